@@ -0,0 +1,289 @@
+/**
+ * \file Bench_Source.cpp
+ * \brief Implementation of the benchmark frame sources
+ *
+ * Contains the capture parsers and the synthetic bus generator.
+ */
+
+#include "Bench_Source.h"
+#include <N2K_Stats.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// Log header and transmit flag, as written by N2K_Logger (see N2K_Logger.h)
+static const uint8_t LOG_HEADER[7] = {'N', 'E', 'M', 'O', 'L', 'O', 'G'};
+static constexpr uint32_t LOG_TX_FLAG = 0x80000000UL;
+
+/* ---------------------------------------------------------------------------
+ * Candump_Source
+ * ------------------------------------------------------------------------- */
+
+Candump_Source::Candump_Source(const char* fileName) {
+    file = fopen(fileName, "r");
+    path = fileName;
+    lastTimestamp = 0;
+    firstLogTime = 0;
+    haveLogTime = false;
+    skippedLines = 0;
+}
+
+Candump_Source::~Candump_Source() {
+    if(file != nullptr) fclose(file);
+}
+
+/**
+ * \brief Parse "can1  09F80123   [8]  01 02 03 04 05 06 07 08"
+ */
+bool Candump_Source::parseNemoLine(const char* line, BenchFrame& frame) {
+    char iface[16];
+    unsigned long id;
+    unsigned len;
+    int consumed = 0;
+    if(sscanf(line, "%15s %lx [%u]%n", iface, &id, &len, &consumed) != 3 || len > 8) return false;
+
+    const char* p = line + consumed;
+    for(unsigned i = 0; i < len; i++) {
+        char* end;
+        unsigned long byte = strtoul(p, &end, 16);
+        if(end == p || byte > 0xFF) return false;
+        frame.data[i] = (uint8_t)byte;
+        p = end;
+    }
+
+    frame.id = id & 0x1FFFFFFF;
+    frame.len = len;
+    frame.timestamp = lastTimestamp + CANDUMP_DEFAULT_SPACING_US;
+    return true;
+}
+
+/**
+ * \brief Parse "(1700000000.123456) can0 09F80123#0102030405060708"
+ */
+bool Candump_Source::parseLogLine(const char* line, BenchFrame& frame) {
+    double seconds;
+    char iface[16];
+    char body[64];
+    if(sscanf(line, "(%lf) %15s %63s", &seconds, iface, body) != 3) return false;
+
+    char* hash = strchr(body, '#');
+    if(hash == nullptr) return false;
+    *hash = '\0';
+    frame.id = strtoul(body, nullptr, 16) & 0x1FFFFFFF;
+
+    const char* hex = hash + 1;
+    size_t digits = strlen(hex);
+    if(digits % 2 != 0 || digits > 16) return false;
+    frame.len = digits / 2;
+    for(uint8_t i = 0; i < frame.len; i++) {
+        char byte[3] = {hex[2 * i], hex[2 * i + 1], '\0'};
+        frame.data[i] = (uint8_t)strtoul(byte, nullptr, 16);
+    }
+
+    if(!haveLogTime) {
+        firstLogTime = seconds;
+        haveLogTime = true;
+    }
+    frame.timestamp = (uint32_t)((seconds - firstLogTime) * 1e6);
+    return true;
+}
+
+bool Candump_Source::next(BenchFrame& frame) {
+    if(file == nullptr) return false;
+
+    char line[256];
+    while(fgets(line, sizeof(line), file) != nullptr) {
+        const char* p = line;
+        while(*p == ' ' || *p == '\t') p++;
+        if(*p == '\0' || *p == '\n' || *p == '\r' || *p == '#') continue;
+
+        bool parsed = (*p == '(') ? parseLogLine(p, frame) : parseNemoLine(p, frame);
+        if(parsed) {
+            lastTimestamp = frame.timestamp;
+            return true;
+        }
+        skippedLines++;
+    }
+    return false;
+}
+
+/* ---------------------------------------------------------------------------
+ * Log_Source
+ * ------------------------------------------------------------------------- */
+
+Log_Source::Log_Source(const char* fileName) {
+    path = fileName;
+    file = fopen(fileName, "rb");
+    if(file == nullptr) return;
+
+    uint8_t header[8];
+    if(fread(header, 1, sizeof(header), file) != sizeof(header) ||
+       memcmp(header, LOG_HEADER, sizeof(LOG_HEADER)) != 0) {
+        fclose(file);
+        file = nullptr;
+    }
+}
+
+Log_Source::~Log_Source() {
+    if(file != nullptr) fclose(file);
+}
+
+static uint32_t getUint32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+bool Log_Source::next(BenchFrame& frame) {
+    if(file == nullptr) return false;
+
+    uint8_t record[9];
+    while(fread(record, 1, sizeof(record), file) == sizeof(record)) {
+        uint8_t len = record[8];
+        if(len > 8 || fread(frame.data, 1, len, file) != len) return false;
+
+        uint32_t id = getUint32(&record[4]);
+        if(id & LOG_TX_FLAG) continue;
+
+        frame.timestamp = getUint32(&record[0]);
+        frame.id = id & 0x1FFFFFFF;
+        frame.len = len;
+        return true;
+    }
+    return false;
+}
+
+/* ---------------------------------------------------------------------------
+ * Synthetic_Source
+ * ------------------------------------------------------------------------- */
+
+Synthetic_Source::Synthetic_Source(int deviceCount, uint32_t frameCount) {
+    if(deviceCount < 1) deviceCount = 1;
+    if(deviceCount > 252) deviceCount = 252;
+
+    pendingIndex = 0;
+    busFreeAt = 0;
+    framesLeft = frameCount;
+    random = 0x12345678;
+    snprintf(name, sizeof(name), "synthetic, %d devices", deviceCount);
+
+    for(int i = 0; i < deviceCount; i++) {
+        uint8_t source = (uint8_t)i;
+        switch(i % 3) {
+            case 0:     // AIS transponder relaying several targets
+                addStream(source, 129038, 4, 28, 200);
+                addStream(source, 129039, 4, 27, 300);
+                break;
+            case 1:     // GNSS receiver
+                addStream(source, 129025, 2, 8, 100);
+                addStream(source, 129026, 2, 8, 250);
+                addStream(source, 129029, 3, 43, 1000);
+                break;
+            default:    // Engine gateway
+                addStream(source, 127488, 2, 8, 100);
+                addStream(source, 127489, 2, 26, 500);
+                break;
+        }
+        addStream(source, 126993, 7, 8, 60000);
+        addStream(source, 60928, 6, 8, 60000);
+    }
+}
+
+void Synthetic_Source::addStream(uint8_t source, uint32_t pgn, uint8_t priority, uint8_t length, uint32_t periodMs) {
+    Stream stream;
+    stream.period = periodMs * 1000;
+    // Spread the first sends over one period, like devices powered up at random
+    stream.nextDue = (uint32_t)(((uint64_t)stream.period * (source * 37 + pgn % 97)) % stream.period);
+    stream.pgn = pgn;
+    stream.source = source;
+    stream.priority = priority;
+    stream.length = length;
+    stream.sequence = 0;
+    schedule.push(stream);
+}
+
+uint8_t Synthetic_Source::nextRandom() {
+    // xorshift32
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+    return (uint8_t)random;
+}
+
+/**
+ * \brief Split one message of a stream into frames
+ *
+ * Single-frame PGNs are one 8 byte frame. Longer ones are sent as a
+ * fast-packet: the first frame carries the sequence/frame counter, the
+ * total length and 6 bytes, every further frame the counter and 7 bytes.
+ *
+ * \param stream Stream to send a message of
+ * \param sendTime Earliest time the first frame can go out
+ */
+void Synthetic_Source::buildMessage(Stream& stream, uint32_t sendTime) {
+    uint8_t payload[223];
+    for(uint8_t i = 0; i < stream.length; i++) payload[i] = nextRandom();
+    // A device's address claim must not change, or the monitor renames it on every claim
+    if(stream.pgn == 60928) {
+        uint32_t identity = stream.source | (2046UL << 21);  // unique number, manufacturer code
+        memset(payload, 0, 8);
+        payload[0] = identity & 0xFF;
+        payload[1] = (identity >> 8) & 0xFF;
+        payload[2] = (identity >> 16) & 0xFF;
+        payload[3] = (identity >> 24) & 0xFF;
+        payload[7] = 0x80;  // arbitrary address capable
+    }
+
+    uint32_t id = ((uint32_t)stream.priority << 26) | (stream.pgn << 8) | stream.source;
+    if(((stream.pgn >> 8) & 0xFF) < 240) id |= 0xFF << 8;   // PDU1: broadcast to 255
+
+    pending.clear();
+    pendingIndex = 0;
+
+    BenchFrame frame;
+    frame.id = id;
+    frame.len = 8;
+    if(stream.length <= 8) {
+        memcpy(frame.data, payload, 8);
+        pending.push_back(frame);
+    } else {
+        uint8_t counter = (stream.sequence & 0x07) << 5;
+        stream.sequence++;
+        uint8_t offset = 0;
+        for(uint8_t index = 0; offset < stream.length; index++) {
+            memset(frame.data, 0xFF, 8);
+            frame.data[0] = counter | index;
+            uint8_t start = 1;
+            if(index == 0) {
+                frame.data[1] = stream.length;
+                start = 2;
+            }
+            for(uint8_t i = start; i < 8 && offset < stream.length; i++) {
+                frame.data[i] = payload[offset++];
+            }
+            pending.push_back(frame);
+        }
+    }
+
+    // Frames leave back to back once the bus is free; that is what saturation looks like
+    uint32_t time = sendTime > busFreeAt ? sendTime : busFreeAt;
+    for(BenchFrame& f : pending) {
+        uint32_t bitTime = N2K_BusStats::frameBits(f.id, f.len, f.data) * (1000000 / MONITOR_BUS_BITRATE);
+        time += bitTime;
+        f.timestamp = time;
+    }
+    busFreeAt = time;
+}
+
+bool Synthetic_Source::next(BenchFrame& frame) {
+    if(framesLeft == 0) return false;
+
+    if(pendingIndex >= pending.size()) {
+        Stream stream = schedule.top();
+        schedule.pop();
+        buildMessage(stream, stream.nextDue);
+        stream.nextDue += stream.period;
+        schedule.push(stream);
+    }
+
+    frame = pending[pendingIndex++];
+    framesLeft--;
+    return true;
+}
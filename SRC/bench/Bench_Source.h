@@ -0,0 +1,197 @@
+/**
+ * \file Bench_Source.h
+ * \brief Frame sources for the native benchmark
+ *
+ * The benchmark drives the monitor with raw CAN frames, the same input the
+ * firmware gets from CAN_Capture, so fast-packet reassembly by the NMEA2000
+ * library is part of the measured path. Frames come from one of:
+ * - Candump_Source:   text captures, NEMO's own candump output or the
+ *                     Linux "candump -l" log format
+ * - Log_Source:       binary NEMOLOG files written by N2K_Logger
+ * - Synthetic_Source: a generated saturated bus with many devices
+ */
+
+#ifndef BENCH_SOURCE_H
+#define BENCH_SOURCE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <queue>
+#include <vector>
+
+/**
+ * \struct BenchFrame
+ * \brief One raw frame with its arrival time
+ */
+struct BenchFrame {
+    uint32_t timestamp;     ///< Arrival time (micros)
+    uint32_t id;            ///< 29-bit extended CAN identifier
+    uint8_t len;            ///< Number of valid data bytes (0-8)
+    uint8_t data[8];        ///< Frame payload
+};
+
+/**
+ * \class Bench_Source
+ * \brief Interface of a frame source
+ */
+class Bench_Source {
+public:
+    virtual ~Bench_Source() {}
+
+    /**
+     * \brief Get the next frame
+     *
+     * \param[out] frame Receives the frame
+     * \return false once the source is exhausted
+     */
+    virtual bool next(BenchFrame& frame) = 0;
+
+    /**
+     * \brief Get a short description for the report
+     *
+     * \return Source description
+     */
+    virtual const char* getName() const = 0;
+};
+
+/**
+ * \class Candump_Source
+ * \brief Reads candump text captures
+ *
+ * Understands NEMO's capture output ("can1  09F80123   [8]  01 02 ...")
+ * and the "candump -l" format ("(1700000000.123456) can0 09F80123#0102...").
+ * Lines without a timestamp are spaced CANDUMP_DEFAULT_SPACING_US apart.
+ * Lines that cannot be parsed are skipped and counted.
+ */
+class Candump_Source : public Bench_Source {
+private:
+    FILE* file;                 ///< Open capture, nullptr if it could not be opened
+    const char* path;           ///< File name for the report
+    uint32_t lastTimestamp;     ///< Timestamp of the previous frame
+    double firstLogTime;        ///< First "candump -l" timestamp, the replay starts at 0
+    bool haveLogTime;           ///< firstLogTime is set
+    uint32_t skippedLines;      ///< Lines that were not frames
+
+    bool parseNemoLine(const char* line, BenchFrame& frame);
+    bool parseLogLine(const char* line, BenchFrame& frame);
+
+public:
+    /// Spacing of frames from captures without timestamps (about 50% load)
+    static constexpr uint32_t CANDUMP_DEFAULT_SPACING_US = 1000;
+
+    /**
+     * \brief Open a capture
+     *
+     * \param fileName Capture to read
+     */
+    Candump_Source(const char* fileName);
+    ~Candump_Source();
+
+    /**
+     * \brief Check whether the capture could be opened
+     *
+     * \return true if the file is open
+     */
+    bool isOpen() const { return file != nullptr; }
+
+    /**
+     * \brief Get the number of lines that were skipped
+     *
+     * \return Unparsable lines so far
+     */
+    uint32_t getSkippedLines() const { return skippedLines; }
+
+    bool next(BenchFrame& frame) override;
+    const char* getName() const override { return path; }
+};
+
+/**
+ * \class Log_Source
+ * \brief Reads binary NEMOLOG files from N2K_Logger
+ *
+ * Frames NEMO transmitted itself (N2K_LOG_TX_FLAG) are skipped, the monitor
+ * only ever sees CAN2 traffic.
+ */
+class Log_Source : public Bench_Source {
+private:
+    FILE* file;                 ///< Open log, nullptr if it could not be opened or is no NEMOLOG
+    const char* path;           ///< File name for the report
+
+public:
+    /**
+     * \brief Open a log and check its header
+     *
+     * \param fileName Log to read
+     */
+    Log_Source(const char* fileName);
+    ~Log_Source();
+
+    /**
+     * \brief Check whether the log could be opened
+     *
+     * \return true if the file is open and has a NEMOLOG header
+     */
+    bool isOpen() const { return file != nullptr; }
+
+    bool next(BenchFrame& frame) override;
+    const char* getName() const override { return path; }
+};
+
+/**
+ * \class Synthetic_Source
+ * \brief Generates a saturated bus with a mixed device profile
+ *
+ * Devices take turns being an AIS transponder, a GNSS receiver or an
+ * engine gateway, each sending its PGNs at their usual rates plus a
+ * heartbeat. With enough devices the offered load exceeds 250 kbit/s;
+ * frames then queue for the bus and leave back to back, just like a
+ * saturated network. Payloads are pseudo-random but have the real lengths,
+ * so the decode cost is representative even though the values are not.
+ */
+class Synthetic_Source : public Bench_Source {
+private:
+    /**
+     * \struct Stream
+     * \brief One periodic PGN of one device
+     */
+    struct Stream {
+        uint32_t nextDue;       ///< Time the next message is due (micros)
+        uint32_t period;        ///< Send interval (micros)
+        uint32_t pgn;           ///< PGN sent
+        uint8_t source;         ///< Sending device
+        uint8_t priority;       ///< CAN priority (0-7)
+        uint8_t length;         ///< Payload length, more than 8 means fast-packet
+        uint8_t sequence;       ///< Fast-packet sequence counter (0-7)
+    };
+
+    /// Orders the schedule by due time, earliest first
+    struct LaterDue {
+        bool operator()(const Stream& a, const Stream& b) const { return a.nextDue > b.nextDue; }
+    };
+
+    std::priority_queue<Stream, std::vector<Stream>, LaterDue> schedule;   ///< Streams by due time
+    std::vector<BenchFrame> pending;    ///< Frames of the message being sent
+    size_t pendingIndex;                ///< Next frame in pending
+    uint32_t busFreeAt;                 ///< Time the bus is free for the next frame (micros)
+    uint32_t framesLeft;                ///< Frames still to generate
+    uint32_t random;                    ///< Payload generator state
+    char name[48];                      ///< Description for the report
+
+    void addStream(uint8_t source, uint32_t pgn, uint8_t priority, uint8_t length, uint32_t periodMs);
+    void buildMessage(Stream& stream, uint32_t sendTime);
+    uint8_t nextRandom();
+
+public:
+    /**
+     * \brief Set up the device profile
+     *
+     * \param deviceCount Number of devices (1-252)
+     * \param frameCount Number of frames to generate
+     */
+    Synthetic_Source(int deviceCount, uint32_t frameCount);
+
+    bool next(BenchFrame& frame) override;
+    const char* getName() const override { return name; }
+};
+
+#endif // BENCH_SOURCE_H
@@ -0,0 +1,536 @@
+/**
+ * \file bench_main.cpp
+ * \brief Native benchmark of the CAN2 monitoring path
+ *
+ * Replays a capture (or a generated saturated bus) through the same chain
+ * the firmware runs for CAN2: bus statistics, NMEA2000 library with
+ * fast-packet reassembly, N2K_Monitor::handleN2kMessage() and, unless
+ * --no-decode is given, the lazy field decode for every message as if the
+ * PGN were open in Live Data.
+ *
+ * Reports:
+ * - messages per second, end to end and for the monitor alone, the latter
+ *   split into messages stored and messages dropped on a full PGN pool
+ * - heap allocations per message (operator new is counted)
+ * - decode cost and allocations per PGN
+ *
+ * A run where more than --max-drops percent of the messages were dropped
+ * fails: it mostly timed the reject path, not storage.
+ *
+ * Usage:
+ *   pio run -e native && .pio/build/native/program [options]
+ *     --candump FILE        replay a candump text capture
+ *     --log FILE            replay a NEMOLOG binary log
+ *     --synthetic N         generate a saturated bus with N devices (default 88, fits the PGN pool)
+ *     --frames N            frames to generate (default 200000)
+ *     --runs N              replay N times and keep the best figures (default 5)
+ *     --no-decode           measure storage only, skip the field decode
+ *     --write-baseline FILE save the summary as a baseline
+ *     --baseline FILE       compare with a baseline, exit 1 on a regression
+ *     --tolerance PCT       allowed throughput loss against the baseline (default 10)
+ *     --max-drops PCT       fail if more messages are dropped on a full PGN pool (default 1)
+ *
+ * Throughput depends on the host, so only compare baselines recorded on the
+ * same machine, and keep the best of several runs so a busy moment on the
+ * host doesn't read as a regression. Allocation counts do not, and are
+ * compared exactly; bench/baseline-allocs.txt holds those of the default
+ * synthetic run.
+ *
+ * Exit codes: 0 ok, 1 regression against the baseline, 2 bad arguments,
+ * unreadable source or baseline, or too many drops.
+ */
+
+#include <Arduino.h>
+#include <NMEA2000.h>
+#include <N2kMessages.h>
+#include <N2K_Monitor.h>
+#include "Bench_Source.h"
+#include <chrono>
+#include <map>
+#include <new>
+#include <string>
+
+uint32_t benchMicros = 0;
+
+extern "C" uint32_t micros() { return benchMicros; }
+extern "C" uint32_t millis() { return benchMicros / 1000; }
+
+/// The virtual clock only moves with the frames, so a delay returns at once
+extern "C" void delay(uint32_t ms) { (void)ms; }
+
+/* ---------------------------------------------------------------------------
+ * Allocation counting
+ * ------------------------------------------------------------------------- */
+
+static uint64_t allocationCount = 0;
+
+void* operator new(size_t size) {
+    allocationCount++;
+    void* p = malloc(size ? size : 1);
+    if(p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    allocationCount++;
+    void* p = malloc(size ? size : 1);
+    if(p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+/* ---------------------------------------------------------------------------
+ * Replay bus
+ * ------------------------------------------------------------------------- */
+
+/**
+ * \class Bench_Bus
+ * \brief tNMEA2000 driver that receives the frames handed to it
+ *
+ * Plays the part of CAN_Capture: every frame pushed is returned by the next
+ * CANGetFrame(), so the library's reassembly runs exactly as on the device.
+ */
+class Bench_Bus : public tNMEA2000 {
+private:
+    BenchFrame frame;       ///< Frame waiting to be read
+    bool hasFrame;          ///< frame has not been read yet
+
+protected:
+    bool CANSendFrame(unsigned long id, unsigned char len, const unsigned char* buf, bool wait_sent) override {
+        (void)id; (void)len; (void)buf; (void)wait_sent;
+        return true;
+    }
+
+    bool CANOpen() override { return true; }
+
+    bool CANGetFrame(unsigned long& id, unsigned char& len, unsigned char* buf) override {
+        if(!hasFrame) return false;
+        id = frame.id;
+        len = frame.len;
+        memcpy(buf, frame.data, frame.len);
+        hasFrame = false;
+        return true;
+    }
+
+public:
+    Bench_Bus() : hasFrame(false) {}
+
+    /**
+     * \brief Hand one frame to the library
+     *
+     * \param next Frame to deliver
+     */
+    void push(const BenchFrame& next) {
+        frame = next;
+        hasFrame = true;
+        ParseMessages();
+    }
+};
+
+/* ---------------------------------------------------------------------------
+ * Measurement
+ * ------------------------------------------------------------------------- */
+
+typedef std::chrono::steady_clock BenchClock;
+
+static uint64_t elapsedNanos(BenchClock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(BenchClock::now() - start).count();
+}
+
+/**
+ * \struct PGNCost
+ * \brief Accumulated decode cost of one PGN
+ */
+struct PGNCost {
+    uint64_t messages = 0;      ///< Messages stored and decoded
+    uint64_t decodeNanos = 0;   ///< Time spent decoding
+    uint64_t decodeAllocs = 0;  ///< Allocations while decoding
+};
+
+static N2K_Monitor* monitor = nullptr;
+static bool decodeEnabled = true;
+static uint64_t messageCount = 0;
+static uint64_t droppedCount = 0;       ///< Messages rejected because the PGN pool was full
+static uint64_t storedNanos = 0;        ///< handleN2kMessage() time of stored messages
+static uint64_t droppedNanos = 0;       ///< handleN2kMessage() time of dropped messages
+static uint64_t monitorAllocs = 0;
+static std::map<uint32_t, PGNCost> pgnCosts;
+
+static void handleMessage(const tN2kMsg& msg) {
+    messageCount++;
+    uint32_t droppedBefore = monitor->getDroppedPGNCount();
+
+    uint64_t allocsBefore = allocationCount;
+    BenchClock::time_point start = BenchClock::now();
+    monitor->handleN2kMessage(msg);
+    uint64_t nanos = elapsedNanos(start);
+    monitorAllocs += allocationCount - allocsBefore;
+
+    // A dropped message only took the reject path and has no entry to decode
+    if(monitor->getDroppedPGNCount() != droppedBefore) {
+        droppedCount++;
+        droppedNanos += nanos;
+        return;
+    }
+    storedNanos += nanos;
+
+    if(!decodeEnabled) return;
+
+    PGNCost& cost = pgnCosts[msg.PGN];
+    cost.messages++;
+
+    allocsBefore = allocationCount;
+    start = BenchClock::now();
+    monitor->getDecodedPGNData(msg.Source, msg.PGN);
+    cost.decodeNanos += elapsedNanos(start);
+    cost.decodeAllocs += allocationCount - allocsBefore;
+}
+
+/* ---------------------------------------------------------------------------
+ * Baselines
+ * ------------------------------------------------------------------------- */
+
+typedef std::map<std::string, double> Summary;
+
+static bool writeBaseline(const char* path, const Summary& summary) {
+    FILE* file = fopen(path, "w");
+    if(file == nullptr) return false;
+    for(const auto& entry : summary) {
+        fprintf(file, "%s=%.4f\n", entry.first.c_str(), entry.second);
+    }
+    fclose(file);
+    return true;
+}
+
+static bool readBaseline(const char* path, Summary& summary) {
+    FILE* file = fopen(path, "r");
+    if(file == nullptr) return false;
+    char key[64];
+    double value;
+    while(fscanf(file, " %63[^=]=%lf", key, &value) == 2) {
+        summary[key] = value;
+    }
+    fclose(file);
+    return true;
+}
+
+/**
+ * \brief Compare a run with a baseline
+ *
+ * Rates ("*_per_sec") may drop by tolerance percent, costs ("*_ns") may
+ * rise by as much. Allocation counts ("*allocs*") must not rise at all.
+ * Message counts ("decode_msgs.*") and the drop share ("drop_pct", checked
+ * against --max-drops instead) are only there for the report.
+ *
+ * \return Number of regressions found
+ */
+static int compareBaseline(const Summary& baseline, const Summary& current, double tolerance) {
+    int regressions = 0;
+    for(const auto& entry : baseline) {
+        auto it = current.find(entry.first);
+        if(it == current.end()) continue;
+
+        const std::string& key = entry.first;
+        if(key.compare(0, 12, "decode_msgs.") == 0 || key == "drop_pct") continue;
+        double base = entry.second;
+        double now = it->second;
+        bool worse;
+        if(key.find("allocs") != std::string::npos) {
+            worse = now > base + 0.005;
+        } else if(key.find("_per_sec") != std::string::npos) {
+            worse = now < base * (1.0 - tolerance / 100.0);
+        } else {
+            worse = now > base * (1.0 + tolerance / 100.0);
+        }
+
+        if(worse) {
+            printf("REGRESSION %-28s baseline %.2f now %.2f\n", key.c_str(), base, now);
+            regressions++;
+        }
+    }
+    return regressions;
+}
+
+/* ---------------------------------------------------------------------------
+ * Runs
+ * ------------------------------------------------------------------------- */
+
+/// Messages a PGN needs before its decode time goes into the summary; fewer are too noisy to compare
+static constexpr uint64_t BENCH_MIN_TIMED_MESSAGES = 1000;
+
+/// Default synthetic devices: the most whose 381 (source, PGN) streams fit MONITOR_MAX_PGN_ENTRIES,
+/// and still enough to saturate the bus
+static constexpr int BENCH_SYNTHETIC_DEVICES = 88;
+
+/**
+ * \struct BenchOptions
+ * \brief What to replay
+ */
+struct BenchOptions {
+    const char* candumpPath = nullptr;      ///< candump capture, or nullptr
+    const char* logPath = nullptr;          ///< NEMOLOG file, or nullptr
+    int syntheticDevices = BENCH_SYNTHETIC_DEVICES;  ///< Devices on the generated bus
+    uint32_t syntheticFrames = 200000;      ///< Frames to generate
+};
+
+/**
+ * \brief Open the source the options select
+ *
+ * \return Source, or nullptr if the file can't be read
+ */
+static Bench_Source* openSource(const BenchOptions& options) {
+    if(options.candumpPath != nullptr) {
+        Candump_Source* capture = new Candump_Source(options.candumpPath);
+        if(capture->isOpen()) return capture;
+        printf("cannot open %s\n", options.candumpPath);
+        delete capture;
+        return nullptr;
+    }
+    if(options.logPath != nullptr) {
+        Log_Source* log = new Log_Source(options.logPath);
+        if(log->isOpen()) return log;
+        printf("cannot open %s or it is not a NEMOLOG file\n", options.logPath);
+        delete log;
+        return nullptr;
+    }
+    return new Synthetic_Source(options.syntheticDevices, options.syntheticFrames);
+}
+
+/**
+ * \brief Replay the source once through a fresh library and monitor
+ *
+ * \param options What to replay
+ * \param[out] summary Rates, costs and allocation counts of the run
+ * \param printHeader Print what was replayed
+ * \return false if the source can't be read or held no messages
+ */
+static bool runOnce(const BenchOptions& options, Summary& summary, bool printHeader) {
+    Bench_Source* source = openSource(options);
+    if(source == nullptr) return false;
+
+    messageCount = 0;
+    droppedCount = 0;
+    storedNanos = 0;
+    droppedNanos = 0;
+    monitorAllocs = 0;
+    pgnCosts.clear();
+    benchMicros = 0;
+
+    monitor = new N2K_Monitor();
+    Bench_Bus bus;
+    bus.SetMode(tNMEA2000::N2km_ListenOnly);
+    bus.SetMsgHandler(handleMessage);
+    bus.SetN2kCANReceiveFrameBufSize(2048);
+    bus.Open();
+
+    // Same periodic work as the MONITOR_STATS and MONITOR_CLEANUP tasks, on the virtual clock
+    uint32_t nextStatsUpdate = 0;
+    uint32_t nextCleanup = MONITOR_CLEANUP_INTERVAL_MS * 1000UL;
+    uint64_t frameCount = 0;
+    uint32_t firstTimestamp = 0;
+
+    uint64_t allocsBefore = allocationCount;
+    BenchClock::time_point start = BenchClock::now();
+
+    BenchFrame frame;
+    while(source->next(frame)) {
+        if(frameCount == 0) firstTimestamp = frame.timestamp;
+        frameCount++;
+        benchMicros = frame.timestamp;
+
+        monitor->handleFrame(frame.id, frame.len, frame.data, frame.timestamp);
+        bus.push(frame);
+
+        if((int32_t)(benchMicros - nextStatsUpdate) >= 0) {
+            monitor->update();
+            nextStatsUpdate = benchMicros + MONITOR_STATS_INTERVAL_MS * 1000UL;
+        }
+        if((int32_t)(benchMicros - nextCleanup) >= 0) {
+            monitor->cleanupStaleEntries();
+            nextCleanup = benchMicros + MONITOR_CLEANUP_INTERVAL_MS * 1000UL;
+        }
+    }
+
+    double totalSeconds = elapsedNanos(start) / 1e9;
+    uint64_t totalAllocs = allocationCount - allocsBefore;
+    double busSeconds = (benchMicros - firstTimestamp) / 1e6;
+
+    bool ok = messageCount > 0;
+    if(!ok) {
+        printf("no messages decoded from %s\n", source->getName());
+    } else {
+        if(printHeader) {
+            printf("source:   %s\n", source->getName());
+            printf("frames:   %llu (%.1f s of bus time, peak load %.1f%%)\n",
+                   (unsigned long long)frameCount, busSeconds, monitor->getBusStats().getPeakBusLoad());
+            printf("messages: %llu from %u devices, %llu stored, %llu dropped (PGN pool of %d entries)\n",
+                   (unsigned long long)messageCount, (unsigned)monitor->getDeviceList().size(),
+                   (unsigned long long)(messageCount - droppedCount), (unsigned long long)droppedCount,
+                   MONITOR_MAX_PGN_ENTRIES);
+        }
+
+        summary["msgs_per_sec"] = messageCount / totalSeconds;
+        summary["drop_pct"] = 100.0 * droppedCount / messageCount;
+        if(storedNanos > 0) summary["stored_msgs_per_sec"] = (messageCount - droppedCount) / (storedNanos / 1e9);
+        if(droppedNanos > 0) summary["dropped_msgs_per_sec"] = droppedCount / (droppedNanos / 1e9);
+        summary["allocs_per_msg"] = (double)totalAllocs / messageCount;
+        summary["monitor_allocs_per_msg"] = (double)monitorAllocs / messageCount;
+
+        for(const auto& entry : pgnCosts) {
+            const PGNCost& cost = entry.second;
+            if(!decodeEnabled || cost.messages == 0) continue;
+            std::string key = std::to_string(entry.first);
+            summary["decode_msgs." + key] = (double)cost.messages;
+            summary["decode_allocs." + key] = (double)cost.decodeAllocs / cost.messages;
+            if(cost.messages >= BENCH_MIN_TIMED_MESSAGES) {
+                summary["decode_ns." + key] = (double)cost.decodeNanos / cost.messages;
+            }
+        }
+    }
+
+    delete monitor;
+    monitor = nullptr;
+    delete source;
+    return ok;
+}
+
+/**
+ * \brief Keep the best figures of two runs
+ *
+ * A slower run only measured a busier host, so each rate keeps its highest
+ * and each cost its lowest value. Allocation counts and the drop share
+ * don't depend on the host; the highest is kept so a run that allocates or
+ * drops more isn't hidden.
+ */
+static void keepBest(Summary& best, const Summary& run) {
+    for(const auto& entry : run) {
+        auto it = best.find(entry.first);
+        if(it == best.end()) {
+            best.insert(entry);
+            continue;
+        }
+        const std::string& key = entry.first;
+        if(key.find("_per_sec") != std::string::npos) {
+            it->second = std::max(it->second, entry.second);
+        } else if(key.find("allocs") != std::string::npos || key == "drop_pct") {
+            it->second = std::max(it->second, entry.second);
+        } else {
+            it->second = std::min(it->second, entry.second);
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Main
+ * ------------------------------------------------------------------------- */
+
+static void printUsage() {
+    printf("usage: program [--candump FILE | --log FILE | --synthetic N] [--frames N] [--runs N]\n"
+           "               [--no-decode] [--write-baseline FILE] [--baseline FILE] [--tolerance PCT]\n"
+           "               [--max-drops PCT]\n");
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    const char* baselinePath = nullptr;
+    const char* writeBaselinePath = nullptr;
+    int runs = 5;
+    double tolerance = 10.0;
+    double maxDrops = 1.0;
+
+    for(int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if(strcmp(argv[i], "--candump") == 0 && hasValue) options.candumpPath = argv[++i];
+        else if(strcmp(argv[i], "--log") == 0 && hasValue) options.logPath = argv[++i];
+        else if(strcmp(argv[i], "--synthetic") == 0 && hasValue) options.syntheticDevices = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--frames") == 0 && hasValue) options.syntheticFrames = strtoul(argv[++i], nullptr, 10);
+        else if(strcmp(argv[i], "--runs") == 0 && hasValue) runs = max(1, atoi(argv[++i]));
+        else if(strcmp(argv[i], "--baseline") == 0 && hasValue) baselinePath = argv[++i];
+        else if(strcmp(argv[i], "--write-baseline") == 0 && hasValue) writeBaselinePath = argv[++i];
+        else if(strcmp(argv[i], "--tolerance") == 0 && hasValue) tolerance = atof(argv[++i]);
+        else if(strcmp(argv[i], "--max-drops") == 0 && hasValue) maxDrops = atof(argv[++i]);
+        else if(strcmp(argv[i], "--no-decode") == 0) decodeEnabled = false;
+        else if(strcmp(argv[i], "--help") == 0) {
+            printUsage();
+            return 0;
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    Summary summary;
+    for(int run = 0; run < runs; run++) {
+        Summary current;
+        if(!runOnce(options, current, run == 0)) return 2;
+        keepBest(summary, current);
+    }
+
+    /* Report */
+    printf("best of:  %d runs\n\n", runs);
+    printf("end to end:   %12.0f msg/s  %8.3f allocs/msg\n", summary["msgs_per_sec"], summary["allocs_per_msg"]);
+    printf("monitor only: %12.0f msg/s  %8.3f allocs/msg  (stored messages)\n", summary["stored_msgs_per_sec"],
+           summary["monitor_allocs_per_msg"]);
+    if(summary.count("dropped_msgs_per_sec")) {
+        printf("dropped:      %12.0f msg/s  %8.1f%% of messages\n", summary["dropped_msgs_per_sec"],
+               summary["drop_pct"]);
+    }
+
+    if(decodeEnabled) {
+        // The summary is sorted as text, the table by PGN number
+        const std::string prefix = "decode_msgs.";
+        std::map<uint32_t, double> pgnMessages;
+        for(const auto& entry : summary) {
+            if(entry.first.compare(0, prefix.size(), prefix) != 0) continue;
+            pgnMessages[strtoul(entry.first.c_str() + prefix.size(), nullptr, 10)] = entry.second;
+        }
+
+        printf("\n%-7s %-22s %9s %10s %12s\n", "pgn", "name", "msgs", "ns/decode", "allocs/dec");
+        for(const auto& entry : pgnMessages) {
+            uint32_t pgn = entry.first;
+            std::string key = std::to_string(pgn);
+            char name[N2K_PGN_NAME_SIZE];
+            N2K_Monitor::formatPGNName(pgn, name, sizeof(name));
+
+            char nanos[16] = "-";
+            auto timed = summary.find("decode_ns." + key);
+            if(timed != summary.end()) snprintf(nanos, sizeof(nanos), "%.0f", timed->second);
+            printf("%-7lu %-22.22s %9.0f %10s %12.2f\n", (unsigned long)pgn, name, entry.second, nanos,
+                   summary["decode_allocs." + key]);
+        }
+        printf("(ns/decode is left out below %llu messages)\n", (unsigned long long)BENCH_MIN_TIMED_MESSAGES);
+    }
+
+    // Checked before a baseline is written, so a run that didn't measure storage can't become one
+    if(summary["drop_pct"] > maxDrops) {
+        printf("\n%.1f%% of messages were dropped on a full PGN pool (limit %.1f%%): fewer devices,\n"
+               "or raise --max-drops to time the reject path on purpose\n", summary["drop_pct"], maxDrops);
+        return 2;
+    }
+
+    if(writeBaselinePath != nullptr) {
+        if(!writeBaseline(writeBaselinePath, summary)) {
+            printf("cannot write %s\n", writeBaselinePath);
+            return 2;
+        }
+        printf("\nbaseline written to %s\n", writeBaselinePath);
+    }
+
+    if(baselinePath != nullptr) {
+        Summary baseline;
+        if(!readBaseline(baselinePath, baseline)) {
+            printf("cannot read %s\n", baselinePath);
+            return 2;
+        }
+        printf("\n");
+        int regressions = compareBaseline(baseline, summary, tolerance);
+        printf("%d regression(s) against %s\n", regressions, baselinePath);
+        if(regressions > 0) return 1;
+    }
+
+    return 0;
+}
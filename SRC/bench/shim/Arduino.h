@@ -0,0 +1,180 @@
+/**
+ * \file Arduino.h
+ * \brief Minimal Arduino core replacement for the native benchmark build
+ *
+ * Provides just enough of the Arduino API for the monitor and PGN helper
+ * libraries to build on the host: a String class with the members they
+ * use, min/max, and millis()/micros() running on a virtual clock.
+ *
+ * The clock is set by the benchmark from the frame timestamps, so rate and
+ * stale-entry logic see the recorded bus timing, not the host's speed.
+ *
+ * \note Only used by [env:native]. Never include it in the firmware build.
+ */
+
+#ifndef NEMO_BENCH_ARDUINO_H
+#define NEMO_BENCH_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <algorithm>
+
+/* ---------------------------------------------------------------------------
+ * Virtual clock
+ * ------------------------------------------------------------------------- */
+
+/**
+ * \brief Current virtual time in microseconds, set by the benchmark
+ */
+extern uint32_t benchMicros;
+
+/*
+ * Off Arduino the NMEA2000 library declares millis() and delay() itself,
+ * with C linkage, and leaves them to the application. They are defined in
+ * bench_main.cpp with exactly those signatures, so the library's timeouts
+ * run on the virtual clock too.
+ */
+extern "C" {
+uint32_t micros();
+uint32_t millis();
+void delay(uint32_t ms);
+}
+
+using std::min;
+using std::max;
+
+/* ---------------------------------------------------------------------------
+ * String
+ * ------------------------------------------------------------------------- */
+
+/**
+ * \class String
+ * \brief std::string backed stand-in for the Arduino String class
+ *
+ * Numeric constructors format the same way as the Arduino core, so decoded
+ * field values and their allocation pattern match the firmware closely.
+ */
+class String {
+private:
+    std::string text;
+
+    static std::string fromUnsigned(unsigned long long value, unsigned char base) {
+        char buf[66];
+        int pos = sizeof(buf) - 1;
+        buf[pos] = '\0';
+        do {
+            unsigned digit = value % base;
+            buf[--pos] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+            value /= base;
+        } while(value != 0 && pos > 0);
+        return std::string(&buf[pos]);
+    }
+
+    static std::string fromSigned(long long value, unsigned char base) {
+        if(value < 0 && base == 10) return "-" + fromUnsigned(-(unsigned long long)value, base);
+        return fromUnsigned((unsigned long long)value, base);
+    }
+
+    static std::string fromDouble(double value, unsigned char decimals) {
+        char buf[48];
+        snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+        return std::string(buf);
+    }
+
+public:
+    String() {}
+    String(const char* str) : text(str ? str : "") {}
+    String(const std::string& str) : text(str) {}
+    explicit String(char c) : text(1, c) {}
+    explicit String(unsigned char value, unsigned char base = 10) : text(fromUnsigned(value, base)) {}
+    explicit String(int value, unsigned char base = 10) : text(fromSigned(value, base)) {}
+    explicit String(unsigned int value, unsigned char base = 10) : text(fromUnsigned(value, base)) {}
+    explicit String(long value, unsigned char base = 10) : text(fromSigned(value, base)) {}
+    explicit String(unsigned long value, unsigned char base = 10) : text(fromUnsigned(value, base)) {}
+    explicit String(long long value, unsigned char base = 10) : text(fromSigned(value, base)) {}
+    explicit String(unsigned long long value, unsigned char base = 10) : text(fromUnsigned(value, base)) {}
+    explicit String(float value, unsigned char decimals = 2) : text(fromDouble(value, decimals)) {}
+    explicit String(double value, unsigned char decimals = 2) : text(fromDouble(value, decimals)) {}
+
+    const char* c_str() const { return text.c_str(); }
+    unsigned int length() const { return text.length(); }
+    bool reserve(unsigned int size) { text.reserve(size); return true; }
+    char charAt(unsigned int index) const { return index < text.length() ? text[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+
+    String substring(unsigned int from) const {
+        return from < text.length() ? String(text.substr(from)) : String();
+    }
+    String substring(unsigned int from, unsigned int to) const {
+        if(from > to) std::swap(from, to);
+        if(from >= text.length()) return String();
+        return String(text.substr(from, std::min<size_t>(to, text.length()) - from));
+    }
+
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t pos = text.find(c, from);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+    int indexOf(const String& str, unsigned int from = 0) const {
+        size_t pos = text.find(str.text, from);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+    bool startsWith(const String& prefix) const { return text.compare(0, prefix.text.length(), prefix.text) == 0; }
+    bool endsWith(const String& suffix) const {
+        return text.length() >= suffix.text.length() &&
+               text.compare(text.length() - suffix.text.length(), suffix.text.length(), suffix.text) == 0;
+    }
+    bool equals(const String& other) const { return text == other.text; }
+
+    void trim() {
+        size_t start = text.find_first_not_of(" \t\r\n");
+        if(start == std::string::npos) { text.clear(); return; }
+        size_t end = text.find_last_not_of(" \t\r\n");
+        text = text.substr(start, end - start + 1);
+    }
+    void toUpperCase() { for(char& c : text) c = toupper((unsigned char)c); }
+    void toLowerCase() { for(char& c : text) c = tolower((unsigned char)c); }
+    long toInt() const { return atol(text.c_str()); }
+    float toFloat() const { return (float)atof(text.c_str()); }
+
+    String& operator+=(const String& other) { text += other.text; return *this; }
+    String& operator+=(const char* str) { if(str) text += str; return *this; }
+    String& operator+=(char c) { text += c; return *this; }
+    String& operator+=(int value) { text += fromSigned(value, 10); return *this; }
+    String& operator+=(unsigned int value) { text += fromUnsigned(value, 10); return *this; }
+    String& operator+=(long value) { text += fromSigned(value, 10); return *this; }
+    String& operator+=(unsigned long value) { text += fromUnsigned(value, 10); return *this; }
+    String& operator+=(double value) { text += fromDouble(value, 2); return *this; }
+
+    bool operator==(const String& other) const { return text == other.text; }
+    bool operator==(const char* str) const { return text == (str ? str : ""); }
+    bool operator!=(const String& other) const { return text != other.text; }
+    bool operator!=(const char* str) const { return !(*this == str); }
+    bool operator<(const String& other) const { return text < other.text; }
+};
+
+template<typename T>
+inline String operator+(const String& lhs, const T& rhs) {
+    String result(lhs);
+    result += rhs;
+    return result;
+}
+
+inline String operator+(const char* lhs, const String& rhs) {
+    String result(lhs);
+    result += rhs;
+    return result;
+}
+
+inline String operator+(char lhs, const String& rhs) {
+    String result(lhs);
+    result += rhs;
+    return result;
+}
+
+#endif // NEMO_BENCH_ARDUINO_H
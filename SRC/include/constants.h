@@ -32,6 +32,19 @@
  */
 #define DEBUG false
 
+/**
+ * \def PROFILER_ENABLED
+ * \brief Enable or disable the cycle counter zone profiler.
+ *
+ * When set to \c true, the code zones marked with PROFILE_ZONE() time
+ * themselves with the Cortex-M7 cycle counter, and the "prof" console
+ * command and the Profiler screen are built. When set to \c false, all of
+ * it compiles to nothing.
+ *
+ * \note Each timed zone costs two cycle counter reads and a table update.
+ */
+#define PROFILER_ENABLED false
+
 /*
  * Hardware Pin Definitions - Sensor Inputs
 */
@@ -63,6 +76,45 @@
  */
 #define SENSOR_PIN_3 14
 
+/*
+ * Analog Sampling Constants
+*/
+
+/**
+ * \brief Maximum number of analog pins the background sampler can serve.
+ *
+ * Default value: 4 pins
+ */
+inline constexpr uint8_t ANALOG_MAX_CHANNELS = 4;
+
+/**
+ * \brief Period of the analog sampling interrupt (in microseconds).
+ *
+ * Each tick collects one finished conversion and starts the next, moving
+ * round-robin over the registered pins. With three sensors every pin is
+ * sampled every 1.5 ms.
+ *
+ * Default value: 500 us
+ */
+inline constexpr uint32_t ANALOG_SAMPLE_INTERVAL_US = 500;
+
+/**
+ * \brief Number of samples in each pin's moving average.
+ *
+ * Together with the hardware averaging this replaces the old blocking
+ * five-sample average. Must be a power of two.
+ *
+ * Default value: 16 samples
+ */
+inline constexpr uint8_t ANALOG_FILTER_SIZE = 16;
+
+/**
+ * \brief Number of conversions the ADC averages in hardware per sample.
+ *
+ * Default value: 4 conversions
+ */
+inline constexpr uint8_t ANALOG_HW_AVERAGING = 4;
+
 /*
  * Hardware Pin Definitions - Navigation Buttons
 */
@@ -103,6 +155,19 @@
  */
 #define BUTTON_RIGHT 4
 
+/*
+ * Hardware Pin Definitions - Storage
+*/
+
+/**
+ * \def LOGGER_SD_CS_PIN
+ * \brief Chip select pin of the SPI SD card used by the frame logger.
+ *
+ * The card shares the default SPI bus (MOSI 11, MISO 12, SCK 13).
+ * Connected to GPIO 10 on the Teensy 4.0 board.
+ */
+#define LOGGER_SD_CS_PIN 10
+
 /*
  * Timing Constants
 */
@@ -114,10 +179,24 @@
  * the device data is considered stale and may be cleaned up. This helps
  * manage memory and ensure the display shows only active network devices.
  *
+ * This is the timeout of STALE_CLASS_DYNAMIC, which holds every PGN not
+ * listed as static in N2K_Expiry.cpp.
+ *
  * Default value: 60000 ms (1 minute)
  */
 inline constexpr unsigned long STALE_TIMEOUT_MS = 60000;
 
+/**
+ * \brief Timeout for static and slowly refreshed PGNs (in milliseconds).
+ *
+ * Used for STALE_CLASS_STATIC, e.g. AIS static data, which is only sent
+ * every 6 minutes, and product information, which is sent on request. Long
+ * enough to ride out one missed report.
+ *
+ * Default value: 900000 ms (15 minutes)
+ */
+inline constexpr unsigned long STALE_TIMEOUT_STATIC_MS = 900000;
+
 /**
  * \brief Delay between display scroll updates (in milliseconds).
  *
@@ -129,6 +208,222 @@ inline constexpr unsigned long STALE_TIMEOUT_MS = 60000;
  */
 inline constexpr unsigned long SCROLL_DELAY_MS = 400;
 
+/*
+ * Task Scheduler Constants
+*/
+
+/**
+ * \brief Maximum number of tasks the loop scheduler can hold.
+ *
+ * Default value: 24 tasks
+ */
+inline constexpr uint8_t SCHEDULER_MAX_TASKS = 24;
+
+/**
+ * \brief Period of the sensor potentiometer refresh task (in milliseconds).
+ *
+ * Default value: 10 ms
+ */
+inline constexpr uint32_t SENSOR_REFRESH_INTERVAL_MS = 10;
+
+/**
+ * \brief Default interval between two transmissions of a simulated device (in milliseconds).
+ *
+ * Each device can be given its own interval, see Sensor::setSendInterval().
+ *
+ * Default value: 1000 ms
+ */
+inline constexpr uint32_t SENSOR_SEND_INTERVAL_MS = 1000;
+
+/**
+ * \brief Period of the button polling task (in milliseconds).
+ *
+ * Short compared to the 250 ms debounce, so presses still feel instant.
+ *
+ * Default value: 10 ms
+ */
+inline constexpr uint32_t BUTTON_POLL_INTERVAL_MS = 10;
+
+/**
+ * \brief Period of the frame logger storage task (in milliseconds).
+ *
+ * A 16 KB logger buffer holds about half a second of a fully loaded bus,
+ * so 5 ms leaves plenty of margin.
+ *
+ * Default value: 5 ms
+ */
+inline constexpr uint32_t LOGGER_SERVICE_INTERVAL_MS = 5;
+
+/**
+ * \brief Period of the snapshot server task (in milliseconds).
+ *
+ * Requests are answered within this time, and subscriptions can't be
+ * pushed more often than this.
+ *
+ * Default value: 5 ms
+ */
+inline constexpr uint32_t SNAPSHOT_SERVICE_INTERVAL_MS = 5;
+
+/**
+ * \brief Period of the configuration store task (in milliseconds).
+ *
+ * Each run compares the live configuration with the saved one and writes
+ * at most CONFIG_WRITE_CHUNK bytes of a pending save.
+ *
+ * Default value: 50 ms
+ */
+inline constexpr uint32_t CONFIG_SERVICE_INTERVAL_MS = 50;
+
+/**
+ * \brief Period of the impersonation attack transmissions (in milliseconds).
+ *
+ * Default value: 100 ms (10 Hz)
+ */
+inline constexpr uint32_t ATTACK_IMPERSONATE_INTERVAL_MS = 100;
+
+/**
+ * \brief Period of the bus statistics publishing task (in milliseconds).
+ *
+ * Default value: 100 ms
+ */
+inline constexpr uint32_t MONITOR_STATS_INTERVAL_MS = 100;
+
+/**
+ * \brief Period of the stale device cleanup task (in milliseconds).
+ *
+ * Each run only retires entries that have expired, so it can run often
+ * without scanning all devices.
+ *
+ * Default value: 1000 ms
+ */
+inline constexpr uint32_t MONITOR_CLEANUP_INTERVAL_MS = 1000;
+
+/**
+ * \brief Period of the display refresh task (in milliseconds).
+ *
+ * Upper bound on how often the menu redraws. Screens apply their own,
+ * slower refresh rates on top of this.
+ *
+ * Default value: 20 ms
+ */
+inline constexpr uint32_t MENU_UPDATE_INTERVAL_MS = 20;
+
+/*
+ * Virtual Device Constants
+*/
+
+/**
+ * \brief Number of simulated devices NMEA2000_CAN1 is set up with.
+ *
+ * Every device costs the NMEA2000 library a device slot (about 200 bytes)
+ * and is created inactive. The first VDEV_POT_DEVICES are the sensors
+ * configured from the menu.
+ *
+ * Default value: 32 devices
+ */
+inline constexpr uint8_t VDEV_DEVICE_COUNT = 32;
+
+/**
+ * \brief Number of devices driven by the three potentiometers by default.
+ *
+ * Default value: 3 devices
+ */
+inline constexpr uint8_t VDEV_POT_DEVICES = 3;
+
+/**
+ * \brief Maximum number of messages staged by one pass of the Sensors task.
+ *
+ * Keeps a pass short when many devices come due together. Devices left
+ * over are staged by the next passes, well within TX_STAGE_LEAD_MS.
+ *
+ * Default value: 4 messages
+ */
+inline constexpr uint8_t VDEV_MAX_STAGED_PER_PASS = 4;
+
+/**
+ * \brief Window the achieved message rate of each device is measured over (in milliseconds).
+ *
+ * Default value: 5000 ms
+ */
+inline constexpr uint32_t VDEV_RATE_WINDOW_MS = 5000;
+
+/**
+ * \brief Shortest transmit interval a device accepts (in milliseconds).
+ *
+ * Default value: 10 ms (100 messages per second)
+ */
+inline constexpr uint32_t SENSOR_MIN_SEND_INTERVAL_MS = 10;
+
+/**
+ * \brief Default period of the ramp, sine and trace value sources (in milliseconds).
+ *
+ * Default value: 10000 ms
+ */
+inline constexpr uint32_t SENSOR_SOURCE_PERIOD_MS = 10000;
+
+/*
+ * Transmit Scheduler Constants
+*/
+
+/**
+ * \brief Period of the CAN1 transmit scheduler interrupt (in microseconds).
+ *
+ * Every tick releases the streams that are due and feeds queued frames to
+ * the driver, so a message goes out at most this late on an idle bus.
+ *
+ * Default value: 100 us
+ */
+inline constexpr uint32_t TX_TICK_US = 100;
+
+/**
+ * \brief Maximum number of transmit streams.
+ *
+ * One per simulated device plus the impersonation attack, with room to spare.
+ *
+ * Default value: 40 streams
+ */
+inline constexpr uint8_t TX_MAX_STREAMS = 40;
+
+/**
+ * \brief Number of frames the CAN1 transmit queue holds.
+ *
+ * Frames wait here between their release and the driver accepting them.
+ * A full 223-byte fast packet takes 32 frames. Must be a power of two.
+ *
+ * Default value: 64 frames
+ */
+inline constexpr uint32_t TX_QUEUE_SIZE = 64;
+
+/**
+ * \brief Number of ticks a frame the driver refuses is retried.
+ *
+ * After that the frame and the rest of its message are dropped and
+ * counted as failed.
+ *
+ * Default value: 50 retries (5 ms at TX_TICK_US)
+ */
+inline constexpr uint8_t TX_MAX_RETRIES = 50;
+
+/**
+ * \brief How long before its slot a stream's next message is built (in milliseconds).
+ *
+ * The message is staged in loop context and sent from the interrupt, so
+ * its values are at most this old. The staging tasks must run more often
+ * than this, or slots are missed.
+ *
+ * Default value: 20 ms
+ */
+inline constexpr uint32_t TX_STAGE_LEAD_MS = 20;
+
+/**
+ * \brief Period of the tasks that stage messages for the transmit scheduler (in milliseconds).
+ *
+ * Used by the Sensors and Attack tasks.
+ *
+ * Default value: 2 ms
+ */
+inline constexpr uint32_t TX_STAGE_INTERVAL_MS = 2;
+
 /*
  * Display Configuration Constants
 */
@@ -155,6 +450,760 @@ inline constexpr int SCROLL_VISIBLE_CHARS = 10;
  */
 inline constexpr int DEVICE_NAME_VISIBLE_CHARS = 12;
 
+/**
+ * \brief Maximum number of display tiles sent per screen flush.
+ *
+ * Bounds the I2C time of one flush. At 400 kHz a tile takes roughly
+ * 0.25 ms, so 16 tiles (one full row) keep a flush near 4 ms. A full
+ * screen change reaches the panel within eight flushes.
+ *
+ * Default value: 16 tiles
+ */
+inline constexpr uint16_t SCREEN_FLUSH_TILE_BUDGET = 16;
+
+/**
+ * \brief Period of the screen flush task (in milliseconds).
+ *
+ * Default value: 10 ms
+ */
+inline constexpr uint32_t SCREEN_FLUSH_INTERVAL_MS = 10;
+
+/**
+ * \brief Display pages (8-pixel rows) of a splash frame sent per step.
+ *
+ * A page is 16 tiles, about 4 ms on the bus, so 2 pages keep one splash
+ * step near 8 ms while a whole frame still goes out within its 35 ms.
+ *
+ * Default value: 2 pages
+ */
+inline constexpr uint8_t SPLASH_PAGES_PER_STEP = 2;
+
+/**
+ * \brief Period of the boot splash task (in milliseconds).
+ *
+ * Default value: 5 ms
+ */
+inline constexpr uint32_t SPLASH_INTERVAL_MS = 5;
+
+/**
+ * \brief Shortest time between two redraws of the field graph (in milliseconds).
+ *
+ * Matches MONITOR_HISTORY_BUCKET_MS, so the graph moves one column per redraw.
+ *
+ * Default value: 500 ms
+ */
+inline constexpr uint32_t MENU_GRAPH_REDRAW_MS = 500;
+
+/**
+ * \brief Display pages (8-pixel rows) of the field graph sent per menu update.
+ *
+ * The graph covers 6 pages, so a redraw reaches the panel within three
+ * menu updates without holding the bus for more than about 8 ms.
+ *
+ * Default value: 2 pages
+ */
+inline constexpr uint8_t MENU_GRAPH_PAGES_PER_STEP = 2;
+
+/*
+ * Network Monitor Storage Constants
+*/
+
+/**
+ * \brief Number of device slots in the network monitor.
+ *
+ * The monitor keeps one slot per valid NMEA2000 source address (0-252) so
+ * a device can be looked up directly by its address. Frames from the null
+ * (254) and global (255) addresses are not tracked.
+ *
+ * Default value: 253 devices
+ */
+inline constexpr int MONITOR_MAX_DEVICES = 253;
+
+/**
+ * \brief Total number of PGN entries shared by all monitored devices.
+ *
+ * PGN entries are taken from a single fixed pool so that a busy device
+ * can use more entries than a quiet one. Once the pool is exhausted, new
+ * PGNs are dropped until stale cleanup frees entries.
+ *
+ * Default value: 384 entries
+ */
+inline constexpr int MONITOR_MAX_PGN_ENTRIES = 384;
+
+/**
+ * \brief Maximum number of PGNs tracked for a single device.
+ *
+ * Limits each device's PGN list and keeps the load factor of its PGN
+ * lookup table at or below 75%.
+ *
+ * Default value: 24 PGNs
+ */
+inline constexpr int MONITOR_MAX_PGNS_PER_DEVICE = 24;
+
+/**
+ * \brief Size of each device's open-addressed PGN lookup table.
+ *
+ * Must be a power of two and larger than MONITOR_MAX_PGNS_PER_DEVICE.
+ *
+ * Default value: 32 slots
+ */
+inline constexpr int MONITOR_PGN_SLOTS_PER_DEVICE = 32;
+
+/**
+ * \brief Maximum number of ISO NAMEs the monitor remembers.
+ *
+ * One record per NAME seen in an address claim, kept when the device moves
+ * to another address or goes stale. A network has at most 50 physical
+ * nodes; the rest is room for spoofed claims.
+ *
+ * Default value: 96 NAMEs
+ */
+inline constexpr int MONITOR_MAX_IDENTITIES = 96;
+
+/**
+ * \brief Size of the open-addressed NAME table.
+ *
+ * Must be a power of two below 256 and larger than MONITOR_MAX_IDENTITIES.
+ *
+ * Default value: 128 slots
+ */
+inline constexpr int MONITOR_IDENTITY_SLOTS = 128;
+
+/*
+ * Stale Expiry Constants
+*/
+
+/**
+ * \brief Width of one stale expiry wheel bucket, as a power of two (in milliseconds).
+ *
+ * Entries expire up to one bucket later than their timeout.
+ *
+ * Default value: 10 (1024 ms)
+ */
+inline constexpr uint32_t MONITOR_EXPIRY_TICK_SHIFT = 10;
+
+/**
+ * \brief Number of buckets in the stale expiry wheel.
+ *
+ * Must be a power of two. One turn of the wheel spans about 65 s, so a
+ * STALE_TIMEOUT_MS entry is checked once per timeout, and a static one
+ * skips its bucket for a few turns.
+ *
+ * Default value: 64 buckets
+ */
+inline constexpr int MONITOR_EXPIRY_SLOTS = 64;
+
+/**
+ * \brief Maximum number of expired entries handled per cleanup run.
+ *
+ * Bounds the time of a run when many devices leave at once, e.g. when a
+ * bus segment is unplugged; the rest follow in the next runs.
+ *
+ * Default value: 32 entries
+ */
+inline constexpr int MONITOR_EXPIRY_MAX_PER_PASS = 32;
+
+/*
+ * Network Statistics Constants
+*/
+
+/**
+ * \brief NMEA2000 bus bit rate used for the bus utilization estimate.
+ *
+ * Default value: 250000 bit/s
+ */
+inline constexpr uint32_t MONITOR_BUS_BITRATE = 250000;
+
+/**
+ * \brief Length of the window the bus-wide rates are averaged over.
+ *
+ * Frames per second, messages per second and bus load are published once
+ * per window. Longer windows give steadier numbers but react more slowly.
+ *
+ * Default value: 1000 ms
+ */
+inline constexpr uint32_t MONITOR_STATS_WINDOW_MS = 1000;
+
+/**
+ * \brief Weight of the newest sample in the per-PGN moving averages.
+ *
+ * The smoothed interval and payload size follow a change in a device's
+ * send rate within roughly 1 / MONITOR_STATS_EWMA_ALPHA messages.
+ *
+ * Default value: 0.125
+ */
+inline constexpr float MONITOR_STATS_EWMA_ALPHA = 0.125f;
+
+/**
+ * \brief Number of multi-frame transfers CAN2 can follow at the same time.
+ *
+ * Every fast packet and ISO transport session in progress takes one slot
+ * of 20 bytes. 256 covers every one of the 252 sources with a transfer
+ * in flight. Must be a power of two.
+ *
+ * Default value: 256 sessions
+ */
+inline constexpr int MONITOR_TRANSFER_SESSIONS = 256;
+
+/**
+ * \brief Number of session table slots looked at per lookup.
+ *
+ * Bounds the per-frame cost. A transfer that finds no free slot within
+ * this many is not followed and counted as such.
+ *
+ * Default value: 16 slots
+ */
+inline constexpr int MONITOR_TRANSFER_PROBES = 16;
+
+/**
+ * \brief Longest gap between two frames of a fast packet (in milliseconds).
+ *
+ * Default value: 750 ms
+ */
+inline constexpr uint32_t MONITOR_FAST_PACKET_TIMEOUT_MS = 750;
+
+/**
+ * \brief Longest gap between two frames of an ISO transport session (in milliseconds).
+ *
+ * ISO 11783-3 allows up to 1250 ms while waiting for data.
+ *
+ * Default value: 1250 ms
+ */
+inline constexpr uint32_t MONITOR_TP_TIMEOUT_MS = 1250;
+
+/**
+ * \brief Number of fields whose value history can be recorded at once.
+ *
+ * Every watched field takes MONITOR_HISTORY_BUCKETS buckets of 16 bytes.
+ *
+ * Default value: 4 fields
+ */
+inline constexpr int MONITOR_HISTORY_FIELDS = 4;
+
+/**
+ * \brief Number of min/max buckets kept per watched field.
+ *
+ * One bucket per pixel column of the graph screen.
+ *
+ * Default value: 128 buckets
+ */
+inline constexpr int MONITOR_HISTORY_BUCKETS = 128;
+
+/**
+ * \brief Time covered by one history bucket (in milliseconds).
+ *
+ * The history spans MONITOR_HISTORY_BUCKETS times this, 64 s by default.
+ * Older buckets are overwritten.
+ *
+ * Default value: 500 ms
+ */
+inline constexpr uint32_t MONITOR_HISTORY_BUCKET_MS = 500;
+
+/*
+ * Anomaly Detection Constants
+*/
+
+/**
+ * \brief Number of alerts kept in the anomaly alert list.
+ *
+ * A repeat of an alert still in the list only bumps its count; once the
+ * list is full the oldest alert is overwritten.
+ *
+ * Default value: 16 alerts
+ */
+inline constexpr int MONITOR_ANOMALY_ALERTS = 16;
+
+/**
+ * \brief Window address claims are counted over (in milliseconds).
+ *
+ * Default value: 1000 ms
+ */
+inline constexpr uint32_t MONITOR_ANOMALY_CLAIM_WINDOW_MS = 1000;
+
+/**
+ * \brief Claims one NAME may send per window before it counts as a claim storm.
+ *
+ * A device claims once at power-up and again when it loses an address
+ * contention, so a handful per second is already unusual.
+ *
+ * Default value: 4 claims
+ */
+inline constexpr uint16_t MONITOR_ANOMALY_CLAIM_LIMIT = 4;
+
+/**
+ * \brief Claims the whole bus may send per window before it counts as a claim storm.
+ *
+ * High enough for every node, NEMO's simulated devices included, to claim
+ * at once after a power-up.
+ *
+ * Default value: 100 claims
+ */
+inline constexpr uint16_t MONITOR_ANOMALY_BUS_CLAIM_LIMIT = 100;
+
+/**
+ * \brief Messages a stream needs before its timing is checked.
+ *
+ * The interval mean and jitter of the first messages are the baseline.
+ *
+ * Default value: 20 messages
+ */
+inline constexpr uint32_t MONITOR_ANOMALY_LEARN_MESSAGES = 20;
+
+/**
+ * \brief Largest jitter, as a share of the mean interval, of a stream whose timing is checked.
+ *
+ * Streams above it are sent on demand rather than periodically.
+ *
+ * Default value: 0.25
+ */
+inline constexpr float MONITOR_ANOMALY_PERIODIC_RATIO = 0.25f;
+
+/**
+ * \brief Standard deviations the smoothed interval may leave the baseline by.
+ *
+ * Default value: 4
+ */
+inline constexpr float MONITOR_ANOMALY_INTERVAL_SIGMAS = 4.0f;
+
+/**
+ * \brief Smallest interval change, as a share of the baseline, that counts.
+ *
+ * Keeps a very regular sender from alerting on a single late message.
+ *
+ * Default value: 0.3
+ */
+inline constexpr float MONITOR_ANOMALY_INTERVAL_RATIO = 0.3f;
+
+/**
+ * \brief Factor the recent jitter may exceed the baseline jitter by.
+ *
+ * Default value: 4
+ */
+inline constexpr float MONITOR_ANOMALY_JITTER_RATIO = 4.0f;
+
+/**
+ * \brief Jitter, as a share of the mean interval, always allowed on top.
+ *
+ * Default value: 0.1
+ */
+inline constexpr float MONITOR_ANOMALY_JITTER_FLOOR = 0.1f;
+
+/**
+ * \brief Raw counts a value may change by on top of its rate limit.
+ *
+ * Covers quantization, so back-to-back messages don't count as jumps.
+ *
+ * Default value: 4 counts
+ */
+inline constexpr float MONITOR_ANOMALY_JUMP_COUNTS = 4.0f;
+
+/**
+ * \brief Number of (PGN, instance) slots of the value conflict table.
+ *
+ * Every slot takes 16 bytes. Must be a power of two.
+ *
+ * Default value: 64 slots
+ */
+inline constexpr int MONITOR_ANOMALY_CONFLICT_SLOTS = 64;
+
+/**
+ * \brief Time two sources' values are compared over (in milliseconds).
+ *
+ * A value older than this is not held against a new source.
+ *
+ * Default value: 2000 ms
+ */
+inline constexpr uint32_t MONITOR_ANOMALY_CONFLICT_WINDOW_MS = 2000;
+
+/*
+ * CAN Capture Constants
+*/
+
+/**
+ * \brief Number of frames the CAN2 capture rings can hold.
+ *
+ * Frames are moved from the CAN controller into a ring by the capture
+ * interrupt and decoded by the decode interrupt, which passes them on to
+ * a second ring of this size for the loop's frame hook. The second ring
+ * must absorb the longest loop stall: at full 250 kbit/s load the bus
+ * carries roughly 1 800 frames per second, so 1024 frames covers stalls of
+ * about half a second. Must be a power of two.
+ *
+ * Default value: 1024 frames
+ */
+inline constexpr uint32_t CAPTURE_RING_SIZE = 1024;
+
+/**
+ * \brief Period of the capture poll interrupt (in microseconds).
+ *
+ * Also the resolution of the frame timestamps. A full 8-byte frame takes
+ * about 500 us on the wire, so 100 us keeps timestamps well below one
+ * frame time.
+ *
+ * Default value: 100 us
+ */
+inline constexpr uint32_t CAPTURE_POLL_INTERVAL_US = 100;
+
+/**
+ * \brief Maximum number of decoded frames, and of messages, dispatched per loop iteration.
+ *
+ * Bounds the time spent in the frame hook and message handler so the user
+ * interface stays responsive while the queues drain after a stall.
+ *
+ * Default value: 64 records
+ */
+inline constexpr uint16_t CAPTURE_BATCH_SIZE = 64;
+
+/**
+ * \brief NVIC priority of the capture stage (0 is highest, steps of 16).
+ *
+ * Applied to the FlexCAN interrupts of both buses and to the PIT, which
+ * every IntervalTimer shares: the capture poll, the transmit scheduler, the
+ * analog sampler and the replay all run at this level and never preempt
+ * each other or the CAN driver. Above the USB and I2C interrupts (128).
+ *
+ * Default value: 64
+ */
+inline constexpr uint8_t CAPTURE_IRQ_PRIORITY = 64;
+
+/**
+ * \brief NVIC priority of the decode stage, a software interrupt.
+ *
+ * Below every hardware interrupt, so USB and the display keep working
+ * while a burst is decoded, but above the loop.
+ *
+ * Default value: 192
+ */
+inline constexpr uint8_t CAPTURE_DECODE_IRQ_PRIORITY = 192;
+
+/**
+ * \brief Size of the queue of decoded messages between decode and the loop (in bytes).
+ *
+ * A record is a 16-byte header plus the data rounded up to 4 bytes, so 24
+ * bytes for a single-frame message: about 340 of them, a few hundred
+ * milliseconds of a fully loaded bus. Must be a power of two.
+ *
+ * Default value: 8192 bytes
+ */
+inline constexpr uint32_t CAPTURE_MESSAGE_QUEUE_SIZE = 8192;
+
+/**
+ * \brief Smoothing factor of the capture stage latencies.
+ *
+ * Default value: 0.05
+ */
+inline constexpr float CAPTURE_LATENCY_ALPHA = 0.05f;
+
+/*
+ * CAN Filter Constants
+*/
+
+/**
+ * \brief Highest PGN the CAN2 filter can hold.
+ *
+ * Covers both data pages (DP 0 and 1), which includes every NMEA2000 PGN.
+ * The PGN bitset takes (CAN_FILTER_MAX_PGN + 1) / 8 bytes of RAM2.
+ *
+ * Default value: 0x1FFFF (131071)
+ */
+inline constexpr uint32_t CAN_FILTER_MAX_PGN = 0x1FFFF;
+
+/*
+ * Serial Console Constants
+*/
+
+/**
+ * \brief Longest command line the serial console accepts (in characters).
+ *
+ * Default value: 96 characters
+ */
+inline constexpr uint8_t CONSOLE_LINE_SIZE = 96;
+
+/**
+ * \brief Maximum number of commands that can be registered with the console.
+ *
+ * Default value: 16 commands
+ */
+inline constexpr uint8_t CONSOLE_MAX_COMMANDS = 16;
+
+/**
+ * \brief Maximum number of words in a console command line.
+ *
+ * Default value: 8 words
+ */
+inline constexpr uint8_t CONSOLE_MAX_ARGS = 8;
+
+/*
+ * Capture Stream Constants
+*/
+
+/**
+ * \brief Size of the USB capture staging buffer (in bytes).
+ *
+ * Captured frames are encoded into this buffer and written to USB in large
+ * chunks instead of one print call per byte. A text candump line is at most
+ * 45 bytes and a binary record 20 bytes, so 8 KB holds well over a hundred
+ * frames while the host is slow to read.
+ *
+ * Default value: 8192 bytes
+ */
+inline constexpr uint32_t CAPTURE_STREAM_BUFFER_SIZE = 8192;
+
+/*
+ * Snapshot Server Constants
+*/
+
+/**
+ * \brief Largest snapshot packet before COBS encoding (in bytes).
+ *
+ * Type, sequence, payload and CRC. Requests longer than this are dropped,
+ * and bulk responses are split into packets of at most this size.
+ *
+ * Default value: 512 bytes
+ */
+inline constexpr uint16_t SNAPSHOT_MAX_PACKET = 512;
+
+/**
+ * \brief Size of the snapshot server's transmit staging buffer (in bytes).
+ *
+ * Holds several encoded packets while the host is slow to read. Bulk
+ * responses wait for room here instead of dropping data.
+ *
+ * Default value: 4096 bytes
+ */
+inline constexpr uint32_t SNAPSHOT_TX_BUFFER_SIZE = 4096;
+
+/**
+ * \brief Number of (device, PGN) pairs a host can subscribe to at once.
+ *
+ * Default value: 16 subscriptions
+ */
+inline constexpr uint8_t SNAPSHOT_MAX_SUBSCRIPTIONS = 16;
+
+/**
+ * \brief Shortest time between two updates of one subscription (in milliseconds).
+ *
+ * Hosts asking for a shorter interval get this one.
+ *
+ * Default value: 20 ms
+ */
+inline constexpr uint16_t SNAPSHOT_MIN_INTERVAL_MS = 20;
+
+/*
+ * Config Store Constants
+*/
+
+/**
+ * \brief Size of one configuration slot in EEPROM (in bytes).
+ *
+ * Holds the header and the saved configuration of the menu sensors.
+ *
+ * Default value: 256 bytes
+ */
+inline constexpr uint16_t CONFIG_SLOT_SIZE = 256;
+
+/**
+ * \brief Number of configuration slots saves rotate through.
+ *
+ * Every save goes to the slot after the newest one, so each slot sees
+ * only a fraction of the writes and the previous save stays valid until
+ * the new one is complete. Slots must fit the 1080 bytes of EEPROM.
+ *
+ * Default value: 4 slots
+ */
+inline constexpr uint8_t CONFIG_SLOT_COUNT = 4;
+
+/**
+ * \brief Time the configuration must stay unchanged before it is saved (in milliseconds).
+ *
+ * Scrolling through message types or manufacturer codes makes one save
+ * once the user stops, not one per button press.
+ *
+ * Default value: 3000 ms
+ */
+inline constexpr uint32_t CONFIG_SAVE_IDLE_MS = 3000;
+
+/**
+ * \brief Bytes of a pending save written per configuration task run.
+ *
+ * Keeps each run short; a full slot is written in a few hundred ms.
+ *
+ * Default value: 32 bytes
+ */
+inline constexpr uint16_t CONFIG_WRITE_CHUNK = 32;
+
+/*
+ * Frame Logger Constants
+*/
+
+/**
+ * \brief Size of each of the two logger RAM buffers (in bytes).
+ *
+ * One buffer fills with frames while the other is written to storage.
+ * A multiple of the 512 byte card sector keeps writes aligned. At full bus
+ * load frames arrive at roughly 30 KB/s, so 16 KB gives the card about half
+ * a second to complete a write before frames are dropped.
+ *
+ * Default value: 16384 bytes
+ */
+inline constexpr uint32_t LOGGER_BUFFER_SIZE = 16384;
+
+/**
+ * \brief Size at which the logger starts a new file (in bytes).
+ *
+ * Keeps individual logs small enough to copy and open easily. Files on the
+ * onboard flash are limited to a quarter of LOGGER_FLASH_SIZE instead.
+ *
+ * Default value: 64 MB
+ */
+inline constexpr uint32_t LOGGER_FILE_SIZE_LIMIT = 64UL * 1024UL * 1024UL;
+
+/**
+ * \brief Maximum time a partly filled buffer is held before it is written (in milliseconds).
+ *
+ * Bounds how much data is lost if power is removed while recording on a
+ * quiet bus.
+ *
+ * Default value: 2000 ms
+ */
+inline constexpr unsigned long LOGGER_FLUSH_INTERVAL_MS = 2000;
+
+/**
+ * \brief Size of the onboard flash area used when no SD card is present (in bytes).
+ *
+ * Taken from the end of the Teensy program flash, so it must leave room
+ * for the firmware itself.
+ *
+ * Default value: 512 KB
+ */
+inline constexpr uint32_t LOGGER_FLASH_SIZE = 512UL * 1024UL;
+
+/*
+ * Capture Replay Constants
+*/
+
+/**
+ * \brief Interval of the replay task that stages frames from the log file (in milliseconds).
+ *
+ * Frames are read ahead into a CAPTURE_RING_SIZE frame ring, so this only
+ * has to keep up on average, not match the frame timing.
+ *
+ * Default value: 2 ms
+ */
+inline constexpr uint32_t REPLAY_SERVICE_INTERVAL_MS = 2;
+
+/**
+ * \brief Maximum number of frames read from the log file per replay task run.
+ *
+ * Bounds the time one run spends on storage reads.
+ *
+ * Default value: 256 frames
+ */
+inline constexpr uint16_t REPLAY_FRAMES_PER_SERVICE = 256;
+
+/**
+ * \brief Maximum number of frames the playback interrupt sends per run.
+ *
+ * Only reached when frames are overdue or at maximum speed.
+ *
+ * Default value: 8 frames
+ */
+inline constexpr uint8_t REPLAY_MAX_BURST = 8;
+
+/**
+ * \brief Shortest wait the playback interrupt arms between runs (in microseconds).
+ *
+ * Also the retry interval when the target cannot take a frame, and the
+ * frame pacing at maximum speed.
+ *
+ * Default value: 5 us
+ */
+inline constexpr uint32_t REPLAY_MIN_WAIT_US = 5;
+
+/**
+ * \brief Longest wait the playback interrupt arms between runs (in microseconds).
+ *
+ * Long quiet periods in a log are covered by several waits, since the
+ * hardware timer cannot count arbitrarily long intervals.
+ *
+ * Default value: 1000000 us (1 s)
+ */
+inline constexpr uint32_t REPLAY_MAX_WAIT_US = 1000000;
+
+/**
+ * \brief Lateness above which a replayed frame counts as late (in microseconds).
+ *
+ * Default value: 50 us
+ */
+inline constexpr uint32_t REPLAY_LATE_THRESHOLD_US = 50;
+
+/**
+ * \brief Maximum number of log files the replay screen can choose from.
+ *
+ * The newest logs are kept when there are more.
+ *
+ * Default value: 16 files
+ */
+inline constexpr uint8_t REPLAY_MAX_FILES = 16;
+
+/*
+ * Profiler Constants
+*/
+
+/**
+ * \brief Number of PGNs the profiler times the parser for separately.
+ *
+ * PGNs seen after the table is full only count towards the parser zone.
+ * Must be a power of two.
+ *
+ * Default value: 32 PGNs
+ */
+inline constexpr uint16_t PROFILER_PGN_SLOTS = 32;
+
+/*
+ * Memory Budget Constants
+*/
+
+/**
+ * \brief Period of the memory budget sampling task (in milliseconds).
+ *
+ * Each sample asks every subsystem for its current use and keeps the peak,
+ * so short bursts between two samples only show in the high-water marks
+ * the buffers keep themselves.
+ *
+ * Default value: 1000 ms
+ */
+inline constexpr uint32_t MEMORY_SAMPLE_INTERVAL_MS = 1000;
+
+/**
+ * \brief Word the free stack area is painted with at boot.
+ *
+ * The deepest word that no longer holds it marks the peak stack use.
+ *
+ * Default value: 0xA5A5A5A5
+ */
+inline constexpr uint32_t MEMORY_STACK_PAINT = 0xA5A5A5A5;
+
+/**
+ * \brief Bytes below the stack pointer left unpainted at boot (in bytes).
+ *
+ * Interrupts are already running while the stack is painted and push
+ * their frames below the stack pointer.
+ *
+ * Default value: 1024 bytes
+ */
+inline constexpr uint32_t MEMORY_STACK_PAINT_MARGIN = 1024;
+
+/**
+ * \brief Resolution of the largest free heap block search (in bytes).
+ *
+ * The search halves the range with trial allocations until it is this
+ * narrow, about 13 allocations for the whole of RAM2.
+ *
+ * Default value: 64 bytes
+ */
+inline constexpr uint32_t MEMORY_HEAP_PROBE_STEP = 64;
+
 /*
  * Attack Controller Constants
 */
@@ -0,0 +1,129 @@
+/**
+ * \file Analog_Sampler.cpp
+ * \brief Implementation of the background ADC sampler
+ *
+ * Contains the round-robin conversion scheduling and the incremental
+ * moving-average filter.
+ */
+
+#include "Analog_Sampler.h"
+
+static_assert((ANALOG_FILTER_SIZE & (ANALOG_FILTER_SIZE - 1)) == 0,
+              "ANALOG_FILTER_SIZE must be a power of two");
+
+Analog_Sampler* Analog_Sampler::instance = nullptr;
+
+Analog_Sampler::Analog_Sampler() {
+    channelCount = 0;
+    currentChannel = 0;
+    converting = false;
+    sampleCount = 0;
+    busyCount = 0;
+
+    for(uint8_t i = 0; i < ANALOG_MAX_CHANNELS; i++) {
+        pins[i] = 0;
+        sampleIndex[i] = 0;
+        sums[i] = 0;
+        filtered[i] = 0;
+    }
+}
+
+int Analog_Sampler::addPin(uint8_t pin) {
+    if(instance == this) return -1;
+
+    // Several sensors can follow the same potentiometer
+    for(uint8_t ch = 0; ch < channelCount; ch++) {
+        if(pins[ch] == pin) return ch;
+    }
+    if(channelCount >= ANALOG_MAX_CHANNELS) return -1;
+
+    pins[channelCount] = pin;
+    return channelCount++;
+}
+
+/**
+ * \brief Configure the ADC and start the sampling interrupt
+ *
+ * The 10-bit resolution matches the 0-1023 range the sensors were built
+ * around. Each ring starts out filled with one blocking reading, so the
+ * first read() already returns the real potentiometer position instead of
+ * ramping up from zero.
+ */
+void Analog_Sampler::begin() {
+    if(channelCount == 0 || instance == this) return;
+
+    adc.adc0->setResolution(10);
+    adc.adc0->setAveraging(ANALOG_HW_AVERAGING);
+    adc.adc0->setConversionSpeed(ADC_CONVERSION_SPEED::MED_SPEED);
+    adc.adc0->setSamplingSpeed(ADC_SAMPLING_SPEED::MED_SPEED);
+
+    for(uint8_t ch = 0; ch < channelCount; ch++) {
+        pinMode(pins[ch], INPUT);
+        uint16_t value = adc.adc0->analogRead(pins[ch]);
+        for(uint8_t i = 0; i < ANALOG_FILTER_SIZE; i++) {
+            samples[ch][i] = value;
+        }
+        sums[ch] = (uint32_t)value * ANALOG_FILTER_SIZE;
+        filtered[ch] = value;
+    }
+
+    currentChannel = 0;
+    converting = false;
+    instance = this;
+    sampleTimer.begin(sampleISR, ANALOG_SAMPLE_INTERVAL_US);
+}
+
+uint16_t Analog_Sampler::read(int channel) const {
+    if(channel < 0 || channel >= channelCount) return 0;
+    return filtered[channel];
+}
+
+void Analog_Sampler::sampleISR() {
+    if(instance != nullptr) {
+        instance->sampleNext();
+    }
+}
+
+/**
+ * \brief Collect the finished conversion and start the next one
+ *
+ * The conversion started on the previous tick has had a full sampling
+ * period to complete, so the interrupt only reads the result register.
+ * If the converter is unexpectedly still busy the tick is skipped and
+ * counted rather than waited out.
+ */
+void Analog_Sampler::sampleNext() {
+    if(converting) {
+        if(!adc.adc0->isComplete()) {
+            busyCount = busyCount + 1;
+            return;
+        }
+        addSample(currentChannel, adc.adc0->readSingle());
+        sampleCount = sampleCount + 1;
+
+        currentChannel++;
+        if(currentChannel >= channelCount) currentChannel = 0;
+    }
+
+    converting = adc.adc0->startSingleRead(pins[currentChannel]);
+}
+
+/**
+ * \brief Add a sample to a channel's ring and publish its average
+ *
+ * Replaces the oldest sample and adjusts the running sum by the
+ * difference, so the average costs the same for any filter size.
+ *
+ * \param channel Channel the sample belongs to
+ * \param value ADC reading
+ */
+void Analog_Sampler::addSample(uint8_t channel, uint16_t value) {
+    uint8_t index = sampleIndex[channel];
+
+    sums[channel] += value;
+    sums[channel] -= samples[channel][index];
+    samples[channel][index] = value;
+    sampleIndex[channel] = (index + 1) & (ANALOG_FILTER_SIZE - 1);
+
+    filtered[channel] = sums[channel] / ANALOG_FILTER_SIZE;
+}
@@ -0,0 +1,128 @@
+/**
+ * \file Analog_Sampler.h
+ * \brief Interrupt-driven background sampling of the sensor potentiometers
+ *
+ * Reading a potentiometer used to block the loop: five analogRead() calls
+ * with a 1 ms delay between them, for each of the three sensors. During
+ * those milliseconds CAN2 was not drained and the buttons were not polled.
+ *
+ * This module moves the sampling off the loop. A periodic IntervalTimer
+ * interrupt collects one finished ADC conversion and starts the next,
+ * moving round-robin over the registered pins, so the interrupt never waits
+ * for the converter. The ADC averages ANALOG_HW_AVERAGING conversions in
+ * hardware, and each pin keeps a ring of the last ANALOG_FILTER_SIZE
+ * samples whose running sum is updated incrementally. Reading the filtered
+ * value is then constant time.
+ *
+ * \note The ADC0 converter belongs to this module once begin() is called.
+ *       Do not use analogRead() elsewhere afterwards.
+ */
+
+#ifndef ANALOG_SAMPLER_H
+#define ANALOG_SAMPLER_H
+
+#include <Arduino.h>
+#include <ADC.h>
+#include "constants.h"
+
+/**
+ * \class Analog_Sampler
+ * \brief Round-robin ADC sampler with a per-pin moving average
+ *
+ * Register all pins with addPin() before calling begin(). Only the sampling
+ * interrupt writes the sample rings; the loop only reads the published
+ * filtered values, which are 16-bit and therefore read atomically.
+ */
+class Analog_Sampler {
+private:
+    static Analog_Sampler* instance;    ///< Instance serviced by the sampling interrupt
+    IntervalTimer sampleTimer;          ///< Timer driving sampleNext()
+    ADC adc;                            ///< Teensy ADC driver
+
+    uint8_t pins[ANALOG_MAX_CHANNELS];  ///< Analog pin of each channel
+    uint8_t channelCount;               ///< Number of registered channels
+    uint8_t currentChannel;             ///< Channel of the running conversion
+    bool converting;                    ///< A conversion has been started
+
+    uint16_t samples[ANALOG_MAX_CHANNELS][ANALOG_FILTER_SIZE];  ///< Recent samples per channel
+    uint8_t sampleIndex[ANALOG_MAX_CHANNELS];                   ///< Oldest sample per channel
+    uint32_t sums[ANALOG_MAX_CHANNELS];                         ///< Running sum of each ring
+    volatile uint16_t filtered[ANALOG_MAX_CHANNELS];            ///< Published moving averages
+
+    volatile uint32_t sampleCount;      ///< Conversions collected since begin()
+    volatile uint32_t busyCount;        ///< Ticks skipped because a conversion was still running
+
+    /**
+     * \brief IntervalTimer entry point
+     *
+     * Static trampoline that forwards to the active instance.
+     */
+    static void sampleISR();
+
+    /**
+     * \brief Collect the finished conversion and start the next one
+     *
+     * Runs in interrupt context every ANALOG_SAMPLE_INTERVAL_US.
+     */
+    void sampleNext();
+
+    /**
+     * \brief Add a sample to a channel's ring and publish its average
+     *
+     * \param channel Channel the sample belongs to
+     * \param value ADC reading
+     */
+    void addSample(uint8_t channel, uint16_t value);
+
+public:
+    /**
+     * \brief Construct a sampler without any channels
+     */
+    Analog_Sampler();
+
+    /**
+     * \brief Register an analog pin
+     *
+     * Must be called before begin(). A pin that is already registered
+     * returns its existing channel.
+     *
+     * \param pin Teensy analog pin number
+     * \return Channel number for read(), or -1 if all channels are in use
+     */
+    int addPin(uint8_t pin);
+
+    /**
+     * \brief Configure the ADC and start the sampling interrupt
+     *
+     * Every ring is pre-filled with a blocking reading, so read() returns
+     * a valid value immediately.
+     */
+    void begin();
+
+    /**
+     * \brief Get the filtered value of a channel
+     *
+     * \param channel Channel number returned by addPin()
+     * \return Moving average of the raw ADC readings (0-1023), 0 for an invalid channel
+     */
+    uint16_t read(int channel) const;
+
+    /**
+     * \brief Get the number of conversions collected
+     *
+     * \return Conversions since begin()
+     */
+    uint32_t getSampleCount() const { return sampleCount; }
+
+    /**
+     * \brief Get the number of ticks that found the ADC still busy
+     *
+     * Non-zero means ANALOG_SAMPLE_INTERVAL_US is too short for the
+     * configured averaging.
+     *
+     * \return Skipped ticks since begin()
+     */
+    uint32_t getBusyCount() const { return busyCount; }
+};
+
+#endif // ANALOG_SAMPLER_H
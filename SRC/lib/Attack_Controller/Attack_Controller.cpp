@@ -19,11 +19,13 @@
  * @param can1 Pointer to the NMEA2000 CAN interface for sending messages
  * @param mon Pointer to the N2K_Monitor for device tracking and PGN data
  * @param sensor Pointer to the Sensor used for reading analog values during impersonation
+ * @param tx Pointer to the TX_Scheduler that sends the spoofed messages
  */
-Attack_Controller::Attack_Controller(tNMEA2000_Teensyx* can1, N2K_Monitor* mon, Sensor* sensor) {
+Attack_Controller::Attack_Controller(tNMEA2000_Teensyx* can1, N2K_Monitor* mon, Sensor* sensor, TX_Scheduler* tx) {
     nmea2000_can1 = can1;
     monitor = mon;
     valueSensor = sensor;
+    txScheduler = tx;
 
     // Spam attack state
     spamAttackActive = false;
@@ -37,9 +39,16 @@ Attack_Controller::Attack_Controller(tNMEA2000_Teensyx* can1, N2K_Monitor* mon,
     impTargetPGN = 0;
     impSelectedFieldIndex = 0;
     impFieldValue = 0.0f;
-    lastImpTime = 0;
     impFieldMin = 0.0f;
     impFieldMax = 100.0f;
+    impStream = txScheduler->addStream();
+    if (impStream >= 0) {
+        txScheduler->setStream(impStream, ATTACK_IMPERSONATE_INTERVAL_MS * 1000, 0);
+    }
+
+    spoof.valid = false;
+    spoof.hasLive = false;
+    spoof.patchCount = 0;
 
     // Initialize per-field lock arrays
     for (int i = 0; i < MAX_IMP_FIELDS; i++) {
@@ -101,21 +110,24 @@ void Attack_Controller::setImpersonatingOwnSensor(bool own, uint8_t sensorIndex)
 }
 
 /**
- * @brief Gets a human-readable status string for the current attack
+ * @brief Gets the memory the controller holds
  *
- * Returns a descriptive string indicating the current attack state,
- * including device name information for impersonate attacks.
+ * The lists grow on the heap when an attack claims addresses or a target
+ * device is picked, and keep their capacity afterwards.
  *
- * @return String Description of current attack ("DOS Attack", "Imp:<device>", or "None")
+ * @return uint32_t Bytes reserved
+ */
+uint32_t Attack_Controller::getReservedBytes() const {
+    return sizeof(Attack_Controller) + claimedAddresses.capacity() * sizeof(uint8_t) +
+           impPGNList.capacity() * sizeof(uint32_t);
+}
+
+/**
+ * @brief Gets the memory holding attack state
  *
- * @note Used for display purposes in the UI to show attack status.
+ * @return uint32_t Bytes in use
  */
-String Attack_Controller::getAttackStatusString() {
-    if (spamAttackActive) return "DOS Attack";
-    if (impersonateActive) {
-        DeviceInfo* device = monitor->getDevice(impTargetAddress);
-        if (device) return "Imp:" + device->name.substring(0, 10);
-        return "Impersonate";
-    }
-    return "None";
+uint32_t Attack_Controller::getUsedBytes() const {
+    return sizeof(Attack_Controller) + claimedAddresses.size() * sizeof(uint8_t) +
+           impPGNList.size() * sizeof(uint32_t);
 }
@@ -15,6 +15,8 @@
 #include <NMEA2000.h>
 #include <NMEA2000_Teensyx.h>
 #include <N2K_Monitor.h>
+#include <TX_Scheduler.h>
+#include <PGN_Helpers.h>
 #include "constants.h"
 
 /**
@@ -30,6 +32,29 @@ enum AttackType {
     ATTACK_IMPERSONATE    ///< Device impersonation attack with spoofed messages
 };
 
+/**
+ * \struct SpoofTemplate
+ * \brief Preformatted spoofed message of the impersonate attack
+ *
+ * Compiled from the target's captured message whenever the attack starts,
+ * the selected field or a lock changes, or the target sends a message that
+ * differs outside the patched fields. Locked fields are already written
+ * into msg; each tick only writes the live field through its patch.
+ */
+struct SpoofTemplate {
+    bool valid;                             ///< msg holds a compiled message
+    tN2kMsg msg;                            ///< Captured message with the locked fields applied
+    uint32_t sourceSequence;                ///< PGNData::sequence the template was checked against
+    bool hasLive;                           ///< The selected field is unlocked and fits the payload
+    PGNFieldPatch live;                     ///< Where the selected field goes
+    int32_t liveRawMin;                     ///< Raw value at the bottom of the field range
+    int32_t liveRawMax;                     ///< Raw value at the top of the field range
+    float liveScale;                        ///< Display units per raw count of the selected field
+    float liveOffset;                       ///< Display value of raw 0 of the selected field
+    PGNFieldPatch patches[MAX_IMP_FIELDS];  ///< Every field written, live one included
+    uint8_t patchCount;                     ///< Entries used in patches
+};
+
 // Forward declaration
 class Sensor;
 
@@ -52,6 +77,7 @@ private:
     tNMEA2000_Teensyx* nmea2000_can1;  // CAN interface for sending attack messages
     N2K_Monitor* monitor;              // Reference to network monitor for device/PGN data
     Sensor* valueSensor;               //Reference to sensor for potentiometer value reading
+    TX_Scheduler* txScheduler;         // Sends the spoofed messages on a precise period
 
     // Spam Attack State
     bool spamAttackActive;             // Flag indicating if spam attack is currently running
@@ -87,10 +113,10 @@ private:
     uint32_t impTargetPGN;             // Target PGN number to spoof
     int impSelectedFieldIndex;         // Currently selected field index for manipulation
     float impFieldValue;               // Current field value (from sensor or locked)
-    unsigned long lastImpTime;         // Timestamp of last impersonate transmission
     float impFieldMin;                 // Minimum value for selected field
     float impFieldMax;                 // Maximum value for selected field
     std::vector<uint32_t> impPGNList;  // List of PGNs available for selected device
+    int impStream;                     // TX_Scheduler stream of the spoofed messages, -1 if none
 
     // Per-field locking for impersonate attack
     bool impFieldLocked[MAX_IMP_FIELDS];        // Lock state per field (MAX_IMP_FIELDS from constants.h)
@@ -100,17 +126,26 @@ private:
     bool impersonatingOwnSensor;       // True if impersonating device's own sensor (Sensor 1/2/3)
     uint8_t impOwnSensorIndex;         // Index of own sensor being impersonated (0, 1, or 2)
 
+    SpoofTemplate spoof;               // Preformatted message staged by updateImpersonate()
+
     /**
-     * \brief Builds a spoofed NMEA2000 message with manipulated field value.
-     * \param N2kMsg Reference to the message object to populate
-     * \param pgn The PGN number of the message to spoof
-     * \param fieldIndex Index of the field to manipulate
-     * \param value The spoofed value to insert into the field
+     * \brief Compiles the spoof template from the target's captured message.
      *
-     * Constructs a complete NMEA2000 message with the specified PGN,
-     * inserting the manipulated value at the designated field position.
+     * Copies the captured payload, writes every locked field and resolves
+     * the patch of the selected field. Leaves the template invalid while the
+     * target hasn't sent the PGN yet.
      */
-    void buildSpoofedMessage(tN2kMsg &N2kMsg, uint32_t pgn, int fieldIndex, float value);
+    void compileSpoofTemplate();
+
+    /**
+     * \brief Checks whether the target sent a message the template doesn't reflect.
+     * \param pgnData The target's PGN entry
+     * \return true if its length or any bit outside the patched fields differs
+     *
+     * Our own spoofed messages come back on CAN2 and only differ inside the
+     * patches, so they never trigger a recompile.
+     */
+    bool spoofSourceChanged(const PGNData& pgnData);
 
 public:
     /**
@@ -118,13 +153,15 @@ public:
      * \param can1 Pointer to the NMEA2000 CAN interface for message transmission
      * \param mon Pointer to the network monitor for device discovery data
      * \param sensor Pointer to the sensor for reading potentiometer values
+     * \param tx Pointer to the CAN1 transmit scheduler
      *
      * Initializes the attack controller with references to required system
      * components. The CAN interface is used for transmitting attack messages,
      * the monitor provides discovered device information, and the sensor
-     * provides real-time value input for impersonation attacks.
+     * provides real-time value input for impersonation attacks. Spoofed
+     * messages are sent through a stream of the transmit scheduler.
      */
-    Attack_Controller(tNMEA2000_Teensyx* can1, N2K_Monitor* mon, Sensor* sensor);
+    Attack_Controller(tNMEA2000_Teensyx* can1, N2K_Monitor* mon, Sensor* sensor, TX_Scheduler* tx);
 
     /**
      * \brief Main update loop for attack processing.
@@ -219,10 +256,12 @@ public:
     void stopImpersonate();
 
     /**
-     * \brief Updates impersonation attack state and sends spoofed messages.
+     * \brief Updates impersonation attack state and stages spoofed messages.
      *
-     * Called internally by update() to handle impersonation timing
-     * and message transmission.
+     * Called internally by update(), which the loop scheduler runs every
+     * TX_STAGE_INTERVAL_MS. Builds the next spoofed message shortly before
+     * its slot; the transmit scheduler sends one every
+     * ATTACK_IMPERSONATE_INTERVAL_MS.
      */
     void updateImpersonate();
 
@@ -332,12 +371,6 @@ public:
      */
     void setImpersonatingOwnSensor(bool own, uint8_t sensorIndex = 0);
 
-    /**
-     * \brief Gets a human-readable string describing the current attack.
-     * \return Status string (e.g., "DOS Attack" or "Imp: DeviceName")
-     */
-    String getAttackStatusString();
-
     
     // Field Range and PGN Utility Methods
     
@@ -354,16 +387,6 @@ public:
      */
     void getFieldRange(uint32_t pgn, int fieldIndex, float &min, float &max);
 
-    /**
-     * \brief Gets the list of editable field names for a PGN.
-     * \param pgn The PGN number to query
-     * \return Vector of field names that can be manipulated
-     *
-     * Returns only fields that can be meaningfully spoofed,
-     * excluding read-only or system fields.
-     */
-    std::vector<String> getEditableFieldNames(uint32_t pgn);
-
     /**
      * \brief Gets the count of editable fields for a PGN.
      * \param pgn The PGN number to query
@@ -395,6 +418,18 @@ public:
      * Returns the count without modifying the internal PGN list.
      */
     int getImpersonatablePGNCount(uint8_t deviceAddress);
+
+    /**
+     * \brief Gets the memory the controller holds.
+     * \return Size of the controller plus the capacity of its lists, in bytes
+     */
+    uint32_t getReservedBytes() const;
+
+    /**
+     * \brief Gets the memory holding attack state.
+     * \return Size of the controller plus the entries in its lists, in bytes
+     */
+    uint32_t getUsedBytes() const;
 };
 
 #endif // ATTACK_CONTROLLER_H
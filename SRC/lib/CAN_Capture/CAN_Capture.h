@@ -0,0 +1,632 @@
+/**
+ * \file CAN_Capture.h
+ * \brief Interrupt-fed receive path for the listen-only CAN2 interface
+ *
+ * Also provides CAN_TxTap, which reports the frames sent on CAN1.
+ *
+ * This module decouples frame reception and decoding from the main loop.
+ * The receive path runs in three stages, each in its own context:
+ * - Capture (CAPTURE_IRQ_PRIORITY): a periodic IntervalTimer interrupt
+ *   pulls every frame the FlexCAN driver has received and pushes it,
+ *   together with a micros() timestamp, into a lock-free
+ *   single-producer/single-consumer ring, then pends the decode interrupt.
+ * - Decode (CAPTURE_DECODE_IRQ_PRIORITY): a software interrupt runs the
+ *   NMEA2000 library on the ring. Every frame it reads goes on to a second
+ *   frame ring, every message it reassembles into a compact record in
+ *   CAN_MessageQueue.
+ * - Dispatch (loop): dispatch() hands the frames to the frame hook and the
+ *   messages to the message handler (monitor, logger, capture output).
+ *
+ * So a slow display redraw or serial write only delays dispatch. Capture
+ * and decode keep up with the bus, and every queue between the stages
+ * exposes its depth, high-water mark and drops, and every stage its
+ * latency (CaptureLatency), so the cost of a stall is visible.
+ *
+ * \note The FlexCAN interrupt itself is owned by the NMEA2000_Teensyx driver,
+ *       so timestamps are taken when our poll interrupt collects the frame.
+ *       They are accurate to within CAPTURE_POLL_INTERVAL_US.
+ */
+
+#ifndef CAN_CAPTURE_H
+#define CAN_CAPTURE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <NMEA2000.h>
+#include <NMEA2000_Teensyx.h>
+#include <CAN_Filter.h>
+#include "constants.h"
+
+/**
+ * \struct CaptureFrame
+ * \brief A single raw CAN frame as received from the bus
+ */
+struct CaptureFrame {
+    uint32_t timestamp;     ///< micros() at the time the frame was collected
+    uint32_t id;            ///< 29-bit extended CAN identifier
+    uint8_t len;            ///< Number of valid data bytes (0-8)
+    uint8_t data[8];        ///< Frame payload
+};
+
+/**
+ * \brief Callback invoked for every raw frame handed to the library
+ *
+ * Runs in loop context from dispatch(), so it sees each frame exactly as
+ * it arrived on the wire, after the library has already read it.
+ */
+typedef void (*CaptureFrameHook)(const CaptureFrame& frame);
+
+/**
+ * \brief Callback invoked for every message the library decoded
+ *
+ * Runs in loop context from dispatch().
+ */
+typedef void (*CaptureMessageHandler)(const tN2kMsg& N2kMsg);
+
+/**
+ * \struct CaptureMessage
+ * \brief Header of a message record in CAN_MessageQueue
+ *
+ * The len data bytes follow the header in the queue.
+ */
+struct CaptureMessage {
+    uint32_t arrival;       ///< Timestamp of the message's last frame (micros)
+    uint32_t msgTime;       ///< MsgTime the library gave the message (millis)
+    uint32_t pgn;           ///< PGN number
+    uint8_t source;         ///< Source address
+    uint8_t destination;    ///< Destination address
+    uint8_t priority;       ///< Priority
+    uint8_t len;            ///< Number of data bytes (up to 223)
+};
+
+/**
+ * \struct CaptureLatency
+ * \brief Latency of one stage of the receive path
+ *
+ * Written by the stage's context only. Every field is a single 32-bit
+ * word, so the loop reads consistent values without disabling interrupts.
+ */
+struct CaptureLatency {
+    volatile uint32_t count;    ///< Samples since the last reset
+    volatile float mean;        ///< Smoothed latency, CAPTURE_LATENCY_ALPHA (micros)
+    volatile uint32_t max;      ///< Longest latency (micros)
+
+    /**
+     * \brief Add a sample
+     *
+     * \param micros Latency of one frame, message or run
+     */
+    void add(uint32_t micros) {
+        mean = count == 0 ? (float)micros : mean + CAPTURE_LATENCY_ALPHA * ((float)micros - mean);
+        if(micros > max) max = micros;
+        count = count + 1;
+    }
+
+    /**
+     * \brief Clear the samples
+     */
+    void reset() {
+        count = 0;
+        mean = 0;
+        max = 0;
+    }
+};
+
+/**
+ * \class CAN_FrameRing
+ * \brief Lock-free single-producer/single-consumer ring of CaptureFrames
+ *
+ * The producer only writes head and the consumer only writes tail, so
+ * neither side needs to disable interrupts whichever contexts they run in
+ * (capture interrupt to decode interrupt, decode interrupt to loop). Indices
+ * run freely and are masked on access, which requires CAPTURE_RING_SIZE
+ * to be a power of two.
+ */
+class CAN_FrameRing {
+private:
+    CaptureFrame frames[CAPTURE_RING_SIZE];  ///< Frame storage
+    std::atomic<uint32_t> head;              ///< Next write index (producer)
+    std::atomic<uint32_t> tail;              ///< Next read index (consumer)
+    volatile uint32_t dropped;               ///< Frames lost because the ring was full
+    volatile uint32_t highWater;             ///< Highest fill level seen
+
+public:
+    /**
+     * \brief Construct an empty ring
+     */
+    CAN_FrameRing();
+
+    /**
+     * \brief Add a frame to the ring (producer side, interrupt context)
+     *
+     * \param frame Frame to copy into the ring
+     * \return true if stored, false if the ring was full and the frame dropped
+     */
+    bool push(const CaptureFrame& frame);
+
+    /**
+     * \brief Remove the oldest frame from the ring (consumer side)
+     *
+     * \param[out] frame Receives the oldest frame
+     * \return true if a frame was returned, false if the ring was empty
+     */
+    bool pop(CaptureFrame& frame);
+
+    /**
+     * \brief Get the number of frames waiting in the ring
+     *
+     * \return Current fill level
+     */
+    uint32_t available() const;
+
+    /**
+     * \brief Get the highest fill level seen since the last reset
+     *
+     * \return High-water mark in frames
+     */
+    uint32_t getHighWater() const { return highWater; }
+
+    /**
+     * \brief Get the number of frames dropped since the last reset
+     *
+     * \return Dropped frame count
+     */
+    uint32_t getDropped() const { return dropped; }
+
+    /**
+     * \brief Clear the high-water mark and dropped counter
+     */
+    void resetStats();
+};
+
+/**
+ * \class CAN_MessageQueue
+ * \brief Lock-free single-producer/single-consumer queue of decoded messages
+ *
+ * Records are a CaptureMessage header followed by the data bytes, padded
+ * to 4 bytes, in a byte ring of CAPTURE_MESSAGE_QUEUE_SIZE. Most NMEA2000
+ * messages have 8 data bytes, so a record is usually 24 bytes rather than
+ * the 240 of a tN2kMsg. A record never wraps: if it doesn't fit before the
+ * end of the ring, the rest of the ring is skipped. Like CAN_FrameRing,
+ * the producer (decode interrupt) only writes head and the consumer (loop)
+ * only writes tail.
+ */
+class CAN_MessageQueue {
+private:
+    uint8_t bytes[CAPTURE_MESSAGE_QUEUE_SIZE] __attribute__((aligned(4)));  ///< Record storage
+    std::atomic<uint32_t> head;              ///< Next write offset, free running (producer)
+    std::atomic<uint32_t> tail;              ///< Next read offset, free running (consumer)
+    volatile uint32_t pushed;                ///< Records stored
+    volatile uint32_t popped;                ///< Records removed
+    volatile uint32_t dropped;               ///< Records lost because the queue was full
+    volatile uint32_t highWater;             ///< Highest fill level seen (bytes)
+
+public:
+    /**
+     * \brief Construct an empty queue
+     */
+    CAN_MessageQueue();
+
+    /**
+     * \brief Add a message to the queue (producer side, interrupt context)
+     *
+     * \param header Message header, len gives the number of data bytes
+     * \param data Data bytes
+     * \return true if stored, false if the queue was full and the message dropped
+     */
+    bool push(const CaptureMessage& header, const uint8_t* data);
+
+    /**
+     * \brief Remove the oldest message from the queue (consumer side)
+     *
+     * \param[out] header Receives the header
+     * \param[out] data Receives the data bytes, at least header.len (up to 223) bytes
+     * \return true if a message was returned, false if the queue was empty
+     */
+    bool pop(CaptureMessage& header, uint8_t* data);
+
+    /**
+     * \brief Get the number of messages waiting in the queue
+     *
+     * \return Current depth in messages
+     */
+    uint32_t available() const { return pushed - popped; }
+
+    /**
+     * \brief Get the number of bytes the waiting messages take
+     *
+     * \return Current fill level in bytes, skipped ends included
+     */
+    uint32_t getUsedBytes() const;
+
+    /**
+     * \brief Get the highest fill level seen since the last reset
+     *
+     * \return High-water mark in bytes
+     */
+    uint32_t getHighWater() const { return highWater; }
+
+    /**
+     * \brief Get the number of messages dropped since the last reset
+     *
+     * \return Dropped message count
+     */
+    uint32_t getDropped() const { return dropped; }
+
+    /**
+     * \brief Clear the high-water mark and dropped counter
+     */
+    void resetStats();
+};
+
+/**
+ * \class CAN_Capture
+ * \brief tNMEA2000_Teensyx interface that receives and decodes in interrupts
+ *
+ * Drop-in replacement for tNMEA2000_Teensyx on the monitoring bus. Opening
+ * the interface starts the poll and decode interrupts. The library's
+ * CANGetFrame() is redirected to the capture ring and its message handler
+ * to the message queue, so the handler given to setMessageHandler() sees
+ * exactly the frames that were captured.
+ *
+ * Call dispatch() from loop() instead of ParseMessages(). The library must
+ * not be called from the loop at all: it belongs to the decode interrupt.
+ */
+class CAN_Capture : public tNMEA2000_Teensyx {
+private:
+    static CAN_Capture* instance;   ///< Instance serviced by the poll and decode interrupts
+    tNMEA2000_Teensyx::tCANDevice captureBus;   ///< CAN controller, selects the FlexCAN interrupt
+    IntervalTimer pollTimer;        ///< Timer driving pollController()
+    CAN_FrameRing ring;             ///< Captured frames waiting for the library (capture -> decode)
+    CAN_FrameRing decodedFrames;    ///< Frames the library read, waiting for the frame hook (decode -> loop)
+    CAN_MessageQueue messages;      ///< Messages the library decoded, waiting for the handler (decode -> loop)
+    volatile uint32_t receivedCount;///< Frames collected from the controller
+    volatile uint32_t filteredCount;///< Frames rejected by the filter
+    const CAN_Filter* filter;       ///< Optional source/PGN filter applied before the ring
+    volatile bool receivePaused;    ///< Discard bus traffic, e.g. while a capture is replayed
+    volatile uint32_t consumedCount;///< Frames handed to the library
+    uint32_t decodeFrameTime;       ///< Timestamp of the frame the library read last (decode context)
+    uint32_t lastFrameTime;         ///< Arrival of the message being dispatched (loop context)
+    uint32_t openTime;              ///< micros() when the poll interrupt was started
+    volatile uint32_t firstFrameTime;   ///< Timestamp of the first frame collected
+    volatile bool firstFrameSeen;   ///< A frame has been collected since Open()
+    bool decodeEnabled;             ///< The decode interrupt was enabled by dispatch()
+    CaptureFrameHook frameHook;     ///< Optional raw frame observer
+    CaptureMessageHandler messageHandler;   ///< Handler of the decoded messages, called from dispatch()
+
+    CaptureLatency decodeWait;      ///< Capture to the library reading the frame
+    CaptureLatency decodeRun;       ///< Run time of the decode interrupt
+    CaptureLatency hookLatency;     ///< Capture to the frame hook
+    CaptureLatency handlerLatency;  ///< Last frame of a message to its handler
+
+    /**
+     * \brief IntervalTimer entry point
+     *
+     * Static trampoline that forwards to the active instance.
+     */
+    static void pollISR();
+
+    /**
+     * \brief Move all frames from the driver into the ring
+     *
+     * Runs in interrupt context every CAPTURE_POLL_INTERVAL_US.
+     */
+    void pollController();
+
+    /**
+     * \brief Software interrupt entry point
+     *
+     * Static trampoline that forwards to the active instance.
+     */
+    static void decodeISR();
+
+    /**
+     * \brief Run the library on the captured frames
+     *
+     * Runs in the decode interrupt, pended by capture and by dispatch().
+     */
+    void decode();
+
+    /**
+     * \brief Library message handler, queues a decoded message
+     *
+     * Runs in the decode interrupt, from ParseMessages().
+     *
+     * \param N2kMsg Message the library reassembled
+     */
+    static void queueMessage(const tN2kMsg &N2kMsg);
+
+protected:
+    /**
+     * \brief Open the CAN controller and start the poll interrupt
+     *
+     * \return true if the controller was opened
+     */
+    bool CANOpen() override;
+
+    /**
+     * \brief Provide the next captured frame to the NMEA2000 library
+     *
+     * \param[out] id 29-bit CAN identifier
+     * \param[out] len Number of data bytes
+     * \param[out] buf Buffer receiving up to 8 data bytes
+     * \return true if a frame was available
+     */
+    bool CANGetFrame(unsigned long &id, unsigned char &len, unsigned char *buf) override;
+
+public:
+    /**
+     * \brief Construct a capture interface on the given CAN controller
+     *
+     * \param bus CAN controller to use (e.g. tNMEA2000_Teensyx::CAN2)
+     */
+    CAN_Capture(tNMEA2000_Teensyx::tCANDevice bus);
+
+    /**
+     * \brief Hand decoded frames and messages to the loop in a bounded batch
+     *
+     * Gives up to maxRecords frames to the frame hook and up to maxRecords
+     * messages to the message handler, then pends the decode interrupt so
+     * the library's housekeeping keeps working on an idle bus.
+     *
+     * \param maxRecords Upper limit of frames, and of messages, in this call
+     */
+    void dispatch(uint16_t maxRecords = CAPTURE_BATCH_SIZE);
+
+    /**
+     * \brief Register a callback that receives every raw frame
+     *
+     * Used by the capture streaming output, which needs the individual CAN
+     * frames rather than the reassembled NMEA2000 messages.
+     *
+     * \param hook Function to call, or nullptr to remove the hook
+     */
+    void setFrameHook(CaptureFrameHook hook) { frameHook = hook; }
+
+    /**
+     * \brief Register the handler of the decoded messages
+     *
+     * Use this instead of SetMsgHandler(): the library's own handler queues
+     * the messages for dispatch().
+     *
+     * \param handler Function to call from dispatch(), or nullptr
+     */
+    void setMessageHandler(CaptureMessageHandler handler) { messageHandler = handler; }
+
+    /**
+     * \brief Apply a source/PGN filter to received frames
+     *
+     * Rejected frames are dropped by the poll interrupt before they enter
+     * the ring, so they cost no parsing, logging or capture output.
+     *
+     * \param captureFilter Filter to apply, or nullptr to keep every frame
+     */
+    void setFilter(const CAN_Filter* captureFilter) { filter = captureFilter; }
+
+    /**
+     * \brief Get the number of frames rejected by the filter
+     *
+     * \return Filtered frame count since startup
+     */
+    uint32_t getFilteredCount() const { return filteredCount; }
+
+    /**
+     * \brief Stop or resume taking frames from the bus
+     *
+     * While paused the poll interrupt still empties the controller but
+     * discards the frames, so only injected frames reach the library.
+     *
+     * \param paused true to discard bus traffic
+     */
+    void setReceivePaused(bool paused) { receivePaused = paused; }
+
+    /**
+     * \brief Check whether bus traffic is being discarded
+     *
+     * \return true while paused
+     */
+    bool isReceivePaused() const { return receivePaused; }
+
+    /**
+     * \brief Add a frame to the ring as if it had been received
+     *
+     * The frame goes through the filter and is stamped with the current
+     * time like a received one.
+     *
+     * \warning The ring has a single producer. Only call this from an
+     *          IntervalTimer interrupt: all of them share the PIT interrupt
+     *          with the poll timer, so they can never preempt each other.
+     *
+     * \param frame Frame to inject; its timestamp is ignored
+     * \return false if the ring was full and the frame was not stored
+     */
+    bool injectFrame(const CaptureFrame& frame);
+
+    /**
+     * \brief Get the frame ring for inspection
+     *
+     * \return Reference to the CAN_FrameRing between capture and decode
+     */
+    CAN_FrameRing& getRing() { return ring; }
+
+    /**
+     * \brief Get the ring of decoded frames for inspection
+     *
+     * \return Reference to the CAN_FrameRing between decode and the frame hook
+     */
+    CAN_FrameRing& getDecodedFrames() { return decodedFrames; }
+
+    /**
+     * \brief Get the message queue for inspection
+     *
+     * \return Reference to the CAN_MessageQueue between decode and the handler
+     */
+    CAN_MessageQueue& getMessages() { return messages; }
+
+    /**
+     * \brief Get the latency from capture to the library reading a frame
+     *
+     * \return Latency of the capture ring
+     */
+    const CaptureLatency& getDecodeWait() const { return decodeWait; }
+
+    /**
+     * \brief Get the run time of the decode interrupt
+     *
+     * \return Time per run, all frames waiting included
+     */
+    const CaptureLatency& getDecodeRun() const { return decodeRun; }
+
+    /**
+     * \brief Get the latency from capture to the frame hook
+     *
+     * \return Latency of capture, decode and the decoded frame ring
+     */
+    const CaptureLatency& getHookLatency() const { return hookLatency; }
+
+    /**
+     * \brief Get the latency from the last frame of a message to its handler
+     *
+     * \return Latency of capture, decode and the message queue
+     */
+    const CaptureLatency& getHandlerLatency() const { return handlerLatency; }
+
+    /**
+     * \brief Clear the high-water marks, drop counters and latencies
+     */
+    void resetStats();
+
+    /**
+     * \brief Get the total number of frames collected from the controller
+     *
+     * \return Received frame count, including dropped frames
+     */
+    uint32_t getReceivedCount() const { return receivedCount; }
+
+    /**
+     * \brief Get the arrival time of the message being dispatched
+     *
+     * Valid inside the message handler: the timestamp of the last frame of
+     * the message.
+     *
+     * \return micros() timestamp of the frame
+     */
+    uint32_t getLastFrameTime() const { return lastFrameTime; }
+
+    /**
+     * \brief Get when capture started
+     *
+     * \return micros() timestamp of Open(), 0 if not opened yet
+     */
+    uint32_t getOpenTime() const { return openTime; }
+
+    /**
+     * \brief Check whether any frame has been collected since Open()
+     *
+     * \return true once the first frame came off the bus
+     */
+    bool hasFirstFrame() const { return firstFrameSeen; }
+
+    /**
+     * \brief Get the timestamp of the first frame collected from the bus
+     *
+     * Taken before the filter, so it measures how soon capture was up
+     * whatever the filter keeps. micros() counts from reset, so this is
+     * also the time from power-on to the first captured frame.
+     *
+     * \return micros() timestamp, only valid if hasFirstFrame()
+     */
+    uint32_t getFirstFrameTime() const { return firstFrameTime; }
+};
+
+/**
+ * \class CAN_TxTap
+ * \brief tNMEA2000_Teensyx interface that reports every frame it transmits
+ *
+ * Drop-in replacement for tNMEA2000_Teensyx on the transmitting bus. Each
+ * frame the driver accepts is passed to the frame hook, so sensor and attack
+ * traffic can be recorded alongside the captured traffic.
+ *
+ * It also flags while the library is inside the driver, so the transmit
+ * scheduler interrupt never enters the driver on top of it.
+ */
+class CAN_TxTap : public tNMEA2000_Teensyx {
+private:
+    tNMEA2000_Teensyx::tCANDevice transmitBus;  ///< CAN controller, selects the FlexCAN interrupt
+    CaptureFrameHook frameHook;     ///< Optional transmitted frame observer
+    volatile bool sending;          ///< The library is inside the driver's send path
+
+protected:
+    /**
+     * \brief Open the CAN controller at the capture interrupt priority
+     *
+     * The transmit scheduler sends from the PIT interrupt, which runs at
+     * CAPTURE_IRQ_PRIORITY with the capture poll. Raising the FlexCAN
+     * interrupt to the same level keeps the scheduler from preempting the
+     * driver's own interrupt.
+     *
+     * \return true if the controller was opened
+     */
+    bool CANOpen() override;
+
+    /**
+     * \brief Send a frame and report it to the frame hook
+     *
+     * \param id 29-bit CAN identifier
+     * \param len Number of data bytes
+     * \param buf Data bytes
+     * \param wait_sent Passed through to the driver
+     * \return true if the driver accepted the frame
+     */
+    bool CANSendFrame(unsigned long id, unsigned char len, const unsigned char *buf, bool wait_sent = true) override;
+
+public:
+    /**
+     * \brief Construct a transmit interface on the given CAN controller
+     *
+     * \param bus CAN controller to use (e.g. tNMEA2000_Teensyx::CAN1)
+     */
+    CAN_TxTap(tNMEA2000_Teensyx::tCANDevice bus);
+
+    /**
+     * \brief Register a callback that receives every transmitted frame
+     *
+     * \param hook Function to call, or nullptr to remove the hook
+     */
+    void setFrameHook(CaptureFrameHook hook) { frameHook = hook; }
+
+    /**
+     * \brief Get the callback that receives every transmitted frame
+     *
+     * \return Current hook, or nullptr if none is set
+     */
+    CaptureFrameHook getFrameHook() const { return frameHook; }
+
+    /**
+     * \brief Check whether the library is sending a frame right now
+     *
+     * Only meaningful in interrupt context: true means the interrupt
+     * preempted the library inside the driver, so it must not send.
+     *
+     * \return true while the library is inside the driver's send path
+     */
+    bool isSending() const { return sending; }
+
+    /**
+     * \brief Send a raw frame without reporting it to the frame hook
+     *
+     * Used by the capture replay and the transmit scheduler, which run in
+     * interrupt context where the hook (the logger) must not be called. The caller has to make sure
+     * the NMEA2000 library is not transmitting on this bus at the same time.
+     *
+     * \param id 29-bit CAN identifier
+     * \param len Number of data bytes
+     * \param buf Data bytes
+     * \return true if the driver accepted the frame
+     */
+    bool sendRawFrame(unsigned long id, unsigned char len, const unsigned char *buf) {
+        return tNMEA2000_Teensyx::CANSendFrame(id, len, buf, false);
+    }
+};
+
+#endif // CAN_CAPTURE_H
@@ -0,0 +1,122 @@
+/**
+ * \file CAN_Filter.cpp
+ * \brief Implementation of the CAN2 source and PGN filter sets
+ *
+ * Contains the bitset editing and listing functions. The per-frame test
+ * is inline in the header so the poll interrupt doesn't pay for a call.
+ */
+
+#include "CAN_Filter.h"
+
+#ifndef DMAMEM
+#define DMAMEM
+#endif
+
+static_assert(((CAN_FILTER_MAX_PGN + 1) & 31) == 0,
+              "CAN_FILTER_MAX_PGN + 1 must be a multiple of 32");
+
+/* ---------------------------------------------------------------------------
+ * Bitset storage
+ *
+ * 16 KB for the PGN bitset is too much for the tightly coupled RAM1, so it
+ * lives in DMAMEM. DMAMEM is not zeroed at startup; the constructor clears it.
+ * ------------------------------------------------------------------------- */
+
+DMAMEM static uint32_t pgnFilterBits[(CAN_FILTER_MAX_PGN + 1) / 32];
+
+CAN_Filter::CAN_Filter() {
+    pgnBits = pgnFilterBits;
+    sourceMode = FILTER_OFF;
+    pgnMode = FILTER_OFF;
+    memset(sourceBits, 0, sizeof(sourceBits));
+    memset(pgnBits, 0, PGN_WORDS * sizeof(uint32_t));
+    sourceCount = 0;
+    pgnCount = 0;
+}
+
+void CAN_Filter::addSource(uint8_t source) {
+    if(hasSource(source)) return;
+    sourceBits[source >> 5] |= (1UL << (source & 31));
+    sourceCount++;
+}
+
+void CAN_Filter::removeSource(uint8_t source) {
+    if(!hasSource(source)) return;
+    sourceBits[source >> 5] &= ~(1UL << (source & 31));
+    sourceCount--;
+}
+
+bool CAN_Filter::addPGN(uint32_t pgn) {
+    if(pgn > CAN_FILTER_MAX_PGN) return false;
+    if(hasPGN(pgn)) return true;
+    pgnBits[pgn >> 5] |= (1UL << (pgn & 31));
+    pgnCount++;
+    return true;
+}
+
+void CAN_Filter::removePGN(uint32_t pgn) {
+    if(!hasPGN(pgn)) return;
+    pgnBits[pgn >> 5] &= ~(1UL << (pgn & 31));
+    pgnCount--;
+}
+
+/**
+ * \brief Empty both sets and turn them off
+ *
+ * The modes are switched off first, so the poll interrupt never applies an
+ * ALLOW set that is half cleared.
+ */
+void CAN_Filter::clear() {
+    sourceMode = FILTER_OFF;
+    pgnMode = FILTER_OFF;
+    memset(sourceBits, 0, sizeof(sourceBits));
+    memset(pgnBits, 0, PGN_WORDS * sizeof(uint32_t));
+    sourceCount = 0;
+    pgnCount = 0;
+}
+
+int CAN_Filter::getSources(uint8_t* out, int maxCount) const {
+    int count = 0;
+    for(int source = 0; source < 256 && count < maxCount; source++) {
+        if(hasSource(source)) out[count++] = source;
+    }
+    return count;
+}
+
+int CAN_Filter::getPGNs(uint32_t* out, int maxCount) const {
+    int count = 0;
+    for(uint32_t word = 0; word < PGN_WORDS && count < maxCount; word++) {
+        uint32_t bits = pgnBits[word];
+        while(bits != 0 && count < maxCount) {
+            uint32_t bit = __builtin_ctz(bits);
+            out[count++] = word * 32 + bit;
+            bits &= bits - 1;
+        }
+    }
+    return count;
+}
+
+FilterEnforcement CAN_Filter::getSourceEnforcement() const {
+    return sourceMode == FILTER_OFF ? FILTER_ENFORCED_NONE : FILTER_ENFORCED_SOFTWARE;
+}
+
+FilterEnforcement CAN_Filter::getPGNEnforcement() const {
+    return pgnMode == FILTER_OFF ? FILTER_ENFORCED_NONE : FILTER_ENFORCED_SOFTWARE;
+}
+
+const char* CAN_Filter::getModeName(FilterMode mode) {
+    switch(mode) {
+        case FILTER_OFF:   return "OFF";
+        case FILTER_ALLOW: return "ALLOW";
+        case FILTER_DENY:  return "DENY";
+        default:           return "?";
+    }
+}
+
+const char* CAN_Filter::getEnforcementName(FilterEnforcement enforcement) {
+    switch(enforcement) {
+        case FILTER_ENFORCED_SOFTWARE: return "SW";
+        case FILTER_ENFORCED_HARDWARE: return "HW";
+        default:                       return "-";
+    }
+}
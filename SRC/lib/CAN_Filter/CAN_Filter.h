@@ -0,0 +1,275 @@
+/**
+ * \file CAN_Filter.h
+ * \brief Source address and PGN filtering for the CAN2 monitor
+ *
+ * When only a few PGNs or a single misbehaving device are of interest,
+ * every other frame still used to go through fast-packet reassembly, the
+ * message handler, the logger and the capture output. CAN_Filter lets
+ * CAN2 keep only the interesting frames.
+ *
+ * There are two independent sets, one of source addresses and one of PGNs.
+ * Each set has a mode:
+ * - FILTER_OFF:   the set is ignored
+ * - FILTER_ALLOW: only frames whose value is in the set pass
+ * - FILTER_DENY:  frames whose value is in the set are dropped
+ *
+ * A frame has to pass both sets. Both are stored as bitsets, so testing a
+ * frame takes two bit lookups however many entries the sets hold.
+ *
+ * The filter is applied by the CAN_Capture poll interrupt, before a frame
+ * enters the capture ring. Rejected frames never reach the library, the
+ * frame hook or the message handler.
+ *
+ * \note The FlexCAN mailboxes are configured by the NMEA2000_Teensyx
+ *       driver, which has no acceptance filter interface. All sets are
+ *       therefore enforced in software, see getSourceEnforcement().
+ */
+
+#ifndef CAN_FILTER_H
+#define CAN_FILTER_H
+
+#include <Arduino.h>
+#include "constants.h"
+
+/**
+ * \enum FilterMode
+ * \brief How a filter set is applied
+ */
+enum FilterMode : uint8_t {
+    FILTER_OFF,         ///< Set is ignored
+    FILTER_ALLOW,       ///< Only values in the set pass
+    FILTER_DENY,        ///< Values in the set are dropped
+    FILTER_MODE_COUNT   ///< Number of modes, not a valid mode
+};
+
+/**
+ * \enum FilterEnforcement
+ * \brief Where a filter set takes effect
+ */
+enum FilterEnforcement : uint8_t {
+    FILTER_ENFORCED_NONE,       ///< Set is off, nothing is filtered
+    FILTER_ENFORCED_SOFTWARE,   ///< Applied by the capture poll interrupt
+    FILTER_ENFORCED_HARDWARE    ///< Applied by the FlexCAN acceptance filters
+};
+
+/**
+ * \class CAN_Filter
+ * \brief Allow/deny sets of source addresses and PGNs
+ *
+ * accepts() is called from interrupt context while the sets may be edited
+ * from the loop. Every edit is a single word write, so the interrupt sees
+ * either the old or the new state of an entry, never a torn one.
+ */
+class CAN_Filter {
+private:
+    static constexpr uint32_t PGN_WORDS = (CAN_FILTER_MAX_PGN + 1) / 32;    ///< Words in the PGN bitset
+
+    volatile FilterMode sourceMode;     ///< Mode of the source address set
+    volatile FilterMode pgnMode;        ///< Mode of the PGN set
+    uint32_t sourceBits[8];             ///< One bit per source address
+    uint32_t* pgnBits;                  ///< One bit per PGN (in RAM2)
+    uint16_t sourceCount;               ///< Addresses in the source set
+    uint32_t pgnCount;                  ///< PGNs in the PGN set
+
+    /**
+     * \brief Check whether one set lets a value through
+     *
+     * \param mode Mode of the set
+     * \param inSet true if the value is in the set
+     * \return true if the value passes
+     */
+    static bool passes(FilterMode mode, bool inSet) {
+        if(mode == FILTER_ALLOW) return inSet;
+        if(mode == FILTER_DENY) return !inSet;
+        return true;
+    }
+
+public:
+    /**
+     * \brief Construct a filter with both sets empty and off
+     */
+    CAN_Filter();
+
+    /**
+     * \brief Get the PGN carried by a 29-bit NMEA2000 identifier
+     *
+     * For PDU1 (PF < 240) the PS byte is a destination address and not
+     * part of the PGN.
+     *
+     * \param id 29-bit CAN identifier
+     * \return PGN including the data page bit
+     */
+    static uint32_t getPGN(uint32_t id) {
+        uint32_t pf = (id >> 16) & 0xFF;
+        uint32_t pgn = (id >> 8) & 0x1FFFF;
+        if(pf < 240) pgn &= 0x1FF00;
+        return pgn;
+    }
+
+    /**
+     * \brief Check whether a frame passes the filter
+     *
+     * \param id 29-bit CAN identifier
+     * \return true if the frame should be kept
+     */
+    bool accepts(uint32_t id) const {
+        uint8_t source = id & 0xFF;
+        if(!passes(sourceMode, hasSource(source))) return false;
+        if(pgnMode == FILTER_OFF) return true;
+        return passes(pgnMode, hasPGN(getPGN(id)));
+    }
+
+    /**
+     * \brief Check whether any set is active
+     *
+     * \return true if at least one set is not FILTER_OFF
+     */
+    bool isActive() const { return sourceMode != FILTER_OFF || pgnMode != FILTER_OFF; }
+
+    /**
+     * \brief Set the mode of the source address set
+     *
+     * \param mode New mode
+     */
+    void setSourceMode(FilterMode mode) { if(mode < FILTER_MODE_COUNT) sourceMode = mode; }
+
+    /**
+     * \brief Get the mode of the source address set
+     *
+     * \return Current mode
+     */
+    FilterMode getSourceMode() const { return sourceMode; }
+
+    /**
+     * \brief Set the mode of the PGN set
+     *
+     * \param mode New mode
+     */
+    void setPGNMode(FilterMode mode) { if(mode < FILTER_MODE_COUNT) pgnMode = mode; }
+
+    /**
+     * \brief Get the mode of the PGN set
+     *
+     * \return Current mode
+     */
+    FilterMode getPGNMode() const { return pgnMode; }
+
+    /**
+     * \brief Add a source address to the source set
+     *
+     * \param source Source address (0-255)
+     */
+    void addSource(uint8_t source);
+
+    /**
+     * \brief Remove a source address from the source set
+     *
+     * \param source Source address (0-255)
+     */
+    void removeSource(uint8_t source);
+
+    /**
+     * \brief Check whether a source address is in the source set
+     *
+     * \param source Source address (0-255)
+     * \return true if the address is in the set
+     */
+    bool hasSource(uint8_t source) const { return (sourceBits[source >> 5] >> (source & 31)) & 1; }
+
+    /**
+     * \brief Add a PGN to the PGN set
+     *
+     * \param pgn PGN to add
+     * \return false if pgn is above CAN_FILTER_MAX_PGN
+     */
+    bool addPGN(uint32_t pgn);
+
+    /**
+     * \brief Remove a PGN from the PGN set
+     *
+     * \param pgn PGN to remove
+     */
+    void removePGN(uint32_t pgn);
+
+    /**
+     * \brief Check whether a PGN is in the PGN set
+     *
+     * \param pgn PGN to look up
+     * \return true if the PGN is in the set
+     */
+    bool hasPGN(uint32_t pgn) const {
+        if(pgn > CAN_FILTER_MAX_PGN) return false;
+        return (pgnBits[pgn >> 5] >> (pgn & 31)) & 1;
+    }
+
+    /**
+     * \brief Empty both sets and turn them off
+     */
+    void clear();
+
+    /**
+     * \brief Get the number of addresses in the source set
+     *
+     * \return Source set size
+     */
+    uint16_t getSourceCount() const { return sourceCount; }
+
+    /**
+     * \brief Get the number of PGNs in the PGN set
+     *
+     * \return PGN set size
+     */
+    uint32_t getPGNCount() const { return pgnCount; }
+
+    /**
+     * \brief List the addresses in the source set
+     *
+     * \param[out] out Receives the addresses in ascending order
+     * \param maxCount Size of out
+     * \return Number of addresses written
+     */
+    int getSources(uint8_t* out, int maxCount) const;
+
+    /**
+     * \brief List the PGNs in the PGN set
+     *
+     * Scans the whole bitset, so only use it for output, not per frame.
+     *
+     * \param[out] out Receives the PGNs in ascending order
+     * \param maxCount Size of out
+     * \return Number of PGNs written
+     */
+    int getPGNs(uint32_t* out, int maxCount) const;
+
+    /**
+     * \brief Get where the source set is enforced
+     *
+     * \return FILTER_ENFORCED_NONE when off, otherwise where it is applied
+     */
+    FilterEnforcement getSourceEnforcement() const;
+
+    /**
+     * \brief Get where the PGN set is enforced
+     *
+     * \return FILTER_ENFORCED_NONE when off, otherwise where it is applied
+     */
+    FilterEnforcement getPGNEnforcement() const;
+
+    /**
+     * \brief Get a short display name for a mode
+     *
+     * \param mode Mode to name
+     * \return "OFF", "ALLOW" or "DENY"
+     */
+    static const char* getModeName(FilterMode mode);
+
+    /**
+     * \brief Get a short display name for an enforcement
+     *
+     * \param enforcement Enforcement to name
+     * \return "-", "SW" or "HW"
+     */
+    static const char* getEnforcementName(FilterEnforcement enforcement);
+};
+
+#endif // CAN_FILTER_H
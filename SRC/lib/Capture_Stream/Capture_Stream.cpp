@@ -0,0 +1,331 @@
+/**
+ * \file Capture_Stream.cpp
+ * \brief Implementation of the USB capture output
+ *
+ * Contains the candump and GVRET encoders, the non-blocking flush and the
+ * small subset of the GVRET command set that SavvyCAN needs to connect.
+ */
+
+#include "Capture_Stream.h"
+#include <Zone_Profiler.h>
+
+#ifndef DMAMEM
+#define DMAMEM
+#endif
+
+/**
+ * \brief Staging buffer of the capture output
+ *
+ * Written and drained front to back, which the RAM2 cache handles well, so
+ * it lives in DMAMEM and leaves the DTCM to the capture rings.
+ */
+DMAMEM static uint8_t streamBuffer[CAPTURE_STREAM_BUFFER_SIZE] __attribute__((aligned(32)));
+
+/* ---------------------------------------------------------------------------
+ * GVRET protocol
+ * ------------------------------------------------------------------------- */
+
+#define GVRET_ENABLE_BINARY     0xE7    ///< Host request to switch to binary mode
+#define GVRET_COMMAND           0xF1    ///< Start of every binary command and record
+
+#define GVRET_BUILD_CAN_FRAME   0x00
+#define GVRET_TIME_SYNC         0x01
+#define GVRET_SETUP_CANBUS      0x05
+#define GVRET_GET_CANBUS_PARAMS 0x06
+#define GVRET_GET_DEVICE_INFO   0x07
+#define GVRET_SET_SINGLEWIRE    0x08
+#define GVRET_KEEPALIVE         0x09
+#define GVRET_SET_SYSTYPE       0x0A
+#define GVRET_ECHO_CAN_FRAME    0x0B
+#define GVRET_GET_NUMBUSES      0x0C
+
+/// Parser states for bytes coming from the host
+#define HOST_IDLE       0
+#define HOST_COMMAND    1
+#define HOST_PAYLOAD    2
+
+/// NMEA2000 bit rate reported to the host
+static constexpr uint32_t GVRET_BUS_SPEED = 250000;
+
+/// Largest encoded record: candump line with 8 data bytes
+static constexpr uint32_t MAX_RECORD_LEN = 48;
+
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+static void putUint32(uint8_t* out, uint32_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = (value >> 24) & 0xFF;
+}
+
+/* ---------------------------------------------------------------------------
+ * Capture_Stream
+ * ------------------------------------------------------------------------- */
+
+Capture_Stream::Capture_Stream(Stream* serialPort, CaptureMode initialMode) {
+    port = serialPort;
+    mode = initialMode;
+    buffer = streamBuffer;
+    bufferLen = 0;
+    framesWritten = 0;
+    framesDropped = 0;
+    hostState = HOST_IDLE;
+    hostCommand = 0;
+    hostPayloadLen = 0;
+    hostPayloadNeeded = 0;
+    textHook = nullptr;
+}
+
+const char* Capture_Stream::getModeName(CaptureMode captureMode) {
+    switch(captureMode) {
+        case CAPTURE_MODE_OFF:     return "OFF";
+        case CAPTURE_MODE_CANDUMP: return "CANDUMP";
+        case CAPTURE_MODE_GVRET:   return "GVRET";
+        default:                   return "?";
+    }
+}
+
+void Capture_Stream::setMode(CaptureMode newMode) {
+    if(newMode >= CAPTURE_MODE_COUNT || newMode == mode) return;
+    mode = newMode;
+    bufferLen = 0;
+}
+
+/**
+ * \brief Queue a captured frame for output
+ *
+ * A frame is either encoded completely or dropped completely, so the host
+ * never receives a truncated record.
+ *
+ * \param frame Frame exactly as received
+ */
+void Capture_Stream::addFrame(const CaptureFrame& frame) {
+    if(mode == CAPTURE_MODE_OFF) return;
+
+    if(!reserve(MAX_RECORD_LEN)) {
+        framesDropped++;
+        return;
+    }
+
+    PROFILE_ZONE(PROFILE_CAPTURE_ENCODE);
+    if(mode == CAPTURE_MODE_GVRET) {
+        encodeGVRET(frame);
+    } else {
+        encodeCandump(frame);
+    }
+    framesWritten++;
+}
+
+bool Capture_Stream::reserve(uint32_t len) {
+    if(bufferLen + len <= CAPTURE_STREAM_BUFFER_SIZE) return true;
+    flush();
+    return bufferLen + len <= CAPTURE_STREAM_BUFFER_SIZE;
+}
+
+void Capture_Stream::append(const uint8_t* data, uint32_t len) {
+    if(!reserve(len)) return;
+    memcpy(buffer + bufferLen, data, len);
+    bufferLen += len;
+}
+
+/**
+ * \brief Encode a frame in candump format
+ *
+ * Produces the same line layout the firmware printed before, e.g.
+ * "can1  09F80123   [8]  01 02 03 04 05 06 07 08".
+ *
+ * \param frame Frame to encode
+ */
+void Capture_Stream::encodeCandump(const CaptureFrame& frame) {
+    char* out = (char*)buffer + bufferLen;
+    int len = snprintf(out, MAX_RECORD_LEN, "can1  %08lX   [%u]  ",
+                       (unsigned long)frame.id, (unsigned)frame.len);
+
+    for(int i = 0; i < frame.len && i < 8; i++) {
+        out[len++] = HEX_DIGITS[frame.data[i] >> 4];
+        out[len++] = HEX_DIGITS[frame.data[i] & 0x0F];
+        if(i < frame.len - 1) out[len++] = ' ';
+    }
+    out[len++] = '\r';
+    out[len++] = '\n';
+
+    bufferLen += len;
+}
+
+/**
+ * \brief Encode a frame as a GVRET record
+ *
+ * Layout: F1 00, timestamp (4, LE), id (4, LE, bit 31 = extended),
+ * length | bus << 4, data bytes, checksum (unused, always 0).
+ *
+ * \param frame Frame to encode
+ */
+void Capture_Stream::encodeGVRET(const CaptureFrame& frame) {
+    uint8_t* out = buffer + bufferLen;
+    uint8_t len = frame.len > 8 ? 8 : frame.len;
+
+    out[0] = GVRET_COMMAND;
+    out[1] = GVRET_BUILD_CAN_FRAME;
+    putUint32(out + 2, frame.timestamp);
+    putUint32(out + 6, frame.id | (1UL << 31));
+    out[10] = len;  // Bus 0
+    memcpy(out + 11, frame.data, len);
+    out[11 + len] = 0;
+
+    bufferLen += 12 + len;
+}
+
+/**
+ * \brief Write as much of the staging buffer as the port accepts
+ *
+ * Uses availableForWrite() so the call never waits for the host.
+ */
+void Capture_Stream::flush() {
+    if(bufferLen == 0) return;
+    PROFILE_ZONE(PROFILE_USB_WRITE);
+
+    int room = port->availableForWrite();
+    if(room <= 0) return;
+
+    uint32_t count = (uint32_t)room < bufferLen ? (uint32_t)room : bufferLen;
+    size_t written = port->write(buffer, count);
+    if(written == 0) return;
+
+    bufferLen -= written;
+    if(bufferLen > 0) {
+        memmove(buffer, buffer + written, bufferLen);
+    }
+}
+
+void Capture_Stream::writeText(const char* text) {
+    if(mode == CAPTURE_MODE_GVRET) return;
+    append((const uint8_t*)text, strlen(text));
+}
+
+void Capture_Stream::poll() {
+    while(port->available() > 0) {
+        handleHostByte((uint8_t)port->read());
+    }
+    flush();
+}
+
+/**
+ * \brief Feed one byte from the host to the GVRET command parser
+ *
+ * SavvyCAN opens the connection by sending 0xE7, which switches the stream
+ * to GVRET from any mode. Binary commands are only interpreted while in
+ * GVRET mode; in the other modes every other byte goes to the text hook.
+ *
+ * \param in Received byte
+ */
+void Capture_Stream::handleHostByte(uint8_t in) {
+    switch(hostState) {
+        case HOST_IDLE:
+            if(in == GVRET_ENABLE_BINARY) {
+                setMode(CAPTURE_MODE_GVRET);
+            } else if(mode == CAPTURE_MODE_GVRET) {
+                if(in == GVRET_COMMAND) hostState = HOST_COMMAND;
+            } else if(textHook != nullptr) {
+                textHook(in);
+            }
+            break;
+
+        case HOST_COMMAND:
+            hostCommand = in;
+            hostPayloadLen = 0;
+            switch(in) {
+                case GVRET_BUILD_CAN_FRAME:
+                case GVRET_ECHO_CAN_FRAME:
+                    hostPayloadNeeded = 6;  // id, bus, length; data added once length is known
+                    break;
+                case GVRET_SETUP_CANBUS:
+                    hostPayloadNeeded = 8;
+                    break;
+                case GVRET_SET_SINGLEWIRE:
+                case GVRET_SET_SYSTYPE:
+                    hostPayloadNeeded = 1;
+                    break;
+                default:
+                    hostPayloadNeeded = 0;
+                    break;
+            }
+            if(hostPayloadNeeded == 0) {
+                hostState = HOST_IDLE;
+                handleHostCommand();
+            } else {
+                hostState = HOST_PAYLOAD;
+            }
+            break;
+
+        case HOST_PAYLOAD:
+            if(hostPayloadLen < sizeof(hostPayload)) {
+                hostPayload[hostPayloadLen] = in;
+            }
+            hostPayloadLen++;
+
+            // Frame commands carry their data length in byte 5, plus a checksum
+            if((hostCommand == GVRET_BUILD_CAN_FRAME || hostCommand == GVRET_ECHO_CAN_FRAME) &&
+               hostPayloadLen == 6) {
+                hostPayloadNeeded = 6 + (in & 0x0F) + 1;
+            }
+
+            if(hostPayloadLen >= hostPayloadNeeded) {
+                hostState = HOST_IDLE;
+                handleHostCommand();
+            }
+            break;
+    }
+}
+
+/**
+ * \brief Reply to a complete GVRET command
+ *
+ * The monitoring bus is listen-only, so frame transmit and bus setup
+ * requests are accepted and ignored. Only the queries SavvyCAN needs to
+ * establish a connection are answered.
+ */
+void Capture_Stream::handleHostCommand() {
+    uint8_t reply[12];
+    reply[0] = GVRET_COMMAND;
+    reply[1] = hostCommand;
+
+    switch(hostCommand) {
+        case GVRET_TIME_SYNC:
+            putUint32(reply + 2, micros());
+            append(reply, 6);
+            break;
+
+        case GVRET_GET_CANBUS_PARAMS:
+            reply[2] = 0x11;  // Bus 0 enabled, listen only
+            putUint32(reply + 3, GVRET_BUS_SPEED);
+            reply[7] = 0x00;  // Bus 1 disabled
+            putUint32(reply + 8, 0);
+            append(reply, 12);
+            break;
+
+        case GVRET_GET_DEVICE_INFO:
+            reply[2] = 1;     // Build number, low byte
+            reply[3] = 0;     // Build number, high byte
+            reply[4] = 0;     // EEPROM version
+            reply[5] = 0;     // File output type
+            reply[6] = 0;     // Auto logging
+            reply[7] = 0;     // Single wire mode
+            append(reply, 8);
+            break;
+
+        case GVRET_KEEPALIVE:
+            reply[2] = 0xDE;
+            reply[3] = 0xAD;
+            append(reply, 4);
+            break;
+
+        case GVRET_GET_NUMBUSES:
+            reply[2] = 1;
+            append(reply, 3);
+            break;
+
+        default:
+            break;
+    }
+}
@@ -0,0 +1,218 @@
+/**
+ * \file Capture_Stream.h
+ * \brief Raw CAN frame capture output over USB serial
+ *
+ * Streams every frame received on the monitoring bus to the host exactly as
+ * it appeared on the wire. Frames come straight from the CAN_Capture frame
+ * hook, so fast-packet messages are output as their original fragments with
+ * the real sequence counters and timestamps.
+ *
+ * Two output formats are available and can be switched at runtime:
+ * - CANDUMP: the text format used by NEMO so far ("can1  ID   [len]  XX ..")
+ * - GVRET:   the binary protocol spoken by SavvyCAN, selected automatically
+ *            when SavvyCAN connects and sends its GVRET handshake
+ *
+ * Records are encoded into a staging buffer and written to USB in large
+ * chunks from loop(), limited to what the USB stack can take without
+ * blocking. If the host stops reading, whole frames are dropped and counted
+ * instead of stalling the main loop.
+ *
+ * Outside GVRET mode, bytes from the host are passed to a text hook (the
+ * serial console), whose replies share the staging buffer with the capture
+ * records so they never split a candump line.
+ */
+
+#ifndef CAPTURE_STREAM_H
+#define CAPTURE_STREAM_H
+
+#include <Arduino.h>
+#include <CAN_Capture.h>
+#include "constants.h"
+
+/**
+ * \enum CaptureMode
+ * \brief Output format of the capture stream
+ */
+enum CaptureMode : uint8_t {
+    CAPTURE_MODE_OFF,       ///< No capture output
+    CAPTURE_MODE_CANDUMP,   ///< candump-style text lines
+    CAPTURE_MODE_GVRET,     ///< GVRET binary records (SavvyCAN)
+    CAPTURE_MODE_COUNT      ///< Number of modes, not a valid mode
+};
+
+/**
+ * \brief Callback receiving host bytes that are not GVRET traffic
+ */
+typedef void (*HostTextHook)(uint8_t c);
+
+/**
+ * \class Capture_Stream
+ * \brief Buffers raw CAN frames and writes them to a serial port
+ *
+ * Call addFrame() for every captured frame (normally from the CAN_Capture
+ * frame hook) and poll() once per loop iteration. poll() handles the GVRET
+ * host commands and flushes the staging buffer.
+ *
+ * \note The staging buffer is static storage in DMAMEM, so only one stream
+ *       should exist.
+ */
+class Capture_Stream {
+private:
+    Stream* port;                                   ///< Serial port the capture is written to
+    CaptureMode mode;                               ///< Active output format
+    uint8_t* buffer;                                ///< Staging buffer for encoded records, in DMAMEM
+    uint32_t bufferLen;                             ///< Number of bytes waiting in buffer
+    uint32_t framesWritten;                         ///< Frames encoded into the buffer
+    uint32_t framesDropped;                         ///< Frames lost because the buffer was full
+
+    uint8_t hostState;                              ///< GVRET command parser state
+    uint8_t hostCommand;                            ///< GVRET command being received
+    uint8_t hostPayload[16];                        ///< Payload bytes of the current command
+    uint8_t hostPayloadLen;                         ///< Payload bytes received so far
+    uint8_t hostPayloadNeeded;                      ///< Payload bytes expected for the command
+    HostTextHook textHook;                          ///< Receives host text outside GVRET mode
+
+    /**
+     * \brief Make room for a record of the given size
+     *
+     * Flushes the buffer if the record doesn't fit.
+     *
+     * \param len Size of the record in bytes
+     * \return true if the record fits in the buffer
+     */
+    bool reserve(uint32_t len);
+
+    /**
+     * \brief Encode a frame as a candump text line
+     *
+     * \param frame Frame to encode
+     */
+    void encodeCandump(const CaptureFrame& frame);
+
+    /**
+     * \brief Encode a frame as a GVRET binary record
+     *
+     * \param frame Frame to encode
+     */
+    void encodeGVRET(const CaptureFrame& frame);
+
+    /**
+     * \brief Feed one byte received from the host to the command parser
+     *
+     * \param in Received byte
+     */
+    void handleHostByte(uint8_t in);
+
+    /**
+     * \brief Reply to a completely received GVRET command
+     */
+    void handleHostCommand();
+
+    /**
+     * \brief Append raw bytes to the staging buffer
+     *
+     * \param data Bytes to append
+     * \param len Number of bytes
+     */
+    void append(const uint8_t* data, uint32_t len);
+
+public:
+    /**
+     * \brief Construct a capture stream on a serial port
+     *
+     * \param serialPort Port to write the capture to (e.g. &Serial)
+     * \param initialMode Output format to start with
+     */
+    Capture_Stream(Stream* serialPort, CaptureMode initialMode);
+
+    /**
+     * \brief Queue a captured frame for output
+     *
+     * Does nothing when the mode is CAPTURE_MODE_OFF.
+     *
+     * \param frame Frame exactly as received
+     */
+    void addFrame(const CaptureFrame& frame);
+
+    /**
+     * \brief Process host commands and write buffered data
+     *
+     * Call once per loop iteration.
+     */
+    void poll();
+
+    /**
+     * \brief Write as much of the staging buffer as the port accepts
+     *
+     * Never blocks; data that doesn't fit stays buffered for the next call.
+     */
+    void flush();
+
+    /**
+     * \brief Change the output format
+     *
+     * Buffered data of the previous format is discarded so the host never
+     * sees a mix of the two.
+     *
+     * \param newMode Format to switch to
+     */
+    void setMode(CaptureMode newMode);
+
+    /**
+     * \brief Get the active output format
+     *
+     * \return Current capture mode
+     */
+    CaptureMode getMode() const { return mode; }
+
+    /**
+     * \brief Get a short display name for a mode
+     *
+     * \param captureMode Mode to name
+     * \return Name such as "CANDUMP"
+     */
+    static const char* getModeName(CaptureMode captureMode);
+
+    /**
+     * \brief Get the number of frames queued for output
+     *
+     * \return Frames written since startup
+     */
+    uint32_t getFramesWritten() const { return framesWritten; }
+
+    /**
+     * \brief Get the number of frames dropped because the host was too slow
+     *
+     * \return Frames dropped since startup
+     */
+    uint32_t getFramesDropped() const { return framesDropped; }
+
+    /**
+     * \brief Get the number of bytes waiting in the staging buffer
+     *
+     * \return Fill level, at most CAPTURE_STREAM_BUFFER_SIZE
+     */
+    uint32_t getBufferedBytes() const { return bufferLen; }
+
+    /**
+     * \brief Register a receiver for host text
+     *
+     * Gets every byte from the host except the GVRET handshake, and nothing
+     * while in GVRET mode.
+     *
+     * \param hook Function to call, or nullptr to remove the hook
+     */
+    void setTextHook(HostTextHook hook) { textHook = hook; }
+
+    /**
+     * \brief Queue text for the host
+     *
+     * Written in between capture records. Dropped in GVRET mode, where the
+     * host expects binary records only.
+     *
+     * \param text Null-terminated text
+     */
+    void writeText(const char* text);
+};
+
+#endif // CAPTURE_STREAM_H
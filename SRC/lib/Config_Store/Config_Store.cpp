@@ -0,0 +1,234 @@
+/**
+ * \file Config_Store.cpp
+ * \brief Implementation of the EEPROM configuration store
+ */
+
+#include "Config_Store.h"
+#include <EEPROM.h>
+
+/// Marks a written slot ("NC")
+static constexpr uint16_t CONFIG_MAGIC = 0x434E;
+
+/// Layout version of ConfigData; slots of other versions are ignored
+static constexpr uint8_t CONFIG_VERSION = 1;
+
+static_assert(sizeof(ConfigHeader) + sizeof(ConfigData) <= CONFIG_SLOT_SIZE,
+              "ConfigData doesn't fit into CONFIG_SLOT_SIZE");
+#ifdef E2END
+static_assert(CONFIG_SLOT_SIZE * CONFIG_SLOT_COUNT <= E2END + 1,
+              "Configuration slots don't fit into the EEPROM");
+#endif
+
+/**
+ * \brief CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF)
+ *
+ * \param data Bytes
+ * \param len Number of bytes
+ * \return CRC
+ */
+static uint16_t crc16(const uint8_t* data, uint16_t len) {
+    uint16_t crc = 0xFFFF;
+    for(uint16_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for(int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+Config_Store::Config_Store(Device_Pool* devicePool) {
+    pool = devicePool;
+    monitor = nullptr;
+    memset(&saved, 0, sizeof(saved));
+    memset(&seen, 0, sizeof(seen));
+    changedAt = 0;
+    changed = false;
+    loaded = false;
+    slot = -1;
+    sequence = 0;
+    writing = false;
+    writeSlot = 0;
+    writePosition = 0;
+    saves = 0;
+    verifyFailures = 0;
+}
+
+void Config_Store::capture(ConfigData& data) {
+    memset(&data, 0, sizeof(data));
+    data.staleCleanup = (monitor != nullptr && monitor->isStaleCleanupEnabled()) ? 1 : 0;
+
+    for(uint8_t i = 0; i < VDEV_POT_DEVICES && i < pool->getCount(); i++) {
+        Sensor* device = pool->getDevice(i);
+        ConfigDevice& config = data.devices[i];
+        config.sendInterval = device->getSendInterval();
+        config.sourcePeriod = device->getSourcePeriod();
+        config.manufacturerCode = device->getManufacturerCode();
+        config.messageType = (uint8_t)device->getMessageType();
+        config.valueSource = (uint8_t)device->getValueSource();
+        config.active = device->isActive() ? 1 : 0;
+        snprintf(config.customName, sizeof(config.customName), "%s", device->getCustomName());
+    }
+}
+
+bool Config_Store::readSlot(uint8_t index, ConfigHeader& header, ConfigData* data) {
+    uint16_t base = index * CONFIG_SLOT_SIZE;
+    uint8_t* headerBytes = (uint8_t*)&header;
+    for(uint16_t i = 0; i < sizeof(ConfigHeader); i++) {
+        headerBytes[i] = EEPROM.read(base + i);
+    }
+    if(header.magic != CONFIG_MAGIC || header.version != CONFIG_VERSION ||
+       header.length != sizeof(ConfigData)) {
+        return false;
+    }
+
+    ConfigData scratch;
+    if(data == nullptr) data = &scratch;
+    uint8_t* dataBytes = (uint8_t*)data;
+    for(uint16_t i = 0; i < sizeof(ConfigData); i++) {
+        dataBytes[i] = EEPROM.read(base + sizeof(ConfigHeader) + i);
+    }
+    return crc16(dataBytes, sizeof(ConfigData)) == header.crc;
+}
+
+bool Config_Store::load() {
+    ConfigHeader header;
+    ConfigData data;
+    slot = -1;
+
+    for(uint8_t i = 0; i < CONFIG_SLOT_COUNT; i++) {
+        if(!readSlot(i, header, &data)) continue;
+
+        // Sequence numbers are compared across the wrap
+        if(slot < 0 || (int32_t)(header.sequence - sequence) > 0) {
+            slot = i;
+            sequence = header.sequence;
+            memcpy(&saved, &data, sizeof(saved));
+        }
+    }
+
+    loaded = slot >= 0;
+
+    // Without a saved configuration the defaults count as saved, so a
+    // first boot doesn't write them back unchanged
+    if(!loaded) capture(saved);
+    return loaded;
+}
+
+void Config_Store::apply() {
+    if(!loaded) return;
+
+    for(uint8_t i = 0; i < VDEV_POT_DEVICES && i < pool->getCount(); i++) {
+        Sensor* device = pool->getDevice(i);
+        const ConfigDevice& config = saved.devices[i];
+
+        if(config.messageType <= MSG_TANK_LEVEL) {
+            device->setMessageType((MessageType)config.messageType);
+        }
+        device->setValueSource((ValueSource)config.valueSource, config.sourcePeriod);
+        device->setSendInterval(config.sendInterval);
+
+        // The sensors are still inactive, so these only update the device
+        // information and don't send an address claim
+        device->setManufacturerCode(config.manufacturerCode & 0x7FF);
+        device->setCustomName(config.customName);
+    }
+
+    if(monitor != nullptr) {
+        monitor->setStaleCleanupEnabled(saved.staleCleanup != 0);
+    }
+}
+
+bool Config_Store::wasActive(uint8_t index) const {
+    return loaded && index < VDEV_POT_DEVICES && saved.devices[index].active != 0;
+}
+
+void Config_Store::service() {
+    if(writing) {
+        writeChunk();
+        return;
+    }
+
+    ConfigData current;
+    capture(current);
+    if(memcmp(&current, &saved, sizeof(current)) == 0) {
+        changed = false;
+        return;
+    }
+
+    // Restart the idle time on every change, save once it settled
+    uint32_t now = millis();
+    if(!changed || memcmp(&current, &seen, sizeof(current)) != 0) {
+        memcpy(&seen, &current, sizeof(seen));
+        changedAt = now;
+        changed = true;
+        return;
+    }
+
+    if(now - changedAt >= CONFIG_SAVE_IDLE_MS) {
+        startSave(seen);
+    }
+}
+
+void Config_Store::save() {
+    if(writing) return;
+
+    ConfigData current;
+    capture(current);
+    startSave(current);
+}
+
+void Config_Store::erase() {
+    writing = false;
+    for(uint8_t i = 0; i < CONFIG_SLOT_COUNT; i++) {
+        uint16_t base = i * CONFIG_SLOT_SIZE;
+        EEPROM.update(base, 0);
+        EEPROM.update(base + 1, 0);
+    }
+    slot = -1;
+    loaded = false;
+    changed = false;
+    capture(saved);
+}
+
+void Config_Store::startSave(const ConfigData& data) {
+    ConfigHeader header;
+    header.magic = CONFIG_MAGIC;
+    header.version = CONFIG_VERSION;
+    header.reserved = 0;
+    header.sequence = sequence + 1;
+    header.length = sizeof(ConfigData);
+    header.crc = crc16((const uint8_t*)&data, sizeof(ConfigData));
+
+    memcpy(image, &header, sizeof(header));
+    memcpy(image + sizeof(header), &data, sizeof(data));
+    memcpy(&saved, &data, sizeof(saved));
+    changed = false;
+
+    writeSlot = (slot + 1) % CONFIG_SLOT_COUNT;
+    writePosition = 0;
+    writing = true;
+}
+
+void Config_Store::writeChunk() {
+    uint16_t base = writeSlot * CONFIG_SLOT_SIZE;
+
+    // The data goes first and the header last, so the slot only becomes
+    // valid once all of it is written
+    for(uint16_t n = 0; n < CONFIG_WRITE_CHUNK && writePosition < sizeof(image); n++) {
+        uint16_t offset = (writePosition + sizeof(ConfigHeader)) % sizeof(image);
+        EEPROM.update(base + offset, image[offset]);
+        writePosition++;
+    }
+    if(writePosition < sizeof(image)) return;
+
+    writing = false;
+    ConfigHeader header;
+    if(readSlot(writeSlot, header, nullptr) && header.sequence == sequence + 1) {
+        slot = writeSlot;
+        sequence = header.sequence;
+        saves++;
+    } else {
+        verifyFailures++;
+    }
+}
@@ -0,0 +1,242 @@
+/**
+ * \file Config_Store.h
+ * \brief Device configuration kept in EEPROM across power cycles
+ *
+ * Every boot used to start from the values built into the firmware, so the
+ * sensor types, spoofed manufacturer codes and active states picked in the
+ * menu had to be entered again after each power cycle. The config store
+ * saves them, together with the stale cleanup toggle, in the EEPROM the
+ * Teensy emulates in flash, and setupNMEA2000() applies them before the
+ * CAN1 devices claim their addresses.
+ *
+ * Saved are the VDEV_POT_DEVICES menu sensors: message type, value source
+ * and period, transmit interval, manufacturer code, custom name and whether
+ * the sensor was active. The other pool devices are bench setups made from
+ * the console and start from their defaults.
+ *
+ * The EEPROM holds CONFIG_SLOT_COUNT slots of CONFIG_SLOT_SIZE bytes, each
+ *
+ *     ConfigHeader (magic, version, sequence, length, CRC) | ConfigData
+ *
+ * A save goes to the slot after the newest valid one with the next
+ * sequence number, so the writes rotate over all slots. The data is written
+ * first and the header last, a few bytes per service() call; a save cut
+ * short by a power loss leaves a slot with a bad CRC and the previous one
+ * is loaded instead. The CRC is CRC-16/CCITT-FALSE over the data.
+ *
+ * Nothing has to report changes: service() compares the live configuration
+ * with the saved one and saves once it stayed unchanged for
+ * CONFIG_SAVE_IDLE_MS.
+ */
+
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+#include <Device_Pool.h>
+#include <N2K_Monitor.h>
+#include "constants.h"
+
+/**
+ * \struct ConfigHeader
+ * \brief Start of every configuration slot
+ */
+struct ConfigHeader {
+    uint16_t magic;             ///< CONFIG_MAGIC in a written slot
+    uint8_t version;            ///< Layout version of the data
+    uint8_t reserved;           ///< Always 0
+    uint32_t sequence;          ///< Save counter, the highest valid one is loaded
+    uint16_t length;            ///< Size of the data following the header
+    uint16_t crc;               ///< CRC-16/CCITT-FALSE of the data
+};
+
+/**
+ * \struct ConfigDevice
+ * \brief Saved settings of one menu sensor
+ */
+struct ConfigDevice {
+    uint32_t sendInterval;      ///< Transmit interval (ms)
+    uint32_t sourcePeriod;      ///< Period of the generated sources (ms)
+    uint16_t manufacturerCode;  ///< Manufacturer code of the NAME
+    uint8_t messageType;        ///< MessageType
+    uint8_t valueSource;        ///< ValueSource
+    uint8_t active;             ///< 1 if the sensor was transmitting
+    char customName[33];        ///< Model ID, "" for the default of the type
+};
+
+/**
+ * \struct ConfigData
+ * \brief Everything a slot saves
+ */
+struct ConfigData {
+    uint8_t staleCleanup;                       ///< 1 if the monitor's stale cleanup was on
+    uint8_t reserved[3];                        ///< Always 0
+    ConfigDevice devices[VDEV_POT_DEVICES];     ///< Menu sensors by device index
+};
+
+/**
+ * \class Config_Store
+ * \brief Loads, applies and saves the device configuration
+ *
+ * Call load() and apply() before NMEA2000_CAN1 is opened, then service()
+ * every CONFIG_SERVICE_INTERVAL_MS.
+ */
+class Config_Store {
+private:
+    Device_Pool* pool;                  ///< Devices the configuration belongs to
+    N2K_Monitor* monitor;               ///< Monitor of the stale cleanup toggle, or nullptr
+
+    ConfigData saved;                   ///< Configuration in the newest slot (or last save started)
+    ConfigData seen;                    ///< Live configuration at the last change
+    uint32_t changedAt;                 ///< Time seen was taken (millis)
+    bool changed;                       ///< Live configuration differs from saved
+    bool loaded;                        ///< saved came from EEPROM at boot
+
+    int8_t slot;                        ///< Newest valid slot, -1 if none
+    uint32_t sequence;                  ///< Sequence number of that slot
+
+    uint8_t image[sizeof(ConfigHeader) + sizeof(ConfigData)];  ///< Slot being written
+    bool writing;                       ///< A save is in progress
+    uint8_t writeSlot;                  ///< Slot of the save in progress
+    uint16_t writePosition;             ///< Bytes of image written so far
+
+    uint32_t saves;                     ///< Saves completed since boot
+    uint32_t verifyFailures;            ///< Saves that didn't read back valid
+
+    /**
+     * \brief Read the live configuration
+     *
+     * \param[out] data Filled in, unused bytes zeroed so it can be compared with memcmp
+     */
+    void capture(ConfigData& data);
+
+    /**
+     * \brief Read and check a slot
+     *
+     * \param index Slot index
+     * \param[out] header Header of the slot
+     * \param[out] data Data of the slot, may be nullptr to check only
+     * \return true if the slot holds a valid configuration of this version
+     */
+    bool readSlot(uint8_t index, ConfigHeader& header, ConfigData* data);
+
+    /**
+     * \brief Start saving a configuration to the next slot
+     *
+     * \param data Configuration to save
+     */
+    void startSave(const ConfigData& data);
+
+    /**
+     * \brief Write the next CONFIG_WRITE_CHUNK bytes of the save in progress
+     */
+    void writeChunk();
+
+public:
+    /**
+     * \brief Construct a store for the menu sensors of a pool
+     *
+     * \param devicePool Pool whose first VDEV_POT_DEVICES devices are saved
+     */
+    Config_Store(Device_Pool* devicePool);
+
+    /**
+     * \brief Set the monitor whose stale cleanup toggle is saved
+     *
+     * \param n2kMonitor Monitor of the CAN2 bus
+     */
+    void setMonitor(N2K_Monitor* n2kMonitor) { monitor = n2kMonitor; }
+
+    /**
+     * \brief Find the newest valid slot and read it
+     *
+     * Call after Device_Pool::begin().
+     *
+     * \return true if a saved configuration was found
+     */
+    bool load();
+
+    /**
+     * \brief Apply the loaded configuration to the sensors and the monitor
+     *
+     * Sets everything but the active state, without any bus traffic, so it
+     * can run before NMEA2000_CAN1 is opened. Sensors that were active are
+     * switched on afterwards with Sensor::setActive(), see wasActive().
+     * Does nothing if load() found no configuration.
+     */
+    void apply();
+
+    /**
+     * \brief Check whether a sensor was active in the loaded configuration
+     *
+     * \param index Device index
+     * \return true if it should be switched on after Open()
+     */
+    bool wasActive(uint8_t index) const;
+
+    /**
+     * \brief Notice changes and continue a save in progress
+     *
+     * Call every CONFIG_SERVICE_INTERVAL_MS.
+     */
+    void service();
+
+    /**
+     * \brief Save the live configuration now instead of waiting for idle
+     *
+     * Does nothing while a save is in progress; the next service() calls
+     * catch up with the changes.
+     */
+    void save();
+
+    /**
+     * \brief Invalidate every slot, so the next boot starts from defaults
+     *
+     * The live configuration is kept and not saved again until it changes.
+     */
+    void erase();
+
+    /**
+     * \brief Check whether a change is waiting for idle or being written
+     *
+     * \return true if the EEPROM doesn't hold the live configuration yet
+     */
+    bool isPending() const { return changed || writing; }
+
+    /**
+     * \brief Check whether the boot configuration came from EEPROM
+     *
+     * \return true if load() found a valid slot
+     */
+    bool isLoaded() const { return loaded; }
+
+    /**
+     * \brief Get the newest valid slot
+     *
+     * \return Slot index, -1 if the EEPROM holds no configuration
+     */
+    int8_t getSlot() const { return slot; }
+
+    /**
+     * \brief Get the sequence number of the newest valid slot
+     *
+     * \return Saves made over the life of the EEPROM
+     */
+    uint32_t getSequence() const { return sequence; }
+
+    /**
+     * \brief Get the number of saves completed since boot
+     *
+     * \return Saves
+     */
+    uint32_t getSaves() const { return saves; }
+
+    /**
+     * \brief Get the number of saves that didn't read back valid
+     *
+     * \return Saves
+     */
+    uint32_t getVerifyFailures() const { return verifyFailures; }
+};
+
+#endif // CONFIG_STORE_H
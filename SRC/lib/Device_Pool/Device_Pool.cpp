@@ -0,0 +1,189 @@
+/**
+ * \file Device_Pool.cpp
+ * \brief Implementation of the simulated device pool and its transmit schedule
+ *
+ * Contains device creation, the spread slot assignment, the transmit pass
+ * and the per-device rate accounting.
+ */
+
+#include "Device_Pool.h"
+#include <PGN_Helpers.h>
+
+/**
+ * \brief Potentiometer pins, in the order the devices follow them
+ */
+static const uint8_t POT_PINS[3] = {SENSOR_PIN_1, SENSOR_PIN_2, SENSOR_PIN_3};
+
+/**
+ * \brief Message types of the menu-configured devices
+ */
+static const MessageType POT_DEVICE_TYPES[3] = {MSG_ENGINE_RPM, MSG_WATER_DEPTH, MSG_HEADING};
+
+static_assert(VDEV_POT_DEVICES <= 3, "There are only three potentiometers");
+static_assert(VDEV_DEVICE_COUNT >= VDEV_POT_DEVICES, "The pool must hold the menu-configured devices");
+
+Device_Pool::Device_Pool(tNMEA2000_Teensyx* can, TX_Scheduler* tx) {
+    nmea2000 = can;
+    scheduler = tx;
+    deviceCount = 0;
+    nextDevice = 0;
+    windowStart = 0;
+    paused = false;
+    for(uint8_t i = 0; i < VDEV_DEVICE_COUNT; i++) {
+        devices[i] = nullptr;
+        schedules[i].stream = -1;
+        schedules[i].windowSent = 0;
+        schedules[i].achievedRate = 0;
+        schedules[i].wasActive = false;
+    }
+}
+
+void Device_Pool::begin(Analog_Sampler* sampler) {
+    if(deviceCount > 0) return;
+
+    for(uint8_t i = 0; i < VDEV_DEVICE_COUNT; i++) {
+        MessageType type = (i < VDEV_POT_DEVICES) ? POT_DEVICE_TYPES[i] : (MessageType)(i % SENSOR_COUNT);
+        Sensor* device = new Sensor(POT_PINS[i % 3], type, nmea2000, i);
+        device->attachSampler(sampler);
+        if(i >= VDEV_POT_DEVICES) {
+            device->setValueSource(SOURCE_SINE, SENSOR_SOURCE_PERIOD_MS);
+        }
+        devices[i] = device;
+        schedules[i].stream = scheduler->addStream();
+    }
+    deviceCount = VDEV_DEVICE_COUNT;
+    windowStart = millis();
+}
+
+uint8_t Device_Pool::getActiveCount() const {
+    uint8_t count = 0;
+    for(uint8_t i = 0; i < deviceCount; i++) {
+        if(devices[i]->isActive()) count++;
+    }
+    return count;
+}
+
+const TxStream* Device_Pool::getStream(uint8_t index) const {
+    if(index >= deviceCount || schedules[index].stream < 0) return nullptr;
+    return scheduler->getStream(schedules[index].stream);
+}
+
+/**
+ * \brief Give every active device a fresh, evenly spread slot
+ *
+ * Active device k of n gets its first slot k/n of its own interval after
+ * the restart. With equal intervals this puts exactly one device in every
+ * interval/n window; with mixed intervals the first slots are still
+ * staggered and the intervals drift apart from there. Inactive devices
+ * and, while paused, all devices have their streams switched off.
+ */
+void Device_Pool::spreadSlots() {
+    uint8_t activeCount = getActiveCount();
+
+    uint8_t k = 0;
+    for(uint8_t i = 0; i < deviceCount; i++) {
+        int stream = schedules[i].stream;
+        if(stream < 0) continue;
+
+        bool enable = !paused && devices[i]->isActive();
+        if(enable) {
+            uint32_t interval = devices[i]->getSendInterval() * 1000;
+            scheduler->setStream(stream, interval, (uint32_t)((uint64_t)interval * k / activeCount));
+            k++;
+        }
+        scheduler->setEnabled(stream, enable);
+    }
+}
+
+void Device_Pool::setInterval(uint8_t index, uint32_t intervalMillis) {
+    if(index >= deviceCount) return;
+    devices[index]->setSendInterval(intervalMillis);
+    spreadSlots();
+}
+
+float Device_Pool::getRequestedRate(uint8_t index) const {
+    if(index >= deviceCount || !devices[index]->isActive()) return 0;
+    return 1000.0f / devices[index]->getSendInterval();
+}
+
+float Device_Pool::getAchievedRate(uint8_t index) const {
+    if(index >= deviceCount) return 0;
+    return schedules[index].achievedRate;
+}
+
+void Device_Pool::refresh() {
+    for(uint8_t i = 0; i < deviceCount; i++) {
+        devices[i]->update();
+    }
+}
+
+void Device_Pool::setPaused(bool pause) {
+    if(paused == pause) return;
+    paused = pause;
+    spreadSlots();
+}
+
+/**
+ * \brief Build the messages of the devices whose slots come up next
+ *
+ * Devices switched on or off since the last pass (from the menu or the
+ * console) trigger a new spread first. The scan starts after the last
+ * device staged, so when more than VDEV_MAX_STAGED_PER_PASS are due the
+ * same devices aren't always the ones that wait.
+ */
+void Device_Pool::service() {
+    bool changed = false;
+    for(uint8_t i = 0; i < deviceCount; i++) {
+        bool active = devices[i]->isActive();
+        if(active != schedules[i].wasActive) {
+            schedules[i].wasActive = active;
+            changed = true;
+        }
+    }
+    if(changed) spreadSlots();
+
+    uint8_t start = nextDevice;
+    uint8_t staged = 0;
+    for(uint8_t n = 0; n < deviceCount && staged < VDEV_MAX_STAGED_PER_PASS; n++) {
+        uint8_t i = (start + n) % deviceCount;
+        int stream = schedules[i].stream;
+        if(stream < 0 || !scheduler->needsMessage(stream)) continue;
+
+        // The library owns the address; a device without one (null
+        // address 254, e.g. it lost its claim) stays quiet
+        uint8_t source = nmea2000->GetN2kSource(i);
+        if(source >= 254) continue;
+
+        Sensor* device = devices[i];
+        tN2kMsg N2kMsg;
+        device->update();
+        if(!device->buildMessage(N2kMsg)) continue;
+        N2kMsg.Source = source;
+
+        scheduler->stage(stream, N2kMsg);
+        staged++;
+        nextDevice = (i + 1) % deviceCount;
+    }
+
+    uint32_t now = millis();
+    uint32_t elapsed = now - windowStart;
+    if(elapsed >= VDEV_RATE_WINDOW_MS) {
+        for(uint8_t i = 0; i < deviceCount; i++) {
+            const TxStream* stream = getStream(i);
+            if(stream == nullptr) continue;
+            uint32_t sent = stream->sent;
+            schedules[i].achievedRate = (sent - schedules[i].windowSent) * 1000.0f / elapsed;
+            schedules[i].windowSent = sent;
+        }
+        windowStart = now;
+    }
+}
+
+void Device_Pool::resetStats() {
+    for(uint8_t i = 0; i < deviceCount; i++) {
+        if(schedules[i].stream >= 0) scheduler->resetStreamStats(schedules[i].stream);
+        schedules[i].windowSent = 0;
+        schedules[i].achievedRate = 0;
+    }
+    windowStart = millis();
+}
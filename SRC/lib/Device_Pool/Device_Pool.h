@@ -0,0 +1,176 @@
+/**
+ * \file Device_Pool.h
+ * \brief Pool of simulated NMEA2000 devices sharing CAN1
+ *
+ * NEMO used to be three hard-wired sensors that all sent at the same
+ * instant once a second. For load testing displays it can now act as up to
+ * VDEV_DEVICE_COUNT devices, each a Sensor with its own device index in the
+ * NMEA2000 library (tNMEA2000::SetDeviceCount), message type, transmit
+ * interval and value source (potentiometer, ramp, sine or trace).
+ *
+ * The first VDEV_POT_DEVICES devices are the sensors the menu configures.
+ * All others start inactive and are configured from the serial console.
+ *
+ * Every device is a TX_Scheduler stream, so its messages leave from the
+ * scheduler interrupt and the pool only builds them ahead of their slots.
+ * Transmissions are spread over time: when the set of active devices
+ * changes, device k of n active devices gets its first slot k/n of its
+ * interval into the future, and from then on every interval after that.
+ * Devices with the same interval therefore never send in the same tick.
+ *
+ * For every device the pool reports the requested rate (from the interval)
+ * next to the achieved rate (messages the driver accepted over the last
+ * VDEV_RATE_WINDOW_MS). The stream adds failed messages and missed slots.
+ */
+
+#ifndef DEVICE_POOL_H
+#define DEVICE_POOL_H
+
+#include <Arduino.h>
+#include <NMEA2000_Teensyx.h>
+#include <Sensor.h>
+#include <Analog_Sampler.h>
+#include <TX_Scheduler.h>
+#include "constants.h"
+
+/**
+ * \struct DeviceSchedule
+ * \brief Transmit stream and rate measurement of one pool device
+ */
+struct DeviceSchedule {
+    int stream;             ///< TX_Scheduler stream of the device, -1 if none was free
+    uint32_t windowSent;    ///< Stream sent count when the current rate window started
+    float achievedRate;     ///< Messages per second over the last full window
+    bool wasActive;         ///< Active state seen by the last service()
+};
+
+/**
+ * \class Device_Pool
+ * \brief Owns the simulated devices and schedules their transmissions
+ *
+ * Call begin() before Analog_Sampler::begin() and before NMEA2000_CAN1 is
+ * opened, then service() more often than TX_STAGE_LEAD_MS from the loop.
+ */
+class Device_Pool {
+private:
+    tNMEA2000_Teensyx* nmea2000;                ///< Interface all devices send on
+    TX_Scheduler* scheduler;                    ///< Sends the staged messages
+    Sensor* devices[VDEV_DEVICE_COUNT];         ///< Devices, index = library device index
+    DeviceSchedule schedules[VDEV_DEVICE_COUNT];///< Transmit slot and statistics per device
+    uint8_t deviceCount;                        ///< Devices created by begin()
+    uint8_t nextDevice;                         ///< Device the next service() pass starts at
+    uint32_t windowStart;                       ///< millis() the current rate window started
+    bool paused;                                ///< All streams are held off
+
+    /**
+     * \brief Give every active device a fresh, evenly spread slot
+     */
+    void spreadSlots();
+
+public:
+    /**
+     * \brief Construct an empty pool
+     *
+     * \param can Interface the devices send on
+     * \param tx Scheduler that sends the device messages on can
+     */
+    Device_Pool(tNMEA2000_Teensyx* can, TX_Scheduler* tx);
+
+    /**
+     * \brief Create the devices and register their potentiometers
+     *
+     * Devices 0-2 keep the original Engine RPM, Water Depth and Heading
+     * setup on potentiometers 1-3. The others cycle through the message
+     * types, follow the potentiometers in turn and use a sine source.
+     *
+     * \param sampler Sampler the potentiometer pins are registered with
+     */
+    void begin(Analog_Sampler* sampler);
+
+    /**
+     * \brief Get the number of devices
+     *
+     * \return Device count, the value to pass to SetDeviceCount()
+     */
+    uint8_t getCount() const { return deviceCount; }
+
+    /**
+     * \brief Get a device
+     *
+     * \param index Device index
+     * \return Device, or nullptr if index is out of range
+     */
+    Sensor* getDevice(uint8_t index) const { return index < deviceCount ? devices[index] : nullptr; }
+
+    /**
+     * \brief Get the transmit stream of a device
+     *
+     * \param index Device index
+     * \return Stream with the message counters, or nullptr if the device has none
+     */
+    const TxStream* getStream(uint8_t index) const;
+
+    /**
+     * \brief Get the number of active devices
+     *
+     * \return Devices currently transmitting
+     */
+    uint8_t getActiveCount() const;
+
+    /**
+     * \brief Change the transmit interval of a device
+     *
+     * \param index Device index
+     * \param intervalMillis New interval (ms)
+     */
+    void setInterval(uint8_t index, uint32_t intervalMillis);
+
+    /**
+     * \brief Get the message rate a device is configured for
+     *
+     * \param index Device index
+     * \return Messages per second, 0 if inactive
+     */
+    float getRequestedRate(uint8_t index) const;
+
+    /**
+     * \brief Get the message rate a device achieved
+     *
+     * \param index Device index
+     * \return Messages per second over the last full rate window
+     */
+    float getAchievedRate(uint8_t index) const;
+
+    /**
+     * \brief Refresh the values of all devices
+     *
+     * Keeps getRawValue() current for the menu and the impersonation
+     * attack. service() refreshes a device itself right before sending.
+     */
+    void refresh();
+
+    /**
+     * \brief Build the messages of the devices whose slots come up next
+     *
+     * Stages at most VDEV_MAX_STAGED_PER_PASS messages. A device whose
+     * message isn't staged by its slot misses that slot rather than
+     * sending late, so it keeps its place in the spread schedule.
+     */
+    void service();
+
+    /**
+     * \brief Hold off or resume all device transmissions
+     *
+     * Used while an attack takes over CAN1. Resuming spreads the slots again.
+     *
+     * \param pause true to hold off
+     */
+    void setPaused(bool pause);
+
+    /**
+     * \brief Clear the counters and restart the rate window
+     */
+    void resetStats();
+};
+
+#endif // DEVICE_POOL_H
@@ -0,0 +1,141 @@
+/**
+ * \file Memory_Budget.cpp
+ * \brief Implementation of the memory accounting
+ *
+ * Region sizes come from the symbols of the Teensy 4 linker script and the
+ * core's sbrk(); heap use from the C library's mallinfo().
+ */
+
+#include "Memory_Budget.h"
+#include <malloc.h>
+
+extern "C" {
+extern char _sdata[];       ///< Start of the globals, the start of DTCM
+extern char _ebss[];        ///< End of the globals
+extern char _estack[];      ///< Top of the stack, the end of DTCM
+extern char _heap_start[];  ///< End of the DMAMEM buffers
+extern char _heap_end[];    ///< End of RAM2
+extern char* __brkval;      ///< Heap claimed by sbrk() so far
+}
+
+/// Start of RAM2 (OCRAM), where the DMAMEM buffers begin
+static const uint32_t OCRAM_START = 0x20200000;
+
+/// The core traps stack overflows with a 32 byte no-access MPU region at _ebss
+static const uint32_t STACK_GUARD_BYTES = 32;
+
+MemoryProbe Memory_Budget::probes[MEMORY_SUBSYSTEM_COUNT];
+MemoryUsage Memory_Budget::usage[MEMORY_SUBSYSTEM_COUNT];
+uint32_t Memory_Budget::heapPeak = 0;
+
+static const char* const SUBSYSTEM_NAMES[MEMORY_SUBSYSTEM_COUNT] = {
+    "Mon", "CAN", "Disp", "Log", "Atk"
+};
+
+/**
+ * \brief Paint the free stack area and clear the table
+ *
+ * Paints from above the overflow guard up to MEMORY_STACK_PAINT_MARGIN
+ * below this function's frame. The loop keeps its variables in registers.
+ */
+void Memory_Budget::begin() {
+    uint32_t* word = (uint32_t*)(_ebss + STACK_GUARD_BYTES);
+    uint32_t* end = (uint32_t*)(((uint32_t)__builtin_frame_address(0) - MEMORY_STACK_PAINT_MARGIN) & ~3UL);
+    while(word < end) {
+        *word++ = MEMORY_STACK_PAINT;
+    }
+
+    memset(probes, 0, sizeof(probes));
+    memset(usage, 0, sizeof(usage));
+    heapPeak = getHeapUsed();
+}
+
+void Memory_Budget::setProbe(MemorySubsystem subsystem, MemoryProbe probe) {
+    if(subsystem < MEMORY_SUBSYSTEM_COUNT) probes[subsystem] = probe;
+}
+
+void Memory_Budget::sample() {
+    for(uint8_t s = 0; s < MEMORY_SUBSYSTEM_COUNT; s++) {
+        if(probes[s] == nullptr) continue;
+
+        MemoryUsage now = {0, 0, 0};
+        probes[s](now);
+
+        MemoryUsage& entry = usage[s];
+        entry.reserved = now.reserved;
+        entry.used = now.used;
+        if(now.peak > entry.peak) entry.peak = now.peak;
+    }
+
+    uint32_t heapUsed = getHeapUsed();
+    if(heapUsed > heapPeak) heapPeak = heapUsed;
+}
+
+void Memory_Budget::resetPeaks() {
+    for(uint8_t s = 0; s < MEMORY_SUBSYSTEM_COUNT; s++) {
+        usage[s].peak = usage[s].used;
+    }
+    heapPeak = getHeapUsed();
+}
+
+const char* Memory_Budget::getSubsystemName(MemorySubsystem subsystem) {
+    return subsystem < MEMORY_SUBSYSTEM_COUNT ? SUBSYSTEM_NAMES[subsystem] : "?";
+}
+
+/**
+ * \brief Measure the RAM regions
+ *
+ * The stack grows down from _estack towards the globals, so the lowest
+ * word that lost its paint marks the deepest the stack has been.
+ *
+ * \param[out] regions Sizes and use
+ */
+void Memory_Budget::getRegions(MemoryRegions& regions) {
+    regions.dtcmSize = (uint32_t)_estack - (uint32_t)_sdata;
+    regions.dtcmStatic = (uint32_t)(_ebss - _sdata);
+    regions.stackSize = (uint32_t)(_estack - _ebss);
+
+    const uint32_t* word = (const uint32_t*)(_ebss + STACK_GUARD_BYTES);
+    while(word < (const uint32_t*)_estack && *word == MEMORY_STACK_PAINT) word++;
+    regions.stackPeak = (uint32_t)_estack - (uint32_t)word;
+
+    regions.ocramSize = (uint32_t)_heap_end - OCRAM_START;
+    regions.dmamemStatic = (uint32_t)_heap_start - OCRAM_START;
+    regions.heapSize = (uint32_t)(_heap_end - _heap_start);
+
+    struct mallinfo info = mallinfo();
+    regions.heapUsed = info.uordblks;
+    if(regions.heapUsed > heapPeak) heapPeak = regions.heapUsed;
+    regions.heapPeak = heapPeak;
+    regions.heapFree = (uint32_t)(_heap_end - __brkval) + info.fordblks;
+    regions.heapLargest = getLargestFreeBlock();
+}
+
+uint32_t Memory_Budget::getHeapUsed() {
+    return mallinfo().uordblks;
+}
+
+/**
+ * \brief Find the largest block an allocation can get
+ *
+ * Binary search with trial allocations that are freed right away. A
+ * successful one may move the end of the heap up; the space stays free for
+ * later allocations.
+ *
+ * \return Block size, rounded down to MEMORY_HEAP_PROBE_STEP
+ */
+uint32_t Memory_Budget::getLargestFreeBlock() {
+    uint32_t low = 0;
+    uint32_t high = (uint32_t)(_heap_end - _heap_start);
+    while(high - low > MEMORY_HEAP_PROBE_STEP) {
+        uint32_t middle = low + (high - low) / 2;
+        void* block = malloc(middle);
+        if(block != nullptr) {
+            free(block);
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return low - low % MEMORY_HEAP_PROBE_STEP;
+}
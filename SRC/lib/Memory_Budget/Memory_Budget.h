@@ -0,0 +1,194 @@
+/**
+ * \file Memory_Budget.h
+ * \brief RAM accounting per subsystem and per memory region
+ *
+ * The Teensy 4.0 has two 512 KB RAM blocks that are not equally fast:
+ * - RAM1 is tightly coupled memory. Code runs from its ITCM part; the DTCM
+ *   part holds the initialized and zeroed globals with the stack above
+ *   them. It is accessed in a single cycle, without the cache.
+ * - RAM2 (OCRAM) sits behind the data cache. It holds the DMAMEM buffers
+ *   and the heap that malloc() and new take from.
+ *
+ * Buffers the capture interrupts and the message handler work on stay in
+ * DTCM; buffers that are filled and drained front to back (the logger
+ * buffers, the USB staging buffer, the replay ring) and the payload pool go
+ * to DMAMEM. The objects created with new at boot land on the heap in RAM2.
+ *
+ * The budget keeps a table of five subsystems. Each one has a probe, a
+ * function registered by the firmware that adds up the memory of the
+ * subsystem's objects into a MemoryUsage. sample() runs the probes and keeps
+ * the peak of every subsystem and of the heap. getRegions() reads the linker
+ * symbols for the size of each region, the heap statistics of the C library
+ * and the stack painted at boot.
+ *
+ * Only loop code may call sample() and getRegions(): the probes read
+ * buffers shared with interrupts without locking (a fill level may be one
+ * frame off), and the largest block search allocates from the heap.
+ */
+
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+#include <Arduino.h>
+#include "constants.h"
+
+/**
+ * \enum MemorySubsystem
+ * \brief Parts of the firmware memory is accounted to
+ */
+enum MemorySubsystem : uint8_t {
+    MEMORY_MONITOR,         ///< Network monitor tables, payload pool and snapshot server
+    MEMORY_CAN,             ///< CAN interfaces, capture rings, transmit scheduler and library buffers
+    MEMORY_DISPLAY,         ///< Display drivers, screen buffer and menus
+    MEMORY_LOGGER,          ///< Frame logger, replay ring and USB capture stream
+    MEMORY_ATTACK,          ///< Attack controller and the simulated devices
+    MEMORY_SUBSYSTEM_COUNT  ///< Number of subsystems
+};
+
+/**
+ * \struct MemoryUsage
+ * \brief Memory of one subsystem
+ *
+ * Probes start from an empty usage and add each object or buffer. Adding
+ * the high-water marks of several buffers overstates the peak somewhat,
+ * as they are rarely all full at once.
+ */
+struct MemoryUsage {
+    uint32_t reserved;      ///< Bytes set aside
+    uint32_t used;          ///< Bytes holding data now
+    uint32_t peak;          ///< Highest use seen
+
+    /**
+     * \brief Add storage that is always in use, e.g. an object or a frame buffer
+     *
+     * \param bytes Size
+     */
+    void addFixed(uint32_t bytes) {
+        reserved += bytes;
+        used += bytes;
+        peak += bytes;
+    }
+
+    /**
+     * \brief Add a buffer that fills and drains
+     *
+     * \param size Size of the buffer
+     * \param fill Bytes in the buffer now
+     * \param highWater Most bytes the buffer held, fill if it doesn't keep a mark
+     */
+    void addBuffer(uint32_t size, uint32_t fill, uint32_t highWater) {
+        reserved += size;
+        used += fill;
+        peak += highWater > fill ? highWater : fill;
+    }
+};
+
+/**
+ * \brief Adds up the memory of one subsystem
+ *
+ * \param[in,out] usage Usage to add to, empty on entry
+ */
+typedef void (*MemoryProbe)(MemoryUsage& usage);
+
+/**
+ * \struct MemoryRegions
+ * \brief Size and use of the RAM regions
+ */
+struct MemoryRegions {
+    uint32_t dtcmSize;      ///< DTCM part of RAM1, the rest is ITCM for code
+    uint32_t dtcmStatic;    ///< Globals in DTCM (.data and .bss)
+    uint32_t stackSize;     ///< DTCM above the globals, free for the stack
+    uint32_t stackPeak;     ///< Deepest stack use since boot
+    uint32_t ocramSize;     ///< RAM2
+    uint32_t dmamemStatic;  ///< DMAMEM buffers at the start of RAM2
+    uint32_t heapSize;      ///< Rest of RAM2, for the heap
+    uint32_t heapUsed;      ///< Bytes in allocated blocks
+    uint32_t heapPeak;      ///< Highest heapUsed seen by sample()
+    uint32_t heapFree;      ///< Freed blocks plus the heap not yet claimed
+    uint32_t heapLargest;   ///< Largest block an allocation can get now
+};
+
+/**
+ * \class Memory_Budget
+ * \brief Static table of the subsystem memory use
+ */
+class Memory_Budget {
+private:
+    static MemoryProbe probes[MEMORY_SUBSYSTEM_COUNT];     ///< Probe of each subsystem, or nullptr
+    static MemoryUsage usage[MEMORY_SUBSYSTEM_COUNT];      ///< Result of the last sample with peaks
+    static uint32_t heapPeak;                              ///< Highest heap use seen
+
+public:
+    /**
+     * \brief Paint the free stack area and clear the table
+     *
+     * Call first thing in setup(), before the stack has been deep.
+     */
+    static void begin();
+
+    /**
+     * \brief Register the probe of a subsystem
+     *
+     * \param subsystem Subsystem
+     * \param probe Function adding up its memory
+     */
+    static void setProbe(MemorySubsystem subsystem, MemoryProbe probe);
+
+    /**
+     * \brief Run every probe and update the peaks
+     */
+    static void sample();
+
+    /**
+     * \brief Set every peak to the current use
+     *
+     * The stack peak stays, it can only be measured since boot. The
+     * high-water marks the buffers keep themselves are cleared with those
+     * buffers' statistics.
+     */
+    static void resetPeaks();
+
+    /**
+     * \brief Get the memory of a subsystem as of the last sample
+     *
+     * \param subsystem Subsystem
+     * \return Usage
+     */
+    static const MemoryUsage& getUsage(MemorySubsystem subsystem) { return usage[subsystem]; }
+
+    /**
+     * \brief Get the short name of a subsystem
+     *
+     * \param subsystem Subsystem
+     * \return Name, at most 4 characters
+     */
+    static const char* getSubsystemName(MemorySubsystem subsystem);
+
+    /**
+     * \brief Measure the RAM regions
+     *
+     * Takes a few hundred microseconds: the stack is scanned and the largest
+     * free block found with trial allocations.
+     *
+     * \param[out] regions Sizes and use
+     */
+    static void getRegions(MemoryRegions& regions);
+
+    /**
+     * \brief Get the bytes in allocated heap blocks
+     *
+     * Cheap enough to bracket a call and see what it allocated.
+     *
+     * \return Heap in use
+     */
+    static uint32_t getHeapUsed();
+
+    /**
+     * \brief Find the largest block an allocation can get
+     *
+     * \return Block size, rounded down to MEMORY_HEAP_PROBE_STEP
+     */
+    static uint32_t getLargestFreeBlock();
+};
+
+#endif // MEMORY_BUDGET_H
@@ -18,13 +18,13 @@
  * - Navigation state (current option, row, column)
  * - Scrolling parameters for long text animation
  *
- * \param u8x8 Pointer to the U8x8 display driver instance for rendering.
+ * \param u8x8 Screen buffer to draw into, flushed to the display separately.
  * \param Title Title string displayed at the top of the menu.
  * \param userOptions Pointer to array of FunctionStruct menu options.
  * \param usrNumChoices Number of options in the userOptions array.
  * \param isMenu Operating mode flag: 1 for interactive menu, 0 for text display.
  */
-Menu::Menu(U8X8_SH1106_128X64_NONAME_HW_I2C* u8x8, String Title, FunctionStruct* userOptions, int usrNumChoices, int isMenu){
+Menu::Menu(Screen_Buffer* u8x8, const char* Title, FunctionStruct* userOptions, int usrNumChoices, int isMenu){
     // Store display driver reference
     screen = u8x8;
 
@@ -52,33 +52,6 @@ Menu::Menu(U8X8_SH1106_128X64_NONAME_HW_I2C* u8x8, String Title, FunctionStruct*
     curr_col = 0;
 }
 
-/************************************************************************//**
- * \brief Truncates a string to fit within the specified maximum length.
- *
- * Handles string truncation for display on the OLED screen. If the input
- * string exceeds the maximum length, it is truncated and an ellipsis (...)
- * is appended to indicate continuation.
- *
- * \param str The input string to truncate.
- * \param maxLen Maximum allowed length for the output string.
- * \return Truncated string that fits within maxLen characters.
- *         Returns original string if already within limits.
- */
-String Menu::truncateString(String str, int maxLen) {
-    // Return unchanged if within length limit
-    if(str.length() <= maxLen) {
-        return str;
-    }
-
-    // Truncate and add ellipsis if there's room for it
-    if(maxLen > 3) {
-        return str.substring(0, maxLen - 3) + "...";
-    }
-
-    // For very short maxLen, just truncate without ellipsis
-    return str.substring(0, maxLen);
-}
-
 /************************************************************************//**
  * \brief Renders the complete menu to the OLED display.
  *
@@ -106,7 +79,7 @@ int Menu::printMenu(){
     scrollOffset = 0;  // Reset scroll when redrawing menu
 
     // Calculate available width for option text after operand prefix
-    int maxOptionLen = num_cols - menu_operand.length();
+    int maxOptionLen = num_cols - (int)strlen(menu_operand);
 
     // Limit visible items to 6 (leaves room for title and spacing)
     int maxVisibleItems = 6;
@@ -122,23 +95,23 @@ int Menu::printMenu(){
         }
 
         // Draw selection indicator prefix
-        screen -> drawString(curr_col, curr_row, menu_operand.c_str());
-        curr_col += menu_operand.length();
+        screen -> drawString(curr_col, curr_row, menu_operand);
+        curr_col += strlen(menu_operand);
 
         // Prepare option text for display
-        String optionText = options[i].name;
+        char optionText[SCREEN_COLS + 1];
 
-        if(curr_option == i && optionText.length() > maxOptionLen) {
-            // Selected item is too long - show beginning for now
+        if(curr_option == i) {
+            // Selected item shows its beginning if too long
             // (will scroll via updateScrollingText())
-            optionText = optionText.substring(0, maxOptionLen);
-        } else if(optionText.length() > maxOptionLen) {
+            snprintf(optionText, sizeof(optionText), "%.*s", maxOptionLen, options[i].name);
+        } else {
             // Non-selected items: truncate with ellipsis
-            optionText = truncateString(optionText, maxOptionLen);
+            truncateText(options[i].name, maxOptionLen, optionText);
         }
 
         // Draw the option text
-        screen -> drawString(curr_col, curr_row, optionText.c_str());
+        screen -> drawString(curr_col, curr_row, optionText);
 
         // Move to next row, reset column
         curr_row++;
@@ -174,31 +147,30 @@ void Menu::updateScrollingText() {
     lastScrollTime = currentTime;
 
     // Calculate maximum text length for option display area
-    int maxOptionLen = num_cols - menu_operand.length();
+    int maxOptionLen = num_cols - (int)strlen(menu_operand);
 
     // Check if current option needs scrolling
     if(curr_option < num_choices) {
-        String optionText = options[curr_option].name;
+        const char* optionText = options[curr_option].name;
+        int optionLen = strlen(optionText);
 
-        if(optionText.length() > maxOptionLen) {
+        if(optionLen > maxOptionLen) {
             // This option text exceeds display width - scroll it
             scrollOffset++;
 
             // Reset scroll offset when reaching end of text
-            if(scrollOffset > optionText.length() - maxOptionLen) {
+            if(scrollOffset > optionLen - maxOptionLen) {
                 scrollOffset = 0;
             }
 
             // Calculate the display row for the selected item
             int displayRow = 2 + curr_option;
 
-            // Clear the option text area (fill with spaces)
+            // Draw the scrolled portion of text, padded over the old one
+            Screen_Line scrolledText;
+            scrolledText.append(optionText + scrollOffset, maxOptionLen).padTo(maxOptionLen);
             screen->setInverseFont(1);
-            screen->drawString(menu_operand.length(), displayRow, "             ");
-
-            // Extract and draw the scrolled portion of text
-            String scrolledText = optionText.substring(scrollOffset, scrollOffset + maxOptionLen);
-            screen->drawString(menu_operand.length(), displayRow, scrolledText.c_str());
+            screen->drawString(strlen(menu_operand), displayRow, scrolledText.c_str());
 
             // Restore normal font mode
             screen->setInverseFont(0);
@@ -275,7 +247,7 @@ int Menu::updateOption(){
     }
 
     // Calculate maximum text length for option display area
-    int maxOptionLen = num_cols - menu_operand.length();
+    int maxOptionLen = num_cols - (int)strlen(menu_operand);
 
     // Menu options begin on row 2 (after title)
     curr_row = 2;
@@ -290,23 +262,23 @@ int Menu::updateOption(){
         }
 
         // Draw selection indicator prefix
-        screen -> drawString(curr_col, curr_row, menu_operand.c_str());
-        curr_col += menu_operand.length();
+        screen -> drawString(curr_col, curr_row, menu_operand);
+        curr_col += strlen(menu_operand);
 
         // Prepare option text for display
-        String optionText = options[i].name;
+        char optionText[SCREEN_COLS + 1];
 
-        if(curr_option == i && optionText.length() > maxOptionLen) {
-            // Selected item is too long - show beginning
+        if(curr_option == i) {
+            // Selected item shows its beginning if too long
             // (will scroll via updateScrollingText())
-            optionText = optionText.substring(0, maxOptionLen);
-        } else if(optionText.length() > maxOptionLen) {
+            snprintf(optionText, sizeof(optionText), "%.*s", maxOptionLen, options[i].name);
+        } else {
             // Non-selected items: truncate with ellipsis
-            optionText = truncateString(optionText, maxOptionLen);
+            truncateText(options[i].name, maxOptionLen, optionText);
         }
 
         // Draw the option text
-        screen -> drawString(curr_col, curr_row, optionText.c_str());
+        screen -> drawString(curr_col, curr_row, optionText);
 
         // Move to next row, reset column
         curr_row++;
@@ -328,21 +300,22 @@ int Menu::updateOption(){
  * \param curr_line The text string to display centered.
  * \return 0 on success (text fits), -1 if text was truncated.
  */
-int Menu::setw(String curr_line){
+int Menu::setw(const char* curr_line){
     // Calculate length and remaining space
-    int line_len = curr_line.length();
+    int line_len = strlen(curr_line);
     int chars_left = num_cols - line_len;
 
     // Check if string exceeds screen width
     if(chars_left<0){
         // Text too long - truncate with ellipsis
-        String truncated = truncateString(curr_line, num_cols);
-        screen -> drawString(curr_col, curr_row, truncated.c_str());
+        char truncated[SCREEN_COLS + 1];
+        truncateText(curr_line, num_cols, truncated);
+        screen -> drawString(curr_col, curr_row, truncated);
         curr_row++;
         return -1;  // Indicate truncation occurred
     }else{
         // Text fits - center it by adding half the remaining space as offset
-        screen -> drawString(curr_col+(chars_left/2), curr_row, curr_line.c_str());
+        screen -> drawString(curr_col+(chars_left/2), curr_row, curr_line);
         curr_row++;
         return 0;  // Success
     }
@@ -352,7 +325,7 @@ int Menu::setw(String curr_line){
  * \brief Resets the display and menu state to initial values.
  *
  * Performs a complete reset of the display and internal state:
- * - Clears the OLED display buffer
+ * - Clears the screen buffer (the panel only receives changed cells)
  * - Moves cursor to home position
  * - Sets default font (ArtossSans 8-pixel)
  * - Disables inverse font mode
@@ -11,7 +11,8 @@
 #define MENU_H
 
 #include <Arduino.h>
-#include <U8x8lib.h>
+#include <Screen_Buffer.h>
+#include <Screen_Line.h>
 
 /**
  * \brief Function pointer type for menu item callbacks.
@@ -28,7 +29,7 @@ typedef void (*FunctionPointer)();
  * and an optional function pointer that is called when the item is selected.
  */
 typedef struct {
-    String name;            ///< Display name of the menu option shown on screen
+    const char* name;       ///< Display name of the menu option shown on screen (not copied)
     FunctionPointer func;   ///< Callback function executed on selection (can be NULL)
 } FunctionStruct;
 
@@ -47,23 +48,10 @@ typedef struct {
  * The class handles display rendering, cursor navigation, text scrolling for
  * long menu items, and callback management for selected options.
  *
- * \note This class is designed specifically for the U8X8_SH1106_128X64_NONAME_HW_I2C
- *       display driver but could be adapted for other U8x8-compatible displays.
+ * \note The menu draws into a Screen_Buffer, which sends only the changed
+ *       cells to the SH1106 display when it is flushed.
  */
 class Menu {
-private:
-    /**
-     * \brief Truncates a string to fit within the specified maximum length.
-     *
-     * If the input string exceeds the maximum length, it is truncated
-     * to ensure proper display on the OLED screen without overflow.
-     *
-     * \param str The input string to truncate.
-     * \param maxLen Maximum allowed length for the output string.
-     * \return Truncated string that fits within maxLen characters.
-     */
-    String truncateString(String str, int maxLen);
-
 public:
     int curr_option;        ///< Index of the currently selected menu option (0-based)
     int num_choices;        ///< Total number of menu options available
@@ -72,10 +60,10 @@ public:
     int num_cols;           ///< Number of display columns (character width)
     int curr_row;           ///< Current cursor row position on display
     int curr_col;           ///< Current cursor column position on display
-    String menu_operand;    ///< Optional operand string for menu operations
+    const char* menu_operand; ///< Selection indicator prefix drawn before each option
     FunctionStruct* options; ///< Pointer to array of menu options (FunctionStruct)
-    String menu_title;      ///< Title string displayed at the top of the menu
-    U8X8_SH1106_128X64_NONAME_HW_I2C* screen; ///< Pointer to the U8x8 display driver instance
+    const char* menu_title; ///< Title string displayed at the top of the menu (not copied)
+    Screen_Buffer* screen;  ///< Screen buffer the menu draws into
 
     // Scrolling support
     int scrollOffset;               ///< Current horizontal scroll offset for long text
@@ -88,14 +76,14 @@ public:
      * Initializes the menu system with the specified display, title, options,
      * and operating mode. Sets up internal state for navigation and rendering.
      *
-     * \param u8x8 Pointer to the U8x8 display driver instance.
+     * \param u8x8 Screen buffer to draw into.
      * \param Title Title string to display at the top of the menu.
      * \param userOptions Pointer to array of FunctionStruct menu options.
      * \param usrNumChoices Number of options in the userOptions array.
      * \param isMenu Operating mode flag: 1 for interactive menu, 0 for text display.
      */
-    Menu(U8X8_SH1106_128X64_NONAME_HW_I2C* u8x8,
-         String Title,
+    Menu(Screen_Buffer* u8x8,
+         const char* Title,
          FunctionStruct* userOptions,
          int usrNumChoices,
          int isMenu);
@@ -183,7 +171,7 @@ public:
      * \param curr_line The text line to measure and set width for.
      * \return The calculated width in characters.
      */
-    int setw(String curr_line);
+    int setw(const char* curr_line);
 
     /**
      * \brief Resets the menu to its initial state.
@@ -10,6 +10,9 @@
 
 #include "Menu_Controller.h"
 
+// Attack type shown on the status screen, scrolls since "Type: Impersonate" is 17 chars
+static const char* const impersonateTypeName = "Impersonate";
+
 /**
  * @brief Checks if any attack is currently active.
  *
@@ -59,23 +62,16 @@ void Menu_Controller::displaySpamActive() {
     prepScreen();
 
     // Clear displayedLines cache since we're doing a full redraw
-    for (int i = 0; i < 8; i++) {
-        displayedLines[i] = "";
-    }
+    resetDisplayedLines();
 
-    screen->drawString(0, 0, "DOS ATTACK");
-    displayedLines[0] = "DOS ATTACK";
-
-    displayedLines[2] = "";
+    drawLine(0, "DOS ATTACK");
 
     // Message count (dynamic)
     char line2[17];
     snprintf(line2, sizeof(line2), "Msgs: %-9lu", attackController->getSpamMessageCount());
-    screen->drawString(0, 3, line2);
-    displayedLines[3] = line2;
+    drawLine(3, line2);
 
-    screen->drawString(0, 7, "< BACK");
-    displayedLines[7] = "< BACK ";
+    drawLine(7, "< BACK");
 
     spamActiveInitialized = true;
 }
@@ -116,7 +112,6 @@ void Menu_Controller::displayImpDeviceSelect() {
     screen->drawString(0, 0, "SELECT DEVICE");
 
     std::vector<uint8_t>& fullDeviceList = monitor->getDeviceList();
-    std::map<uint8_t, DeviceInfo>& devices = monitor->getDevices();
 
     // Build filtered list of devices with impersonatable PGNs
     // Now includes own sensors (Sensor 1, 2, 3) - they will be marked with [OWN]
@@ -149,28 +144,24 @@ void Menu_Controller::displayImpDeviceSelect() {
     int row = 1;
     for (int i = startIdx; i < (int)impDeviceList.size() && row < 7; i++) {
         uint8_t addr = impDeviceList[i];
-        DeviceInfo& dev = devices[addr];
+        DeviceInfo* dev = monitor->getDevice(addr);
+        if (dev == nullptr) continue;
 
         char line[17];
         // Show selection indicator and device info
         char indicator = (i == impDeviceScrollIndex) ? '>' : ' ';
 
         // Check if this is one of our own sensors
-        String devName = dev.name;
-        bool isOwnSensor = (devName == "Sensor 1" || devName == "Sensor 2" || devName == "Sensor 3");
+        const char* devName = dev->name;
+        bool isOwnSensor = (strcmp(devName, "Sensor 1") == 0 || strcmp(devName, "Sensor 2") == 0 ||
+                            strcmp(devName, "Sensor 3") == 0);
 
         if (isOwnSensor) {
             // Show with [OWN] marker - truncate name more to fit
-            if (devName.length() > 7) {
-                devName = devName.substring(0, 7);
-            }
-            snprintf(line, sizeof(line), "%c%s[OWN]", indicator, devName.c_str());
+            snprintf(line, sizeof(line), "%c%.7s[OWN]", indicator, devName);
         } else {
             // Normal device - truncate to fit
-            if (devName.length() > 10) {
-                devName = devName.substring(0, 10);
-            }
-            snprintf(line, sizeof(line), "%c%s", indicator, devName.c_str());
+            snprintf(line, sizeof(line), "%c%.10s", indicator, devName);
 
             // Show impersonatable PGN count on the right for non-own devices
             char pgnCount[5];
@@ -232,11 +223,9 @@ void Menu_Controller::displayImpPGNSelect() {
         char indicator = (i == impPGNScrollIndex) ? '>' : ' ';
 
         // Get PGN name (truncated)
-        String pgnName = monitor->getPGNName(pgn);
-        if (pgnName.length() > 14) {
-            pgnName = pgnName.substring(0, 14);
-        }
-        snprintf(line, sizeof(line), "%c%s", indicator, pgnName.c_str());
+        char pgnName[N2K_PGN_NAME_SIZE];
+        N2K_Monitor::formatPGNName(pgn, pgnName, sizeof(pgnName));
+        snprintf(line, sizeof(line), "%c%.14s", indicator, pgnName);
         screen->drawString(0, row, line);
 
         row++;
@@ -267,9 +256,7 @@ void Menu_Controller::displayImpFieldSelect() {
     prepScreen();
 
     // Clear displayedLines cache since we're doing a full redraw
-    for (int i = 0; i < 8; i++) {
-        displayedLines[i] = "";
-    }
+    resetDisplayedLines();
 
     uint8_t impTargetAddress = attackController->getImpTargetAddress();
     uint32_t impTargetPGN = attackController->getImpTargetPGN();
@@ -280,9 +267,9 @@ void Menu_Controller::displayImpFieldSelect() {
     snprintf(header, sizeof(header), "D:%d P:%lu", impTargetAddress, (unsigned long)impTargetPGN);
     screen->drawString(0, 0, header);
 
-    // Get editable field names for this PGN (only fields that can be spoofed)
-    std::vector<String> editableFields = attackController->getEditableFieldNames(impTargetPGN);
-    int numFields = editableFields.size();
+    // Editable fields of this PGN (only fields that can be spoofed), straight from the table
+    const PGNDef* def = getPGNDef(impTargetPGN);
+    int numFields = (def != nullptr) ? getPGNDefEditableCount(*def) : 0;
 
     if (numFields == 0) {
         screen->drawString(0, 2, "No fields");
@@ -292,21 +279,17 @@ void Menu_Controller::displayImpFieldSelect() {
 
     // Display selected field name (row 2)
     if (impSelectedFieldIndex < numFields) {
-        String fieldName = editableFields[impSelectedFieldIndex];
-        if (fieldName.length() > 15) {
-            fieldName = fieldName.substring(0, 15);
-        }
+        const PGNFieldDef* field = getPGNField(impTargetPGN, impSelectedFieldIndex);
 
         char fieldLine[17];
-        snprintf(fieldLine, sizeof(fieldLine), ">%s", fieldName.c_str());
+        snprintf(fieldLine, sizeof(fieldLine), ">%.15s", field ? field->name : "");
         screen->drawString(0, 2, fieldLine);
     }
 
     // Display current value (row 3) - track in cache for efficient updates
     char valueLine[17];
     snprintf(valueLine, sizeof(valueLine), "Val: %-9.1f", attackController->getImpFieldValue());
-    screen->drawString(0, 3, valueLine);
-    displayedLines[3] = valueLine;
+    drawLine(3, valueLine);
 
     // Display range (row 4)
     char rangeLine[17];
@@ -318,12 +301,10 @@ void Menu_Controller::displayImpFieldSelect() {
     bool currentFieldLocked = attackController->isFieldLocked(impSelectedFieldIndex);
     if (currentFieldLocked) {
         screen->setInverseFont(1);
-        screen->drawString(0, 5, " LOCKED         ");
+        drawLine(5, " LOCKED");
         screen->setInverseFont(0);
-        displayedLines[5] = " LOCKED ";
     } else {
-        screen->drawString(0, 5, "SEL=Lock        ");
-        displayedLines[5] = "SEL=Lock        ";
+        drawLine(5, "SEL=Lock");
     }
 
     // Field navigation hint (row 6)
@@ -356,12 +337,9 @@ void Menu_Controller::updateImpFieldSelectValue() {
     bool currentFieldLocked = attackController->isFieldLocked(impSelectedFieldIndex);
     if (currentFieldLocked) {
         // Draw locked status with inverse
-        if (displayedLines[5] != " LOCKED ") {
-            displayedLines[5] = " LOCKED ";
-            screen->setInverseFont(1);
-            screen->drawString(0, 5, " LOCKED         ");
-            screen->setInverseFont(0);
-        }
+        screen->setInverseFont(1);
+        drawLine(5, " LOCKED");
+        screen->setInverseFont(0);
     } else {
         drawLine(5, "SEL=Lock");
     }
@@ -394,79 +372,71 @@ void Menu_Controller::displayAttackStatus() {
     prepScreen();
 
     // Clear displayedLines cache since we're doing a full redraw
-    for (int i = 0; i < 8; i++) {
-        displayedLines[i] = "";
-    }
+    resetDisplayedLines();
 
     // Reset scroll offset when first displaying
     attackStatusScrollOffset = 0;
 
-    screen->drawString(0, 0, "ATTACK ACTIVE");
-    displayedLines[0] = "ATTACK ACTIVE";
+    drawLine(0, "ATTACK ACTIVE");
 
     AttackType attackType = attackController->getActiveAttackType();
 
     if (attackType == ATTACK_SPAM) {
-        screen->drawString(0, 2, "Type: DOS Attack");
-        displayedLines[2] = "DOS Attack";  // Store type name for consistency
+        drawLine(2, "Type: DOS Attack");
 
         char line[17];
         snprintf(line, sizeof(line), "Msgs: %lu", attackController->getSpamMessageCount());
-        screen->drawString(0, 3, line);
-        displayedLines[3] = line;
+        drawLine(3, line);
     } else if (attackType == ATTACK_IMPERSONATE) {
-        // "Type: Impersonate" is 17 chars, too long for 16-char display
-        // Store full type name for scrolling, display truncated initially
-        String typeName = "Impersonate";
-        displayedLines[2] = typeName;  // Store for scrolling
-
-        int typeAvailWidth = 16 - 6;  // "Type: " = 6 chars
-        String displayType = typeName.substring(0, typeAvailWidth);
-        char typeLine[17];
-        snprintf(typeLine, sizeof(typeLine), "Type: %s", displayType.c_str());
-        screen->drawString(0, 2, typeLine);
-
-        // Show target device (may need scrolling)
-        uint8_t targetAddr = attackController->getImpTargetAddress();
-        DeviceInfo* device = monitor->getDevice(targetAddr);
-        char line[17];
-        String targetLabel = "Target: ";
-        String devName = device ? device->name : ("Addr " + String(targetAddr));
-        int availableWidth = 16 - targetLabel.length();
-
-        // Display initial view (scrolling handled in update)
-        String displayName = devName.substring(0, availableWidth);
-        snprintf(line, sizeof(line), "%s%s", targetLabel.c_str(), displayName.c_str());
-        screen->drawString(0, 3, line);
-        displayedLines[3] = devName;  // Store full name for scrolling
-
-        // Show target PGN (may need scrolling)
-        uint32_t targetPGN = attackController->getImpTargetPGN();
-        String pgnName = monitor->getPGNName(targetPGN);
-        String pgnLabel = "PGN: ";
-        availableWidth = 16 - pgnLabel.length();
-
-        String displayPGN = pgnName.substring(0, availableWidth);
-        snprintf(line, sizeof(line), "%s%s", pgnLabel.c_str(), displayPGN.c_str());
-        screen->drawString(0, 4, line);
-        displayedLines[4] = pgnName;  // Store full name for scrolling
+        // "Type: Impersonate" is 17 chars, too long for 16-char display;
+        // the rows show the start of each name, scrolling happens in update
+        char devName[N2K_DEVICE_NAME_SIZE];
+        char pgnName[N2K_PGN_NAME_SIZE];
+        getAttackStatusNames(devName, pgnName);
+
+        Screen_Line line("Type: ");
+        drawLine(2, line.append(impersonateTypeName));
+
+        line = Screen_Line("Target: ");
+        drawLine(3, line.append(devName));
+
+        line = Screen_Line("PGN: ");
+        drawLine(4, line.append(pgnName));
 
         // Show if impersonating own sensor
         if (attackController->isImpersonatingOwnSensor()) {
-            screen->drawString(0, 5, "[OWN SENSOR]");
-            displayedLines[5] = "[OWN SENSOR]";
+            drawLine(5, "[OWN SENSOR]");
         }
     }
 
     // Bottom row - stop instruction
     screen->setInverseFont(1);
-    screen->drawString(0, 7, "SELECT = STOP   ");
+    drawLine(7, "SELECT = STOP");
     screen->setInverseFont(0);
-    displayedLines[7] = "SELECT = STOP   ";
 
     attackStatusInitialized = true;
 }
 
+/**
+ * @brief Gets the target names shown on the attack status screen.
+ *
+ * The names are looked up again on every scroll step instead of being kept
+ * around, so a renamed target shows its new name.
+ *
+ * @param devName Receives the device name, or "Addr N" if the target is gone
+ * @param pgnName Receives the PGN name
+ */
+void Menu_Controller::getAttackStatusNames(char* devName, char* pgnName) {
+    uint8_t targetAddr = attackController->getImpTargetAddress();
+    DeviceInfo* device = monitor->getDevice(targetAddr);
+    if (device) {
+        snprintf(devName, N2K_DEVICE_NAME_SIZE, "%s", device->name);
+    } else {
+        snprintf(devName, N2K_DEVICE_NAME_SIZE, "Addr %u", targetAddr);
+    }
+    N2K_Monitor::formatPGNName(attackController->getImpTargetPGN(), pgnName, N2K_PGN_NAME_SIZE);
+}
+
 /**
  * @brief Updates the attack status display with scrolling text and live values.
  *
@@ -494,31 +464,36 @@ void Menu_Controller::updateAttackStatusDisplay() {
             lastAttackStatusScrollUpdate = currentTime;
 
             // Check if any text needs scrolling
-            String typeName = displayedLines[2];  // Full type name stored here
-            String devName = displayedLines[3];   // Full device name stored here
-            String pgnName = displayedLines[4];   // Full PGN name stored here
+            char devName[N2K_DEVICE_NAME_SIZE];
+            char pgnName[N2K_PGN_NAME_SIZE];
+            getAttackStatusNames(devName, pgnName);
+            const char* typeName = impersonateTypeName;
+
+            int typeLen = strlen(typeName);
+            int devLen = strlen(devName);
+            int pgnLen = strlen(pgnName);
 
             int typeAvailWidth = 16 - 6;    // "Type: " = 6 chars
             int targetAvailWidth = 16 - 8;  // "Target: " = 8 chars
             int pgnAvailWidth = 16 - 5;     // "PGN: " = 5 chars
 
-            bool needsScroll = (typeName.length() > (unsigned int)typeAvailWidth) ||
-                              (devName.length() > (unsigned int)targetAvailWidth) ||
-                              (pgnName.length() > (unsigned int)pgnAvailWidth);
+            bool needsScroll = (typeLen > typeAvailWidth) ||
+                              (devLen > targetAvailWidth) ||
+                              (pgnLen > pgnAvailWidth);
 
             if (needsScroll) {
                 // Calculate max scroll needed
                 int maxScroll = 0;
-                if (typeName.length() > (unsigned int)typeAvailWidth) {
-                    int typeScroll = typeName.length() - typeAvailWidth + 3;  // +3 for wrap padding
+                if (typeLen > typeAvailWidth) {
+                    int typeScroll = typeLen - typeAvailWidth + 3;  // +3 for wrap padding
                     if (typeScroll > maxScroll) maxScroll = typeScroll;
                 }
-                if (devName.length() > (unsigned int)targetAvailWidth) {
-                    int devScroll = devName.length() - targetAvailWidth + 3;
+                if (devLen > targetAvailWidth) {
+                    int devScroll = devLen - targetAvailWidth + 3;
                     if (devScroll > maxScroll) maxScroll = devScroll;
                 }
-                if (pgnName.length() > (unsigned int)pgnAvailWidth) {
-                    int pgnScroll = pgnName.length() - pgnAvailWidth + 3;
+                if (pgnLen > pgnAvailWidth) {
+                    int pgnScroll = pgnLen - pgnAvailWidth + 3;
                     if (pgnScroll > maxScroll) maxScroll = pgnScroll;
                 }
 
@@ -529,30 +504,21 @@ void Menu_Controller::updateAttackStatusDisplay() {
                 }
 
                 // Update type row if it needs scrolling
-                if (typeName.length() > (unsigned int)typeAvailWidth) {
-                    String scrollText = typeName + "   " + typeName;
-                    String visible = scrollText.substring(attackStatusScrollOffset, attackStatusScrollOffset + typeAvailWidth);
-                    char line[17];
-                    snprintf(line, sizeof(line), "Type: %s", visible.c_str());
-                    screen->drawString(0, 2, line);
+                if (typeLen > typeAvailWidth) {
+                    Screen_Line line("Type: ");
+                    drawLine(2, line.appendScrolled(typeName, attackStatusScrollOffset, typeAvailWidth));
                 }
 
                 // Update device name row if it needs scrolling
-                if (devName.length() > (unsigned int)targetAvailWidth) {
-                    String scrollText = devName + "   " + devName;
-                    String visible = scrollText.substring(attackStatusScrollOffset, attackStatusScrollOffset + targetAvailWidth);
-                    char line[17];
-                    snprintf(line, sizeof(line), "Target: %s", visible.c_str());
-                    screen->drawString(0, 3, line);
+                if (devLen > targetAvailWidth) {
+                    Screen_Line line("Target: ");
+                    drawLine(3, line.appendScrolled(devName, attackStatusScrollOffset, targetAvailWidth));
                 }
 
                 // Update PGN name row if it needs scrolling
-                if (pgnName.length() > (unsigned int)pgnAvailWidth) {
-                    String scrollText = pgnName + "   " + pgnName;
-                    String visible = scrollText.substring(attackStatusScrollOffset, attackStatusScrollOffset + pgnAvailWidth);
-                    char line[17];
-                    snprintf(line, sizeof(line), "PGN: %s", visible.c_str());
-                    screen->drawString(0, 4, line);
+                if (pgnLen > pgnAvailWidth) {
+                    Screen_Line line("PGN: ");
+                    drawLine(4, line.appendScrolled(pgnName, attackStatusScrollOffset, pgnAvailWidth));
                 }
             }
         }
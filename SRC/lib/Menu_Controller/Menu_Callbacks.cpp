@@ -39,6 +39,46 @@ void Menu_Controller::callback_Configure() {
     if(instance) instance->changeMenu(MENU_CONFIGURE);
 }
 
+/**
+ * @brief Callback for "Logger" menu option.
+ *
+ * Navigates to the frame logger screen where recording to the SD card
+ * (or onboard flash) can be started and stopped.
+ */
+void Menu_Controller::callback_Logger() {
+    if(instance) instance->changeMenu(MENU_LOGGER);
+}
+
+/**
+ * @brief Callback for "Bus Stats" menu option.
+ *
+ * Navigates to the bus statistics screen showing the bus load and the
+ * rate and jitter of each PGN on the network.
+ */
+void Menu_Controller::callback_BusStats() {
+    if(instance) instance->changeMenu(MENU_BUS_STATS);
+}
+
+/**
+ * @brief Callback for "Alerts" menu option.
+ *
+ * Navigates to the list of claim storms, conflicting sources and timing or
+ * value anomalies the monitor detected.
+ */
+void Menu_Controller::callback_Alerts() {
+    if(instance) instance->changeMenu(MENU_ALERTS);
+}
+
+/**
+ * @brief Callback for "Replay" menu option.
+ *
+ * Navigates to the screen where a recorded log is played back into the
+ * monitor or onto CAN1.
+ */
+void Menu_Controller::callback_Replay() {
+    if(instance) instance->changeMenu(MENU_REPLAY);
+}
+
 /**
  * @brief Callback for "Attacks" menu option.
  *
@@ -223,6 +263,46 @@ void Menu_Controller::callback_StaleCleanupToggle() {
     }
 }
 
+/**
+ * @brief Callback for "Capture Mode" option.
+ *
+ * Navigates to the capture mode screen where the user can cycle the USB
+ * capture output between off, candump text and GVRET binary.
+ */
+void Menu_Controller::callback_CaptureMode() {
+    if(instance) {
+        // navigateBack for MENU_CAPTURE_MODE goes directly to MENU_DEVICE_CONFIG
+        instance->changeMenu(MENU_CAPTURE_MODE);
+    }
+}
+
+/**
+ * @brief Callback for "CAN2 Filters" option.
+ *
+ * Navigates to the screen where the source address and PGN filter sets of
+ * the monitoring bus are switched and edited.
+ */
+void Menu_Controller::callback_CanFilters() {
+    if(instance) {
+        // navigateBack for MENU_CAN_FILTERS goes directly to MENU_DEVICE_CONFIG
+        instance->changeMenu(MENU_CAN_FILTERS);
+    }
+}
+
+#if PROFILER_ENABLED
+/**
+ * @brief Callback for "Profiler" option.
+ *
+ * Navigates to the screen with the cycle counter timings of the code zones.
+ */
+void Menu_Controller::callback_Profiler() {
+    if(instance) {
+        // navigateBack for MENU_PROFILER goes directly to MENU_DEVICE_CONFIG
+        instance->changeMenu(MENU_PROFILER);
+    }
+}
+#endif
+
 /**
  * @brief Callback for "Info" option in About menu.
  *
@@ -235,6 +315,19 @@ void Menu_Controller::callback_AboutInfo() {
     }
 }
 
+/**
+ * @brief Monitor watch callback for the PGN on the detail screen.
+ *
+ * Runs from the monitor's message handler, so it only flags the change;
+ * update() redraws the values at its own pace.
+ *
+ * @param source Source address of the changed entry
+ * @param pgn PGN number of the changed entry
+ */
+void Menu_Controller::callback_WatchedPGN(uint8_t source, uint32_t pgn) {
+    if(instance) instance->watchedPGNChanged = true;
+}
+
 /**
  * @brief Callback for "Supported PGNs" option in About menu.
  *
@@ -360,12 +453,12 @@ void Menu_Controller::toggleSensorActive(int sensorNum) {
     if(sensorMenu != nullptr && targetSensor != nullptr) {
         // Toggle the text in the menu options and the actual sensor state
         // Active is at index 2 (after Manufacturer and Device Type)
-        String currentText = sensorMenu->options[2].name;
-        if(currentText.indexOf("YES") != -1) {
-            sensorMenu->options[2].name = String("Active: NO");
+        const char* currentText = sensorMenu->options[2].name;
+        if(strstr(currentText, "YES") != nullptr) {
+            sensorMenu->options[2].name = "Active: NO";
             targetSensor->setActive(false);
         } else {
-            sensorMenu->options[2].name = String("Active: YES");
+            sensorMenu->options[2].name = "Active: YES";
             targetSensor->setActive(true);
         }
 
@@ -436,42 +529,42 @@ void Menu_Controller::updateSensorConfigDisplay(int sensorNum) {
         prepScreen();
 
         // Row 0: Title
-        String title = String("SENSOR ") + String(sensorNum + 1);
-        int padding = (screen->getCols() - title.length()) / 2;
-        screen->drawString(padding, 0, title.c_str());
+        char title[SCREEN_COLS + 1];
+        int titleLen = snprintf(title, sizeof(title), "SENSOR %d", sensorNum + 1);
+        int padding = (screen->getCols() - titleLen) / 2;
+        screen->drawString(padding, 0, title);
 
         // Row 2: Current manufacturer - uses MANUFACTURERS array from constants.h
         uint16_t currentCode = targetSensor->getManufacturerCode();
         const char* mfrNamePtr = getManufacturerName(currentCode);
-        String mfrName = mfrNamePtr ? String(mfrNamePtr) : String(currentCode);
-        String mfrLine = "Mfr:" + mfrName;
-        if(mfrLine.length() > 16) mfrLine = mfrLine.substring(0, 16);
+        Screen_Line mfrLine("Mfr:");
+        if(mfrNamePtr) {
+            mfrLine.append(mfrNamePtr);
+        } else {
+            mfrLine.appendf("%u", currentCode);
+        }
         screen->drawString(0, 2, mfrLine.c_str());
 
         // Row 3: Show current PGN type with scrolling if needed
         MessageType currentType = targetSensor->getMessageType();
-        String typeName = String(getSensorDisplayName((int)currentType));
+        const char* typeName = getSensorDisplayName((int)currentType);
         screen->drawString(0, 3, "Type:");
 
         // If type name fits, just display it; otherwise scroll
-        if((int)typeName.length() <= SCROLL_VISIBLE_CHARS) {
-            screen->drawString(5, 3, typeName.c_str());
+        if((int)strlen(typeName) <= SCROLL_VISIBLE_CHARS) {
+            screen->drawString(5, 3, typeName);
         } else {
             // Add padding for smooth scroll wrap-around
-            String scrollText = typeName + "   " + typeName;
-            String visible = scrollText.substring(typeScrollOffset, typeScrollOffset + SCROLL_VISIBLE_CHARS);
-            // Pad to clear any leftover characters
-            while((int)visible.length() < SCROLL_VISIBLE_CHARS) visible += " ";
+            Screen_Line visible;
+            visible.appendScrolled(typeName, typeScrollOffset, SCROLL_VISIBLE_CHARS);
             screen->drawString(5, 3, visible.c_str());
         }
 
         // Row 4: Current value
         screen->drawString(0, 4, "Value:");
-        String valueStr = String(targetSensor->getRawValue());
-        if(valueStr.length() > 9) {
-            valueStr = valueStr.substring(0, 9);
-        }
-        screen->drawString(6, 4, valueStr.c_str());
+        char valueStr[10];
+        snprintf(valueStr, sizeof(valueStr), "%d", targetSensor->getRawValue());
+        screen->drawString(6, 4, valueStr);
 
         // Rows 5, 6, 7: Menu options (Manufacturer, Device Type, Active)
         // Option 0 - Manufacturer
@@ -498,12 +591,8 @@ void Menu_Controller::updateSensorConfigDisplay(int sensorNum) {
         }
 
         // Display the active state from the menu option
-        String activeText = targetMenu->options[2].name;
-        if(activeText.length() > 13) {
-            activeText = activeText.substring(0, 13);
-        }
-        String displayLine = String(" * ") + activeText;
-        while(displayLine.length() < 16) displayLine += " ";
+        Screen_Line displayLine(" * ");
+        displayLine.append(targetMenu->options[2].name).padTo(SCREEN_COLS);
         screen->drawString(0, 7, displayLine.c_str());
 
         screen->setInverseFont(0);
@@ -533,10 +622,8 @@ void Menu_Controller::updateSensorValueOnly(int sensorNum) {
         // Clear the value area and redraw (row 4, starting at col 6)
         screen->drawString(6, 4, "          ");  // Clear old value
 
-        String valueStr = String(targetSensor->getRawValue());
-        if(valueStr.length() > 9) {
-            valueStr = valueStr.substring(0, 9);
-        }
-        screen->drawString(6, 4, valueStr.c_str());
+        char valueStr[10];
+        snprintf(valueStr, sizeof(valueStr), "%d", targetSensor->getRawValue());
+        screen->drawString(6, 4, valueStr);
     }
 }
@@ -18,10 +18,11 @@ Menu_Controller* Menu_Controller::instance = nullptr;
  * @brief Constructs a new Menu_Controller object.
  *
  * Initializes all member variables, sets up references to external components
- * (display, buttons, sensors, monitor, attack controller), and creates the
- * menu hierarchy. The static instance pointer is set for callback functions.
+ * (display, buttons, sensors, monitor, attack controller). The static
+ * instance pointer is set for callback functions. The menu hierarchy is
+ * built later by begin(), so setup() is not held up by it.
  *
- * @param u8x8 Pointer to the OLED display driver
+ * @param u8x8 Screen buffer flushed to the OLED display
  * @param upBtn Pin number for the up navigation button
  * @param downBtn Pin number for the down navigation button
  * @param leftBtn Pin number for the left/back navigation button
@@ -32,7 +33,7 @@ Menu_Controller* Menu_Controller::instance = nullptr;
  * @param mon Pointer to the N2K_Monitor for network monitoring
  * @param attk Pointer to the Attack_Controller for attack functionality
  */
-Menu_Controller::Menu_Controller(U8X8_SH1106_128X64_NONAME_HW_I2C* u8x8,
+Menu_Controller::Menu_Controller(Screen_Buffer* u8x8,
                                  int upBtn, int downBtn, int leftBtn, int rightBtn,
                                  Sensor* s1, Sensor* s2, Sensor* s3,
                                  N2K_Monitor* mon, Attack_Controller* attk) {
@@ -49,6 +50,12 @@ Menu_Controller::Menu_Controller(U8X8_SH1106_128X64_NONAME_HW_I2C* u8x8,
     sensor3 = s3;
     monitor = mon;
     attackController = attk;
+    captureStream = nullptr;
+    logger = nullptr;
+    canFilter = nullptr;
+    filteredCapture = nullptr;
+    replay = nullptr;
+    graphics = nullptr;
 
     // Menu state
     currentMenuID = MENU_MAIN;
@@ -63,6 +70,9 @@ Menu_Controller::Menu_Controller(U8X8_SH1106_128X64_NONAME_HW_I2C* u8x8,
     currentDeviceAddress = 0;
     currentPGN = 0;
     lastPGNUpdate = 0;
+    displayedListGeneration = 0;
+    displayedDeviceGeneration = 0;
+    watchedPGNChanged = false;
     detailViewInitialized = false;
     impFieldSelectInitialized = false;
     viewingPGNDetail = false;
@@ -85,11 +95,48 @@ Menu_Controller::Menu_Controller(U8X8_SH1106_128X64_NONAME_HW_I2C* u8x8,
 
     // About menu navigation state
     aboutPGNScrollIndex = 0;
+    lastMemoryDisplayUpdate = 0;
 
     // Display update tracking for spam attack
     lastSpamDisplayUpdate = 0;
     spamActiveInitialized = false;
 
+    // Display update tracking for capture mode screen
+    lastCaptureDisplayUpdate = 0;
+    displayedCaptureMode = CAPTURE_MODE_OFF;
+
+    // Display update tracking for logger screen
+    lastLoggerDisplayUpdate = 0;
+    displayedLoggerRecording = false;
+
+    // Display update tracking for bus stats screen
+    lastBusStatsDisplayUpdate = 0;
+    busStatsSelectedStream = 0;
+
+    // Display update tracking for alerts screen
+    lastAlertsDisplayUpdate = 0;
+    displayedAlertsGeneration = 0;
+    alertsFirst = 0;
+
+    // Display update tracking for CAN filter screen
+    lastCanFilterDisplayUpdate = 0;
+    canFilterCursor = 0;
+    lastReplayDisplayUpdate = 0;
+    replayCursor = 0;
+    displayedReplayState = REPLAY_STOPPED;
+
+#if PROFILER_ENABLED
+    // Display update tracking for profiler screen
+    lastProfilerDisplayUpdate = 0;
+    profilerFirstZone = 0;
+#endif
+
+    // Display update tracking for field graph screen
+    graphTrace = -1;
+    displayedGraphGeneration = 0;
+    lastGraphDisplayUpdate = 0;
+    graphFlushPage = 7;
+
     // Display update tracking for attack status screen
     attackStatusInitialized = false;
     attackStatusScrollOffset = 0;
@@ -99,11 +146,23 @@ Menu_Controller::Menu_Controller(U8X8_SH1106_128X64_NONAME_HW_I2C* u8x8,
     instance = this;
 
     // Initialize displayed lines tracking
-    for (int i = 0; i < 8; i++) {
-        displayedLines[i] = "";
-    }
+    resetDisplayedLines();
 
-    initializeMenus();
+    // Menus are created by begin()
+    currentMenu = nullptr;
+    mainMenu = nullptr;
+    sensorReadingsMenu = nullptr;
+    configureMenu = nullptr;
+    configureSensor1Menu = nullptr;
+    configureSensor2Menu = nullptr;
+    configureSensor3Menu = nullptr;
+    attacksMenu = nullptr;
+    aboutMenu = nullptr;
+    deviceConfigMenu = nullptr;
+    manufacturerMenu = nullptr;
+    for(int i = 0; i < 3; i++) {
+        pgnTypeMenus[i] = nullptr;
+    }
 }
 
 /**
@@ -133,8 +192,9 @@ Menu_Controller::~Menu_Controller() {
 /**
  * @brief Prepares the screen for drawing by clearing and resetting font settings.
  *
- * Clears the display, moves cursor to home position, sets the default font,
- * and disables inverse font mode. Should be called before drawing a new screen.
+ * Clears the screen buffer, moves cursor to home position, sets the default
+ * font, and disables inverse font mode. Should be called before drawing a new
+ * screen. Only the cells that end up different are sent to the display.
  */
 void Menu_Controller::prepScreen(){
     screen->clear();
@@ -161,79 +221,93 @@ void Menu_Controller::prepScreen(){
  */
 void Menu_Controller::initializeMenus() {
     // Initialize main menu - keep strings short (max ~13 chars for option text with " * " prefix)
-    mainChoices[0] = {String("Live Data"), callback_SensorReadings};
-    mainChoices[1] = {String("Attacks"), callback_Attacks};
-    mainChoices[2] = {String("Configure"), callback_Configure};
-    mainChoices[3] = {String("About"), callback_About};
-    mainMenu = new Menu(screen, String("MAIN MENU"), mainChoices, mainChoicesNum, 1);
+    mainChoices[0] = {"Live Data", callback_SensorReadings};
+    mainChoices[1] = {"Attacks", callback_Attacks};
+    mainChoices[2] = {"Configure", callback_Configure};
+    mainChoices[3] = {"Logger", callback_Logger};
+    mainChoices[4] = {"Bus Stats", callback_BusStats};
+    mainChoices[5] = {"Alerts", callback_Alerts};
+    mainChoices[6] = {"Replay", callback_Replay};
+    mainChoices[7] = {"About", callback_About};
+    mainMenu = new Menu(screen, "MAIN MENU", mainChoices, mainChoicesNum, 1);
 
     // Initialize configure menu
-    configureChoices[0] = {String("Sensor 1"), callback_ConfigSensor1};
-    configureChoices[1] = {String("Sensor 2"), callback_ConfigSensor2};
-    configureChoices[2] = {String("Sensor 3"), callback_ConfigSensor3};
-    configureChoices[3] = {String("Device Config"), callback_DeviceConfig};
-    configureMenu = new Menu(screen, String("CONFIGURE"), configureChoices, configureChoicesNum, 1);
+    configureChoices[0] = {"Sensor 1", callback_ConfigSensor1};
+    configureChoices[1] = {"Sensor 2", callback_ConfigSensor2};
+    configureChoices[2] = {"Sensor 3", callback_ConfigSensor3};
+    configureChoices[3] = {"Device Config", callback_DeviceConfig};
+    configureMenu = new Menu(screen, "CONFIGURE", configureChoices, configureChoicesNum, 1);
 
     // Initialize device config menu
-    deviceConfigChoices[0] = {String("Stale Cleanup"), callback_StaleCleanupToggle};
-    deviceConfigMenu = new Menu(screen, String("DEVICE CONFIG"), deviceConfigChoices, deviceConfigChoicesNum, 1);
+    deviceConfigChoices[0] = {"Stale Cleanup", callback_StaleCleanupToggle};
+    deviceConfigChoices[1] = {"Capture Mode", callback_CaptureMode};
+    deviceConfigChoices[2] = {"CAN2 Filters", callback_CanFilters};
+#if PROFILER_ENABLED
+    deviceConfigChoices[3] = {"Profiler", callback_Profiler};
+#endif
+    deviceConfigMenu = new Menu(screen, "DEVICE CONFIG", deviceConfigChoices, deviceConfigChoicesNum, 1);
 
     // Initialize manufacturer selection menu
     for(int i = 0; i < MANUFACTURER_COUNT; i++) {
-        manufacturerChoices[i] = {String(MANUFACTURERS[i].name), nullptr};
+        manufacturerChoices[i] = {MANUFACTURERS[i].name, nullptr};
     }
-    manufacturerMenu = new Menu(screen, String("MANUFACTURER"), manufacturerChoices, MANUFACTURER_COUNT, 1);
+    manufacturerMenu = new Menu(screen, "MANUFACTURER", manufacturerChoices, MANUFACTURER_COUNT, 1);
 
     // Initialize attacks menu
-    attacksChoices[0] = {String("DOS Attack"), callback_SpamAttack};
-    attacksChoices[1] = {String("Impersonate"), callback_Impersonate};
-    attacksMenu = new Menu(screen, String("ATTACKS"), attacksChoices, attacksChoicesNum, 1);
+    attacksChoices[0] = {"DOS Attack", callback_SpamAttack};
+    attacksChoices[1] = {"Impersonate", callback_Impersonate};
+    attacksMenu = new Menu(screen, "ATTACKS", attacksChoices, attacksChoicesNum, 1);
 
     // Initialize about menu
-    aboutChoices[0] = {String("Info"), callback_AboutInfo};
-    aboutChoices[1] = {String("Supported PGNs"), callback_AboutPGNs};
-    aboutMenu = new Menu(screen, String("ABOUT"), aboutChoices, aboutChoicesNum, 1);
+    aboutChoices[0] = {"Info", callback_AboutInfo};
+    aboutChoices[1] = {"Supported PGNs", callback_AboutPGNs};
+    aboutMenu = new Menu(screen, "ABOUT", aboutChoices, aboutChoicesNum, 1);
 
     // Initialize sensor config menus (same structure for all 3)
     // Order: Manufacturer, Device Type, Active
     // Check actual sensor state for initial display
-    sensorConfigChoices[0] = {String("Manufacturer"), callback_Sensor1Manufacturer};
-    sensorConfigChoices[1] = {String("Device Type"), callback_Sensor1PGNType};
-    sensorConfigChoices[2] = {String(sensor1->isActive() ? "Active: YES" : "Active: NO"), callback_Sensor1Active};
-    configureSensor1Menu = new Menu(screen, String("SENSOR 1"), sensorConfigChoices, sensorConfigChoicesNum, 1);
+    sensorConfigChoices[0] = {"Manufacturer", callback_Sensor1Manufacturer};
+    sensorConfigChoices[1] = {"Device Type", callback_Sensor1PGNType};
+    sensorConfigChoices[2] = {sensor1->isActive() ? "Active: YES" : "Active: NO", callback_Sensor1Active};
+    configureSensor1Menu = new Menu(screen, "SENSOR 1", sensorConfigChoices, sensorConfigChoicesNum, 1);
 
-    sensor2ConfigChoices[0] = {String("Manufacturer"), callback_Sensor2Manufacturer};
-    sensor2ConfigChoices[1] = {String("Device Type"), callback_Sensor2PGNType};
-    sensor2ConfigChoices[2] = {String(sensor2->isActive() ? "Active: YES" : "Active: NO"), callback_Sensor2Active};
-    configureSensor2Menu = new Menu(screen, String("SENSOR 2"), sensor2ConfigChoices, sensor2ConfigChoicesNum, 1);
+    sensor2ConfigChoices[0] = {"Manufacturer", callback_Sensor2Manufacturer};
+    sensor2ConfigChoices[1] = {"Device Type", callback_Sensor2PGNType};
+    sensor2ConfigChoices[2] = {sensor2->isActive() ? "Active: YES" : "Active: NO", callback_Sensor2Active};
+    configureSensor2Menu = new Menu(screen, "SENSOR 2", sensor2ConfigChoices, sensor2ConfigChoicesNum, 1);
 
-    sensor3ConfigChoices[0] = {String("Manufacturer"), callback_Sensor3Manufacturer};
-    sensor3ConfigChoices[1] = {String("Device Type"), callback_Sensor3PGNType};
-    sensor3ConfigChoices[2] = {String(sensor3->isActive() ? "Active: YES" : "Active: NO"), callback_Sensor3Active};
-    configureSensor3Menu = new Menu(screen, String("SENSOR 3"), sensor3ConfigChoices, sensor3ConfigChoicesNum, 1);
+    sensor3ConfigChoices[0] = {"Manufacturer", callback_Sensor3Manufacturer};
+    sensor3ConfigChoices[1] = {"Device Type", callback_Sensor3PGNType};
+    sensor3ConfigChoices[2] = {sensor3->isActive() ? "Active: YES" : "Active: NO", callback_Sensor3Active};
+    configureSensor3Menu = new Menu(screen, "SENSOR 3", sensor3ConfigChoices, sensor3ConfigChoicesNum, 1);
 
     // Initialize PGN type selection menus - use SENSOR_DEFS from constants.h
     for(uint8_t i = 0; i < SENSOR_COUNT; i++) {
-        pgnTypeChoices[i] = {String(SENSOR_DEFS[i].displayName), nullptr};
+        pgnTypeChoices[i] = {SENSOR_DEFS[i].displayName, nullptr};
     }
-    pgnTypeMenus[0] = new Menu(screen, String("SELECT PGN"), pgnTypeChoices, pgnTypeChoicesNum, 1);
-    pgnTypeMenus[1] = new Menu(screen, String("SELECT PGN"), pgnTypeChoices, pgnTypeChoicesNum, 1);
-    pgnTypeMenus[2] = new Menu(screen, String("SELECT PGN"), pgnTypeChoices, pgnTypeChoicesNum, 1);
+    pgnTypeMenus[0] = new Menu(screen, "SELECT PGN", pgnTypeChoices, pgnTypeChoicesNum, 1);
+    pgnTypeMenus[1] = new Menu(screen, "SELECT PGN", pgnTypeChoices, pgnTypeChoicesNum, 1);
+    pgnTypeMenus[2] = new Menu(screen, "SELECT PGN", pgnTypeChoices, pgnTypeChoicesNum, 1);
 
     // Initialize sensor readings menu (will be populated dynamically)
-    sensorReadingsMenu = new Menu(screen, String("LIVE DATA"), nullptr, 0, 1);
+    sensorReadingsMenu = new Menu(screen, "LIVE DATA", nullptr, 0, 1);
 
     // Set current menu
     currentMenu = mainMenu;
 }
 
 /**
- * @brief Starts the menu system by displaying the initial menu.
+ * @brief Starts the menu system by building the menus and displaying the main menu.
  *
- * Should be called once after construction to display the main menu
- * and begin user interaction.
+ * Should be called once after construction, when the display is ready for
+ * the menu. Building the menus allocates all Menu objects and their labels,
+ * so it is left until the boot splash has finished and CAN capture is
+ * already running.
  */
 void Menu_Controller::begin() {
+    if(currentMenu == nullptr) {
+        initializeMenus();
+    }
     currentMenu->printMenu();
 }
 
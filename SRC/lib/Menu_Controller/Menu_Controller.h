@@ -12,7 +12,9 @@
 #define MENU_CONTROLLER_H
 
 #include <Arduino.h>
-#include <U8x8lib.h>
+#include <Screen_Buffer.h>
+#include <Screen_Line.h>
+#include <U8g2lib.h>
 #include <Menu.h>
 #include <N2kMessages.h>
 #include <Sensor.h>
@@ -21,6 +23,12 @@
 #include <PGN_Helpers.h>
 #include <N2K_Monitor.h>
 #include <Attack_Controller.h>
+#include <Capture_Stream.h>
+#include <CAN_Filter.h>
+#include <N2K_Logger.h>
+#include <N2K_Replay.h>
+#include <Zone_Profiler.h>
+#include <Memory_Budget.h>
 
 /*
  *                              Forward Declarations
@@ -80,10 +88,21 @@ enum MenuID {
     MENU_IMP_FIELD_SELECT,      ///< Select and modify field values for impersonation
     MENU_DEVICE_CONFIG,         ///< Device-level configuration options
     MENU_STALE_CLEANUP,         ///< Toggle for automatic stale device cleanup
+    MENU_CAPTURE_MODE,          ///< Selects the USB capture output format
     MENU_MANUFACTURER_SELECT,   ///< Manufacturer code selection for sensors
     MENU_ABOUT_INFO,            ///< About information page with device details
     MENU_ABOUT_PGNS,            ///< List of supported PGNs
-    MENU_ATTACK_STATUS          ///< Shows active attack status with stop option
+    MENU_ABOUT_MEMORY,          ///< Memory budget of the subsystems and the heap
+    MENU_ATTACK_STATUS,         ///< Shows active attack status with stop option
+    MENU_LOGGER,                ///< Frame logger start/stop and statistics
+    MENU_BUS_STATS,             ///< Bus load and per-PGN traffic statistics
+    MENU_CAN_FILTERS,           ///< Source/PGN filter sets of the CAN2 monitor
+    MENU_REPLAY,                ///< Log file playback into the monitor or onto CAN1
+    MENU_FIELD_GRAPH,           ///< History graph of a watched PGN field
+    MENU_ALERTS,                ///< Alert list of the monitor's anomaly detector
+#if PROFILER_ENABLED
+    MENU_PROFILER,              ///< Cycle counter timings of the code zones
+#endif
 };
 
 /*
@@ -118,7 +137,7 @@ private:
      * Display and Menu State
      * ------------------------------------------------------------------------ */
 
-    U8X8_SH1106_128X64_NONAME_HW_I2C* screen;  ///< Pointer to the OLED display driver
+    Screen_Buffer* screen;                     ///< Screen buffer flushed to the OLED
     Menu* currentMenu;                          ///< Currently active menu object
     MenuID currentMenuID;                       ///< ID of the current menu
     MenuID previousMenuID;                      ///< ID of the previous menu (for transitions)
@@ -152,7 +171,7 @@ private:
      * Menu Choice Counts
      * ------------------------------------------------------------------------ */
 
-    const static int mainChoicesNum = 4;              ///< Number of main menu options
+    const static int mainChoicesNum = 8;              ///< Number of main menu options
     const static int configureChoicesNum = 4;         ///< Number of configure menu options (Sensor1, Sensor2, Sensor3, Device Config)
     const static int sensorConfigChoicesNum = 3;      ///< Number of sensor 1 config options (Change Type, Active, Manufacturer)
     const static int sensor2ConfigChoicesNum = 3;     ///< Number of sensor 2 config options
@@ -160,7 +179,7 @@ private:
     const static int attacksChoicesNum = 2;           ///< Number of attack menu options
     const static int aboutChoicesNum = 2;             ///< Number of about menu options
     const static int pgnTypeChoicesNum = SENSOR_COUNT; ///< Number of PGN types (from constants.h)
-    const static int deviceConfigChoicesNum = 1;      ///< Number of device config options (stale cleanup toggle)
+    const static int deviceConfigChoicesNum = PROFILER_ENABLED ? 4 : 3; ///< Number of device config options (stale cleanup, capture mode, CAN2 filters, profiler)
     const static int manufacturerChoicesNum = MANUFACTURER_COUNT; ///< Number of manufacturer options
 
     /* ------------------------------------------------------------------------
@@ -192,6 +211,12 @@ private:
 
     N2K_Monitor* monitor;              ///< NMEA2000 network monitor for device/PGN tracking
     Attack_Controller* attackController; ///< Attack controller for research demonstrations
+    Capture_Stream* captureStream;     ///< USB capture output (optional, may be nullptr)
+    N2K_Logger* logger;                ///< On-device frame logger (optional, may be nullptr)
+    CAN_Filter* canFilter;             ///< CAN2 filter sets (optional, may be nullptr)
+    CAN_Capture* filteredCapture;      ///< CAN2 capture applying canFilter, for the drop counter
+    N2K_Replay* replay;                ///< Log file player (optional, may be nullptr)
+    U8G2_SH1106_128X64_NONAME_F_HW_I2C* graphics; ///< Graphics driver of the same panel, for the field graph (optional, may be nullptr)
 
     /* ------------------------------------------------------------------------
      * Device/PGN Navigation State
@@ -203,12 +228,15 @@ private:
     uint8_t currentDeviceAddress;       ///< NMEA2000 address of currently selected device
     uint32_t currentPGN;                ///< Currently selected PGN number
     unsigned long lastPGNUpdate;        ///< Timestamp of last PGN value update
+    uint32_t displayedListGeneration;   ///< Monitor list generation the device list was drawn with
+    uint32_t displayedDeviceGeneration; ///< Device generation the PGN list was drawn with
+    bool watchedPGNChanged;             ///< The PGN on the detail screen received data since the last draw
 
     /* ------------------------------------------------------------------------
      * Display Optimization State
      * ------------------------------------------------------------------------ */
 
-    String displayedLines[8];           ///< Cache of currently displayed text on each row
+    char displayedLines[8][SCREEN_COLS + 1]; ///< Cache of currently displayed text on each row
     bool detailViewInitialized;         ///< Flag indicating if detail view has been fully drawn
     bool impFieldSelectInitialized;     ///< Flag indicating if impersonate field select is drawn
 
@@ -275,6 +303,7 @@ private:
      * ------------------------------------------------------------------------ */
 
     int aboutPGNScrollIndex;           ///< Scroll position for supported PGNs list
+    unsigned long lastMemoryDisplayUpdate; ///< Timestamp of last memory budget update
 
     /* ------------------------------------------------------------------------
      * Spam Attack Display State
@@ -283,6 +312,71 @@ private:
     unsigned long lastSpamDisplayUpdate;   ///< Timestamp of last spam display update
     bool spamActiveInitialized;            ///< Flag indicating if spam active screen is drawn
 
+    /* ------------------------------------------------------------------------
+     * Capture Mode Display State
+     * ------------------------------------------------------------------------ */
+
+    unsigned long lastCaptureDisplayUpdate;    ///< Timestamp of last capture counter update
+    CaptureMode displayedCaptureMode;          ///< Mode shown on screen, detects host-driven switches
+
+    /* ------------------------------------------------------------------------
+     * Logger Display State
+     * ------------------------------------------------------------------------ */
+
+    unsigned long lastLoggerDisplayUpdate;     ///< Timestamp of last logger counter update
+    bool displayedLoggerRecording;             ///< Recording state shown on screen, detects error stops
+
+    /* ------------------------------------------------------------------------
+     * Bus Stats Display State
+     * ------------------------------------------------------------------------ */
+
+    unsigned long lastBusStatsDisplayUpdate;   ///< Timestamp of last bus statistics update
+    int busStatsSelectedStream;                ///< Index of the (source, PGN) stream shown
+
+    /* ------------------------------------------------------------------------
+     * Alerts Display State
+     * ------------------------------------------------------------------------ */
+
+    const static int alertsRows = 3;           ///< Alerts on the alerts screen (two rows each, rows 1-6)
+    unsigned long lastAlertsDisplayUpdate;     ///< Timestamp of last alert list check
+    uint32_t displayedAlertsGeneration;        ///< Alert list generation shown on screen
+    int alertsFirst;                           ///< Age of the alert shown at the top
+
+    /* ------------------------------------------------------------------------
+     * CAN Filter Display State
+     * ------------------------------------------------------------------------ */
+
+    unsigned long lastCanFilterDisplayUpdate;  ///< Timestamp of last filter counter update
+    int canFilterCursor;                       ///< Highlighted row of the filter screen (0-4)
+
+    /* ------------------------------------------------------------------------
+     * Replay Display State
+     * ------------------------------------------------------------------------ */
+
+    unsigned long lastReplayDisplayUpdate;     ///< Timestamp of last replay counter update
+    int replayCursor;                          ///< Highlighted row of the replay screen (0-3)
+
+    ReplayState displayedReplayState;          ///< Playback state shown on screen, detects the end of a log
+
+#if PROFILER_ENABLED
+    /* ------------------------------------------------------------------------
+     * Profiler Display State
+     * ------------------------------------------------------------------------ */
+
+    const static int profilerRows = 6;         ///< Zone rows on the profiler screen (rows 1-6)
+    unsigned long lastProfilerDisplayUpdate;   ///< Timestamp of last profiler update
+    int profilerFirstZone;                     ///< Zone shown in the top row
+#endif
+
+    /* ------------------------------------------------------------------------
+     * Field Graph Display State
+     * ------------------------------------------------------------------------ */
+
+    int graphTrace;                            ///< History slot shown on the field graph
+    uint32_t displayedGraphGeneration;         ///< Trace generation the graph was drawn with
+    unsigned long lastGraphDisplayUpdate;      ///< Timestamp of last graph redraw
+    uint8_t graphFlushPage;                    ///< Next display page of the graph to send, 7 when sent
+
     /* ------------------------------------------------------------------------
      * Attack Status Display State
      * ------------------------------------------------------------------------ */
@@ -390,6 +484,33 @@ private:
      */
     void updatePGNDetailValues();
 
+    /**
+     * @brief Finds the table field shown in the top field row of the PGN detail view.
+     *
+     * Only numeric fields of PGNs decoded from the PGN table can be graphed.
+     *
+     * @return Field definition, or nullptr if the top row can't be graphed
+     */
+    const PGNFieldDef* getDetailGraphField();
+
+    /**
+     * @brief Displays the history graph of the selected watched field.
+     *
+     * Rows 0 and 7 are text; rows 1-6 are drawn with the graphics driver
+     * and sent a few pages per update() call.
+     */
+    void displayFieldGraph();
+
+    /**
+     * @brief Redraws the field graph when its trace got new samples or buckets.
+     */
+    void updateFieldGraph();
+
+    /**
+     * @brief Sends pending graph pages to the panel, MENU_GRAPH_PAGES_PER_STEP at a time.
+     */
+    void flushFieldGraph();
+
     /**
      * @brief Draws a line of text only if it differs from what is displayed.
      * @param row The display row (0-7) to draw on.
@@ -397,7 +518,19 @@ private:
      *
      * Prevents flicker by only updating changed content.
      */
-    void drawLine(int row, const String& text);
+    void drawLine(int row, const char* text);
+
+    /**
+     * @brief Draws a built row only if it differs from what is displayed.
+     * @param row The display row (0-7) to draw on.
+     * @param line The row to display.
+     */
+    void drawLine(int row, const Screen_Line& line) { drawLine(row, line.c_str()); }
+
+    /**
+     * @brief Forgets what drawLine() last drew, so every row is drawn again.
+     */
+    void resetDisplayedLines();
 
     /**
      * @brief Gets the number of fields in the current PGN.
@@ -410,6 +543,106 @@ private:
      */
     void displayDeviceConfig();
 
+    /**
+     * @brief Displays the capture mode screen.
+     */
+    void displayCaptureMode();
+
+    /**
+     * @brief Updates the frame counters on the capture mode screen.
+     */
+    void updateCaptureModeValues();
+
+    /**
+     * @brief Displays the frame logger screen.
+     */
+    void displayLogger();
+
+    /**
+     * @brief Updates the file name and counters on the frame logger screen.
+     */
+    void updateLoggerValues();
+
+    /**
+     * @brief Displays the bus statistics screen.
+     */
+    void displayBusStats();
+
+    /**
+     * @brief Updates the bus load and selected stream values on the bus statistics screen.
+     */
+    void updateBusStatsValues();
+
+    /**
+     * @brief Counts the (source, PGN) streams the monitor is tracking.
+     *
+     * @return Number of PGN entries over all devices
+     */
+    int getBusStatsStreamCount();
+
+    /**
+     * @brief Finds a (source, PGN) stream by its position.
+     *
+     * Streams are ordered by device list order, then by the device's PGN order.
+     *
+     * @param index Position of the stream
+     * @param[out] source Source address of the device sending the stream
+     * @return Pointer to the PGN entry, or nullptr if index is out of range
+     */
+    PGNData* getBusStatsStream(int index, uint8_t& source);
+
+    /**
+     * @brief Displays the anomaly alerts screen.
+     */
+    void displayAlerts();
+
+    /**
+     * @brief Updates the alert total and the visible alerts on the alerts screen.
+     */
+    void updateAlertsValues();
+
+    /**
+     * @brief Displays the CAN2 filter screen.
+     */
+    void displayCanFilters();
+
+    /**
+     * @brief Updates the set sizes and the drop counter on the CAN2 filter screen.
+     */
+    void updateCanFilterValues();
+
+    /**
+     * @brief Applies SELECT to the highlighted row of the CAN2 filter screen.
+     */
+    void editCanFilter();
+
+    /**
+     * @brief Displays the log replay screen.
+     */
+    void displayReplay();
+
+    /**
+     * @brief Updates the settings and counters on the log replay screen.
+     */
+    void updateReplayValues();
+
+    /**
+     * @brief Applies SELECT to the highlighted row of the log replay screen.
+     */
+    void editReplay();
+
+#if PROFILER_ENABLED
+    /**
+     * @brief Displays the profiler screen.
+     */
+    void displayProfiler();
+
+    /**
+     * @brief Updates the zone timings on the profiler screen.
+     */
+    void updateProfilerValues();
+#endif
+
     /**
      * @brief Displays the manufacturer selection screen.
      */
@@ -475,6 +708,14 @@ private:
      */
     void updateAttackStatusDisplay();
 
+    /**
+     * @brief Gets the target names shown on the attack status screen.
+     *
+     * @param devName Receives the target device name, N2K_DEVICE_NAME_SIZE bytes
+     * @param pgnName Receives the target PGN name, N2K_PGN_NAME_SIZE bytes
+     */
+    void getAttackStatusNames(char* devName, char* pgnName);
+
     /* ------------------------------------------------------------------------
      * About Display Methods
      * ------------------------------------------------------------------------ */
@@ -489,6 +730,16 @@ private:
      */
     void displaySupportedPGNs();
 
+    /**
+     * @brief Displays the memory budget page.
+     */
+    void displayAboutMemory();
+
+    /**
+     * @brief Updates the subsystem and heap rows on the memory budget page.
+     */
+    void updateAboutMemoryValues();
+
     /* ------------------------------------------------------------------------
      * Legacy PGN Display Methods
      * ------------------------------------------------------------------------ */
@@ -524,7 +775,7 @@ public:
     /**
      * @brief Constructs a Menu_Controller with all required dependencies.
      *
-     * @param u8x8 Pointer to the OLED display driver instance.
+     * @param u8x8 Screen buffer flushed to the OLED display.
      * @param upBtn GPIO pin number for the up navigation button.
      * @param downBtn GPIO pin number for the down navigation button.
      * @param leftBtn GPIO pin number for the left/back navigation button.
@@ -535,7 +786,7 @@ public:
      * @param mon Pointer to the NMEA2000 network monitor.
      * @param attk Pointer to the attack controller.
      */
-    Menu_Controller(U8X8_SH1106_128X64_NONAME_HW_I2C* u8x8,
+    Menu_Controller(Screen_Buffer* u8x8,
                    int upBtn, int downBtn, int leftBtn, int rightBtn,
                    Sensor* s1, Sensor* s2, Sensor* s3,
                    N2K_Monitor* mon, Attack_Controller* attk);
@@ -553,7 +804,8 @@ public:
      * @brief Initializes the menu controller and displays the main menu.
      *
      * Must be called after construction and before any other methods.
-     * Initializes the display, creates all menus, and shows the main menu.
+     * Creates all menus and shows the main menu. Deferred from the
+     * constructor so it can run after the boot splash.
      */
     void begin();
 
@@ -609,6 +861,41 @@ public:
      */
     bool isAttackActive();
 
+    /* ========================================================================
+     *                          Capture Output Methods
+     * ======================================================================== */
+
+    /**
+     * @brief Connects the USB capture output so its mode can be changed.
+     * @param stream Pointer to the capture stream, or nullptr to disable the screen.
+     */
+    void setCaptureStream(Capture_Stream* stream) { captureStream = stream; }
+
+    /**
+     * @brief Connects the frame logger so it can be controlled from the menu.
+     * @param log Pointer to the logger, or nullptr to disable the screen.
+     */
+    void setLogger(N2K_Logger* log) { logger = log; }
+
+    /**
+     * @brief Connects the CAN2 filter sets so they can be edited from the menu.
+     * @param filter Pointer to the filter, or nullptr to disable the screen.
+     * @param capture Capture driver applying the filter, for its drop counter (may be nullptr).
+     */
+    void setCanFilter(CAN_Filter* filter, CAN_Capture* capture) { canFilter = filter; filteredCapture = capture; }
+
+    /**
+     * @brief Connects the log player so it can be controlled from the menu.
+     * @param player Pointer to the player, or nullptr to disable the screen.
+     */
+    void setReplay(N2K_Replay* player) { replay = player; }
+
+    /**
+     * @brief Connects the graphics driver of the panel for the field graph.
+     * @param u8g2 Pointer to the U8g2 driver, or nullptr to disable the graph.
+     */
+    void setGraphics(U8G2_SH1106_128X64_NONAME_F_HW_I2C* u8g2) { graphics = u8g2; }
+
 
     /* ========================================================================
      *                          Sensor Configuration Methods
@@ -648,6 +935,18 @@ public:
     /** @brief Callback for navigating to Attacks menu. */
     static void callback_Attacks();
 
+    /** @brief Callback for opening the frame logger screen. */
+    static void callback_Logger();
+
+    /** @brief Callback for opening the bus statistics screen. */
+    static void callback_BusStats();
+
+    /** @brief Callback for opening the anomaly alerts screen. */
+    static void callback_Alerts();
+
+    /** @brief Callback for opening the log replay screen. */
+    static void callback_Replay();
+
     /** @brief Callback for navigating to About menu. */
     static void callback_About();
 
@@ -696,6 +995,20 @@ public:
     /** @brief Callback for toggling stale device cleanup setting. */
     static void callback_StaleCleanupToggle();
 
+    /** @brief Callback for opening the capture mode screen. */
+    static void callback_CaptureMode();
+
+    /** @brief Callback for opening the CAN2 filter screen. */
+    static void callback_CanFilters();
+
+#if PROFILER_ENABLED
+    /** @brief Callback for opening the profiler screen. */
+    static void callback_Profiler();
+#endif
+
+    /** @brief Monitor watch callback for the PGN on the detail screen. */
+    static void callback_WatchedPGN(uint8_t source, uint32_t pgn);
+
     /** @brief Callback for navigating to About Info page. */
     static void callback_AboutInfo();
 
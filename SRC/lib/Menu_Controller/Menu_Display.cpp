@@ -32,7 +32,7 @@ void Menu_Controller::displayDeviceList() {
     screen->drawString(0, 0, "NETWORK DEVICES");
 
     std::vector<uint8_t>& deviceList = monitor->getDeviceList();
-    std::map<uint8_t, DeviceInfo>& devices = monitor->getDevices();
+    displayedListGeneration = monitor->getListGeneration();
 
     if(deviceList.empty()) {
         screen->drawString(0, 3, "Scanning...");
@@ -55,42 +55,41 @@ void Menu_Controller::displayDeviceList() {
             screen->setInverseFont(0);
         }
 
-        String deviceName = "";
+        char fallbackName[12];
+        const char* deviceName = "";
         int pgnCount = 0;
 
-        if(devices.find(addr) != devices.end()) {
-            DeviceInfo& dev = devices[addr];
-            deviceName = dev.name;
-            pgnCount = dev.pgns.size();
+        DeviceInfo* dev = monitor->getDevice(addr);
+        if(dev != nullptr) {
+            deviceName = dev->name;
+            pgnCount = dev->pgnCount;
         }
 
         // If no name, use address
-        if(deviceName.length() == 0) {
-            deviceName = "Device " + String(addr);
+        if(deviceName[0] == '\0') {
+            snprintf(fallbackName, sizeof(fallbackName), "Device %u", addr);
+            deviceName = fallbackName;
         }
 
         // Format: "DeviceName (N)" where N is PGN count
-        String pgnSuffix = " (" + String(pgnCount) + ")";
-        int maxNameLen = 16 - pgnSuffix.length();  // Leave room for PGN count
+        char pgnSuffix[8];
+        int suffixLen = snprintf(pgnSuffix, sizeof(pgnSuffix), " (%d)", pgnCount);
+        int maxNameLen = 16 - suffixLen;  // Leave room for PGN count
+        int nameLen = (int)strlen(deviceName);
 
-        String displayName;
-        if(isSelected && (int)deviceName.length() > maxNameLen) {
+        Screen_Line line;
+        if(isSelected && nameLen > maxNameLen) {
             // Scrolling for selected item with long name
-            String scrollText = deviceName + "   " + deviceName;
-            displayName = scrollText.substring(deviceListScrollOffset, deviceListScrollOffset + maxNameLen);
-        } else if((int)deviceName.length() > maxNameLen) {
+            line.appendScrolled(deviceName, deviceListScrollOffset, maxNameLen);
+        } else if(nameLen > maxNameLen) {
             // Truncate non-selected long names
-            displayName = deviceName.substring(0, maxNameLen - 2) + "..";
+            line.append(deviceName, maxNameLen - 2).append("..");
         } else {
-            displayName = deviceName;
+            line.append(deviceName);
         }
 
         // Pad to fill space before PGN count
-        while((int)displayName.length() < maxNameLen) {
-            displayName += " ";
-        }
-
-        String line = displayName + pgnSuffix;
+        line.padTo(maxNameLen).append(pgnSuffix);
         screen->drawString(0, row, line.c_str());
         row++;
     }
@@ -115,51 +114,48 @@ void Menu_Controller::displayDeviceList() {
  */
 void Menu_Controller::displayDevicePGNs() {
     prepScreen();
+    displayedDeviceGeneration = monitor->getDeviceGeneration(currentDeviceAddress);
 
-    std::map<uint8_t, DeviceInfo>& devices = monitor->getDevices();
-    if(devices.find(currentDeviceAddress) == devices.end()) {
+    DeviceInfo* device = monitor->getDevice(currentDeviceAddress);
+    if(device == nullptr) {
         screen->drawString(0, 0, "Device not found");
         screen->drawString(0, 7, "< BACK");
         return;
     }
 
-    DeviceInfo& device = devices[currentDeviceAddress];
-
     // Title - show device address
-    String title = "DEV " + String(currentDeviceAddress) + " PGNs";
-    screen->drawString(0, 0, title.c_str());
+    char title[SCREEN_COLS + 1];
+    snprintf(title, sizeof(title), "DEV %u PGNs", currentDeviceAddress);
+    screen->drawString(0, 0, title);
 
-    if(device.pgns.empty()) {
+    int pgnCount = device->pgnCount;
+    if(pgnCount == 0) {
         screen->drawString(0, 3, "No PGNs yet");
         screen->drawString(0, 7, "< BACK");
         return;
     }
 
-    // Build ordered list of PGNs
-    std::vector<uint32_t> pgnList;
-    for(auto& pair : device.pgns) {
-        pgnList.push_back(pair.first);
-#if DEBUG
-        Serial.println(pair.first);
-#endif
-    }
-
-    // Display PGNs with scrolling
+    // Display PGNs with scrolling (the monitor keeps them ordered by PGN number)
     int row = 2;
     int startIdx = selectedPGNIndex > 3 ? selectedPGNIndex - 3 : 0;
 
-    for(int i = startIdx; i < (int)pgnList.size() && row < 7; i++) {
-        uint32_t pgn = pgnList[i];
+    for(int i = startIdx; i < pgnCount && row < 7; i++) {
+        PGNData* pgnData = monitor->getPGNDataAt(currentDeviceAddress, i);
+        if(pgnData == nullptr) break;
+        uint32_t pgn = pgnData->pgn;
+#if DEBUG
+        Serial.println(pgn);
+#endif
         if(i == selectedPGNIndex) {
             screen->setInverseFont(1);
         } else {
             screen->setInverseFont(0);
         }
 
-        String line = monitor->getPGNName(pgn);
-        if(line.length() > 16) line = line.substring(0, 13) + "...";
+        char line[N2K_PGN_NAME_SIZE];
+        N2K_Monitor::formatPGNName(pgn, line, sizeof(line));
 
-        screen->drawString(0, row, line.c_str());
+        screen->drawString(0, row, line);
         row++;
     }
 
@@ -176,7 +172,7 @@ void Menu_Controller::displayDevicePGNs() {
  * partial updates.
  *
  * Display format:
- * - Row 0: PGN name (scrolls if longer than 16 chars)
+ * - Row 0: PGN name
  * - Row 1: "PGN [number]"
  * - Rows 2-6: Field entries with format "Name: Value Unit"
  * - Row 7: Navigation hints with scroll indicators (^ v)
@@ -187,30 +183,30 @@ void Menu_Controller::displayPGNDetail() {
     prepScreen();
 
     // Reset displayed lines tracking
-    for(int i = 0; i < 8; i++) {
-        displayedLines[i] = "";
-    }
+    resetDisplayedLines();
 
-    std::map<uint8_t, DeviceInfo>& devices = monitor->getDevices();
-    if(devices.find(currentDeviceAddress) == devices.end() ||
-       devices[currentDeviceAddress].pgns.find(currentPGN) == devices[currentDeviceAddress].pgns.end()) {
+    // Get told about new data instead of redrawing on a timer
+    monitor->watch(currentDeviceAddress, currentPGN, callback_WatchedPGN);
+    watchedPGNChanged = false;
+
+    PGNData* decoded = monitor->getDecodedPGNData(currentDeviceAddress, currentPGN);
+    if(decoded == nullptr) {
         drawLine(0, "PGN not found");
         drawLine(7, "< BACK");
         detailViewInitialized = true;
         return;
     }
 
-    PGNData& pgnData = devices[currentDeviceAddress].pgns[currentPGN];
+    PGNData& pgnData = *decoded;
 
-    // Title - PGN name (row 0) - truncate initially, scrolling happens in update()
-    String title = pgnData.name;
-    if((int)title.length() > 16) {
-        title = title.substring(0, 16);
-    }
+    // Title - PGN name (row 0), always fits on one line
+    char title[N2K_PGN_NAME_SIZE];
+    N2K_Monitor::formatPGNName(pgnData.pgn, title, sizeof(title));
     drawLine(0, title);
 
     // Show PGN number (row 1)
-    drawLine(1, "PGN " + String(currentPGN));
+    Screen_Line pgnLine;
+    drawLine(1, pgnLine.appendf("PGN %lu", (unsigned long)currentPGN));
 
     // Display fields (rows 2-6) - truncate initially, scrolling happens in update()
     int maxRows = 5;
@@ -227,31 +223,17 @@ void Menu_Controller::displayPGNDetail() {
         PGNField& field = pgnData.fields[i];
 
         // Build line with label fixed, value truncated if needed
-        String label = "";
-        String valueWithUnit = field.value;
-        int labelWidth = 0;
-
-        if(field.name.length() > 0) {
-            label = field.name + ": ";
-            labelWidth = label.length();
-        }
-        if(field.unit.length() > 0) {
-            valueWithUnit += " " + field.unit;
+        Screen_Line line;
+        if(field.name[0] != '\0') {
+            line.append(field.name).append(": ");
         }
 
-        // Calculate available width for value
-        int valueAreaWidth = 16 - labelWidth;
-
         // Truncate value if needed - scrolling happens in update()
-        String displayValue = valueWithUnit;
-        if((int)valueWithUnit.length() > valueAreaWidth && valueAreaWidth > 0) {
-            displayValue = valueWithUnit.substring(0, valueAreaWidth);
+        line.append(field.value);
+        if(field.unit[0] != '\0') {
+            line.append(' ').append(field.unit);
         }
 
-        String line = label + displayValue;
-        // Pad to 16 chars
-        while((int)line.length() < 16) line += " ";
-
         drawLine(row, line);
         row++;
     }
@@ -263,10 +245,13 @@ void Menu_Controller::displayPGNDetail() {
     }
 
     // Show scroll indicators (row 7)
-    String navLine = "< BACK";
+    Screen_Line navLine("< BACK");
     if(totalFields > maxRows) {
-        if(detailScrollOffset > 0) navLine += " ^";
-        if(detailScrollOffset < totalFields - maxRows) navLine += " v";
+        if(detailScrollOffset > 0) navLine.append(" ^");
+        if(detailScrollOffset < totalFields - maxRows) navLine.append(" v");
+    }
+    if(graphics != nullptr && getDetailGraphField() != nullptr) {
+        navLine.padTo(10).append("GRAPH>");
     }
     drawLine(7, navLine);
 
@@ -289,13 +274,15 @@ void Menu_Controller::updatePGNDetailValues() {
         return;
     }
 
-    std::map<uint8_t, DeviceInfo>& devices = monitor->getDevices();
-    if(devices.find(currentDeviceAddress) == devices.end() ||
-       devices[currentDeviceAddress].pgns.find(currentPGN) == devices[currentDeviceAddress].pgns.end()) {
+    watchedPGNChanged = false;
+    PGNData* decoded = monitor->getDecodedPGNData(currentDeviceAddress, currentPGN);
+    if(decoded == nullptr || strcmp(displayedLines[0], "PGN not found") == 0) {
+        // The entry went stale or came back, redraw the whole screen
+        displayPGNDetail();
         return;
     }
 
-    PGNData& pgnData = devices[currentDeviceAddress].pgns[currentPGN];
+    PGNData& pgnData = *decoded;
 
     // Only update the value rows (2-6), leave title and navigation alone
     int totalFields = pgnData.fields.size();
@@ -305,39 +292,195 @@ void Menu_Controller::updatePGNDetailValues() {
         PGNField& field = pgnData.fields[i];
 
         // Build line with label fixed, value truncated if needed
-        String label = "";
-        String valueWithUnit = field.value;
         int labelWidth = 0;
-
-        if(field.name.length() > 0) {
-            label = field.name + ": ";
-            labelWidth = label.length();
+        if(field.name[0] != '\0') {
+            labelWidth = strlen(field.name) + 2;
         }
-        if(field.unit.length() > 0) {
-            valueWithUnit += " " + field.unit;
+        int valueWidth = strlen(field.value);
+        if(field.unit[0] != '\0') {
+            valueWidth += 1 + strlen(field.unit);
         }
 
         // Calculate available width for value
         int valueAreaWidth = 16 - labelWidth;
 
         // Skip fields that need scrolling - the scroll code in update() handles those
-        if((int)valueWithUnit.length() > valueAreaWidth && valueAreaWidth > 0) {
+        if(valueWidth > valueAreaWidth && valueAreaWidth > 0) {
             row++;
             continue;
         }
 
         // Only update fields that fit without scrolling
-        String displayValue = valueWithUnit;
-
-        String line = label + displayValue;
-        // Pad to 16 chars
-        while((int)line.length() < 16) line += " ";
+        Screen_Line line;
+        if(labelWidth > 0) {
+            line.append(field.name).append(": ");
+        }
+        line.append(field.value);
+        if(field.unit[0] != '\0') {
+            line.append(' ').append(field.unit);
+        }
 
         drawLine(row, line);
         row++;
     }
 }
 
+/**
+ * @brief Finds the table field shown in the top field row of the PGN detail view.
+ *
+ * The decoded fields only carry their names, so the row is matched by name
+ * against the PGN's table entry. PGNs decoded by the parser switch have no
+ * table entry and enumerations have no scale to plot.
+ *
+ * @return Field definition, or nullptr if the top row can't be graphed
+ */
+const PGNFieldDef* Menu_Controller::getDetailGraphField() {
+    const PGNDef* def = getPGNDef(currentPGN);
+    if(def == nullptr) return nullptr;
+
+    PGNData* decoded = monitor->getDecodedPGNData(currentDeviceAddress, currentPGN);
+    if(decoded == nullptr || detailScrollOffset >= (int)decoded->fields.size()) return nullptr;
+
+    const char* name = decoded->fields[detailScrollOffset].name;
+    int total = getPGNDefFieldTotal(*def);
+    for(int i = 0; i < total; i++) {
+        const PGNFieldDef& field = def->fields[i];
+        if(field.enumNames == nullptr && strcmp(name, field.name) == 0) return &field;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Maps a field value to a pixel row of the graph area.
+ *
+ * @param value Value to place
+ * @param lo Value at the bottom edge
+ * @param span Value range covered by the graph area, 0 for a flat trace
+ * @param top First pixel row of the graph area
+ * @param height Pixel rows of the graph area
+ * @return Pixel row, larger values further up
+ */
+static int graphRow(float value, float lo, float span, int top, int height) {
+    if(span <= 0) return top + height / 2;
+    int offset = (int)((value - lo) * (height - 1) / span + 0.5f);
+    if(offset < 0) offset = 0;
+    if(offset > height - 1) offset = height - 1;
+    return top + (height - 1) - offset;
+}
+
+/**
+ * @brief Displays the history graph of the selected watched field.
+ *
+ * Display format:
+ * - Row 0: Field name and latest value with unit
+ * - Rows 1-6: One pixel column per bucket, newest on the right, spanning the
+ *   bucket's min to max; the dotted line is the window mean
+ * - Row 7: "min-max ~mean" over the whole window
+ *
+ * The graph rows are handed over from the screen buffer to the graphics
+ * driver until navigateBack() takes them back.
+ */
+void Menu_Controller::displayFieldGraph() {
+    prepScreen();
+
+    resetDisplayedLines();
+
+    if(monitor->getHistory().get(graphTrace) == nullptr || graphics == nullptr) {
+        screen->setForeignRows(0);
+        graphFlushPage = 7;
+        drawLine(0, "Not watched");
+        drawLine(7, "< BACK");
+        return;
+    }
+
+    // Rows 1-6 belong to the graphics driver
+    screen->setForeignRows(0x7E);
+    updateFieldGraph();
+}
+
+/**
+ * @brief Redraws the field graph from its trace.
+ *
+ * The window is scaled to the full 48 pixel height, so small changes stay
+ * visible. The frame is rendered into the U8g2 buffer here and sent by
+ * flushFieldGraph() over the next update() calls.
+ */
+void Menu_Controller::updateFieldGraph() {
+    N2K_FieldHistory* trace = monitor->getHistory().get(graphTrace);
+    if(trace == nullptr || graphics == nullptr) {
+        displayFieldGraph();
+        return;
+    }
+
+    displayedGraphGeneration = trace->generation;
+    const PGNFieldDef& field = *trace->field;
+
+    // Row 0: name, latest value right-aligned
+    Screen_Line value;
+    if(trace->sampleCount > 0) {
+        value.appendf("%.*f", field.decimals, trace->lastValue);
+    } else {
+        value.append("--");
+    }
+    if(field.unit != nullptr && field.unit[0] != '\0') value.append(' ').append(field.unit);
+    int nameWidth = max(0, 15 - (int)value.size());
+    Screen_Line title;
+    title.append(field.name, nameWidth).padTo(SCREEN_COLS - value.size()).append(value.c_str());
+    drawLine(0, title);
+
+    // Row 7: window statistics
+    uint32_t samples = trace->getWindowCount();
+    float lo = trace->getWindowMin();
+    float hi = trace->getWindowMax();
+    float mean = trace->getWindowMean();
+    if(samples == 0) {
+        drawLine(7, "< BACK  no data");
+    } else {
+        Screen_Line stats;
+        stats.appendf("%.*f-%.*f ~%.*f", field.decimals, lo, field.decimals, hi, field.decimals, mean);
+        drawLine(7, stats);
+    }
+
+    // Rows 1-6: the buckets, newest at the right edge
+    const int top = 8;
+    const int height = 48;
+    const int width = SCREEN_COLS * 8;
+    float span = hi - lo;
+
+    graphics->clearBuffer();
+    if(samples > 0) {
+        int columns = min((int)trace->getBucketCount(), width);
+        for(int age = 0; age < columns; age++) {
+            const N2K_HistoryBucket& bucket = trace->getBucket(age);
+            if(bucket.count == 0) continue;  // No data in this bucket, leave a gap
+
+            int x = width - 1 - age;
+            graphics->drawLine(x, graphRow(bucket.max, lo, span, top, height),
+                               x, graphRow(bucket.min, lo, span, top, height));
+        }
+
+        int meanRow = graphRow(mean, lo, span, top, height);
+        for(int x = 0; x < width; x += 4) {
+            graphics->drawPixel(x, meanRow);
+        }
+    }
+    graphFlushPage = 1;
+}
+
+/**
+ * @brief Sends pending graph pages to the panel.
+ *
+ * A page is one 8 pixel text row; sending all six at once would hold the
+ * I2C bus for about 24 ms, so they go out MENU_GRAPH_PAGES_PER_STEP per call.
+ */
+void Menu_Controller::flushFieldGraph() {
+    if(graphics == nullptr || graphFlushPage >= 7) return;
+
+    uint8_t count = min((int)MENU_GRAPH_PAGES_PER_STEP, 7 - graphFlushPage);
+    graphics->updateDisplayArea(0, graphFlushPage, graphics->getBufferTileWidth(), count);
+    graphFlushPage += count;
+}
+
 /**
  * @brief Draws a line of text only if it has changed from the cached value.
  *
@@ -348,33 +491,40 @@ void Menu_Controller::updatePGNDetailValues() {
  * @param row The display row (0-7)
  * @param text The text to display (will be padded/truncated to 16 chars)
  */
-void Menu_Controller::drawLine(int row, const String& text) {
+void Menu_Controller::drawLine(int row, const char* text) {
     if(row < 0 || row >= 8) return;
 
     // Pad text to 16 chars to clear any old content
-    String paddedText = text;
-    while(paddedText.length() < 16) paddedText += " ";
-    if(paddedText.length() > 16) paddedText = paddedText.substring(0, 16);
+    Screen_Line paddedText(text);
+    paddedText.padTo(SCREEN_COLS);
 
     // Only draw if different from what's currently displayed
-    if(displayedLines[row] != paddedText) {
-        displayedLines[row] = paddedText;
+    if(strcmp(displayedLines[row], paddedText.c_str()) != 0) {
+        memcpy(displayedLines[row], paddedText.c_str(), SCREEN_COLS + 1);
         screen->drawString(0, row, paddedText.c_str());
     }
 }
 
+/**
+ * @brief Forgets what drawLine() last drew, so every row is drawn again.
+ */
+void Menu_Controller::resetDisplayedLines() {
+    for(int i = 0; i < 8; i++) {
+        displayedLines[i][0] = '\0';
+    }
+}
+
 /**
  * @brief Gets the number of fields in the currently displayed PGN.
  *
  * @return int The number of fields, or 0 if PGN not found
  */
 int Menu_Controller::getPGNFieldCount() {
-    std::map<uint8_t, DeviceInfo>& devices = monitor->getDevices();
-    if(devices.find(currentDeviceAddress) == devices.end() ||
-       devices[currentDeviceAddress].pgns.find(currentPGN) == devices[currentDeviceAddress].pgns.end()) {
+    PGNData* decoded = monitor->getDecodedPGNData(currentDeviceAddress, currentPGN);
+    if(decoded == nullptr) {
         return 0;
     }
-    return devices[currentDeviceAddress].pgns[currentPGN].fields.size();
+    return decoded->fields.size();
 }
 /**
  * @brief Displays the legacy PGN list screen.
@@ -393,7 +543,7 @@ void Menu_Controller::displayPGNList() {
     prepScreen();
 
     // Title
-    int titleLen = String("LIVE NMEA DATA").length();
+    int titleLen = strlen("LIVE NMEA DATA");
     int padding = (screen->getCols() - titleLen) / 2;
     screen->drawString(padding, 0, "LIVE NMEA DATA");
 
@@ -419,13 +569,11 @@ void Menu_Controller::displayPGNList() {
         }
 
         // Truncate name to fit (leave room for " * " = 3 chars, so max 13 chars)
-        String line = detectedPGNs[i].name;
-        if(line.length() > 13) {
-            line = line.substring(0, 10) + "...";
-        }
+        char line[14];
+        truncateText(detectedPGNs[i].name, 13, line);
 
         screen->drawString(0, row, " * ");
-        screen->drawString(3, row, line.c_str());
+        screen->drawString(3, row, line);
         row++;
     }
 
@@ -450,21 +598,20 @@ void Menu_Controller::displayPGNValue(int pgnIndex) {
     PGNInfo& info = detectedPGNs[pgnIndex];
 
     // Truncate name if needed (max 16 chars)
-    String displayName = info.name;
-    if(displayName.length() > 16) {
-        displayName = displayName.substring(0, 13) + "...";
-    }
+    char displayName[SCREEN_COLS + 1];
+    truncateText(info.name, SCREEN_COLS, displayName);
+
+    char pgnStr[11];
+    snprintf(pgnStr, sizeof(pgnStr), "%lu", (unsigned long)info.pgn);
 
-    screen->drawString(0, 0, displayName.c_str());
+    screen->drawString(0, 0, displayName);
     screen->drawString(0, 2, "PGN:");
-    screen->drawString(5, 2, String(info.pgn).c_str());
+    screen->drawString(5, 2, pgnStr);
     screen->drawString(0, 4, "Value:");
 
     // Format value to fit on screen
-    String valueStr = String(info.value, 2);
-    if(valueStr.length() > 16) {
-        valueStr = valueStr.substring(0, 16);
-    }
+    Screen_Line valueStr;
+    valueStr.appendf("%.2f", (double)info.value);
     screen->drawString(0, 5, valueStr.c_str());
     screen->drawString(0, 7, "< BACK");
 }
@@ -488,10 +635,8 @@ void Menu_Controller::updatePGNValueDisplay(int pgnIndex) {
     screen->drawString(0, 5, "                ");
 
     // Format and display new value
-    String valueStr = String(info.value, 2);
-    if(valueStr.length() > 16) {
-        valueStr = valueStr.substring(0, 16);
-    }
+    Screen_Line valueStr;
+    valueStr.appendf("%.2f", (double)info.value);
     screen->drawString(0, 5, valueStr.c_str());
 }
 
@@ -528,6 +673,629 @@ void Menu_Controller::displayDeviceConfig() {
     screen->drawString(0, 7, "< BACK  TOGGLE>");
 }
 
+/**
+ * @brief Displays the capture mode screen.
+ *
+ * Shows the current USB capture output format and how many frames have
+ * been streamed or dropped. The mode can also change without a key press
+ * when SavvyCAN connects, so update() redraws the screen if it differs
+ * from displayedCaptureMode.
+ *
+ * Display format:
+ * - Row 0: Title "CAPTURE MODE"
+ * - Row 2: "USB output:"
+ * - Row 3: Current mode "OFF", "CANDUMP" or "GVRET" (inverse font)
+ * - Row 5: Frames streamed "Sent: [count]"
+ * - Row 6: Frames dropped "Drop: [count]"
+ * - Row 7: Navigation hints "< BACK   CYCLE>"
+ */
+void Menu_Controller::displayCaptureMode() {
+    prepScreen();
+
+    // Clear displayedLines cache since we're doing a full redraw
+    resetDisplayedLines();
+
+    screen->drawString(0, 0, "CAPTURE MODE");
+
+    if(captureStream == nullptr) {
+        screen->drawString(0, 3, "Not available");
+        screen->drawString(0, 7, "< BACK");
+        return;
+    }
+
+    screen->drawString(0, 2, "USB output:");
+
+    char modeLine[17];
+    displayedCaptureMode = captureStream->getMode();
+    snprintf(modeLine, sizeof(modeLine), "  %-12s", Capture_Stream::getModeName(displayedCaptureMode));
+    screen->setInverseFont(1);
+    screen->drawString(0, 3, modeLine);
+    screen->setInverseFont(0);
+
+    updateCaptureModeValues();
+
+    screen->drawString(0, 7, "< BACK   CYCLE>");
+}
+
+/**
+ * @brief Updates the frame counters on the capture mode screen.
+ *
+ * Uses drawLine() so only changed rows are written to the display.
+ */
+void Menu_Controller::updateCaptureModeValues() {
+    if(captureStream == nullptr) return;
+
+    char line[17];
+    snprintf(line, sizeof(line), "Sent: %lu", (unsigned long)captureStream->getFramesWritten());
+    drawLine(5, line);
+    snprintf(line, sizeof(line), "Drop: %lu", (unsigned long)captureStream->getFramesDropped());
+    drawLine(6, line);
+}
+
+/**
+ * @brief Displays the frame logger screen.
+ *
+ * Shows whether frames are being recorded, where they go and how much has
+ * been written. Recording can stop on its own if the card is pulled, so
+ * update() redraws the screen when the state no longer matches
+ * displayedLoggerRecording.
+ *
+ * Display format:
+ * - Row 0: Title "LOGGER"
+ * - Row 1: Storage and file "SD NEMO0001.LOG"
+ * - Row 2: State "RECORDING", "STOPPED" or "WRITE ERROR" (inverse font)
+ * - Row 3: Bytes written "Bytes: [count]"
+ * - Row 4: Frames logged "Frames: [count]"
+ * - Row 5: Frames dropped "Drops: [count]"
+ * - Row 6: Transmit logging "TX log: ON/OFF"
+ * - Row 7: Navigation hints "< BACK   START>" or "< BACK    STOP>"
+ */
+void Menu_Controller::displayLogger() {
+    prepScreen();
+
+    // Clear displayedLines cache since we're doing a full redraw
+    resetDisplayedLines();
+
+    screen->drawString(0, 0, "LOGGER");
+
+    if(logger == nullptr || logger->getStorage() == LOGGER_STORAGE_NONE) {
+        screen->drawString(0, 2, "No SD card or");
+        screen->drawString(0, 3, "flash storage");
+        screen->drawString(0, 7, "< BACK");
+        return;
+    }
+
+    displayedLoggerRecording = logger->isRecording();
+
+    screen->setInverseFont(1);
+    if(displayedLoggerRecording) {
+        screen->drawString(0, 2, "  RECORDING     ");
+    } else if(logger->hasWriteError()) {
+        screen->drawString(0, 2, "  WRITE ERROR   ");
+    } else {
+        screen->drawString(0, 2, "  STOPPED       ");
+    }
+    screen->setInverseFont(0);
+
+    updateLoggerValues();
+
+    if(displayedLoggerRecording) {
+        screen->drawString(0, 7, "< BACK    STOP>");
+    } else {
+        screen->drawString(0, 7, "< BACK   START>");
+    }
+}
+
+/**
+ * @brief Updates the file name and counters on the frame logger screen.
+ *
+ * Byte counts switch to kilobytes once they no longer fit on the line.
+ * Uses drawLine() so only changed rows are written to the display.
+ */
+void Menu_Controller::updateLoggerValues() {
+    if(logger == nullptr || logger->getStorage() == LOGGER_STORAGE_NONE) return;
+
+    char line[17];
+    snprintf(line, sizeof(line), "%s %s", logger->getStorageName(), logger->getFileName());
+    drawLine(1, line);
+
+    uint32_t bytes = logger->getBytesWritten();
+    if(bytes < 1000000UL) {
+        snprintf(line, sizeof(line), "Bytes: %lu", (unsigned long)bytes);
+    } else {
+        snprintf(line, sizeof(line), "Bytes: %luK", (unsigned long)(bytes / 1024));
+    }
+    drawLine(3, line);
+
+    snprintf(line, sizeof(line), "Frames: %lu", (unsigned long)logger->getFramesLogged());
+    drawLine(4, line);
+    snprintf(line, sizeof(line), "Drops: %lu", (unsigned long)logger->getFramesDropped());
+    drawLine(5, line);
+    snprintf(line, sizeof(line), "TX log: %s", logger->isLogTransmitted() ? "ON" : "OFF");
+    drawLine(6, line);
+}
+
+int Menu_Controller::getBusStatsStreamCount() {
+    int count = 0;
+    std::vector<uint8_t>& deviceList = monitor->getDeviceList();
+    for(size_t i = 0; i < deviceList.size(); i++) {
+        count += monitor->getPGNCount(deviceList[i]);
+    }
+    return count;
+}
+
+PGNData* Menu_Controller::getBusStatsStream(int index, uint8_t& source) {
+    std::vector<uint8_t>& deviceList = monitor->getDeviceList();
+    for(size_t i = 0; i < deviceList.size(); i++) {
+        int pgnCount = monitor->getPGNCount(deviceList[i]);
+        if(index < pgnCount) {
+            source = deviceList[i];
+            return monitor->getPGNDataAt(deviceList[i], index);
+        }
+        index -= pgnCount;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Displays the bus statistics screen.
+ *
+ * Shows the bus utilization and the traffic statistics of one (source, PGN)
+ * stream at a time. UP/DOWN step through the streams, SELECT clears all
+ * statistics.
+ *
+ * Display format:
+ * - Row 0: Title "BUS STATS"
+ * - Row 1: Bus load "Load: [pct]%"
+ * - Row 2: Peak bus load "Peak: [pct]%"
+ * - Row 3: Frame and message rate "Fr/s:[n] Msg:[n]"
+ * - Row 4: Selected stream "[source] [PGN name]"
+ * - Row 5: Rate and jitter "[hz]Hz j[ms]ms"
+ * - Row 6: Throughput and interval range "[n]B/s [min]-[max]", or for
+ *   multi-frame PGNs the transfers "ok[n] to[n] er[n]" (completed, timed
+ *   out, corrupted)
+ * - Row 7: Navigation hints "< BACK   RESET>"
+ */
+void Menu_Controller::displayBusStats() {
+    prepScreen();
+
+    // Clear displayedLines cache since we're doing a full redraw
+    resetDisplayedLines();
+
+    screen->drawString(0, 0, "BUS STATS");
+    updateBusStatsValues();
+    screen->drawString(0, 7, "< BACK   RESET>");
+}
+
+/**
+ * @brief Updates the bus load and selected stream values on the bus statistics screen.
+ *
+ * The selected stream index is clamped here, since streams disappear when
+ * stale devices are cleaned up. Uses drawLine() so only changed rows are
+ * written to the display.
+ */
+void Menu_Controller::updateBusStatsValues() {
+    N2K_BusStats& bus = monitor->getBusStats();
+
+    char line[17];
+    snprintf(line, sizeof(line), "Load: %.1f%%", bus.getBusLoad());
+    drawLine(1, line);
+    snprintf(line, sizeof(line), "Peak: %.1f%%", bus.getPeakBusLoad());
+    drawLine(2, line);
+    snprintf(line, sizeof(line), "Fr/s:%.0f Msg:%.0f", bus.getFramesPerSecond(), bus.getMessagesPerSecond());
+    drawLine(3, line);
+
+    int streamCount = getBusStatsStreamCount();
+    if(busStatsSelectedStream >= streamCount) {
+        busStatsSelectedStream = streamCount > 0 ? streamCount - 1 : 0;
+    }
+
+    uint8_t source = 0;
+    PGNData* pgnData = getBusStatsStream(busStatsSelectedStream, source);
+    if(pgnData == nullptr) {
+        drawLine(4, "No traffic");
+        drawLine(5, "");
+        drawLine(6, "");
+        return;
+    }
+
+    char name[N2K_PGN_NAME_SIZE];
+    N2K_Monitor::formatPGNName(pgnData->pgn, name, sizeof(name));
+    snprintf(line, sizeof(line), "%3u %.12s", (unsigned)source, name);
+    drawLine(4, line);
+
+    const N2K_PGNStats& stats = pgnData->stats;
+    snprintf(line, sizeof(line), "%.1fHz j%.1fms", stats.getRate(), stats.getJitter());
+    drawLine(5, line);
+    const N2K_TransferStats& transfers = pgnData->transfers;
+    if(transfers.hasTransfers()) {
+        snprintf(line, sizeof(line), "ok%lu to%lu er%lu", (unsigned long)transfers.getCompleted(),
+                 (unsigned long)transfers.getTimedOut(), (unsigned long)transfers.getCorrupted());
+    } else {
+        snprintf(line, sizeof(line), "%.0fB/s %.0f-%.0f", stats.getBytesPerSecond(),
+                 stats.getMinInterval(), stats.getMaxInterval());
+    }
+    drawLine(6, line);
+}
+
+/**
+ * @brief Displays the anomaly alerts screen.
+ *
+ * Lists the alerts of the monitor's anomaly detector, newest first, three
+ * at a time. UP/DOWN scroll through the list, SELECT clears it.
+ *
+ * Display format:
+ * - Row 0: Title and detections since the last reset "ALERTS [total]"
+ * - Rows 1-6: Two rows per alert:
+ *   - "[type] [source] x[count]", source "bus" for bus-wide claim storms,
+ *     count shown up to 99
+ *   - "[PGN] [detail]", where detail is "[claims]>[limit]/s" for claim
+ *     storms, "v[other] d[difference]" for conflicts, "[now]/[base]ms"
+ *     for interval and jitter changes and "[rate]>[limit]/s" for jumps
+ * - Row 7: Navigation hints "< BACK   RESET>"
+ */
+void Menu_Controller::displayAlerts() {
+    prepScreen();
+
+    // Clear displayedLines cache since we're doing a full redraw
+    resetDisplayedLines();
+
+    updateAlertsValues();
+    screen->drawString(0, 7, "< BACK   RESET>");
+}
+
+/**
+ * @brief Updates the alert total and the visible alerts on the alerts screen.
+ *
+ * The first shown alert is clamped here, since the list shrinks when it is
+ * cleared. Ages shift as new alerts arrive, so the view stays anchored to
+ * the newest alert rather than to an entry. Uses drawLine() so only changed
+ * rows are written to the display.
+ */
+void Menu_Controller::updateAlertsValues() {
+    const N2K_AnomalyDetector& anomalies = monitor->getAnomalies();
+    displayedAlertsGeneration = anomalies.getGeneration();
+
+    char line[17];
+    snprintf(line, sizeof(line), "ALERTS %lu", (unsigned long)anomalies.getTotal());
+    drawLine(0, line);
+
+    int alertCount = anomalies.getAlertCount();
+    if(alertsFirst > alertCount - alertsRows) {
+        alertsFirst = alertCount > alertsRows ? alertCount - alertsRows : 0;
+    }
+
+    if(alertCount == 0) {
+        drawLine(1, "");
+        drawLine(2, "No alerts");
+        for(int row = 3; row <= 2 * alertsRows; row++) {
+            drawLine(row, "");
+        }
+        return;
+    }
+
+    for(int i = 0; i < alertsRows; i++) {
+        const N2K_Alert* alert = anomalies.getAlert(alertsFirst + i);
+        int row = 1 + 2 * i;
+        if(alert == nullptr) {
+            drawLine(row, "");
+            drawLine(row + 1, "");
+            continue;
+        }
+
+        char source[4];
+        if(alert->source == 0xFF) {
+            snprintf(source, sizeof(source), "bus");
+        } else {
+            snprintf(source, sizeof(source), "%u", (unsigned)alert->source);
+        }
+        snprintf(line, sizeof(line), "%-8.8s%4s x%u", N2K_AnomalyDetector::getTypeName(alert->type), source,
+                 (unsigned)(alert->count > 99 ? 99 : alert->count));
+        drawLine(row, line);
+
+        switch(alert->type) {
+            case ANOMALY_VALUE_CONFLICT:
+                snprintf(line, sizeof(line), "%lu v%u d%.1f", (unsigned long)alert->pgn, (unsigned)alert->other,
+                         alert->value);
+                break;
+            case ANOMALY_INTERVAL_CHANGE:
+            case ANOMALY_JITTER_CHANGE:
+                snprintf(line, sizeof(line), "%lu %.0f/%.0fms", (unsigned long)alert->pgn, alert->value,
+                         alert->limit);
+                break;
+            default:
+                snprintf(line, sizeof(line), "%lu %.0f>%.0f/s", (unsigned long)alert->pgn, alert->value,
+                         alert->limit);
+                break;
+        }
+        drawLine(row + 1, line);
+    }
+}
+
+/**
+ * @brief Displays the CAN2 filter screen.
+ *
+ * Lists the editable rows of the monitoring bus filter with the highlighted
+ * one in inverse font. UP/DOWN move the highlight, SELECT edits the row
+ * (see editCanFilter()). The entry rows use the device and PGN last opened
+ * in Live Data.
+ *
+ * Display format:
+ * - Row 0: Title "CAN2 FILTERS"
+ * - Row 1: Source set "Src [mode] [n] [SW/HW]"
+ * - Row 2: PGN set "PGN [mode] [n] [SW/HW]"
+ * - Row 3: Selected device "Src [addr]: in/out"
+ * - Row 4: Selected PGN "[pgn]: in/out"
+ * - Row 5: "Clear all"
+ * - Row 6: Frames dropped by the filter "Drop: [count]"
+ * - Row 7: Navigation hints "< BACK    EDIT>"
+ */
+void Menu_Controller::displayCanFilters() {
+    prepScreen();
+
+    // Clear displayedLines cache since we're doing a full redraw
+    resetDisplayedLines();
+
+    screen->drawString(0, 0, "CAN2 FILTERS");
+
+    if(canFilter == nullptr) {
+        screen->drawString(0, 3, "Not available");
+        screen->drawString(0, 7, "< BACK");
+        return;
+    }
+
+    updateCanFilterValues();
+    screen->drawString(0, 7, "< BACK    EDIT>");
+}
+
+/**
+ * @brief Updates the set sizes and the drop counter on the CAN2 filter screen.
+ *
+ * The sets can also be changed from the serial console, so every row is
+ * rebuilt. Uses drawLine() so only changed rows are written to the display;
+ * the highlight only moves through displayCanFilters(), which resets the
+ * line cache.
+ */
+void Menu_Controller::updateCanFilterValues() {
+    if(canFilter == nullptr) return;
+
+    char rows[5][17];
+    snprintf(rows[0], sizeof(rows[0]), "Src %-5s %3u %s",
+             CAN_Filter::getModeName(canFilter->getSourceMode()),
+             (unsigned)canFilter->getSourceCount(),
+             CAN_Filter::getEnforcementName(canFilter->getSourceEnforcement()));
+    snprintf(rows[1], sizeof(rows[1]), "PGN %-5s %3lu %s",
+             CAN_Filter::getModeName(canFilter->getPGNMode()),
+             (unsigned long)canFilter->getPGNCount(),
+             CAN_Filter::getEnforcementName(canFilter->getPGNEnforcement()));
+    snprintf(rows[2], sizeof(rows[2]), "Src %u: %s", (unsigned)currentDeviceAddress,
+             canFilter->hasSource(currentDeviceAddress) ? "in" : "out");
+    snprintf(rows[3], sizeof(rows[3]), "%lu: %s", (unsigned long)currentPGN,
+             canFilter->hasPGN(currentPGN) ? "in" : "out");
+    snprintf(rows[4], sizeof(rows[4]), "Clear all");
+
+    for(int i = 0; i < 5; i++) {
+        screen->setInverseFont(i == canFilterCursor ? 1 : 0);
+        drawLine(i + 1, rows[i]);
+    }
+    screen->setInverseFont(0);
+
+    char line[17];
+    if(filteredCapture != nullptr) {
+        snprintf(line, sizeof(line), "Drop: %lu", (unsigned long)filteredCapture->getFilteredCount());
+    } else {
+        line[0] = '\0';
+    }
+    drawLine(6, line);
+}
+
+/**
+ * @brief Applies SELECT to the highlighted row of the CAN2 filter screen.
+ *
+ * - Set rows cycle the mode OFF -> ALLOW -> DENY
+ * - Entry rows add or remove the selected device or PGN
+ * - "Clear all" empties both sets and turns them off
+ */
+void Menu_Controller::editCanFilter() {
+    if(canFilter == nullptr) return;
+
+    switch(canFilterCursor) {
+        case 0:
+            canFilter->setSourceMode((FilterMode)((canFilter->getSourceMode() + 1) % FILTER_MODE_COUNT));
+            break;
+        case 1:
+            canFilter->setPGNMode((FilterMode)((canFilter->getPGNMode() + 1) % FILTER_MODE_COUNT));
+            break;
+        case 2:
+            if(canFilter->hasSource(currentDeviceAddress)) {
+                canFilter->removeSource(currentDeviceAddress);
+            } else {
+                canFilter->addSource(currentDeviceAddress);
+            }
+            break;
+        case 3:
+            if(canFilter->hasPGN(currentPGN)) {
+                canFilter->removePGN(currentPGN);
+            } else {
+                canFilter->addPGN(currentPGN);
+            }
+            break;
+        default:
+            canFilter->clear();
+            break;
+    }
+    updateCanFilterValues();
+}
+
+/**
+ * @brief Displays the log replay screen.
+ *
+ * Lists the playback settings with the highlighted row in inverse font.
+ * UP/DOWN move the highlight, SELECT edits the row (see editReplay()).
+ * The settings are locked while a log is playing.
+ *
+ * Display format:
+ * - Row 0: Title "REPLAY"
+ * - Row 1: Selected log "[file name]"
+ * - Row 2: Target "To: Monitor/CAN1"
+ * - Row 3: Speed "Speed: 1x/2x/10x/Max"
+ * - Row 4: "Play" with the last result, or "Stop [n]% U:[underruns]"
+ * - Row 5: Frames played "Frames: [count]"
+ * - Row 6: Late frames and worst lateness "Late:[n] [max]us"
+ * - Row 7: Navigation hints "< BACK    EDIT>"
+ */
+void Menu_Controller::displayReplay() {
+    prepScreen();
+
+    // Clear displayedLines cache since we're doing a full redraw
+    resetDisplayedLines();
+
+    screen->drawString(0, 0, "REPLAY");
+
+    if(replay == nullptr || logger == nullptr || logger->getStorage() == LOGGER_STORAGE_NONE) {
+        screen->drawString(0, 2, "No SD card or");
+        screen->drawString(0, 3, "flash storage");
+        screen->drawString(0, 7, "< BACK");
+        return;
+    }
+
+    displayedReplayState = replay->getState();
+    updateReplayValues();
+    screen->drawString(0, 7, "< BACK    EDIT>");
+}
+
+/**
+ * @brief Updates the settings and counters on the log replay screen.
+ *
+ * Uses drawLine() so only changed rows are written to the display; the
+ * highlight only moves through displayReplay(), which resets the line
+ * cache.
+ */
+void Menu_Controller::updateReplayValues() {
+    if(replay == nullptr || logger == nullptr || logger->getStorage() == LOGGER_STORAGE_NONE) return;
+
+    char rows[4][17];
+    if(replay->getLogCount() > 0) {
+        replay->getSelectedLogName(rows[0]);
+    } else {
+        snprintf(rows[0], sizeof(rows[0]), "No logs");
+    }
+    snprintf(rows[1], sizeof(rows[1]), "To: %s", N2K_Replay::getTargetName(replay->getTarget()));
+    snprintf(rows[2], sizeof(rows[2]), "Speed: %s", N2K_Replay::getSpeedName(replay->getSpeed()));
+    switch(replay->getState()) {
+        case REPLAY_PLAYING:
+            snprintf(rows[3], sizeof(rows[3]), "Stop %3u%% U:%lu", (unsigned)replay->getProgress(),
+                     (unsigned long)replay->getUnderruns());
+            break;
+        case REPLAY_FINISHED:
+            snprintf(rows[3], sizeof(rows[3]), "Play      (done)");
+            break;
+        case REPLAY_ERROR:
+            snprintf(rows[3], sizeof(rows[3]), "Play     (error)");
+            break;
+        default:
+            snprintf(rows[3], sizeof(rows[3]), "Play");
+            break;
+    }
+
+    for(int i = 0; i < 4; i++) {
+        screen->setInverseFont(i == replayCursor ? 1 : 0);
+        drawLine(i + 1, rows[i]);
+    }
+    screen->setInverseFont(0);
+
+    char line[17];
+    snprintf(line, sizeof(line), "Frames: %lu", (unsigned long)replay->getFramesPlayed());
+    drawLine(5, line);
+    snprintf(line, sizeof(line), "Late:%lu %luus", (unsigned long)replay->getFramesLate(),
+             (unsigned long)replay->getMaxLateness());
+    drawLine(6, line);
+}
+
+/**
+ * @brief Applies SELECT to the highlighted row of the log replay screen.
+ *
+ * - Log row steps to the next log found on the storage
+ * - Target row switches Monitor -> CAN1
+ * - Speed row cycles 1x -> 2x -> 10x -> Max
+ * - Play row starts playback, or stops it while playing
+ *
+ * The first three are ignored while a log is playing.
+ */
+void Menu_Controller::editReplay() {
+    if(replay == nullptr || logger == nullptr || logger->getStorage() == LOGGER_STORAGE_NONE) return;
+
+    switch(replayCursor) {
+        case 0:
+            replay->selectNextLog();
+            break;
+        case 1:
+            replay->setTarget((ReplayTarget)((replay->getTarget() + 1) % REPLAY_TARGET_COUNT));
+            break;
+        case 2:
+            replay->setSpeed((ReplaySpeed)((replay->getSpeed() + 1) % REPLAY_SPEED_COUNT));
+            break;
+        default:
+            if(replay->isPlaying()) {
+                replay->stop();
+            } else {
+                replay->start();
+            }
+            break;
+    }
+    displayReplay();
+}
+
+#if PROFILER_ENABLED
+/**
+ * @brief Displays the profiler screen.
+ *
+ * Shows the average and longest run of six code zones at a time, in
+ * microseconds. UP/DOWN scroll through the zones, SELECT clears the table.
+ * The histograms and the per-PGN table are only on the serial console
+ * ("prof").
+ *
+ * Display format:
+ * - Row 0: Column titles "ZONE us avg  max"
+ * - Rows 1-6: Zones "[name] [avg] [max]"
+ * - Row 7: Navigation hints "< BACK   RESET>"
+ */
+void Menu_Controller::displayProfiler() {
+    prepScreen();
+
+    // Clear displayedLines cache since we're doing a full redraw
+    resetDisplayedLines();
+
+    screen->drawString(0, 0, "ZONE us avg  max");
+    updateProfilerValues();
+    screen->drawString(0, 7, "< BACK   RESET>");
+}
+
+/**
+ * @brief Updates the zone rows on the profiler screen.
+ *
+ * Times above 99999 us are shown as 99999. Uses drawLine() so only changed
+ * rows are written to the display.
+ */
+void Menu_Controller::updateProfilerValues() {
+    char line[17];
+    for(int row = 0; row < profilerRows; row++) {
+        int zone = profilerFirstZone + row;
+        if(zone >= PROFILE_ZONE_COUNT) {
+            drawLine(row + 1, "");
+            continue;
+        }
+
+        const ProfileZoneStats& stats = Zone_Profiler::getZone((ProfileZone)zone);
+        uint32_t avg = stats.count > 0 ? Zone_Profiler::toMicros(stats.totalCycles / stats.count) : 0;
+        uint32_t max = Zone_Profiler::toMicros(stats.maxCycles);
+        snprintf(line, sizeof(line), "%-6.6s%5lu%5lu", Zone_Profiler::getZoneName((ProfileZone)zone),
+                 (unsigned long)(avg > 99999 ? 99999 : avg), (unsigned long)(max > 99999 ? 99999 : max));
+        drawLine(row + 1, line);
+    }
+}
+#endif
+
 /**
  * @brief Displays the manufacturer selection screen.
  *
@@ -546,8 +1314,9 @@ void Menu_Controller::displayManufacturerSelect() {
     prepScreen();
 
     // Title with sensor number
-    String title = "SENSOR " + String(currentSensorBeingConfigured + 1) + " MFR";
-    screen->drawString(0, 0, title.c_str());
+    char title[SCREEN_COLS + 1];
+    snprintf(title, sizeof(title), "SENSOR %d MFR", currentSensorBeingConfigured + 1);
+    screen->drawString(0, 0, title);
 
     // Get current sensor's manufacturer code
     Sensor* targetSensor = (currentSensorBeingConfigured == 0) ? sensor1 :
@@ -555,14 +1324,13 @@ void Menu_Controller::displayManufacturerSelect() {
     uint16_t currentCode = (targetSensor != nullptr) ? targetSensor->getManufacturerCode() : 2046;
 
     // Show current manufacturer - uses MANUFACTURERS array from constants.h
-    String currentMfr = "Cur: ";
+    Screen_Line currentMfr("Cur: ");
     const char* mfrNamePtr = getManufacturerName(currentCode);
     if(mfrNamePtr) {
-        currentMfr += mfrNamePtr;
+        currentMfr.append(mfrNamePtr);
     } else {
-        currentMfr += String(currentCode);
+        currentMfr.appendf("%u", currentCode);
     }
-    if(currentMfr.length() > 16) currentMfr = currentMfr.substring(0, 16);
     screen->drawString(0, 1, currentMfr.c_str());
 
     // Display manufacturers with scrolling - uses MANUFACTURERS array from constants.h
@@ -576,10 +1344,9 @@ void Menu_Controller::displayManufacturerSelect() {
             screen->setInverseFont(0);
         }
 
-        String line = String(MANUFACTURERS[i].name);
-        if(line.length() > 16) line = line.substring(0, 16);
+        Screen_Line line(MANUFACTURERS[i].name);
         // Pad with spaces to clear previous text
-        while(line.length() < 16) line += " ";
+        line.padTo(SCREEN_COLS);
         screen->drawString(0, row, line.c_str());
         row++;
     }
@@ -599,7 +1366,7 @@ void Menu_Controller::displayManufacturerSelect() {
  * - Row 2: "NEMO" (centered)
  * - Row 3: "Version 1.0" (centered)
  * - Rows 5-6: GitHub URL
- * - Row 7: "< BACK"
+ * - Row 7: "< BACK   MEMORY>", SELECT opens the memory budget page
  */
 void Menu_Controller::displayAboutInfo() {
     prepScreen();
@@ -611,7 +1378,56 @@ void Menu_Controller::displayAboutInfo() {
     screen->drawString(0, 5, "   github.com/");
     screen->drawString(0, 6, "   soups71/nemo");
 
-    screen->drawString(0, 7, "< BACK");
+    screen->drawString(0, 7, "< BACK   MEMORY>");
+}
+
+/**
+ * @brief Displays the memory budget page.
+ *
+ * Shows the memory of each subsystem as of the last Memory_Budget sample,
+ * and how much of the heap is free. SELECT sets the peaks to the current
+ * use. The region sizes and the stack peak are only on the serial console
+ * ("mem").
+ *
+ * Display format:
+ * - Row 0: Column titles "KB   Use Res Max"
+ * - Rows 1-5: Subsystems "[name] [used] [reserved] [peak]"
+ * - Row 6: Heap "Free [free]K blk [largest]K"
+ * - Row 7: Navigation hints "< BACK   RESET>"
+ */
+void Menu_Controller::displayAboutMemory() {
+    prepScreen();
+
+    // Clear displayedLines cache since we're doing a full redraw
+    resetDisplayedLines();
+
+    screen->drawString(0, 0, "KB   Use Res Max");
+    updateAboutMemoryValues();
+    screen->drawString(0, 7, "< BACK   RESET>");
+}
+
+/**
+ * @brief Updates the subsystem and heap rows on the memory budget page.
+ *
+ * Sizes are rounded up to whole KB, so a subsystem that holds anything
+ * never shows 0. Uses drawLine() so only changed rows are written to the
+ * display.
+ */
+void Menu_Controller::updateAboutMemoryValues() {
+    char line[17];
+    for(int s = 0; s < MEMORY_SUBSYSTEM_COUNT; s++) {
+        const MemoryUsage& usage = Memory_Budget::getUsage((MemorySubsystem)s);
+        snprintf(line, sizeof(line), "%-4.4s%4lu%4lu%4lu", Memory_Budget::getSubsystemName((MemorySubsystem)s),
+                 (unsigned long)((usage.used + 1023) / 1024), (unsigned long)((usage.reserved + 1023) / 1024),
+                 (unsigned long)((usage.peak + 1023) / 1024));
+        drawLine(s + 1, line);
+    }
+
+    MemoryRegions regions;
+    Memory_Budget::getRegions(regions);
+    snprintf(line, sizeof(line), "Free%3luK blk%3luK", (unsigned long)(regions.heapFree / 1024),
+             (unsigned long)(regions.heapLargest / 1024));
+    drawLine(6, line);
 }
 
 /**
@@ -40,8 +40,8 @@ void Menu_Controller::navigateUp() {
         }
         return;
     }
-    if(currentMenuID == MENU_ABOUT_INFO) {
-        return;  // No scrolling on info page
+    if(currentMenuID == MENU_ABOUT_INFO || currentMenuID == MENU_ABOUT_MEMORY) {
+        return;  // No scrolling on info pages
     }
     if(currentMenuID == MENU_ABOUT_PGNS) {
         if(aboutPGNScrollIndex > 0) {
@@ -62,8 +62,71 @@ void Menu_Controller::navigateUp() {
         return;
     }
 
-    // Stale cleanup screen has no up/down navigation
-    if(currentMenuID == MENU_STALE_CLEANUP) {
+    // Stale cleanup and capture mode screens have no up/down navigation
+    if(currentMenuID == MENU_STALE_CLEANUP || currentMenuID == MENU_CAPTURE_MODE) {
+        return;
+    }
+
+    // Bus stats screen - up/down step through the (source, PGN) streams
+    if(currentMenuID == MENU_BUS_STATS) {
+        if(busStatsSelectedStream > 0) {
+            busStatsSelectedStream--;
+            updateBusStatsValues();
+        }
+        return;
+    }
+
+    // Alerts screen - up/down scroll through the alerts
+    if(currentMenuID == MENU_ALERTS) {
+        if(alertsFirst > 0) {
+            alertsFirst--;
+            updateAlertsValues();
+        }
+        return;
+    }
+
+#if PROFILER_ENABLED
+    // Profiler screen - up/down scroll through the zones
+    if(currentMenuID == MENU_PROFILER) {
+        if(profilerFirstZone > 0) {
+            profilerFirstZone--;
+            updateProfilerValues();
+        }
+        return;
+    }
+#endif
+
+    // CAN filter screen - up/down move the highlight
+    if(currentMenuID == MENU_CAN_FILTERS) {
+        if(canFilterCursor > 0) {
+            canFilterCursor--;
+            displayCanFilters();
+        }
+        return;
+    }
+
+    // Field graph - up/down switch between the watched fields
+    if(currentMenuID == MENU_FIELD_GRAPH) {
+        graphTrace = monitor->getHistory().next(graphTrace, -1);
+        displayFieldGraph();
+        return;
+    }
+
+    // Replay screen - up/down move the highlight
+    if(currentMenuID == MENU_REPLAY) {
+        if(replayCursor > 0) {
+            replayCursor--;
+            displayReplay();
+        }
+        return;
+    }
+
+    // Logger screen - up/down toggles logging of our own CAN1 traffic
+    if(currentMenuID == MENU_LOGGER) {
+        if(logger != nullptr) {
+            logger->setLogTransmitted(!logger->isLogTransmitted());
+            updateLoggerValues();
+        }
         return;
     }
 
@@ -154,8 +217,8 @@ void Menu_Controller::navigateDown() {
         }
         return;
     }
-    if(currentMenuID == MENU_ABOUT_INFO) {
-        return;  // No scrolling on info page
+    if(currentMenuID == MENU_ABOUT_INFO || currentMenuID == MENU_ABOUT_MEMORY) {
+        return;  // No scrolling on info pages
     }
     if(currentMenuID == MENU_ABOUT_PGNS) {
         // Use IMPERSONATABLE_PGN_COUNT from constants.h
@@ -179,8 +242,71 @@ void Menu_Controller::navigateDown() {
         return;
     }
 
-    // Stale cleanup screen has no up/down navigation
-    if(currentMenuID == MENU_STALE_CLEANUP) {
+    // Stale cleanup and capture mode screens have no up/down navigation
+    if(currentMenuID == MENU_STALE_CLEANUP || currentMenuID == MENU_CAPTURE_MODE) {
+        return;
+    }
+
+    // Bus stats screen - up/down step through the (source, PGN) streams
+    if(currentMenuID == MENU_BUS_STATS) {
+        if(busStatsSelectedStream < getBusStatsStreamCount() - 1) {
+            busStatsSelectedStream++;
+            updateBusStatsValues();
+        }
+        return;
+    }
+
+    // Alerts screen - up/down scroll through the alerts
+    if(currentMenuID == MENU_ALERTS) {
+        if(alertsFirst < monitor->getAnomalies().getAlertCount() - alertsRows) {
+            alertsFirst++;
+            updateAlertsValues();
+        }
+        return;
+    }
+
+#if PROFILER_ENABLED
+    // Profiler screen - up/down scroll through the zones
+    if(currentMenuID == MENU_PROFILER) {
+        if(profilerFirstZone < PROFILE_ZONE_COUNT - profilerRows) {
+            profilerFirstZone++;
+            updateProfilerValues();
+        }
+        return;
+    }
+#endif
+
+    // CAN filter screen - up/down move the highlight
+    if(currentMenuID == MENU_CAN_FILTERS) {
+        if(canFilterCursor < 4) {
+            canFilterCursor++;
+            displayCanFilters();
+        }
+        return;
+    }
+
+    // Field graph - up/down switch between the watched fields
+    if(currentMenuID == MENU_FIELD_GRAPH) {
+        graphTrace = monitor->getHistory().next(graphTrace, 1);
+        displayFieldGraph();
+        return;
+    }
+
+    // Replay screen - up/down move the highlight
+    if(currentMenuID == MENU_REPLAY) {
+        if(replayCursor < 3) {
+            replayCursor++;
+            displayReplay();
+        }
+        return;
+    }
+
+    // Logger screen - up/down toggles logging of our own CAN1 traffic
+    if(currentMenuID == MENU_LOGGER) {
+        if(logger != nullptr) {
+            logger->setLogTransmitted(!logger->isLogTransmitted());
+            updateLoggerValues();
+        }
         return;
     }
 
@@ -203,13 +329,10 @@ void Menu_Controller::navigateDown() {
         }
     } else if(currentMenuID == MENU_DEVICE_PGNS) {
         // PGN list navigation
-        std::map<uint8_t, DeviceInfo>& devices = monitor->getDevices();
-        if(devices.find(currentDeviceAddress) != devices.end()) {
-            int pgnCount = devices[currentDeviceAddress].pgns.size();
-            if(selectedPGNIndex < pgnCount - 1) {
-                selectedPGNIndex++;
-                displayDevicePGNs();
-            }
+        int pgnCount = monitor->getPGNCount(currentDeviceAddress);
+        if(selectedPGNIndex < pgnCount - 1) {
+            selectedPGNIndex++;
+            displayDevicePGNs();
         }
     } else if(currentMenuID == MENU_PGN_DETAIL) {
         // Scroll down in PGN detail view
@@ -331,10 +454,27 @@ void Menu_Controller::navigateBack() {
         currentMenu->printMenu();
         return;
     }
+    if(currentMenuID == MENU_ABOUT_MEMORY) {
+        // Back to the info page it was opened from
+        inSpecialMode = false;
+        currentMenuID = MENU_ABOUT_INFO;
+        displayAboutInfo();
+        return;
+    }
 
     // Handle new device-centric menu hierarchy
+    if(currentMenuID == MENU_FIELD_GRAPH) {
+        // Go back from the graph to the PGN detail, the field stays watched
+        screen->setForeignRows(0);
+        graphFlushPage = 7;
+        currentMenuID = MENU_PGN_DETAIL;
+        displayPGNDetail();
+        return;
+    }
+
     if(currentMenuID == MENU_PGN_DETAIL) {
         // Go back from PGN detail to PGN list
+        monitor->unwatch();
         currentMenuID = MENU_DEVICE_PGNS;
         displayDevicePGNs();
         return;
@@ -357,8 +497,13 @@ void Menu_Controller::navigateBack() {
         return;
     }
 
-    if(currentMenuID == MENU_STALE_CLEANUP) {
-        // Go back from stale cleanup toggle to device config menu
+    bool fromDeviceConfig = currentMenuID == MENU_STALE_CLEANUP || currentMenuID == MENU_CAPTURE_MODE ||
+                            currentMenuID == MENU_CAN_FILTERS;
+#if PROFILER_ENABLED
+    fromDeviceConfig = fromDeviceConfig || currentMenuID == MENU_PROFILER;
+#endif
+    if(fromDeviceConfig) {
+        // Go back from stale cleanup toggle, capture mode, filters or profiler to device config menu
         // Pop the stack since changeMenu pushed MENU_DEVICE_CONFIG when entering
         if(menuStackPointer > 0) {
             popMenu();
@@ -532,20 +677,21 @@ void Menu_Controller::navigateSelect() {
     }
     if(currentMenuID == MENU_IMP_PGN_SELECT) {
         std::vector<uint32_t>& impPGNList = attackController->getImpPGNList();
-        std::map<uint8_t, DeviceInfo>& devices = monitor->getDevices();
         // Use filtered impDeviceList
         if(!impPGNList.empty() && impPGNScrollIndex < (int)impPGNList.size()) {
             uint8_t targetAddr = impDeviceList[impDeviceScrollIndex];
             uint32_t targetPGN = impPGNList[impPGNScrollIndex];
 
             // Check if this is one of our own sensors and track it
-            String devName = devices[targetAddr].name;
-            bool isOwnSensor = (devName == "Sensor 1" || devName == "Sensor 2" || devName == "Sensor 3");
+            DeviceInfo* dev = monitor->getDevice(targetAddr);
+            const char* devName = (dev != nullptr) ? dev->name : "";
+            bool isOwnSensor = (strcmp(devName, "Sensor 1") == 0 || strcmp(devName, "Sensor 2") == 0 ||
+                                strcmp(devName, "Sensor 3") == 0);
             if (isOwnSensor) {
                 // Determine which sensor index (0, 1, or 2)
                 uint8_t sensorIdx = 0;
-                if (devName == "Sensor 2") sensorIdx = 1;
-                else if (devName == "Sensor 3") sensorIdx = 2;
+                if (strcmp(devName, "Sensor 2") == 0) sensorIdx = 1;
+                else if (strcmp(devName, "Sensor 3") == 0) sensorIdx = 2;
                 attackController->setImpersonatingOwnSensor(true, sensorIdx);
             } else {
                 attackController->setImpersonatingOwnSensor(false, 0);
@@ -581,29 +727,43 @@ void Menu_Controller::navigateSelect() {
 
     if(currentMenuID == MENU_DEVICE_PGNS) {
         // Select a PGN - go to detail view
-        std::map<uint8_t, DeviceInfo>& devices = monitor->getDevices();
-        if(devices.find(currentDeviceAddress) != devices.end()) {
-            DeviceInfo& device = devices[currentDeviceAddress];
-            if(!device.pgns.empty()) {
-                // Get the PGN at the selected index
-                std::vector<uint32_t> pgnList;
-                for(auto& pair : device.pgns) {
-                    pgnList.push_back(pair.first);
-                }
-                if(selectedPGNIndex < (int)pgnList.size()) {
-                    currentPGN = pgnList[selectedPGNIndex];
-                    currentMenuID = MENU_PGN_DETAIL;
-                    detailScrollOffset = 0;
-                    pgnFieldScrollOffset = 0;  // Reset horizontal scroll for new PGN
-                    displayPGNDetail();
-                }
-            }
+        // Get the PGN at the selected index
+        PGNData* pgnData = monitor->getPGNDataAt(currentDeviceAddress, selectedPGNIndex);
+        if(pgnData != nullptr) {
+            currentPGN = pgnData->pgn;
+            currentMenuID = MENU_PGN_DETAIL;
+            detailScrollOffset = 0;
+            pgnFieldScrollOffset = 0;  // Reset horizontal scroll for new PGN
+            displayPGNDetail();
         }
         return;
     }
 
     if(currentMenuID == MENU_PGN_DETAIL) {
-        // Already at detail level - do nothing on select
+        // Start recording the top field row and show its graph
+        const PGNFieldDef* field = getDetailGraphField();
+        if(field != nullptr && graphics != nullptr) {
+            int index = monitor->getHistory().watch(currentDeviceAddress, currentPGN, field, millis());
+            if(index < 0) {
+                drawLine(7, "History full");
+                return;
+            }
+            graphTrace = index;
+            currentMenuID = MENU_FIELD_GRAPH;
+            displayFieldGraph();
+        }
+        return;
+    }
+
+    if(currentMenuID == MENU_FIELD_GRAPH) {
+        // Stop recording the shown field, move on to the next one if any
+        monitor->getHistory().unwatch(graphTrace);
+        graphTrace = monitor->getHistory().next(graphTrace, 1);
+        if(graphTrace < 0) {
+            navigateBack();
+            return;
+        }
+        displayFieldGraph();
         return;
     }
 
@@ -614,6 +774,81 @@ void Menu_Controller::navigateSelect() {
         return;
     }
 
+    if(currentMenuID == MENU_LOGGER) {
+        // Start or stop recording
+        if(logger != nullptr && logger->getStorage() != LOGGER_STORAGE_NONE) {
+            if(logger->isRecording()) {
+                logger->stop();
+            } else {
+                logger->start();
+            }
+            displayLogger();
+        }
+        return;
+    }
+
+    if(currentMenuID == MENU_BUS_STATS) {
+        // Clear bus and per-PGN statistics
+        monitor->resetStatistics();
+        displayBusStats();
+        return;
+    }
+
+    if(currentMenuID == MENU_ALERTS) {
+        // Clear the alert list
+        monitor->resetAlerts();
+        alertsFirst = 0;
+        displayAlerts();
+        return;
+    }
+
+#if PROFILER_ENABLED
+    if(currentMenuID == MENU_PROFILER) {
+        // Clear the zone and PGN timings
+        Zone_Profiler::reset();
+        displayProfiler();
+        return;
+    }
+#endif
+
+    if(currentMenuID == MENU_ABOUT_INFO) {
+        // Open the memory budget page
+        inSpecialMode = true;
+        currentMenuID = MENU_ABOUT_MEMORY;
+        lastMemoryDisplayUpdate = millis();
+        displayAboutMemory();
+        return;
+    }
+
+    if(currentMenuID == MENU_ABOUT_MEMORY) {
+        // Start the peaks over from the current use
+        Memory_Budget::resetPeaks();
+        displayAboutMemory();
+        return;
+    }
+
+    if(currentMenuID == MENU_CAN_FILTERS) {
+        // Switch a set's mode, toggle an entry or clear everything
+        editCanFilter();
+        return;
+    }
+
+    if(currentMenuID == MENU_REPLAY) {
+        // Change a setting, or start or stop playback
+        editReplay();
+        return;
+    }
+
+    if(currentMenuID == MENU_CAPTURE_MODE) {
+        // Cycle OFF -> CANDUMP -> GVRET
+        if(captureStream != nullptr) {
+            CaptureMode next = (CaptureMode)((captureStream->getMode() + 1) % CAPTURE_MODE_COUNT);
+            captureStream->setMode(next);
+            displayCaptureMode();
+        }
+        return;
+    }
+
     if(currentMenuID == MENU_MANUFACTURER_SELECT) {
         // Set the selected manufacturer code for the current sensor
         setManufacturerCode(currentSensorBeingConfigured, MANUFACTURERS[selectedManufacturerIndex].code);
@@ -788,6 +1023,49 @@ void Menu_Controller::changeMenu(MenuID newMenuID) {
             inSpecialMode = true;
             displayDeviceConfig();
             return;
+        case MENU_CAPTURE_MODE:
+            // Special display for capture output format
+            inSpecialMode = true;
+            displayCaptureMode();
+            return;
+        case MENU_LOGGER:
+            // Special display for logger state and statistics
+            inSpecialMode = true;
+            displayLogger();
+            return;
+        case MENU_BUS_STATS:
+            // Special display for bus load and PGN statistics
+            inSpecialMode = true;
+            busStatsSelectedStream = 0;
+            displayBusStats();
+            return;
+        case MENU_ALERTS:
+            // Special display for the anomaly alert list
+            inSpecialMode = true;
+            alertsFirst = 0;
+            displayAlerts();
+            return;
+#if PROFILER_ENABLED
+        case MENU_PROFILER:
+            // Special display for the zone timings
+            inSpecialMode = true;
+            profilerFirstZone = 0;
+            displayProfiler();
+            return;
+#endif
+        case MENU_CAN_FILTERS:
+            // Special display for the CAN2 filter sets
+            inSpecialMode = true;
+            canFilterCursor = 0;
+            displayCanFilters();
+            return;
+        case MENU_REPLAY:
+            // Special display for log playback, the log list is read on entry
+            inSpecialMode = true;
+            if(replay != nullptr && !replay->isPlaying()) replay->scanLogs();
+            replayCursor = 0;
+            displayReplay();
+            return;
         case MENU_MANUFACTURER_SELECT:
             // Special display for manufacturer selection
             inSpecialMode = true;
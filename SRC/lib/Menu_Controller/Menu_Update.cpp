@@ -37,22 +37,37 @@
 
 #include "Menu_Controller.h"
 
+/**
+ * @brief Writes a field's value followed by its unit.
+ *
+ * @param field Decoded field
+ * @param out Receives "value unit", or just the value if it has no unit
+ * @param size Size of out
+ * @return Length of the text in out
+ */
+static int formatValueWithUnit(const PGNField& field, char* out, size_t size) {
+    int len = snprintf(out, size, "%s%s%s", field.value, field.unit[0] != '\0' ? " " : "", field.unit);
+    if(len < 0) len = 0;
+    if(len >= (int)size) len = size - 1;
+    return len;
+}
+
 /**
  * @brief Main update loop for real-time display and system updates.
  *
- * This method should be called regularly from the main loop (typically every
- * iteration). It handles:
+ * The loop scheduler runs this as a low priority task every
+ * MENU_UPDATE_INTERVAL_MS, so a redraw never delays CAN parsing by more
+ * than one call. It handles:
  *
- * - Network monitor updates (stale device cleanup)
- * - Attack controller updates (DOS/impersonate message transmission)
  * - Screen refresh for current menu state
  * - Text scrolling animations for long content
  * - Live value updates for sensor readings and attack statistics
  *
  * Update frequencies vary by screen type:
  * - Attack screens: 100ms for live statistics
- * - PGN detail: 250ms for field values
- * - Device/PGN lists: 500ms-1s for new entries
+ * - PGN detail: when the monitor reports new data, at most every 250ms
+ * - Device/PGN lists: when the monitor's generation counters change,
+ *   checked every 250ms
  * - Text scrolling: SCROLL_DELAY_MS (defined in constants.h)
  *
  * The function uses early returns after handling specialized screens to
@@ -64,14 +79,10 @@
  *       from interrupt context.
  */
 void Menu_Controller::update() {
-    // Called regularly from main loop for real-time updates
-    unsigned long currentTime = millis();
-
-    // Update monitor (handles stale cleanup)
-    monitor->update();
+    PROFILE_ZONE(PROFILE_MENU_UPDATE);
 
-    // Update attack controller (handles spam/impersonate attacks)
-    attackController->update();
+    // Called by the loop scheduler for real-time updates
+    unsigned long currentTime = millis();
 
     // -------------------------------------------------------------------------
     // Attack Status Screen Updates
@@ -124,19 +135,145 @@ void Menu_Controller::update() {
         return;
     }
 
+    // -------------------------------------------------------------------------
+    // Capture Mode Screen Updates
+    // -------------------------------------------------------------------------
+    // Refreshes the frame counters and follows host-driven mode switches
+    if(currentMenuID == MENU_CAPTURE_MODE) {
+        if(captureStream != nullptr && currentTime - lastCaptureDisplayUpdate > 500) {
+            lastCaptureDisplayUpdate = currentTime;
+            if(captureStream->getMode() != displayedCaptureMode) {
+                displayCaptureMode();
+            } else {
+                updateCaptureModeValues();
+            }
+        }
+        return;
+    }
+
+    // -------------------------------------------------------------------------
+    // Logger Screen Updates
+    // -------------------------------------------------------------------------
+    // Refreshes the counters and notices when recording stopped on an error
+    if(currentMenuID == MENU_LOGGER) {
+        if(logger != nullptr && currentTime - lastLoggerDisplayUpdate > 500) {
+            lastLoggerDisplayUpdate = currentTime;
+            if(logger->isRecording() != displayedLoggerRecording) {
+                displayLogger();
+            } else {
+                updateLoggerValues();
+            }
+        }
+        return;
+    }
+
+    // -------------------------------------------------------------------------
+    // Bus Stats Screen Updates
+    // -------------------------------------------------------------------------
+    // Refreshes the bus load and the selected stream once per half second
+    if(currentMenuID == MENU_BUS_STATS) {
+        if(currentTime - lastBusStatsDisplayUpdate > 500) {
+            lastBusStatsDisplayUpdate = currentTime;
+            updateBusStatsValues();
+        }
+        return;
+    }
+
+    // -------------------------------------------------------------------------
+    // Alerts Screen Updates
+    // -------------------------------------------------------------------------
+    // Checks the alert list once per half second, redraws only when it changed
+    if(currentMenuID == MENU_ALERTS) {
+        if(currentTime - lastAlertsDisplayUpdate > 500) {
+            lastAlertsDisplayUpdate = currentTime;
+            if(monitor->getAnomalies().getGeneration() != displayedAlertsGeneration) {
+                updateAlertsValues();
+            }
+        }
+        return;
+    }
+
+    // -------------------------------------------------------------------------
+    // Memory Budget Screen Updates
+    // -------------------------------------------------------------------------
+    // Redraws with each new sample of the memory budget
+    if(currentMenuID == MENU_ABOUT_MEMORY) {
+        if(currentTime - lastMemoryDisplayUpdate > MEMORY_SAMPLE_INTERVAL_MS) {
+            lastMemoryDisplayUpdate = currentTime;
+            updateAboutMemoryValues();
+        }
+        return;
+    }
+
+#if PROFILER_ENABLED
+    // -------------------------------------------------------------------------
+    // Profiler Screen Updates
+    // -------------------------------------------------------------------------
+    // Refreshes the zone timings once per half second
+    if(currentMenuID == MENU_PROFILER) {
+        if(currentTime - lastProfilerDisplayUpdate > 500) {
+            lastProfilerDisplayUpdate = currentTime;
+            updateProfilerValues();
+        }
+        return;
+    }
+#endif
+
+    // -------------------------------------------------------------------------
+    // CAN Filter Screen Updates
+    // -------------------------------------------------------------------------
+    // Refreshes the drop counter, and the set sizes after console edits
+    if(currentMenuID == MENU_CAN_FILTERS) {
+        if(currentTime - lastCanFilterDisplayUpdate > 500) {
+            lastCanFilterDisplayUpdate = currentTime;
+            updateCanFilterValues();
+        }
+        return;
+    }
+
+    // -------------------------------------------------------------------------
+    // Replay Screen Updates
+    // -------------------------------------------------------------------------
+    // Refreshes the progress and notices when the log has been played out
+    if(currentMenuID == MENU_REPLAY) {
+        if(replay != nullptr && currentTime - lastReplayDisplayUpdate > 500) {
+            lastReplayDisplayUpdate = currentTime;
+            if(replay->getState() != displayedReplayState) {
+                displayReplay();
+            } else {
+                updateReplayValues();
+            }
+        }
+        return;
+    }
+
+    // -------------------------------------------------------------------------
+    // Field Graph Screen Updates
+    // -------------------------------------------------------------------------
+    // Sends the rendered graph a few pages at a time, then redraws it once the
+    // trace got new samples or moved on a bucket, at most every MENU_GRAPH_REDRAW_MS
+    if(currentMenuID == MENU_FIELD_GRAPH) {
+        flushFieldGraph();
+        if(graphFlushPage >= 7 && currentTime - lastGraphDisplayUpdate > MENU_GRAPH_REDRAW_MS) {
+            N2K_FieldHistory* trace = monitor->getHistory().get(graphTrace);
+            if(trace != nullptr && trace->generation != displayedGraphGeneration) {
+                lastGraphDisplayUpdate = currentTime;
+                updateFieldGraph();
+            }
+        }
+        return;
+    }
+
     // -------------------------------------------------------------------------
     // Device List Screen Updates
     // -------------------------------------------------------------------------
     // Handles device list refresh and name scrolling for the Live Data view
     if(currentMenuID == MENU_DEVICE_LIST) {
-        // Refresh device list periodically to show new devices
+        // Redraw when a device, a name or a PGN count changed since the last draw
         std::vector<uint8_t>& deviceList = monitor->getDeviceList();
-        std::map<uint8_t, DeviceInfo>& devices = monitor->getDevices();
-        if(currentTime - lastPGNUpdate > 1000) {  // Update every 1 second
+        if(currentTime - lastPGNUpdate > 250) {
             lastPGNUpdate = currentTime;
-            static size_t lastDeviceCount = 0;
-            if(deviceList.size() != lastDeviceCount) {
-                lastDeviceCount = deviceList.size();
+            if(monitor->getListGeneration() != displayedListGeneration) {
                 displayDeviceList();
             }
         }
@@ -148,22 +285,20 @@ void Menu_Controller::update() {
             // Check if selected device name needs scrolling
             if(!deviceList.empty() && selectedDeviceIndex < (int)deviceList.size()) {
                 uint8_t addr = deviceList[selectedDeviceIndex];
-                if(devices.find(addr) != devices.end()) {
-                    String deviceName = devices[addr].name;
-                    if(deviceName.length() == 0) {
-                        deviceName = "Device " + String(addr);
-                    }
+                DeviceInfo* dev = monitor->getDevice(addr);
+                if(dev != nullptr) {
+                    // An empty name shows as "Device N", which always fits
+                    int nameLen = strlen(dev->name);
 
                     // Calculate max name length (16 chars - " (N)" suffix)
-                    int pgnCount = devices[addr].pgns.size();
-                    String pgnSuffix = " (" + String(pgnCount) + ")";
-                    int maxNameLen = 16 - pgnSuffix.length();
+                    char pgnSuffix[8];
+                    int maxNameLen = 16 - snprintf(pgnSuffix, sizeof(pgnSuffix), " (%d)", dev->pgnCount);
 
-                    if((int)deviceName.length() > maxNameLen) {
+                    if(nameLen > maxNameLen) {
                         // Advance scroll position
                         deviceListScrollOffset++;
                         // Reset when we've scrolled through full text + padding
-                        if(deviceListScrollOffset >= (int)deviceName.length() + 3) {
+                        if(deviceListScrollOffset >= nameLen + 3) {
                             deviceListScrollOffset = 0;
                         }
 
@@ -177,18 +312,12 @@ void Menu_Controller::update() {
     // -------------------------------------------------------------------------
     // Device PGN List Screen Updates
     // -------------------------------------------------------------------------
-    // Refreshes PGN list when new PGNs are detected for the selected device
+    // Refreshes the PGN list when the selected device gains or loses PGNs
     else if(currentMenuID == MENU_DEVICE_PGNS) {
-        std::map<uint8_t, DeviceInfo>& devices = monitor->getDevices();
-        if(currentTime - lastPGNUpdate > 500) {
+        if(currentTime - lastPGNUpdate > 250) {
             lastPGNUpdate = currentTime;
-            if(devices.find(currentDeviceAddress) != devices.end()) {
-                static size_t lastPGNCount = 0;
-                size_t currentPGNCount = devices[currentDeviceAddress].pgns.size();
-                if(currentPGNCount != lastPGNCount) {
-                    lastPGNCount = currentPGNCount;
-                    displayDevicePGNs();
-                }
+            if(monitor->getDeviceGeneration(currentDeviceAddress) != displayedDeviceGeneration) {
+                displayDevicePGNs();
             }
         }
     }
@@ -197,9 +326,10 @@ void Menu_Controller::update() {
     // -------------------------------------------------------------------------
     // Handles live field value updates and horizontal text scrolling
     else if(currentMenuID == MENU_PGN_DETAIL) {
-        // Refresh PGN detail view periodically for live data
+        // Refresh values once the monitor reported new data for this PGN, at most
+        // every 250ms; the latest message is shown, so no update is lost.
         // Only update lines that have actually changed to avoid flicker
-        if(currentTime - lastPGNUpdate > 250) {  // Update every 250ms for live feel
+        if(watchedPGNChanged && currentTime - lastPGNUpdate > 250) {
             lastPGNUpdate = currentTime;
             updatePGNDetailValues();  // Only update changed values, no full redraw
         }
@@ -209,29 +339,22 @@ void Menu_Controller::update() {
         if(currentTime - lastPGNFieldScrollUpdate > SCROLL_DELAY_MS) {
             lastPGNFieldScrollUpdate = currentTime;
 
-            std::map<uint8_t, DeviceInfo>& devices = monitor->getDevices();
-            if(devices.find(currentDeviceAddress) != devices.end() &&
-               devices[currentDeviceAddress].pgns.find(currentPGN) != devices[currentDeviceAddress].pgns.end()) {
-                PGNData& pgnData = devices[currentDeviceAddress].pgns[currentPGN];
+            PGNData* decoded = monitor->getDecodedPGNData(currentDeviceAddress, currentPGN);
+            if(decoded != nullptr) {
+                PGNData& pgnData = *decoded;
                 bool anyScrolled = false;
                 int maxScrollNeeded = 0;
 
-                // Check if PGN title needs scrolling
-                if((int)pgnData.name.length() > 16) {
-                    int titleMaxScroll = pgnData.name.length();  // Scroll until off screen
-                    if(titleMaxScroll > maxScrollNeeded) maxScrollNeeded = titleMaxScroll;
-                }
-
                 // Check if any field values need scrolling
                 int row = 2;
                 for(int i = detailScrollOffset; i < (int)pgnData.fields.size() && row < 7; i++) {
                     PGNField& field = pgnData.fields[i];
-                    String valueWithUnit = field.value;
-                    int labelWidth = (field.name.length() > 0) ? field.name.length() + 2 : 0;
-                    if(field.unit.length() > 0) valueWithUnit += " " + field.unit;
+                    char valueWithUnit[N2K_FIELD_VALUE_SIZE + SCREEN_COLS];
+                    int valueLen = formatValueWithUnit(field, valueWithUnit, sizeof(valueWithUnit));
+                    int labelWidth = (field.name[0] != '\0') ? strlen(field.name) + 2 : 0;
                     int valueAreaWidth = 16 - labelWidth;
-                    if((int)valueWithUnit.length() > valueAreaWidth && valueAreaWidth > 0) {
-                        int fieldMaxScroll = valueWithUnit.length();  // Scroll until off screen
+                    if(valueLen > valueAreaWidth && valueAreaWidth > 0) {
+                        int fieldMaxScroll = valueLen;  // Scroll until off screen
                         if(fieldMaxScroll > maxScrollNeeded) maxScrollNeeded = fieldMaxScroll;
                     }
                     row++;
@@ -247,46 +370,32 @@ void Menu_Controller::update() {
                     // First few steps are pause (show position 0), then scroll
                     int scrollPos = (rawPos < pauseSteps) ? 0 : (rawPos - pauseSteps);
 
-                    // Scroll title if needed (row 0)
-                    if((int)pgnData.name.length() > 16) {
-                        int titleScrollPos = min(scrollPos, (int)pgnData.name.length());
-                        String title = pgnData.name.substring(titleScrollPos);
-                        while((int)title.length() < 16) title += " ";
-                        title = title.substring(0, 16);
-                        screen->drawString(0, 0, title.c_str());
-                        anyScrolled = true;
-                    }
-
                     // Scroll field value portion only - keep labels fixed (rows 2-6)
                     row = 2;
                     for(int i = detailScrollOffset; i < (int)pgnData.fields.size() && row < 7; i++) {
                         PGNField& field = pgnData.fields[i];
 
                         // Calculate label portion and value portion
-                        String label = "";
-                        String valueWithUnit = field.value;
-                        int labelWidth = 0;
-
-                        if(field.name.length() > 0) {
-                            label = field.name + ": ";
-                            labelWidth = label.length();
-                        }
-                        if(field.unit.length() > 0) {
-                            valueWithUnit += " " + field.unit;
+                        Screen_Line label;
+                        if(field.name[0] != '\0') {
+                            label.append(field.name).append(": ");
                         }
+                        int labelWidth = label.size();
+
+                        char valueWithUnit[N2K_FIELD_VALUE_SIZE + SCREEN_COLS];
+                        int valueLen = formatValueWithUnit(field, valueWithUnit, sizeof(valueWithUnit));
 
                         // Calculate available width for value after label
                         int valueAreaWidth = 16 - labelWidth;
 
                         // Only scroll if value portion is longer than available space
-                        if((int)valueWithUnit.length() > valueAreaWidth && valueAreaWidth > 0) {
+                        if(valueLen > valueAreaWidth && valueAreaWidth > 0) {
                             anyScrolled = true;
-                            int fieldScrollPos = min(scrollPos, (int)valueWithUnit.length());
+                            int fieldScrollPos = min(scrollPos, valueLen);
 
                             // Get remaining text after scroll position, pad with spaces
-                            String scrolledValue = valueWithUnit.substring(fieldScrollPos);
-                            while((int)scrolledValue.length() < valueAreaWidth) scrolledValue += " ";
-                            scrolledValue = scrolledValue.substring(0, valueAreaWidth);
+                            Screen_Line scrolledValue;
+                            scrolledValue.append(&valueWithUnit[fieldScrollPos], valueAreaWidth).padTo(valueAreaWidth);
 
                             // Draw label at column 0 (fixed), then scrolled value
                             screen->drawString(0, row, label.c_str());
@@ -363,20 +472,20 @@ void Menu_Controller::update() {
                                    (currentMenuID == MENU_CONFIGURE_SENSOR2) ? sensor2 : sensor3;
 
             if(targetSensor != nullptr) {
-                String typeName = String(getSensorDisplayName((int)targetSensor->getMessageType()));
+                const char* typeName = getSensorDisplayName((int)targetSensor->getMessageType());
+                int typeLen = strlen(typeName);
 
-                if((int)typeName.length() > SCROLL_VISIBLE_CHARS) {
+                if(typeLen > SCROLL_VISIBLE_CHARS) {
                     // Advance scroll position
                     typeScrollOffset++;
                     // Reset when we've scrolled through full text + padding
-                    if(typeScrollOffset >= (int)typeName.length() + 3) {
+                    if(typeScrollOffset >= typeLen + 3) {
                         typeScrollOffset = 0;
                     }
 
                     // Update just the type text line (row 3, column 5)
-                    String scrollText = typeName + "   " + typeName;
-                    String visible = scrollText.substring(typeScrollOffset, typeScrollOffset + SCROLL_VISIBLE_CHARS);
-                    while((int)visible.length() < SCROLL_VISIBLE_CHARS) visible += " ";
+                    Screen_Line visible;
+                    visible.appendScrolled(typeName, typeScrollOffset, SCROLL_VISIBLE_CHARS);
                     screen->drawString(5, 3, visible.c_str());
                 }
             }
@@ -0,0 +1,276 @@
+/**
+ * \file N2K_Logger.cpp
+ * \brief Implementation of the double-buffered frame logger
+ *
+ * Contains storage detection, file rotation and the buffer swap logic.
+ */
+
+#include "N2K_Logger.h"
+#include <SD.h>
+#include <LittleFS.h>
+
+#ifndef DMAMEM
+#define DMAMEM
+#endif
+
+/* ---------------------------------------------------------------------------
+ * Buffer storage
+ *
+ * Both buffers live in DMAMEM (RAM2) and are aligned to the 32 byte cache
+ * line, so the SD driver can move them without extra copies.
+ * ------------------------------------------------------------------------- */
+
+DMAMEM static uint8_t logBufferA[LOGGER_BUFFER_SIZE] __attribute__((aligned(32)));
+DMAMEM static uint8_t logBufferB[LOGGER_BUFFER_SIZE] __attribute__((aligned(32)));
+
+static LittleFS_Program flashFS;
+
+/// Highest log file number
+static constexpr uint16_t MAX_LOG_INDEX = 9999;
+
+static const uint8_t LOG_HEADER[8] = {'N', 'E', 'M', 'O', 'L', 'O', 'G', N2K_LOG_VERSION};
+
+N2K_Logger::N2K_Logger() {
+    fs = nullptr;
+    storage = LOGGER_STORAGE_NONE;
+    fileName[0] = '\0';
+
+    recording = false;
+    logTransmitted = false;
+    writeError = false;
+
+    buffers[0] = logBufferA;
+    buffers[1] = logBufferB;
+    bufferLen[0] = 0;
+    bufferLen[1] = 0;
+    fillIndex = 0;
+    flushPending = false;
+    lastSwapTime = 0;
+
+    fileIndex = 0;
+    fileBytes = 0;
+    fileSizeLimit = LOGGER_FILE_SIZE_LIMIT;
+
+    bytesWritten = 0;
+    framesLogged = 0;
+    framesDropped = 0;
+}
+
+bool N2K_Logger::begin() {
+    if(SD.begin(LOGGER_SD_CS_PIN)) {
+        fs = &SD;
+        storage = LOGGER_STORAGE_SD;
+        fileSizeLimit = LOGGER_FILE_SIZE_LIMIT;
+    } else if(flashFS.begin(LOGGER_FLASH_SIZE)) {
+        fs = &flashFS;
+        storage = LOGGER_STORAGE_FLASH;
+        fileSizeLimit = LOGGER_FLASH_SIZE / 4;
+    } else {
+        fs = nullptr;
+        storage = LOGGER_STORAGE_NONE;
+    }
+
+#if DEBUG
+    Serial.print("Logger storage: ");
+    Serial.println(getStorageName());
+#endif
+
+    return storage != LOGGER_STORAGE_NONE;
+}
+
+const char* N2K_Logger::getStorageName() const {
+    switch(storage) {
+        case LOGGER_STORAGE_SD:    return "SD";
+        case LOGGER_STORAGE_FLASH: return "Flash";
+        default:                   return "None";
+    }
+}
+
+void N2K_Logger::makeFileName(uint16_t index, char* out) {
+    snprintf(out, 13, "NEMO%04u.LOG", (unsigned)index);
+}
+
+/**
+ * \brief Start recording into a new log file
+ *
+ * Continues numbering after the highest existing log, so earlier
+ * recordings are never overwritten.
+ *
+ * \return true if recording started
+ */
+bool N2K_Logger::start() {
+    if(recording || fs == nullptr) return recording;
+
+    bufferLen[0] = 0;
+    bufferLen[1] = 0;
+    fillIndex = 0;
+    flushPending = false;
+    lastSwapTime = millis();
+
+    bytesWritten = 0;
+    framesLogged = 0;
+    framesDropped = 0;
+    writeError = false;
+
+    if(!openNextFile()) {
+        writeError = true;
+        return false;
+    }
+
+    recording = true;
+    return true;
+}
+
+void N2K_Logger::stop() {
+    if(!recording) return;
+
+    // Write whatever is still buffered, in order
+    if(flushPending) writePending();
+    if(bufferLen[fillIndex] > 0) {
+        swapBuffers();
+        writePending();
+    }
+
+    if(logFile) logFile.close();
+    recording = false;
+}
+
+/**
+ * \brief Record a frame
+ *
+ * Only copies the frame into the fill buffer. If the fill buffer is full
+ * and the other one is still waiting for storage, the frame is dropped.
+ *
+ * \param frame Frame to record
+ * \param transmitted true if NEMO sent the frame on CAN1
+ */
+void N2K_Logger::logFrame(const CaptureFrame& frame, bool transmitted) {
+    if(!recording) return;
+    if(transmitted && !logTransmitted) return;
+
+    uint8_t len = frame.len > 8 ? 8 : frame.len;
+    uint32_t recordLen = 9 + len;
+
+    if(bufferLen[fillIndex] + recordLen > LOGGER_BUFFER_SIZE) {
+        if(flushPending) {
+            framesDropped++;
+            return;
+        }
+        swapBuffers();
+    }
+
+    uint32_t id = frame.id;
+    if(transmitted) id |= N2K_LOG_TX_FLAG;
+
+    uint8_t* out = buffers[fillIndex] + bufferLen[fillIndex];
+    memcpy(out, &frame.timestamp, 4);
+    memcpy(out + 4, &id, 4);
+    out[8] = len;
+    memcpy(out + 9, frame.data, len);
+
+    bufferLen[fillIndex] += recordLen;
+    framesLogged++;
+}
+
+void N2K_Logger::swapBuffers() {
+    flushPending = true;
+    fillIndex ^= 1;
+    bufferLen[fillIndex] = 0;
+    lastSwapTime = millis();
+}
+
+/**
+ * \brief Write full buffers to storage
+ *
+ * A partly filled buffer is also written once it is older than
+ * LOGGER_FLUSH_INTERVAL_MS, so a quiet bus still reaches the card.
+ */
+void N2K_Logger::service() {
+    if(!recording) return;
+
+    if(!flushPending && bufferLen[fillIndex] > 0 &&
+       millis() - lastSwapTime >= LOGGER_FLUSH_INTERVAL_MS) {
+        swapBuffers();
+    }
+
+    if(flushPending) {
+        writePending();
+    }
+}
+
+/**
+ * \brief Write the buffer waiting for storage
+ *
+ * Rotates to a new file first if the buffer would push the current file
+ * past the size limit. Any write failure (card pulled, flash full) stops
+ * the recording and sets the error flag.
+ */
+void N2K_Logger::writePending() {
+    uint8_t index = fillIndex ^ 1;
+    uint32_t len = bufferLen[index];
+
+    if(len > 0) {
+        if(fileBytes + len > fileSizeLimit && !openNextFile()) {
+            writeError = true;
+            recording = false;
+            return;
+        }
+
+        size_t written = logFile.write(buffers[index], len);
+        logFile.flush();
+
+        if(written != len) {
+            logFile.close();
+            writeError = true;
+            recording = false;
+            return;
+        }
+
+        fileBytes += len;
+        bytesWritten += len;
+    }
+
+    bufferLen[index] = 0;
+    flushPending = false;
+}
+
+bool N2K_Logger::openNextFile() {
+    if(logFile) logFile.close();
+
+    // Find the next unused file number
+    char name[16];
+    do {
+        if(fileIndex >= MAX_LOG_INDEX) return false;
+        fileIndex++;
+        makeFileName(fileIndex, name);
+    } while(fs->exists(name));
+
+    if(storage == LOGGER_STORAGE_FLASH) {
+        makeRoom();
+    }
+
+    logFile = fs->open(name, FILE_WRITE);
+    if(!logFile) return false;
+
+    strcpy(fileName, name);
+    fileBytes = logFile.write(LOG_HEADER, sizeof(LOG_HEADER));
+    bytesWritten += fileBytes;
+    return fileBytes == sizeof(LOG_HEADER);
+}
+
+/**
+ * \brief Delete the oldest logs until a full file fits on flash
+ *
+ * Only used for the program flash, which is small enough to fill up
+ * during a long recording. SD cards are never cleaned up automatically.
+ */
+void N2K_Logger::makeRoom() {
+    char name[16];
+    for(uint16_t i = 1; i < fileIndex; i++) {
+        if(fs->totalSize() - fs->usedSize() >= fileSizeLimit) return;
+        makeFileName(i, name);
+        if(fs->exists(name)) {
+            fs->remove(name);
+        }
+    }
+}
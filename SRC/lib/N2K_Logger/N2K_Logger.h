@@ -0,0 +1,246 @@
+/**
+ * \file N2K_Logger.h
+ * \brief On-device recording of raw CAN frames to SD card or onboard flash
+ *
+ * The logger records frames into a compact binary log so sea trials can be
+ * captured without a laptop attached. Received CAN2 frames always get
+ * logged. The frames NEMO itself transmits on CAN1 can be logged as well.
+ *
+ * Frames are collected in two RAM buffers. One buffer fills while the other
+ * is written to storage, so a slow card write never loses the frames that
+ * arrive meanwhile. Frames are only dropped (and counted) when both buffers
+ * are full. Files rotate when they reach LOGGER_FILE_SIZE_LIMIT.
+ *
+ * Storage is an SPI SD card on LOGGER_SD_CS_PIN if one is present, otherwise
+ * a LOGGER_FLASH_SIZE area of the Teensy program flash. On flash the oldest
+ * logs are deleted to make room for new ones.
+ *
+ * Log file layout (all values little-endian):
+ * - File header: "NEMOLOG" followed by a version byte (8 bytes)
+ * - Records:     timestamp (4, micros), id (4), length (1), data (length)
+ *
+ * Bit 31 of the record id is set for frames NEMO transmitted on CAN1.
+ */
+
+#ifndef N2K_LOGGER_H
+#define N2K_LOGGER_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <CAN_Capture.h>
+#include "constants.h"
+
+/**
+ * \brief Version byte written in the log file header
+ */
+#define N2K_LOG_VERSION 1
+
+/**
+ * \brief Flag in the record id marking a frame transmitted by NEMO
+ */
+#define N2K_LOG_TX_FLAG 0x80000000UL
+
+/**
+ * \enum LoggerStorage
+ * \brief Storage backend the logger writes to
+ */
+enum LoggerStorage : uint8_t {
+    LOGGER_STORAGE_NONE,    ///< No usable storage found
+    LOGGER_STORAGE_SD,      ///< SPI SD card
+    LOGGER_STORAGE_FLASH    ///< LittleFS area in program flash
+};
+
+/**
+ * \class N2K_Logger
+ * \brief Double-buffered binary frame logger
+ *
+ * logFrame() only copies into RAM and never touches storage. All writes
+ * happen in service(), which must be called from loop().
+ */
+class N2K_Logger {
+private:
+    FS* fs;                         ///< Filesystem of the selected storage
+    LoggerStorage storage;          ///< Selected storage backend
+    File logFile;                   ///< Currently open log file
+    char fileName[16];              ///< Name of the current log file
+
+    bool recording;                 ///< true while logging is active
+    bool logTransmitted;            ///< Also record frames sent on CAN1
+    bool writeError;                ///< Last recording stopped on a storage error
+
+    uint8_t* buffers[2];            ///< The two frame buffers
+    uint32_t bufferLen[2];          ///< Bytes used in each buffer
+    uint8_t fillIndex;              ///< Buffer currently being filled
+    bool flushPending;              ///< The other buffer is full and waiting to be written
+    unsigned long lastSwapTime;     ///< millis() of the last buffer swap
+
+    uint16_t fileIndex;             ///< Number of the current log file
+    uint32_t fileBytes;             ///< Bytes in the current log file
+    uint32_t fileSizeLimit;         ///< Rotation size for the selected storage
+
+    uint32_t bytesWritten;          ///< Bytes written since recording started
+    uint32_t framesLogged;          ///< Frames buffered since recording started
+    uint32_t framesDropped;         ///< Frames lost because both buffers were full
+
+    /**
+     * \brief Close the current file and open the next free log file
+     *
+     * \return true if a new file was opened
+     */
+    bool openNextFile();
+
+    /**
+     * \brief Delete the oldest logs until a full file fits on flash
+     */
+    void makeRoom();
+
+
+    /**
+     * \brief Hand the fill buffer over for writing and start filling the other
+     */
+    void swapBuffers();
+
+    /**
+     * \brief Write the buffer waiting for storage
+     */
+    void writePending();
+
+public:
+    /**
+     * \brief Construct an idle logger
+     */
+    N2K_Logger();
+
+    /**
+     * \brief Detect the storage backend
+     *
+     * Tries the SD card first and falls back to program flash.
+     *
+     * \return true if a storage backend is available
+     */
+    bool begin();
+
+    /**
+     * \brief Start recording into a new log file
+     *
+     * \return true if recording started
+     */
+    bool start();
+
+    /**
+     * \brief Write any buffered frames and close the log file
+     */
+    void stop();
+
+    /**
+     * \brief Record a frame
+     *
+     * Cheap enough to call for every frame. Does nothing when not recording,
+     * or for transmitted frames when transmit logging is off.
+     *
+     * \param frame Frame to record
+     * \param transmitted true if NEMO sent the frame on CAN1
+     */
+    void logFrame(const CaptureFrame& frame, bool transmitted);
+
+    /**
+     * \brief Write full buffers to storage
+     *
+     * Call once per loop iteration.
+     */
+    void service();
+
+    /**
+     * \brief Check whether recording is active
+     *
+     * \return true while recording
+     */
+    bool isRecording() const { return recording; }
+
+    /**
+     * \brief Check whether the last recording stopped because of a storage error
+     *
+     * \return true after a failed write or file open
+     */
+    bool hasWriteError() const { return writeError; }
+
+    /**
+     * \brief Enable or disable logging of frames transmitted on CAN1
+     *
+     * \param enabled true to record transmitted frames
+     */
+    void setLogTransmitted(bool enabled) { logTransmitted = enabled; }
+
+    /**
+     * \brief Check whether transmitted frames are recorded
+     *
+     * \return true if transmit logging is on
+     */
+    bool isLogTransmitted() const { return logTransmitted; }
+
+    /**
+     * \brief Get the selected storage backend
+     *
+     * \return Storage backend, LOGGER_STORAGE_NONE before begin() or without storage
+     */
+    LoggerStorage getStorage() const { return storage; }
+
+    /**
+     * \brief Get a short display name for the storage backend
+     *
+     * \return "SD", "Flash" or "None"
+     */
+    const char* getStorageName() const;
+
+    /**
+     * \brief Get the name of the current (or last) log file
+     *
+     * \return File name, empty before the first recording
+     */
+    const char* getFileName() const { return fileName; }
+
+    /**
+     * \brief Get the filesystem logs are written to
+     *
+     * \return Filesystem, nullptr without storage
+     */
+    FS* getFileSystem() const { return fs; }
+
+    /**
+     * \brief Build the file name for a log number
+     *
+     * \param index Log number
+     * \param[out] out Buffer of at least 13 characters
+     */
+    static void makeFileName(uint16_t index, char* out);
+
+    /**
+     * \brief Get the number of bytes written since recording started
+     *
+     * \return Bytes written to storage
+     */
+    uint32_t getBytesWritten() const { return bytesWritten; }
+
+    /**
+     * \brief Get the number of frames recorded since recording started
+     *
+     * \return Frames logged
+     */
+    uint32_t getFramesLogged() const { return framesLogged; }
+
+    /**
+     * \brief Get the number of frames dropped since recording started
+     *
+     * \return Frames dropped because both buffers were full
+     */
+    uint32_t getFramesDropped() const { return framesDropped; }
+
+    /**
+     * \brief Get the number of bytes waiting in the two buffers
+     *
+     * \return Fill level, at most 2 * LOGGER_BUFFER_SIZE
+     */
+    uint32_t getBufferedBytes() const { return bufferLen[0] + bufferLen[1]; }
+};
+
+#endif // N2K_LOGGER_H
@@ -0,0 +1,337 @@
+/**
+ * \file N2K_Anomaly.cpp
+ * \brief Implementation of the spoofing and address conflict detector
+ *
+ * Contains the table of physical limits, the per-message checks and the
+ * alert ring.
+ */
+
+#include "N2K_Anomaly.h"
+#include <math.h>
+
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+
+static_assert((MONITOR_ANOMALY_CONFLICT_SLOTS & (MONITOR_ANOMALY_CONFLICT_SLOTS - 1)) == 0,
+              "MONITOR_ANOMALY_CONFLICT_SLOTS must be a power of two");
+static_assert(MONITOR_ANOMALY_ALERTS > 0 && MONITOR_ANOMALY_ALERTS <= 255,
+              "MONITOR_ANOMALY_ALERTS must fit the 8-bit ring indices");
+static_assert(ANOMALY_TYPE_COUNT <= 8, "Stream anomalies must fit N2K_StreamGuard::active");
+
+/// Value of N2K_Alert::source and other when there is no address
+static constexpr uint8_t NO_SOURCE = 0xFF;
+
+/**
+ * \brief Limits of the value fields checked for conflicts and jumps, sorted by PGN number
+ *
+ * Field indices refer to the PGN's row in IMPERSONATABLE_PGN_DEFS. The
+ * kind field keeps apart streams that share an instance number but measure
+ * different things, like a fuel and a water tank both at instance 0. Rates
+ * are generous upper bounds of what the measured quantity can do, so
+ * sensor noise and fast but real changes (a gust, a drop-off) stay below
+ * them; tolerances allow for two honest sensors reading slightly apart.
+ */
+static constexpr N2K_AnomalyLimit ANOMALY_LIMITS[] PROGMEM = {
+    //  pgn    value inst  kind  rate/s  tolerance  wrap
+    {127245,     1,    0, 0xFF,     60,        10,    0},   // Rudder angle (deg)
+    {127250,     0, 0xFF, 0xFF,     90,        10,  360},   // Heading (deg)
+    {127488,     1,    0, 0xFF,   2000,       200,    0},   // Engine RPM
+    {127489,     3,    0, 0xFF,      5,         5,    0},   // Coolant temperature (C)
+    {127505,     2,    0,    1,     10,         5,    0},   // Fluid level (%), per fluid type
+    {127508,     1,    0, 0xFF,     10,         1,    0},   // Battery voltage (V)
+    {128259,     0, 0xFF, 0xFF,      5,         2,    0},   // Speed through water (kn)
+    {128267,     0, 0xFF, 0xFF,     20,         2,    0},   // Water depth (m)
+    {129026,     1, 0xFF, 0xFF,      5,         2,    0},   // Speed over ground (kn)
+    {130306,     0, 0xFF, 0xFF,     40,        10,    0},   // Wind speed (kn)
+    {130310,     0, 0xFF, 0xFF,      2,         2,    0},   // Water temperature (C)
+    {130312,     2,    0,    1,      5,         5,    0},   // Temperature (C), per source
+    {130314,     1,    0, 0xFF,     10,         5,    0},   // Pressure (mbar)
+};
+
+static constexpr int ANOMALY_LIMIT_COUNT = sizeof(ANOMALY_LIMITS) / sizeof(ANOMALY_LIMITS[0]);
+
+/**
+ * \brief Check that ANOMALY_LIMITS is sorted and names fields that can be decoded
+ *
+ * \return true if every row is ascending and refers to a numeric value
+ *         field (and instance and kind fields, if any) of its PGN table row
+ */
+static constexpr bool anomalyLimitsValid() {
+    for(int i = 0; i < ANOMALY_LIMIT_COUNT; i++) {
+        const N2K_AnomalyLimit& limit = ANOMALY_LIMITS[i];
+        if(i > 0 && ANOMALY_LIMITS[i - 1].pgn >= limit.pgn) return false;
+        if(limit.maxRate <= 0 || limit.tolerance <= 0) return false;
+
+        const PGNDef* def = nullptr;
+        for(int d = 0; d < IMPERSONATABLE_PGN_COUNT; d++) {
+            if(IMPERSONATABLE_PGN_DEFS[d].pgn == limit.pgn) def = &IMPERSONATABLE_PGN_DEFS[d];
+        }
+        if(def == nullptr || limit.valueField >= getPGNDefFieldTotal(*def)) return false;
+        if(def->fields[limit.valueField].enumNames != nullptr) return false;
+        if(limit.instanceField != 0xFF && limit.instanceField >= getPGNDefFieldTotal(*def)) return false;
+        if(limit.kindField != 0xFF && limit.kindField >= getPGNDefFieldTotal(*def)) return false;
+    }
+    return true;
+}
+
+static_assert(anomalyLimitsValid(), "ANOMALY_LIMITS must be sorted and name numeric fields of the PGN table");
+
+static const char* const ANOMALY_TYPE_NAMES[ANOMALY_TYPE_COUNT] = {
+    "CLAIMS", "CONFLICT", "INTERVAL", "JITTER", "JUMP",
+};
+
+const N2K_AnomalyLimit* N2K_AnomalyDetector::getLimit(uint32_t pgn) {
+    int low = 0;
+    int high = ANOMALY_LIMIT_COUNT - 1;
+    while(low <= high) {
+        int mid = (low + high) / 2;
+        if(ANOMALY_LIMITS[mid].pgn == pgn) return &ANOMALY_LIMITS[mid];
+        if(ANOMALY_LIMITS[mid].pgn < pgn) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return nullptr;
+}
+
+const char* N2K_AnomalyDetector::getTypeName(AnomalyType type) {
+    return type < ANOMALY_TYPE_COUNT ? ANOMALY_TYPE_NAMES[type] : "?";
+}
+
+void N2K_AnomalyDetector::reset() {
+    for(int i = 0; i < MONITOR_ANOMALY_CONFLICT_SLOTS; i++) {
+        conflicts[i].pgn = 0;
+    }
+    for(int i = 0; i < ANOMALY_TYPE_COUNT; i++) {
+        totals[i] = 0;
+    }
+    alertHead = 0;
+    alertCount = 0;
+    busWindowStart = 0;
+    busWindowClaims = 0;
+    busStormActive = false;
+    generation++;
+}
+
+/**
+ * \brief Add an alert, or update it if still in the ring
+ *
+ * At most MONITOR_ANOMALY_ALERTS entries are compared, so a storm of
+ * repeats costs the same as a new alert. Once the ring is full the oldest
+ * alert is overwritten.
+ */
+void N2K_AnomalyDetector::raise(AnomalyType type, uint8_t source, uint8_t other, uint32_t pgn,
+                                uint64_t name, float value, float limit, uint32_t nowMillis) {
+    totals[type]++;
+    generation++;
+
+    for(int age = 0; age < alertCount; age++) {
+        N2K_Alert& alert = alerts[(alertHead + MONITOR_ANOMALY_ALERTS - 1 - age) % MONITOR_ANOMALY_ALERTS];
+        if(alert.type != type || alert.pgn != pgn || alert.name != name) continue;
+        // A storming NAME hops addresses, so claim storms are matched by NAME alone
+        if(type != ANOMALY_CLAIM_STORM && alert.source != source) continue;
+        alert.source = source;
+        alert.other = other;
+        alert.value = value;
+        alert.limit = limit;
+        alert.lastMillis = nowMillis;
+        if(alert.count < 0xFFFF) alert.count++;
+        return;
+    }
+
+    N2K_Alert& alert = alerts[alertHead];
+    alert.type = type;
+    alert.source = source;
+    alert.other = other;
+    alert.pgn = pgn;
+    alert.name = name;
+    alert.value = value;
+    alert.limit = limit;
+    alert.count = 1;
+    alert.firstMillis = nowMillis;
+    alert.lastMillis = nowMillis;
+    alertHead = (alertHead + 1) % MONITOR_ANOMALY_ALERTS;
+    if(alertCount < MONITOR_ANOMALY_ALERTS) alertCount++;
+}
+
+void N2K_AnomalyDetector::latch(N2K_StreamGuard& guard, AnomalyType type, bool condition, uint8_t source,
+                                uint32_t pgn, float value, float limit, uint32_t nowMillis) {
+    uint8_t bit = 1 << type;
+    if(!condition) {
+        guard.active &= ~bit;
+    } else if(!(guard.active & bit)) {
+        guard.active |= bit;
+        raise(type, source, NO_SOURCE, pgn, 0, value, limit, nowMillis);
+    }
+}
+
+/**
+ * \brief Check an address claim
+ *
+ * Claims are counted per fixed window of MONITOR_ANOMALY_CLAIM_WINDOW_MS,
+ * per NAME in its identity record and for the bus as a whole. A NAME or
+ * the bus raises one alert per window that goes over its limit. NAMEs that
+ * didn't fit the identity table still count for the bus.
+ */
+void N2K_AnomalyDetector::recordClaim(N2K_Identity* identity, uint64_t name, uint8_t address,
+                                      uint32_t nowMillis) {
+    if(nowMillis - busWindowStart >= MONITOR_ANOMALY_CLAIM_WINDOW_MS) {
+        busWindowStart = nowMillis;
+        busWindowClaims = 0;
+        busStormActive = false;
+    }
+    if(busWindowClaims < 0xFFFF) busWindowClaims++;
+    if(busWindowClaims > MONITOR_ANOMALY_BUS_CLAIM_LIMIT && !busStormActive) {
+        busStormActive = true;
+        raise(ANOMALY_CLAIM_STORM, NO_SOURCE, NO_SOURCE, 60928, 0, busWindowClaims,
+              MONITOR_ANOMALY_BUS_CLAIM_LIMIT, nowMillis);
+    }
+
+    if(identity == nullptr) return;
+
+    if(nowMillis - identity->claimWindowStart >= MONITOR_ANOMALY_CLAIM_WINDOW_MS) {
+        identity->claimWindowStart = nowMillis;
+        identity->claimWindowCount = 0;
+    }
+    identity->claimWindowCount++;
+
+    // Raised once, when the window goes over the limit
+    if(identity->claimWindowCount == MONITOR_ANOMALY_CLAIM_LIMIT + 1) {
+        raise(ANOMALY_CLAIM_STORM, address, NO_SOURCE, 60928, name, identity->claimWindowCount,
+              MONITOR_ANOMALY_CLAIM_LIMIT, nowMillis);
+    }
+}
+
+/**
+ * \brief Check a stored message
+ *
+ * Timing checks start once the stream has MONITOR_ANOMALY_LEARN_MESSAGES
+ * messages, so its long-run interval mean and jitter are a baseline to
+ * compare with. The interval check compares the smoothed interval (which
+ * follows a change within a few messages) with that mean; the jitter check
+ * compares the recent deviation with the long-run jitter. Both thresholds
+ * have a floor relative to the mean interval, so perfectly regular senders
+ * don't alert on a millisecond of noise.
+ *
+ * Only periodic streams are timed: address claims, requests and other
+ * PGNs sent on demand have a jitter of the order of their mean interval
+ * (above MONITOR_ANOMALY_PERIODIC_RATIO) and no rate to deviate from.
+ */
+void N2K_AnomalyDetector::recordMessage(N2K_StreamGuard& guard, const N2K_PGNStats& stats, uint8_t source,
+                                        uint32_t pgn, const uint8_t* data, uint8_t dataLen,
+                                        uint32_t arrivalMicros, uint32_t nowMillis) {
+    float baseline = stats.getMeanInterval();
+    float jitter = stats.getJitter();
+    bool periodic = stats.getCount() >= MONITOR_ANOMALY_LEARN_MESSAGES &&
+                    jitter <= MONITOR_ANOMALY_PERIODIC_RATIO * baseline;
+
+    float interval = stats.getInterval();
+    float intervalLimit = max(MONITOR_ANOMALY_INTERVAL_SIGMAS * jitter, MONITOR_ANOMALY_INTERVAL_RATIO * baseline);
+    latch(guard, ANOMALY_INTERVAL_CHANGE, periodic && fabsf(interval - baseline) > intervalLimit, source, pgn,
+          interval, baseline, nowMillis);
+
+    float recentJitter = stats.getRecentJitter();
+    float jitterLimit = MONITOR_ANOMALY_JITTER_RATIO * jitter + MONITOR_ANOMALY_JITTER_FLOOR * baseline;
+    latch(guard, ANOMALY_JITTER_CHANGE, periodic && recentJitter > jitterLimit, source, pgn,
+          recentJitter, jitter, nowMillis);
+
+    const N2K_AnomalyLimit* limit = getLimit(pgn);
+    if(limit != nullptr) {
+        checkValue(guard, *limit, source, data, dataLen, arrivalMicros, nowMillis);
+    }
+}
+
+/**
+ * \brief Check the value field of a message against the limits of its PGN
+ *
+ * The jump check compares with the previous value of the same stream,
+ * instance and kind. The conflict check compares with the last value another
+ * source sent for the same (PGN, instance, kind) within
+ * MONITOR_ANOMALY_CONFLICT_WINDOW_MS.
+ * Its table is direct-mapped, so two keys sharing a slot just replace each
+ * other and may miss a conflict rather than cost a search.
+ */
+void N2K_AnomalyDetector::checkValue(N2K_StreamGuard& guard, const N2K_AnomalyLimit& limit, uint8_t source,
+                                     const uint8_t* data, uint8_t dataLen, uint32_t arrivalMicros,
+                                     uint32_t nowMillis) {
+    // Field indices count every field of the table row, not only the editable ones getPGNField() counts
+    const PGNDef* def = getPGNDef(limit.pgn);
+    if(def == nullptr) return;
+    const PGNFieldDef* field = &def->fields[limit.valueField];
+
+    // N/A and error values are not compared
+    int32_t raw;
+    if(!decodePGNField(*field, data, dataLen, raw)) {
+        guard.hasValue = false;
+        return;
+    }
+    float value = (float)getPGNFieldValue(*field, raw);
+
+    // Instance in the low byte, kind in the high byte
+    uint16_t instance = 0;
+    if(limit.instanceField != 0xFF) {
+        int32_t instanceRaw;
+        if(decodePGNField(def->fields[limit.instanceField], data, dataLen, instanceRaw)) {
+            instance = (uint8_t)instanceRaw;
+        }
+    }
+    if(limit.kindField != 0xFF) {
+        int32_t kindRaw;
+        if(decodePGNField(def->fields[limit.kindField], data, dataLen, kindRaw)) {
+            instance |= (uint16_t)((uint8_t)kindRaw << 8);
+        }
+    }
+
+    // Value jump, against the stream's previous value of the same instance
+    if(guard.hasValue && guard.lastInstance == instance) {
+        float delta = value - guard.lastValue;
+        if(limit.wrap > 0) {
+            delta = fmodf(delta, limit.wrap);
+            if(delta > limit.wrap / 2) delta -= limit.wrap;
+            if(delta < -limit.wrap / 2) delta += limit.wrap;
+        }
+        float seconds = (uint32_t)(arrivalMicros - guard.lastMicros) / 1000000.0f;
+        float allowed = limit.maxRate * seconds + MONITOR_ANOMALY_JUMP_COUNTS * (float)field->scale;
+        if(fabsf(delta) > allowed) {
+            float rate = seconds > 0 ? fabsf(delta) / seconds : fabsf(delta) * 1000000.0f;
+            raise(ANOMALY_VALUE_JUMP, source, NO_SOURCE, limit.pgn, 0, rate, limit.maxRate, nowMillis);
+        }
+    }
+    guard.lastValue = value;
+    guard.lastMicros = arrivalMicros;
+    guard.lastInstance = instance;
+    guard.hasValue = true;
+
+    // Value conflict, against the last other source of this (PGN, instance, kind)
+    uint32_t key = limit.pgn * 31 + instance;
+    ConflictSlot& slot = conflicts[(key * 2654435761UL >> 16) & (MONITOR_ANOMALY_CONFLICT_SLOTS - 1)];
+    if(slot.pgn == limit.pgn && slot.instance == instance && slot.source != source &&
+       arrivalMicros - slot.micros < MONITOR_ANOMALY_CONFLICT_WINDOW_MS * 1000UL) {
+        float difference = fabsf(value - slot.value);
+        if(limit.wrap > 0 && difference > limit.wrap / 2) difference = limit.wrap - difference;
+        if(difference > limit.tolerance) {
+            raise(ANOMALY_VALUE_CONFLICT, source, slot.source, limit.pgn, 0, difference, limit.tolerance,
+                  nowMillis);
+        }
+    }
+    slot.pgn = limit.pgn;
+    slot.instance = instance;
+    slot.source = source;
+    slot.value = value;
+    slot.micros = arrivalMicros;
+}
+
+const N2K_Alert* N2K_AnomalyDetector::getAlert(int age) const {
+    if(age < 0 || age >= alertCount) return nullptr;
+    return &alerts[(alertHead + MONITOR_ANOMALY_ALERTS - 1 - age) % MONITOR_ANOMALY_ALERTS];
+}
+
+uint32_t N2K_AnomalyDetector::getTotal() const {
+    uint32_t total = 0;
+    for(int i = 0; i < ANOMALY_TYPE_COUNT; i++) {
+        total += totals[i];
+    }
+    return total;
+}
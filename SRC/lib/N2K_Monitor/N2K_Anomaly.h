@@ -0,0 +1,289 @@
+/**
+ * \file N2K_Anomaly.h
+ * \brief Spoofing and address conflict detection for the N2K_Monitor module
+ *
+ * The attacks NEMO demonstrates leave signatures on the bus that the monitor
+ * already has most of the data for. N2K_AnomalyDetector runs after every
+ * stored message and looks for:
+ * - address claim storms: one NAME claiming more than
+ *   MONITOR_ANOMALY_CLAIM_LIMIT times per MONITOR_ANOMALY_CLAIM_WINDOW_MS,
+ *   or the whole bus claiming more than MONITOR_ANOMALY_BUS_CLAIM_LIMIT
+ * - value conflicts: two sources sending the same PGN, instance and kind
+ *   (fluid type, temperature source) with values further apart than the
+ *   PGN's tolerance
+ * - interval changes: a stream's smoothed interval leaving its learned
+ *   baseline, the long-run mean of N2K_PGNStats
+ * - jitter changes: a stream's recent jitter rising well above its learned
+ *   jitter
+ * - value jumps: a field changing faster than the physical limit of what it
+ *   measures
+ *
+ * Conflicts and jumps are checked on the value field of the PGNs listed in
+ * a small table in flash (N2K_Anomaly.cpp), decoded straight from the raw
+ * payload like the field history does.
+ *
+ * Every check is constant time and nothing is allocated. Per-stream state
+ * lives in the PGN entry (N2K_StreamGuard), per-NAME claim counts in the
+ * identity record, and conflicts use a direct-mapped table of
+ * MONITOR_ANOMALY_CONFLICT_SLOTS entries. Alerts go into a ring of
+ * MONITOR_ANOMALY_ALERTS; a repeat of an alert still in the ring only
+ * bumps its count.
+ */
+
+#ifndef N2K_ANOMALY_H
+#define N2K_ANOMALY_H
+
+#include <Arduino.h>
+#include <PGN_Helpers.h>
+#include "constants.h"
+#include "N2K_Stats.h"
+#include "N2K_Identity.h"
+
+/**
+ * \enum AnomalyType
+ * \brief Kinds of anomaly the detector raises alerts for
+ */
+enum AnomalyType : uint8_t {
+    ANOMALY_CLAIM_STORM,        ///< Address claim rate of a NAME or of the bus above its limit
+    ANOMALY_VALUE_CONFLICT,     ///< Two sources disagree on the value of a PGN
+    ANOMALY_INTERVAL_CHANGE,    ///< Send interval of a stream left its baseline
+    ANOMALY_JITTER_CHANGE,      ///< Jitter of a stream rose above its baseline
+    ANOMALY_VALUE_JUMP,         ///< Value changed faster than physically possible
+    ANOMALY_TYPE_COUNT          ///< Number of anomaly types
+};
+
+/**
+ * \struct N2K_StreamGuard
+ * \brief Detector state of one (source, PGN) entry
+ *
+ * Kept in PGNData next to the statistics it builds on.
+ */
+struct N2K_StreamGuard {
+    float lastValue;            ///< Previous value of the checked field
+    uint32_t lastMicros;        ///< Arrival time of lastValue (micros)
+    uint16_t lastInstance;      ///< Instance and kind lastValue belongs to, see N2K_AnomalyLimit
+    bool hasValue;              ///< lastValue is valid
+    uint8_t active;             ///< Bit per AnomalyType currently raised for the stream
+
+    /**
+     * \brief Forget the previous value and the raised anomalies
+     */
+    void reset() {
+        hasValue = false;
+        active = 0;
+    }
+};
+
+/**
+ * \struct N2K_Alert
+ * \brief One entry of the alert list
+ *
+ * What value and limit hold depends on the type:
+ * - CLAIM_STORM: claims in the window and the limit; name is the NAME, 0
+ *   for the bus-wide limit
+ * - VALUE_CONFLICT: difference between the two values and the tolerance;
+ *   other is the second source
+ * - INTERVAL_CHANGE: smoothed interval and baseline interval (ms)
+ * - JITTER_CHANGE: recent jitter and baseline jitter (ms)
+ * - VALUE_JUMP: rate of change and the limit (display units per second)
+ */
+struct N2K_Alert {
+    AnomalyType type;           ///< What was detected
+    uint8_t source;             ///< Source address, 0xFF for bus-wide alerts
+    uint8_t other;              ///< Second source of a conflict, 0xFF otherwise
+    uint32_t pgn;               ///< PGN concerned
+    uint64_t name;              ///< NAME of a claim storm, 0 otherwise
+    float value;                ///< Measured value, see above
+    float limit;                ///< Limit or baseline it was compared with
+    uint16_t count;             ///< Times detected while the alert was in the ring
+    uint32_t firstMillis;       ///< First detection (millis)
+    uint32_t lastMillis;        ///< Latest detection (millis)
+};
+
+/**
+ * \struct N2K_AnomalyLimit
+ * \brief Physical limits of the value field of one PGN
+ */
+struct N2K_AnomalyLimit {
+    uint32_t pgn;               ///< PGN number
+    uint8_t valueField;         ///< Index of the checked field in the PGN table row
+    uint8_t instanceField;      ///< Index of the instance field, 0xFF if the PGN has none
+    uint8_t kindField;          ///< Index of the field telling apart streams of one instance (fluid type,
+                                ///< temperature source), 0xFF if the PGN has none
+    float maxRate;              ///< Largest plausible change per second (display units)
+    float tolerance;            ///< Largest plausible difference between two sources
+    float wrap;                 ///< Span of a circular value (360 for angles), 0 if linear
+};
+
+/**
+ * \class N2K_AnomalyDetector
+ * \brief Streaming detector stage of the monitor
+ */
+class N2K_AnomalyDetector {
+private:
+    /**
+     * \struct ConflictSlot
+     * \brief Last value one source sent for a (PGN, instance, kind)
+     */
+    struct ConflictSlot {
+        uint32_t pgn;           ///< PGN number, 0 if the slot is free
+        uint32_t micros;        ///< Arrival time (micros)
+        float value;            ///< Value sent
+        uint16_t instance;      ///< Instance in the low byte, kind in the high byte
+        uint8_t source;         ///< Source address that sent it
+    };
+
+    ConflictSlot conflicts[MONITOR_ANOMALY_CONFLICT_SLOTS];    ///< Direct-mapped by (PGN, instance, kind)
+    N2K_Alert alerts[MONITOR_ANOMALY_ALERTS];   ///< Alert ring
+    uint8_t alertHead;                          ///< Slot the next new alert goes into
+    uint8_t alertCount;                         ///< Alerts in the ring
+    uint32_t totals[ANOMALY_TYPE_COUNT];        ///< Detections per type since the last reset
+    uint32_t generation;                        ///< Bumped whenever an alert is added or updated
+
+    uint32_t busWindowStart;                    ///< Start of the bus-wide claim window (millis)
+    uint16_t busWindowClaims;                   ///< Claims in the bus-wide window
+    bool busStormActive;                        ///< Bus-wide claim storm raised for the current window
+
+    /**
+     * \brief Add an alert, or update it if still in the ring
+     *
+     * \param type Anomaly type
+     * \param source Source address
+     * \param other Second source, 0xFF if none
+     * \param pgn PGN number
+     * \param name NAME, 0 if none
+     * \param value Measured value
+     * \param limit Limit it was compared with
+     * \param nowMillis Current time (millis)
+     */
+    void raise(AnomalyType type, uint8_t source, uint8_t other, uint32_t pgn, uint64_t name,
+               float value, float limit, uint32_t nowMillis);
+
+    /**
+     * \brief Raise a stream anomaly on its rising edge, clear it when it ends
+     *
+     * \param guard Stream state
+     * \param type Anomaly type
+     * \param condition Whether the anomaly is present now
+     * \param source Source address
+     * \param pgn PGN number
+     * \param value Measured value
+     * \param limit Limit it was compared with
+     * \param nowMillis Current time (millis)
+     */
+    void latch(N2K_StreamGuard& guard, AnomalyType type, bool condition, uint8_t source, uint32_t pgn,
+               float value, float limit, uint32_t nowMillis);
+
+    /**
+     * \brief Check the value field of a message against the limits of its PGN
+     *
+     * \param guard Stream state
+     * \param limit Limits of the PGN
+     * \param source Source address
+     * \param data Payload
+     * \param dataLen Payload length
+     * \param arrivalMicros Arrival time (micros)
+     * \param nowMillis Current time (millis)
+     */
+    void checkValue(N2K_StreamGuard& guard, const N2K_AnomalyLimit& limit, uint8_t source,
+                    const uint8_t* data, uint8_t dataLen, uint32_t arrivalMicros, uint32_t nowMillis);
+
+public:
+    /**
+     * \brief Construct with no alerts
+     */
+    N2K_AnomalyDetector() { reset(); }
+
+    /**
+     * \brief Clear the alerts, the totals and the conflict table
+     *
+     * Stream guards live in the PGN entries and are reset with them.
+     */
+    void reset();
+
+    /**
+     * \brief Check an address claim
+     *
+     * \param identity Record of the claiming NAME, nullptr if the table was full
+     * \param name Claimed NAME
+     * \param address Claimed address
+     * \param nowMillis Current time (millis)
+     */
+    void recordClaim(N2K_Identity* identity, uint64_t name, uint8_t address, uint32_t nowMillis);
+
+    /**
+     * \brief Check a stored message
+     *
+     * Call after the stream statistics were updated with the message.
+     *
+     * \param guard Detector state of the (source, PGN) entry
+     * \param stats Statistics of the entry
+     * \param source Source address
+     * \param pgn PGN number
+     * \param data Payload
+     * \param dataLen Payload length
+     * \param arrivalMicros Arrival time (micros), as given to the statistics
+     * \param nowMillis Current time (millis)
+     */
+    void recordMessage(N2K_StreamGuard& guard, const N2K_PGNStats& stats, uint8_t source, uint32_t pgn,
+                       const uint8_t* data, uint8_t dataLen, uint32_t arrivalMicros, uint32_t nowMillis);
+
+    /**
+     * \brief Get the number of alerts in the list
+     *
+     * \return Alerts, up to MONITOR_ANOMALY_ALERTS
+     */
+    uint8_t getAlertCount() const { return alertCount; }
+
+    /**
+     * \brief Get an alert by age
+     *
+     * \param age 0 for the newest alert, getAlertCount() - 1 for the oldest
+     * \return Alert, or nullptr if age is out of range
+     */
+    const N2K_Alert* getAlert(int age) const;
+
+    /**
+     * \brief Get the number of detections of one type
+     *
+     * Counts repeats too, so it keeps growing while an alert is merged.
+     *
+     * \param type Anomaly type
+     * \return Detections since the last reset
+     */
+    uint32_t getTotal(AnomalyType type) const { return type < ANOMALY_TYPE_COUNT ? totals[type] : 0; }
+
+    /**
+     * \brief Get the number of detections of all types
+     *
+     * \return Detections since the last reset
+     */
+    uint32_t getTotal() const;
+
+    /**
+     * \brief Get the generation of the alert list
+     *
+     * \return Changes whenever an alert is added or updated
+     */
+    uint32_t getGeneration() const { return generation; }
+
+    /**
+     * \brief Get the short name of an anomaly type
+     *
+     * \param type Anomaly type
+     * \return Name of at most 8 characters
+     */
+    static const char* getTypeName(AnomalyType type);
+
+    /**
+     * \brief Get the limits the value checks use for a PGN
+     *
+     * Binary search in a small table kept in flash.
+     *
+     * \param pgn PGN number
+     * \return Limits, or nullptr if the PGN's values aren't checked
+     */
+    static const N2K_AnomalyLimit* getLimit(uint32_t pgn);
+};
+
+#endif // N2K_ANOMALY_H
@@ -0,0 +1,186 @@
+/**
+ * \file N2K_Expiry.cpp
+ * \brief Timer wheel and stale timeout classes for the N2K_Monitor module
+ *
+ * Contains the expiry wheel and the table assigning PGNs to stale timeout
+ * classes. The incremental cleanup pass itself is in N2K_Monitor.cpp.
+ */
+
+#include "N2K_Monitor.h"
+
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+
+static_assert((MONITOR_EXPIRY_SLOTS & (MONITOR_EXPIRY_SLOTS - 1)) == 0 && MONITOR_EXPIRY_SLOTS <= 255,
+              "MONITOR_EXPIRY_SLOTS must be a power of two below 256");
+static_assert(N2K_EXPIRY_NODES < N2K_EXPIRY_NONE, "Too many timers for 16-bit links");
+
+/* ---------------------------------------------------------------------------
+ * Expiry wheel
+ * ------------------------------------------------------------------------- */
+
+N2K_ExpiryWheel::N2K_ExpiryWheel() {
+    for(int i = 0; i < MONITOR_EXPIRY_SLOTS; i++) {
+        heads[i] = N2K_EXPIRY_NONE;
+    }
+    for(int i = 0; i < N2K_EXPIRY_NODES; i++) {
+        next[i] = N2K_EXPIRY_NONE;
+        prev[i] = N2K_EXPIRY_NONE;
+        due[i] = 0;
+        bucketOf[i] = 0xFF;
+    }
+    wheelTime = 0;
+    scanNext = N2K_EXPIRY_NONE;
+    scanning = false;
+}
+
+void N2K_ExpiryWheel::schedule(uint16_t id, uint32_t dueTime) {
+    if(id >= N2K_EXPIRY_NODES) return;
+    cancel(id);
+
+    // The bucket being processed is the earliest one that will still be visited
+    uint32_t bucketTime = (int32_t)(dueTime - wheelTime) < 0 ? wheelTime : dueTime;
+    uint8_t bucket = bucketFor(bucketTime);
+
+    due[id] = dueTime;
+    bucketOf[id] = bucket;
+    prev[id] = N2K_EXPIRY_NONE;
+    next[id] = heads[bucket];
+    if(heads[bucket] != N2K_EXPIRY_NONE) prev[heads[bucket]] = id;
+    heads[bucket] = id;
+}
+
+void N2K_ExpiryWheel::cancel(uint16_t id) {
+    if(id >= N2K_EXPIRY_NODES || bucketOf[id] == 0xFF) return;
+
+    // Keep an interrupted scan valid when its next timer goes away
+    if(scanning && scanNext == id) scanNext = next[id];
+
+    if(prev[id] != N2K_EXPIRY_NONE) {
+        next[prev[id]] = next[id];
+    } else {
+        heads[bucketOf[id]] = next[id];
+    }
+    if(next[id] != N2K_EXPIRY_NONE) prev[next[id]] = prev[id];
+
+    next[id] = N2K_EXPIRY_NONE;
+    prev[id] = N2K_EXPIRY_NONE;
+    bucketOf[id] = 0xFF;
+}
+
+/**
+ * \brief Take the next expired timer out of the wheel
+ *
+ * Walks the bucket of wheelTime, returning timers that are due and skipping
+ * those due in a later turn. Once the bucket is done and its time span has
+ * passed, wheelTime moves on to the next bucket. A bucket whose span is
+ * still running is rescanned from the start on the next call, since timers
+ * may have been added to it. After a long pause at most one full turn is
+ * walked, which visits every bucket once.
+ *
+ * \param now Current time (millis)
+ * \return Id of an expired timer, or N2K_EXPIRY_NONE if none is due
+ */
+uint16_t N2K_ExpiryWheel::popExpired(uint32_t now) {
+    const uint32_t tick = 1UL << MONITOR_EXPIRY_TICK_SHIFT;
+    const uint32_t turn = tick * MONITOR_EXPIRY_SLOTS;
+
+    if((int32_t)(now - wheelTime) > (int32_t)turn) {
+        wheelTime = (now & ~(tick - 1)) - (turn - tick);
+        scanning = false;
+    }
+
+    while(true) {
+        uint16_t id = scanning ? scanNext : heads[bucketFor(wheelTime)];
+        scanning = true;
+
+        while(id != N2K_EXPIRY_NONE) {
+            uint16_t following = next[id];
+            if((int32_t)(due[id] - now) <= 0) {
+                scanNext = following;
+                cancel(id);
+                return id;
+            }
+            id = following;
+        }
+
+        scanning = false;
+        if((int32_t)(now - wheelTime) < (int32_t)tick) return N2K_EXPIRY_NONE;
+        wheelTime += tick;
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Stale timeout classes
+ * ------------------------------------------------------------------------- */
+
+/**
+ * \struct StaleClassEntry
+ * \brief One row of the stale class table
+ */
+struct StaleClassEntry {
+    uint32_t pgn;           ///< PGN number
+    StaleClass staleClass;  ///< Class the PGN belongs to
+};
+
+/**
+ * \brief PGNs that are not STALE_CLASS_DYNAMIC, sorted by PGN number
+ *
+ * AIS static reports repeat every 6 minutes, aids to navigation every
+ * 3 minutes. Product and configuration information is only sent at start-up
+ * or on request.
+ */
+static constexpr StaleClassEntry STALE_CLASSES[] PROGMEM = {
+    {126996, STALE_CLASS_STATIC},   // Product Information
+    {126998, STALE_CLASS_STATIC},   // Configuration Information
+    {129041, STALE_CLASS_STATIC},   // AIS Aids to Navigation Report
+    {129794, STALE_CLASS_STATIC},   // AIS Class A Static and Voyage Data
+    {129809, STALE_CLASS_STATIC},   // AIS Class B Static Data Part A
+    {129810, STALE_CLASS_STATIC},   // AIS Class B Static Data Part B
+};
+
+StaleClass N2K_Monitor::getStaleClass(uint32_t pgn) {
+    int low = 0;
+    int high = sizeof(STALE_CLASSES) / sizeof(STALE_CLASSES[0]) - 1;
+    while(low <= high) {
+        int mid = (low + high) / 2;
+        if(STALE_CLASSES[mid].pgn == pgn) return STALE_CLASSES[mid].staleClass;
+        if(STALE_CLASSES[mid].pgn < pgn) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return STALE_CLASS_DYNAMIC;
+}
+
+void N2K_Monitor::setStaleTimeout(StaleClass staleClass, uint32_t timeoutMs) {
+    if(staleClass >= STALE_CLASS_COUNT || timeoutMs == 0) return;
+    staleTimeouts[staleClass] = timeoutMs;
+}
+
+uint32_t N2K_Monitor::getStaleTimeout(StaleClass staleClass) const {
+    if(staleClass >= STALE_CLASS_COUNT) return STALE_TIMEOUT_MS;
+    return staleTimeouts[staleClass];
+}
+
+/**
+ * \brief Get the timeout of a device
+ *
+ * A device is kept for at least STALE_CLASS_DYNAMIC time, and for as long
+ * as the slowest class among its PGNs, so a transponder that only sends
+ * static data is not dropped between two reports.
+ *
+ * \param device Device to look at
+ * \return Timeout in milliseconds
+ */
+uint32_t N2K_Monitor::getDeviceTimeout(const DeviceInfo &device) const {
+    uint32_t timeout = staleTimeouts[STALE_CLASS_DYNAMIC];
+    for(uint8_t c = 0; c < STALE_CLASS_COUNT; c++) {
+        if((device.staleClasses & (1 << c)) && staleTimeouts[c] > timeout) {
+            timeout = staleTimeouts[c];
+        }
+    }
+    return timeout;
+}
@@ -0,0 +1,120 @@
+/**
+ * \file N2K_Expiry.h
+ * \brief Incremental stale entry expiry for the N2K_Monitor module
+ *
+ * Stale cleanup used to walk every device and every PGN entry on each pass.
+ * N2K_ExpiryWheel is a hashed timer wheel instead: every device and PGN
+ * entry sits in the bucket of the time it should next be checked, and a
+ * cleanup pass only visits the buckets whose time has come.
+ *
+ * Rescheduling is lazy. Receiving a message only refreshes the entry's
+ * timestamp; when its bucket comes around the monitor compares the real
+ * expiry time and either retires the entry or moves it to a later bucket.
+ * Each entry is therefore touched about once per timeout period, however
+ * often it is received.
+ *
+ * Timeouts are configurable per PGN class, see StaleClass.
+ */
+
+#ifndef N2K_EXPIRY_H
+#define N2K_EXPIRY_H
+
+#include <Arduino.h>
+#include "constants.h"
+
+/**
+ * \brief Number of timers in the wheel: one per device slot, then one per PGN pool entry
+ */
+#define N2K_EXPIRY_NODES (MONITOR_MAX_DEVICES + MONITOR_MAX_PGN_ENTRIES)
+
+/**
+ * \brief Marker for "no timer" in the wheel's links
+ */
+#define N2K_EXPIRY_NONE 0xFFFF
+
+/**
+ * \enum StaleClass
+ * \brief Groups of PGNs that share a stale timeout
+ */
+enum StaleClass : uint8_t {
+    STALE_CLASS_DYNAMIC,    ///< Periodic data sent every few seconds or faster
+    STALE_CLASS_STATIC,     ///< Static or slowly refreshed data, e.g. AIS static reports
+    STALE_CLASS_COUNT       ///< Number of classes, not a valid class
+};
+
+/**
+ * \class N2K_ExpiryWheel
+ * \brief Hashed timer wheel of intrusive, index-linked timers
+ *
+ * Timer ids are small integers chosen by the caller (0 to
+ * N2K_EXPIRY_NODES-1), so the links are fixed arrays and nothing is
+ * allocated. Buckets are MONITOR_EXPIRY_TICK_MS wide. Timers further out
+ * than one turn of the wheel stay in their bucket and are skipped until the
+ * turn they are due in.
+ */
+class N2K_ExpiryWheel {
+private:
+    uint16_t heads[MONITOR_EXPIRY_SLOTS];   ///< First timer of each bucket
+    uint16_t next[N2K_EXPIRY_NODES];        ///< Next timer in the same bucket
+    uint16_t prev[N2K_EXPIRY_NODES];        ///< Previous timer in the same bucket
+    uint32_t due[N2K_EXPIRY_NODES];         ///< Due time of each timer (millis)
+    uint8_t bucketOf[N2K_EXPIRY_NODES];     ///< Bucket holding each timer, 0xFF if not scheduled
+
+    uint32_t wheelTime;                     ///< Start time of the bucket being processed (millis)
+    uint16_t scanNext;                      ///< Next timer to look at in that bucket
+    bool scanning;                          ///< scanNext is valid
+
+    /**
+     * \brief Get the bucket a time falls into
+     *
+     * \param time Time (millis)
+     * \return Bucket index
+     */
+    static uint8_t bucketFor(uint32_t time) {
+        return (time >> MONITOR_EXPIRY_TICK_SHIFT) & (MONITOR_EXPIRY_SLOTS - 1);
+    }
+
+public:
+    /**
+     * \brief Construct an empty wheel
+     */
+    N2K_ExpiryWheel();
+
+    /**
+     * \brief Schedule or reschedule a timer
+     *
+     * Times that have already passed go into the bucket being processed.
+     *
+     * \param id Timer id
+     * \param dueTime Time the timer expires (millis)
+     */
+    void schedule(uint16_t id, uint32_t dueTime);
+
+    /**
+     * \brief Remove a timer, if scheduled
+     *
+     * \param id Timer id
+     */
+    void cancel(uint16_t id);
+
+    /**
+     * \brief Check whether a timer is scheduled
+     *
+     * \param id Timer id
+     * \return true if the timer is in the wheel
+     */
+    bool isScheduled(uint16_t id) const { return bucketOf[id] != 0xFF; }
+
+    /**
+     * \brief Take the next expired timer out of the wheel
+     *
+     * Call repeatedly until it returns N2K_EXPIRY_NONE, or as often as the
+     * caller's time budget allows; the wheel resumes where it stopped.
+     *
+     * \param now Current time (millis)
+     * \return Id of an expired timer, or N2K_EXPIRY_NONE if none is due
+     */
+    uint16_t popExpired(uint32_t now);
+};
+
+#endif // N2K_EXPIRY_H
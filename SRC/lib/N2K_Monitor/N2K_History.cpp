@@ -0,0 +1,206 @@
+/**
+ * \file N2K_History.cpp
+ * \brief Implementation of the watched field history
+ *
+ * Contains the bucket ring with its incremental window statistics and the
+ * watch slots fed from the monitor's message path.
+ */
+
+#include "N2K_History.h"
+
+static_assert(MONITOR_HISTORY_BUCKETS > 1 && MONITOR_HISTORY_BUCKETS <= 65535,
+              "MONITOR_HISTORY_BUCKETS must fit the 16-bit ring indices");
+
+/* ---------------------------------------------------------------------------
+ * N2K_FieldHistory
+ * ------------------------------------------------------------------------- */
+
+void N2K_FieldHistory::clear(uint32_t nowMillis) {
+    head = 0;
+    filled = 1;
+    headEpoch = nowMillis / MONITOR_HISTORY_BUCKET_MS;
+    buckets[0].count = 0;
+    buckets[0].sum = 0;
+
+    windowSum = 0;
+    windowCount = 0;
+    windowMin = 0;
+    windowMax = 0;
+    extremesStale = false;
+
+    lastValue = 0;
+    sampleCount = 0;
+    generation++;
+}
+
+void N2K_FieldHistory::add(float value, uint32_t nowMillis) {
+    advance(nowMillis);
+
+    N2K_HistoryBucket& bucket = buckets[head];
+    if(bucket.count == 0) {
+        bucket.min = value;
+        bucket.max = value;
+    } else {
+        if(value < bucket.min) bucket.min = value;
+        if(value > bucket.max) bucket.max = value;
+    }
+    bucket.sum += value;
+    bucket.count++;
+
+    if(windowCount == 0) {
+        windowMin = value;
+        windowMax = value;
+    } else {
+        if(value < windowMin) windowMin = value;
+        if(value > windowMax) windowMax = value;
+    }
+    windowSum += value;
+    windowCount++;
+
+    lastValue = value;
+    sampleCount++;
+    generation++;
+}
+
+/**
+ * \brief Move the ring on to the bucket of nowMillis
+ *
+ * A full ring drops its oldest bucket for every new one. The dropped
+ * samples leave the window sum and count right away; if the bucket held
+ * the window minimum or maximum, the extremes are recomputed from the
+ * buckets the next time they are asked for.
+ *
+ * \param nowMillis Current time (millis)
+ */
+void N2K_FieldHistory::advance(uint32_t nowMillis) {
+    uint32_t epoch = nowMillis / MONITOR_HISTORY_BUCKET_MS;
+    int32_t steps = (int32_t)(epoch - headEpoch);
+    if(steps <= 0) return;
+    headEpoch = epoch;
+    if(steps > MONITOR_HISTORY_BUCKETS) steps = MONITOR_HISTORY_BUCKETS;
+
+    for(int32_t i = 0; i < steps; i++) {
+        head = (head + 1) % MONITOR_HISTORY_BUCKETS;
+        N2K_HistoryBucket& bucket = buckets[head];
+
+        if(filled < MONITOR_HISTORY_BUCKETS) {
+            filled++;
+        } else if(bucket.count > 0) {
+            windowSum -= bucket.sum;
+            windowCount -= bucket.count;
+            if(bucket.min <= windowMin || bucket.max >= windowMax) extremesStale = true;
+        }
+        bucket.count = 0;
+        bucket.sum = 0;
+    }
+    if(windowCount == 0) windowSum = 0;     // Don't let rounding drift build up
+    generation++;
+}
+
+void N2K_FieldHistory::refreshExtremes() {
+    extremesStale = false;
+    bool first = true;
+    for(uint16_t age = 0; age < filled; age++) {
+        const N2K_HistoryBucket& bucket = getBucket(age);
+        if(bucket.count == 0) continue;
+        if(first || bucket.min < windowMin) windowMin = bucket.min;
+        if(first || bucket.max > windowMax) windowMax = bucket.max;
+        first = false;
+    }
+}
+
+float N2K_FieldHistory::getWindowMin() {
+    if(windowCount == 0) return 0;
+    if(extremesStale) refreshExtremes();
+    return windowMin;
+}
+
+float N2K_FieldHistory::getWindowMax() {
+    if(windowCount == 0) return 0;
+    if(extremesStale) refreshExtremes();
+    return windowMax;
+}
+
+/* ---------------------------------------------------------------------------
+ * N2K_History
+ * ------------------------------------------------------------------------- */
+
+int N2K_History::find(uint8_t source, uint32_t pgn, const PGNFieldDef* field) const {
+    for(int i = 0; i < MONITOR_HISTORY_FIELDS; i++) {
+        const N2K_FieldHistory& trace = traces[i];
+        if(trace.field == field && trace.source == source && trace.pgn == pgn) return i;
+    }
+    return -1;
+}
+
+int N2K_History::watch(uint8_t source, uint32_t pgn, const PGNFieldDef* field, uint32_t nowMillis) {
+    if(field == nullptr || field->enumNames != nullptr) return -1;
+
+    int index = find(source, pgn, field);
+    if(index >= 0) return index;
+
+    for(int i = 0; i < MONITOR_HISTORY_FIELDS; i++) {
+        N2K_FieldHistory& trace = traces[i];
+        if(trace.field != nullptr) continue;
+
+        trace.source = source;
+        trace.pgn = pgn;
+        trace.field = field;
+        trace.clear(nowMillis);
+        activeCount++;
+        return i;
+    }
+    return -1;
+}
+
+void N2K_History::unwatch(int index) {
+    if(get(index) == nullptr) return;
+    traces[index].field = nullptr;
+    activeCount--;
+}
+
+void N2K_History::record(uint8_t source, uint32_t pgn, const uint8_t* data, uint8_t dataLen,
+                         uint32_t nowMillis) {
+    if(activeCount == 0) return;
+
+    for(int i = 0; i < MONITOR_HISTORY_FIELDS; i++) {
+        N2K_FieldHistory& trace = traces[i];
+        if(trace.field == nullptr || trace.source != source || trace.pgn != pgn) continue;
+
+        // N/A and error values are not samples
+        int32_t raw;
+        if(!decodePGNField(*trace.field, data, dataLen, raw)) continue;
+        trace.add((float)getPGNFieldValue(*trace.field, raw), nowMillis);
+    }
+}
+
+void N2K_History::moveSource(uint8_t from, uint8_t to) {
+    for(int i = 0; i < MONITOR_HISTORY_FIELDS; i++) {
+        if(traces[i].field != nullptr && traces[i].source == from) traces[i].source = to;
+    }
+}
+
+void N2K_History::advance(uint32_t nowMillis) {
+    if(activeCount == 0) return;
+
+    for(int i = 0; i < MONITOR_HISTORY_FIELDS; i++) {
+        if(traces[i].field != nullptr) traces[i].advance(nowMillis);
+    }
+}
+
+N2K_FieldHistory* N2K_History::get(int index) {
+    if(index < 0 || index >= MONITOR_HISTORY_FIELDS || traces[index].field == nullptr) return nullptr;
+    return &traces[index];
+}
+
+int N2K_History::next(int index, int step) const {
+    if(activeCount == 0) return -1;
+    if(index < 0) index = (step > 0) ? -1 : 0;
+
+    for(int n = 1; n <= MONITOR_HISTORY_FIELDS; n++) {
+        int candidate = ((index + n * step) % MONITOR_HISTORY_FIELDS + MONITOR_HISTORY_FIELDS) %
+                        MONITOR_HISTORY_FIELDS;
+        if(traces[candidate].field != nullptr) return candidate;
+    }
+    return -1;
+}
@@ -0,0 +1,246 @@
+/**
+ * \file N2K_History.h
+ * \brief Value history of watched PGN fields for the N2K_Monitor module
+ *
+ * PGN entries only hold the latest message, so there is no way to tell
+ * whether a depth or RPM reading is trending or oscillating. A few fields
+ * can be watched instead. Every message of a watched (source, PGN) has the
+ * field decoded straight from the raw payload, and the value lands in the
+ * field's current time bucket.
+ *
+ * Each bucket covers MONITOR_HISTORY_BUCKET_MS and keeps only the min, max,
+ * sum and count of its samples. Buckets form a ring of
+ * MONITOR_HISTORY_BUCKETS, the oldest one is overwritten, so memory stays
+ * fixed however long it runs. The min, max and mean over the whole window
+ * are kept up to date as buckets are added and dropped, so drawing the
+ * graph never rescans the samples.
+ *
+ * Only numeric fields of the PGN table (PGN_Helpers) can be watched; PGNs
+ * decoded by the parser switch have no field layout to decode from.
+ */
+
+#ifndef N2K_HISTORY_H
+#define N2K_HISTORY_H
+
+#include <Arduino.h>
+#include <PGN_Helpers.h>
+#include "constants.h"
+
+/**
+ * \struct N2K_HistoryBucket
+ * \brief Samples of one field over one MONITOR_HISTORY_BUCKET_MS
+ */
+struct N2K_HistoryBucket {
+    float min;          ///< Smallest sample
+    float max;          ///< Largest sample
+    float sum;          ///< Sum of the samples
+    uint32_t count;     ///< Number of samples, 0 for a bucket without data
+};
+
+// The 32-bit count fills the padding a 16-bit one left, so it never saturates for free
+static_assert(sizeof(N2K_HistoryBucket) == 16, "N2K_HistoryBucket grew past its 16 bytes");
+
+/**
+ * \class N2K_FieldHistory
+ * \brief Bucket ring and window statistics of one watched field
+ */
+class N2K_FieldHistory {
+private:
+    N2K_HistoryBucket buckets[MONITOR_HISTORY_BUCKETS];    ///< Bucket ring
+    uint16_t head;              ///< Index of the newest bucket
+    uint16_t filled;            ///< Buckets in use, up to MONITOR_HISTORY_BUCKETS
+    uint32_t headEpoch;         ///< Bucket number (millis / MONITOR_HISTORY_BUCKET_MS) of head
+
+    double windowSum;           ///< Sum of all samples in the ring
+    uint32_t windowCount;       ///< Number of samples in the ring
+    float windowMin;            ///< Smallest sample in the ring
+    float windowMax;            ///< Largest sample in the ring
+    bool extremesStale;         ///< A dropped bucket held windowMin or windowMax
+
+    /**
+     * \brief Recompute windowMin and windowMax from the buckets
+     */
+    void refreshExtremes();
+
+public:
+    uint8_t source;             ///< Source address of the watched entry
+    uint32_t pgn;               ///< PGN of the watched entry
+    const PGNFieldDef* field;   ///< Field decoded from the payload, nullptr if the slot is free
+    float lastValue;            ///< Latest sample
+    uint32_t sampleCount;       ///< Samples recorded since watching started
+    uint32_t generation;        ///< Changes on every sample and every new bucket
+
+    /**
+     * \brief Construct a free slot
+     */
+    N2K_FieldHistory() : field(nullptr) { clear(0); }
+
+    /**
+     * \brief Drop all samples and start a new ring at nowMillis
+     *
+     * \param nowMillis Current time (millis)
+     */
+    void clear(uint32_t nowMillis);
+
+    /**
+     * \brief Record a sample
+     *
+     * \param value Field value in display units
+     * \param nowMillis Time of the sample (millis)
+     */
+    void add(float value, uint32_t nowMillis);
+
+    /**
+     * \brief Move the ring on to the bucket of nowMillis
+     *
+     * Buckets in between stay empty, so a silent sender shows as a gap.
+     *
+     * \param nowMillis Current time (millis)
+     */
+    void advance(uint32_t nowMillis);
+
+    /**
+     * \brief Get the number of buckets in use
+     *
+     * \return Buckets, newest included
+     */
+    uint16_t getBucketCount() const { return filled; }
+
+    /**
+     * \brief Get a bucket by age
+     *
+     * \param age 0 for the newest bucket, getBucketCount() - 1 for the oldest
+     * \return Bucket
+     */
+    const N2K_HistoryBucket& getBucket(uint16_t age) const {
+        return buckets[(head + MONITOR_HISTORY_BUCKETS - age) % MONITOR_HISTORY_BUCKETS];
+    }
+
+    /**
+     * \brief Get the number of samples in the window
+     *
+     * \return Samples in all buckets
+     */
+    uint32_t getWindowCount() const { return windowCount; }
+
+    /**
+     * \brief Get the smallest sample in the window
+     *
+     * \return Minimum, 0 if the window is empty
+     */
+    float getWindowMin();
+
+    /**
+     * \brief Get the largest sample in the window
+     *
+     * \return Maximum, 0 if the window is empty
+     */
+    float getWindowMax();
+
+    /**
+     * \brief Get the mean of the samples in the window
+     *
+     * \return Mean, 0 if the window is empty
+     */
+    float getWindowMean() const { return windowCount > 0 ? (float)(windowSum / windowCount) : 0; }
+};
+
+/**
+ * \class N2K_History
+ * \brief The watched fields of the monitor
+ *
+ * record() is called for every stored message and returns right away while
+ * nothing is watched.
+ */
+class N2K_History {
+private:
+    N2K_FieldHistory traces[MONITOR_HISTORY_FIELDS];   ///< Watch slots
+    uint8_t activeCount;                                ///< Slots in use
+
+public:
+    /**
+     * \brief Construct with no field watched
+     */
+    N2K_History() : activeCount(0) {}
+
+    /**
+     * \brief Find the slot of a watched field
+     *
+     * \param source Source address
+     * \param pgn PGN number
+     * \param field Field of the PGN table
+     * \return Slot index, or -1 if the field isn't watched
+     */
+    int find(uint8_t source, uint32_t pgn, const PGNFieldDef* field) const;
+
+    /**
+     * \brief Start recording a field
+     *
+     * \param source Source address
+     * \param pgn PGN number
+     * \param field Field of the PGN table; enumerations can't be watched
+     * \param nowMillis Current time (millis)
+     * \return Slot index, the existing one if already watched, or -1 if all
+     *         MONITOR_HISTORY_FIELDS slots are taken
+     */
+    int watch(uint8_t source, uint32_t pgn, const PGNFieldDef* field, uint32_t nowMillis);
+
+    /**
+     * \brief Stop recording a field and free its slot
+     *
+     * \param index Slot index
+     */
+    void unwatch(int index);
+
+    /**
+     * \brief Record the watched fields of a stored message
+     *
+     * \param source Source address of the message
+     * \param pgn PGN of the message
+     * \param data Payload
+     * \param dataLen Payload length
+     * \param nowMillis Arrival time (millis)
+     */
+    void record(uint8_t source, uint32_t pgn, const uint8_t* data, uint8_t dataLen, uint32_t nowMillis);
+
+    /**
+     * \brief Follow a device to a new source address
+     *
+     * \param from Previous source address
+     * \param to New source address
+     */
+    void moveSource(uint8_t from, uint8_t to);
+
+    /**
+     * \brief Move every watched field on to the bucket of nowMillis
+     *
+     * \param nowMillis Current time (millis)
+     */
+    void advance(uint32_t nowMillis);
+
+    /**
+     * \brief Get a watch slot
+     *
+     * \param index Slot index
+     * \return Slot, or nullptr if index is out of range or the slot is free
+     */
+    N2K_FieldHistory* get(int index);
+
+    /**
+     * \brief Get the next watched slot after a given one
+     *
+     * \param index Slot to start after, -1 to start at the first slot
+     * \param step 1 to search forwards, -1 backwards, wrapping around
+     * \return Slot index, or -1 if nothing is watched
+     */
+    int next(int index, int step) const;
+
+    /**
+     * \brief Get the number of watched fields
+     *
+     * \return Slots in use
+     */
+    uint8_t getActiveCount() const { return activeCount; }
+};
+
+#endif // N2K_HISTORY_H
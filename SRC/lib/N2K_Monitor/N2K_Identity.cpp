@@ -0,0 +1,119 @@
+/**
+ * \file N2K_Identity.cpp
+ * \brief Implementation of the NAME-keyed device identities
+ */
+
+#include "N2K_Identity.h"
+
+static_assert((MONITOR_IDENTITY_SLOTS & (MONITOR_IDENTITY_SLOTS - 1)) == 0 &&
+              MONITOR_IDENTITY_SLOTS <= 255,
+              "MONITOR_IDENTITY_SLOTS must be a power of two below 256");
+static_assert(MONITOR_MAX_IDENTITIES < MONITOR_IDENTITY_SLOTS,
+              "Identity table needs at least one free slot");
+
+/// Marker for an address no identity holds
+static constexpr uint8_t NO_SLOT = 0xFF;
+
+/**
+ * \brief Hash a NAME into the identity table
+ *
+ * The unique number sits in the low bits, but devices of one manufacturer
+ * often differ in only a few of them, so both halves are folded and spread
+ * with Fibonacci hashing.
+ *
+ * \param name NAME to hash
+ * \return Slot index in the range 0 to MONITOR_IDENTITY_SLOTS-1
+ */
+static inline uint16_t hashName(uint64_t name) {
+    uint32_t folded = (uint32_t)name ^ (uint32_t)(name >> 32);
+    return (uint16_t)((folded * 2654435761UL) >> 16) & (MONITOR_IDENTITY_SLOTS - 1);
+}
+
+void N2K_IdentityTable::clear() {
+    for(int i = 0; i < MONITOR_IDENTITY_SLOTS; i++) {
+        slots[i].inUse = false;
+    }
+    memset(byAddress, NO_SLOT, sizeof(byAddress));
+    count = 0;
+    untracked = 0;
+}
+
+uint16_t N2K_IdentityTable::probe(uint64_t name) const {
+    uint16_t slot = hashName(name);
+    while(slots[slot].inUse && slots[slot].name != name) {
+        slot = (slot + 1) & (MONITOR_IDENTITY_SLOTS - 1);
+    }
+    return slot;
+}
+
+N2K_Identity* N2K_IdentityTable::claim(uint64_t name, uint8_t address, uint32_t nowMillis) {
+    if(address >= MONITOR_MAX_DEVICES) return nullptr;
+
+    uint16_t slot = probe(name);
+    N2K_Identity& identity = slots[slot];
+    if(!identity.inUse) {
+        if(count >= MONITOR_MAX_IDENTITIES) {
+            untracked++;
+            return nullptr;
+        }
+        identity.inUse = true;
+        identity.name = name;
+        identity.deviceName[0] = '\0';
+        identity.firstClaim = nowMillis;
+        identity.claims = 0;
+        identity.addressChanges = 0;
+        identity.claimWindowStart = nowMillis;
+        identity.claimWindowCount = 0;
+        identity.address = N2K_NO_ADDRESS;
+        count++;
+    }
+
+    // A device announces its claim again on request, which isn't a move
+    if(identity.address != address) {
+        if(identity.address != N2K_NO_ADDRESS) {
+            byAddress[identity.address] = NO_SLOT;
+            identity.addressChanges++;
+        }
+
+        // Whoever held the address before has lost it
+        uint8_t previousOwner = byAddress[address];
+        if(previousOwner != NO_SLOT) {
+            slots[previousOwner].address = N2K_NO_ADDRESS;
+        }
+
+        byAddress[address] = slot;
+        identity.address = address;
+    }
+
+    identity.lastClaim = nowMillis;
+    if(identity.claims < 0xFFFF) identity.claims++;
+    return &identity;
+}
+
+void N2K_IdentityTable::release(uint8_t address) {
+    if(address >= MONITOR_MAX_DEVICES || byAddress[address] == NO_SLOT) return;
+    slots[byAddress[address]].address = N2K_NO_ADDRESS;
+    byAddress[address] = NO_SLOT;
+}
+
+N2K_Identity* N2K_IdentityTable::find(uint64_t name) {
+    uint16_t slot = probe(name);
+    return slots[slot].inUse ? &slots[slot] : nullptr;
+}
+
+N2K_Identity* N2K_IdentityTable::findByAddress(uint8_t address) {
+    if(address >= MONITOR_MAX_DEVICES || byAddress[address] == NO_SLOT) return nullptr;
+    return &slots[byAddress[address]];
+}
+
+void N2K_IdentityTable::setDeviceName(uint8_t address, const char* deviceName) {
+    N2K_Identity* identity = findByAddress(address);
+    if(identity != nullptr) {
+        snprintf(identity->deviceName, sizeof(identity->deviceName), "%s", deviceName);
+    }
+}
+
+const N2K_Identity* N2K_IdentityTable::get(int slot) const {
+    if(slot < 0 || slot >= MONITOR_IDENTITY_SLOTS || !slots[slot].inUse) return nullptr;
+    return &slots[slot];
+}
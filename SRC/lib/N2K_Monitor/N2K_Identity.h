@@ -0,0 +1,174 @@
+/**
+ * \file N2K_Identity.h
+ * \brief NAME-keyed device identities for the N2K_Monitor module
+ *
+ * A source address only belongs to a device until the next address claim.
+ * Devices move after a bus reset, when two claim the same address, or
+ * whenever the address claim experiments are running. What stays the same
+ * is the 64-bit ISO NAME sent in PGN 60928, so N2K_IdentityTable keeps one
+ * record per NAME and an index from address to record:
+ * - Looking up a NAME is a probe of an open-addressed table of
+ *   MONITOR_IDENTITY_SLOTS slots.
+ * - Looking up the NAME behind an address is one array read.
+ * - A claim rebinds both in constant time. A NAME that held the claimed
+ *   address before loses it.
+ *
+ * Records keep the last display name known for the device, so it comes back
+ * even after the device's slot in the monitor was dropped. Records are only
+ * removed by clear(); once MONITOR_MAX_IDENTITIES are known, new NAMEs are
+ * counted but not stored.
+ */
+
+#ifndef N2K_IDENTITY_H
+#define N2K_IDENTITY_H
+
+#include <Arduino.h>
+#include "constants.h"
+
+/**
+ * \def N2K_DEVICE_NAME_SIZE
+ * \brief Buffer size of a device name; a Model ID has up to 32 characters
+ */
+#define N2K_DEVICE_NAME_SIZE 33
+
+/**
+ * \def N2K_NO_ADDRESS
+ * \brief Address of an identity that currently holds none
+ */
+#define N2K_NO_ADDRESS 0xFF
+
+/**
+ * \struct N2K_Identity
+ * \brief Everything known about one NAME
+ */
+struct N2K_Identity {
+    uint64_t name;                      ///< 64-bit ISO NAME from the address claim
+    char deviceName[N2K_DEVICE_NAME_SIZE];  ///< Last display name of the device, "" if none yet
+    uint32_t firstClaim;                ///< Time of the first claim (millis)
+    uint32_t lastClaim;                 ///< Time of the latest claim (millis)
+    uint16_t claims;                    ///< Claims received
+    uint16_t addressChanges;            ///< Claims of a different address than the one held
+    uint32_t claimWindowStart;          ///< Start of the claim rate window of N2K_AnomalyDetector (millis)
+    uint16_t claimWindowCount;          ///< Claims in that window
+    uint8_t address;                    ///< Address currently held, N2K_NO_ADDRESS if none
+    bool inUse;                         ///< true if the slot holds a NAME
+};
+
+/**
+ * \class N2K_IdentityTable
+ * \brief NAME to identity table with an address index
+ */
+class N2K_IdentityTable {
+private:
+    N2K_Identity slots[MONITOR_IDENTITY_SLOTS];     ///< Open-addressed by NAME
+    uint8_t byAddress[MONITOR_MAX_DEVICES];         ///< Slot of the identity holding each address, 0xFF if none
+    uint16_t count;                                 ///< Slots in use
+    uint32_t untracked;                             ///< Claims of NAMEs that found the table full
+
+    /**
+     * \brief Find the slot of a NAME, or the free slot it would go into
+     *
+     * \param name NAME to look up
+     * \return Slot index
+     */
+    uint16_t probe(uint64_t name) const;
+
+public:
+    /**
+     * \brief Construct an empty table
+     */
+    N2K_IdentityTable() { clear(); }
+
+    /**
+     * \brief Forget every identity
+     */
+    void clear();
+
+    /**
+     * \brief Record an address claim
+     *
+     * Binds the address to the NAME, creating its record if needed. The
+     * NAME's previous address and the address's previous NAME are unbound.
+     *
+     * \param name Claimed NAME
+     * \param address Claimed address (0-252)
+     * \param nowMillis Current time (millis)
+     * \return Record of the NAME, or nullptr if it is new and the table is full
+     */
+    N2K_Identity* claim(uint64_t name, uint8_t address, uint32_t nowMillis);
+
+    /**
+     * \brief Unbind an address, e.g. when its device goes stale
+     *
+     * The record is kept, with no address.
+     *
+     * \param address Address to release
+     */
+    void release(uint8_t address);
+
+    /**
+     * \brief Look up a NAME
+     *
+     * \param name NAME to look up
+     * \return Record, or nullptr if the NAME never claimed an address
+     */
+    N2K_Identity* find(uint64_t name);
+
+    /**
+     * \brief Look up the identity holding an address
+     *
+     * \param address Source address
+     * \return Record, or nullptr if no known NAME holds the address
+     */
+    N2K_Identity* findByAddress(uint8_t address);
+
+    /**
+     * \brief Remember the display name of the device at an address
+     *
+     * Does nothing if no known NAME holds the address.
+     *
+     * \param address Source address
+     * \param deviceName Name to store
+     */
+    void setDeviceName(uint8_t address, const char* deviceName);
+
+    /**
+     * \brief Get a record by slot, for listing the table
+     *
+     * \param slot Slot index (0 to MONITOR_IDENTITY_SLOTS-1)
+     * \return Record, or nullptr if the slot is unused
+     */
+    const N2K_Identity* get(int slot) const;
+
+    /**
+     * \brief Get the number of known NAMEs
+     *
+     * \return Records in use
+     */
+    uint16_t getCount() const { return count; }
+
+    /**
+     * \brief Get the number of claims whose NAME couldn't be stored
+     *
+     * \return Claims
+     */
+    uint32_t getUntracked() const { return untracked; }
+
+    /**
+     * \brief Get the manufacturer code of a NAME
+     *
+     * \param name NAME
+     * \return Manufacturer code (bits 21-31)
+     */
+    static uint16_t getManufacturerCode(uint64_t name) { return (name >> 21) & 0x7FF; }
+
+    /**
+     * \brief Get the device function of a NAME
+     *
+     * \param name NAME
+     * \return Device function (bits 40-47)
+     */
+    static uint8_t getDeviceFunction(uint64_t name) { return (name >> 40) & 0xFF; }
+};
+
+#endif // N2K_IDENTITY_H
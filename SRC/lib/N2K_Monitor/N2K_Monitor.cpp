@@ -5,58 +5,152 @@
  * This file contains the core implementation of the N2K_Monitor class, which
  * provides comprehensive monitoring capabilities for NMEA2000 networks. The
  * implementation handles device discovery, message processing, PGN data storage,
- * and automatic cleanup of stale network entries.
+ * on-demand field decoding, and automatic cleanup of stale network entries.
  *
  * The module is split into multiple files for maintainability:
  *   - N2K_Monitor.cpp (this file) - Constructor and core functions
+ *   - N2K_Storage.cpp - Fixed-capacity device/PGN tables and payload pool
+ *   - N2K_Stats.cpp - Per-PGN and bus-wide traffic statistics
+ *   - N2K_Expiry.cpp - Stale expiry timer wheel and timeout classes
+ *   - N2K_Identity.cpp - NAME-keyed device identities
  *   - N2K_PGNNames.cpp - PGN name lookup tables and functions
  *   - N2K_PGNParser.cpp - Comprehensive PGN parsing implementations
  */
 
 #include "N2K_Monitor.h"
+#include <Zone_Profiler.h>
 
 /**
  * \brief Construct a new N2K_Monitor instance
  *
  * Initializes the monitor with default settings:
  * - Stale entry cleanup is disabled by default
- * - Last cleanup check timestamp is set to 0
+ * - Stale timeouts of the PGN classes come from constants.h
+ * - All device slots are marked unused with empty PGN tables
+ * - Every PGN pool entry is pushed onto the free stack
  *
- * The devices map and device list are automatically initialized
- * as empty by their default constructors.
+ * The ordered device list reserves room for every possible address so
+ * it never reallocates while devices are discovered.
  *
  * \note Call setStaleCleanupEnabled(true) after construction if you
  *       want automatic cleanup of devices that leave the network.
  */
 N2K_Monitor::N2K_Monitor() {
     staleCleanupEnabled = false;
-    lastCleanupCheck = 0;
+    droppedPGNCount = 0;
+    movedDeviceCount = 0;
+    listGeneration = 0;
+    watchSource = 0;
+    watchPGN = 0;
+    watchCallback = nullptr;
+    staleTimeouts[STALE_CLASS_DYNAMIC] = STALE_TIMEOUT_MS;
+    staleTimeouts[STALE_CLASS_STATIC] = STALE_TIMEOUT_STATIC_MS;
+
+    for(int addr = 0; addr < MONITOR_MAX_DEVICES; addr++) {
+        DeviceInfo& device = devices[addr];
+        device.sourceAddress = addr;
+        device.lastSeen = 0;
+        device.lastHeartbeat = 0;
+        device.inUse = false;
+        device.pgnCount = 0;
+        device.staleClasses = 0;
+        device.generation = 0;
+        for(int i = 0; i < MONITOR_PGN_SLOTS_PER_DEVICE; i++) {
+            device.pgnSlots[i] = N2K_EMPTY_SLOT;
+        }
+    }
+
+    for(int i = 0; i < MONITOR_MAX_PGN_ENTRIES; i++) {
+        pgnPool[i].rawData = nullptr;
+        pgnPool[i].rawCapacity = 0;
+        pgnPool[i].dataLen = 0;
+        pgnPool[i].dirty = false;
+        pgnPool[i].fields.clear();
+        // Push in reverse so entry 0 is handed out first
+        freePGNEntries[i] = MONITOR_MAX_PGN_ENTRIES - 1 - i;
+    }
+    freePGNCount = MONITOR_MAX_PGN_ENTRIES;
+    decodedIndex = -1;
+
+    deviceList.reserve(MONITOR_MAX_DEVICES);
 }
 
 /**
  * \brief Perform periodic maintenance tasks
  *
- * This method should be called regularly from the main loop to perform
- * periodic maintenance. Currently implements:
- * - Stale entry cleanup (every 5 seconds when enabled)
- *
- * The 5-second interval prevents excessive CPU usage while still
- * maintaining reasonable responsiveness for device removal.
+ * Publishes the bus statistics window, so the rates drop to zero when no
+ * frames arrive, times out transfers whose sender went quiet and moves the
+ * watched field history on, so a silent field shows up as a gap. Stale
+ * entry cleanup runs as its own, slower scheduler task through
+ * cleanupStaleEntries().
  */
 void N2K_Monitor::update() {
-    // Periodically check for stale entries (every 5 seconds)
-    unsigned long currentTime = millis();
-    if(currentTime - lastCleanupCheck > 5000) {
-        lastCleanupCheck = currentTime;
-        cleanupStaleEntries();
+    busStats.update(millis());
+
+    TransferEvent event;
+    uint32_t now = micros();
+    while(transfers.expire(now, event)) {
+        recordTransfer(event);
+    }
+
+    history.advance(millis());
+}
+
+void N2K_Monitor::handleFrame(uint32_t id, uint8_t len, const uint8_t* data, uint32_t timestamp) {
+    busStats.addFrame(id, len, data, timestamp);
+
+    TransferEvent event;
+    if(transfers.addFrame(id, len, data, timestamp, event)) {
+        recordTransfer(event);
+    }
+}
+
+void N2K_Monitor::recordTransfer(const TransferEvent& event) {
+    PGNData* pgnData = getPGNData(event.source, event.pgn);
+    if(pgnData != nullptr) pgnData->transfers.record(event);
+}
+
+/**
+ * \brief Clear all traffic statistics
+ *
+ * Resets the bus-wide counters and peak load, the transfer totals, the
+ * alerts, and the rate and transfer statistics of every tracked PGN.
+ * Devices and their PGN data are kept.
+ */
+void N2K_Monitor::resetStatistics() {
+    busStats.reset();
+    transfers.resetStats();
+    for(uint8_t address : deviceList) {
+        DeviceInfo& device = devices[address];
+        for(int i = 0; i < device.pgnCount; i++) {
+            pgnPool[device.pgnOrder[i]].stats.reset();
+            pgnPool[device.pgnOrder[i]].transfers.reset();
+        }
+    }
+    resetAlerts();
+}
+
+/**
+ * \brief Clear the alert list and the anomaly state of every PGN entry
+ *
+ * The stream guards are reset too, so an anomaly latched before the reset
+ * is raised again instead of staying hidden until it ends.
+ */
+void N2K_Monitor::resetAlerts() {
+    anomalies.reset();
+    for(uint8_t address : deviceList) {
+        DeviceInfo& device = devices[address];
+        for(int i = 0; i < device.pgnCount; i++) {
+            pgnPool[device.pgnOrder[i]].guard.reset();
+        }
     }
 }
 
 /**
  * \brief Retrieve a device by its source address
  *
- * Looks up a device in the internal map by its NMEA2000 source address.
- * This provides direct access to the device's information including
+ * Looks up a device slot directly by its NMEA2000 source address.
+ * This provides O(1) access to the device's information including
  * name, timing data, and all received PGNs.
  *
  * \param address The NMEA2000 source address (0-252) to look up
@@ -65,8 +159,8 @@ void N2K_Monitor::update() {
  *         nullptr if no device with that address has been seen
  */
 DeviceInfo* N2K_Monitor::getDevice(uint8_t address) {
-    // Check if the device exists in the map
-    if(devices.find(address) != devices.end()) {
+    // Check if the slot holds a discovered device
+    if(address < MONITOR_MAX_DEVICES && devices[address].inUse) {
         return &devices[address];
     }
     return nullptr;
@@ -76,8 +170,8 @@ DeviceInfo* N2K_Monitor::getDevice(uint8_t address) {
  * \brief Retrieve PGN data for a specific device and PGN number
  *
  * Looks up stored PGN data for a given device and PGN combination.
- * This allows access to parsed field data without iterating through
- * the device's entire PGN map.
+ * The device slot is indexed directly and the PGN is found through the
+ * device's hash table, so the lookup is O(1) and never allocates.
  *
  * \param deviceAddress The NMEA2000 source address of the device
  * \param pgn The PGN number to retrieve data for
@@ -87,13 +181,41 @@ DeviceInfo* N2K_Monitor::getDevice(uint8_t address) {
  */
 PGNData* N2K_Monitor::getPGNData(uint8_t deviceAddress, uint32_t pgn) {
     // First check if the device exists
-    if(devices.find(deviceAddress) != devices.end()) {
-        // Then check if the PGN exists for this device
-        if(devices[deviceAddress].pgns.find(pgn) != devices[deviceAddress].pgns.end()) {
-            return &devices[deviceAddress].pgns[pgn];
-        }
-    }
-    return nullptr;
+    DeviceInfo* device = getDevice(deviceAddress);
+    if(device == nullptr) return nullptr;
+
+    // Then check if the PGN exists for this device
+    return findPGNEntry(*device, pgn);
+}
+
+/**
+ * \brief Get the number of PGNs tracked for a device
+ *
+ * \param deviceAddress The NMEA2000 source address of the device
+ *
+ * \return Number of PGNs received from the device, 0 if unknown
+ */
+int N2K_Monitor::getPGNCount(uint8_t deviceAddress) {
+    DeviceInfo* device = getDevice(deviceAddress);
+    return (device != nullptr) ? device->pgnCount : 0;
+}
+
+/**
+ * \brief Retrieve a device's PGN data by list position
+ *
+ * PGNs are kept sorted by PGN number, matching the order the device PGN
+ * screen has always displayed them in.
+ *
+ * \param deviceAddress The NMEA2000 source address of the device
+ * \param index Position in the device's PGN list
+ *
+ * \return Pointer to the PGNData structure, nullptr if the device is
+ *         unknown or the index is out of range
+ */
+PGNData* N2K_Monitor::getPGNDataAt(uint8_t deviceAddress, int index) {
+    DeviceInfo* device = getDevice(deviceAddress);
+    if(device == nullptr || index < 0 || index >= device->pgnCount) return nullptr;
+    return &pgnPool[device->pgnOrder[index]];
 }
 
 /**
@@ -104,41 +226,66 @@ PGNData* N2K_Monitor::getPGNData(uint8_t deviceAddress, uint32_t pgn) {
  * received message.
  *
  * \param N2kMsg Reference to the received NMEA2000 message from the library
+ * \param arrivalMicros Capture timestamp of the message's last frame, 0 if unknown
  */
-void N2K_Monitor::handleN2kMessage(const tN2kMsg &N2kMsg) {
+void N2K_Monitor::handleN2kMessage(const tN2kMsg &N2kMsg, uint32_t arrivalMicros) {
+    PROFILE_ZONE(PROFILE_N2K_MESSAGE);
     uint8_t source = N2kMsg.Source;
+    busStats.addMessage();
+
+    // Only real source addresses get a device slot (254 = null, 255 = global)
+    if(source >= MONITOR_MAX_DEVICES) return;
+
+    // ISO Address Claim (PGN 60928) carries the 64-bit NAME, transmitted in
+    // little-endian byte order
+    uint64_t isoName = 0;
+    if(N2kMsg.PGN == 60928 && N2kMsg.DataLen >= 8) {
+        for(int i = 0; i < 8; i++) {
+            isoName |= ((uint64_t)N2kMsg.Data[i]) << (i * 8);
+        }
+        handleAddressClaim(source, isoName);
+    }
+
+    DeviceInfo& device = devices[source];
 
     
     // Device Discovery and Creation
     
-    // Check if this is a new device (source address not in our map)
-    if(devices.find(source) == devices.end()) {
-        // Create a new device entry with default values
-        DeviceInfo newDevice;
-        newDevice.sourceAddress = source;
-        newDevice.name = "Device " + String(source);  // Default name until we get more info
-        newDevice.lastSeen = millis();
-        newDevice.lastHeartbeat = 0;  // No heartbeat received yet
-        devices[source] = newDevice;
-
-        // Rebuild the ordered device list for consistent UI display
-        deviceList.clear();
-        for(auto& pair : devices) {
-            deviceList.push_back(pair.first);
+    // Check if this is a new device (slot not in use yet)
+    if(!device.inUse) {
+        // Initialize the slot with default values
+        device.inUse = true;
+        device.sourceAddress = source;
+        const N2K_Identity* identity = identities.findByAddress(source);
+        if(identity != nullptr && identity->deviceName[0] != '\0') {
+            // Seen before under this NAME, e.g. before it went stale
+            snprintf(device.name, sizeof(device.name), "%s", identity->deviceName);
+        } else {
+            snprintf(device.name, sizeof(device.name), "Device %u", source);  // Default name until we get more info
         }
+        device.lastSeen = millis();
+        device.lastHeartbeat = 0;  // No heartbeat received yet
+        device.pgnCount = 0;
+        device.staleClasses = 0;
+
+        // Insert into the ordered device list, keeping it sorted by address
+        deviceList.insert(std::lower_bound(deviceList.begin(), deviceList.end(), source), source);
 
+        // Raised to a longer timeout when the device sends a static PGN
+        expiry.schedule(source, device.lastSeen + getDeviceTimeout(device));
+        deviceChanged(device);
     }
 
     
     // Timing Updates
     
     // Always update the lastSeen timestamp for this device
-    devices[source].lastSeen = millis();
+    device.lastSeen = millis();
 
     // Track heartbeat messages separately for stale detection
     // PGN 126993 is the NMEA2000 Heartbeat message
     if(N2kMsg.PGN == 126993) {
-        devices[source].lastHeartbeat = millis();
+        device.lastHeartbeat = millis();
     }
 
     
@@ -149,30 +296,26 @@ void N2K_Monitor::handleN2kMessage(const tN2kMsg &N2kMsg) {
     if(N2kMsg.PGN == 60928 && N2kMsg.DataLen >= 8) {
         // Only use Address Claim info if we don't have a Model ID yet
         // (Product Information provides better names when available)
-        if(devices[source].name.startsWith("Device ")) {
-            // Parse the 8-byte NAME field from ISO Address Claim
-            // The NAME is transmitted in little-endian byte order
-            uint64_t name = 0;
-            for(int i = 0; i < 8; i++) {
-                name |= ((uint64_t)N2kMsg.Data[i]) << (i * 8);
-            }
-
-            // Extract manufacturer code (bits 21-31, 11 bits)
-            uint16_t mfrCode = (name >> 21) & 0x7FF;
-
-            // Extract device function (bits 40-47, 8 bits)
-            uint8_t devFunction = (name >> 40) & 0xFF;
-
-            // Build a descriptive name using the manufacturer code
-            String devName = "Mfr" + String(mfrCode);
+        const N2K_Identity* identity = identities.findByAddress(source);
+        if(strncmp(device.name, "Device ", 7) == 0 && identity != nullptr && identity->deviceName[0] != '\0') {
+            // The NAME was seen before, possibly with its Model ID
+            snprintf(device.name, sizeof(device.name), "%s", identity->deviceName);
+            deviceChanged(device);
+        } else if(strncmp(device.name, "Device ", 7) == 0) {
+            uint16_t mfrCode = N2K_IdentityTable::getManufacturerCode(isoName);
+            uint8_t devFunction = N2K_IdentityTable::getDeviceFunction(isoName);
 
             // Add a function hint based on the device function code ranges
             // These ranges are approximate groupings of related functions
-            if(devFunction >= 130 && devFunction <= 140) devName += " Nav";       // Navigation devices
-            else if(devFunction >= 140 && devFunction <= 160) devName += " Eng";  // Engine/propulsion
-            else if(devFunction >= 170 && devFunction <= 180) devName += " Pwr";  // Power management
+            const char* hint = "";
+            if(devFunction >= 130 && devFunction <= 140) hint = " Nav";       // Navigation devices
+            else if(devFunction >= 140 && devFunction <= 160) hint = " Eng";  // Engine/propulsion
+            else if(devFunction >= 170 && devFunction <= 180) hint = " Pwr";  // Power management
 
-            devices[source].name = devName;
+            // Build a descriptive name using the manufacturer code
+            snprintf(device.name, sizeof(device.name), "Mfr%u%s", mfrCode, hint);
+            identities.setDeviceName(source, device.name);
+            deviceChanged(device);
         }
     }
 
@@ -191,21 +334,107 @@ void N2K_Monitor::handleN2kMessage(const tN2kMsg &N2kMsg) {
                              sizeof(ModelVersion), ModelVersion,
                              sizeof(ModelSerialCode), ModelSerialCode,
                              CertificationLevel, LoadEquivalency)) {
-            // Only update if we got a non-empty Model ID
-            if(strlen(ModelID) > 0) {
-                devices[source].name = String(ModelID);
-                devices[source].name.trim();  // Remove any padding whitespace
+            // Remove any padding whitespace
+            char* modelName = ModelID;
+            while(isspace((unsigned char)*modelName)) modelName++;
+            size_t len = strlen(modelName);
+            while(len > 0 && isspace((unsigned char)modelName[len - 1])) modelName[--len] = '\0';
+
+            // Only update if we got a non-empty Model ID; it is sent again on
+            // every request, so only a new name is a change
+            if(len > 0 && strcmp(modelName, device.name) != 0) {
+                snprintf(device.name, sizeof(device.name), "%s", modelName);
+                identities.setDeviceName(source, device.name);
+                deviceChanged(device);
             }
         }
     }
 
     
-    // PGN Data Storage and Parsing
+    // PGN Data Storage
     
-    // Parse the message into human-readable fields and store
-    PGNData pgnData;
-    parsePGNData(N2kMsg, pgnData);  // Implemented in N2K_PGNParser.cpp
-    devices[source].pgns[N2kMsg.PGN] = pgnData;
+    // Only store the raw bytes here; decoding into fields is deferred until
+    // a consumer asks for them through getDecodedPGNData()
+    PGNData* pgnData = findPGNEntry(device, N2kMsg.PGN);
+    if(pgnData == nullptr) {
+        pgnData = addPGNEntry(device, N2kMsg.PGN);  // Implemented in N2K_Storage.cpp
+        if(pgnData == nullptr) return;  // Storage full, counted in droppedPGNCount
+    }
+
+    // Without a timestamp from the capture path, the message is taken to
+    // arrive right after its last frame was handed to handleFrame()
+    uint32_t arrival = arrivalMicros != 0 ? arrivalMicros : busStats.getLastFrameMicros();
+    if(arrival == 0) arrival = micros();
+    pgnData->stats.record(arrival, N2kMsg.DataLen);
+
+    pgnData->lastUpdate = millis();
+    pgnData->priority = N2kMsg.Priority;
+    pgnData->destination = N2kMsg.Destination;
+    storePayload(*pgnData, N2kMsg.Data, N2kMsg.DataLen);
+    history.record(source, N2kMsg.PGN, N2kMsg.Data, N2kMsg.DataLen, pgnData->lastUpdate);
+    anomalies.recordMessage(pgnData->guard, pgnData->stats, source, N2kMsg.PGN, N2kMsg.Data, N2kMsg.DataLen,
+                            arrival, pgnData->lastUpdate);
+    pgnData->dirty = true;
+    pgnData->sequence++;
+    notifyWatch(source, N2kMsg.PGN);
+}
+
+/**
+ * \brief Retrieve PGN data with decoded fields for a device and PGN number
+ *
+ * Looks up the PGN entry like getPGNData() and, if a message has arrived
+ * since the fields were last decoded or another entry was decoded since,
+ * re-parses the stored raw data first. Consecutive calls for the same
+ * entry without new traffic return the cached fields.
+ *
+ * \param deviceAddress The NMEA2000 source address of the device
+ * \param pgn The PGN number to retrieve data for
+ *
+ * \return Pointer to the decoded PGNData structure if found, nullptr if
+ *         either the device doesn't exist or hasn't sent that PGN
+ */
+PGNData* N2K_Monitor::getDecodedPGNData(uint8_t deviceAddress, uint32_t pgn) {
+    PGNData* pgnData = getPGNData(deviceAddress, pgn);
+    if(pgnData != nullptr) {
+        decodePGNData(deviceAddress, *pgnData);
+    }
+    return pgnData;
+}
+
+/**
+ * \brief Decode a PGN entry's raw data into fields if it is dirty
+ *
+ * Reconstructs the original tN2kMsg from the stored raw bytes and header
+ * values so the library Parse functions can be used, then hands it to
+ * parsePGNData() (implemented in N2K_PGNParser.cpp).
+ *
+ * The fields go into decodedFields, which the entry then holds until
+ * another entry is decoded; that one's list is emptied and it decodes
+ * again the next time it is asked for.
+ *
+ * \param source Source address the PGN entry was received from
+ * \param pgnData Reference to the PGNData entry to decode
+ */
+void N2K_Monitor::decodePGNData(uint8_t source, PGNData &pgnData) {
+    int16_t index = &pgnData - pgnPool;
+    if(index == decodedIndex && !pgnData.dirty) return;
+
+    if(decodedIndex >= 0 && decodedIndex != index) {
+        pgnPool[decodedIndex].fields.clear();
+        pgnPool[decodedIndex].dirty = true;
+    }
+    decodedIndex = index;
+    pgnData.fields.items = decodedFields;
+    pgnData.fields.count = 0;
+
+    tN2kMsg N2kMsg;
+    N2kMsg.Init(pgnData.priority, pgnData.pgn, source, pgnData.destination);
+    N2kMsg.DataLen = min((int)pgnData.dataLen, (int)tN2kMsg::MaxDataLen);
+    memcpy(N2kMsg.Data, pgnData.rawData, N2kMsg.DataLen);
+    N2kMsg.MsgTime = pgnData.lastUpdate;
+
+    parsePGNData(N2kMsg, pgnData);
+    pgnData.dirty = false;
 
     
     // Legacy API Support
@@ -213,12 +442,11 @@ void N2K_Monitor::handleN2kMessage(const tN2kMsg &N2kMsg) {
     // Also call legacy handler for backward compatibility with older code
     // that uses the simple PGN tracking system
     if(pgnData.fields.size() > 0) {
-        double value = 0;
         // Extract the primary value (first field) for legacy tracking
-        if(pgnData.fields.size() > 0) {
-            value = pgnData.fields[0].value.toFloat();
-        }
-        registerPGN(N2kMsg.PGN, pgnData.name, value);
+        double value = atof(pgnData.fields[0].value);
+        char name[N2K_PGN_NAME_SIZE];
+        formatPGNName(pgnData.pgn, name, sizeof(name));
+        registerPGN(pgnData.pgn, name, value);
     }
 }
 
@@ -236,7 +464,7 @@ void N2K_Monitor::handleN2kMessage(const tN2kMsg &N2kMsg) {
  * \param name Human-readable name for the PGN
  * \param value The primary numeric value from the PGN message
  */
-void N2K_Monitor::registerPGN(uint32_t pgn, String name, double value) {
+void N2K_Monitor::registerPGN(uint32_t pgn, const char* name, double value) {
     // Search for existing PGN entry
     for(auto& pgnInfo : detectedPGNs) {
         if(pgnInfo.pgn == pgn) {
@@ -251,32 +479,51 @@ void N2K_Monitor::registerPGN(uint32_t pgn, String name, double value) {
     // Not found - create and add new entry
     PGNInfo info;
     info.pgn = pgn;
-    info.name = name;
+    snprintf(info.name, sizeof(info.name), "%s", name);
     info.value = value;
     info.received = true;
     info.lastUpdate = millis();
     detectedPGNs.push_back(info);
 }
 
+/**
+ * \brief Get the legacy detected PGNs vector
+ *
+ * The legacy tracking system is fed from decoded fields, so every PGN entry
+ * that has received new raw data since its last decode is decoded here
+ * before the vector is returned. Only the legacy PGN screens pay this cost.
+ *
+ * \return Reference to the std::vector<PGNInfo> of registered PGNs
+ */
+std::vector<PGNInfo>& N2K_Monitor::getDetectedPGNs() {
+    for(uint8_t addr : deviceList) {
+        DeviceInfo& device = devices[addr];
+        for(int i = 0; i < device.pgnCount; i++) {
+            decodePGNData(addr, pgnPool[device.pgnOrder[i]]);
+        }
+    }
+    return detectedPGNs;
+}
+
 /**
  * \brief Remove stale devices and PGN entries from the monitor
  *
- * Iterates through all tracked devices and removes those that have not
- * been active within the STALE_TIMEOUT_MS period (defined in constants.h).
- * Also removes individual PGN entries from active devices if those specific
- * PGNs have not been received within the timeout period.
+ * Takes expired timers from the expiry wheel instead of scanning every
+ * device and PGN. Timers are not moved when a message arrives, so an
+ * expired timer only means the entry is due for a check: if it was seen
+ * again within its timeout it is rescheduled from the latest activity,
+ * otherwise it is removed.
  *
  * Activity determination:
  * - For devices that send heartbeats (PGN 126993), lastHeartbeat is used
  * - For devices without heartbeats, lastSeen is used as fallback
  *
  * Protected PGNs:
- * - ISO Address Claim (PGN 60928) is never removed independently; it is
- *   only removed when the entire device is removed
+ * - ISO Address Claim (PGN 60928) never gets a timer; it is only removed
+ *   when the entire device is removed
  *
- * This method performs a two-pass removal:
- * 1. First pass: Identify stale entries (can't modify while iterating)
- * 2. Second pass: Remove the identified entries
+ * At most MONITOR_EXPIRY_MAX_PER_PASS entries are handled per call; the
+ * rest are picked up by the next call.
  */
 void N2K_Monitor::cleanupStaleEntries() {
     // Early exit if cleanup is disabled
@@ -284,63 +531,38 @@ void N2K_Monitor::cleanupStaleEntries() {
 
     unsigned long currentTime = millis();
 
-    
-    // Pass 1: Identify stale devices
-    
-    std::vector<uint8_t> devicesToRemove;
-
-    for(auto& devicePair : devices) {
-        uint8_t addr = devicePair.first;
-        DeviceInfo& device = devicePair.second;
-
-        // Determine the most recent activity timestamp
-        // Prefer heartbeat if available (more reliable for active devices)
-        // Fall back to lastSeen for devices that don't send heartbeats
-        unsigned long lastActivity = (device.lastHeartbeat > 0) ? device.lastHeartbeat : device.lastSeen;
-
-        // Check if device has exceeded the stale timeout
-        if(currentTime - lastActivity > STALE_TIMEOUT_MS) {
-            devicesToRemove.push_back(addr);
-            continue;  // Skip PGN cleanup for devices being removed entirely
-        }
-
-        // =====================================================================
-        // Check for stale PGNs within this active device
-        // =====================================================================
-        std::vector<uint32_t> pgnsToRemove;
-
-        for(auto& pgnPair : device.pgns) {
-            uint32_t pgn = pgnPair.first;
-            PGNData& pgnData = pgnPair.second;
-
-            // ISO Address Claim is special - only remove with the device
-            // This ensures we maintain device identity information
-            if(pgn == 60928) continue;
-
-            // Check if this PGN has exceeded the stale timeout
-            if(currentTime - pgnData.lastUpdate > STALE_TIMEOUT_MS) {
-                pgnsToRemove.push_back(pgn);
+    for(int n = 0; n < MONITOR_EXPIRY_MAX_PER_PASS; n++) {
+        uint16_t id = expiry.popExpired(currentTime);
+        if(id == N2K_EXPIRY_NONE) break;
+
+        if(id < MONITOR_MAX_DEVICES) {
+            DeviceInfo& device = devices[id];
+            if(!device.inUse) continue;
+
+            // Prefer heartbeat if available (more reliable for active devices)
+            unsigned long lastActivity = (device.lastHeartbeat > 0) ? device.lastHeartbeat : device.lastSeen;
+            uint32_t timeout = getDeviceTimeout(device);
+            if(currentTime - lastActivity > timeout) {
+                removeDevice(id);  // Also releases its PGN entries and their timers
+            } else {
+                expiry.schedule(id, lastActivity + timeout + 1);
             }
+            continue;
         }
 
-        // Remove stale PGNs from this device
-        for(uint32_t pgn : pgnsToRemove) {
-            device.pgns.erase(pgn);
+        uint16_t index = id - MONITOR_MAX_DEVICES;
+        PGNData& pgnData = pgnPool[index];
+        DeviceInfo& device = devices[pgnData.source];
+        uint32_t timeout = staleTimeouts[pgnData.staleClass];
+        if(currentTime - pgnData.lastUpdate <= timeout) {
+            expiry.schedule(id, pgnData.lastUpdate + timeout + 1);
+            continue;
         }
-    }
 
-    
-    // Pass 2: Remove stale devices
-    
-    for(uint8_t addr : devicesToRemove) {
-        // Remove from the main devices map
-        devices.erase(addr);
-
-        // Also remove from the ordered deviceList for consistent UI
-        for(auto it = deviceList.begin(); it != deviceList.end(); ++it) {
-            if(*it == addr) {
-                deviceList.erase(it);
-                break;  // Each address appears only once
+        for(int i = 0; i < device.pgnCount; i++) {
+            if(device.pgnOrder[i] == index) {
+                removePGNEntry(device, i);
+                break;
             }
         }
     }
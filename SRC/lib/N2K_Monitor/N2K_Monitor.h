@@ -8,8 +8,13 @@
  *
  * The N2K_Monitor class is designed to work with the NMEA2000 library and provides:
  * - Automatic device discovery and tracking by source address
+ * - Device identities keyed by ISO NAME that follow a device to a new address
  * - PGN message recording with parsed field data
- * - Stale entry cleanup for devices that leave the network
+ * - Fixed-capacity, allocation-free device and PGN storage
+ * - Incremental stale entry expiry with per-PGN-class timeouts
+ * - Fast-packet and ISO transport reassembly diagnostics from the raw frames
+ * - Streaming detection of claim storms, conflicting sources and timing or
+ *   value anomalies (N2K_AnomalyDetector)
  * - Legacy compatibility functions for simple PGN tracking
  *
  */
@@ -21,8 +26,49 @@
 #include <N2kMessages.h>
 #include <NMEA2000.h>
 #include <vector>
-#include <map>
+#include <algorithm>
 #include "constants.h"
+#include "N2K_Storage.h"
+#include "N2K_Stats.h"
+#include "N2K_Expiry.h"
+#include "N2K_Transfers.h"
+#include "N2K_History.h"
+#include "N2K_Identity.h"
+#include "N2K_Anomaly.h"
+
+/**
+ * \brief Marker for an unused slot in a device's PGN lookup table
+ */
+#define N2K_EMPTY_SLOT 0xFFFF
+
+/**
+ * \def N2K_PGN_NAME_SIZE
+ * \brief Buffer size that holds any PGN display name, including the terminator
+ */
+#define N2K_PGN_NAME_SIZE 16
+
+/**
+ * \def N2K_FIELD_VALUE_SIZE
+ * \brief Buffer size of a decoded field value, fits 8 hex bytes
+ */
+#define N2K_FIELD_VALUE_SIZE 24
+
+/**
+ * \def N2K_MAX_DECODED_FIELDS
+ * \brief Most fields one decode produces
+ *
+ * Table PGNs have at most MAX_PGN_FIELDS (12), the decoders written out in
+ * N2K_PGNParser.cpp at most 7.
+ */
+#define N2K_MAX_DECODED_FIELDS 12
+
+/**
+ * \brief Called when the watched (source, PGN) entry changes
+ *
+ * \param source Source address of the entry
+ * \param pgn PGN number of the entry
+ */
+typedef void (*N2K_WatchCallback)(uint8_t source, uint32_t pgn);
 
 /**
  * \struct PGNField
@@ -32,12 +78,43 @@
  * the parsed representation of a single field, including its name,
  * human-readable value, and unit of measurement.
  *
+ * Names and units always point at string literals or the PGN table, and
+ * the value is formatted in place, so decoding never touches the heap.
+ *
  * \note Field parsing is PGN-specific and handled by parsePGNData()
  */
 struct PGNField {
-    String name;    ///< Field name (e.g., "Speed Over Ground", "Heading")
-    String value;   ///< Parsed value as human-readable string
-    String unit;    ///< Unit of measurement (e.g., "kn", "deg", "m")
+    const char* name;                   ///< Field name (e.g., "Speed Over Ground", "Heading"), "" for none
+    char value[N2K_FIELD_VALUE_SIZE];   ///< Parsed value as human-readable string
+    const char* unit;                   ///< Unit of measurement (e.g., "kn", "deg", "m"), "" for none
+};
+
+/**
+ * \struct PGNFieldList
+ * \brief Decoded fields of a PGN entry
+ *
+ * A view of the monitor's single decode buffer. Only one entry is shown at
+ * a time, so only the entry decoded last holds fields; decoding another
+ * one empties this list (see N2K_Monitor::getDecodedPGNData()). Has the
+ * parts of std::vector the screens use.
+ */
+struct PGNFieldList {
+    PGNField* items;    ///< First field, nullptr if none
+    uint8_t count;      ///< Number of fields
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    PGNField& operator[](int index) const { return items[index]; }
+    PGNField* begin() const { return items; }
+    PGNField* end() const { return items + count; }
+
+    /**
+     * \brief Drop the fields and the link to the decode buffer
+     */
+    void clear() {
+        items = nullptr;
+        count = 0;
+    }
 };
 
 /**
@@ -45,19 +122,35 @@ struct PGNField {
  * \brief Contains all data associated with a specific PGN from a device
  *
  * This structure stores both the raw message data and parsed field information
- * for a PGN received from a specific device. The raw data is retained to allow
- * re-parsing if needed.
+ * for a PGN received from a specific device. Only the raw data is refreshed
+ * when a message arrives; the fields are decoded lazily from rawData the next
+ * time someone asks for them (see N2K_Monitor::getDecodedPGNData()).
+ *
+ * Entries are owned by the monitor's fixed PGN pool and are reused when a
+ * PGN goes stale, so pointers to them are only valid until the next
+ * cleanupStaleEntries() call.
  *
- * \note The rawData buffer is sized at 256 bytes which exceeds the maximum
- *       NMEA2000 fast-packet size of 223 bytes.
+ * Entries time out after the timeout of their StaleClass.
+ *
+ * \note rawData points to a block from the monitor's payload pool sized to
+ *       the message length (up to the 223 byte fast-packet maximum).
  */
 struct PGNData {
     uint32_t pgn;                   ///< PGN number (Parameter Group Number)
-    String name;                    ///< Human-readable name of the PGN
     unsigned long lastUpdate;       ///< Timestamp (millis) of last message received
-    std::vector<PGNField> fields;   ///< Parsed fields for display
-    uint8_t rawData[256];           ///< Raw message data buffer for re-parsing
+    PGNFieldList fields;            ///< Parsed fields for display (valid only when !dirty)
+    uint8_t* rawData;               ///< Raw message data for re-parsing (payload pool block)
+    uint8_t rawCapacity;            ///< Size of the rawData block in bytes
     uint8_t dataLen;                ///< Length of valid data in rawData buffer
+    uint8_t priority;               ///< Priority of the last message received
+    uint8_t destination;            ///< Destination address of the last message received
+    N2K_PGNStats stats;             ///< Rate and timing statistics of this PGN from this device
+    N2K_TransferStats transfers;    ///< Multi-frame transfer outcomes of this PGN from this device
+    N2K_StreamGuard guard;          ///< Anomaly detector state of this PGN from this device
+    uint8_t source;                 ///< Source address of the device owning the entry
+    uint32_t sequence;              ///< Messages stored since the entry was created
+    StaleClass staleClass;          ///< Stale timeout class of the PGN
+    bool dirty;                     ///< true if rawData changed since fields were last decoded
 };
 
 /**
@@ -66,17 +159,33 @@ struct PGNData {
  *
  * This structure maintains all information known about a device on the network,
  * including its source address, name (if available), timing information, and
- * a map of all PGNs received from this device.
+ * the PGNs received from this device.
+ *
+ * Devices are stored by their source address which may change during
+ * address claiming. When a known NAME claims a new address, the monitor
+ * moves the whole entry there (see N2K_IdentityTable). The lastSeen
+ * timestamp is used for stale entry cleanup.
  *
- * Devices are identified by their source address which may change during
- * address claiming. The lastSeen timestamp is used for stale entry cleanup.
+ * Screens showing a device compare its generation with the one they last
+ * drew instead of polling sizes; see N2K_Monitor::getDeviceGeneration().
+ *
+ * PGNs are referenced by index into the monitor's PGN pool. pgnSlots is an
+ * open-addressed (linear probing) table used for O(1) lookup by PGN number,
+ * and pgnOrder lists the same entries sorted by PGN number for display.
+ * Use N2K_Monitor::getPGNData() and getPGNDataAt() rather than the index
+ * arrays directly.
  */
 struct DeviceInfo {
     uint8_t sourceAddress;              ///< NMEA2000 source address (0-252)
-    String name;                        ///< Device name from ISO Address Claim (if available)
+    char name[N2K_DEVICE_NAME_SIZE];    ///< Device name from Product Information or Address Claim
     unsigned long lastSeen;             ///< Timestamp (millis) of last message from device
     unsigned long lastHeartbeat;        ///< Timestamp of last heartbeat PGN (0 if never received)
-    std::map<uint32_t, PGNData> pgns;   ///< Map of PGN numbers to their data
+    bool inUse;                         ///< true if this slot holds a discovered device
+    uint8_t pgnCount;                   ///< Number of PGNs tracked for this device
+    uint8_t staleClasses;               ///< Bit per StaleClass among the PGNs seen, sets the device timeout
+    uint32_t generation;                ///< Bumped when the name or the PGN list changes, or the device goes
+    uint16_t pgnSlots[MONITOR_PGN_SLOTS_PER_DEVICE];  ///< PGN lookup table of pool indices
+    uint16_t pgnOrder[MONITOR_MAX_PGNS_PER_DEVICE];   ///< Pool indices sorted by PGN number
 };
 
 /**
@@ -89,7 +198,7 @@ struct DeviceInfo {
  */
 struct PGNInfo {
     uint32_t pgn;               ///< PGN number
-    String name;                ///< Human-readable PGN name
+    char name[N2K_PGN_NAME_SIZE];   ///< Human-readable PGN name
     double value;               ///< Simple numeric value (first field only)
     bool received;              ///< Flag indicating if PGN has been received
     unsigned long lastUpdate;   ///< Timestamp of last update
@@ -106,6 +215,7 @@ struct PGNInfo {
  * Key features:
  * - Automatic device discovery by source address
  * - PGN message storage with parsed field data
+ * - O(1) device and PGN lookup with no heap allocation in steady state
  * - Configurable stale entry cleanup
  * - Thread-safe device and PGN access
  * - Legacy API for backward compatibility
@@ -113,35 +223,151 @@ struct PGNInfo {
 class N2K_Monitor {
 private:
     /**
-     * \brief Map of all discovered devices keyed by source address
+     * \brief Device slots indexed directly by source address
      *
-     * Devices are automatically added when messages are received from
-     * new source addresses. Entries may be removed by stale cleanup.
+     * Devices are automatically marked in use when messages are received
+     * from new source addresses. Entries may be released by stale cleanup.
      */
-    std::map<uint8_t, DeviceInfo> devices;
+    DeviceInfo devices[MONITOR_MAX_DEVICES];
 
     /**
-     * \brief Ordered list of device addresses for sequential access
+     * \brief Pool of PGN entries shared by all devices
      *
-     * Maintains the order in which devices were discovered, useful for
-     * consistent display ordering in user interfaces.
+     * Devices reference entries by index through DeviceInfo::pgnSlots
+     * and DeviceInfo::pgnOrder.
      */
-    std::vector<uint8_t> deviceList;
+    PGNData pgnPool[MONITOR_MAX_PGN_ENTRIES];
 
     /**
-     * \brief Flag to enable/disable automatic stale entry cleanup
+     * \brief Stack of free indices into pgnPool
+     */
+    uint16_t freePGNEntries[MONITOR_MAX_PGN_ENTRIES];
+
+    /**
+     * \brief Number of valid entries in freePGNEntries
+     */
+    uint16_t freePGNCount;
+
+    /**
+     * \brief Fields of the entry decoded last
      *
-     * When enabled, devices that haven't been seen within STALE_TIMEOUT_MS
-     * (defined in constants.h) will be automatically removed.
+     * One buffer for the whole pool instead of one per entry: only the
+     * entry on screen is decoded, so the pool needs no field storage.
      */
-    bool staleCleanupEnabled;
+    PGNField decodedFields[N2K_MAX_DECODED_FIELDS];
+
+    /**
+     * \brief pgnPool index of the entry decodedFields belongs to, -1 if none
+     */
+    int16_t decodedIndex;
+
+    /**
+     * \brief Size-class allocator for the raw payload bytes of PGN entries
+     */
+    N2K_PayloadPool payloadPool;
+
+    /**
+     * \brief Frame rate and utilization of the monitored bus
+     */
+    N2K_BusStats busStats;
+
+    /**
+     * \brief Fast-packet and ISO transport sessions followed on the monitored bus
+     */
+    N2K_TransferTracker transfers;
+
+    /**
+     * \brief Value history of the watched PGN fields
+     */
+    N2K_History history;
 
     /**
-     * \brief Timestamp of last stale cleanup check
+     * \brief Device identities by ISO NAME
+     */
+    N2K_IdentityTable identities;
+
+    /**
+     * \brief Anomaly detector run on every stored message and address claim
+     */
+    N2K_AnomalyDetector anomalies;
+
+    /**
+     * \brief Number of devices moved to a new address by an address claim
+     */
+    uint32_t movedDeviceCount;
+
+    /**
+     * \brief Credit a finished transfer to its PGN entry
      *
-     * Used to throttle cleanup operations to avoid performance impact.
+     * \param event Transfer that ended
+     */
+    void recordTransfer(const TransferEvent& event);
+
+    /**
+     * \brief Expiry timers of the devices (ids 0-252) and PGN entries (253 + pool index)
      */
-    unsigned long lastCleanupCheck;
+    N2K_ExpiryWheel expiry;
+
+    /**
+     * \brief Stale timeout of each StaleClass (in milliseconds)
+     */
+    uint32_t staleTimeouts[STALE_CLASS_COUNT];
+
+    /**
+     * \brief Bumped whenever something shown in the device list changes
+     *
+     * That is a device appearing or going, or a device's name or PGN count
+     * changing.
+     */
+    uint32_t listGeneration;
+
+    uint8_t watchSource;                ///< Source address of the watched entry
+    uint32_t watchPGN;                  ///< PGN of the watched entry
+    N2K_WatchCallback watchCallback;    ///< Called on changes of the watched entry, or nullptr
+
+    /**
+     * \brief Note a change of a device's name or PGN list
+     *
+     * \param device Device that changed
+     */
+    void deviceChanged(DeviceInfo &device) {
+        device.generation++;
+        listGeneration++;
+    }
+
+    /**
+     * \brief Call the watch callback if the entry is watched
+     *
+     * \param source Source address of the changed entry
+     * \param pgn PGN number of the changed entry
+     */
+    void notifyWatch(uint8_t source, uint32_t pgn) {
+        if(watchCallback != nullptr && source == watchSource && pgn == watchPGN) {
+            watchCallback(source, pgn);
+        }
+    }
+
+    /**
+     * \brief Number of PGNs that could not be stored because a table was full
+     */
+    uint32_t droppedPGNCount;
+
+    /**
+     * \brief Ordered list of device addresses for sequential access
+     *
+     * Kept sorted by source address for consistent display ordering in
+     * user interfaces. Capacity is reserved up front so inserting a new
+     * device never reallocates.
+     */
+    std::vector<uint8_t> deviceList;
+
+    /**
+     * \brief Flag to enable/disable automatic stale entry cleanup
+     *
+     * When enabled, devices and PGN entries that haven't been seen within
+     * the timeout of their StaleClass will be automatically removed.
+     */
+    bool staleCleanupEnabled;
 
     /**
      * \brief Legacy PGN tracking vector
@@ -164,6 +390,103 @@ private:
      */
     void parsePGNData(const tN2kMsg &N2kMsg, PGNData &pgnData);
 
+    /**
+     * \brief Decode the stored raw data of a PGN entry if it is dirty
+     *
+     * Rebuilds a tN2kMsg from rawData and runs parsePGNData() on it into
+     * the shared decode buffer, then clears the dirty flag so repeated
+     * reads reuse the cached fields. The entry that held the buffer before
+     * loses its fields and is marked dirty.
+     *
+     * \param source Source address the PGN entry belongs to
+     * \param pgnData Reference to the PGNData entry to decode
+     */
+    void decodePGNData(uint8_t source, PGNData &pgnData);
+
+    /**
+     * \brief Look up a PGN entry in a device's lookup table
+     *
+     * \param device Device to search
+     * \param pgn PGN number to find
+     * \return Pointer to the PGNData entry, or nullptr if not tracked
+     */
+    PGNData* findPGNEntry(DeviceInfo &device, uint32_t pgn);
+
+    /**
+     * \brief Take a PGN entry from the pool and attach it to a device
+     *
+     * \param device Device the PGN was received from
+     * \param pgn PGN number of the new entry
+     * \return Pointer to the new PGNData entry, or nullptr if the device
+     *         or the pool is full
+     */
+    PGNData* addPGNEntry(DeviceInfo &device, uint32_t pgn);
+
+    /**
+     * \brief Detach a PGN entry from a device and return it to the pool
+     *
+     * \param device Device owning the entry
+     * \param orderIndex Position of the entry in DeviceInfo::pgnOrder
+     */
+    void removePGNEntry(DeviceInfo &device, int orderIndex);
+
+    /**
+     * \brief Rebuild a device's PGN lookup table from its pgnOrder list
+     *
+     * Used after removals, since linear probing can't simply clear a slot.
+     *
+     * \param device Device whose table should be rebuilt
+     */
+    void rebuildPGNSlots(DeviceInfo &device);
+
+    /**
+     * \brief Release a device slot and all of its PGN entries
+     *
+     * \param address Source address of the device to remove
+     */
+    void removeDevice(uint8_t address);
+
+    /**
+     * \brief Record an address claim and follow the device if it moved
+     *
+     * Called before the claim is stored, so a device that moved finds its
+     * old entry at the new address.
+     *
+     * \param address Claimed address
+     * \param name NAME from the claim
+     */
+    void handleAddressClaim(uint8_t address, uint64_t name);
+
+    /**
+     * \brief Move a device entry with its PGN entries to another address
+     *
+     * Whatever was stored at the new address is removed first.
+     *
+     * \param from Current address of the entry
+     * \param to New address
+     */
+    void moveDevice(uint8_t from, uint8_t to);
+
+    /**
+     * \brief Copy a message payload into a PGN entry's payload block
+     *
+     * Moves the entry to a larger block when the payload grows. If no
+     * larger block is available the payload is truncated to the current one.
+     *
+     * \param pgnData Entry to store the payload in
+     * \param data Payload bytes
+     * \param len Number of payload bytes
+     */
+    void storePayload(PGNData &pgnData, const unsigned char *data, int len);
+
+    /**
+     * \brief Get the timeout of a device
+     *
+     * \param device Device to look at
+     * \return Longest timeout among the device's stale classes (in milliseconds)
+     */
+    uint32_t getDeviceTimeout(const DeviceInfo &device) const;
+
 public:
     /**
      * \brief Construct a new N2K_Monitor object
@@ -184,29 +507,22 @@ public:
      * The method will:
      * - Create a new device entry if the source address is new
      * - Update device timing information
-     * - Store and parse the PGN data
+     * - Update the rate statistics of the (source, PGN) entry
+     * - Store the raw PGN data and mark it for decoding
      *
-     * \param N2kMsg Reference to the received NMEA2000 message
-     */
-    void handleN2kMessage(const tN2kMsg &N2kMsg);
-
-    /**
-     * \brief Get reference to the devices map
+     * Field decoding is deferred to getDecodedPGNData() so that busy
+     * networks don't pay the String parsing cost for every frame.
      *
-     * Provides direct access to the internal devices map for iteration
-     * and bulk operations.
-     *
-     * \return Reference to std::map<uint8_t, DeviceInfo> of all devices
-     *
-     * \warning Modifying the returned map directly may cause inconsistencies.
-     *          Use provided methods for device management when possible.
+     * \param N2kMsg Reference to the received NMEA2000 message
+     * \param arrivalMicros Capture timestamp of the message's last frame, or
+     *        0 to use the last frame given to handleFrame()
      */
-    std::map<uint8_t, DeviceInfo>& getDevices() { return devices; }
+    void handleN2kMessage(const tN2kMsg &N2kMsg, uint32_t arrivalMicros = 0);
 
     /**
      * \brief Get reference to the ordered device list
      *
-     * Returns the list of device addresses in discovery order, useful
+     * Returns the list of device addresses sorted by address, useful
      * for consistent UI display ordering.
      *
      * \return Reference to std::vector<uint8_t> of device addresses
@@ -221,6 +537,36 @@ public:
      */
     DeviceInfo* getDevice(uint8_t address);
 
+    /**
+     * \brief Get the identity of the device at an address
+     *
+     * \param address NMEA2000 source address
+     * \return Identity, or nullptr if no address claim was seen for it
+     */
+    const N2K_Identity* getIdentity(uint8_t address) { return identities.findByAddress(address); }
+
+    /**
+     * \brief Get the table of every NAME seen
+     *
+     * \return Reference to the N2K_IdentityTable of the monitor
+     */
+    const N2K_IdentityTable& getIdentities() const { return identities; }
+
+    /**
+     * \brief Get the anomaly detector
+     *
+     * \return Reference to the N2K_AnomalyDetector of the monitor, for the
+     *         alert list and totals
+     */
+    const N2K_AnomalyDetector& getAnomalies() const { return anomalies; }
+
+    /**
+     * \brief Get the number of devices that followed their NAME to a new address
+     *
+     * \return Moves
+     */
+    uint32_t getMovedDeviceCount() const { return movedDeviceCount; }
+
     /**
      * \brief Get PGN data for a specific device and PGN number
      *
@@ -230,21 +576,204 @@ public:
      */
     PGNData* getPGNData(uint8_t deviceAddress, uint32_t pgn);
 
+    /**
+     * \brief Get PGN data with its fields decoded from the latest message
+     *
+     * Same as getPGNData(), but decodes the raw data into fields first if a
+     * new message has arrived since the last decode. Use this whenever the
+     * fields are needed. They live in a buffer shared by all entries, so
+     * they are only valid until the next call for another entry.
+     *
+     * \param deviceAddress NMEA2000 source address of the device
+     * \param pgn PGN number to retrieve
+     * \return Pointer to decoded PGNData if found, nullptr otherwise
+     */
+    PGNData* getDecodedPGNData(uint8_t deviceAddress, uint32_t pgn);
+
+    /**
+     * \brief Get the number of PGNs tracked for a device
+     *
+     * \param deviceAddress NMEA2000 source address of the device
+     * \return Number of PGNs, or 0 if the device is unknown
+     */
+    int getPGNCount(uint8_t deviceAddress);
+
+    /**
+     * \brief Get a device's PGN data by position in PGN number order
+     *
+     * Together with getPGNCount() this replaces iterating a device's PGNs.
+     * The fields are not decoded; use getDecodedPGNData() for that.
+     *
+     * \param deviceAddress NMEA2000 source address of the device
+     * \param index Position in the device's PGN list (0 to getPGNCount()-1)
+     * \return Pointer to PGNData if found, nullptr otherwise
+     */
+    PGNData* getPGNDataAt(uint8_t deviceAddress, int index);
+
+    /**
+     * \brief Get the generation of the device list
+     *
+     * Changes whenever a device appears or goes, or a device's name or PGN
+     * count changes. A screen that stores the value it drew with only has
+     * to redraw when it differs.
+     *
+     * \return Current list generation
+     */
+    uint32_t getListGeneration() const { return listGeneration; }
+
+    /**
+     * \brief Get the generation of a device
+     *
+     * Changes whenever the device's name or PGN list changes, and when the
+     * device is removed. Per-message updates show up in PGNData::sequence
+     * instead.
+     *
+     * \param address NMEA2000 source address of the device
+     * \return Current device generation, 0 for invalid addresses
+     */
+    uint32_t getDeviceGeneration(uint8_t address) const {
+        return address < MONITOR_MAX_DEVICES ? devices[address].generation : 0;
+    }
+
+    /**
+     * \brief Watch one (source, PGN) entry for changes
+     *
+     * The callback runs from handleN2kMessage() whenever a message for the
+     * entry is stored, and when the entry is removed. Only one entry can be
+     * watched; a new call replaces the previous one.
+     *
+     * \param source Source address of the entry
+     * \param pgn PGN number of the entry
+     * \param callback Function to call, or nullptr to stop watching
+     */
+    void watch(uint8_t source, uint32_t pgn, N2K_WatchCallback callback) {
+        watchSource = source;
+        watchPGN = pgn;
+        watchCallback = callback;
+    }
+
+    /**
+     * \brief Stop watching
+     */
+    void unwatch() { watchCallback = nullptr; }
+
+    /**
+     * \brief Get the number of PGNs dropped because the storage was full
+     *
+     * \return Count of PGN entries that could not be created
+     */
+    uint32_t getDroppedPGNCount() { return droppedPGNCount; }
+
+    /**
+     * \brief Get the payload pool used for raw PGN data
+     *
+     * \return Reference to the N2K_PayloadPool, e.g. for usage statistics
+     */
+    N2K_PayloadPool& getPayloadPool() { return payloadPool; }
+
+    /**
+     * \brief Get the memory the monitor holds
+     *
+     * The monitor object with its fixed tables, the payload pool storage
+     * and the capacity of the field and list vectors.
+     *
+     * \return Bytes reserved
+     */
+    uint32_t getReservedBytes() const;
+
+    /**
+     * \brief Get the part of getReservedBytes() holding data
+     *
+     * Counts the device slots and PGN entries in use, the payload blocks
+     * handed out and the elements of the vectors; all smaller tables count
+     * as fully used.
+     *
+     * \return Bytes in use
+     */
+    uint32_t getUsedBytes() const;
+
+    /**
+     * \brief Get the bus-wide traffic statistics
+     *
+     * Frames must be fed in with handleFrame() from the capture path;
+     * messages are counted by handleN2kMessage().
+     *
+     * \return Reference to the N2K_BusStats of the monitored bus
+     */
+    N2K_BusStats& getBusStats() { return busStats; }
+
+    /**
+     * \brief Account for a raw frame from the capture path
+     *
+     * Feeds the bus statistics and the transfer tracker. Transfers that end
+     * are credited to the PGN entry of their sender; one the library never
+     * delivered a message of only shows in the tracker's totals.
+     *
+     * \param id 29-bit CAN identifier
+     * \param len Number of data bytes
+     * \param data Data bytes
+     * \param timestamp Receive time (micros)
+     */
+    void handleFrame(uint32_t id, uint8_t len, const uint8_t* data, uint32_t timestamp);
+
+    /**
+     * \brief Get the multi-frame transfer tracker
+     *
+     * \return Reference to the N2K_TransferTracker of the monitored bus
+     */
+    const N2K_TransferTracker& getTransfers() const { return transfers; }
+
+    /**
+     * \brief Get the watched field history
+     *
+     * Fields are watched and unwatched through the returned object; every
+     * stored message of a watched PGN adds its value.
+     *
+     * \return Reference to the N2K_History of the monitor
+     */
+    N2K_History& getHistory() { return history; }
+
+    /**
+     * \brief Clear the bus statistics and the statistics of every PGN entry
+     *
+     * Includes the transfer totals and per-PGN transfer statistics, and
+     * the alerts (see resetAlerts()).
+     */
+    void resetStatistics();
+
+    /**
+     * \brief Clear the alert list and the anomaly state of every PGN entry
+     *
+     * Anomalies still present are raised again on the next message.
+     */
+    void resetAlerts();
+
     /**
      * \brief Get human-readable name for a PGN number
      *
-     * Looks up the standard name for a given PGN number.
+     * Binary search in a sorted table kept in flash; nothing is allocated.
      *
      * \param pgn PGN number to look up
-     * \return String containing PGN name, or "Unknown PGN" if not found
+     * \return PGN name, or nullptr if the PGN is not in the table
+     */
+    static const char* getPGNName(uint32_t pgn);
+
+    /**
+     * \brief Write the display name of a PGN into a buffer
+     *
+     * Falls back to "PGN <number>" for PGNs without a table entry.
+     *
+     * \param pgn PGN number to name
+     * \param out Buffer receiving the name
+     * \param size Size of out (N2K_PGN_NAME_SIZE is always enough)
      */
-    String getPGNName(uint32_t pgn);
+    static void formatPGNName(uint32_t pgn, char* out, size_t size);
 
     /**
      * \brief Enable or disable automatic stale entry cleanup
      *
-     * When enabled, the update() method will remove devices that haven't
-     * been seen within STALE_TIMEOUT_MS milliseconds.
+     * When enabled, cleanupStaleEntries() will remove devices and PGN
+     * entries that haven't been seen within their stale timeout.
      *
      * \param enabled true to enable cleanup, false to disable
      */
@@ -257,20 +786,52 @@ public:
      */
     bool isStaleCleanupEnabled() { return staleCleanupEnabled; }
 
+    /**
+     * \brief Set the stale timeout of a PGN class
+     *
+     * Entries already scheduled pick up the new timeout the next time they
+     * are checked, so a shorter timeout takes effect within the old one.
+     *
+     * \param staleClass Class to change
+     * \param timeoutMs New timeout in milliseconds (0 is ignored)
+     */
+    void setStaleTimeout(StaleClass staleClass, uint32_t timeoutMs);
+
+    /**
+     * \brief Get the stale timeout of a PGN class
+     *
+     * \param staleClass Class to look up
+     * \return Timeout in milliseconds
+     */
+    uint32_t getStaleTimeout(StaleClass staleClass) const;
+
+    /**
+     * \brief Get the stale class a PGN belongs to
+     *
+     * Binary search in a small table kept in flash.
+     *
+     * \param pgn PGN number to look up
+     * \return Class of the PGN, STALE_CLASS_DYNAMIC for PGNs not in the table
+     */
+    static StaleClass getStaleClass(uint32_t pgn);
+
     /**
      * \brief Remove stale devices and PGN entries
      *
-     * Removes devices that haven't been seen within STALE_TIMEOUT_MS.
-     * This method is called automatically by update() if stale cleanup
-     * is enabled.
+     * Retires at most MONITOR_EXPIRY_MAX_PER_PASS expired entries, taken
+     * from the expiry wheel, so a pass costs the same however many devices
+     * are tracked. Does nothing unless stale cleanup is enabled. The loop
+     * scheduler calls it every MONITOR_CLEANUP_INTERVAL_MS.
      */
     void cleanupStaleEntries();
 
     /**
      * \brief Periodic update function
      *
-     * Call this method periodically (e.g., in loop()) to perform
-     * maintenance tasks such as stale entry cleanup.
+     * Publishes the bus statistics window even while the bus is quiet and
+     * times out stalled multi-frame transfers. Also moves the watched field
+     * history on to the current time bucket. The loop scheduler calls it
+     * every MONITOR_STATS_INTERVAL_MS.
      */
     void update();
 
@@ -283,15 +844,18 @@ public:
      * \param name Human-readable name for the PGN
      * \param value Initial numeric value
      */
-    void registerPGN(uint32_t pgn, String name, double value);
+    void registerPGN(uint32_t pgn, const char* name, double value);
 
 
     /**
      * \brief Get reference to legacy detected PGNs vector
      *
+     * Decodes any PGN entries with pending raw data first so the legacy
+     * values reflect the latest messages.
+     *
      * \return Reference to std::vector<PGNInfo> of registered PGNs
      */
-    std::vector<PGNInfo>& getDetectedPGNs() { return detectedPGNs; }
+    std::vector<PGNInfo>& getDetectedPGNs();
 };
 
 #endif // N2K_MONITOR_H
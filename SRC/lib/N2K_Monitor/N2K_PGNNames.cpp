@@ -3,136 +3,178 @@
  * @brief PGN name lookup implementation for the N2K_Monitor module.
  *
  * This file provides human-readable name mapping for NMEA2000 Parameter Group
- * Numbers (PGNs). It contains a comprehensive lookup function that translates
- * numeric PGN identifiers into descriptive string names for display purposes.
+ * Numbers (PGNs). The names live in a table sorted by PGN number, stored in
+ * program flash and searched with a binary search, so a lookup never
+ * allocates memory.
  */
 
 #include "N2K_Monitor.h"
 
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+
 /**
- * @brief Retrieves the human-readable name for a given NMEA2000 PGN.
- *
- * This function provides a comprehensive lookup table that maps NMEA2000
- * Parameter Group Numbers (PGNs) to their descriptive names. The function
- * covers the following categories of PGNs:
- *
- * - System PGNs (ISO acknowledgment, requests, address claiming, etc.)
- * - Navigation PGNs (heading, position, COG/SOG, waypoints, etc.)
- * - Engine PGNs (RPM, dynamic parameters, transmission, trip data)
- * - Electrical PGNs (battery status, charger, DC systems, fluid levels)
- * - Environmental PGNs (temperature, humidity, pressure, wind, depth)
- * - Windlass PGNs (anchor windlass control and monitoring)
- * - AIS PGNs (Class A/B position reports, static data, safety messages)
- * - Entertainment PGNs (marine entertainment systems)
+ * @struct PGNNameEntry
+ * @brief One row of the PGN name table.
  *
- * @param pgn The 32-bit NMEA2000 Parameter Group Number to look up.
- *
- * @return String containing the human-readable name for the PGN.
- *         Returns "PGN XXXXX" format for unknown/unrecognized PGNs,
- *         where XXXXX is the numeric PGN value.
+ * The name is stored inline rather than as a pointer, so the whole table
+ * (including the text) stays in flash.
  */
-String N2K_Monitor::getPGNName(uint32_t pgn) {
-    switch(pgn) {
-        // System PGNs
-        case 59392:  return "ISO Ack";
-        case 59904:  return "ISO Request";
-        case 60160:  return "ISO Transport";
-        case 60416:  return "ISO TP Conn";
-        case 60928:  return "ISO Addr Claim";
-        case 65240:  return "Cmd Addr";
-        case 126208: return "NMEA Req/Cmd";
-        case 126464: return "PGN List";
-        case 126992: return "System Time";
-        case 126993: return "Heartbeat";
-        case 126996: return "Product Info";
-        case 126998: return "Config Info";
-
-        // Navigation PGNs
-        case 127233: return "MOB";
-        case 127237: return "Heading Ctrl";
-        case 127245: return "Rudder";
-        case 127250: return "Vessel Heading";
-        case 127251: return "Rate of Turn";
-        case 127252: return "Heave";
-        case 127257: return "Attitude";
-        case 127258: return "Mag Variation";
-        case 129025: return "Position Rapid";
-        case 129026: return "COG/SOG Rapid";
-        case 129029: return "GNSS Position";
-        case 129033: return "Time & Date";
-        case 129283: return "Cross Track Err";
-        case 129284: return "Nav Route Info";
-        case 129285: return "Nav Route/WP";
-        case 129539: return "GNSS DOPs";
-        case 129540: return "GNSS Sats";
-
-        // Engine PGNs
-        case 127488: return "Engine Rapid";
-        case 127489: return "Engine Dynamic";
-        case 127493: return "Transmission";
-        case 127497: return "Trip Params";
+struct PGNNameEntry {
+    uint32_t pgn;                       ///< PGN number
+    char name[N2K_PGN_NAME_SIZE];       ///< Display name, at most 15 characters
+};
 
-        // Electrical PGNs
-        case 127501: return "Binary Status";
-        case 127502: return "Switch Ctrl";
-        case 127505: return "Fluid Level";
-        case 127506: return "DC Detail";
-        case 127507: return "Charger Stat";
-        case 127508: return "Battery Stat";
-        case 127510: return "Charger Conf";
-        case 127513: return "Battery Conf";
-        case 127750: return "DC Converter";
-        case 127751: return "DC Volt/Curr";
+/**
+ * @brief Names of all PGNs known to the monitor, sorted by PGN number.
+ *
+ * Covers system, navigation, engine, electrical, environmental, windlass,
+ * AIS and entertainment PGNs.
+ */
+static constexpr PGNNameEntry PGN_NAMES[] PROGMEM = {
+    {59392,  "ISO Ack"},
+    {59904,  "ISO Request"},
+    {60160,  "ISO Transport"},
+    {60416,  "ISO TP Conn"},
+    {60928,  "ISO Addr Claim"},
+    {65240,  "Cmd Addr"},
+    {126208, "NMEA Req/Cmd"},
+    {126464, "PGN List"},
+    {126992, "System Time"},
+    {126993, "Heartbeat"},
+    {126996, "Product Info"},
+    {126998, "Config Info"},
+    {127233, "MOB"},
+    {127237, "Heading Ctrl"},
+    {127245, "Rudder"},
+    {127250, "Vessel Heading"},
+    {127251, "Rate of Turn"},
+    {127252, "Heave"},
+    {127257, "Attitude"},
+    {127258, "Mag Variation"},
+    {127488, "Engine Rapid"},
+    {127489, "Engine Dynamic"},
+    {127493, "Transmission"},
+    {127497, "Trip Params"},
+    {127501, "Binary Status"},
+    {127502, "Switch Ctrl"},
+    {127505, "Fluid Level"},
+    {127506, "DC Detail"},
+    {127507, "Charger Stat"},
+    {127508, "Battery Stat"},
+    {127510, "Charger Conf"},
+    {127513, "Battery Conf"},
+    {127750, "DC Converter"},
+    {127751, "DC Volt/Curr"},
+    {128000, "Leeway"},
+    {128259, "Speed Water"},
+    {128267, "Water Depth"},
+    {128275, "Distance Log"},
+    {128776, "Windlass Ctrl"},
+    {128777, "Windlass Op"},
+    {128778, "Windlass Mon"},
+    {129025, "Position Rapid"},
+    {129026, "COG/SOG Rapid"},
+    {129029, "GNSS Position"},
+    {129033, "Time & Date"},
+    {129038, "AIS Class A"},
+    {129039, "AIS Class B"},
+    {129040, "AIS B Ext"},
+    {129041, "AIS AtoN"},
+    {129283, "Cross Track Err"},
+    {129284, "Nav Route Info"},
+    {129285, "Nav Route/WP"},
+    {129539, "GNSS DOPs"},
+    {129540, "GNSS Sats"},
+    {129793, "AIS UTC/Date"},
+    {129794, "AIS Static A"},
+    {129795, "AIS Addressed"},
+    {129796, "AIS Ack"},
+    {129797, "AIS Binary"},
+    {129798, "AIS SAR"},
+    {129799, "Radio Freq"},
+    {129800, "AIS UTC Query"},
+    {129801, "AIS Slot Alloc"},
+    {129802, "AIS Safety"},
+    {129803, "AIS Interrog"},
+    {129804, "AIS Assign"},
+    {129805, "AIS Data Link"},
+    {129806, "AIS Channel"},
+    {129807, "AIS Group"},
+    {129808, "DSC Call Info"},
+    {129809, "AIS Static B"},
+    {129810, "AIS Static 24"},
+    {130306, "Wind Data"},
+    {130310, "Env Outside"},
+    {130311, "Env Params"},
+    {130312, "Temperature"},
+    {130313, "Humidity"},
+    {130314, "Pressure"},
+    {130316, "Temp Extended"},
+    {130323, "Meteo Station"},
+    {130576, "Trim Tabs"},
+    {130577, "Direction"},
+    {130816, "Entertainment"},
+};
 
-        // Environmental PGNs
-        case 128000: return "Leeway";
-        case 128259: return "Speed Water";
-        case 128267: return "Water Depth";
-        case 128275: return "Distance Log";
-        case 130306: return "Wind Data";
-        case 130310: return "Env Outside";
-        case 130311: return "Env Params";
-        case 130312: return "Temperature";
-        case 130313: return "Humidity";
-        case 130314: return "Pressure";
-        case 130316: return "Temp Extended";
-        case 130323: return "Meteo Station";
-        case 130576: return "Trim Tabs";
-        case 130577: return "Direction";
+static constexpr int PGN_NAME_COUNT = sizeof(PGN_NAMES) / sizeof(PGN_NAMES[0]);
 
-        // Windlass PGNs
-        case 128776: return "Windlass Ctrl";
-        case 128777: return "Windlass Op";
-        case 128778: return "Windlass Mon";
+/**
+ * @brief Check that PGN_NAMES is strictly ascending.
+ *
+ * @return true if the table can be binary searched
+ */
+static constexpr bool pgnNamesSorted() {
+    for(int i = 1; i < PGN_NAME_COUNT; i++) {
+        if(PGN_NAMES[i - 1].pgn >= PGN_NAMES[i].pgn) return false;
+    }
+    return true;
+}
 
-        // AIS PGNs
-        case 129038: return "AIS Class A";
-        case 129039: return "AIS Class B";
-        case 129040: return "AIS B Ext";
-        case 129041: return "AIS AtoN";
-        case 129793: return "AIS UTC/Date";
-        case 129794: return "AIS Static A";
-        case 129795: return "AIS Addressed";
-        case 129796: return "AIS Ack";
-        case 129797: return "AIS Binary";
-        case 129798: return "AIS SAR";
-        case 129799: return "Radio Freq";
-        case 129800: return "AIS UTC Query";
-        case 129801: return "AIS Slot Alloc";
-        case 129802: return "AIS Safety";
-        case 129803: return "AIS Interrog";
-        case 129804: return "AIS Assign";
-        case 129805: return "AIS Data Link";
-        case 129806: return "AIS Channel";
-        case 129807: return "AIS Group";
-        case 129808: return "DSC Call Info";
-        case 129809: return "AIS Static B";
-        case 129810: return "AIS Static 24";
+static_assert(pgnNamesSorted(), "PGN_NAMES must be sorted by PGN number");
 
-        // Entertainment
-        case 130816: return "Entertainment";
+/**
+ * @brief Retrieves the human-readable name for a given NMEA2000 PGN.
+ *
+ * Binary search over PGN_NAMES. The returned pointer refers to the table
+ * itself and stays valid for the lifetime of the program.
+ *
+ * @param pgn The 32-bit NMEA2000 Parameter Group Number to look up.
+ *
+ * @return Name of the PGN, or nullptr for unknown PGNs.
+ */
+const char* N2K_Monitor::getPGNName(uint32_t pgn) {
+    int low = 0;
+    int high = PGN_NAME_COUNT - 1;
+    while(low <= high) {
+        int mid = (low + high) / 2;
+        uint32_t midPGN = PGN_NAMES[mid].pgn;
+        if(midPGN == pgn) return PGN_NAMES[mid].name;
+        if(midPGN < pgn) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return nullptr;
+}
 
-        default:
-            return "PGN " + String(pgn);
+/**
+ * @brief Writes the display name of a PGN into a buffer.
+ *
+ * Uses the table name if there is one, otherwise "PGN XXXXX" where XXXXX
+ * is the numeric PGN value.
+ *
+ * @param pgn PGN number to name
+ * @param out Buffer receiving the name
+ * @param size Size of out, N2K_PGN_NAME_SIZE is always enough
+ */
+void N2K_Monitor::formatPGNName(uint32_t pgn, char* out, size_t size) {
+    const char* name = getPGNName(pgn);
+    if(name != nullptr) {
+        snprintf(out, size, "%s", name);
+    } else {
+        snprintf(out, size, "PGN %lu", (unsigned long)pgn);
     }
 }
@@ -9,6 +9,83 @@
  */
 
 #include "N2K_Monitor.h"
+#include <PGN_Helpers.h>
+#include <Zone_Profiler.h>
+#include <stdarg.h>
+
+static_assert(N2K_MAX_DECODED_FIELDS >= MAX_PGN_FIELDS, "The decode buffer must hold every field of a table PGN");
+
+/**
+ * @brief Append a decoded field with a printf-formatted value.
+ *
+ * The value is written straight into the monitor's decode buffer, cut to
+ * N2K_FIELD_VALUE_SIZE - 1 characters, so this never allocates. Fields
+ * past N2K_MAX_DECODED_FIELDS are left out.
+ *
+ * @param pgnData PGNData structure the field is added to
+ * @param name Field name, must outlive the entry (literal or PGN table)
+ * @param unit Unit, must outlive the entry, "" for none
+ * @param format printf format of the value
+ */
+static void addField(PGNData &pgnData, const char* name, const char* unit, const char* format, ...)
+    __attribute__((format(printf, 4, 5)));
+
+static void addField(PGNData &pgnData, const char* name, const char* unit, const char* format, ...) {
+    if(pgnData.fields.count >= N2K_MAX_DECODED_FIELDS) return;
+    PGNField &field = pgnData.fields.items[pgnData.fields.count++];
+    field.name = name;
+    field.unit = unit;
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(field.value, sizeof(field.value), format, args);
+    va_end(args);
+}
+
+/**
+ * @brief Format up to 8 payload bytes as space-separated hex.
+ *
+ * @param data First byte
+ * @param count Number of bytes, at most 8
+ * @param[out] out Receives the text, N2K_FIELD_VALUE_SIZE bytes
+ */
+static void formatHexBytes(const unsigned char* data, int count, char* out) {
+    int pos = 0;
+    for(int i = 0; i < count && i < 8; i++) {
+        pos += snprintf(&out[pos], N2K_FIELD_VALUE_SIZE - pos, (i > 0) ? " %02x" : "%02x", data[i]);
+    }
+    out[pos] = '\0';
+}
+
+/**
+ * @brief Decode a PGN with a fixed layout from its descriptor table entry.
+ *
+ * Runs the generic field decoder over every field of the definition. Fields
+ * holding an N/A value are skipped, enumerations are shown by name and
+ * numeric fields are formatted with the decimals given in the table.
+ *
+ * @param def Table entry for the PGN (see IMPERSONATABLE_PGN_DEFS)
+ * @param N2kMsg Message to decode
+ * @param pgnData PGNData structure whose fields are filled
+ */
+static void decodeTablePGN(const PGNDef &def, const tN2kMsg &N2kMsg, PGNData &pgnData) {
+    int total = getPGNDefFieldTotal(def);
+    for(int i = 0; i < total; i++) {
+        const PGNFieldDef &field = def.fields[i];
+        int32_t raw;
+        if(!decodePGNField(field, N2kMsg.Data, N2kMsg.DataLen, raw)) continue;
+
+        if(field.enumNames != nullptr) {
+            if(raw >= 0 && raw < field.enumCount) {
+                addField(pgnData, field.name, field.unit, "%s", field.enumNames[raw]);
+            } else {
+                addField(pgnData, field.name, field.unit, "%ld", (long)raw);
+            }
+        } else {
+            addField(pgnData, field.name, field.unit, "%.*f", field.decimals, getPGNFieldValue(field, raw));
+        }
+    }
+}
 
 /**
  * @brief Parses an NMEA2000 message and extracts human-readable field data.
@@ -78,18 +155,21 @@
  * - 129809: AIS Class B CS Static Data Part A (MMSI, name)
  * - 129810: AIS Class B CS Static Data Part B (MMSI, callsign, dimensions)
  *
+ * PGNs with a fixed field layout are listed in IMPERSONATABLE_PGN_DEFS
+ * (PGN_Helpers.h) and decoded by the generic table decoder; the switch only
+ * handles PGNs with strings, repeating groups or AIS bit packing.
+ *
  * For unrecognized PGNs, the function displays raw hexadecimal data bytes.
  *
  * @param N2kMsg Reference to the incoming NMEA2000 message to parse.
  *               Contains PGN number, data length, source address, and raw data.
  * @param pgnData Reference to the PGNData structure to populate with parsed results.
- *                On return, contains:
- *                - pgn: The PGN number
- *                - name: Human-readable PGN name
- *                - lastUpdate: Timestamp of when this was parsed
- *                - fields: Vector of parsed field name/value/unit tuples
- *                - rawData: Copy of the raw message data
- *                - dataLen: Length of the raw data
+ *                On return, fields holds the parsed name/value/unit tuples.
+ *                The remaining members (pgn, name, lastUpdate, rawData) are
+ *                owned by handleN2kMessage() and are left untouched.
+ *
+ * @note This is called lazily through decodePGNData() rather than for every
+ *       received frame, with N2kMsg rebuilt from the stored rawData.
  *
  * @note Unit conversions are applied automatically:
  *       - Angles: Radians to degrees
@@ -105,183 +185,22 @@
  * @see PGNData structure for the output data format.
  */
 void N2K_Monitor::parsePGNData(const tN2kMsg &N2kMsg, PGNData &pgnData) {
-    pgnData.pgn = N2kMsg.PGN;
-    pgnData.name = getPGNName(N2kMsg.PGN);
-    pgnData.lastUpdate = millis();
-    pgnData.fields.clear();
-
-    // Store raw data for potential re-parsing
-    pgnData.dataLen = min((int)N2kMsg.DataLen, 256);
-    memcpy(pgnData.rawData, N2kMsg.Data, pgnData.dataLen);
+    PROFILE_ZONE(PROFILE_PGN_PARSE);
+    PROFILE_PGN(N2kMsg.PGN);
+
+    // Raw data, name and timestamps are maintained by handleN2kMessage();
+    // this function only (re)builds the decoded fields, which
+    // decodePGNData() has pointed at the empty decode buffer
+
+    // Fixed-layout PGNs come straight from the descriptor table
+    const PGNDef* def = getPGNDef(N2kMsg.PGN);
+    if(def != nullptr) {
+        decodeTablePGN(*def, N2kMsg, pgnData);
+        return;
+    }
 
     // Parse based on PGN
     switch(N2kMsg.PGN) {
-        case 127250: { // Vessel Heading
-            unsigned char SID;
-            double Heading, Deviation, Variation;
-            tN2kHeadingReference ref;
-            if(ParseN2kHeading(N2kMsg, SID, Heading, Deviation, Variation, ref)) {
-                pgnData.fields.push_back({"Heading", String(RadToDeg(Heading), 1), "deg"});
-                if(!N2kIsNA(Deviation)) pgnData.fields.push_back({"Deviation", String(RadToDeg(Deviation), 1), "deg"});
-                if(!N2kIsNA(Variation)) pgnData.fields.push_back({"Variation", String(RadToDeg(Variation), 1), "deg"});
-                pgnData.fields.push_back({"Reference", ref == N2khr_magnetic ? "Mag" : "True", ""});
-            }
-            break;
-        }
-
-        case 127251: { // Rate of Turn
-            unsigned char SID;
-            double RateOfTurn;
-            if(ParseN2kRateOfTurn(N2kMsg, SID, RateOfTurn)) {
-                pgnData.fields.push_back({"Rate", String(RadToDeg(RateOfTurn) * 60, 2), "deg/min"});
-            }
-            break;
-        }
-
-        case 127257: { // Attitude
-            unsigned char SID;
-            double Yaw, Pitch, Roll;
-            if(ParseN2kAttitude(N2kMsg, SID, Yaw, Pitch, Roll)) {
-                if(!N2kIsNA(Yaw)) pgnData.fields.push_back({"Yaw", String(RadToDeg(Yaw), 1), "deg"});
-                if(!N2kIsNA(Pitch)) pgnData.fields.push_back({"Pitch", String(RadToDeg(Pitch), 1), "deg"});
-                if(!N2kIsNA(Roll)) pgnData.fields.push_back({"Roll", String(RadToDeg(Roll), 1), "deg"});
-            }
-            break;
-        }
-
-        case 127258: { // Magnetic Variation
-            unsigned char SID;
-            tN2kMagneticVariation Source;
-            uint16_t DaysSince1970;
-            double Variation;
-            if(ParseN2kMagneticVariation(N2kMsg, SID, Source, DaysSince1970, Variation)) {
-                if(!N2kIsNA(Variation)) pgnData.fields.push_back({"Var", String(RadToDeg(Variation), 1), "deg"});
-                const char* sourceNames[] = {"Manual", "Chart", "Table", "Calc", "WMM2000", "WMM2005", "WMM2010", "WMM2015", "WMM2020"};
-                if((int)Source < 9) {
-                    pgnData.fields.push_back({"Source", sourceNames[(int)Source], ""});
-                }
-            }
-            break;
-        }
-
-        case 127245: { // Rudder
-            double RudderPosition;
-            unsigned char Instance;
-            tN2kRudderDirectionOrder RudderDirectionOrder;
-            double AngleOrder;
-            if(ParseN2kRudder(N2kMsg, RudderPosition, Instance, RudderDirectionOrder, AngleOrder)) {
-                pgnData.fields.push_back({"Position", String(RadToDeg(RudderPosition), 1), "deg"});
-                pgnData.fields.push_back({"Instance", String(Instance), ""});
-            }
-            break;
-        }
-
-        case 127488: { // Engine Rapid
-            unsigned char EngineInstance;
-            double EngineSpeed, EngineBoostPressure;
-            int8_t EngineTiltTrim;
-            if(ParseN2kEngineParamRapid(N2kMsg, EngineInstance, EngineSpeed, EngineBoostPressure, EngineTiltTrim)) {
-                pgnData.fields.push_back({"Instance", String(EngineInstance), ""});
-                pgnData.fields.push_back({"RPM", String(EngineSpeed, 0), "rpm"});
-                if(!N2kIsNA(EngineBoostPressure)) pgnData.fields.push_back({"Boost", String(EngineBoostPressure/100, 1), "kPa"});
-                if(EngineTiltTrim != N2kInt8NA) pgnData.fields.push_back({"Tilt/Trim", String(EngineTiltTrim), "%"});
-            }
-            break;
-        }
-
-        case 127489: { // Engine Dynamic
-            unsigned char EngineInstance;
-            double EngineOilPress, EngineOilTemp, EngineCoolantTemp, AlternatorVoltage;
-            double FuelRate, EngineHours, EngineCoolantPress, EngineFuelPress;
-            int8_t EngineLoad, EngineTorque;
-            tN2kEngineDiscreteStatus1 Status1;
-            tN2kEngineDiscreteStatus2 Status2;
-            if(ParseN2kEngineDynamicParam(N2kMsg, EngineInstance, EngineOilPress, EngineOilTemp,
-                                          EngineCoolantTemp, AlternatorVoltage, FuelRate, EngineHours,
-                                          EngineCoolantPress, EngineFuelPress, EngineLoad, EngineTorque,
-                                          Status1, Status2)) {
-                pgnData.fields.push_back({"Instance", String(EngineInstance), ""});
-                if(!N2kIsNA(EngineOilPress)) pgnData.fields.push_back({"Oil Press", String(EngineOilPress/1000, 1), "kPa"});
-                if(!N2kIsNA(EngineOilTemp)) pgnData.fields.push_back({"Oil Temp", String(KelvinToC(EngineOilTemp), 1), "C"});
-                if(!N2kIsNA(EngineCoolantTemp)) pgnData.fields.push_back({"Coolant", String(KelvinToC(EngineCoolantTemp), 1), "C"});
-                if(!N2kIsNA(AlternatorVoltage)) pgnData.fields.push_back({"Alt Volt", String(AlternatorVoltage, 1), "V"});
-                if(!N2kIsNA(FuelRate)) pgnData.fields.push_back({"Fuel Rate", String(FuelRate * 3600, 1), "L/h"});
-                if(!N2kIsNA(EngineHours)) pgnData.fields.push_back({"Hours", String(EngineHours / 3600, 1), "h"});
-                if(EngineLoad != N2kInt8NA) pgnData.fields.push_back({"Load", String(EngineLoad), "%"});
-            }
-            break;
-        }
-
-        case 127508: { // Battery Status
-            unsigned char BatteryInstance;
-            double BatteryVoltage, BatteryCurrent, BatteryTemperature;
-            unsigned char SID;
-            if(ParseN2kDCBatStatus(N2kMsg, BatteryInstance, BatteryVoltage, BatteryCurrent, BatteryTemperature, SID)) {
-                pgnData.fields.push_back({"Instance", String(BatteryInstance), ""});
-                if(!N2kIsNA(BatteryVoltage)) pgnData.fields.push_back({"Voltage", String(BatteryVoltage, 2), "V"});
-                if(!N2kIsNA(BatteryCurrent)) pgnData.fields.push_back({"Current", String(BatteryCurrent, 1), "A"});
-                if(!N2kIsNA(BatteryTemperature)) pgnData.fields.push_back({"Temp", String(KelvinToC(BatteryTemperature), 1), "C"});
-            }
-            break;
-        }
-
-        case 127505: { // Fluid Level
-            unsigned char Instance;
-            tN2kFluidType FluidType;
-            double Level, Capacity;
-            if(ParseN2kFluidLevel(N2kMsg, Instance, FluidType, Level, Capacity)) {
-                pgnData.fields.push_back({"Instance", String(Instance), ""});
-                const char* fluidNames[] = {"Fuel", "Water", "Gray", "LiveWell", "Oil", "Black", "Gasoline", "Error", "Unavail"};
-                if((int)FluidType < 9) pgnData.fields.push_back({"Type", fluidNames[(int)FluidType], ""});
-                pgnData.fields.push_back({"Level", String(Level, 1), "%"});
-                if(!N2kIsNA(Capacity)) pgnData.fields.push_back({"Capacity", String(Capacity, 0), "L"});
-            }
-            break;
-        }
-
-        case 128259: { // Speed Water
-            unsigned char SID;
-            double WaterReferenced, GroundReferenced;
-            tN2kSpeedWaterReferenceType SWRT;
-            if(ParseN2kBoatSpeed(N2kMsg, SID, WaterReferenced, GroundReferenced, SWRT)) {
-                if(!N2kIsNA(WaterReferenced)) pgnData.fields.push_back({"STW", String(msToKnots(WaterReferenced), 2), "kn"});
-                if(!N2kIsNA(GroundReferenced)) pgnData.fields.push_back({"SOG", String(msToKnots(GroundReferenced), 2), "kn"});
-            }
-            break;
-        }
-
-        case 128267: { // Water Depth
-            unsigned char SID;
-            double DepthBelowTransducer, Offset, Range;
-            if(ParseN2kWaterDepth(N2kMsg, SID, DepthBelowTransducer, Offset, Range)) {
-                pgnData.fields.push_back({"Depth", String(DepthBelowTransducer, 1), "m"});
-                if(!N2kIsNA(Offset)) pgnData.fields.push_back({"Offset", String(Offset, 2), "m"});
-                if(!N2kIsNA(Range)) pgnData.fields.push_back({"Range", String(Range, 0), "m"});
-            }
-            break;
-        }
-
-        case 129025: { // Position Rapid
-            double Latitude, Longitude;
-            if(ParseN2kPositionRapid(N2kMsg, Latitude, Longitude)) {
-                pgnData.fields.push_back({"Lat", String(Latitude, 6), "deg"});
-                pgnData.fields.push_back({"Lon", String(Longitude, 6), "deg"});
-            }
-            break;
-        }
-
-        case 129026: { // COG/SOG Rapid
-            unsigned char SID;
-            tN2kHeadingReference ref;
-            double COG, SOG;
-            if(ParseN2kCOGSOGRapid(N2kMsg, SID, ref, COG, SOG)) {
-                if(!N2kIsNA(COG)) pgnData.fields.push_back({"COG", String(RadToDeg(COG), 1), "deg"});
-                if(!N2kIsNA(SOG)) pgnData.fields.push_back({"SOG", String(msToKnots(SOG), 2), "kn"});
-                pgnData.fields.push_back({"Reference", ref == N2khr_magnetic ? "Mag" : "True", ""});
-            }
-            break;
-        }
-
         case 129029: { // GNSS Position
             unsigned char SID;
             uint16_t DaysSince1970;
@@ -299,86 +218,11 @@ void N2K_Monitor::parsePGNData(const tN2kMsg &N2kMsg, PGNData &pgnData) {
                             Latitude, Longitude, Altitude, GNSStype, GNSSmethod,
                             nSatellites, HDOP, PDOP, GeoidalSeparation,
                             nReferenceStations, ReferenceStationType, ReferenceSationID, AgeOfCorrection)) {
-                pgnData.fields.push_back({"Lat", String(Latitude, 6), "deg"});
-                pgnData.fields.push_back({"Lon", String(Longitude, 6), "deg"});
-                if(!N2kIsNA(Altitude)) pgnData.fields.push_back({"Alt", String(Altitude, 1), "m"});
-                pgnData.fields.push_back({"Sats", String(nSatellites), ""});
-                if(!N2kIsNA(HDOP)) pgnData.fields.push_back({"HDOP", String(HDOP, 1), ""});
-            }
-            break;
-        }
-
-        case 130306: { // Wind Data
-            unsigned char SID;
-            double WindSpeed, WindAngle;
-            tN2kWindReference WindReference;
-            if(ParseN2kWindSpeed(N2kMsg, SID, WindSpeed, WindAngle, WindReference)) {
-                pgnData.fields.push_back({"Speed", String(msToKnots(WindSpeed), 1), "kn"});
-                pgnData.fields.push_back({"Angle", String(RadToDeg(WindAngle), 1), "deg"});
-                const char* refNames[] = {"True N", "Mag N", "Apparent", "True Boat", "True Water"};
-                if((int)WindReference < 5) pgnData.fields.push_back({"Ref", refNames[(int)WindReference], ""});
-            }
-            break;
-        }
-
-        case 130310: { // Environmental Outside
-            unsigned char SID;
-            double WaterTemperature, OutsideAmbientAirTemperature, AtmosphericPressure;
-            if(ParseN2kOutsideEnvironmentalParameters(N2kMsg, SID, WaterTemperature,
-                                                       OutsideAmbientAirTemperature, AtmosphericPressure)) {
-                if(!N2kIsNA(WaterTemperature)) pgnData.fields.push_back({"Water Temp", String(KelvinToC(WaterTemperature), 1), "C"});
-                if(!N2kIsNA(OutsideAmbientAirTemperature)) pgnData.fields.push_back({"Air Temp", String(KelvinToC(OutsideAmbientAirTemperature), 1), "C"});
-                if(!N2kIsNA(AtmosphericPressure)) pgnData.fields.push_back({"Pressure", String(AtmosphericPressure/100, 1), "mbar"});
-            }
-            break;
-        }
-
-        case 130311: { // Environmental Parameters
-            unsigned char SID;
-            tN2kTempSource TempSource;
-            double Temperature;
-            tN2kHumiditySource HumiditySource;
-            double Humidity, AtmosphericPressure;
-            if(ParseN2kEnvironmentalParameters(N2kMsg, SID, TempSource, Temperature,
-                                               HumiditySource, Humidity, AtmosphericPressure)) {
-                if(!N2kIsNA(Temperature)) pgnData.fields.push_back({"Temp", String(KelvinToC(Temperature), 1), "C"});
-                if(!N2kIsNA(Humidity)) pgnData.fields.push_back({"Humidity", String(Humidity, 1), "%"});
-                if(!N2kIsNA(AtmosphericPressure)) pgnData.fields.push_back({"Pressure", String(AtmosphericPressure/100, 1), "mbar"});
-            }
-            break;
-        }
-
-        case 130312: { // Temperature
-            unsigned char SID, TempInstance;
-            tN2kTempSource TempSource;
-            double ActualTemperature, SetTemperature;
-            if(ParseN2kTemperature(N2kMsg, SID, TempInstance, TempSource, ActualTemperature, SetTemperature)) {
-                pgnData.fields.push_back({"Instance", String(TempInstance), ""});
-                if(!N2kIsNA(ActualTemperature)) pgnData.fields.push_back({"Actual", String(KelvinToC(ActualTemperature), 1), "C"});
-                if(!N2kIsNA(SetTemperature)) pgnData.fields.push_back({"Set", String(KelvinToC(SetTemperature), 1), "C"});
-            }
-            break;
-        }
-
-        case 130313: { // Humidity
-            unsigned char SID, HumidityInstance;
-            tN2kHumiditySource HumiditySource;
-            double ActualHumidity, SetHumidity;
-            if(ParseN2kHumidity(N2kMsg, SID, HumidityInstance, HumiditySource, ActualHumidity, SetHumidity)) {
-                pgnData.fields.push_back({"Instance", String(HumidityInstance), ""});
-                if(!N2kIsNA(ActualHumidity)) pgnData.fields.push_back({"Actual", String(ActualHumidity, 1), "%"});
-                if(!N2kIsNA(SetHumidity)) pgnData.fields.push_back({"Set", String(SetHumidity, 1), "%"});
-            }
-            break;
-        }
-
-        case 130314: { // Pressure
-            unsigned char SID, PressureInstance;
-            tN2kPressureSource PressureSource;
-            double Pressure;
-            if(ParseN2kPressure(N2kMsg, SID, PressureInstance, PressureSource, Pressure)) {
-                pgnData.fields.push_back({"Instance", String(PressureInstance), ""});
-                pgnData.fields.push_back({"Pressure", String(Pressure/100, 1), "mbar"});
+                addField(pgnData, "Lat", "deg", "%.6f", Latitude);
+                addField(pgnData, "Lon", "deg", "%.6f", Longitude);
+                if(!N2kIsNA(Altitude)) addField(pgnData, "Alt", "m", "%.1f", Altitude);
+                addField(pgnData, "Sats", "", "%lu", (unsigned long)nSatellites);
+                if(!N2kIsNA(HDOP)) addField(pgnData, "HDOP", "", "%.1f", HDOP);
             }
             break;
         }
@@ -389,29 +233,13 @@ void N2K_Monitor::parsePGNData(const tN2kMsg &N2kMsg, PGNData &pgnData) {
             double SystemTime;
             tN2kTimeSource TimeSource;
             if(ParseN2kSystemTime(N2kMsg, SID, SystemDate, SystemTime, TimeSource)) {
-                pgnData.fields.push_back({"Days", String(SystemDate), ""});
+                addField(pgnData, "Days", "", "%lu", (unsigned long)SystemDate);
                 int hours = (int)(SystemTime / 3600);
                 int mins = (int)((SystemTime - hours * 3600) / 60);
                 int secs = (int)(SystemTime - hours * 3600 - mins * 60);
                 char timeStr[16];
                 snprintf(timeStr, sizeof(timeStr), "%02d:%02d:%02d", hours, mins, secs);
-                pgnData.fields.push_back({"Time", String(timeStr), "UTC"});
-            }
-            break;
-        }
-
-        case 127493: { // Transmission Parameters
-            unsigned char EngineInstance;
-            tN2kTransmissionGear TransmissionGear;
-            double OilPressure, OilTemperature;
-            unsigned char DiscreteStatus1;
-            if(ParseN2kTransmissionParameters(N2kMsg, EngineInstance, TransmissionGear,
-                                              OilPressure, OilTemperature, DiscreteStatus1)) {
-                pgnData.fields.push_back({"Instance", String(EngineInstance), ""});
-                const char* gearNames[] = {"Forward", "Neutral", "Reverse", "Unknown"};
-                if((int)TransmissionGear < 4) pgnData.fields.push_back({"Gear", gearNames[(int)TransmissionGear], ""});
-                if(!N2kIsNA(OilPressure)) pgnData.fields.push_back({"Oil Press", String(OilPressure/1000, 1), "kPa"});
-                if(!N2kIsNA(OilTemperature)) pgnData.fields.push_back({"Oil Temp", String(KelvinToC(OilTemperature), 1), "C"});
+                addField(pgnData, "Time", "UTC", "%s", timeStr);
             }
             break;
         }
@@ -421,8 +249,8 @@ void N2K_Monitor::parsePGNData(const tN2kMsg &N2kMsg, PGNData &pgnData) {
             double SecondsSinceMidnight;
             uint32_t Log, TripLog;
             if(ParseN2kDistanceLog(N2kMsg, DaysSince1970, SecondsSinceMidnight, Log, TripLog)) {
-                if(Log != N2kUInt32NA) pgnData.fields.push_back({"Log", String((double)Log/1852.0, 1), "nm"});
-                if(TripLog != N2kUInt32NA) pgnData.fields.push_back({"Trip", String((double)TripLog/1852.0, 2), "nm"});
+                if(Log != N2kUInt32NA) addField(pgnData, "Log", "nm", "%.1f", (double)Log/1852.0);
+                if(TripLog != N2kUInt32NA) addField(pgnData, "Trip", "nm", "%.2f", (double)TripLog/1852.0);
             }
             break;
         }
@@ -444,21 +272,21 @@ void N2K_Monitor::parsePGNData(const tN2kMsg &N2kMsg, PGNData &pgnData) {
                 uint8_t sysInstance = (name >> 56) & 0x0F;  // 4 bits
                 uint8_t indGroup = (name >> 60) & 0x07;  // 3 bits
 
-                pgnData.fields.push_back({"Mfr Code", String(mfrCode), ""});
-                pgnData.fields.push_back({"Unique#", String(uniqueNumber), ""});
-                pgnData.fields.push_back({"Dev Func", String(devFunction), ""});
-                pgnData.fields.push_back({"Dev Class", String(devClass), ""});
-                pgnData.fields.push_back({"Instance", String(devInstance), ""});
+                addField(pgnData, "Mfr Code", "", "%lu", (unsigned long)mfrCode);
+                addField(pgnData, "Unique#", "", "%lu", (unsigned long)uniqueNumber);
+                addField(pgnData, "Dev Func", "", "%lu", (unsigned long)devFunction);
+                addField(pgnData, "Dev Class", "", "%lu", (unsigned long)devClass);
+                addField(pgnData, "Instance", "", "%lu", (unsigned long)devInstance);
 
                 // Industry group names
                 const char* indNames[] = {"Global", "Highway", "Agri", "Constr", "Marine", "Indust"};
                 if(indGroup < 6) {
-                    pgnData.fields.push_back({"Industry", indNames[indGroup], ""});
+                    addField(pgnData, "Industry", "", "%s", indNames[indGroup]);
                 } else {
-                    pgnData.fields.push_back({"Industry", String(indGroup), ""});
+                    addField(pgnData, "Industry", "", "%lu", (unsigned long)indGroup);
                 }
 
-                pgnData.fields.push_back({"Sys Inst", String(sysInstance), ""});
+                addField(pgnData, "Sys Inst", "", "%lu", (unsigned long)sysInstance);
             }
             break;
         }
@@ -477,13 +305,13 @@ void N2K_Monitor::parsePGNData(const tN2kMsg &N2kMsg, PGNData &pgnData) {
                 uint8_t ctrl2State = (N2kMsg.Data[5] >> 2) & 0x03;
 
                 if(interval != 0xFFFFFFFF) {
-                    pgnData.fields.push_back({"Interval", String(interval / 1000.0, 1), "sec"});
+                    addField(pgnData, "Interval", "sec", "%.1f", interval / 1000.0);
                 }
-                pgnData.fields.push_back({"Sequence", String(seqCounter), ""});
+                addField(pgnData, "Sequence", "", "%lu", (unsigned long)seqCounter);
 
                 const char* stateNames[] = {"Ctrl", "Auto", "Remote", "N/A"};
-                pgnData.fields.push_back({"Ctrl1", stateNames[ctrl1State], ""});
-                pgnData.fields.push_back({"Ctrl2", stateNames[ctrl2State], ""});
+                addField(pgnData, "Ctrl1", "", "%s", stateNames[ctrl1State]);
+                addField(pgnData, "Ctrl2", "", "%s", stateNames[ctrl2State]);
             }
             break;
         }
@@ -499,40 +327,10 @@ void N2K_Monitor::parsePGNData(const tN2kMsg &N2kMsg, PGNData &pgnData) {
                                  sizeof(ModelVersion), ModelVersion,
                                  sizeof(ModelSerialCode), ModelSerialCode,
                                  CertificationLevel, LoadEquivalency)) {
-                pgnData.fields.push_back({"N2K Ver", String(N2kVersion), ""});
-                pgnData.fields.push_back({"Prod Code", String(ProductCode), ""});
-                if(strlen(ModelID) > 0) {
-                    String modelStr = String(ModelID);
-                    if(modelStr.length() > 14) modelStr = modelStr.substring(0, 14);
-                    pgnData.fields.push_back({"Model", modelStr, ""});
-                }
-                if(strlen(SwCode) > 0) {
-                    String swStr = String(SwCode);
-                    if(swStr.length() > 12) swStr = swStr.substring(0, 12);
-                    pgnData.fields.push_back({"SW", swStr, ""});
-                }
-            }
-            break;
-        }
-
-        case 127252: { // Heave
-            unsigned char SID;
-            double Heave, Delay;
-            tN2kDelaySource DelaySource;
-            if(ParseN2kHeave(N2kMsg, SID, Heave, Delay, DelaySource)) {
-                if(!N2kIsNA(Heave)) pgnData.fields.push_back({"Heave", String(Heave, 2), "m"});
-                if(!N2kIsNA(Delay)) pgnData.fields.push_back({"Delay", String(Delay, 3), "s"});
-            }
-            break;
-        }
-
-        case 127497: { // Trip Fuel Parameters
-            unsigned char EngineInstance;
-            double TripFuelUsed, FuelRateAverage, FuelRateEconomy, InstantaneousFuelEconomy;
-            if(ParseN2kEngineTripParameters(N2kMsg, EngineInstance, TripFuelUsed, FuelRateAverage, FuelRateEconomy, InstantaneousFuelEconomy)) {
-                pgnData.fields.push_back({"Engine", String(EngineInstance), ""});
-                if(!N2kIsNA(TripFuelUsed)) pgnData.fields.push_back({"Trip Fuel", String(TripFuelUsed, 1), "L"});
-                if(!N2kIsNA(FuelRateAverage)) pgnData.fields.push_back({"Avg Rate", String(FuelRateAverage * 3600, 1), "L/h"});
+                addField(pgnData, "N2K Ver", "", "%lu", (unsigned long)N2kVersion);
+                addField(pgnData, "Prod Code", "", "%lu", (unsigned long)ProductCode);
+                if(strlen(ModelID) > 0) addField(pgnData, "Model", "", "%.14s", ModelID);
+                if(strlen(SwCode) > 0) addField(pgnData, "SW", "", "%.12s", SwCode);
             }
             break;
         }
@@ -541,45 +339,15 @@ void N2K_Monitor::parsePGNData(const tN2kMsg &N2kMsg, PGNData &pgnData) {
             unsigned char DeviceBankInstance;
             tN2kBinaryStatus BankStatus;
             if(ParseN2kBinaryStatus(N2kMsg, DeviceBankInstance, BankStatus)) {
-                pgnData.fields.push_back({"Bank", String(DeviceBankInstance), ""});
+                addField(pgnData, "Bank", "", "%lu", (unsigned long)DeviceBankInstance);
                 // Show first 8 switch states
-                String states = "";
+                char states[9];
                 for(int i = 0; i < 8; i++) {
                     tN2kOnOff status = N2kGetStatusOnBinaryStatus(BankStatus, i + 1);
-                    states += (status == N2kOnOff_On) ? "1" : ((status == N2kOnOff_Off) ? "0" : "-");
+                    states[i] = (status == N2kOnOff_On) ? '1' : ((status == N2kOnOff_Off) ? '0' : '-');
                 }
-                pgnData.fields.push_back({"Sw 1-8", states, ""});
-            }
-            break;
-        }
-
-        case 127506: { // DC Detailed Status
-            unsigned char SID, DCInstance;
-            tN2kDCType DCType;
-            uint8_t StateOfCharge, StateOfHealth;
-            double TimeRemaining, RippleVoltage, Capacity;
-            if(ParseN2kDCStatus(N2kMsg, SID, DCInstance, DCType, StateOfCharge, StateOfHealth, TimeRemaining, RippleVoltage, Capacity)) {
-                pgnData.fields.push_back({"Instance", String(DCInstance), ""});
-                if(StateOfCharge <= 100) pgnData.fields.push_back({"SOC", String(StateOfCharge), "%"});
-                if(StateOfHealth <= 100) pgnData.fields.push_back({"Health", String(StateOfHealth), "%"});
-                if(!N2kIsNA(Capacity)) pgnData.fields.push_back({"Capacity", String(Capacity, 0), "Ah"});
-            }
-            break;
-        }
-
-        case 127507: { // Charger Status
-            unsigned char Instance, BatteryInstance;
-            tN2kChargeState ChargeState;
-            tN2kChargerMode ChargerMode;
-            tN2kOnOff Enabled;
-            tN2kOnOff EqualizationPending;
-            double EqualizationTimeRemaining;
-            if(ParseN2kChargerStatus(N2kMsg, Instance, BatteryInstance, ChargeState, ChargerMode, Enabled, EqualizationPending, EqualizationTimeRemaining)) {
-                pgnData.fields.push_back({"Charger", String(Instance), ""});
-                pgnData.fields.push_back({"Battery", String(BatteryInstance), ""});
-                const char* stateNames[] = {"Not Chg", "Bulk", "Absorb", "Overchg", "Equal", "Float", "No Float", "Fault"};
-                if((int)ChargeState < 8) pgnData.fields.push_back({"State", stateNames[(int)ChargeState], ""});
-                pgnData.fields.push_back({"Enabled", Enabled == N2kOnOff_On ? "Yes" : "No", ""});
+                states[8] = '\0';
+                addField(pgnData, "Sw 1-8", "", "%s", states);
             }
             break;
         }
@@ -595,12 +363,12 @@ void N2K_Monitor::parsePGNData(const tN2kMsg &N2kMsg, PGNData &pgnData) {
             double PeukertExponent;
             int8_t ChargeEfficiencyFactor;
             if(ParseN2kBatConf(N2kMsg, BatInstance, BatType, SupportsEqual, BatNominalVoltage, BatChemistry, BatCapacity, BatTemperatureCoefficient, PeukertExponent, ChargeEfficiencyFactor)) {
-                pgnData.fields.push_back({"Instance", String(BatInstance), ""});
+                addField(pgnData, "Instance", "", "%lu", (unsigned long)BatInstance);
                 const char* typeNames[] = {"Flooded", "Gel", "AGM"};
-                if((int)BatType < 3) pgnData.fields.push_back({"Type", typeNames[(int)BatType], ""});
+                if((int)BatType < 3) addField(pgnData, "Type", "", "%s", typeNames[(int)BatType]);
                 const char* chemNames[] = {"Lead Acid", "LiIon", "NiCad", "NiMH"};
-                if((int)BatChemistry < 4) pgnData.fields.push_back({"Chemistry", chemNames[(int)BatChemistry], ""});
-                if(!N2kIsNA(BatCapacity)) pgnData.fields.push_back({"Capacity", String(BatCapacity / 3600, 0), "Ah"});
+                if((int)BatChemistry < 4) addField(pgnData, "Chemistry", "", "%s", chemNames[(int)BatChemistry]);
+                if(!N2kIsNA(BatCapacity)) addField(pgnData, "Capacity", "Ah", "%.0f", BatCapacity / 3600);
             }
             break;
         }
@@ -609,18 +377,9 @@ void N2K_Monitor::parsePGNData(const tN2kMsg &N2kMsg, PGNData &pgnData) {
             unsigned char Instance, SID;
             double Voltage, Current;
             if(ParseN2kPGN127751(N2kMsg, Instance, Voltage, Current, SID)) {
-                pgnData.fields.push_back({"Instance", String(Instance), ""});
-                if(!N2kIsNA(Voltage)) pgnData.fields.push_back({"Voltage", String(Voltage, 2), "V"});
-                if(!N2kIsNA(Current)) pgnData.fields.push_back({"Current", String(Current, 1), "A"});
-            }
-            break;
-        }
-
-        case 128000: { // Leeway
-            unsigned char SID;
-            double Leeway;
-            if(ParseN2kLeeway(N2kMsg, SID, Leeway)) {
-                if(!N2kIsNA(Leeway)) pgnData.fields.push_back({"Leeway", String(RadToDeg(Leeway), 1), "deg"});
+                addField(pgnData, "Instance", "", "%lu", (unsigned long)Instance);
+                if(!N2kIsNA(Voltage)) addField(pgnData, "Voltage", "V", "%.2f", Voltage);
+                if(!N2kIsNA(Current)) addField(pgnData, "Current", "A", "%.1f", Current);
             }
             break;
         }
@@ -635,8 +394,8 @@ void N2K_Monitor::parsePGNData(const tN2kMsg &N2kMsg, PGNData &pgnData) {
                 int secs = (int)(SecondsSinceMidnight - hours * 3600 - mins * 60);
                 char timeStr[12];
                 snprintf(timeStr, sizeof(timeStr), "%02d:%02d:%02d", hours, mins, secs);
-                pgnData.fields.push_back({"Time", String(timeStr), ""});
-                pgnData.fields.push_back({"Offset", String(LocalOffset), "min"});
+                addField(pgnData, "Time", "", "%s", timeStr);
+                addField(pgnData, "Offset", "min", "%ld", (long)LocalOffset);
             }
             break;
         }
@@ -653,11 +412,11 @@ void N2K_Monitor::parsePGNData(const tN2kMsg &N2kMsg, PGNData &pgnData) {
             unsigned char SID;
             if(ParseN2kPGN129038(N2kMsg, MessageID, Repeat, UserID, Latitude, Longitude,
                                  Accuracy, RAIM, Seconds, COG, SOG, Heading, ROT, NavStatus, AISInfo, SID)) {
-                pgnData.fields.push_back({"MMSI", String(UserID), ""});
-                if(!N2kIsNA(Latitude)) pgnData.fields.push_back({"Lat", String(Latitude, 4), "deg"});
-                if(!N2kIsNA(Longitude)) pgnData.fields.push_back({"Lon", String(Longitude, 4), "deg"});
-                if(!N2kIsNA(SOG)) pgnData.fields.push_back({"SOG", String(msToKnots(SOG), 1), "kn"});
-                if(!N2kIsNA(COG)) pgnData.fields.push_back({"COG", String(RadToDeg(COG), 0), "deg"});
+                addField(pgnData, "MMSI", "", "%lu", (unsigned long)UserID);
+                if(!N2kIsNA(Latitude)) addField(pgnData, "Lat", "deg", "%.4f", Latitude);
+                if(!N2kIsNA(Longitude)) addField(pgnData, "Lon", "deg", "%.4f", Longitude);
+                if(!N2kIsNA(SOG)) addField(pgnData, "SOG", "kn", "%.1f", msToKnots(SOG));
+                if(!N2kIsNA(COG)) addField(pgnData, "COG", "deg", "%.0f", RadToDeg(COG));
             }
             break;
         }
@@ -678,11 +437,11 @@ void N2K_Monitor::parsePGNData(const tN2kMsg &N2kMsg, PGNData &pgnData) {
             if(ParseN2kPGN129039(N2kMsg, MessageID, Repeat, UserID, Latitude, Longitude,
                                  Accuracy, RAIM, Seconds, COG, SOG, AISInfo, Heading,
                                  Unit, Display, DSC, Band, Msg22, Mode, State, SID)) {
-                pgnData.fields.push_back({"MMSI", String(UserID), ""});
-                if(!N2kIsNA(Latitude)) pgnData.fields.push_back({"Lat", String(Latitude, 4), "deg"});
-                if(!N2kIsNA(Longitude)) pgnData.fields.push_back({"Lon", String(Longitude, 4), "deg"});
-                if(!N2kIsNA(SOG)) pgnData.fields.push_back({"SOG", String(msToKnots(SOG), 1), "kn"});
-                if(!N2kIsNA(COG)) pgnData.fields.push_back({"COG", String(RadToDeg(COG), 0), "deg"});
+                addField(pgnData, "MMSI", "", "%lu", (unsigned long)UserID);
+                if(!N2kIsNA(Latitude)) addField(pgnData, "Lat", "deg", "%.4f", Latitude);
+                if(!N2kIsNA(Longitude)) addField(pgnData, "Lon", "deg", "%.4f", Longitude);
+                if(!N2kIsNA(SOG)) addField(pgnData, "SOG", "kn", "%.1f", msToKnots(SOG));
+                if(!N2kIsNA(COG)) addField(pgnData, "COG", "deg", "%.0f", RadToDeg(COG));
             }
             break;
         }
@@ -693,8 +452,8 @@ void N2K_Monitor::parsePGNData(const tN2kMsg &N2kMsg, PGNData &pgnData) {
             bool NavigationTerminated;
             double XTE;
             if(ParseN2kXTE(N2kMsg, SID, XTEMode, NavigationTerminated, XTE)) {
-                if(!N2kIsNA(XTE)) pgnData.fields.push_back({"XTE", String(XTE, 0), "m"});
-                pgnData.fields.push_back({"Nav Term", NavigationTerminated ? "Yes" : "No", ""});
+                if(!N2kIsNA(XTE)) addField(pgnData, "XTE", "m", "%.0f", XTE);
+                addField(pgnData, "Nav Term", "", "%s", NavigationTerminated ? "Yes" : "No");
             }
             break;
         }
@@ -714,10 +473,10 @@ void N2K_Monitor::parsePGNData(const tN2kMsg &N2kMsg, PGNData &pgnData) {
                                       BearingOriginToWaypoint, BearingPositionToWaypoint,
                                       OriginWaypointNumber, DestinationWaypointNumber,
                                       DestinationLatitude, DestinationLongitude, WaypointClosingVelocity)) {
-                if(!N2kIsNA(DistanceToWaypoint)) pgnData.fields.push_back({"Dist WP", String(DistanceToWaypoint, 0), "m"});
-                if(!N2kIsNA(BearingPositionToWaypoint)) pgnData.fields.push_back({"Bearing", String(RadToDeg(BearingPositionToWaypoint), 0), "deg"});
-                if(!N2kIsNA(WaypointClosingVelocity)) pgnData.fields.push_back({"VMG", String(msToKnots(WaypointClosingVelocity), 1), "kn"});
-                pgnData.fields.push_back({"Arrived", ArrivalCircleEntered ? "Yes" : "No", ""});
+                if(!N2kIsNA(DistanceToWaypoint)) addField(pgnData, "Dist WP", "m", "%.0f", DistanceToWaypoint);
+                if(!N2kIsNA(BearingPositionToWaypoint)) addField(pgnData, "Bearing", "deg", "%.0f", RadToDeg(BearingPositionToWaypoint));
+                if(!N2kIsNA(WaypointClosingVelocity)) addField(pgnData, "VMG", "kn", "%.1f", msToKnots(WaypointClosingVelocity));
+                addField(pgnData, "Arrived", "", "%s", ArrivalCircleEntered ? "Yes" : "No");
             }
             break;
         }
@@ -727,11 +486,11 @@ void N2K_Monitor::parsePGNData(const tN2kMsg &N2kMsg, PGNData &pgnData) {
             tN2kGNSSDOPmode DesiredMode, ActualMode;
             double HDOP, VDOP, TDOP;
             if(ParseN2kGNSSDOPData(N2kMsg, SID, DesiredMode, ActualMode, HDOP, VDOP, TDOP)) {
-                if(!N2kIsNA(HDOP)) pgnData.fields.push_back({"HDOP", String(HDOP, 2), ""});
-                if(!N2kIsNA(VDOP)) pgnData.fields.push_back({"VDOP", String(VDOP, 2), ""});
-                if(!N2kIsNA(TDOP)) pgnData.fields.push_back({"TDOP", String(TDOP, 2), ""});
+                if(!N2kIsNA(HDOP)) addField(pgnData, "HDOP", "", "%.2f", HDOP);
+                if(!N2kIsNA(VDOP)) addField(pgnData, "VDOP", "", "%.2f", VDOP);
+                if(!N2kIsNA(TDOP)) addField(pgnData, "TDOP", "", "%.2f", TDOP);
                 const char* modeNames[] = {"1D", "2D", "3D", "Auto", "Reserved", "Error"};
-                if((int)ActualMode < 6) pgnData.fields.push_back({"Mode", modeNames[(int)ActualMode], ""});
+                if((int)ActualMode < 6) addField(pgnData, "Mode", "", "%s", modeNames[(int)ActualMode]);
             }
             break;
         }
@@ -741,13 +500,12 @@ void N2K_Monitor::parsePGNData(const tN2kMsg &N2kMsg, PGNData &pgnData) {
             tN2kRangeResidualMode Mode;
             uint8_t NumberOfSVs;
             if(ParseN2kPGN129540(N2kMsg, SID, Mode, NumberOfSVs)) {
-                pgnData.fields.push_back({"Sats", String(NumberOfSVs), ""});
+                addField(pgnData, "Sats", "", "%lu", (unsigned long)NumberOfSVs);
                 // Get info for first few satellites
                 for(uint8_t i = 0; i < min((uint8_t)3, NumberOfSVs); i++) {
                     tSatelliteInfo satInfo;
                     if(ParseN2kPGN129540(N2kMsg, i, satInfo)) {
-                        String satStr = "SV" + String(satInfo.PRN) + " El" + String(RadToDeg(satInfo.Elevation), 0);
-                        pgnData.fields.push_back({"", satStr, ""});
+                        addField(pgnData, "", "", "SV%u El%.0f", (unsigned)satInfo.PRN, RadToDeg(satInfo.Elevation));
                     }
                 }
             }
@@ -774,10 +532,10 @@ void N2K_Monitor::parsePGNData(const tN2kMsg &N2kMsg, PGNData &pgnData) {
             if(ParseN2kPGN129794(N2kMsg, MessageID, Repeat, UserID, IMONumber, Callsign, sizeof(Callsign), Name, sizeof(Name),
                                  VesselType, Length, Beam, PosRefStbd, PosRefBow,
                                  ETAdate, ETAtime, Draught, Destination, sizeof(Destination), AISversion, GNSStype, DTE, AISinfo, SID)) {
-                pgnData.fields.push_back({"MMSI", String(UserID), ""});
-                if(strlen(Name) > 0) pgnData.fields.push_back({"Name", String(Name).substring(0, 12), ""});
-                if(strlen(Callsign) > 0) pgnData.fields.push_back({"Call", String(Callsign), ""});
-                if(!N2kIsNA(Length)) pgnData.fields.push_back({"Length", String(Length, 0), "m"});
+                addField(pgnData, "MMSI", "", "%lu", (unsigned long)UserID);
+                if(strlen(Name) > 0) addField(pgnData, "Name", "", "%.12s", Name);
+                if(strlen(Callsign) > 0) addField(pgnData, "Call", "", "%s", Callsign);
+                if(!N2kIsNA(Length)) addField(pgnData, "Length", "m", "%.0f", Length);
             }
             break;
         }
@@ -790,8 +548,8 @@ void N2K_Monitor::parsePGNData(const tN2kMsg &N2kMsg, PGNData &pgnData) {
             tN2kAISTransceiverInformation AISInfo;
             uint8_t SID;
             if(ParseN2kPGN129809(N2kMsg, MessageID, Repeat, UserID, Name, sizeof(Name), AISInfo, SID)) {
-                pgnData.fields.push_back({"MMSI", String(UserID), ""});
-                if(strlen(Name) > 0) pgnData.fields.push_back({"Name", String(Name).substring(0, 12), ""});
+                addField(pgnData, "MMSI", "", "%lu", (unsigned long)UserID);
+                if(strlen(Name) > 0) addField(pgnData, "Name", "", "%.12s", Name);
             }
             break;
         }
@@ -808,70 +566,23 @@ void N2K_Monitor::parsePGNData(const tN2kMsg &N2kMsg, PGNData &pgnData) {
             uint8_t SID;
             if(ParseN2kPGN129810(N2kMsg, MessageID, Repeat, UserID, VesselType, Vendor, sizeof(Vendor), Callsign, sizeof(Callsign),
                                  Length, Beam, PosRefStbd, PosRefBow, MothershipUserID, AISInfo, SID)) {
-                pgnData.fields.push_back({"MMSI", String(UserID), ""});
-                if(strlen(Callsign) > 0) pgnData.fields.push_back({"Call", String(Callsign), ""});
-                if(!N2kIsNA(Length)) pgnData.fields.push_back({"Length", String(Length, 0), "m"});
-                if(!N2kIsNA(Beam)) pgnData.fields.push_back({"Beam", String(Beam, 1), "m"});
-            }
-            break;
-        }
-
-        case 130316: { // Temperature Extended Range
-            unsigned char SID, TempInstance;
-            tN2kTempSource TempSource;
-            double ActualTemperature, SetTemperature;
-            if(ParseN2kTemperatureExt(N2kMsg, SID, TempInstance, TempSource, ActualTemperature, SetTemperature)) {
-                pgnData.fields.push_back({"Instance", String(TempInstance), ""});
-                const char* srcNames[] = {"Sea", "Outside", "Inside", "Engine", "Cabin", "LiveWell", "Bait", "Refrig", "Heat", "Dew", "Wind", "App Wind", "Exh", "Shift"};
-                if((int)TempSource < 14) pgnData.fields.push_back({"Source", srcNames[(int)TempSource], ""});
-                if(!N2kIsNA(ActualTemperature)) pgnData.fields.push_back({"Temp", String(KelvinToC(ActualTemperature), 1), "C"});
-                if(!N2kIsNA(SetTemperature)) pgnData.fields.push_back({"Set", String(KelvinToC(SetTemperature), 1), "C"});
-            }
-            break;
-        }
-
-        case 130576: { // Trim Tab Status
-            int8_t PortTrimTab, StbdTrimTab;
-            if(ParseN2kTrimTab(N2kMsg, PortTrimTab, StbdTrimTab)) {
-                if(PortTrimTab != N2kInt8NA) pgnData.fields.push_back({"Port", String(PortTrimTab), "%"});
-                if(StbdTrimTab != N2kInt8NA) pgnData.fields.push_back({"Stbd", String(StbdTrimTab), "%"});
-            }
-            break;
-        }
-
-        case 130577: { // Direction Data
-            tN2kDataMode DataMode;
-            tN2kHeadingReference CogReference;
-            unsigned char SID;
-            double COG, SOG, Heading, SpeedThroughWater, Set, Drift;
-            if(ParseN2kDirectionData(N2kMsg, DataMode, CogReference, SID, COG, SOG, Heading, SpeedThroughWater, Set, Drift)) {
-                if(!N2kIsNA(COG)) pgnData.fields.push_back({"COG", String(RadToDeg(COG), 0), "deg"});
-                if(!N2kIsNA(SOG)) pgnData.fields.push_back({"SOG", String(msToKnots(SOG), 1), "kn"});
-                if(!N2kIsNA(Heading)) pgnData.fields.push_back({"Heading", String(RadToDeg(Heading), 0), "deg"});
-                if(!N2kIsNA(Set)) pgnData.fields.push_back({"Set", String(RadToDeg(Set), 0), "deg"});
-                if(!N2kIsNA(Drift)) pgnData.fields.push_back({"Drift", String(msToKnots(Drift), 1), "kn"});
+                addField(pgnData, "MMSI", "", "%lu", (unsigned long)UserID);
+                if(strlen(Callsign) > 0) addField(pgnData, "Call", "", "%s", Callsign);
+                if(!N2kIsNA(Length)) addField(pgnData, "Length", "m", "%.0f", Length);
+                if(!N2kIsNA(Beam)) addField(pgnData, "Beam", "m", "%.1f", Beam);
             }
             break;
         }
 
         default: {
             // For unknown PGNs, show raw data bytes
-            pgnData.fields.push_back({"DataLen", String(N2kMsg.DataLen), "bytes"});
-            String hexData = "";
-            for(int i = 0; i < min((int)N2kMsg.DataLen, 8); i++) {
-                if(i > 0) hexData += " ";
-                if(N2kMsg.Data[i] < 16) hexData += "0";
-                hexData += String(N2kMsg.Data[i], HEX);
-            }
-            pgnData.fields.push_back({"Data", hexData, ""});
+            addField(pgnData, "DataLen", "bytes", "%lu", (unsigned long)N2kMsg.DataLen);
+            char hexData[N2K_FIELD_VALUE_SIZE];
+            formatHexBytes(N2kMsg.Data, min((int)N2kMsg.DataLen, 8), hexData);
+            addField(pgnData, "Data", "", "%s", hexData);
             if(N2kMsg.DataLen > 8) {
-                hexData = "";
-                for(int i = 8; i < min((int)N2kMsg.DataLen, 16); i++) {
-                    if(i > 8) hexData += " ";
-                    if(N2kMsg.Data[i] < 16) hexData += "0";
-                    hexData += String(N2kMsg.Data[i], HEX);
-                }
-                pgnData.fields.push_back({"", hexData, ""});
+                formatHexBytes(&N2kMsg.Data[8], min((int)N2kMsg.DataLen, 16) - 8, hexData);
+                addField(pgnData, "", "", "%s", hexData);
             }
             break;
         }
@@ -0,0 +1,210 @@
+/**
+ * \file N2K_Stats.cpp
+ * \brief Implementation of the per-PGN and bus-wide traffic statistics
+ *
+ * Contains the incremental interval statistics and the exact on-wire frame
+ * length calculation used for the bus utilization.
+ */
+
+#include "N2K_Stats.h"
+#include <math.h>
+
+/* ---------------------------------------------------------------------------
+ * N2K_PGNStats
+ * ------------------------------------------------------------------------- */
+
+void N2K_PGNStats::reset() {
+    count = 0;
+    lastMicros = 0;
+    ewmaInterval = 0;
+    minInterval = 0;
+    maxInterval = 0;
+    meanInterval = 0;
+    m2Interval = 0;
+    ewmaDeviation = 0;
+    ewmaBytes = 0;
+}
+
+/**
+ * \brief Account for a received message
+ *
+ * The first message only sets the reference time and payload size; interval
+ * statistics start with the second one.
+ *
+ * \param nowMicros Arrival time of the message (micros)
+ * \param len Payload length in bytes
+ */
+void N2K_PGNStats::record(uint32_t nowMicros, uint16_t len) {
+    count++;
+
+    if(count == 1) {
+        lastMicros = nowMicros;
+        ewmaBytes = len;
+        return;
+    }
+
+    float interval = (uint32_t)(nowMicros - lastMicros) / 1000.0f;
+    lastMicros = nowMicros;
+    ewmaBytes += MONITOR_STATS_EWMA_ALPHA * (len - ewmaBytes);
+
+    if(count == 2) {
+        ewmaInterval = interval;
+        minInterval = interval;
+        maxInterval = interval;
+    } else {
+        ewmaDeviation += MONITOR_STATS_EWMA_ALPHA * (fabsf(interval - ewmaInterval) - ewmaDeviation);
+        ewmaInterval += MONITOR_STATS_EWMA_ALPHA * (interval - ewmaInterval);
+        if(interval < minInterval) minInterval = interval;
+        if(interval > maxInterval) maxInterval = interval;
+    }
+
+    // Welford update over the count - 1 intervals seen so far
+    uint32_t n = count - 1;
+    float delta = interval - meanInterval;
+    meanInterval += delta / n;
+    m2Interval += delta * (interval - meanInterval);
+}
+
+float N2K_PGNStats::getRate() const {
+    if(count < 2 || ewmaInterval <= 0) return 0;
+    return 1000.0f / ewmaInterval;
+}
+
+float N2K_PGNStats::getJitter() const {
+    if(count < 3) return 0;
+    return sqrtf(m2Interval / (count - 2));
+}
+
+/* ---------------------------------------------------------------------------
+ * N2K_BusStats
+ * ------------------------------------------------------------------------- */
+
+/// Bits after the CRC that are never stuffed: CRC delimiter, ACK slot and
+/// delimiter, end of frame and interframe space
+static constexpr uint16_t FRAME_TRAILER_BITS = 1 + 2 + 7 + 3;
+
+/**
+ * \brief Feeds frame bits through the CAN CRC and bit stuffing rules
+ *
+ * The controller inserts a complementary bit after every five equal bits
+ * from the start of frame to the end of the CRC, counting stuff bits
+ * themselves towards the next run.
+ */
+struct FrameBitCounter {
+    uint16_t bits = 0;          ///< Bits emitted, excluding stuff bits
+    uint16_t stuffBits = 0;     ///< Stuff bits the controller would add
+    uint16_t crc = 0;           ///< CRC-15 over the bits emitted so far
+    uint8_t runBit = 2;         ///< Value of the current run (2 = no run yet)
+    uint8_t runLength = 0;      ///< Length of the current run
+
+    void stuff(uint8_t bit) {
+        bits++;
+        if(bit == runBit) {
+            if(++runLength == 5) {
+                stuffBits++;
+                runBit = !bit;
+                runLength = 1;
+            }
+        } else {
+            runBit = bit;
+            runLength = 1;
+        }
+    }
+
+    void crcBit(uint8_t bit) {
+        uint8_t next = bit ^ ((crc >> 14) & 1);
+        crc = (crc << 1) & 0x7FFF;
+        if(next) crc ^= 0x4599;
+    }
+
+    void field(uint32_t value, uint8_t width) {
+        for(int i = width - 1; i >= 0; i--) {
+            uint8_t bit = (value >> i) & 1;
+            crcBit(bit);
+            stuff(bit);
+        }
+    }
+};
+
+/**
+ * \brief Get the number of bits a frame occupies on the wire
+ *
+ * Builds the extended data frame bit by bit: SOF, base ID, SRR, IDE,
+ * extended ID, RTR, two reserved bits, DLC, data and CRC-15, then adds the
+ * unstuffed trailer. At most 118 bits are processed per frame.
+ *
+ * \param id 29-bit CAN identifier
+ * \param len Number of data bytes (0 to 8)
+ * \param data Data bytes
+ * \return Frame length in bits including stuff bits and interframe space
+ */
+uint16_t N2K_BusStats::frameBits(uint32_t id, uint8_t len, const uint8_t* data) {
+    if(len > 8) len = 8;
+
+    FrameBitCounter counter;
+    counter.field(0, 1);                    // SOF
+    counter.field((id >> 18) & 0x7FF, 11);  // Base identifier
+    counter.field(1, 1);                    // SRR
+    counter.field(1, 1);                    // IDE
+    counter.field(id & 0x3FFFF, 18);        // Identifier extension
+    counter.field(0, 1);                    // RTR
+    counter.field(0, 2);                    // r1, r0
+    counter.field(len, 4);                  // DLC
+    for(uint8_t i = 0; i < len; i++) {
+        counter.field(data[i], 8);
+    }
+
+    uint16_t crc = counter.crc;
+    for(int i = 14; i >= 0; i--) {
+        counter.stuff((crc >> i) & 1);
+    }
+
+    return counter.bits + counter.stuffBits + FRAME_TRAILER_BITS;
+}
+
+void N2K_BusStats::reset() {
+    windowStart = millis();
+    windowFrames = 0;
+    windowMessages = 0;
+    windowBits = 0;
+    lastFrameMicros = 0;
+
+    totalFrames = 0;
+    framesPerSecond = 0;
+    messagesPerSecond = 0;
+    busLoad = 0;
+    peakBusLoad = 0;
+}
+
+void N2K_BusStats::addFrame(uint32_t id, uint8_t len, const uint8_t* data, uint32_t timestampMicros) {
+    update(millis());
+
+    windowFrames++;
+    windowBits += frameBits(id, len, data);
+    totalFrames++;
+    lastFrameMicros = timestampMicros;
+}
+
+/**
+ * \brief Publish the window once it has elapsed
+ *
+ * Rates are scaled by the real window length, so a late call (e.g. after a
+ * long screen redraw) still reports correct values.
+ *
+ * \param nowMillis Current time (millis)
+ */
+void N2K_BusStats::update(uint32_t nowMillis) {
+    uint32_t elapsed = nowMillis - windowStart;
+    if(elapsed < MONITOR_STATS_WINDOW_MS) return;
+
+    float seconds = elapsed / 1000.0f;
+    framesPerSecond = windowFrames / seconds;
+    messagesPerSecond = windowMessages / seconds;
+    busLoad = 100.0f * windowBits / (seconds * MONITOR_BUS_BITRATE);
+    if(busLoad > peakBusLoad) peakBusLoad = busLoad;
+
+    windowStart = nowMillis;
+    windowFrames = 0;
+    windowMessages = 0;
+    windowBits = 0;
+}
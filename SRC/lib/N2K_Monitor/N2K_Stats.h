@@ -0,0 +1,250 @@
+/**
+ * \file N2K_Stats.h
+ * \brief Traffic statistics for the N2K_Monitor module
+ *
+ * Two layers of statistics are kept while traffic is flowing:
+ * - N2K_PGNStats, one per (source, PGN) entry: message count, smoothed
+ *   interval, min/max interval, jitter and payload bytes per second.
+ * - N2K_BusStats, one for the whole bus: frames and messages per second and
+ *   the bus utilization as a share of MONITOR_BUS_BITRATE.
+ *
+ * Every update is constant time and allocation free, so the statistics can
+ * be fed from the receive path for every frame and message.
+ */
+
+#ifndef N2K_STATS_H
+#define N2K_STATS_H
+
+#include <Arduino.h>
+#include "constants.h"
+
+/**
+ * \class N2K_PGNStats
+ * \brief Timing statistics of one PGN sent by one device
+ *
+ * The inter-arrival interval is tracked three ways:
+ * - an exponentially weighted moving average (EWMA), which follows changes
+ *   in the send rate and is used for the rate shown on screen
+ * - the minimum and maximum ever seen
+ * - Welford's running mean and variance, whose standard deviation is the
+ *   jitter
+ *
+ * The Welford mean and jitter cover every interval since the last reset,
+ * so they serve as the learned baseline of the stream. The EWMA and its
+ * smoothed deviation show the recent behaviour to compare it with.
+ */
+class N2K_PGNStats {
+private:
+    uint32_t count;             ///< Messages received since the last reset
+    uint32_t lastMicros;        ///< Arrival time of the previous message (micros)
+    float ewmaInterval;         ///< Smoothed interval between messages (ms)
+    float minInterval;          ///< Shortest interval seen (ms)
+    float maxInterval;          ///< Longest interval seen (ms)
+    float meanInterval;         ///< Welford running mean of the interval (ms)
+    float m2Interval;           ///< Welford sum of squared deviations (ms^2)
+    float ewmaDeviation;        ///< Smoothed absolute deviation of the interval from ewmaInterval (ms)
+    float ewmaBytes;            ///< Smoothed payload length (bytes)
+
+public:
+    /**
+     * \brief Construct empty statistics
+     */
+    N2K_PGNStats() { reset(); }
+
+    /**
+     * \brief Clear all statistics
+     */
+    void reset();
+
+    /**
+     * \brief Account for a received message
+     *
+     * \param nowMicros Arrival time of the message (micros)
+     * \param len Payload length in bytes
+     */
+    void record(uint32_t nowMicros, uint16_t len);
+
+    /**
+     * \brief Get the number of messages received
+     *
+     * \return Messages since the last reset
+     */
+    uint32_t getCount() const { return count; }
+
+    /**
+     * \brief Get the current send rate
+     *
+     * \return Messages per second from the smoothed interval, 0 before the second message
+     */
+    float getRate() const;
+
+    /**
+     * \brief Get the smoothed interval between messages
+     *
+     * \return Interval in milliseconds, 0 before the second message
+     */
+    float getInterval() const { return count > 1 ? ewmaInterval : 0; }
+
+    /**
+     * \brief Get the shortest interval seen
+     *
+     * \return Interval in milliseconds, 0 before the second message
+     */
+    float getMinInterval() const { return count > 1 ? minInterval : 0; }
+
+    /**
+     * \brief Get the longest interval seen
+     *
+     * \return Interval in milliseconds, 0 before the second message
+     */
+    float getMaxInterval() const { return count > 1 ? maxInterval : 0; }
+
+    /**
+     * \brief Get the long-run mean interval between messages
+     *
+     * \return Mean of every interval since the last reset in milliseconds, 0 before the second message
+     */
+    float getMeanInterval() const { return count > 1 ? meanInterval : 0; }
+
+    /**
+     * \brief Get the jitter of the interval
+     *
+     * \return Standard deviation of the interval in milliseconds
+     */
+    float getJitter() const;
+
+    /**
+     * \brief Get the recent jitter of the interval
+     *
+     * Follows a change within roughly 1 / MONITOR_STATS_EWMA_ALPHA messages,
+     * unlike getJitter(). For normally distributed intervals it is about
+     * 0.8 times the standard deviation.
+     *
+     * \return Smoothed absolute deviation of the interval in milliseconds
+     */
+    float getRecentJitter() const { return count > 2 ? ewmaDeviation : 0; }
+
+    /**
+     * \brief Get the payload throughput of this PGN
+     *
+     * \return Payload bytes per second at the current send rate
+     */
+    float getBytesPerSecond() const { return ewmaBytes * getRate(); }
+};
+
+/**
+ * \class N2K_BusStats
+ * \brief Bus-wide frame rate and utilization
+ *
+ * Each frame is costed with its exact length on the wire: the extended frame
+ * fields, the CRC-15 and the stuff bits the controller inserts, plus the
+ * delimiter, ACK, end-of-frame and interframe space. The counts are summed
+ * over MONITOR_STATS_WINDOW_MS and published as rates at the end of each
+ * window.
+ */
+class N2K_BusStats {
+private:
+    uint32_t windowStart;       ///< Start of the current window (millis)
+    uint32_t windowFrames;      ///< Frames in the current window
+    uint32_t windowMessages;    ///< Messages in the current window
+    uint32_t windowBits;        ///< Bits on the wire in the current window
+    uint32_t lastFrameMicros;   ///< Timestamp of the most recent frame (micros)
+
+    uint32_t totalFrames;       ///< Frames since the last reset
+    float framesPerSecond;      ///< Frame rate of the last complete window
+    float messagesPerSecond;    ///< Message rate of the last complete window
+    float busLoad;              ///< Bus utilization of the last complete window (%)
+    float peakBusLoad;          ///< Highest busLoad since the last reset (%)
+
+public:
+    /**
+     * \brief Construct empty statistics
+     */
+    N2K_BusStats() { reset(); }
+
+    /**
+     * \brief Clear all statistics and start a new window
+     */
+    void reset();
+
+    /**
+     * \brief Account for a frame seen on the bus
+     *
+     * \param id 29-bit CAN identifier
+     * \param len Number of data bytes (0 to 8)
+     * \param data Data bytes, needed to count the stuff bits
+     * \param timestampMicros Receive time of the frame (micros)
+     */
+    void addFrame(uint32_t id, uint8_t len, const uint8_t* data, uint32_t timestampMicros);
+
+    /**
+     * \brief Account for a complete NMEA2000 message
+     */
+    void addMessage() { windowMessages++; }
+
+    /**
+     * \brief Publish the window once it has elapsed
+     *
+     * Called from addFrame() and from N2K_Monitor::update(), so the rates
+     * drop to zero when the bus goes quiet.
+     *
+     * \param nowMillis Current time (millis)
+     */
+    void update(uint32_t nowMillis);
+
+    /**
+     * \brief Get the time of the most recent frame
+     *
+     * \return Receive timestamp in micros, 0 if no frame was seen yet
+     */
+    uint32_t getLastFrameMicros() const { return lastFrameMicros; }
+
+    /**
+     * \brief Get the number of frames seen
+     *
+     * \return Frames since the last reset
+     */
+    uint32_t getTotalFrames() const { return totalFrames; }
+
+    /**
+     * \brief Get the frame rate
+     *
+     * \return Frames per second over the last window
+     */
+    float getFramesPerSecond() const { return framesPerSecond; }
+
+    /**
+     * \brief Get the message rate
+     *
+     * Lower than the frame rate when fast-packet messages are on the bus.
+     *
+     * \return Messages per second over the last window
+     */
+    float getMessagesPerSecond() const { return messagesPerSecond; }
+
+    /**
+     * \brief Get the bus utilization
+     *
+     * \return Share of MONITOR_BUS_BITRATE used over the last window (%)
+     */
+    float getBusLoad() const { return busLoad; }
+
+    /**
+     * \brief Get the highest bus utilization seen
+     *
+     * \return Peak of getBusLoad() since the last reset (%)
+     */
+    float getPeakBusLoad() const { return peakBusLoad; }
+
+    /**
+     * \brief Get the number of bits a frame occupies on the wire
+     *
+     * \param id 29-bit CAN identifier
+     * \param len Number of data bytes (0 to 8)
+     * \param data Data bytes
+     * \return Frame length in bits including stuff bits and interframe space
+     */
+    static uint16_t frameBits(uint32_t id, uint8_t len, const uint8_t* data);
+};
+
+#endif // N2K_STATS_H
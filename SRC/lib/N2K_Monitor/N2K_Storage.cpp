@@ -0,0 +1,480 @@
+/**
+ * \file N2K_Storage.cpp
+ * \brief Fixed-capacity device and PGN storage for the N2K_Monitor module
+ *
+ * This file implements the payload pool and the N2K_Monitor helpers that
+ * manage the flat device/PGN tables. Nothing in here allocates from the
+ * heap; all storage is reserved at startup:
+ *   - Device slots are indexed directly by source address
+ *   - PGN entries come from a shared pool and are found through a small
+ *     open-addressed hash table per device
+ *   - Raw payload bytes live in size-class blocks placed in DMAMEM
+ */
+
+#include "N2K_Monitor.h"
+
+#ifndef DMAMEM
+#define DMAMEM
+#endif
+
+/* ---------------------------------------------------------------------------
+ * Payload pool storage
+ *
+ * Most NMEA2000 traffic is single-frame (8 bytes), so the small class gets
+ * the most blocks. Fast-packet PGNs such as GNSS position (43 bytes) or AIS
+ * static data (up to ~80 bytes) use the middle classes, and the largest
+ * class covers the 223 byte fast-packet maximum.
+ * ------------------------------------------------------------------------- */
+
+#define PAYLOAD_SMALL_SIZE   8
+#define PAYLOAD_SMALL_COUNT  320
+#define PAYLOAD_MEDIUM_SIZE  32
+#define PAYLOAD_MEDIUM_COUNT 96
+#define PAYLOAD_LARGE_SIZE   96
+#define PAYLOAD_LARGE_COUNT  32
+#define PAYLOAD_MAX_SIZE     223
+#define PAYLOAD_MAX_COUNT    16
+
+DMAMEM static uint8_t payloadSmall[PAYLOAD_SMALL_SIZE * PAYLOAD_SMALL_COUNT];
+DMAMEM static uint8_t payloadMedium[PAYLOAD_MEDIUM_SIZE * PAYLOAD_MEDIUM_COUNT];
+DMAMEM static uint8_t payloadLarge[PAYLOAD_LARGE_SIZE * PAYLOAD_LARGE_COUNT];
+DMAMEM static uint8_t payloadMax[PAYLOAD_MAX_SIZE * PAYLOAD_MAX_COUNT];
+
+DMAMEM static uint16_t payloadSmallFree[PAYLOAD_SMALL_COUNT];
+DMAMEM static uint16_t payloadMediumFree[PAYLOAD_MEDIUM_COUNT];
+DMAMEM static uint16_t payloadLargeFree[PAYLOAD_LARGE_COUNT];
+DMAMEM static uint16_t payloadMaxFree[PAYLOAD_MAX_COUNT];
+
+/**
+ * \brief Construct the payload pool
+ *
+ * Wires each size class to its static storage and pushes every block
+ * index onto the class's free stack. DMAMEM is not zeroed at boot, so
+ * the free stacks must be filled here rather than relying on static
+ * initialization.
+ */
+N2K_PayloadPool::N2K_PayloadPool() {
+    classes[0] = {PAYLOAD_SMALL_SIZE,  PAYLOAD_SMALL_COUNT,  payloadSmall,  payloadSmallFree,  0};
+    classes[1] = {PAYLOAD_MEDIUM_SIZE, PAYLOAD_MEDIUM_COUNT, payloadMedium, payloadMediumFree, 0};
+    classes[2] = {PAYLOAD_LARGE_SIZE,  PAYLOAD_LARGE_COUNT,  payloadLarge,  payloadLargeFree,  0};
+    classes[3] = {PAYLOAD_MAX_SIZE,    PAYLOAD_MAX_COUNT,    payloadMax,    payloadMaxFree,    0};
+
+    for(int c = 0; c < N2K_PAYLOAD_CLASS_COUNT; c++) {
+        N2K_PayloadClass& pc = classes[c];
+        for(uint16_t i = 0; i < pc.blockCount; i++) {
+            // Push in reverse so block 0 is handed out first
+            pc.freeStack[i] = pc.blockCount - 1 - i;
+        }
+        pc.freeCount = pc.blockCount;
+    }
+    failedAllocations = 0;
+}
+
+/**
+ * \brief Allocate a payload block
+ *
+ * Walks the size classes from smallest to largest and pops a block from
+ * the first class that is big enough and still has free blocks.
+ *
+ * \param len Number of bytes required
+ * \param[out] capacity Size of the returned block, or 0 on failure
+ *
+ * \return Pointer to the block, or nullptr if no class could serve it
+ */
+uint8_t* N2K_PayloadPool::allocate(uint8_t len, uint8_t& capacity) {
+    for(int c = 0; c < N2K_PAYLOAD_CLASS_COUNT; c++) {
+        N2K_PayloadClass& pc = classes[c];
+        if(pc.blockSize < len || pc.freeCount == 0) continue;
+
+        uint16_t index = pc.freeStack[--pc.freeCount];
+        capacity = pc.blockSize;
+        return pc.storage + (uint32_t)index * pc.blockSize;
+    }
+
+    capacity = 0;
+    failedAllocations++;
+    return nullptr;
+}
+
+/**
+ * \brief Release a payload block
+ *
+ * The capacity identifies the size class; the block index is recovered
+ * from the pointer offset within that class's storage.
+ *
+ * \param block Pointer returned by allocate(), or nullptr
+ * \param capacity Capacity reported by allocate() for this block
+ */
+void N2K_PayloadPool::release(uint8_t* block, uint8_t capacity) {
+    if(block == nullptr) return;
+
+    for(int c = 0; c < N2K_PAYLOAD_CLASS_COUNT; c++) {
+        N2K_PayloadClass& pc = classes[c];
+        if(pc.blockSize != capacity) continue;
+
+        uint16_t index = (block - pc.storage) / pc.blockSize;
+        if(index < pc.blockCount && pc.freeCount < pc.blockCount) {
+            pc.freeStack[pc.freeCount++] = index;
+        }
+        return;
+    }
+}
+
+/**
+ * \brief Get the size of the block storage and the free stacks
+ *
+ * \return Bytes reserved in DMAMEM
+ */
+uint32_t N2K_PayloadPool::getReservedBytes() const {
+    uint32_t bytes = 0;
+    for(int c = 0; c < N2K_PAYLOAD_CLASS_COUNT; c++) {
+        const N2K_PayloadClass& pc = classes[c];
+        bytes += (uint32_t)pc.blockCount * (pc.blockSize + sizeof(uint16_t));
+    }
+    return bytes;
+}
+
+/**
+ * \brief Get the size of the blocks handed out plus the free stacks
+ *
+ * \return Bytes in use
+ */
+uint32_t N2K_PayloadPool::getUsedBytes() const {
+    uint32_t bytes = 0;
+    for(int c = 0; c < N2K_PAYLOAD_CLASS_COUNT; c++) {
+        const N2K_PayloadClass& pc = classes[c];
+        bytes += (uint32_t)(pc.blockCount - pc.freeCount) * pc.blockSize + pc.blockCount * sizeof(uint16_t);
+    }
+    return bytes;
+}
+
+/* ---------------------------------------------------------------------------
+ * Device / PGN tables
+ * ------------------------------------------------------------------------- */
+
+/**
+ * \brief Hash a PGN number into a device's lookup table
+ *
+ * Fibonacci hashing spreads the clustered PGN numbers (e.g. 127245-127258)
+ * evenly over the table.
+ *
+ * \param pgn PGN number to hash
+ * \return Slot index in the range 0 to MONITOR_PGN_SLOTS_PER_DEVICE-1
+ */
+static inline uint16_t hashPGN(uint32_t pgn) {
+    static_assert((MONITOR_PGN_SLOTS_PER_DEVICE & (MONITOR_PGN_SLOTS_PER_DEVICE - 1)) == 0,
+                  "MONITOR_PGN_SLOTS_PER_DEVICE must be a power of two");
+    static_assert(MONITOR_PGN_SLOTS_PER_DEVICE > MONITOR_MAX_PGNS_PER_DEVICE,
+                  "PGN lookup table needs at least one free slot");
+    return (uint16_t)((pgn * 2654435761UL) >> 16) & (MONITOR_PGN_SLOTS_PER_DEVICE - 1);
+}
+
+/**
+ * \brief Look up a PGN entry for a device
+ *
+ * Linear probing from the hashed slot until either the PGN or an empty
+ * slot is found. Since the table is never more than 75% full, the probe
+ * sequence is short.
+ *
+ * \param device Device to search
+ * \param pgn PGN number to find
+ *
+ * \return Pointer to the PGNData entry, or nullptr if not tracked
+ */
+PGNData* N2K_Monitor::findPGNEntry(DeviceInfo &device, uint32_t pgn) {
+    uint16_t slot = hashPGN(pgn);
+    for(int probe = 0; probe < MONITOR_PGN_SLOTS_PER_DEVICE; probe++) {
+        uint16_t index = device.pgnSlots[slot];
+        if(index == N2K_EMPTY_SLOT) return nullptr;
+        if(pgnPool[index].pgn == pgn) return &pgnPool[index];
+        slot = (slot + 1) & (MONITOR_PGN_SLOTS_PER_DEVICE - 1);
+    }
+    return nullptr;
+}
+
+/**
+ * \brief Attach a new PGN entry to a device
+ *
+ * Pops an entry from the PGN pool, inserts it into the device's lookup
+ * table and into its sorted pgnOrder list. The entry's fields vector
+ * keeps its previous capacity when recycled, so reuse does not allocate.
+ *
+ * \param device Device the PGN was received from
+ * \param pgn PGN number of the new entry
+ *
+ * \return Pointer to the new entry, or nullptr if the device's table or
+ *         the shared pool is full
+ */
+PGNData* N2K_Monitor::addPGNEntry(DeviceInfo &device, uint32_t pgn) {
+    if(device.pgnCount >= MONITOR_MAX_PGNS_PER_DEVICE || freePGNCount == 0) {
+        droppedPGNCount++;
+        return nullptr;
+    }
+
+    uint16_t index = freePGNEntries[--freePGNCount];
+    PGNData& pgnData = pgnPool[index];
+    pgnData.pgn = pgn;
+    pgnData.lastUpdate = 0;
+    pgnData.fields.clear();
+    pgnData.dataLen = 0;
+    pgnData.priority = 0;
+    pgnData.destination = 0xFF;
+    pgnData.stats.reset();
+    pgnData.transfers.reset();
+    pgnData.guard.reset();
+    pgnData.source = device.sourceAddress;
+    pgnData.sequence = 0;
+    pgnData.staleClass = getStaleClass(pgn);
+    pgnData.dirty = false;
+
+    // Address Claim is only removed together with its device
+    device.staleClasses |= (1 << pgnData.staleClass);
+    if(pgn != 60928) {
+        expiry.schedule(MONITOR_MAX_DEVICES + index, millis() + staleTimeouts[pgnData.staleClass]);
+    }
+
+    // Insert into the lookup table
+    uint16_t slot = hashPGN(pgn);
+    while(device.pgnSlots[slot] != N2K_EMPTY_SLOT) {
+        slot = (slot + 1) & (MONITOR_PGN_SLOTS_PER_DEVICE - 1);
+    }
+    device.pgnSlots[slot] = index;
+
+    // Insert into the PGN-ordered list
+    int pos = device.pgnCount;
+    while(pos > 0 && pgnPool[device.pgnOrder[pos - 1]].pgn > pgn) {
+        device.pgnOrder[pos] = device.pgnOrder[pos - 1];
+        pos--;
+    }
+    device.pgnOrder[pos] = index;
+    device.pgnCount++;
+    deviceChanged(device);
+
+    return &pgnData;
+}
+
+/**
+ * \brief Detach a PGN entry from a device
+ *
+ * Returns the payload block and the entry to their pools, cancels its
+ * expiry timer, removes the entry from pgnOrder and rebuilds the lookup
+ * table.
+ *
+ * \param device Device owning the entry
+ * \param orderIndex Position of the entry in DeviceInfo::pgnOrder
+ */
+void N2K_Monitor::removePGNEntry(DeviceInfo &device, int orderIndex) {
+    if(orderIndex < 0 || orderIndex >= device.pgnCount) return;
+
+    uint16_t index = device.pgnOrder[orderIndex];
+    PGNData& pgnData = pgnPool[index];
+    expiry.cancel(MONITOR_MAX_DEVICES + index);
+    payloadPool.release(pgnData.rawData, pgnData.rawCapacity);
+    pgnData.rawData = nullptr;
+    pgnData.rawCapacity = 0;
+    pgnData.dataLen = 0;
+    pgnData.fields.clear();
+    if(decodedIndex == index) decodedIndex = -1;
+    freePGNEntries[freePGNCount++] = index;
+
+    for(int i = orderIndex; i < device.pgnCount - 1; i++) {
+        device.pgnOrder[i] = device.pgnOrder[i + 1];
+    }
+    device.pgnCount--;
+
+    rebuildPGNSlots(device);
+    deviceChanged(device);
+    notifyWatch(device.sourceAddress, pgnData.pgn);
+}
+
+/**
+ * \brief Rebuild a device's PGN lookup table
+ *
+ * Clearing a slot in a linear-probing table would break the probe chain
+ * of any entry stored after it, so the table is rebuilt from pgnOrder
+ * instead. With at most MONITOR_MAX_PGNS_PER_DEVICE entries this is cheap,
+ * and it only happens when an entry expires.
+ *
+ * \param device Device whose table should be rebuilt
+ */
+void N2K_Monitor::rebuildPGNSlots(DeviceInfo &device) {
+    for(int i = 0; i < MONITOR_PGN_SLOTS_PER_DEVICE; i++) {
+        device.pgnSlots[i] = N2K_EMPTY_SLOT;
+    }
+    for(int i = 0; i < device.pgnCount; i++) {
+        uint16_t index = device.pgnOrder[i];
+        uint16_t slot = hashPGN(pgnPool[index].pgn);
+        while(device.pgnSlots[slot] != N2K_EMPTY_SLOT) {
+            slot = (slot + 1) & (MONITOR_PGN_SLOTS_PER_DEVICE - 1);
+        }
+        device.pgnSlots[slot] = index;
+    }
+}
+
+/**
+ * \brief Release a device slot
+ *
+ * Returns all of the device's PGN entries to the pool, cancels the
+ * device's expiry timer, marks the slot unused and removes the address
+ * from the sorted device list with a binary search.
+ *
+ * \param address Source address of the device to remove
+ */
+void N2K_Monitor::removeDevice(uint8_t address) {
+    if(address >= MONITOR_MAX_DEVICES || !devices[address].inUse) return;
+
+    DeviceInfo& device = devices[address];
+    while(device.pgnCount > 0) {
+        removePGNEntry(device, device.pgnCount - 1);
+    }
+    device.inUse = false;
+    expiry.cancel(address);
+    identities.release(address);
+    deviceChanged(device);
+
+    auto it = std::lower_bound(deviceList.begin(), deviceList.end(), address);
+    if(it != deviceList.end() && *it == address) {
+        deviceList.erase(it);
+    }
+}
+
+/**
+ * \brief Record an address claim
+ *
+ * Three cases:
+ * - The NAME held another address and its entry is still there: the
+ *   device moved, so the entry follows it with moveDevice().
+ * - Another NAME held the claimed address: that device lost the address
+ *   and will claim a new one, so the entry stored there is dropped rather
+ *   than mixed with the new owner's traffic. Its identity keeps the name.
+ * - Otherwise the claim only refreshes the identity.
+ *
+ * Every claim is also counted by the anomaly detector for claim storms.
+ *
+ * \param address Claimed address
+ * \param name NAME from the claim
+ */
+void N2K_Monitor::handleAddressClaim(uint8_t address, uint64_t name) {
+    const N2K_Identity* identity = identities.find(name);
+    if(identity != nullptr && identity->address != N2K_NO_ADDRESS && identity->address != address &&
+       devices[identity->address].inUse) {
+        moveDevice(identity->address, address);
+    } else {
+        const N2K_Identity* owner = identities.findByAddress(address);
+        if(owner != nullptr && owner->name != name) {
+            removeDevice(address);
+        }
+    }
+    uint32_t now = millis();
+    anomalies.recordClaim(identities.claim(name, address, now), name, address, now);
+}
+
+/**
+ * \brief Move a device entry to another address
+ *
+ * The slot is copied as a whole; the PGN entries stay where they are in
+ * the pool and only get their new owner, so nothing is allocated or
+ * rehashed. The device timer moves with it and watched field histories
+ * follow. Both slots change generation, so screens showing either redraw.
+ *
+ * \param from Current address of the entry
+ * \param to New address
+ */
+void N2K_Monitor::moveDevice(uint8_t from, uint8_t to) {
+    if(from >= MONITOR_MAX_DEVICES || to >= MONITOR_MAX_DEVICES || from == to) return;
+    if(!devices[from].inUse) return;
+    if(devices[to].inUse) removeDevice(to);
+
+    DeviceInfo& source = devices[from];
+    DeviceInfo& target = devices[to];
+    uint32_t generation = target.generation;
+    target = source;
+    target.sourceAddress = to;
+    target.generation = generation;
+    for(int i = 0; i < target.pgnCount; i++) {
+        pgnPool[target.pgnOrder[i]].source = to;
+    }
+
+    source.inUse = false;
+    source.pgnCount = 0;
+    for(int i = 0; i < MONITOR_PGN_SLOTS_PER_DEVICE; i++) {
+        source.pgnSlots[i] = N2K_EMPTY_SLOT;
+    }
+    expiry.cancel(from);
+    expiry.schedule(to, target.lastSeen + getDeviceTimeout(target));
+    history.moveSource(from, to);
+
+    auto it = std::lower_bound(deviceList.begin(), deviceList.end(), from);
+    if(it != deviceList.end() && *it == from) {
+        deviceList.erase(it);
+    }
+    deviceList.insert(std::lower_bound(deviceList.begin(), deviceList.end(), to), to);
+
+    deviceChanged(source);
+    deviceChanged(target);
+    movedDeviceCount++;
+}
+
+/**
+ * \brief Store a message payload in a PGN entry
+ *
+ * The existing block is reused whenever the payload fits. When it grows
+ * (e.g. a fast-packet PGN whose length varies), a larger block is taken
+ * before the old one is released so the previous data survives a failed
+ * allocation; in that case the payload is truncated to the old block.
+ *
+ * \param pgnData Entry to store the payload in
+ * \param data Payload bytes
+ * \param len Number of payload bytes
+ */
+void N2K_Monitor::storePayload(PGNData &pgnData, const unsigned char *data, int len) {
+    if(len > PAYLOAD_MAX_SIZE) len = PAYLOAD_MAX_SIZE;
+    if(len < 0) len = 0;
+
+    if(len > pgnData.rawCapacity) {
+        uint8_t capacity;
+        uint8_t* block = payloadPool.allocate(len, capacity);
+        if(block != nullptr) {
+            payloadPool.release(pgnData.rawData, pgnData.rawCapacity);
+            pgnData.rawData = block;
+            pgnData.rawCapacity = capacity;
+        } else {
+            len = pgnData.rawCapacity;
+        }
+    }
+
+    pgnData.dataLen = len;
+    if(len > 0) {
+        memcpy(pgnData.rawData, data, len);
+    }
+}
+
+/**
+ * \brief Get the memory the monitor holds
+ *
+ * Decoded fields live in one buffer inside the monitor, so everything
+ * except the payload pool and the two lists is sizeof(N2K_Monitor).
+ *
+ * \return Bytes reserved
+ */
+uint32_t N2K_Monitor::getReservedBytes() const {
+    uint32_t bytes = sizeof(N2K_Monitor) + payloadPool.getReservedBytes();
+    bytes += deviceList.capacity() * sizeof(uint8_t) + detectedPGNs.capacity() * sizeof(PGNInfo);
+    return bytes;
+}
+
+/**
+ * \brief Get the part of the monitor's memory holding data
+ *
+ * deviceList holds one address per device slot in use.
+ *
+ * \return Bytes in use
+ */
+uint32_t N2K_Monitor::getUsedBytes() const {
+    uint32_t bytes = sizeof(N2K_Monitor) - sizeof(devices) - sizeof(pgnPool);
+    bytes += deviceList.size() * (sizeof(DeviceInfo) + sizeof(uint8_t));
+    bytes += (MONITOR_MAX_PGN_ENTRIES - freePGNCount) * sizeof(PGNData);
+    bytes += payloadPool.getUsedBytes();
+    bytes += detectedPGNs.size() * sizeof(PGNInfo);
+    return bytes;
+}
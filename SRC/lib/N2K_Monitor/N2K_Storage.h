@@ -0,0 +1,128 @@
+/**
+ * \file N2K_Storage.h
+ * \brief Fixed-capacity payload storage for the N2K_Monitor module
+ *
+ * The network monitor never allocates from the heap while traffic is flowing.
+ * Device and PGN records live in fixed arrays inside N2K_Monitor, and the raw
+ * payload bytes of each PGN are kept in blocks handed out by N2K_PayloadPool.
+ *
+ * The pool is split into a few size classes so that a single-frame PGN only
+ * occupies an 8 byte block while fast-packet PGNs get a block sized closer to
+ * their real length. The block storage itself is placed in DMAMEM (RAM2) to
+ * keep the tightly coupled RAM1 free for the stack and hot variables.
+ */
+
+#ifndef N2K_STORAGE_H
+#define N2K_STORAGE_H
+
+#include <Arduino.h>
+
+/**
+ * \brief Number of payload size classes in N2K_PayloadPool
+ */
+#define N2K_PAYLOAD_CLASS_COUNT 4
+
+/**
+ * \struct N2K_PayloadClass
+ * \brief Describes one size class of the payload pool
+ *
+ * Free blocks are tracked with a stack of block indices, so allocating
+ * and releasing a block are both O(1).
+ */
+struct N2K_PayloadClass {
+    uint8_t blockSize;      ///< Size of each block in bytes
+    uint16_t blockCount;    ///< Number of blocks in this class
+    uint8_t* storage;       ///< Start of the block storage (blockSize * blockCount bytes)
+    uint16_t* freeStack;    ///< Indices of free blocks
+    uint16_t freeCount;     ///< Number of valid entries in freeStack
+};
+
+/**
+ * \class N2K_PayloadPool
+ * \brief Size-class block allocator for raw PGN payloads
+ *
+ * Hands out fixed-size blocks from statically reserved storage. A request is
+ * served from the smallest class that fits and falls back to larger classes
+ * when that class is exhausted.
+ *
+ * \note The block storage is static, so only one pool should exist. The
+ *       N2K_Monitor owns it.
+ */
+class N2K_PayloadPool {
+private:
+    N2K_PayloadClass classes[N2K_PAYLOAD_CLASS_COUNT];  ///< Size classes, smallest first
+    uint32_t failedAllocations;                          ///< Requests that could not be served
+
+public:
+    /**
+     * \brief Construct the pool and mark every block as free
+     */
+    N2K_PayloadPool();
+
+    /**
+     * \brief Allocate a block that can hold at least len bytes
+     *
+     * \param len Number of bytes required (1-223)
+     * \param[out] capacity Set to the size of the returned block, or 0
+     * \return Pointer to the block, or nullptr if no class can serve it
+     */
+    uint8_t* allocate(uint8_t len, uint8_t& capacity);
+
+    /**
+     * \brief Return a block to the pool
+     *
+     * \param block Pointer previously returned by allocate() (nullptr is ignored)
+     * \param capacity Capacity reported by allocate() for this block
+     */
+    void release(uint8_t* block, uint8_t capacity);
+
+    /**
+     * \brief Get the block size of a size class
+     *
+     * \param sizeClass Index of the class (0 to N2K_PAYLOAD_CLASS_COUNT-1)
+     * \return Block size in bytes
+     */
+    uint8_t getBlockSize(int sizeClass) { return classes[sizeClass].blockSize; }
+
+    /**
+     * \brief Get the total number of blocks in a size class
+     *
+     * \param sizeClass Index of the class (0 to N2K_PAYLOAD_CLASS_COUNT-1)
+     * \return Number of blocks
+     */
+    uint16_t getBlockCount(int sizeClass) { return classes[sizeClass].blockCount; }
+
+    /**
+     * \brief Get the number of free blocks in a size class
+     *
+     * \param sizeClass Index of the class (0 to N2K_PAYLOAD_CLASS_COUNT-1)
+     * \return Number of free blocks
+     */
+    uint16_t getFreeCount(int sizeClass) { return classes[sizeClass].freeCount; }
+
+    /**
+     * \brief Get the number of allocation requests that failed
+     *
+     * \return Count of failed allocations since startup
+     */
+    uint32_t getFailedAllocations() { return failedAllocations; }
+
+    /**
+     * \brief Get the size of the block storage and the free stacks
+     *
+     * \return Bytes reserved in DMAMEM
+     */
+    uint32_t getReservedBytes() const;
+
+    /**
+     * \brief Get the size of the blocks handed out plus the free stacks
+     *
+     * Counts whole blocks, so it includes the slack between a payload and
+     * the block size of its class.
+     *
+     * \return Bytes in use
+     */
+    uint32_t getUsedBytes() const;
+};
+
+#endif // N2K_STORAGE_H
@@ -0,0 +1,410 @@
+/**
+ * \file N2K_Transfers.cpp
+ * \brief Implementation of the fast-packet and ISO transport reassembly diagnostics
+ *
+ * Contains the per-PGN transfer statistics, the session table and the
+ * frame handling of both protocols.
+ */
+
+#include "N2K_Transfers.h"
+#include <PGN_Helpers.h>
+
+static_assert((MONITOR_TRANSFER_SESSIONS & (MONITOR_TRANSFER_SESSIONS - 1)) == 0 &&
+              MONITOR_TRANSFER_SESSIONS <= 65536,
+              "MONITOR_TRANSFER_SESSIONS must be a power of two that fits 16 bits");
+static_assert(MONITOR_TRANSFER_PROBES <= MONITOR_TRANSFER_SESSIONS,
+              "MONITOR_TRANSFER_PROBES can't exceed the table");
+
+/// ISO transport connection management (TP.CM)
+static constexpr uint32_t PGN_TP_CM = 60416;
+/// ISO transport data transfer (TP.DT)
+static constexpr uint32_t PGN_TP_DT = 60160;
+
+/// TP.CM control bytes
+static constexpr uint8_t TP_CM_RTS = 16;
+static constexpr uint8_t TP_CM_CTS = 17;
+static constexpr uint8_t TP_CM_BAM = 32;
+static constexpr uint8_t TP_CM_ABORT = 255;
+
+/// Largest fast-packet payload: 6 bytes in frame 0 and 7 in each of frames 1-31
+static constexpr uint8_t FAST_PACKET_MAX_LEN = 223;
+
+/* ---------------------------------------------------------------------------
+ * N2K_TransferStats
+ * ------------------------------------------------------------------------- */
+
+void N2K_TransferStats::reset() {
+    completed = 0;
+    timedOut = 0;
+    corrupted = 0;
+    ewmaLatency = 0;
+    maxLatency = 0;
+}
+
+void N2K_TransferStats::record(const TransferEvent& event) {
+    switch(event.result) {
+        case TRANSFER_COMPLETED: {
+            float latency = event.latency / 1000.0f;
+            if(completed == 0) {
+                ewmaLatency = latency;
+            } else {
+                ewmaLatency += MONITOR_STATS_EWMA_ALPHA * (latency - ewmaLatency);
+            }
+            if(latency > maxLatency) maxLatency = latency;
+            completed++;
+            break;
+        }
+        case TRANSFER_TIMED_OUT:
+            timedOut++;
+            break;
+        case TRANSFER_CORRUPTED:
+            corrupted++;
+            break;
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Session table
+ * ------------------------------------------------------------------------- */
+
+N2K_TransferTracker::N2K_TransferTracker() {
+    reset();
+}
+
+void N2K_TransferTracker::reset() {
+    for(int i = 0; i < MONITOR_TRANSFER_SESSIONS; i++) {
+        sessions[i].kind = TRANSFER_FREE;
+    }
+    expireCursor = 0;
+    activeCount = 0;
+    resetStats();
+}
+
+void N2K_TransferTracker::resetStats() {
+    completed = 0;
+    timedOut = 0;
+    missingFrames = 0;
+    outOfOrder = 0;
+    collisions = 0;
+    orphans = 0;
+    aborted = 0;
+    badLength = 0;
+    untracked = 0;
+    peakActive = activeCount;
+    maxLatency = 0;
+    latencySum = 0;
+}
+
+uint16_t N2K_TransferTracker::hashKey(TransferKind kind, uint8_t source, uint8_t key, uint32_t pgn) {
+    // FNV-1a over the key fields, folded to the table size
+    uint32_t hash = 2166136261u;
+    uint32_t parts[4] = {kind, source, key, pgn};
+    for(uint32_t part : parts) {
+        hash = (hash ^ part) * 16777619u;
+    }
+    return (uint16_t)((hash ^ (hash >> 16)) & (MONITOR_TRANSFER_SESSIONS - 1));
+}
+
+/**
+ * \brief Find the session of a key
+ *
+ * Free slots don't end the probe: closing a session frees its slot in
+ * place, so a session further along the probe sequence may still follow.
+ *
+ * \param kind Protocol
+ * \param source Sender address
+ * \param key Sequence id or destination address
+ * \param pgn PGN, ignored for ISO TP
+ * \return Session, or nullptr if none is in progress
+ */
+N2K_TransferTracker::Session* N2K_TransferTracker::find(TransferKind kind, uint8_t source,
+                                                        uint8_t key, uint32_t pgn) {
+    if(kind == TRANSFER_ISO_TP) pgn = 0;
+    uint16_t slot = hashKey(kind, source, key, pgn);
+    for(int n = 0; n < MONITOR_TRANSFER_PROBES; n++) {
+        Session& session = sessions[(slot + n) & (MONITOR_TRANSFER_SESSIONS - 1)];
+        if(session.kind == kind && session.source == source && session.key == key &&
+           (kind == TRANSFER_ISO_TP || session.pgn == pgn)) {
+            return &session;
+        }
+    }
+    return nullptr;
+}
+
+N2K_TransferTracker::Session* N2K_TransferTracker::open(TransferKind kind, uint8_t source,
+                                                        uint8_t key, uint32_t pgn) {
+    uint16_t slot = hashKey(kind, source, key, kind == TRANSFER_ISO_TP ? 0 : pgn);
+    for(int n = 0; n < MONITOR_TRANSFER_PROBES; n++) {
+        Session& session = sessions[(slot + n) & (MONITOR_TRANSFER_SESSIONS - 1)];
+        if(session.kind != TRANSFER_FREE) continue;
+
+        session.kind = kind;
+        session.source = source;
+        session.key = key;
+        session.pgn = pgn;
+        activeCount++;
+        if(activeCount > peakActive) peakActive = activeCount;
+        return &session;
+    }
+    untracked++;
+    return nullptr;
+}
+
+void N2K_TransferTracker::close(Session* session, TransferResult result, TransferEvent& event) {
+    event.pgn = session->pgn;
+    event.source = session->source;
+    event.result = result;
+    event.latency = 0;
+
+    if(result == TRANSFER_COMPLETED) {
+        event.latency = session->lastMicros - session->startMicros;
+        completed++;
+        latencySum += event.latency;
+        if(event.latency > maxLatency) maxLatency = event.latency;
+    } else if(result == TRANSFER_TIMED_OUT) {
+        timedOut++;
+    }
+
+    session->kind = TRANSFER_FREE;
+    activeCount--;
+}
+
+bool N2K_TransferTracker::addFrame(uint32_t id, uint8_t len, const uint8_t* data,
+                                   uint32_t timestamp, TransferEvent& event) {
+    uint8_t source = id & 0xFF;
+    uint8_t pf = (id >> 16) & 0xFF;
+    uint32_t pgn = (id >> 8) & 0x3FFFF;
+    uint8_t destination = 0xFF;
+
+    // PDU1: the PS byte is the destination, not part of the PGN
+    if(pf < 240) {
+        destination = pgn & 0xFF;
+        pgn &= 0x3FF00;
+    }
+
+    if(pgn == PGN_TP_CM) return addTpConnectionFrame(source, destination, len, data, timestamp, event);
+    if(pgn == PGN_TP_DT) return addTpDataFrame(source, destination, len, data, timestamp, event);
+    if(isFastPacketPGN(pgn)) return addFastPacketFrame(source, pgn, len, data, timestamp, event);
+    return false;
+}
+
+/* ---------------------------------------------------------------------------
+ * Fast packets
+ * ------------------------------------------------------------------------- */
+
+/**
+ * \brief Follow a fast-packet frame
+ *
+ * Byte 0 holds the sequence id (bits 7-5) and the frame counter (bits 4-0).
+ * Frame 0 carries the total length in byte 1. A frame 0 arriving while the
+ * same sequence id is still open means the sender restarted it, and the
+ * unfinished transfer is reported as corrupted before the new one opens;
+ * the new one is not reported on the same frame, it opens silently.
+ *
+ * \param source Sender address
+ * \param pgn PGN of the frame
+ * \param len Number of data bytes
+ * \param data Data bytes
+ * \param timestamp Receive time (micros)
+ * \param[out] event Receives a finished transfer
+ * \return true if a transfer ended
+ */
+bool N2K_TransferTracker::addFastPacketFrame(uint8_t source, uint32_t pgn, uint8_t len,
+                                             const uint8_t* data, uint32_t timestamp,
+                                             TransferEvent& event) {
+    if(len < 1) return false;
+    uint8_t sequence = data[0] >> 5;
+    uint8_t counter = data[0] & 0x1F;
+    Session* session = find(TRANSFER_FAST_PACKET, source, sequence, pgn);
+    bool ended = false;
+
+    if(counter == 0) {
+        if(session != nullptr) {
+            collisions++;
+            close(session, TRANSFER_CORRUPTED, event);
+            ended = true;
+        }
+        if(len < 2) return ended;
+
+        uint8_t total = data[1];
+        if(total > FAST_PACKET_MAX_LEN) {
+            badLength++;
+            return ended;
+        }
+        // Frame 0 carries 6 payload bytes, every further frame 7
+        uint8_t frames = (total <= 6) ? 1 : 1 + (total - 6 + 7 - 1) / 7;
+        if(frames == 1) return ended;   // Fits one frame, nothing to reassemble
+
+        session = open(TRANSFER_FAST_PACKET, source, sequence, pgn);
+        if(session == nullptr) return ended;
+        session->startMicros = timestamp;
+        session->lastMicros = timestamp;
+        session->frames = frames;
+        session->nextFrame = 1;
+        return ended;
+    }
+
+    if(session == nullptr) {
+        orphans++;
+        return false;
+    }
+
+    if(counter != session->nextFrame) {
+        if(counter > session->nextFrame) {
+            missingFrames++;
+        } else {
+            outOfOrder++;
+        }
+        close(session, TRANSFER_CORRUPTED, event);
+        return true;
+    }
+
+    session->lastMicros = timestamp;
+    session->nextFrame++;
+    if(session->nextFrame < session->frames) return false;
+
+    close(session, TRANSFER_COMPLETED, event);
+    return true;
+}
+
+/* ---------------------------------------------------------------------------
+ * ISO transport
+ * ------------------------------------------------------------------------- */
+
+/**
+ * \brief Follow an ISO transport connection management frame (TP.CM)
+ *
+ * RTS and BAM open a session keyed by (sender, destination); BAM goes to
+ * the global address 255. CTS comes from the receiver, so it is looked up
+ * with the addresses swapped, and moves the expected packet number back
+ * when the receiver asks for a retransmit. Abort may come from either side.
+ *
+ * \param source Sender address
+ * \param destination Destination address
+ * \param len Number of data bytes
+ * \param data Data bytes
+ * \param timestamp Receive time (micros)
+ * \param[out] event Receives a finished transfer
+ * \return true if a transfer ended
+ */
+bool N2K_TransferTracker::addTpConnectionFrame(uint8_t source, uint8_t destination, uint8_t len,
+                                               const uint8_t* data, uint32_t timestamp,
+                                               TransferEvent& event) {
+    if(len < 8) return false;
+    uint8_t control = data[0];
+
+    if(control == TP_CM_RTS || control == TP_CM_BAM) {
+        uint8_t key = (control == TP_CM_BAM) ? 0xFF : destination;
+        uint16_t size = data[1] | (data[2] << 8);
+        uint8_t packets = data[3];
+        uint32_t pgn = data[5] | ((uint32_t)data[6] << 8) | ((uint32_t)(data[7] & 0x03) << 16);
+
+        bool ended = false;
+        Session* session = find(TRANSFER_ISO_TP, source, key, 0);
+        if(session != nullptr) {
+            collisions++;
+            close(session, TRANSFER_CORRUPTED, event);
+            ended = true;
+        }
+
+        // 7 bytes per packet, 9 to 1785 bytes in total
+        if(size < 9 || size > 1785 || packets == 0 || packets != (size + 6) / 7) {
+            badLength++;
+            return ended;
+        }
+
+        session = open(TRANSFER_ISO_TP, source, key, pgn);
+        if(session == nullptr) return ended;
+        session->startMicros = timestamp;
+        session->lastMicros = timestamp;
+        session->frames = packets;
+        session->nextFrame = 1;
+        return ended;
+    }
+
+    if(control == TP_CM_CTS) {
+        Session* session = find(TRANSFER_ISO_TP, destination, source, 0);
+        if(session == nullptr) return false;
+        session->lastMicros = timestamp;
+        // Packet count 0 holds the connection open without asking for data
+        if(data[1] > 0 && data[2] > 0) session->nextFrame = data[2];
+        return false;
+    }
+
+    if(control == TP_CM_ABORT) {
+        Session* session = find(TRANSFER_ISO_TP, source, destination, 0);
+        if(session == nullptr) session = find(TRANSFER_ISO_TP, destination, source, 0);
+        if(session == nullptr) return false;
+        aborted++;
+        close(session, TRANSFER_CORRUPTED, event);
+        return true;
+    }
+
+    // End of message acknowledgements need no action, the last TP.DT closed the session
+    return false;
+}
+
+/**
+ * \brief Follow an ISO transport data frame (TP.DT)
+ *
+ * Byte 0 is the packet number, counting from 1. A repeated packet number
+ * is only out of order when the receiver didn't ask for it with a CTS.
+ *
+ * \param source Sender address
+ * \param destination Destination address
+ * \param len Number of data bytes
+ * \param data Data bytes
+ * \param timestamp Receive time (micros)
+ * \param[out] event Receives a finished transfer
+ * \return true if a transfer ended
+ */
+bool N2K_TransferTracker::addTpDataFrame(uint8_t source, uint8_t destination, uint8_t len,
+                                         const uint8_t* data, uint32_t timestamp,
+                                         TransferEvent& event) {
+    if(len < 1) return false;
+    uint8_t packet = data[0];
+    Session* session = find(TRANSFER_ISO_TP, source, destination, 0);
+    if(session == nullptr) {
+        orphans++;
+        return false;
+    }
+
+    if(packet != session->nextFrame) {
+        if(packet > session->nextFrame) {
+            missingFrames++;
+        } else {
+            outOfOrder++;
+        }
+        close(session, TRANSFER_CORRUPTED, event);
+        return true;
+    }
+
+    session->lastMicros = timestamp;
+    if(packet < session->frames) {
+        session->nextFrame++;
+        return false;
+    }
+
+    close(session, TRANSFER_COMPLETED, event);
+    return true;
+}
+
+/* ---------------------------------------------------------------------------
+ * Timeouts
+ * ------------------------------------------------------------------------- */
+
+bool N2K_TransferTracker::expire(uint32_t nowMicros, TransferEvent& event) {
+    while(expireCursor < MONITOR_TRANSFER_SESSIONS) {
+        Session& session = sessions[expireCursor++];
+        if(session.kind == TRANSFER_FREE) continue;
+
+        uint32_t timeout = (session.kind == TRANSFER_FAST_PACKET) ? MONITOR_FAST_PACKET_TIMEOUT_MS
+                                                                  : MONITOR_TP_TIMEOUT_MS;
+        if(nowMicros - session.lastMicros > timeout * 1000) {
+            close(&session, TRANSFER_TIMED_OUT, event);
+            return true;
+        }
+    }
+    expireCursor = 0;
+    return false;
+}
@@ -0,0 +1,331 @@
+/**
+ * \file N2K_Transfers.h
+ * \brief Fast-packet and ISO transport reassembly diagnostics for the N2K_Monitor module
+ *
+ * The monitor only ever sees messages the library managed to reassemble,
+ * so broken multi-frame transfers used to be invisible. N2K_TransferTracker
+ * follows them on the raw CAN2 frames instead:
+ * - Fast packets, per (source, PGN, sequence id). Frame 0 carries the
+ *   total length, so the tracker knows how many frames to expect.
+ * - ISO transport sessions (TP.CM BAM or RTS/CTS, then TP.DT), per
+ *   (source, destination).
+ *
+ * Each transfer ends as completed, timed out or corrupted. Corrupted ones
+ * are split by cause: missing frames, frames out of order or repeated, a
+ * new transfer starting on top of an unfinished one with the same key
+ * (sequence collision), a continuation frame with no start, an ISO abort
+ * or an impossible length. Completed transfers report their reassembly
+ * latency, first to last frame.
+ *
+ * Sessions live in a fixed, open-addressed table of
+ * MONITOR_TRANSFER_SESSIONS slots with bounded probing, so every frame is
+ * constant time and nothing is allocated.
+ */
+
+#ifndef N2K_TRANSFERS_H
+#define N2K_TRANSFERS_H
+
+#include <Arduino.h>
+#include "constants.h"
+
+/**
+ * \enum TransferKind
+ * \brief Multi-frame protocol of a session
+ */
+enum TransferKind : uint8_t {
+    TRANSFER_FREE,          ///< Slot is unused
+    TRANSFER_FAST_PACKET,   ///< NMEA2000 fast packet
+    TRANSFER_ISO_TP         ///< ISO 11783-3 transport protocol
+};
+
+/**
+ * \enum TransferResult
+ * \brief How a transfer ended
+ */
+enum TransferResult : uint8_t {
+    TRANSFER_COMPLETED,     ///< All frames arrived in order
+    TRANSFER_TIMED_OUT,     ///< The sender went quiet before the last frame
+    TRANSFER_CORRUPTED      ///< Frames went missing, out of order or collided
+};
+
+/**
+ * \struct TransferEvent
+ * \brief A transfer that just ended, for attribution to its PGN
+ */
+struct TransferEvent {
+    uint32_t pgn;           ///< PGN that was transferred
+    uint32_t latency;       ///< First to last frame (micros), completed transfers only
+    uint8_t source;         ///< Sender address
+    TransferResult result;  ///< How it ended
+};
+
+/**
+ * \class N2K_TransferStats
+ * \brief Transfer outcomes of one PGN sent by one device
+ */
+class N2K_TransferStats {
+private:
+    uint32_t completed;     ///< Transfers reassembled
+    uint32_t timedOut;      ///< Transfers that timed out
+    uint32_t corrupted;     ///< Transfers that broke
+    float ewmaLatency;      ///< Smoothed reassembly latency (ms)
+    float maxLatency;       ///< Longest reassembly latency seen (ms)
+
+public:
+    /**
+     * \brief Construct empty statistics
+     */
+    N2K_TransferStats() { reset(); }
+
+    /**
+     * \brief Clear all statistics
+     */
+    void reset();
+
+    /**
+     * \brief Account for a finished transfer
+     *
+     * \param event The transfer that ended
+     */
+    void record(const TransferEvent& event);
+
+    /**
+     * \brief Check whether this PGN was seen as a multi-frame transfer
+     *
+     * \return true once any transfer has ended
+     */
+    bool hasTransfers() const { return completed + timedOut + corrupted > 0; }
+
+    /**
+     * \brief Get the number of completed transfers
+     *
+     * \return Transfers reassembled
+     */
+    uint32_t getCompleted() const { return completed; }
+
+    /**
+     * \brief Get the number of timed out transfers
+     *
+     * \return Transfers whose last frame never arrived
+     */
+    uint32_t getTimedOut() const { return timedOut; }
+
+    /**
+     * \brief Get the number of corrupted transfers
+     *
+     * \return Transfers with missing, out of order or colliding frames
+     */
+    uint32_t getCorrupted() const { return corrupted; }
+
+    /**
+     * \brief Get the smoothed reassembly latency
+     *
+     * \return Latency in milliseconds, 0 before the first completed transfer
+     */
+    float getLatency() const { return ewmaLatency; }
+
+    /**
+     * \brief Get the longest reassembly latency
+     *
+     * \return Latency in milliseconds
+     */
+    float getMaxLatency() const { return maxLatency; }
+};
+
+/**
+ * \class N2K_TransferTracker
+ * \brief Session table following fast packets and ISO transport sessions
+ */
+class N2K_TransferTracker {
+private:
+    /**
+     * \struct Session
+     * \brief One transfer in progress
+     */
+    struct Session {
+        uint32_t pgn;           ///< PGN being transferred
+        uint32_t startMicros;   ///< Timestamp of the first frame
+        uint32_t lastMicros;    ///< Timestamp of the latest frame
+        uint8_t source;         ///< Sender address
+        uint8_t key;            ///< Fast packet: sequence id, ISO TP: destination address
+        TransferKind kind;      ///< Protocol, TRANSFER_FREE if the slot is unused
+        uint8_t frames;         ///< Frames (fast packet) or packets (ISO TP) expected
+        uint8_t nextFrame;      ///< Frame counter or packet number expected next
+    };
+
+    Session sessions[MONITOR_TRANSFER_SESSIONS];   ///< Session table
+    uint16_t expireCursor;      ///< Slot the next expire() scan continues at
+    uint16_t activeCount;       ///< Sessions in progress
+
+    /* Totals, since the last reset */
+    uint32_t completed;         ///< Transfers reassembled
+    uint32_t timedOut;          ///< Transfers that timed out
+    uint32_t missingFrames;     ///< Transfers that skipped a frame
+    uint32_t outOfOrder;        ///< Transfers with a frame repeated or out of order
+    uint32_t collisions;        ///< Transfers restarted by a new one with the same key
+    uint32_t orphans;           ///< Continuation frames without a transfer
+    uint32_t aborted;           ///< ISO transport sessions aborted
+    uint32_t badLength;         ///< Transfers announcing an impossible length
+    uint32_t untracked;         ///< Transfers not followed because the table was full
+    uint16_t peakActive;        ///< Most sessions in progress at once
+    uint32_t maxLatency;        ///< Longest reassembly latency (micros)
+    uint64_t latencySum;        ///< Sum of all reassembly latencies (micros)
+
+    /**
+     * \brief Get the first slot probed for a key
+     *
+     * \param kind Protocol
+     * \param source Sender address
+     * \param key Sequence id or destination address
+     * \param pgn PGN (fast packets only, 0 for ISO TP)
+     * \return Slot index
+     */
+    static uint16_t hashKey(TransferKind kind, uint8_t source, uint8_t key, uint32_t pgn);
+
+    /**
+     * \brief Find the session of a key
+     *
+     * \param kind Protocol
+     * \param source Sender address
+     * \param key Sequence id or destination address
+     * \param pgn PGN, ignored for ISO TP
+     * \return Session, or nullptr if none is in progress
+     */
+    Session* find(TransferKind kind, uint8_t source, uint8_t key, uint32_t pgn);
+
+    /**
+     * \brief Open a session in a free slot
+     *
+     * \param kind Protocol
+     * \param source Sender address
+     * \param key Sequence id or destination address
+     * \param pgn PGN being transferred
+     * \return Session, or nullptr if the probed slots are all taken
+     */
+    Session* open(TransferKind kind, uint8_t source, uint8_t key, uint32_t pgn);
+
+    /**
+     * \brief End a session and describe the result
+     *
+     * \param session Session to close
+     * \param result How it ended
+     * \param[out] event Receives the finished transfer
+     */
+    void close(Session* session, TransferResult result, TransferEvent& event);
+
+    /**
+     * \brief Follow a fast-packet frame
+     *
+     * \param source Sender address
+     * \param pgn PGN of the frame
+     * \param len Number of data bytes
+     * \param data Data bytes
+     * \param timestamp Receive time (micros)
+     * \param[out] event Receives a finished transfer
+     * \return true if a transfer ended
+     */
+    bool addFastPacketFrame(uint8_t source, uint32_t pgn, uint8_t len, const uint8_t* data,
+                            uint32_t timestamp, TransferEvent& event);
+
+    /**
+     * \brief Follow an ISO transport connection management frame (TP.CM)
+     *
+     * \param source Sender address
+     * \param destination Destination address
+     * \param len Number of data bytes
+     * \param data Data bytes
+     * \param timestamp Receive time (micros)
+     * \param[out] event Receives a finished transfer
+     * \return true if a transfer ended
+     */
+    bool addTpConnectionFrame(uint8_t source, uint8_t destination, uint8_t len, const uint8_t* data,
+                              uint32_t timestamp, TransferEvent& event);
+
+    /**
+     * \brief Follow an ISO transport data frame (TP.DT)
+     *
+     * \param source Sender address
+     * \param destination Destination address
+     * \param len Number of data bytes
+     * \param data Data bytes
+     * \param timestamp Receive time (micros)
+     * \param[out] event Receives a finished transfer
+     * \return true if a transfer ended
+     */
+    bool addTpDataFrame(uint8_t source, uint8_t destination, uint8_t len, const uint8_t* data,
+                        uint32_t timestamp, TransferEvent& event);
+
+public:
+    /**
+     * \brief Construct an empty tracker
+     */
+    N2K_TransferTracker();
+
+    /**
+     * \brief Follow a frame seen on the bus
+     *
+     * Frames that are neither fast packets nor ISO transport return right
+     * after the PGN lookup.
+     *
+     * \param id 29-bit CAN identifier
+     * \param len Number of data bytes (0 to 8)
+     * \param data Data bytes
+     * \param timestamp Receive time (micros)
+     * \param[out] event Receives the transfer that ended, if any
+     * \return true if a transfer ended with this frame
+     */
+    bool addFrame(uint32_t id, uint8_t len, const uint8_t* data, uint32_t timestamp, TransferEvent& event);
+
+    /**
+     * \brief Time out one stalled session
+     *
+     * Call repeatedly until it returns false. Over all calls of one round
+     * every slot is visited once.
+     *
+     * \param nowMicros Current time (micros)
+     * \param[out] event Receives the transfer that timed out
+     * \return true if a transfer timed out, false when the round is done
+     */
+    bool expire(uint32_t nowMicros, TransferEvent& event);
+
+    /**
+     * \brief Forget all sessions and clear the totals
+     */
+    void reset();
+
+    /**
+     * \brief Clear the totals, keeping the sessions in progress
+     */
+    void resetStats();
+
+    uint32_t getCompleted() const { return completed; }         ///< \return Transfers reassembled
+    uint32_t getTimedOut() const { return timedOut; }           ///< \return Transfers that timed out
+    uint32_t getMissingFrames() const { return missingFrames; } ///< \return Transfers that skipped a frame
+    uint32_t getOutOfOrder() const { return outOfOrder; }       ///< \return Transfers with a frame out of order
+    uint32_t getCollisions() const { return collisions; }       ///< \return Transfers restarted by one with the same key
+    uint32_t getOrphans() const { return orphans; }             ///< \return Continuation frames without a transfer
+    uint32_t getAborted() const { return aborted; }             ///< \return ISO transport sessions aborted
+    uint32_t getBadLength() const { return badLength; }         ///< \return Transfers with an impossible length
+    uint32_t getUntracked() const { return untracked; }         ///< \return Transfers not followed, table full
+    uint16_t getActiveCount() const { return activeCount; }     ///< \return Sessions in progress
+    uint16_t getPeakActive() const { return peakActive; }       ///< \return Most sessions in progress at once
+    uint32_t getMaxLatency() const { return maxLatency; }       ///< \return Longest reassembly latency (micros)
+
+    /**
+     * \brief Get the number of corrupted transfers
+     *
+     * \return Sum of all corruption causes
+     */
+    uint32_t getCorrupted() const {
+        return missingFrames + outOfOrder + collisions + orphans + aborted + badLength;
+    }
+
+    /**
+     * \brief Get the mean reassembly latency
+     *
+     * \return Latency in microseconds, 0 before the first completed transfer
+     */
+    uint32_t getMeanLatency() const { return completed > 0 ? (uint32_t)(latencySum / completed) : 0; }
+};
+
+#endif // N2K_TRANSFERS_H
@@ -0,0 +1,383 @@
+/**
+ * \file N2K_Replay.cpp
+ * \brief Implementation of the log file player
+ *
+ * Contains the log scan, the staging reader and the playback interrupt.
+ */
+
+#include "N2K_Replay.h"
+
+#ifndef DMAMEM
+#define DMAMEM
+#endif
+
+static const uint8_t LOG_MAGIC[7] = {'N', 'E', 'M', 'O', 'L', 'O', 'G'};
+
+/**
+ * \brief Staging ring of the player
+ *
+ * CAPTURE_RING_SIZE frames that are only touched while a log plays, and
+ * then read ahead of their due time, so they live in DMAMEM (RAM2) rather
+ * than in the DTCM the capture path needs. DMAMEM is not zeroed at startup;
+ * the ring's constructor sets its indices.
+ */
+DMAMEM static CAN_FrameRing replayRing;
+
+N2K_Replay* N2K_Replay::instance = nullptr;
+
+N2K_Replay::N2K_Replay(CAN_Capture* monitorInterface, CAN_TxTap* transmitInterface, N2K_Logger* frameLogger)
+    : ring(replayRing), loaderDone(false) {
+    monitorBus = monitorInterface;
+    transmitBus = transmitInterface;
+    logger = frameLogger;
+
+    logCount = 0;
+    selectedLog = 0;
+
+    target = REPLAY_TARGET_MONITOR;
+    speed = REPLAY_SPEED_1X;
+    state = REPLAY_STOPPED;
+    wasReceivePaused = false;
+
+    fileDone = true;
+    haveLastTimestamp = false;
+    lastTimestamp = 0;
+    delayRemainder = 0;
+    fileSize = 0;
+    filePosition = 0;
+
+    haveNextFrame = false;
+    nextDue = 0;
+    starved = false;
+
+    framesPlayed = 0;
+    framesLate = 0;
+    maxLateness = 0;
+    underruns = 0;
+}
+
+/* ---------------------------------------------------------------------------
+ * Log selection
+ * ------------------------------------------------------------------------- */
+
+uint8_t N2K_Replay::scanLogs() {
+    logCount = 0;
+    selectedLog = 0;
+
+    FS* fs = logger != nullptr ? logger->getFileSystem() : nullptr;
+    if(fs == nullptr) return 0;
+
+    File root = fs->open("/");
+    if(!root) return 0;
+
+    while(true) {
+        File entry = root.openNextFile();
+        if(!entry) break;
+
+        unsigned index = 0;
+        int consumed = 0;
+        const char* name = entry.name();
+        bool isLog = !entry.isDirectory() &&
+                     sscanf(name, "NEMO%4u.LOG%n", &index, &consumed) == 1 &&
+                     consumed == (int)strlen(name) && index > 0;
+        entry.close();
+        if(!isLog) continue;
+
+        // Keep the newest logs, sorted ascending
+        if(logCount == REPLAY_MAX_FILES) {
+            if(index <= logIndices[0]) continue;
+            memmove(&logIndices[0], &logIndices[1], (REPLAY_MAX_FILES - 1) * sizeof(logIndices[0]));
+            logCount--;
+        }
+        uint8_t pos = logCount;
+        while(pos > 0 && logIndices[pos - 1] > index) {
+            logIndices[pos] = logIndices[pos - 1];
+            pos--;
+        }
+        logIndices[pos] = index;
+        logCount++;
+    }
+    root.close();
+
+    if(logCount > 0) selectedLog = logCount - 1;
+    return logCount;
+}
+
+void N2K_Replay::selectNextLog() {
+    if(state == REPLAY_PLAYING || logCount == 0) return;
+    selectedLog = (selectedLog + 1) % logCount;
+}
+
+void N2K_Replay::getSelectedLogName(char* out) const {
+    if(logCount == 0) {
+        out[0] = '\0';
+        return;
+    }
+    N2K_Logger::makeFileName(logIndices[selectedLog], out);
+}
+
+void N2K_Replay::setTarget(ReplayTarget replayTarget) {
+    if(state == REPLAY_PLAYING || replayTarget >= REPLAY_TARGET_COUNT) return;
+    target = replayTarget;
+}
+
+void N2K_Replay::setSpeed(ReplaySpeed replaySpeed) {
+    if(state == REPLAY_PLAYING || replaySpeed >= REPLAY_SPEED_COUNT) return;
+    speed = replaySpeed;
+}
+
+/* ---------------------------------------------------------------------------
+ * Loader (loop context)
+ * ------------------------------------------------------------------------- */
+
+/**
+ * \brief Start playing the selected log
+ *
+ * The ring is filled completely before the timer starts, so playback
+ * begins with the full read-ahead.
+ *
+ * \return true if playback started
+ */
+bool N2K_Replay::start() {
+    if(state == REPLAY_PLAYING || logCount == 0) return false;
+
+    FS* fs = logger->getFileSystem();
+    if(fs == nullptr) return false;
+
+    char name[16];
+    getSelectedLogName(name);
+    if(logger->isRecording() && strcmp(name, logger->getFileName()) == 0) return false;
+
+    file = fs->open(name, FILE_READ);
+    uint8_t header[8];
+    if(!file || file.read(header, sizeof(header)) != sizeof(header) ||
+       memcmp(header, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0) {
+        if(file) file.close();
+        state = REPLAY_ERROR;
+        return false;
+    }
+
+    fileSize = file.size();
+    filePosition = sizeof(header);
+
+    CaptureFrame discard;
+    while(ring.pop(discard)) {}
+    ring.resetStats();
+
+    fileDone = false;
+    loaderDone.store(false, std::memory_order_relaxed);
+    haveLastTimestamp = false;
+    delayRemainder = 0;
+    haveNextFrame = false;
+    starved = false;
+
+    framesPlayed = 0;
+    framesLate = 0;
+    maxLateness = 0;
+    underruns = 0;
+
+    stage(CAPTURE_RING_SIZE);
+
+    if(target == REPLAY_TARGET_MONITOR) {
+        wasReceivePaused = monitorBus->isReceivePaused();
+        monitorBus->setReceivePaused(true);
+    }
+
+    instance = this;
+    state = REPLAY_PLAYING;
+    nextDue = micros() + REPLAY_MIN_WAIT_US;
+    playTimer.begin(playISR, REPLAY_MIN_WAIT_US);
+    return true;
+}
+
+void N2K_Replay::stop() {
+    if(state != REPLAY_PLAYING) return;
+    finish(REPLAY_STOPPED);
+}
+
+void N2K_Replay::finish(ReplayState endState) {
+    playTimer.end();
+    state = endState;
+
+    if(target == REPLAY_TARGET_MONITOR) {
+        monitorBus->setReceivePaused(wasReceivePaused);
+    }
+    if(file) file.close();
+}
+
+void N2K_Replay::service() {
+    if(state == REPLAY_PLAYING) {
+        stage(REPLAY_FRAMES_PER_SERVICE);
+    } else if(file) {
+        // The interrupt reached the end of the file
+        finish(state);
+    }
+}
+
+/**
+ * \brief Scale a recorded delay to the playback speed
+ *
+ * The remainder of each division is carried into the next delay, so the
+ * playback does not drift from the scaled recording over many frames.
+ *
+ * \param delay Delay between two recorded frames (micros)
+ * \return Delay to wait during playback (micros)
+ */
+uint32_t N2K_Replay::scaleDelay(uint32_t delay) {
+    uint32_t divisor;
+    switch(speed) {
+        case REPLAY_SPEED_1X:  return delay;
+        case REPLAY_SPEED_2X:  divisor = 2; break;
+        case REPLAY_SPEED_10X: divisor = 10; break;
+        default:               return 0;
+    }
+
+    uint32_t total = delay + delayRemainder;
+    delayRemainder = total % divisor;
+    return total / divisor;
+}
+
+/**
+ * \brief Read frames from the file into the ring
+ *
+ * Stops early when the ring is full. A short read or a corrupt record
+ * ends the file, so a log cut off by a power loss plays up to the cut.
+ *
+ * \param maxFrames Maximum number of records to read
+ */
+void N2K_Replay::stage(uint16_t maxFrames) {
+    if(fileDone) return;
+
+    for(uint16_t n = 0; n < maxFrames; n++) {
+        if(ring.available() >= CAPTURE_RING_SIZE) return;
+
+        uint8_t record[9];
+        CaptureFrame frame;
+        if(file.read(record, sizeof(record)) != sizeof(record) || record[8] > 8 ||
+           file.read(frame.data, record[8]) != record[8]) {
+            fileDone = true;
+            break;
+        }
+        filePosition += sizeof(record) + record[8];
+
+        uint32_t timestamp;
+        uint32_t id;
+        memcpy(&timestamp, &record[0], 4);
+        memcpy(&id, &record[4], 4);
+        if(id & N2K_LOG_TX_FLAG) continue;
+
+        uint32_t delay = haveLastTimestamp ? timestamp - lastTimestamp : 0;
+        lastTimestamp = timestamp;
+        haveLastTimestamp = true;
+
+        frame.timestamp = scaleDelay(delay);
+        frame.id = id;
+        frame.len = record[8];
+        ring.push(frame);
+    }
+
+    // Published after the last push, so the interrupt never misses a frame
+    if(fileDone) loaderDone.store(true, std::memory_order_release);
+}
+
+uint8_t N2K_Replay::getProgress() const {
+    if(state == REPLAY_FINISHED) return 100;
+    if(fileSize == 0) return 0;
+    return (uint8_t)((uint64_t)filePosition * 100 / fileSize);
+}
+
+/* ---------------------------------------------------------------------------
+ * Player (interrupt context)
+ * ------------------------------------------------------------------------- */
+
+void N2K_Replay::playISR() {
+    if(instance != nullptr) {
+        instance->play();
+    }
+}
+
+bool N2K_Replay::deliver(const CaptureFrame& frame) {
+    if(target == REPLAY_TARGET_CAN1) {
+        // A library send already in the driver when playback started must not be re-entered
+        if(transmitBus->isSending()) return false;
+        return transmitBus->sendRawFrame(frame.id, frame.len, frame.data);
+    }
+    return monitorBus->injectFrame(frame);
+}
+
+/**
+ * \brief Send the frames that are due and arm the timer for the next one
+ *
+ * A frame becomes due its scaled delay after the previous frame's due
+ * time, so interrupt latency never accumulates. After an underrun the
+ * clock restarts at the frame that was missing, keeping the spacing of
+ * the frames that follow. If the target is busy (transmit buffer or
+ * capture ring full, or the interrupt preempted the library inside the
+ * CAN1 driver) the frame is retried after REPLAY_MIN_WAIT_US.
+ */
+void N2K_Replay::play() {
+    uint32_t now = micros();
+    bool timed = speed != REPLAY_SPEED_MAX;
+
+    for(uint8_t sent = 0; sent < REPLAY_MAX_BURST; ) {
+        if(!haveNextFrame) {
+            bool done = loaderDone.load(std::memory_order_acquire);
+            if(!ring.pop(nextFrame)) {
+                if(done) {
+                    // service() closes the file and releases the bus
+                    playTimer.end();
+                    state = REPLAY_FINISHED;
+                    return;
+                }
+                if(!starved && timed) underruns = underruns + 1;
+                starved = true;
+                break;
+            }
+            if(starved && (int32_t)(now - nextDue) > 0) nextDue = now;
+            starved = false;
+            haveNextFrame = true;
+            nextDue += nextFrame.timestamp;
+        }
+
+        if(timed && (int32_t)(nextDue - now) > 0) break;
+        if(!deliver(nextFrame)) break;
+
+        if(timed) {
+            uint32_t lateness = now - nextDue;
+            if(lateness > maxLateness) maxLateness = lateness;
+            if(lateness > REPLAY_LATE_THRESHOLD_US) framesLate = framesLate + 1;
+        }
+        framesPlayed = framesPlayed + 1;
+        haveNextFrame = false;
+        sent++;
+    }
+
+    uint32_t wait = REPLAY_MIN_WAIT_US;
+    if(haveNextFrame && timed) {
+        int32_t remaining = (int32_t)(nextDue - micros());
+        if(remaining > (int32_t)REPLAY_MAX_WAIT_US) {
+            wait = REPLAY_MAX_WAIT_US;
+        } else if(remaining > (int32_t)REPLAY_MIN_WAIT_US) {
+            wait = remaining;
+        }
+    }
+    playTimer.begin(playISR, wait);
+}
+
+const char* N2K_Replay::getTargetName(ReplayTarget replayTarget) {
+    switch(replayTarget) {
+        case REPLAY_TARGET_MONITOR: return "Monitor";
+        case REPLAY_TARGET_CAN1:    return "CAN1";
+        default:                    return "?";
+    }
+}
+
+const char* N2K_Replay::getSpeedName(ReplaySpeed replaySpeed) {
+    switch(replaySpeed) {
+        case REPLAY_SPEED_1X:  return "1x";
+        case REPLAY_SPEED_2X:  return "2x";
+        case REPLAY_SPEED_10X: return "10x";
+        case REPLAY_SPEED_MAX: return "Max";
+        default:               return "?";
+    }
+}
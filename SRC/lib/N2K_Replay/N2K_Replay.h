@@ -0,0 +1,335 @@
+/**
+ * \file N2K_Replay.h
+ * \brief Timed playback of recorded logs into the monitor or onto CAN1
+ *
+ * Plays a NEMOLOG file written by N2K_Logger back with its original
+ * timing, or 2x, 10x or as fast as possible. Frames go to one of:
+ * - REPLAY_TARGET_MONITOR: injected into the CAN2 capture ring, so the
+ *   monitor, bus statistics, capture output and logger see them exactly
+ *   like live traffic. Live CAN2 traffic is paused meanwhile.
+ * - REPLAY_TARGET_CAN1: transmitted on CAN1 to recreate a bus scenario on
+ *   the bench. NEMO's own CAN1 traffic is held off meanwhile.
+ *
+ * The replay task reads frames from storage into a ring well ahead of
+ * time. A hardware timer is re-armed for each frame's due time and sends
+ * it from the interrupt. Frame timing therefore depends only on interrupt
+ * latency, not on what loop() is doing. Due times are kept on an absolute
+ * clock so errors don't add up over a long log.
+ *
+ * Frames marked as transmitted by NEMO (N2K_LOG_TX_FLAG) are skipped: on
+ * the usual setup CAN1 and CAN2 share one network, so CAN2 recorded them
+ * anyway.
+ */
+
+#ifndef N2K_REPLAY_H
+#define N2K_REPLAY_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <CAN_Capture.h>
+#include <N2K_Logger.h>
+#include "constants.h"
+
+/**
+ * \enum ReplayTarget
+ * \brief Where replayed frames are sent
+ */
+enum ReplayTarget : uint8_t {
+    REPLAY_TARGET_MONITOR,  ///< Into the CAN2 capture ring
+    REPLAY_TARGET_CAN1,     ///< Transmitted on CAN1
+    REPLAY_TARGET_COUNT     ///< Number of targets, not a valid target
+};
+
+/**
+ * \enum ReplaySpeed
+ * \brief Playback speed
+ */
+enum ReplaySpeed : uint8_t {
+    REPLAY_SPEED_1X,        ///< Original timing
+    REPLAY_SPEED_2X,        ///< Twice as fast
+    REPLAY_SPEED_10X,       ///< Ten times as fast
+    REPLAY_SPEED_MAX,       ///< As fast as the target takes frames
+    REPLAY_SPEED_COUNT      ///< Number of speeds, not a valid speed
+};
+
+/**
+ * \enum ReplayState
+ * \brief Playback state
+ */
+enum ReplayState : uint8_t {
+    REPLAY_STOPPED,         ///< Idle, nothing played yet or stopped by the user
+    REPLAY_PLAYING,         ///< Frames are being played
+    REPLAY_FINISHED,        ///< The whole file was played
+    REPLAY_ERROR            ///< The file could not be opened or read
+};
+
+/**
+ * \class N2K_Replay
+ * \brief Log file player with interrupt-timed frame output
+ *
+ * The staging ring is a CAN_FrameRing with the roles of the capture path
+ * swapped: service() in loop context is the producer and the playback
+ * interrupt the consumer. Each staged frame's timestamp field holds its
+ * delay after the previous frame, already scaled to the playback speed.
+ *
+ * \note The ring is a static object in DMAMEM, so only one player should
+ *       exist.
+ */
+class N2K_Replay {
+private:
+    static N2K_Replay* instance;    ///< Instance serviced by the playback interrupt
+    IntervalTimer playTimer;        ///< Re-armed for the due time of the next frame
+    CAN_FrameRing& ring;            ///< Frames staged for playback, in DMAMEM (N2K_Replay.cpp)
+
+    CAN_Capture* monitorBus;        ///< CAN2 interface frames are injected into
+    CAN_TxTap* transmitBus;         ///< CAN1 interface frames are sent on
+    N2K_Logger* logger;             ///< Provides the filesystem and the log names
+    File file;                      ///< Log being played
+
+    uint16_t logIndices[REPLAY_MAX_FILES];  ///< Numbers of the logs found, ascending
+    uint8_t logCount;               ///< Entries used in logIndices
+    uint8_t selectedLog;            ///< Index into logIndices of the log to play
+
+    ReplayTarget target;            ///< Where frames go
+    ReplaySpeed speed;              ///< Playback speed
+    volatile ReplayState state;     ///< Current state
+    bool wasReceivePaused;          ///< CAN2 pause state before playback, restored on stop
+
+    /* Loader state (loop context) */
+    bool fileDone;                  ///< All frames of the file are staged
+    bool haveLastTimestamp;         ///< lastTimestamp is valid
+    uint32_t lastTimestamp;         ///< Recorded time of the last staged frame
+    uint32_t delayRemainder;        ///< Remainder of the last scaled delay, carried forward
+    uint32_t fileSize;              ///< Size of the log file in bytes
+    uint32_t filePosition;          ///< Bytes of the file consumed so far
+
+    /* Player state (interrupt context) */
+    CaptureFrame nextFrame;         ///< Frame taken from the ring, waiting to be due
+    bool haveNextFrame;             ///< nextFrame is valid
+    uint32_t nextDue;               ///< micros() at which nextFrame is due
+    std::atomic<bool> loaderDone;   ///< Copy of fileDone published to the interrupt
+    bool starved;                   ///< The ring was empty at the last attempt
+
+    /* Statistics */
+    volatile uint32_t framesPlayed;     ///< Frames delivered to the target
+    volatile uint32_t framesLate;       ///< Frames sent more than REPLAY_LATE_THRESHOLD_US late
+    volatile uint32_t maxLateness;      ///< Worst lateness of a frame (micros)
+    volatile uint32_t underruns;        ///< Times the ring ran empty before the file ended
+
+    /**
+     * \brief IntervalTimer entry point
+     */
+    static void playISR();
+
+    /**
+     * \brief Send the frames that are due and arm the timer for the next one
+     *
+     * Runs in interrupt context.
+     */
+    void play();
+
+    /**
+     * \brief Pass one frame to the target
+     *
+     * \param frame Frame to deliver
+     * \return false if the target could not take it yet, or CAN1 is busy
+     *         with a library send the interrupt preempted
+     */
+    bool deliver(const CaptureFrame& frame);
+
+    /**
+     * \brief Read frames from the file into the ring
+     *
+     * \param maxFrames Maximum number of frames to read
+     */
+    void stage(uint16_t maxFrames);
+
+    /**
+     * \brief Scale a recorded delay to the playback speed
+     *
+     * \param delay Delay between two recorded frames (micros)
+     * \return Delay to wait during playback (micros)
+     */
+    uint32_t scaleDelay(uint32_t delay);
+
+    /**
+     * \brief Stop the timer and release the bus and the file
+     *
+     * \param endState State to enter
+     */
+    void finish(ReplayState endState);
+
+public:
+    /**
+     * \brief Construct an idle player
+     *
+     * \param monitorInterface CAN2 interface frames are injected into
+     * \param transmitInterface CAN1 interface frames are sent on
+     * \param frameLogger Logger whose storage holds the logs
+     */
+    N2K_Replay(CAN_Capture* monitorInterface, CAN_TxTap* transmitInterface, N2K_Logger* frameLogger);
+
+    /**
+     * \brief Look for log files on the logger's storage
+     *
+     * Keeps the REPLAY_MAX_FILES newest logs and selects the newest one.
+     *
+     * \return Number of logs found
+     */
+    uint8_t scanLogs();
+
+    /**
+     * \brief Select the next log in the list, wrapping around
+     */
+    void selectNextLog();
+
+    /**
+     * \brief Get the name of the selected log
+     *
+     * \param[out] out Buffer of at least 13 characters, empty if there are no logs
+     */
+    void getSelectedLogName(char* out) const;
+
+    /**
+     * \brief Get the number of logs found by scanLogs()
+     *
+     * \return Log count
+     */
+    uint8_t getLogCount() const { return logCount; }
+
+    /**
+     * \brief Start playing the selected log
+     *
+     * Fails while the logger is recording that same file. Playback to CAN1
+     * must not be started while the library or an attack transmits there;
+     * main.cpp holds that traffic off while isTransmitting() is true.
+     *
+     * \return true if playback started
+     */
+    bool start();
+
+    /**
+     * \brief Stop playback
+     */
+    void stop();
+
+    /**
+     * \brief Stage frames and notice the end of playback
+     *
+     * Call regularly from loop(); does nothing while stopped.
+     */
+    void service();
+
+    /**
+     * \brief Set where frames are sent, when stopped
+     *
+     * \param replayTarget New target
+     */
+    void setTarget(ReplayTarget replayTarget);
+
+    /**
+     * \brief Get where frames are sent
+     *
+     * \return Current target
+     */
+    ReplayTarget getTarget() const { return target; }
+
+    /**
+     * \brief Set the playback speed, when stopped
+     *
+     * \param replaySpeed New speed
+     */
+    void setSpeed(ReplaySpeed replaySpeed);
+
+    /**
+     * \brief Get the playback speed
+     *
+     * \return Current speed
+     */
+    ReplaySpeed getSpeed() const { return speed; }
+
+    /**
+     * \brief Get the playback state
+     *
+     * \return Current state
+     */
+    ReplayState getState() const { return state; }
+
+    /**
+     * \brief Check whether playback is running
+     *
+     * \return true while playing
+     */
+    bool isPlaying() const { return state == REPLAY_PLAYING; }
+
+    /**
+     * \brief Check whether playback is currently transmitting on CAN1
+     *
+     * \return true while playing to REPLAY_TARGET_CAN1
+     */
+    bool isTransmitting() const { return state == REPLAY_PLAYING && target == REPLAY_TARGET_CAN1; }
+
+    /**
+     * \brief Get how much of the file has been played
+     *
+     * \return Progress in percent of the file size
+     */
+    uint8_t getProgress() const;
+
+    /**
+     * \brief Get the number of frames delivered
+     *
+     * \return Frames played since start()
+     */
+    uint32_t getFramesPlayed() const { return framesPlayed; }
+
+    /**
+     * \brief Get the number of frames sent late
+     *
+     * \return Frames more than REPLAY_LATE_THRESHOLD_US behind their due time
+     */
+    uint32_t getFramesLate() const { return framesLate; }
+
+    /**
+     * \brief Get the worst lateness of a frame
+     *
+     * Not tracked at REPLAY_SPEED_MAX, where frames have no due time.
+     *
+     * \return Lateness in microseconds
+     */
+    uint32_t getMaxLateness() const { return maxLateness; }
+
+    /**
+     * \brief Get the number of times the staging ring ran empty
+     *
+     * Each one means storage could not keep up and frames went out late.
+     *
+     * \return Underrun count
+     */
+    uint32_t getUnderruns() const { return underruns; }
+
+    /**
+     * \brief Get the staging ring
+     *
+     * \return Ring, e.g. for its fill level
+     */
+    const CAN_FrameRing& getRing() const { return ring; }
+
+    /**
+     * \brief Get a short display name for a target
+     *
+     * \param replayTarget Target to name
+     * \return "Monitor" or "CAN1"
+     */
+    static const char* getTargetName(ReplayTarget replayTarget);
+
+    /**
+     * \brief Get a short display name for a speed
+     *
+     * \param replaySpeed Speed to name
+     * \return "1x", "2x", "10x" or "Max"
+     */
+    static const char* getSpeedName(ReplaySpeed replaySpeed);
+};
+
+#endif // N2K_REPLAY_H
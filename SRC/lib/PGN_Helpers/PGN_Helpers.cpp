@@ -9,19 +9,68 @@
 
 #include "PGN_Helpers.h"
 
+#include <math.h>
+
+/* ---- Compile-time table checks ---- */
+
+/// Largest NMEA2000 payload (fast packet), in bits
+static constexpr int PGN_MAX_PAYLOAD_BITS = 223 * 8;
+
+/**
+ * @brief Check that every field of the table fits the codec.
+ *
+ * @return true if all widths are 1 to 32 bits, every field lies inside the
+ *         largest payload and editable fields have a usable range
+ */
+static constexpr bool pgnFieldsValid() {
+    for (int i = 0; i < IMPERSONATABLE_PGN_COUNT; i++) {
+        const PGNDef& def = IMPERSONATABLE_PGN_DEFS[i];
+        for (int f = 0; f < getPGNDefFieldTotal(def); f++) {
+            const PGNFieldDef& field = def.fields[f];
+            if (field.bitWidth == 0 || field.bitWidth > 32) return false;
+            if (field.bitOffset + field.bitWidth > PGN_MAX_PAYLOAD_BITS) return false;
+            if (field.scale == 0) return false;
+            if ((field.flags & PGN_FIELD_EDITABLE) && field.minValue >= field.maxValue) return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Check that the table is sorted by PGN number without duplicates.
+ *
+ * @return true if getPGNDef() can binary search the table
+ */
+static constexpr bool pgnDefsSorted() {
+    for (int i = 1; i < IMPERSONATABLE_PGN_COUNT; i++) {
+        if (IMPERSONATABLE_PGN_DEFS[i - 1].pgn >= IMPERSONATABLE_PGN_DEFS[i].pgn) return false;
+    }
+    return true;
+}
+
+static_assert(pgnFieldsValid(), "IMPERSONATABLE_PGN_DEFS has a field the codec can't handle");
+static_assert(pgnDefsSorted(), "IMPERSONATABLE_PGN_DEFS must be sorted by PGN number");
+
 /**
  * @brief Find a PGN definition by its PGN number.
  *
- * Performs a linear search through the IMPERSONATABLE_PGN_DEFS array to find
- * a matching PGN number. Returns a pointer to the definition structure if found.
+ * Performs a binary search through the IMPERSONATABLE_PGN_DEFS array, which
+ * is sorted by PGN number. Returns a pointer to the definition structure if found.
  *
  * @param pgn The NMEA2000 PGN number to search for (e.g., 127250 for Vessel Heading)
  * @return Pointer to the PGNDef structure if found, nullptr otherwise
  */
 const PGNDef* getPGNDef(uint32_t pgn) {
-    for (int i = 0; i < IMPERSONATABLE_PGN_COUNT; i++) {
-        if (IMPERSONATABLE_PGN_DEFS[i].pgn == pgn) {
-            return &IMPERSONATABLE_PGN_DEFS[i];
+    int low = 0;
+    int high = IMPERSONATABLE_PGN_COUNT - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        uint32_t midPGN = IMPERSONATABLE_PGN_DEFS[mid].pgn;
+        if (midPGN == pgn) return &IMPERSONATABLE_PGN_DEFS[mid];
+        if (midPGN < pgn) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
         }
     }
     return nullptr;
@@ -66,7 +115,7 @@ const char* getPGNShortName(uint32_t pgn) {
  */
 int getPGNFieldCount(uint32_t pgn) {
     const PGNDef* def = getPGNDef(pgn);
-    return def ? def->fieldCount : 0;
+    return def ? getPGNDefEditableCount(*def) : 0;
 }
 
 /**
@@ -74,16 +123,22 @@ int getPGNFieldCount(uint32_t pgn) {
  *
  * Retrieves the complete field definition including name, value range,
  * and unit of measurement for a specific field within a PGN message.
+ * Display-only fields are skipped, so the index counts editable fields only.
  *
  * @param pgn The NMEA2000 PGN number containing the field
- * @param fieldIndex Zero-based index of the field (0 to fieldCount-1)
+ * @param fieldIndex Zero-based index among the editable fields
  * @return Pointer to PGNFieldDef structure, or nullptr if PGN not found
  *         or fieldIndex is out of bounds
  */
 const PGNFieldDef* getPGNField(uint32_t pgn, int fieldIndex) {
     const PGNDef* def = getPGNDef(pgn);
-    if (def && fieldIndex >= 0 && fieldIndex < def->fieldCount) {
-        return &def->fields[fieldIndex];
+    if (def == nullptr || fieldIndex < 0) return nullptr;
+
+    int total = getPGNDefFieldTotal(*def);
+    for (int i = 0; i < total; i++) {
+        if (!(def->fields[i].flags & PGN_FIELD_EDITABLE)) continue;
+        if (fieldIndex == 0) return &def->fields[i];
+        fieldIndex--;
     }
     return nullptr;
 }
@@ -115,28 +170,6 @@ void getPGNFieldRange(uint32_t pgn, int fieldIndex, float& minOut, float& maxOut
     }
 }
 
-/**
- * @brief Get a list of all field names for a PGN.
- *
- * Constructs and returns a vector containing the names of all editable
- * fields for the specified PGN, in order of their field index. This is
- * useful for populating UI selection lists or generating field documentation.
- *
- * @param pgn The NMEA2000 PGN number to query
- * @return Vector of field name strings in field index order;
- *         empty vector if PGN not found
- */
-std::vector<String> getPGNFieldNames(uint32_t pgn) {
-    std::vector<String> names;
-    const PGNDef* def = getPGNDef(pgn);
-    if (def) {
-        for (int i = 0; i < def->fieldCount; i++) {
-            names.push_back(def->fields[i].name);
-        }
-    }
-    return names;
-}
-
 /**
  * @brief Check if a PGN is in the impersonatable list.
  *
@@ -151,6 +184,194 @@ bool isImpersonatablePGN(uint32_t pgn) {
     return getPGNDef(pgn) != nullptr;
 }
 
+/**
+ * @brief Standard fast-packet PGNs, sorted by PGN number.
+ *
+ * The fast-packet messages the NMEA2000 library knows by default. The
+ * proprietary ranges are checked separately in isFastPacketPGN(). Declared
+ * inline like the tables in PGN_Helpers.h: GCC won't put a static and an
+ * inline variable in the same .progmem section of one object file.
+ */
+inline constexpr uint32_t FAST_PACKET_PGNS[] PROGMEM = {
+    126208, 126464, 126983, 126984, 126985, 126986, 126987, 126988,
+    126996, 126998, 127233, 127237, 127489, 127496, 127497, 127498,
+    127503, 127504, 127506, 127507, 127509, 127510, 127511, 127512,
+    127513, 127514, 128275, 128520, 129029, 129038, 129039, 129040,
+    129041, 129044, 129045, 129284, 129285, 129301, 129302, 129538,
+    129540, 129541, 129542, 129545, 129547, 129549, 129551, 129556,
+    129792, 129793, 129794, 129795, 129796, 129797, 129798, 129799,
+    129800, 129801, 129802, 129803, 129804, 129805, 129806, 129807,
+    129808, 129809, 129810, 130052, 130053, 130054, 130060, 130061,
+    130064, 130065, 130066, 130067, 130068, 130069, 130070, 130071,
+    130072, 130073, 130074, 130320, 130321, 130322, 130323, 130324,
+    130567, 130569, 130570, 130571, 130572, 130573, 130574, 130577,
+    130578, 130580, 130581, 130583, 130584, 130586,
+};
+
+/**
+ * @brief Check that the fast-packet table is sorted for the binary search.
+ */
+constexpr bool fastPacketPGNsSorted() {
+    for (size_t i = 1; i < sizeof(FAST_PACKET_PGNS) / sizeof(FAST_PACKET_PGNS[0]); i++) {
+        if (FAST_PACKET_PGNS[i - 1] >= FAST_PACKET_PGNS[i]) return false;
+    }
+    return true;
+}
+
+static_assert(fastPacketPGNsSorted(), "FAST_PACKET_PGNS must be sorted by PGN number");
+
+/**
+ * @brief Check if a PGN is sent as a fast packet.
+ *
+ * Binary search through FAST_PACKET_PGNS after the proprietary ranges.
+ *
+ * @param pgn The NMEA2000 PGN number to check
+ * @return true if the PGN is sent as a fast packet, false otherwise
+ */
+bool isFastPacketPGN(uint32_t pgn) {
+    // Proprietary fast-packet ranges
+    if (pgn == 126720 || (pgn >= 130816 && pgn <= 131071)) return true;
+
+    int low = 0;
+    int high = sizeof(FAST_PACKET_PGNS) / sizeof(FAST_PACKET_PGNS[0]) - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        if (FAST_PACKET_PGNS[mid] == pgn) return true;
+        if (FAST_PACKET_PGNS[mid] < pgn) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return false;
+}
+
+/* ---- Field codec ---- */
+
+/**
+ * @brief Get the all-ones mask for a field width.
+ *
+ * @param bitWidth Field width in bits (1 to 32)
+ * @return Mask with the lowest bitWidth bits set
+ */
+static inline uint32_t fieldMask(uint8_t bitWidth) {
+    return bitWidth >= 32 ? 0xFFFFFFFFUL : ((1UL << bitWidth) - 1);
+}
+
+/**
+ * @brief Read the raw value of a field from a PGN payload.
+ *
+ * A field spans at most five bytes (32 bits at any bit position), which are
+ * gathered into one 64-bit word and shifted into place.
+ *
+ * The N/A sentinels follow the NMEA2000 convention: for unsigned fields the
+ * all-ones value means "not available" and all-ones minus one means "error";
+ * for signed fields the same applies to the largest positive values. Fields
+ * narrower than a byte only reserve all-ones. Enumerations have no sentinels.
+ *
+ * @param field Field description
+ * @param data Payload bytes
+ * @param dataLen Number of payload bytes
+ * @param[out] raw Raw field value
+ * @return true if the field is present and not one of the N/A sentinels
+ */
+bool decodePGNField(const PGNFieldDef& field, const uint8_t* data, uint8_t dataLen, int32_t& raw) {
+    uint16_t endBit = field.bitOffset + field.bitWidth;
+    if (endBit > (uint16_t)dataLen * 8) return false;
+
+    int firstByte = field.bitOffset >> 3;
+    int lastByte = (endBit - 1) >> 3;
+    uint64_t word = 0;
+    for (int i = lastByte; i >= firstByte; i--) {
+        word = (word << 8) | data[i];
+    }
+
+    uint32_t mask = fieldMask(field.bitWidth);
+    uint32_t value = (uint32_t)(word >> (field.bitOffset & 7)) & mask;
+
+    if (field.flags & PGN_FIELD_HAS_NA) {
+        uint32_t naValue = (field.flags & PGN_FIELD_SIGNED) ? (mask >> 1) : mask;
+        if (value == naValue) return false;
+        if (field.bitWidth >= 8 && value == naValue - 1) return false;
+    }
+
+    if ((field.flags & PGN_FIELD_SIGNED) && field.bitWidth < 32 && (value & (1UL << (field.bitWidth - 1)))) {
+        value |= ~mask;  // Sign extend
+    }
+
+    raw = (int32_t)value;
+    return true;
+}
+
+/**
+ * @brief Write a value in display units into a PGN payload.
+ *
+ * Performs the inverse of decodePGNField() and getPGNFieldValue(). The
+ * surrounding bits are preserved, so reserved bits and neighbouring fields
+ * of the template message keep their original contents.
+ *
+ * @param field Field description
+ * @param data Payload bytes to modify
+ * @param dataLen Number of payload bytes
+ * @param value New value in display units
+ * @return true if the field fits in the payload and was written
+ */
+bool encodePGNField(const PGNFieldDef& field, uint8_t* data, uint8_t dataLen, double value) {
+    PGNFieldPatch patch;
+    if (!compilePGNFieldPatch(field, dataLen, patch)) return false;
+    writePGNFieldPatch(patch, data, getPGNFieldRaw(field, value));
+    return true;
+}
+
+int32_t getPGNFieldRaw(const PGNFieldDef& field, double value) {
+    uint32_t mask = fieldMask(field.bitWidth);
+    uint32_t reserved = 0;
+    if (field.flags & PGN_FIELD_HAS_NA) {
+        reserved = field.bitWidth >= 8 ? 2 : 1;
+    }
+
+    // Clamp to the raw range, keeping clear of the N/A sentinels
+    double rawValue = round((value - field.offset) / field.scale);
+    double rawMin, rawMax;
+    if (field.flags & PGN_FIELD_SIGNED) {
+        rawMax = (double)(mask >> 1) - reserved;
+        rawMin = -(double)(mask >> 1) - 1;
+    } else {
+        rawMax = (double)mask - reserved;
+        rawMin = 0;
+    }
+    if (rawValue > rawMax) rawValue = rawMax;
+    if (rawValue < rawMin) rawValue = rawMin;
+
+    return (int32_t)(int64_t)rawValue;
+}
+
+bool compilePGNFieldPatch(const PGNFieldDef& field, uint8_t dataLen, PGNFieldPatch& patch) {
+    uint16_t endBit = field.bitOffset + field.bitWidth;
+    if (endBit > (uint16_t)dataLen * 8) return false;
+
+    patch.firstByte = field.bitOffset >> 3;
+    patch.lastByte = (endBit - 1) >> 3;
+    patch.shift = field.bitOffset & 7;
+    patch.mask = fieldMask(field.bitWidth);
+    return true;
+}
+
+void writePGNFieldPatch(const PGNFieldPatch& patch, uint8_t* data, int32_t raw) {
+    uint32_t bits = (uint32_t)raw & patch.mask;
+
+    uint64_t word = 0;
+    for (int i = patch.lastByte; i >= patch.firstByte; i--) {
+        word = (word << 8) | data[i];
+    }
+    word &= ~((uint64_t)patch.mask << patch.shift);
+    word |= (uint64_t)bits << patch.shift;
+    for (int i = patch.firstByte; i <= patch.lastByte; i++) {
+        data[i] = word & 0xFF;
+        word >>= 8;
+    }
+}
+
 /**
  * @brief Get a manufacturer definition by array index.
  *
@@ -11,30 +11,64 @@
 #define PGN_HELPERS_H
 
 #include <Arduino.h>
-#include <vector>
 
+#ifndef PROGMEM
+#define PROGMEM
+#endif
 
 /**
- * @brief Maximum number of editable fields per PGN definition.
+ * @brief Maximum number of fields per PGN definition.
  *
  * This constant limits the size of the fields array in PGNDef structures.
- * Increase this value if you need to support PGNs with more than 8 fields.
+ * It counts all described fields, not only the editable ones.
  */
-#define MAX_PGN_FIELDS 8
+#define MAX_PGN_FIELDS 12
 
 /**
- * @struct PGNFieldDef
- * @brief Definition of a single editable field within a PGN message.
+ * @brief Size of an enumeration name, including the terminator.
  *
- * Each PGN message can contain multiple data fields. This structure describes
- * one such field, including its valid value range and unit of measurement.
+ * Names are stored in fixed-width PROGMEM tables instead of behind
+ * pointers, so neither pointers nor literals are copied to RAM.
+ */
+#define PGN_ENUM_NAME_SIZE 11
+
+/**
+ * @brief One enumeration name; a longer initializer does not compile.
+ */
+typedef char PGNEnumName[PGN_ENUM_NAME_SIZE];
 
+/**
+ * @name PGN field flags
+ * @brief Bit flags describing how a PGNFieldDef is encoded and used.
+ * @{
+ */
+#define PGN_FIELD_SIGNED    0x01    ///< Raw value is two's complement
+#define PGN_FIELD_HAS_NA    0x02    ///< Top raw values are the NMEA2000 N/A and error sentinels
+#define PGN_FIELD_EDITABLE  0x04    ///< Field can be changed by the impersonate attack
+/** @} */
+
+/**
+ * @struct PGNFieldDef
+ * @brief Wire layout and display format of a single field within a PGN message.
+ *
+ * Describes where the field sits in the payload (bit offset and width, little-endian
+ * as in the NMEA2000 standard) and how a raw value converts to display units:
+ * value = raw * scale + offset. The same description drives decoding in the
+ * monitor and encoding in the spoof builder.
  */
 struct PGNFieldDef {
-    const char* name;      ///< Field name displayed in UI (e.g., "Heading", "Deviation")
-    float minValue;        ///< Minimum valid value for this field
-    float maxValue;        ///< Maximum valid value for this field
-    const char* unit;      ///< Unit of measurement (e.g., "deg", "m", "kPa", "%")
+    const char* name;               ///< Field name displayed in UI (e.g., "Heading", "Deviation")
+    uint16_t bitOffset;             ///< Position of the least significant bit in the payload
+    uint8_t bitWidth;               ///< Number of bits (1 to 32)
+    uint8_t flags;                  ///< PGN_FIELD_* flags
+    double scale;                   ///< Display units per raw count
+    double offset;                  ///< Display value of raw 0 (e.g., -273.15 for Kelvin to Celsius)
+    uint8_t decimals;               ///< Decimal places shown
+    const char* unit;               ///< Unit of measurement (e.g., "deg", "m", "kPa", "%")
+    float minValue;                 ///< Minimum value the attack may set (editable fields)
+    float maxValue;                 ///< Maximum value the attack may set (editable fields)
+    const PGNEnumName* enumNames;   ///< Names of the raw values, nullptr for numeric fields
+    uint8_t enumCount;              ///< Number of entries in enumNames
 };
 
 /**
@@ -42,219 +76,343 @@ struct PGNFieldDef {
  * @brief Complete definition of an NMEA2000 PGN message.
  *
  * This structure serves as the single source of truth for PGN definitions
- * that can be impersonated or simulated. It includes the PGN number, human-readable
- * names, and definitions for all editable fields.
+ * that can be decoded and impersonated. It includes the PGN number, human-readable
+ * names, and the layout of every described field. Unused entries of the fields
+ * array have a nullptr name.
  */
 struct PGNDef {
     uint32_t pgn;                       ///< NMEA2000 PGN number (e.g., 127250 for Vessel Heading)
     const char* name;                   ///< Full descriptive name (e.g., "Vessel Heading")
     const char* shortName;              ///< Abbreviated name for display (e.g., "Heading")
-    uint8_t fieldCount;                 ///< Number of editable fields (1 to MAX_PGN_FIELDS)
-    PGNFieldDef fields[MAX_PGN_FIELDS]; ///< Array of field definitions
+    PGNFieldDef fields[MAX_PGN_FIELDS]; ///< Field definitions in display order
 };
 
 /**
- * @brief Array of all PGN definitions available for impersonation.
+ * @name Field builders
+ * @brief Helpers that keep the rows of IMPERSONATABLE_PGN_DEFS short.
+ *
+ * Numeric fields always carry the N/A sentinels; enumerations use every raw value.
+ * Pass PGN_FIELD_SIGNED or 0 as sign.
+ * @{
+ */
+
+/** @brief Display-only numeric field */
+constexpr PGNFieldDef pgnValue(const char* name, uint16_t bitOffset, uint8_t bitWidth, uint8_t sign,
+                               double scale, double offset, uint8_t decimals, const char* unit) {
+    return {name, bitOffset, bitWidth, (uint8_t)(sign | PGN_FIELD_HAS_NA), scale, offset, decimals, unit,
+            0, 0, nullptr, 0};
+}
+
+/** @brief Numeric field the impersonate attack can change between minValue and maxValue */
+constexpr PGNFieldDef pgnEdit(const char* name, uint16_t bitOffset, uint8_t bitWidth, uint8_t sign,
+                              double scale, double offset, uint8_t decimals, const char* unit,
+                              float minValue, float maxValue) {
+    return {name, bitOffset, bitWidth, (uint8_t)(sign | PGN_FIELD_HAS_NA | PGN_FIELD_EDITABLE),
+            scale, offset, decimals, unit, minValue, maxValue, nullptr, 0};
+}
+
+/** @brief Display-only enumeration, shown by name */
+template <size_t N>
+constexpr PGNFieldDef pgnEnum(const char* name, uint16_t bitOffset, uint8_t bitWidth,
+                              const PGNEnumName (&names)[N]) {
+    return {name, bitOffset, bitWidth, 0, 1, 0, 0, "", 0, 0, names, (uint8_t)N};
+}
+
+/** @brief Enumeration the impersonate attack can change, edited by raw value */
+template <size_t N>
+constexpr PGNFieldDef pgnEditEnum(const char* name, uint16_t bitOffset, uint8_t bitWidth,
+                                  const PGNEnumName (&names)[N]) {
+    return {name, bitOffset, bitWidth, PGN_FIELD_EDITABLE, 1, 0, 0, "", 0, (float)(N - 1), names, (uint8_t)N};
+}
+/** @} */
+
+/**
+ * @name Unit conversion factors
+ * @brief Multipliers from NMEA2000 SI units to the display units.
+ * @{
+ */
+inline constexpr double PGN_RAD_TO_DEG = 57.29577951308232;    ///< Radians to degrees
+inline constexpr double PGN_MS_TO_KN = 1.9438444924406048;     ///< m/s to knots
+inline constexpr double PGN_K_TO_C = -273.15;                  ///< Kelvin to Celsius offset
+inline constexpr double PGN_ANGLE = 1e-4 * PGN_RAD_TO_DEG;     ///< 0.0001 rad resolution in degrees
+inline constexpr double PGN_SPEED = 0.01 * PGN_MS_TO_KN;       ///< 0.01 m/s resolution in knots
+inline constexpr double PGN_PERCENT = 0.004;                   ///< 0.004 % resolution of levels and humidity
+/** @} */
+
+/**
+ * @name Enumeration names
+ * @brief Display names of the lookup fields used in IMPERSONATABLE_PGN_DEFS.
+ *
+ * Kept in flash like the table itself.
+ * @{
+ */
+inline constexpr PGNEnumName PGN_HEADING_REF_NAMES[] PROGMEM = {"True", "Mag", "Error", "N/A"};
+inline constexpr PGNEnumName PGN_MAG_VAR_NAMES[] PROGMEM = {"Manual", "Chart", "Table", "Calc", "WMM2000",
+                                                            "WMM2005", "WMM2010", "WMM2015", "WMM2020"};
+inline constexpr PGNEnumName PGN_GEAR_NAMES[] PROGMEM = {"Forward", "Neutral", "Reverse", "Unknown"};
+inline constexpr PGNEnumName PGN_FLUID_NAMES[] PROGMEM = {"Fuel", "Water", "Gray", "LiveWell", "Oil",
+                                                          "Black", "Gasoline", "Error", "Unavail"};
+inline constexpr PGNEnumName PGN_DC_TYPE_NAMES[] PROGMEM = {"Battery", "Alternator", "Converter", "Solar", "Wind"};
+inline constexpr PGNEnumName PGN_CHARGE_STATE_NAMES[] PROGMEM = {"Not Chg", "Bulk", "Absorb", "Overchg",
+                                                                 "Equal", "Float", "No Float", "Fault"};
+inline constexpr PGNEnumName PGN_CHARGER_MODE_NAMES[] PROGMEM = {"Standalone", "Primary", "Secondary", "Echo"};
+inline constexpr PGNEnumName PGN_ON_OFF_NAMES[] PROGMEM = {"No", "Yes", "Error", "N/A"};
+inline constexpr PGNEnumName PGN_WIND_REF_NAMES[] PROGMEM = {"True N", "Mag N", "Apparent", "True Boat",
+                                                             "True Water"};
+inline constexpr PGNEnumName PGN_TEMP_SOURCE_NAMES[] PROGMEM = {"Sea", "Outside", "Inside", "Engine", "Cabin",
+                                                                "LiveWell", "Bait", "Refrig", "Heat", "Dew",
+                                                                "Wind", "App Wind", "Exh", "Shift"};
+inline constexpr PGNEnumName PGN_HUMIDITY_SOURCE_NAMES[] PROGMEM = {"Inside", "Outside"};
+inline constexpr PGNEnumName PGN_DATA_MODE_NAMES[] PROGMEM = {"Auto", "Diff", "Estimated", "Simulator", "Manual"};
+/** @} */
+
+/**
+ * @brief Array of all PGN definitions available for decoding and impersonation.
  *
  * This array contains the complete list of NMEA2000 PGNs that the NEMO device
- * can simulate or impersonate. Each entry defines the PGN number, names, and
- * all editable fields with their valid ranges.
+ * can decode by table and simulate or impersonate. Each entry defines the PGN
+ * number, names, and the wire layout of its fields. Entries are sorted by PGN
+ * number (checked at compile time), so lookups can use a binary search.
+ *
+ * Adding a PGN with a fixed layout only needs a new row here.
+ *
+ * Kept in flash: Teensy 4 copies plain const data into DTCM at startup, and
+ * the table is about 16 KB there. Reads go through the flash cache.
  */
-inline const PGNDef IMPERSONATABLE_PGN_DEFS[] = {
+inline constexpr PGNDef IMPERSONATABLE_PGN_DEFS[] PROGMEM = {
     /* --- Steering and Rudder --- */
 
     /** @brief PGN 127245 - Rudder angle measurement */
-    {127245, "Rudder", "Rudder", 1, {
-        {"Rudder", -45, 45, "deg"},
+    {127245, "Rudder", "Rudder", {
+        pgnValue("Instance", 0, 8, 0, 1, 0, 0, ""),
+        pgnEdit("Rudder", 32, 16, PGN_FIELD_SIGNED, PGN_ANGLE, 0, 1, "deg", -45, 45),
+        pgnValue("Order", 16, 16, PGN_FIELD_SIGNED, PGN_ANGLE, 0, 1, "deg"),
     }},
 
     /* --- Navigation and Attitude --- */
 
     /** @brief PGN 127250 - Vessel heading with magnetic deviation and variation */
-    {127250, "Vessel Heading", "Heading", 3, {
-        {"Heading", 0, 360, "deg"},
-        {"Deviation", -30, 30, "deg"},
-        {"Variation", -30, 30, "deg"},
+    {127250, "Vessel Heading", "Heading", {
+        pgnEdit("Heading", 8, 16, 0, PGN_ANGLE, 0, 1, "deg", 0, 360),
+        pgnEdit("Deviation", 24, 16, PGN_FIELD_SIGNED, PGN_ANGLE, 0, 1, "deg", -30, 30),
+        pgnEdit("Variation", 40, 16, PGN_FIELD_SIGNED, PGN_ANGLE, 0, 1, "deg", -30, 30),
+        pgnEnum("Reference", 56, 2, PGN_HEADING_REF_NAMES),
     }},
 
     /** @brief PGN 127251 - Rate of turn (angular velocity) */
-    {127251, "Rate of Turn", "Rate of Turn", 1, {
-        {"Rate", -180, 180, "deg/min"},
+    {127251, "Rate of Turn", "Rate of Turn", {
+        pgnEdit("Rate", 8, 32, PGN_FIELD_SIGNED, 3.125e-8 * PGN_RAD_TO_DEG * 60.0, 0, 1, "deg/min", -180, 180),
     }},
 
     /** @brief PGN 127252 - Heave (vertical motion) measurement */
-    {127252, "Heave", "Heave", 2, {
-        {"Heave", -10, 10, "m"},
-        {"Delay", 0, 10, "s"},
+    {127252, "Heave", "Heave", {
+        pgnEdit("Heave", 8, 16, PGN_FIELD_SIGNED, 0.01, 0, 2, "m", -10, 10),
+        pgnEdit("Delay", 24, 16, 0, 0.01, 0, 2, "s", 0, 10),
     }},
 
     /** @brief PGN 127257 - Vessel attitude (yaw, pitch, roll) */
-    {127257, "Attitude", "Attitude", 3, {
-        {"Yaw", -180, 180, "deg"},
-        {"Pitch", -90, 90, "deg"},
-        {"Roll", -180, 180, "deg"},
+    {127257, "Attitude", "Attitude", {
+        pgnEdit("Yaw", 8, 16, PGN_FIELD_SIGNED, PGN_ANGLE, 0, 1, "deg", -180, 180),
+        pgnEdit("Pitch", 24, 16, PGN_FIELD_SIGNED, PGN_ANGLE, 0, 1, "deg", -90, 90),
+        pgnEdit("Roll", 40, 16, PGN_FIELD_SIGNED, PGN_ANGLE, 0, 1, "deg", -180, 180),
     }},
 
     /** @brief PGN 127258 - Magnetic variation at current location */
-    {127258, "Magnetic Variation", "Mag Variation", 1, {
-        {"Variation", -30, 30, "deg"},
+    {127258, "Magnetic Variation", "Mag Variation", {
+        pgnEdit("Variation", 32, 16, PGN_FIELD_SIGNED, PGN_ANGLE, 0, 1, "deg", -30, 30),
+        pgnEnum("Source", 8, 4, PGN_MAG_VAR_NAMES),
+        pgnValue("Days", 16, 16, 0, 1, 0, 0, ""),
     }},
 
     /* --- Engine and Propulsion --- */
 
     /** @brief PGN 127488 - Engine parameters, rapid update (RPM and boost) */
-    {127488, "Engine Parameters Rapid", "Engine Rapid", 2, {
-        {"RPM", 0, 8000, "rpm"},
-        {"Boost", 0, 500, "kPa"},
+    {127488, "Engine Parameters Rapid", "Engine Rapid", {
+        pgnValue("Instance", 0, 8, 0, 1, 0, 0, ""),
+        pgnEdit("RPM", 8, 16, 0, 0.25, 0, 0, "rpm", 0, 8000),
+        pgnEdit("Boost", 24, 16, 0, 0.1, 0, 1, "kPa", 0, 500),
+        pgnValue("Tilt/Trim", 40, 8, PGN_FIELD_SIGNED, 1, 0, 0, "%"),
     }},
 
     /** @brief PGN 127489 - Engine parameters, dynamic (detailed engine data) */
-    {127489, "Engine Parameters Dynamic", "Engine Dynamic", 7, {
-        {"Oil Press", 0, 1000, "kPa"},
-        {"Oil Temp", 233, 400, "K"},
-        {"Coolant", 233, 400, "K"},
-        {"Alt Volt", 0, 32, "V"},
-        {"Fuel Rate", 0, 200, "L/h"},
-        {"Hours", 0, 100000, "h"},
-        {"Load", 0, 100, "%"},
+    {127489, "Engine Parameters Dynamic", "Engine Dynamic", {
+        pgnValue("Instance", 0, 8, 0, 1, 0, 0, ""),
+        pgnEdit("Oil Press", 8, 16, 0, 0.1, 0, 1, "kPa", 0, 1000),
+        pgnEdit("Oil Temp", 24, 16, 0, 0.1, PGN_K_TO_C, 1, "C", -40, 127),
+        pgnEdit("Coolant", 40, 16, 0, 0.01, PGN_K_TO_C, 1, "C", -40, 127),
+        pgnEdit("Alt Volt", 56, 16, PGN_FIELD_SIGNED, 0.01, 0, 2, "V", 0, 32),
+        pgnEdit("Fuel Rate", 72, 16, PGN_FIELD_SIGNED, 0.1, 0, 1, "L/h", 0, 200),
+        pgnEdit("Hours", 88, 32, 0, 1.0 / 3600.0, 0, 1, "h", 0, 100000),
+        pgnEdit("Load", 192, 8, PGN_FIELD_SIGNED, 1, 0, 0, "%", 0, 100),
     }},
 
     /** @brief PGN 127493 - Transmission parameters (gear, oil pressure/temp) */
-    {127493, "Transmission Parameters", "Transmission", 3, {
-        {"Gear", 0, 3, ""},
-        {"Oil Press", 0, 1000, "kPa"},
-        {"Oil Temp", 233, 400, "K"},
+    {127493, "Transmission Parameters", "Transmission", {
+        pgnValue("Instance", 0, 8, 0, 1, 0, 0, ""),
+        pgnEditEnum("Gear", 8, 2, PGN_GEAR_NAMES),
+        pgnEdit("Oil Press", 16, 16, 0, 0.1, 0, 1, "kPa", 0, 1000),
+        pgnEdit("Oil Temp", 32, 16, 0, 0.1, PGN_K_TO_C, 1, "C", -40, 127),
     }},
 
     /** @brief PGN 127497 - Trip fuel consumption parameters */
-    {127497, "Trip Fuel Parameters", "Trip Fuel", 2, {
-        {"Trip Fuel", 0, 10000, "L"},
-        {"Avg Rate", 0, 200, "L/h"},
+    {127497, "Trip Fuel Parameters", "Trip Fuel", {
+        pgnValue("Instance", 0, 8, 0, 1, 0, 0, ""),
+        pgnEdit("Trip Fuel", 8, 16, 0, 1, 0, 0, "L", 0, 10000),
+        pgnEdit("Avg Rate", 24, 16, PGN_FIELD_SIGNED, 0.1, 0, 1, "L/h", 0, 200),
+        pgnValue("Economy", 40, 16, PGN_FIELD_SIGNED, 0.1, 0, 1, "L/h"),
+        pgnValue("Inst Rate", 56, 16, PGN_FIELD_SIGNED, 0.1, 0, 1, "L/h"),
     }},
 
     /* --- Tanks and Fluid Levels --- */
 
     /** @brief PGN 127505 - Fluid level (fuel, water, waste, etc.) */
-    {127505, "Fluid Level", "Fluid Level", 1, {
-        {"Level", 0, 100, "%"},
+    {127505, "Fluid Level", "Fluid Level", {
+        pgnValue("Instance", 0, 4, 0, 1, 0, 0, ""),
+        pgnEnum("Type", 4, 4, PGN_FLUID_NAMES),
+        pgnEdit("Level", 8, 16, PGN_FIELD_SIGNED, PGN_PERCENT, 0, 1, "%", 0, 100),
+        pgnValue("Capacity", 24, 32, 0, 0.1, 0, 0, "L"),
     }},
 
     /* --- Electrical Systems --- */
 
     /** @brief PGN 127506 - DC battery detailed status (SOC, health, capacity) */
-    {127506, "DC Detailed Status", "DC Status", 3, {
-        {"SOC", 0, 100, "%"},
-        {"Health", 0, 100, "%"},
-        {"Capacity", 0, 1000, "Ah"},
+    {127506, "DC Detailed Status", "DC Status", {
+        pgnValue("Instance", 8, 8, 0, 1, 0, 0, ""),
+        pgnEnum("Type", 16, 8, PGN_DC_TYPE_NAMES),
+        pgnEdit("SOC", 24, 8, 0, 1, 0, 0, "%", 0, 100),
+        pgnEdit("Health", 32, 8, 0, 1, 0, 0, "%", 0, 100),
+        pgnValue("Remaining", 40, 16, 0, 1, 0, 0, "min"),
+        pgnValue("Ripple", 56, 16, 0, 0.001, 0, 3, "V"),
+        pgnEdit("Capacity", 72, 16, 0, 1, 0, 0, "Ah", 0, 1000),
     }},
 
     /** @brief PGN 127507 - Battery charger status */
-    {127507, "Charger Status", "Charger", 2, {
-        {"State", 0, 7, ""},
-        {"Enabled", 0, 1, ""},
+    {127507, "Charger Status", "Charger", {
+        pgnValue("Charger", 0, 8, 0, 1, 0, 0, ""),
+        pgnValue("Battery", 8, 8, 0, 1, 0, 0, ""),
+        pgnEditEnum("State", 16, 4, PGN_CHARGE_STATE_NAMES),
+        pgnEditEnum("Enabled", 24, 2, PGN_ON_OFF_NAMES),
+        pgnEnum("Mode", 20, 4, PGN_CHARGER_MODE_NAMES),
+        pgnValue("Eq Time", 32, 16, 0, 1, 0, 0, "min"),
     }},
 
     /** @brief PGN 127508 - Battery voltage and current status */
-    {127508, "Battery Status", "Battery", 2, {
-        {"Voltage", 0, 32, "V"},
-        {"Current", -500, 500, "A"},
+    {127508, "Battery Status", "Battery", {
+        pgnValue("Instance", 0, 8, 0, 1, 0, 0, ""),
+        pgnEdit("Voltage", 8, 16, PGN_FIELD_SIGNED, 0.01, 0, 2, "V", 0, 32),
+        pgnEdit("Current", 24, 16, PGN_FIELD_SIGNED, 0.1, 0, 1, "A", -500, 500),
+        pgnValue("Temp", 40, 16, 0, 0.01, PGN_K_TO_C, 1, "C"),
     }},
 
     /* --- Speed and Distance --- */
 
     /** @brief PGN 128000 - Leeway angle (side slip) */
-    {128000, "Leeway", "Leeway", 1, {
-        {"Leeway", -30, 30, "deg"},
+    {128000, "Leeway", "Leeway", {
+        pgnEdit("Leeway", 8, 16, PGN_FIELD_SIGNED, PGN_ANGLE, 0, 1, "deg", -30, 30),
     }},
 
     /** @brief PGN 128259 - Speed referenced to water and ground */
-    {128259, "Speed Water Referenced", "Speed Water", 2, {
-        {"Water Spd", 0, 20, "m/s"},
-        {"Ground Spd", 0, 20, "m/s"},
+    {128259, "Speed Water Referenced", "Speed Water", {
+        pgnEdit("Water Spd", 8, 16, 0, PGN_SPEED, 0, 1, "kn", 0, 40),
+        pgnEdit("Ground Spd", 24, 16, 0, PGN_SPEED, 0, 1, "kn", 0, 40),
     }},
 
     /** @brief PGN 128267 - Water depth below transducer */
-    {128267, "Water Depth", "Water Depth", 2, {
-        {"Depth", 0, 200, "m"},
-        {"Offset", -10, 10, "m"},
+    {128267, "Water Depth", "Water Depth", {
+        pgnEdit("Depth", 8, 32, 0, 0.01, 0, 1, "m", 0, 200),
+        pgnEdit("Offset", 40, 16, PGN_FIELD_SIGNED, 0.001, 0, 1, "m", -10, 10),
+        pgnValue("Range", 56, 8, 0, 10, 0, 0, "m"),
     }},
 
     /* --- Position and Course --- */
 
     /** @brief PGN 129025 - GPS position, rapid update (lat/lon) */
-    {129025, "Position Rapid Update", "Position", 2, {
-        {"Latitude", -90, 90, "deg"},
-        {"Longitude", -180, 180, "deg"},
+    {129025, "Position Rapid Update", "Position", {
+        pgnEdit("Latitude", 0, 32, PGN_FIELD_SIGNED, 1e-7, 0, 6, "deg", -90, 90),
+        pgnEdit("Longitude", 32, 32, PGN_FIELD_SIGNED, 1e-7, 0, 6, "deg", -180, 180),
     }},
 
     /** @brief PGN 129026 - Course over ground and speed over ground */
-    {129026, "COG & SOG Rapid Update", "COG & SOG", 2, {
-        {"COG", 0, 360, "deg"},
-        {"SOG", 0, 20, "m/s"},
+    {129026, "COG & SOG Rapid Update", "COG & SOG", {
+        pgnEdit("COG", 16, 16, 0, PGN_ANGLE, 0, 1, "deg", 0, 360),
+        pgnEdit("SOG", 32, 16, 0, PGN_SPEED, 0, 1, "kn", 0, 40),
+        pgnEnum("Reference", 8, 2, PGN_HEADING_REF_NAMES),
     }},
 
     /* --- Wind Data --- */
 
     /** @brief PGN 130306 - Wind speed and angle */
-    {130306, "Wind Data", "Wind Data", 2, {
-        {"Wind Spd", 0, 50, "m/s"},
-        {"Wind Ang", 0, 360, "deg"},
+    {130306, "Wind Data", "Wind Data", {
+        pgnEdit("Wind Spd", 8, 16, 0, PGN_SPEED, 0, 1, "kn", 0, 100),
+        pgnEdit("Wind Ang", 24, 16, 0, PGN_ANGLE, 0, 0, "deg", 0, 360),
+        pgnEnum("Reference", 40, 3, PGN_WIND_REF_NAMES),
     }},
 
     /* --- Environmental Parameters --- */
 
     /** @brief PGN 130310 - Environmental parameters (outside: water temp, air temp, pressure) */
-    {130310, "Environmental Parameters Outside", "Env Outside", 3, {
-        {"Water Temp", 233, 333, "K"},
-        {"Air Temp", 233, 333, "K"},
-        {"Pressure", 80000, 110000, "Pa"},
+    {130310, "Environmental Parameters Outside", "Env Outside", {
+        pgnEdit("Water Temp", 8, 16, 0, 0.01, PGN_K_TO_C, 1, "C", -40, 60),
+        pgnEdit("Air Temp", 24, 16, 0, 0.01, PGN_K_TO_C, 1, "C", -40, 60),
+        pgnEdit("Pressure", 40, 16, 0, 1, 0, 0, "mbar", 800, 1100),
     }},
 
     /** @brief PGN 130311 - Environmental parameters (general: temp, humidity, pressure) */
-    {130311, "Environmental Parameters", "Env Params", 3, {
-        {"Temp", 233, 333, "K"},
-        {"Humidity", 0, 100, "%"},
-        {"Pressure", 80000, 110000, "Pa"},
+    {130311, "Environmental Parameters", "Env Params", {
+        pgnEdit("Temp", 16, 16, 0, 0.01, PGN_K_TO_C, 1, "C", -40, 60),
+        pgnEdit("Humidity", 32, 16, PGN_FIELD_SIGNED, PGN_PERCENT, 0, 1, "%", 0, 100),
+        pgnEdit("Pressure", 48, 16, 0, 1, 0, 0, "mbar", 800, 1100),
+        pgnEnum("Temp Src", 8, 6, PGN_TEMP_SOURCE_NAMES),
+        pgnEnum("Hum Src", 14, 2, PGN_HUMIDITY_SOURCE_NAMES),
     }},
 
     /** @brief PGN 130312 - Temperature (actual and set point) */
-    {130312, "Temperature", "Temperature", 2, {
-        {"Actual", 233, 400, "K"},
-        {"Set", 233, 400, "K"},
+    {130312, "Temperature", "Temperature", {
+        pgnValue("Instance", 8, 8, 0, 1, 0, 0, ""),
+        pgnEnum("Source", 16, 8, PGN_TEMP_SOURCE_NAMES),
+        pgnEdit("Actual", 24, 16, 0, 0.01, PGN_K_TO_C, 1, "C", -40, 127),
+        pgnEdit("Set", 40, 16, 0, 0.01, PGN_K_TO_C, 1, "C", -40, 127),
     }},
 
     /** @brief PGN 130313 - Humidity (actual and set point) */
-    {130313, "Humidity", "Humidity", 2, {
-        {"Actual", 0, 100, "%"},
-        {"Set", 0, 100, "%"},
+    {130313, "Humidity", "Humidity", {
+        pgnValue("Instance", 8, 8, 0, 1, 0, 0, ""),
+        pgnEnum("Source", 16, 8, PGN_HUMIDITY_SOURCE_NAMES),
+        pgnEdit("Actual", 24, 16, PGN_FIELD_SIGNED, PGN_PERCENT, 0, 1, "%", 0, 100),
+        pgnEdit("Set", 40, 16, PGN_FIELD_SIGNED, PGN_PERCENT, 0, 1, "%", 0, 100),
     }},
 
     /** @brief PGN 130314 - Atmospheric or hydraulic pressure */
-    {130314, "Pressure", "Pressure", 1, {
-        {"Pressure", 80000, 110000, "Pa"},
+    {130314, "Pressure", "Pressure", {
+        pgnValue("Instance", 8, 8, 0, 1, 0, 0, ""),
+        pgnEdit("Pressure", 24, 32, PGN_FIELD_SIGNED, 0.001, 0, 1, "mbar", 800, 1100),
     }},
 
     /** @brief PGN 130316 - Temperature extended range (actual and set point) */
-    {130316, "Temperature Extended Range", "Temp Extended", 2, {
-        {"Actual", 233, 400, "K"},
-        {"Set", 233, 400, "K"},
+    {130316, "Temperature Extended Range", "Temp Extended", {
+        pgnValue("Instance", 8, 8, 0, 1, 0, 0, ""),
+        pgnEnum("Source", 16, 8, PGN_TEMP_SOURCE_NAMES),
+        pgnEdit("Actual", 24, 24, 0, 0.001, PGN_K_TO_C, 1, "C", -40, 127),
+        pgnEdit("Set", 48, 16, 0, 0.1, PGN_K_TO_C, 1, "C", -40, 127),
     }},
 
     /* --- Trim and Control Surfaces --- */
 
     /** @brief PGN 130576 - Trim tab position (port and starboard) */
-    {130576, "Trim Tab Status", "Trim Tab", 2, {
-        {"Port", -100, 100, "%"},
-        {"Starboard", -100, 100, "%"},
+    {130576, "Trim Tab Status", "Trim Tab", {
+        pgnEdit("Port", 0, 8, PGN_FIELD_SIGNED, 1, 0, 0, "%", -100, 100),
+        pgnEdit("Starboard", 8, 8, PGN_FIELD_SIGNED, 1, 0, 0, "%", -100, 100),
     }},
 
     /** @brief PGN 130577 - Direction data (comprehensive navigation data) */
-    {130577, "Direction Data", "Direction", 5, {
-        {"COG", 0, 360, "deg"},
-        {"SOG", 0, 20, "m/s"},
-        {"Heading", 0, 360, "deg"},
-        {"Set", 0, 360, "deg"},
-        {"Drift", 0, 10, "m/s"},
+    {130577, "Direction Data", "Direction", {
+        pgnEnum("Mode", 0, 4, PGN_DATA_MODE_NAMES),
+        pgnEdit("COG", 16, 16, 0, PGN_ANGLE, 0, 0, "deg", 0, 360),
+        pgnEdit("SOG", 32, 16, 0, PGN_SPEED, 0, 1, "kn", 0, 40),
+        pgnEdit("Heading", 48, 16, 0, PGN_ANGLE, 0, 0, "deg", 0, 360),
+        pgnValue("STW", 64, 16, 0, PGN_SPEED, 0, 1, "kn"),
+        pgnEdit("Set", 80, 16, 0, PGN_ANGLE, 0, 0, "deg", 0, 360),
+        pgnEdit("Drift", 96, 16, 0, PGN_SPEED, 0, 1, "kn", 0, 20),
     }},
 };
 
@@ -395,15 +553,18 @@ const char* getPGNShortName(uint32_t pgn);
  * @brief Get the number of editable fields for a PGN.
  *
  * @param pgn The PGN number to look up
- * @return Number of fields (1 to MAX_PGN_FIELDS), or 0 if PGN not found
+ * @return Number of fields marked PGN_FIELD_EDITABLE, or 0 if PGN not found
  */
 int getPGNFieldCount(uint32_t pgn);
 
 /**
- * @brief Get a specific field definition from a PGN.
+ * @brief Get an editable field definition from a PGN.
+ *
+ * Field indices used by the attack code count editable fields only, so
+ * display-only fields in the table don't shift them.
  *
  * @param pgn The PGN number containing the field
- * @param fieldIndex Zero-based index of the field (0 to fieldCount-1)
+ * @param fieldIndex Zero-based index among the editable fields (0 to getPGNFieldCount()-1)
  * @return Pointer to PGNFieldDef, or nullptr if PGN or field not found
  */
 const PGNFieldDef* getPGNField(uint32_t pgn, int fieldIndex);
@@ -424,23 +585,135 @@ const PGNFieldDef* getPGNField(uint32_t pgn, int fieldIndex);
 void getPGNFieldRange(uint32_t pgn, int fieldIndex, float& minOut, float& maxOut);
 
 /**
- * @brief Get a list of all field names for a PGN.
- *
- * Returns a vector containing the names of all editable fields for the
- * specified PGN, in order of their field index.
+ * @brief Check if a PGN is in the impersonatable list.
  *
- * @param pgn The PGN number to query
- * @return Vector of field name strings; empty if PGN not found
+ * @param pgn The PGN number to check
+ * @return true if the PGN can be impersonated, false otherwise
  */
-std::vector<String> getPGNFieldNames(uint32_t pgn);
+bool isImpersonatablePGN(uint32_t pgn);
 
 /**
- * @brief Check if a PGN is in the impersonatable list.
+ * @brief Check if a PGN is sent as a fast packet.
+ *
+ * Used wherever frames are built or reassembled without the NMEA2000
+ * library, so NEMO frames a PGN the same way the library does whatever
+ * the payload length.
  *
  * @param pgn The PGN number to check
- * @return true if the PGN can be impersonated, false otherwise
+ * @return true for the fast-packet PGNs the NMEA2000 library knows and the
+ *         proprietary fast-packet ranges
  */
-bool isImpersonatablePGN(uint32_t pgn);
+bool isFastPacketPGN(uint32_t pgn);
+
+/**
+ * @brief Count the described fields of a PGN definition.
+ *
+ * @param def PGN definition
+ * @return Number of used entries in def.fields
+ */
+constexpr int getPGNDefFieldTotal(const PGNDef& def) {
+    int count = 0;
+    while (count < MAX_PGN_FIELDS && def.fields[count].name != nullptr) count++;
+    return count;
+}
+
+/**
+ * @brief Count the editable fields of a PGN definition.
+ *
+ * @param def PGN definition
+ * @return Number of fields marked PGN_FIELD_EDITABLE
+ */
+constexpr int getPGNDefEditableCount(const PGNDef& def) {
+    int count = 0;
+    for (int i = 0; i < getPGNDefFieldTotal(def); i++) {
+        if (def.fields[i].flags & PGN_FIELD_EDITABLE) count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Read the raw value of a field from a PGN payload.
+ *
+ * Extracts bitWidth bits starting at bitOffset (little-endian) and sign
+ * extends signed fields.
+ *
+ * @param field Field description
+ * @param data Payload bytes
+ * @param dataLen Number of payload bytes
+ * @param[out] raw Raw field value
+ * @return true if the field is present and not one of the N/A sentinels
+ */
+bool decodePGNField(const PGNFieldDef& field, const uint8_t* data, uint8_t dataLen, int32_t& raw);
+
+/**
+ * @brief Convert a raw field value to display units.
+ *
+ * @param field Field description
+ * @param raw Raw value from decodePGNField()
+ * @return raw * scale + offset
+ */
+inline double getPGNFieldValue(const PGNFieldDef& field, int32_t raw) {
+    return raw * field.scale + field.offset;
+}
+
+/**
+ * @brief Write a value in display units into a PGN payload.
+ *
+ * The value is rounded to the field resolution and clamped to the raw range,
+ * below the N/A sentinels. Bits outside the field are left untouched.
+ *
+ * @param field Field description
+ * @param data Payload bytes to modify
+ * @param dataLen Number of payload bytes
+ * @param value New value in display units
+ * @return true if the field fits in the payload and was written
+ */
+bool encodePGNField(const PGNFieldDef& field, uint8_t* data, uint8_t dataLen, double value);
+
+/**
+ * @struct PGNFieldPatch
+ * @brief Position of a field in a payload of known length, resolved ahead of time.
+ *
+ * Lets a caller that writes the same field over and over skip the bounds
+ * check and the conversion from display units; see writePGNFieldPatch().
+ */
+struct PGNFieldPatch {
+    uint8_t firstByte;      ///< First payload byte the field touches
+    uint8_t lastByte;       ///< Last payload byte the field touches
+    uint8_t shift;          ///< Bit position of the field within firstByte
+    uint32_t mask;          ///< Mask of bitWidth ones
+};
+
+/**
+ * @brief Convert a value in display units to the raw value encodePGNField() writes.
+ *
+ * @param field Field description
+ * @param value Value in display units
+ * @return Raw value, rounded and clamped below the N/A sentinels
+ */
+int32_t getPGNFieldRaw(const PGNFieldDef& field, double value);
+
+/**
+ * @brief Resolve where a field sits in a payload.
+ *
+ * @param field Field description
+ * @param dataLen Number of payload bytes
+ * @param[out] patch Receives the byte range, shift and mask
+ * @return true if the field fits in the payload
+ */
+bool compilePGNFieldPatch(const PGNFieldDef& field, uint8_t dataLen, PGNFieldPatch& patch);
+
+/**
+ * @brief Write a raw value through a resolved patch.
+ *
+ * Bits outside the field are left untouched. No range checks are done;
+ * raw should come from getPGNFieldRaw() or lie between two such values.
+ *
+ * @param patch Patch from compilePGNFieldPatch()
+ * @param data Payload bytes to modify
+ * @param raw Raw field value
+ */
+void writePGNFieldPatch(const PGNFieldPatch& patch, uint8_t* data, int32_t raw);
 
 /**
  * @brief Get a manufacturer definition by array index.
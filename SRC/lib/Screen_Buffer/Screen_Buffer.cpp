@@ -0,0 +1,161 @@
+/**
+ * \file Screen_Buffer.cpp
+ * \brief Implementation of the diffed OLED text buffer
+ *
+ * Contains the buffer drawing calls, the glyph renderer and the budgeted
+ * flush that sends only changed cells.
+ */
+
+#include "Screen_Buffer.h"
+#include <Zone_Profiler.h>
+
+Screen_Buffer::Screen_Buffer(U8X8* u8x8) {
+    display = u8x8;
+    font = u8x8_font_artossans8_r;
+    inverse = false;
+    flushRow = 0;
+    foreignRows = 0;
+    tilesSent = 0;
+    flushCount = 0;
+
+    clear();
+    invalidate();
+}
+
+void Screen_Buffer::begin() {
+    display->clearDisplay();
+    memset(shownText, ' ', sizeof(shownText));
+    memset(shownInverse, 0, sizeof(shownInverse));
+}
+
+void Screen_Buffer::invalidate() {
+    // No drawn cell is ever NUL, so every cell compares as changed
+    memset(shownText, 0, sizeof(shownText));
+}
+
+void Screen_Buffer::setForeignRows(uint8_t rowMask) {
+    uint8_t released = foreignRows & ~rowMask;
+    for(uint8_t row = 0; row < SCREEN_ROWS; row++) {
+        if((released >> row) & 1) memset(shownText[row], 0, SCREEN_COLS);
+    }
+    foreignRows = rowMask;
+}
+
+void Screen_Buffer::clear() {
+    memset(text, ' ', sizeof(text));
+    memset(inverseMask, 0, sizeof(inverseMask));
+}
+
+void Screen_Buffer::setFont(const uint8_t* fontData) {
+    if(fontData == nullptr || fontData == font) return;
+    font = fontData;
+    invalidate();
+}
+
+void Screen_Buffer::drawString(uint8_t x, uint8_t y, const char* str) {
+    if(y >= SCREEN_ROWS || str == nullptr) return;
+
+    for(uint8_t col = x; col < SCREEN_COLS && *str != '\0'; col++, str++) {
+        text[y][col] = *str;
+        if(inverse) {
+            inverseMask[y] |= (1u << col);
+        } else {
+            inverseMask[y] &= ~(1u << col);
+        }
+    }
+}
+
+bool Screen_Buffer::isDirty(uint8_t row, uint8_t col) const {
+    if(text[row][col] != shownText[row][col]) return true;
+    return ((inverseMask[row] ^ shownInverse[row]) >> col) & 1;
+}
+
+bool Screen_Buffer::isClean() const {
+    for(uint8_t row = 0; row < SCREEN_ROWS; row++) {
+        if((foreignRows >> row) & 1) continue;
+        if(inverseMask[row] != shownInverse[row]) return false;
+        if(memcmp(text[row], shownText[row], SCREEN_COLS) != 0) return false;
+    }
+    return true;
+}
+
+/**
+ * \brief Render one cell into an 8-byte U8x8 tile
+ *
+ * U8x8 fonts start with the first and last encoding and the glyph size in
+ * tiles, followed by 8 column bytes per tile. Only single-tile glyphs are
+ * supported; characters outside the font render blank.
+ *
+ * \param row Cell row
+ * \param col Cell column
+ * \param[out] tile Receives the 8 column bytes of the tile
+ */
+void Screen_Buffer::renderTile(uint8_t row, uint8_t col, uint8_t* tile) const {
+    uint8_t c = (uint8_t)text[row][col];
+    uint8_t first = u8x8_pgm_read(font + 0);
+    uint8_t last = u8x8_pgm_read(font + 1);
+    uint8_t invert = ((inverseMask[row] >> col) & 1) ? 0xFF : 0x00;
+
+    if(c < first || c > last) {
+        memset(tile, invert, 8);
+        return;
+    }
+
+    const uint8_t* glyph = font + 4 + (uint16_t)(c - first) * 8;
+    for(uint8_t i = 0; i < 8; i++) {
+        tile[i] = u8x8_pgm_read(glyph + i) ^ invert;
+    }
+}
+
+/**
+ * \brief Send changed cells to the panel
+ *
+ * Each run of adjacent changed cells in a row is rendered into one tile
+ * buffer and sent with a single drawTile() call, which costs one address
+ * setup on the bus instead of one per character.
+ *
+ * \param maxTiles Maximum number of tiles to send in this call
+ * \return Number of tiles sent
+ */
+uint16_t Screen_Buffer::flush(uint16_t maxTiles) {
+    PROFILE_ZONE(PROFILE_SCREEN_FLUSH);
+    uint8_t tiles[SCREEN_COLS * 8];
+    uint16_t budget = maxTiles;
+
+    for(uint8_t i = 0; i < SCREEN_ROWS && budget > 0; i++) {
+        uint8_t row = (flushRow + i) % SCREEN_ROWS;
+        uint8_t col = 0;
+        if((foreignRows >> row) & 1) continue;
+
+        while(col < SCREEN_COLS && budget > 0) {
+            if(!isDirty(row, col)) {
+                col++;
+                continue;
+            }
+
+            uint8_t start = col;
+            while(col < SCREEN_COLS && col - start < budget && isDirty(row, col)) {
+                renderTile(row, col, &tiles[(col - start) * 8]);
+                col++;
+            }
+
+            uint8_t count = col - start;
+            display->drawTile(start, row, count, tiles);
+
+            uint16_t runMask = ((1u << count) - 1) << start;
+            memcpy(&shownText[row][start], &text[row][start], count);
+            shownInverse[row] = (shownInverse[row] & ~runMask) | (inverseMask[row] & runMask);
+            budget -= count;
+        }
+
+        // Out of budget - resume in this row next time
+        if(budget == 0) flushRow = row;
+    }
+
+    uint16_t sent = maxTiles - budget;
+    if(sent > 0) {
+        tilesSent += sent;
+        flushCount++;
+    }
+    return sent;
+}
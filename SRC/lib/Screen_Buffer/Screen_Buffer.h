@@ -0,0 +1,196 @@
+/**
+ * \file Screen_Buffer.h
+ * \brief Text-mode back buffer for the OLED with incremental, diffed flushing
+ *
+ * Drawing straight to the U8x8 driver sends every character over I2C the
+ * moment it is drawn, and a full clear-and-redraw screen sends all 128
+ * tiles even when a single row changed (e.g. a scrolling device name).
+ *
+ * Screen_Buffer offers the same drawing calls the menus use (clear,
+ * drawString, setInverseFont, ...) but only writes into a 16x8 character
+ * buffer with one inverse bit per cell. flush() compares it with what the
+ * panel currently shows and sends only the cells that differ. Neighbouring
+ * changed cells go out as one drawTile() transfer, and a tile budget per
+ * call bounds the time spent on the bus.
+ *
+ * Rows can be handed to another driver (e.g. a U8g2 graph) with
+ * setForeignRows(); flush() leaves them alone until they are handed back.
+ */
+
+#ifndef SCREEN_BUFFER_H
+#define SCREEN_BUFFER_H
+
+#include <Arduino.h>
+#include <U8x8lib.h>
+#include "constants.h"
+
+/**
+ * \brief Number of character columns of the buffer
+ */
+#define SCREEN_COLS 16
+
+/**
+ * \brief Number of character rows of the buffer
+ */
+#define SCREEN_ROWS 8
+
+/**
+ * \class Screen_Buffer
+ * \brief Drop-in drawing target for the menus, backed by a frame diff
+ *
+ * Drawing never touches the bus. Call flush() regularly (the loop scheduler
+ * does) to bring the panel up to date.
+ */
+class Screen_Buffer {
+private:
+    U8X8* display;                              ///< Display driver the buffer is flushed to
+    const uint8_t* font;                        ///< 8x8 U8x8 font used to render cells
+    bool inverse;                               ///< Inverse mode for subsequent drawString() calls
+
+    char text[SCREEN_ROWS][SCREEN_COLS];        ///< Characters to show
+    uint16_t inverseMask[SCREEN_ROWS];          ///< Inverse flag of each cell, bit = column
+    char shownText[SCREEN_ROWS][SCREEN_COLS];   ///< Characters currently on the panel
+    uint16_t shownInverse[SCREEN_ROWS];         ///< Inverse flags currently on the panel
+    uint8_t flushRow;                           ///< Row the next flush() starts at
+    uint8_t foreignRows;                        ///< Rows drawn by someone else, bit = row
+
+    uint32_t tilesSent;                         ///< Tiles sent since construction
+    uint32_t flushCount;                        ///< flush() calls that sent at least one tile
+
+    /**
+     * \brief Check whether a cell differs from the panel
+     *
+     * \param row Cell row
+     * \param col Cell column
+     * \return true if the cell needs to be sent
+     */
+    bool isDirty(uint8_t row, uint8_t col) const;
+
+    /**
+     * \brief Render one cell into an 8-byte U8x8 tile
+     *
+     * \param row Cell row
+     * \param col Cell column
+     * \param[out] tile Receives the 8 column bytes of the tile
+     */
+    void renderTile(uint8_t row, uint8_t col, uint8_t* tile) const;
+
+public:
+    /**
+     * \brief Construct a blank buffer for a display
+     *
+     * \param u8x8 Display driver to flush to
+     */
+    Screen_Buffer(U8X8* u8x8);
+
+    /**
+     * \brief Clear the panel and mark it as matching an empty buffer
+     *
+     * Call after the display driver's begin().
+     */
+    void begin();
+
+    /**
+     * \brief Force the next flushes to resend every cell
+     *
+     * Use after something else drew on the panel directly.
+     */
+    void invalidate();
+
+    /**
+     * \brief Hand rows over to another driver drawing on the same panel
+     *
+     * flush() skips the rows in the mask and isClean() ignores them. Rows
+     * leaving the mask are resent in full, since the panel shows whatever
+     * the other driver left there.
+     *
+     * \param rowMask Foreign rows, bit = row; 0 to own the whole panel again
+     */
+    void setForeignRows(uint8_t rowMask);
+
+    /**
+     * \brief Blank the whole buffer
+     */
+    void clear();
+
+    /**
+     * \brief Kept for U8x8 compatibility, the buffer has no cursor
+     */
+    void home() {}
+
+    /**
+     * \brief Select the 8x8 U8x8 font cells are rendered with
+     *
+     * Changing the font resends the whole screen.
+     *
+     * \param fontData U8x8 font, e.g. u8x8_font_artossans8_r
+     */
+    void setFont(const uint8_t* fontData);
+
+    /**
+     * \brief Set inverse mode for subsequent drawString() calls
+     *
+     * \param enable 1 to draw inverted, 0 for normal
+     */
+    void setInverseFont(uint8_t enable) { inverse = enable != 0; }
+
+    /**
+     * \brief Write text into the buffer
+     *
+     * Text past the right edge is clipped.
+     *
+     * \param x Start column
+     * \param y Row
+     * \param str Null-terminated text
+     */
+    void drawString(uint8_t x, uint8_t y, const char* str);
+
+    /**
+     * \brief Get the number of character rows
+     *
+     * \return SCREEN_ROWS
+     */
+    uint8_t getRows() const { return SCREEN_ROWS; }
+
+    /**
+     * \brief Get the number of character columns
+     *
+     * \return SCREEN_COLS
+     */
+    uint8_t getCols() const { return SCREEN_COLS; }
+
+    /**
+     * \brief Send changed cells to the panel
+     *
+     * Rows are visited round-robin starting after the row the previous call
+     * stopped in, so a budget smaller than the pending changes still brings
+     * every row up to date over a few calls.
+     *
+     * \param maxTiles Maximum number of tiles to send in this call
+     * \return Number of tiles sent
+     */
+    uint16_t flush(uint16_t maxTiles);
+
+    /**
+     * \brief Check whether the panel already shows the buffer
+     *
+     * \return true if no cell is waiting to be sent
+     */
+    bool isClean() const;
+
+    /**
+     * \brief Get the number of tiles sent so far
+     *
+     * \return Tiles written to the panel
+     */
+    uint32_t getTilesSent() const { return tilesSent; }
+
+    /**
+     * \brief Get the number of flushes that sent anything
+     *
+     * \return Non-empty flush() calls
+     */
+    uint32_t getFlushCount() const { return flushCount; }
+};
+
+#endif // SCREEN_BUFFER_H
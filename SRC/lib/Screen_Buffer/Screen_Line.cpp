@@ -0,0 +1,98 @@
+/**
+ * \file Screen_Line.cpp
+ * \brief Implementation of the fixed-size text row
+ */
+
+#include "Screen_Line.h"
+#include <stdarg.h>
+
+Screen_Line& Screen_Line::append(const char* str) {
+    if(str == nullptr) return *this;
+    while(*str != '\0' && length < SCREEN_COLS) {
+        text[length++] = *str++;
+    }
+    text[length] = '\0';
+    return *this;
+}
+
+Screen_Line& Screen_Line::append(const char* str, size_t count) {
+    if(str == nullptr) return *this;
+    while(count > 0 && *str != '\0' && length < SCREEN_COLS) {
+        text[length++] = *str++;
+        count--;
+    }
+    text[length] = '\0';
+    return *this;
+}
+
+Screen_Line& Screen_Line::append(char c) {
+    if(length < SCREEN_COLS) {
+        text[length++] = c;
+        text[length] = '\0';
+    }
+    return *this;
+}
+
+Screen_Line& Screen_Line::appendf(const char* format, ...) {
+    if(length >= SCREEN_COLS) return *this;
+
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(&text[length], sizeof(text) - length, format, args);
+    va_end(args);
+
+    if(written > 0) {
+        length = (length + written > SCREEN_COLS) ? SCREEN_COLS : length + written;
+    }
+    text[length] = '\0';
+    return *this;
+}
+
+Screen_Line& Screen_Line::appendScrolled(const char* str, size_t offset, uint8_t width, uint8_t gap) {
+    if(str == nullptr) return *this;
+    size_t len = strlen(str);
+    size_t cycle = len + gap;
+    if(cycle == 0) return padTo(length + width);
+
+    for(uint8_t i = 0; i < width && length < SCREEN_COLS; i++) {
+        size_t pos = (offset + i) % cycle;
+        text[length++] = (pos < len) ? str[pos] : ' ';
+    }
+    text[length] = '\0';
+    return *this;
+}
+
+Screen_Line& Screen_Line::padTo(uint8_t column) {
+    if(column > SCREEN_COLS) column = SCREEN_COLS;
+    while(length < column) {
+        text[length++] = ' ';
+    }
+    text[length] = '\0';
+    return *this;
+}
+
+Screen_Line& Screen_Line::truncate(uint8_t len) {
+    if(len < length) {
+        length = len;
+        text[length] = '\0';
+    }
+    return *this;
+}
+
+void truncateText(const char* str, int maxLen, char* out) {
+    if(maxLen < 0) maxLen = 0;
+    int len = (int)strlen(str);
+    if(len <= maxLen) {
+        memcpy(out, str, len + 1);
+        return;
+    }
+
+    // Room for an ellipsis, otherwise just cut
+    if(maxLen > 3) {
+        memcpy(out, str, maxLen - 3);
+        memcpy(&out[maxLen - 3], "...", 4);
+    } else {
+        memcpy(out, str, maxLen);
+        out[maxLen] = '\0';
+    }
+}
@@ -0,0 +1,132 @@
+/**
+ * \file Screen_Line.h
+ * \brief Fixed-size text row for building menu lines without the heap
+ *
+ * Building a row out of String concatenation and substring() allocates on
+ * every redraw and every scroll step, and over a long run the fragments
+ * are what eventually make an allocation fail. A Screen_Line is one row of
+ * the screen, SCREEN_COLS characters plus the terminator, on the stack.
+ * Text appended past the right edge is dropped, so nothing ever overflows.
+ */
+
+#ifndef SCREEN_LINE_H
+#define SCREEN_LINE_H
+
+#include <Arduino.h>
+#include "Screen_Buffer.h"
+
+/**
+ * \class Screen_Line
+ * \brief One row of screen text, appended to in place
+ */
+class Screen_Line {
+private:
+    char text[SCREEN_COLS + 1];     ///< Row text, always terminated
+    uint8_t length;                 ///< Characters in text
+
+public:
+    /**
+     * \brief Construct an empty row
+     */
+    Screen_Line() { clear(); }
+
+    /**
+     * \brief Construct a row holding a text
+     *
+     * \param str Null-terminated text, clipped to the row
+     */
+    explicit Screen_Line(const char* str) { clear(); append(str); }
+
+    /**
+     * \brief Empty the row
+     */
+    void clear() { length = 0; text[0] = '\0'; }
+
+    /**
+     * \brief Append text
+     *
+     * \param str Null-terminated text, nullptr appends nothing
+     * \return This row
+     */
+    Screen_Line& append(const char* str);
+
+    /**
+     * \brief Append at most count characters of a text
+     *
+     * \param str Text, a terminator before count ends it early
+     * \param count Characters to take
+     * \return This row
+     */
+    Screen_Line& append(const char* str, size_t count);
+
+    /**
+     * \brief Append one character
+     *
+     * \param c Character
+     * \return This row
+     */
+    Screen_Line& append(char c);
+
+    /**
+     * \brief Append printf-formatted text
+     *
+     * \param format printf format
+     * \return This row
+     */
+    Screen_Line& appendf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    /**
+     * \brief Append a window onto a text scrolling in a loop
+     *
+     * The text is followed by gap spaces and repeats, the way a marquee
+     * shows "name   name"; offset picks the first character shown.
+     *
+     * \param str Null-terminated text
+     * \param offset Start position in the looping text
+     * \param width Characters to append
+     * \param gap Spaces between the end of the text and its repeat
+     * \return This row
+     */
+    Screen_Line& appendScrolled(const char* str, size_t offset, uint8_t width, uint8_t gap = 3);
+
+    /**
+     * \brief Append spaces up to a column
+     *
+     * \param column Column to pad to, at most SCREEN_COLS
+     * \return This row
+     */
+    Screen_Line& padTo(uint8_t column);
+
+    /**
+     * \brief Cut the row down to a length
+     *
+     * \param len Characters to keep
+     * \return This row
+     */
+    Screen_Line& truncate(uint8_t len);
+
+    /**
+     * \brief Get the row text
+     *
+     * \return Null-terminated text
+     */
+    const char* c_str() const { return text; }
+
+    /**
+     * \brief Get the number of characters in the row
+     *
+     * \return Length, at most SCREEN_COLS
+     */
+    uint8_t size() const { return length; }
+};
+
+/**
+ * \brief Copy a text into a buffer, cut to fit with "..." if it is too long
+ *
+ * \param str Null-terminated text
+ * \param maxLen Characters the result may have
+ * \param[out] out Receives the text, at least maxLen + 1 bytes
+ */
+void truncateText(const char* str, int maxLen, char* out);
+
+#endif // SCREEN_LINE_H
@@ -13,26 +13,42 @@
 
 #include <Sensor.h>
 #include <PGN_Helpers.h>
+#include <Zone_Profiler.h>
+
+/**
+ * \brief Trace played back by SOURCE_TRACE
+ *
+ * A potentiometer recording of a gusting value: a slow swell with short
+ * spikes and a calm stretch, so displays see both trends and outliers.
+ * Points are spread evenly over the source period and interpolated.
+ */
+static const uint16_t SENSOR_TRACE[] = {
+    420, 455, 498, 530, 562, 610, 702, 655, 590, 571, 560, 548,
+    530, 512, 880, 640, 505, 470, 430, 402, 380, 366, 360, 358,
+    361, 372, 388, 940, 610, 450, 425, 415
+};
+
+/**
+ * \brief Number of points in SENSOR_TRACE
+ */
+static constexpr uint16_t SENSOR_TRACE_POINTS = sizeof(SENSOR_TRACE) / sizeof(SENSOR_TRACE[0]);
 
 //*****************************************************************************
 /**
- * \brief Read and smooth analog input from potentiometer
+ * \brief Read the smoothed analog input from the potentiometer
  *
- * Performs multiple ADC readings and averages them to reduce noise and
- * provide stable sensor values. The potentiometer reading is inverted
- * (1023 - value) to match expected rotation direction.
+ * Returns the moving average the Analog_Sampler keeps up to date in the
+ * background, so no time is spent waiting for the ADC. The potentiometer
+ * reading is inverted (1023 - value) to match expected rotation direction.
  *
- * \return int Smoothed analog value (0-1023), averaged from 5 readings
+ * \return int Smoothed analog value (0-1023)
  */
 int Sensor::readAnalog() {
-    // Simple averaging for stability - take 5 samples to reduce noise
-    int sum = 0;
-    for (int i = 0; i < 5; i++) {
-      // Invert reading (1023 - value) so clockwise rotation increases value
-      sum += (1023-analogRead(pin));
-      delay(1);  // Brief delay for ADC stabilization between readings
+    if (sampler != nullptr && samplerChannel >= 0) {
+        return 1023 - sampler->read(samplerChannel);
     }
-    return sum / 5;  // Return arithmetic mean of samples
+    // No sampler attached - single unfiltered reading
+    return 1023 - analogRead(pin);
 }
 
 //*****************************************************************************
@@ -58,12 +74,31 @@ Sensor::Sensor(uint8_t analogPin, MessageType type, tNMEA2000_Teensyx* CAN_Inter
     deviceIndex = devIndex;
     manufacturerCode = 2046;  // Default manufacturer code (reserved range)
     savedAddress = 22 + devIndex;  // Default starting address offset from base
+    sampler = nullptr;
+    samplerChannel = -1;
+    valueSource = SOURCE_POT;
+    sourcePeriod = SENSOR_SOURCE_PERIOD_MS;
+    sendInterval = SENSOR_SEND_INTERVAL_MS;
     pinMode(pin, INPUT);
 
     // Set default custom name based on device index (e.g., "Sensor 1", "Sensor 2")
     snprintf(customName, sizeof(customName), "Sensor %d", devIndex + 1);
 }
 
+//*****************************************************************************
+/**
+ * \brief Take readings from a background sampler
+ *
+ * Registers this sensor's pin with the sampler. If the sampler has no free
+ * channel the sensor keeps reading the pin directly.
+ *
+ * \param analogSampler Sampler to register with, before its begin()
+ */
+void Sensor::attachSampler(Analog_Sampler* analogSampler) {
+    sampler = analogSampler;
+    samplerChannel = (sampler != nullptr) ? sampler->addPin(pin) : -1;
+}
+
 //*****************************************************************************
 /**
  * \brief Set the message type (PGN) this sensor will transmit
@@ -89,14 +124,76 @@ MessageType Sensor::getMessageType() {
 
 //*****************************************************************************
 /**
- * \brief Update sensor reading from analog input
+ * \brief Set where the value comes from
+ *
+ * \param source New value source, ignored if out of range
+ * \param periodMillis Period of the ramp, sine or trace (ignored for SOURCE_POT)
+ */
+void Sensor::setValueSource(ValueSource source, uint32_t periodMillis) {
+    if (source >= SOURCE_COUNT) return;
+    valueSource = source;
+    if (periodMillis > 0) sourcePeriod = periodMillis;
+}
+
+//*****************************************************************************
+/**
+ * \brief Set the time between two transmissions
+ *
+ * \param intervalMillis Transmit interval (ms), raised to SENSOR_MIN_SEND_INTERVAL_MS
+ */
+void Sensor::setSendInterval(uint32_t intervalMillis) {
+    sendInterval = max(intervalMillis, SENSOR_MIN_SEND_INTERVAL_MS);
+}
+
+//*****************************************************************************
+/**
+ * \brief Generate the value of a ramp, sine or trace source
+ *
+ * The position in the period is taken from millis(), shifted by a quarter
+ * second per device index so devices with the same source don't move in
+ * lockstep.
  *
- * Reads the current potentiometer value and stores it for subsequent
- * message transmission. Should be called periodically from the main loop
- * before sendMessage().
+ * \return int Generated value (0-1023)
+ */
+int Sensor::generateValue() {
+    uint32_t t = (millis() + (uint32_t)deviceIndex * 250) % sourcePeriod;
+    float phase = (float)t / sourcePeriod;
+
+    switch (valueSource) {
+      case SOURCE_RAMP:
+        return (int)(phase * 1023.0f);
+      case SOURCE_SINE:
+        return (int)((0.5f + 0.5f * sinf(2.0f * (float)PI * phase)) * 1023.0f);
+      case SOURCE_TRACE: {
+        // Linear interpolation between neighbouring points, wrapping at the end
+        float position = phase * SENSOR_TRACE_POINTS;
+        uint16_t index = (uint16_t)position;
+        float fraction = position - index;
+        int from = SENSOR_TRACE[index % SENSOR_TRACE_POINTS];
+        int to = SENSOR_TRACE[(index + 1) % SENSOR_TRACE_POINTS];
+        return from + (int)((to - from) * fraction);
+      }
+      default:
+        return rawValue;
+    }
+}
+
+//*****************************************************************************
+/**
+ * \brief Update sensor reading from its value source
+ *
+ * Stores the current filtered potentiometer value, or the generated value,
+ * for subsequent message transmission. Only reads a value the sampler
+ * already computed, so it is cheap enough to call on every loop pass and
+ * keeps getRawValue() fresh for the impersonation attack.
  */
 void Sensor::update() {
-    rawValue = readAnalog();
+    PROFILE_ZONE(PROFILE_SENSOR_UPDATE);
+    if (valueSource == SOURCE_POT) {
+        rawValue = readAnalog();
+    } else {
+        rawValue = generateValue();
+    }
 }
 
 //*****************************************************************************
@@ -141,10 +238,10 @@ float Sensor::mapToRange(float min, float max) {
 
 //*****************************************************************************
 /**
- * \brief Transmit NMEA2000 message based on current sensor type
+ * \brief Build NMEA2000 message based on current sensor type
  *
- * Builds and sends the appropriate PGN message using the current
- * raw value and message type setting. Does nothing if sensor is inactive.
+ * Builds the appropriate PGN message using the current raw value and
+ * message type setting. The source address is left to the caller.
  *
  * The message type determines which PGN is transmitted:
  * - MSG_ENGINE_RPM: PGN 127488 (Engine Parameters, Rapid Update)
@@ -160,14 +257,12 @@ float Sensor::mapToRange(float min, float max) {
  * - MSG_BATTERY_VOLT: PGN 127508 (Battery Status)
  * - MSG_TANK_LEVEL: PGN 127505 (Fluid Level)
  *
+ * \param N2kMsg Reference to NMEA2000 message object to populate
+ * \return bool True if a message was built
+ *
  * \sa update(), setMessageType()
  */
-void Sensor::sendMessage() {
-    // Skip transmission if sensor is deactivated
-    if(!active) return;
-
-    tN2kMsg N2kMsg;
-
+bool Sensor::buildMessage(tN2kMsg &N2kMsg) {
     // Dispatch to appropriate PGN handler based on configured message type
     switch (messageType) {
       case MSG_ENGINE_RPM:
@@ -209,14 +304,35 @@ void Sensor::sendMessage() {
       case MSG_TANK_LEVEL:
         sendTankLevel(N2kMsg);
         break;
+      default:
+        return false;
     }
+    return true;
+}
+
+//*****************************************************************************
+/**
+ * \brief Transmit NMEA2000 message based on current type
+ *
+ * Builds the message and sends it right away through the library, from
+ * this device's address. Does nothing if sensor is inactive.
+ *
+ * \return bool True if the driver accepted the message
+ */
+bool Sensor::sendMessage() {
+    // Skip transmission if sensor is deactivated
+    if(!active) return false;
+
+    tN2kMsg N2kMsg;
+    if(!buildMessage(N2kMsg)) return false;
+    return NMEA2000->SendMsg(N2kMsg, deviceIndex);
 }
 
 //*****************************************************************************
 /**
  * \brief Send Engine RPM message (PGN 127488)
  *
- * Transmits Engine Parameters Rapid Update message with simulated
+ * Builds Engine Parameters Rapid Update message with simulated
  * engine speed. Maps potentiometer to 0-6000 RPM range.
  *
  * \param N2kMsg Reference to NMEA2000 message object to populate
@@ -229,14 +345,13 @@ void Sensor::sendEngineRPM(tN2kMsg &N2kMsg) {
 
     SetN2kEngineParamRapid(N2kMsg, EngineInstance, EngineSpeed,
                            EngineBoostPressure, EngineTiltTrim);
-    NMEA2000->SendMsg(N2kMsg, deviceIndex);
 }
 
 //*****************************************************************************
 /**
  * \brief Send Water Depth message (PGN 128267)
  *
- * Transmits Water Depth message with simulated depth below transducer.
+ * Builds Water Depth message with simulated depth below transducer.
  * Maps potentiometer to 0-100 meter range.
  *
  * \param N2kMsg Reference to NMEA2000 message object to populate
@@ -248,14 +363,13 @@ void Sensor::sendWaterDepth(tN2kMsg &N2kMsg) {
     double Range = 100.0;  // Maximum measurable depth (meters)
 
     SetN2kWaterDepth(N2kMsg, SID, DepthBelowTransducer, Offset, Range);
-    NMEA2000->SendMsg(N2kMsg, deviceIndex);
 }
 
 //*****************************************************************************
 /**
  * \brief Send Vessel Heading message (PGN 127250)
  *
- * Transmits Magnetic Heading message with simulated compass heading.
+ * Builds Magnetic Heading message with simulated compass heading.
  * Maps potentiometer to 0-360 degree range.
  *
  * \param N2kMsg Reference to NMEA2000 message object to populate
@@ -268,14 +382,13 @@ void Sensor::sendHeading(tN2kMsg &N2kMsg) {
     double Variation = DegToRad(-5.0);  // Magnetic variation (5 degrees West)
 
     SetN2kMagneticHeading(N2kMsg, SID, Heading, Deviation, Variation);
-    NMEA2000->SendMsg(N2kMsg, deviceIndex);
 }
 
 //*****************************************************************************
 /**
  * \brief Send Speed message (PGN 128259)
  *
- * Transmits Speed Water Referenced message with simulated boat speed.
+ * Builds Speed Water Referenced message with simulated boat speed.
  * Maps potentiometer to 0-20 knots (0-10.29 m/s) range.
  *
  * \param N2kMsg Reference to NMEA2000 message object to populate
@@ -288,14 +401,13 @@ void Sensor::sendSpeed(tN2kMsg &N2kMsg) {
     tN2kSpeedWaterReferenceType SWRT = N2kSWRT_Paddle_wheel;  // Sensor type
 
     SetN2kBoatSpeed(N2kMsg, SID, WaterReferenced, GroundReferenced, SWRT);
-    NMEA2000->SendMsg(N2kMsg, deviceIndex);
 }
 
 //*****************************************************************************
 /**
  * \brief Send Rudder Angle message (PGN 127245)
  *
- * Transmits Rudder message with simulated rudder position.
+ * Builds Rudder message with simulated rudder position.
  * Maps potentiometer to -45 to +45 degree range (port to starboard).
  *
  * \param N2kMsg Reference to NMEA2000 message object to populate
@@ -308,14 +420,13 @@ void Sensor::sendRudder(tN2kMsg &N2kMsg) {
     double AngleOrder = N2kDoubleNA;  // Commanded angle not available
 
     SetN2kRudder(N2kMsg, RudderPosition, Instance, RudderDirectionOrder, AngleOrder);
-    NMEA2000->SendMsg(N2kMsg, deviceIndex);
 }
 
 //*****************************************************************************
 /**
  * \brief Send Wind Speed message (PGN 130306)
  *
- * Transmits Wind Data message with variable wind speed and fixed angle.
+ * Builds Wind Data message with variable wind speed and fixed angle.
  * Maps potentiometer to 0-50 m/s wind speed range.
  *
  * \param N2kMsg Reference to NMEA2000 message object to populate
@@ -326,14 +437,13 @@ void Sensor::sendWindSpeed(tN2kMsg &N2kMsg) {
     tN2kWindReference windRef = N2kWind_Apparent;  // Apparent wind (relative to boat)
 
     SetN2kWindSpeed(N2kMsg, 1, windSpeed, windAngle, windRef);
-    NMEA2000->SendMsg(N2kMsg, deviceIndex);
 }
 
 //*****************************************************************************
 /**
  * \brief Send Wind Angle message (PGN 130306)
  *
- * Transmits Wind Data message with variable wind angle and fixed speed.
+ * Builds Wind Data message with variable wind angle and fixed speed.
  * Maps potentiometer to 0-360 degree wind angle range.
  *
  * \param N2kMsg Reference to NMEA2000 message object to populate
@@ -344,14 +454,13 @@ void Sensor::sendWindAngle(tN2kMsg &N2kMsg) {
     tN2kWindReference windRef = N2kWind_Apparent;  // Apparent wind (relative to boat)
 
     SetN2kWindSpeed(N2kMsg, 1, windSpeed, windAngle, windRef);
-    NMEA2000->SendMsg(N2kMsg, deviceIndex);
 }
 
 //*****************************************************************************
 /**
  * \brief Send Water Temperature message (PGN 130311)
  *
- * Transmits Environmental Parameters message with simulated sea temperature.
+ * Builds Environmental Parameters message with simulated sea temperature.
  * Maps potentiometer to -5 to +40 degrees Celsius range.
  *
  * \param N2kMsg Reference to NMEA2000 message object to populate
@@ -367,14 +476,13 @@ void Sensor::sendWaterTemp(tN2kMsg &N2kMsg) {
 
     SetN2kEnvironmentalParameters(N2kMsg, SID, TempSource, Temperature,
                                   HumiditySource, Humidity, AtmosphericPressure);
-    NMEA2000->SendMsg(N2kMsg, deviceIndex);
 }
 
 //*****************************************************************************
 /**
  * \brief Send Outside Temperature message (PGN 130310)
  *
- * Transmits Environmental Parameters message with simulated air temperature.
+ * Builds Environmental Parameters message with simulated air temperature.
  * Maps potentiometer to -20 to +50 degrees Celsius range.
  *
  * \param N2kMsg Reference to NMEA2000 message object to populate
@@ -391,14 +499,13 @@ void Sensor::sendOutsideTemp(tN2kMsg &N2kMsg) {
 
     SetN2kEnvironmentalParameters(N2kMsg, SID, TempSource, Temperature,
                                   HumiditySource, Humidity, AtmosphericPressure);
-    NMEA2000->SendMsg(N2kMsg, deviceIndex);
 }
 
 //*****************************************************************************
 /**
  * \brief Send Atmospheric Pressure message (PGN 130314)
  *
- * Transmits Actual Pressure message with simulated barometric pressure.
+ * Builds Actual Pressure message with simulated barometric pressure.
  * Maps potentiometer to 80000-110000 Pascal range (typical atmospheric range).
  *
  * \param N2kMsg Reference to NMEA2000 message object to populate
@@ -414,14 +521,13 @@ void Sensor::sendPressure(tN2kMsg &N2kMsg) {
     double Pressure = mapToRange(80000.0, 110000.0);  // Map pot to 80000-110000 Pa
 
     SetN2kPressure(N2kMsg, SID, PressureInstance, PressureSource, Pressure);
-    NMEA2000->SendMsg(N2kMsg, deviceIndex);
 }
 
 //*****************************************************************************
 /**
  * \brief Send Humidity message (PGN 130313)
  *
- * Transmits Humidity message with simulated relative humidity.
+ * Builds Humidity message with simulated relative humidity.
  * Maps potentiometer to 0-100 percent range.
  *
  * \param N2kMsg Reference to NMEA2000 message object to populate
@@ -436,14 +542,13 @@ void Sensor::sendHumidity(tN2kMsg &N2kMsg) {
 
     SetN2kHumidity(N2kMsg, SID, HumidityInstance, HumiditySource,
                    ActualHumidity, SetHumidity);
-    NMEA2000->SendMsg(N2kMsg, deviceIndex);
 }
 
 //*****************************************************************************
 /**
  * \brief Send Battery Voltage message (PGN 127508)
  *
- * Transmits DC Battery Status message with simulated battery voltage.
+ * Builds DC Battery Status message with simulated battery voltage.
  * Maps potentiometer to 0-30 Volt range.
  *
  * \param N2kMsg Reference to NMEA2000 message object to populate
@@ -458,14 +563,13 @@ void Sensor::sendBatteryVolt(tN2kMsg &N2kMsg) {
 
     SetN2kDCBatStatus(N2kMsg, BatteryInstance, BatteryVoltage, BatteryCurrent,
                       BatteryTemperature, SID);
-    NMEA2000->SendMsg(N2kMsg, deviceIndex);
 }
 
 //*****************************************************************************
 /**
  * \brief Send Tank Level message (PGN 127505)
  *
- * Transmits Fluid Level message with simulated fuel tank level.
+ * Builds Fluid Level message with simulated fuel tank level.
  * Maps potentiometer to 0-100 percent range.
  *
  * \param N2kMsg Reference to NMEA2000 message object to populate
@@ -478,7 +582,6 @@ void Sensor::sendTankLevel(tN2kMsg &N2kMsg) {
     double Capacity = 200.0;  // Tank capacity in liters
 
     SetN2kFluidLevel(N2kMsg, Instance, FluidType, Level, Capacity);
-    NMEA2000->SendMsg(N2kMsg, deviceIndex);
 }
 
 //*****************************************************************************
@@ -17,6 +17,8 @@
 #include <NMEA2000.h>
 #include <N2kMessages.h>
 #include <NMEA2000_Teensyx.h>
+#include <Analog_Sampler.h>
+#include "constants.h"
 
 /** \enum MessageType
  *  \brief Enumeration of supported NMEA2000 message types
@@ -42,20 +44,35 @@ enum MessageType {
     MSG_TANK_LEVEL = 12      ///< Tank fluid level (PGN 127505), range: 0-100%
 };
 
+/** \enum ValueSource
+ *  \brief Where a sensor takes its value from
+ *
+ *  Every source produces the same 0-1023 raw value a potentiometer does,
+ *  so the PGN mapping and the attacks work the same for all of them.
+ */
+enum ValueSource : uint8_t {
+    SOURCE_POT,         ///< Potentiometer reading from the sampler
+    SOURCE_RAMP,        ///< Sawtooth from minimum to maximum over the source period
+    SOURCE_SINE,        ///< Sine wave over the source period
+    SOURCE_TRACE,       ///< Recorded trace played back over the source period
+    SOURCE_COUNT        ///< Number of sources, not a valid source
+};
+
 /** \class Sensor
  *  \brief Simulates an NMEA2000 sensor using analog input
  *
- *  The Sensor class reads an analog potentiometer value and converts it to
- *  NMEA2000 messages for transmission on a CAN bus. Each sensor operates as
- *  a separate NMEA2000 device with its own source address.
+ *  The Sensor class reads an analog potentiometer value (or generates one)
+ *  and converts it to NMEA2000 messages for transmission on a CAN bus. Each
+ *  sensor operates as a separate NMEA2000 device with its own source address.
  *
  *  Features:
  *  - Configurable message type (PGN)
+ *  - Configurable value source and transmit interval
  *  - Configurable manufacturer code for device spoofing
  *  - Active/inactive state control
- *  - Automatic value smoothing via analog averaging
+ *  - Automatic value smoothing by the background Analog_Sampler
  *
- *  \sa MessageType, tNMEA2000_Teensyx
+ *  \sa MessageType, ValueSource, Device_Pool, tNMEA2000_Teensyx
  */
 class Sensor {
 private:
@@ -69,9 +86,14 @@ private:
     uint16_t manufacturerCode;      ///< NMEA2000 manufacturer code for NAME
     char customName[33];            ///< Custom device name (max 32 chars + null)
     uint8_t savedAddress;           ///< Saved source address when going inactive
+    Analog_Sampler* sampler;        ///< Background sampler providing the readings (may be nullptr)
+    int samplerChannel;             ///< Channel of this sensor's pin in the sampler
+    ValueSource valueSource;        ///< Where update() takes the value from
+    uint32_t sourcePeriod;          ///< Period of the generated sources (ms)
+    uint32_t sendInterval;          ///< Time between two transmissions (ms)
 
-    /** \brief Read and smooth analog input
-     *  \return Smoothed analog value (average of 5 readings)
+    /** \brief Read the smoothed analog input
+     *  \return Filtered analog value, inverted so clockwise rotation increases it
      */
     int readAnalog();
 
@@ -93,6 +115,11 @@ private:
      */
     const char* getProductNameForType(MessageType type);
 
+    /** \brief Generate the value of a ramp, sine or trace source
+     *  \return Generated value (0-1023)
+     */
+    int generateValue();
+
     /** \brief Send Engine RPM message (PGN 127488)
      *  \param N2kMsg Reference to message object to populate
      */
@@ -167,6 +194,14 @@ public:
      */
     Sensor(uint8_t analogPin, MessageType type, tNMEA2000_Teensyx* CAN_Interface, int devIndex);
 
+    /** \brief Take readings from a background sampler
+     *  \param analogSampler Sampler to register this sensor's pin with
+     *
+     *  Must be called before Analog_Sampler::begin(). Without a sampler
+     *  the sensor falls back to a single analogRead() per update.
+     */
+    void attachSampler(Analog_Sampler* analogSampler);
+
     /** \brief Set the message type (PGN) this sensor transmits
      *  \param type New message type
      *  \sa MessageType
@@ -178,10 +213,37 @@ public:
      */
     MessageType getMessageType();
 
-    /** \brief Update sensor reading from analog input
+    /** \brief Set where the value comes from
+     *  \param source New value source
+     *  \param periodMillis Period of the ramp, sine or trace (ignored for SOURCE_POT)
+     */
+    void setValueSource(ValueSource source, uint32_t periodMillis);
+
+    /** \brief Get the value source
+     *  \return Current ValueSource
+     */
+    ValueSource getValueSource() const { return valueSource; }
+
+    /** \brief Get the period of the generated sources
+     *  \return Source period (ms)
+     */
+    uint32_t getSourcePeriod() const { return sourcePeriod; }
+
+    /** \brief Set the time between two transmissions
+     *  \param intervalMillis Transmit interval (ms), at least SENSOR_MIN_SEND_INTERVAL_MS
+     */
+    void setSendInterval(uint32_t intervalMillis);
+
+    /** \brief Get the time between two transmissions
+     *  \return Transmit interval (ms)
+     */
+    uint32_t getSendInterval() const { return sendInterval; }
+
+    /** \brief Update sensor reading from its value source
      *
-     *  Reads the analog pin and updates the internal raw value.
-     *  Should be called periodically from the main loop.
+     *  Copies the latest filtered value from the sampler, or computes the
+     *  generated value for the current time, into the internal raw value.
+     *  Constant time, so it can be called on every loop pass.
      */
     void update();
 
@@ -202,12 +264,26 @@ public:
      */
     float mapToRange(float min, float max);
 
+    /** \brief Build the NMEA2000 message for the current type
+     *
+     *  Fills in the appropriate PGN message using the current raw
+     *  value and message type setting, without sending it. Used to
+     *  stage messages for the transmit scheduler.
+     *
+     *  \param N2kMsg Message to fill in; the source is not set
+     *  \return True if a message was built, false for an unknown type
+     */
+    bool buildMessage(tN2kMsg &N2kMsg);
+
     /** \brief Transmit NMEA2000 message based on current type
      *
      *  Builds and sends the appropriate PGN message using the
      *  current raw value and message type setting.
+     *
+     *  \return True if the driver accepted the message, false if it
+     *          refused it or the sensor is inactive
      */
-    void sendMessage();
+    bool sendMessage();
 
     /** \brief Set sensor active/inactive state
      *  \param status True to activate, false to deactivate
@@ -0,0 +1,104 @@
+/**
+ * \file Serial_Console.cpp
+ * \brief Implementation of the serial command console
+ *
+ * Contains the line editor, the tokenizer and the command dispatch.
+ */
+
+#include "Serial_Console.h"
+#include <stdarg.h>
+
+Serial_Console::Serial_Console(Capture_Stream* output) {
+    stream = output;
+    commandCount = 0;
+    lineLen = 0;
+    overflow = false;
+}
+
+bool Serial_Console::addCommand(const char* name, const char* help, ConsoleHandler handler) {
+    if(commandCount >= CONSOLE_MAX_COMMANDS || name == nullptr || handler == nullptr) {
+        return false;
+    }
+    commands[commandCount].name = name;
+    commands[commandCount].help = help;
+    commands[commandCount].handler = handler;
+    commandCount++;
+    return true;
+}
+
+void Serial_Console::handleByte(uint8_t c) {
+    if(c == '\r' || c == '\n') {
+        if(overflow) {
+            printf("error: line too long\r\n");
+        } else if(lineLen > 0) {
+            line[lineLen] = '\0';
+            execute();
+        }
+        lineLen = 0;
+        overflow = false;
+        return;
+    }
+
+    if(c == '\b' || c == 0x7F) {
+        if(lineLen > 0) lineLen--;
+        return;
+    }
+
+    if(c < ' ' || c > '~') return;
+
+    if(lineLen < CONSOLE_LINE_SIZE - 1) {
+        line[lineLen++] = (char)c;
+    } else {
+        overflow = true;
+    }
+}
+
+/**
+ * \brief Split the completed line into words and run its command
+ *
+ * Words are separated by spaces or tabs and split in place. Words beyond
+ * CONSOLE_MAX_ARGS are ignored.
+ */
+void Serial_Console::execute() {
+    char* argv[CONSOLE_MAX_ARGS];
+    int argc = 0;
+    char* p = line;
+
+    while(*p != '\0' && argc < CONSOLE_MAX_ARGS) {
+        while(*p == ' ' || *p == '\t') p++;
+        if(*p == '\0') break;
+        argv[argc++] = p;
+        while(*p != '\0' && *p != ' ' && *p != '\t') p++;
+        if(*p != '\0') *p++ = '\0';
+    }
+    if(argc == 0) return;
+
+    if(strcmp(argv[0], "help") == 0) {
+        printHelp();
+        return;
+    }
+
+    for(uint8_t i = 0; i < commandCount; i++) {
+        if(strcmp(argv[0], commands[i].name) == 0) {
+            commands[i].handler(*this, argc, argv);
+            return;
+        }
+    }
+    printf("unknown command '%s', try 'help'\r\n", argv[0]);
+}
+
+void Serial_Console::printHelp() {
+    printf("%-10s %s\r\n", "help", "list commands");
+    for(uint8_t i = 0; i < commandCount; i++) {
+        printf("%-10s %s\r\n", commands[i].name, commands[i].help ? commands[i].help : "");
+    }
+}
+
+void Serial_Console::printf(const char* format, ...) {
+    char text[CONSOLE_LINE_SIZE + 1];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    stream->writeText(text);
+}
@@ -0,0 +1,106 @@
+/**
+ * \file Serial_Console.h
+ * \brief Line-based command console on the USB serial port
+ *
+ * Lets the host configure NEMO by typing commands such as "filter pgn add
+ * 127488" into a terminal. Bytes arrive through the Capture_Stream text
+ * hook, so the console shares the port with the candump output and steps
+ * aside automatically when SavvyCAN switches the stream to GVRET.
+ *
+ * Commands are registered at startup with a name, a one-line help text and
+ * a handler. A completed line is split into words, and the handler of the
+ * first word is called with the words as argc/argv.
+ */
+
+#ifndef SERIAL_CONSOLE_H
+#define SERIAL_CONSOLE_H
+
+#include <Arduino.h>
+#include <Capture_Stream.h>
+#include "constants.h"
+
+class Serial_Console;
+
+/**
+ * \brief Handler of a console command
+ *
+ * \param console Console the command was typed into, for replies
+ * \param argc Number of words, including the command name
+ * \param argv The words; argv[0] is the command name
+ */
+typedef void (*ConsoleHandler)(Serial_Console& console, int argc, char* argv[]);
+
+/**
+ * \struct ConsoleCommand
+ * \brief A registered console command
+ */
+struct ConsoleCommand {
+    const char* name;           ///< Word that invokes the command
+    const char* help;           ///< One-line description for "help"
+    ConsoleHandler handler;     ///< Function called with the parsed words
+};
+
+/**
+ * \class Serial_Console
+ * \brief Assembles host text into lines and dispatches them to commands
+ */
+class Serial_Console {
+private:
+    Capture_Stream* stream;                         ///< Output for replies
+    ConsoleCommand commands[CONSOLE_MAX_COMMANDS];  ///< Registered commands
+    uint8_t commandCount;                           ///< Entries used in commands
+    char line[CONSOLE_LINE_SIZE];                   ///< Line being typed
+    uint8_t lineLen;                                ///< Characters in line
+    bool overflow;                                  ///< Current line was too long
+
+    /**
+     * \brief Split the completed line into words and run its command
+     */
+    void execute();
+
+    /**
+     * \brief Print the list of registered commands
+     */
+    void printHelp();
+
+public:
+    /**
+     * \brief Construct a console that replies through a capture stream
+     *
+     * \param output Capture stream replies are written to
+     */
+    Serial_Console(Capture_Stream* output);
+
+    /**
+     * \brief Register a command
+     *
+     * "help" is built in and lists all registered commands.
+     *
+     * \param name Word that invokes the command (must stay valid)
+     * \param help One-line description (must stay valid)
+     * \param handler Function to call
+     * \return false if the command table is full
+     */
+    bool addCommand(const char* name, const char* help, ConsoleHandler handler);
+
+    /**
+     * \brief Feed one byte typed by the host
+     *
+     * A line ends at CR or LF. Backspace deletes the last character. Lines
+     * longer than CONSOLE_LINE_SIZE - 1 are rejected as a whole.
+     *
+     * \param c Received byte
+     */
+    void handleByte(uint8_t c);
+
+    /**
+     * \brief Write formatted text to the host
+     *
+     * Output longer than CONSOLE_LINE_SIZE characters is truncated.
+     *
+     * \param format printf-style format
+     */
+    void printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+#endif // SERIAL_CONSOLE_H
@@ -0,0 +1,606 @@
+/**
+ * \file Snapshot_Server.cpp
+ * \brief Implementation of the snapshot protocol
+ *
+ * Contains the COBS framing and CRC, the request handlers and the
+ * serializers of the monitor tables.
+ */
+
+#include "Snapshot_Server.h"
+
+/// Protocol version reported by SNAPSHOT_HELLO
+static constexpr uint8_t SNAPSHOT_VERSION = 1;
+
+/// Flag of the last packet of a bulk response
+static constexpr uint8_t BULK_LAST = 0x01;
+
+/// Flag of a field list that didn't fit into one packet
+static constexpr uint8_t FIELDS_TRUNCATED = 0x01;
+
+/// Device flags of SNAPSHOT_DEVICES entries
+static constexpr uint8_t DEVICE_HAS_NAME = 0x01;
+static constexpr uint8_t DEVICE_HAS_HEARTBEAT = 0x02;
+
+/// Address that selects every subscription in SNAPSHOT_UNSUBSCRIBE
+static constexpr uint8_t ALL_DEVICES = 0xFF;
+
+/// Longest COBS encoding of a packet, including the delimiter
+static constexpr uint32_t MAX_ENCODED_LEN = SNAPSHOT_MAX_PACKET + SNAPSHOT_MAX_PACKET / 254 + 2;
+
+/// Size of one SNAPSHOT_PGNS entry
+static constexpr uint16_t PGN_ENTRY_LEN = 55;
+
+/* ---------------------------------------------------------------------------
+ * Framing
+ * ------------------------------------------------------------------------- */
+
+/**
+ * \brief CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF)
+ *
+ * \param data Bytes
+ * \param len Number of bytes
+ * \return CRC
+ */
+static uint16_t crc16(const uint8_t* data, uint16_t len) {
+    uint16_t crc = 0xFFFF;
+    for(uint16_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for(int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+/**
+ * \brief Decode COBS bytes in place
+ *
+ * The decoded data is never longer than the encoded data, so it can
+ * overwrite the input as it goes.
+ *
+ * \param data Encoded bytes without the 0x00 delimiter, replaced by the decoded bytes
+ * \param len Number of encoded bytes
+ * \return Number of decoded bytes, or -1 if the encoding is invalid
+ */
+static int cobsDecode(uint8_t* data, uint16_t len) {
+    uint16_t read = 0;
+    uint16_t write = 0;
+    while(read < len) {
+        uint8_t code = data[read++];
+        if(code == 0) return -1;
+        for(uint8_t i = 1; i < code; i++) {
+            if(read >= len) return -1;
+            data[write++] = data[read++];
+        }
+        if(code != 0xFF && read < len) data[write++] = 0;
+    }
+    return write;
+}
+
+/**
+ * \brief COBS encode bytes and add the 0x00 delimiter
+ *
+ * \param in Bytes to encode
+ * \param len Number of bytes
+ * \param out Output, at least len + len / 254 + 2 bytes
+ * \return Number of bytes written
+ */
+static uint32_t cobsEncode(const uint8_t* in, uint16_t len, uint8_t* out) {
+    uint32_t codePos = 0;
+    uint32_t write = 1;
+    uint8_t code = 1;
+    for(uint16_t i = 0; i < len; i++) {
+        if(in[i] == 0) {
+            out[codePos] = code;
+            codePos = write++;
+            code = 1;
+        } else {
+            out[write++] = in[i];
+            if(++code == 0xFF) {
+                out[codePos] = code;
+                codePos = write++;
+                code = 1;
+            }
+        }
+    }
+    out[codePos] = code;
+    out[write++] = 0;
+    return write;
+}
+
+static uint32_t getUint32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+/* ---------------------------------------------------------------------------
+ * Snapshot_Server
+ * ------------------------------------------------------------------------- */
+
+Snapshot_Server::Snapshot_Server(Stream* serialPort) {
+    port = serialPort;
+    monitor = nullptr;
+    rxLen = 0;
+    rxOverflow = false;
+    packetLen = 0;
+    txLen = 0;
+    bulkType = 0;
+    bulkSequence = 0;
+    bulkAddress = 0;
+    bulkCursor = 0;
+    nextSubscription = 0;
+    requestsReceived = 0;
+    badPackets = 0;
+    packetsSent = 0;
+    packetsDropped = 0;
+    for(int i = 0; i < SNAPSHOT_MAX_SUBSCRIPTIONS; i++) {
+        subscriptions[i].inUse = false;
+    }
+}
+
+uint8_t Snapshot_Server::getSubscriptionCount() const {
+    uint8_t count = 0;
+    for(int i = 0; i < SNAPSHOT_MAX_SUBSCRIPTIONS; i++) {
+        if(subscriptions[i].inUse) count++;
+    }
+    return count;
+}
+
+/**
+ * \brief Handle host requests, continue bulk responses and push updates
+ *
+ * Requests are answered as soon as their delimiter arrives. Bulk
+ * responses and subscription updates only go out while the transmit
+ * buffer has room for a whole packet, so they wait for a slow host
+ * instead of being dropped.
+ */
+void Snapshot_Server::poll() {
+    while(port->available() > 0) {
+        uint8_t in = (uint8_t)port->read();
+        if(in == 0) {
+            if(rxOverflow) {
+                badPackets++;
+            } else if(rxLen > 0) {
+                handlePacket();
+            }
+            rxLen = 0;
+            rxOverflow = false;
+        } else if(rxLen < sizeof(rxBuffer)) {
+            rxBuffer[rxLen++] = in;
+        } else {
+            rxOverflow = true;
+        }
+    }
+
+    if(monitor != nullptr) {
+        while(bulkType != 0 && continueBulk()) {}
+        serviceSubscriptions();
+    }
+    flush();
+}
+
+void Snapshot_Server::handlePacket() {
+    int len = cobsDecode(rxBuffer, rxLen);
+    if(len < 4 || crc16(rxBuffer, len - 2) != (rxBuffer[len - 2] | (rxBuffer[len - 1] << 8))) {
+        badPackets++;
+        sendError(0, 0, SNAPSHOT_ERROR_CRC);
+        return;
+    }
+
+    requestsReceived++;
+    handleRequest(rxBuffer[0], rxBuffer[1], rxBuffer + 2, len - 4);
+}
+
+/**
+ * \brief Answer a decoded request
+ *
+ * The payload is still in rxBuffer, so the response can be built in
+ * packet while the request is being read. Payloads, by request type:
+ *
+ * - HELLO: no request payload. Response: version (1), largest packet (2),
+ *   uptime ms (4), device list generation (4), device count (1),
+ *   subscription slots (1).
+ * - DEVICES: no request payload. Response packets: flags (1, bit 0 = last
+ *   packet), device list generation (4), entry count (1), then per device:
+ *   address (1), PGN count (1), flags (1, bit 0 = NAME known, bit 1 =
+ *   heartbeat seen), device generation (4), ms since last message (4),
+ *   NAME (8, 0 if unknown), name (string).
+ * - PGNS: request: address (1). Response packets: flags (1), address (1),
+ *   device generation (4), entry count (1), then per PGN: PGN (4),
+ *   messages (4), sequence (4), ms since last message (4), rate Hz,
+ *   mean interval ms, jitter ms, bytes/s, min and max interval ms (6
+ *   floats), transfers completed, timed out and corrupted (3 x 4), data
+ *   length (1), priority (1), destination (1).
+ * - FIELDS: request: address (1), PGN (4). Response: address (1), PGN (4),
+ *   sequence (4), ms since last message (4), flags (1, bit 0 = fields
+ *   truncated), field count (1), then per field: name, value and unit
+ *   (3 strings).
+ * - SUBSCRIBE: request: address (1), PGN (4), shortest interval ms (2).
+ *   Response: subscription slot (1). Updates carry the FIELDS response
+ *   payload and type SNAPSHOT_UPDATE, whenever a new message was stored.
+ *   The pair doesn't have to exist yet.
+ * - UNSUBSCRIBE: request: address (1, 0xFF = all), PGN (4). Response:
+ *   subscriptions left (1).
+ *
+ * Errors are answered with type SNAPSHOT_ERROR and the request's sequence:
+ * request type (1), error code (1).
+ *
+ * \param type Request type
+ * \param sequence Request sequence number
+ * \param payload Request payload
+ * \param len Payload length
+ */
+void Snapshot_Server::handleRequest(uint8_t type, uint8_t sequence, const uint8_t* payload, uint16_t len) {
+    if(monitor == nullptr) {
+        sendError(type, sequence, SNAPSHOT_ERROR_NO_MONITOR);
+        return;
+    }
+
+    switch(type) {
+        case SNAPSHOT_HELLO:
+            begin(type | SNAPSHOT_RESPONSE, sequence);
+            put8(SNAPSHOT_VERSION);
+            put16(SNAPSHOT_MAX_PACKET);
+            put32(millis());
+            put32(monitor->getListGeneration());
+            put8((uint8_t)monitor->getDeviceList().size());
+            put8(SNAPSHOT_MAX_SUBSCRIPTIONS);
+            send();
+            break;
+
+        case SNAPSHOT_DEVICES:
+        case SNAPSHOT_PGNS:
+            if(bulkType != 0) {
+                sendError(type, sequence, SNAPSHOT_ERROR_BUSY);
+                return;
+            }
+            if(type == SNAPSHOT_PGNS) {
+                if(len < 1) {
+                    sendError(type, sequence, SNAPSHOT_ERROR_LENGTH);
+                    return;
+                }
+                if(monitor->getDevice(payload[0]) == nullptr) {
+                    sendError(type, sequence, SNAPSHOT_ERROR_NOT_FOUND);
+                    return;
+                }
+                bulkAddress = payload[0];
+            }
+            bulkType = type;
+            bulkSequence = sequence;
+            bulkCursor = 0;
+            break;
+
+        case SNAPSHOT_FIELDS: {
+            if(len < 5) {
+                sendError(type, sequence, SNAPSHOT_ERROR_LENGTH);
+                return;
+            }
+            uint8_t address = payload[0];
+            PGNData* pgnData = monitor->getDecodedPGNData(address, getUint32(payload + 1));
+            if(pgnData == nullptr) {
+                sendError(type, sequence, SNAPSHOT_ERROR_NOT_FOUND);
+                return;
+            }
+            begin(type | SNAPSHOT_RESPONSE, sequence);
+            putFields(address, *pgnData);
+            send();
+            break;
+        }
+
+        case SNAPSHOT_SUBSCRIBE: {
+            if(len < 7) {
+                sendError(type, sequence, SNAPSHOT_ERROR_LENGTH);
+                return;
+            }
+            uint8_t address = payload[0];
+            uint32_t pgn = getUint32(payload + 1);
+            uint16_t interval = payload[5] | (payload[6] << 8);
+            if(interval < SNAPSHOT_MIN_INTERVAL_MS) interval = SNAPSHOT_MIN_INTERVAL_MS;
+
+            // Subscribing again only changes the interval
+            int slot = -1;
+            for(int i = 0; i < SNAPSHOT_MAX_SUBSCRIPTIONS; i++) {
+                SnapshotSubscription& sub = subscriptions[i];
+                if(sub.inUse && sub.address == address && sub.pgn == pgn) {
+                    slot = i;
+                    break;
+                }
+                if(!sub.inUse && slot < 0) slot = i;
+            }
+            if(slot < 0) {
+                sendError(type, sequence, SNAPSHOT_ERROR_FULL);
+                return;
+            }
+
+            SnapshotSubscription& sub = subscriptions[slot];
+            if(!sub.inUse) {
+                sub.inUse = true;
+                sub.address = address;
+                sub.pgn = pgn;
+                sub.lastSequence = 0;   // Entries count from 1, so existing data goes out right away
+                sub.lastSent = millis() - interval;
+            }
+            sub.intervalMs = interval;
+
+            begin(type | SNAPSHOT_RESPONSE, sequence);
+            put8(slot);
+            send();
+            break;
+        }
+
+        case SNAPSHOT_UNSUBSCRIBE: {
+            if(len < 5) {
+                sendError(type, sequence, SNAPSHOT_ERROR_LENGTH);
+                return;
+            }
+            uint8_t address = payload[0];
+            uint32_t pgn = getUint32(payload + 1);
+            bool found = false;
+            for(int i = 0; i < SNAPSHOT_MAX_SUBSCRIPTIONS; i++) {
+                SnapshotSubscription& sub = subscriptions[i];
+                if(sub.inUse && (address == ALL_DEVICES || (sub.address == address && sub.pgn == pgn))) {
+                    sub.inUse = false;
+                    found = true;
+                }
+            }
+            if(!found && address != ALL_DEVICES) {
+                sendError(type, sequence, SNAPSHOT_ERROR_NOT_FOUND);
+                return;
+            }
+
+            begin(type | SNAPSHOT_RESPONSE, sequence);
+            put8(getSubscriptionCount());
+            send();
+            break;
+        }
+
+        default:
+            sendError(type, sequence, SNAPSHOT_ERROR_TYPE);
+            break;
+    }
+}
+
+void Snapshot_Server::sendError(uint8_t type, uint8_t sequence, SnapshotError code) {
+    begin(SNAPSHOT_ERROR, sequence);
+    put8(type);
+    put8(code);
+    send();
+}
+
+/* ---------------------------------------------------------------------------
+ * Packet building
+ * ------------------------------------------------------------------------- */
+
+void Snapshot_Server::begin(uint8_t type, uint8_t sequence) {
+    packet[0] = type;
+    packet[1] = sequence;
+    packetLen = 2;
+}
+
+bool Snapshot_Server::put(const void* data, uint16_t len) {
+    // Room for the CRC is kept free
+    if(packetLen + len + 2 > SNAPSHOT_MAX_PACKET) return false;
+    memcpy(packet + packetLen, data, len);
+    packetLen += len;
+    return true;
+}
+
+bool Snapshot_Server::put16(uint16_t value) {
+    uint8_t out[2] = {(uint8_t)value, (uint8_t)(value >> 8)};
+    return put(out, 2);
+}
+
+bool Snapshot_Server::put32(uint32_t value) {
+    uint8_t out[4] = {(uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24)};
+    return put(out, 4);
+}
+
+bool Snapshot_Server::putFloat(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return put32(bits);
+}
+
+bool Snapshot_Server::putString(const char* text) {
+    size_t len = strlen(text);
+    if(len > 255) len = 255;
+    if(packetLen + 1 + len + 2 > SNAPSHOT_MAX_PACKET) return false;
+    put8((uint8_t)len);
+    return put(text, len);
+}
+
+bool Snapshot_Server::send() {
+    uint16_t crc = crc16(packet, packetLen);
+    packet[packetLen++] = crc & 0xFF;
+    packet[packetLen++] = crc >> 8;
+
+    if(txRoom() < packetLen + packetLen / 254 + 2u) {
+        packetsDropped++;
+        return false;
+    }
+    txLen += cobsEncode(packet, packetLen, txBuffer + txLen);
+    packetsSent++;
+    return true;
+}
+
+uint32_t Snapshot_Server::txRoom() {
+    if(SNAPSHOT_TX_BUFFER_SIZE - txLen < MAX_ENCODED_LEN) flush();
+    return SNAPSHOT_TX_BUFFER_SIZE - txLen;
+}
+
+/**
+ * \brief Write as much of the transmit buffer as the port accepts
+ *
+ * Uses availableForWrite() so the call never waits for the host.
+ */
+void Snapshot_Server::flush() {
+    if(txLen == 0) return;
+
+    int room = port->availableForWrite();
+    if(room <= 0) return;
+
+    uint32_t count = (uint32_t)room < txLen ? (uint32_t)room : txLen;
+    size_t written = port->write(txBuffer, count);
+    if(written == 0) return;
+
+    txLen -= written;
+    if(txLen > 0) {
+        memmove(txBuffer, txBuffer + written, txLen);
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Monitor serializers
+ * ------------------------------------------------------------------------- */
+
+/**
+ * \brief Append the decoded fields of a PGN entry
+ *
+ * The field count is patched in at the end, once it is known how many
+ * fields fit.
+ *
+ * \param address Source address
+ * \param pgnData Decoded entry
+ */
+void Snapshot_Server::putFields(uint8_t address, const PGNData& pgnData) {
+    put8(address);
+    put32(pgnData.pgn);
+    put32(pgnData.sequence);
+    put32(millis() - pgnData.lastUpdate);
+    uint16_t flagsPos = packetLen;
+    put8(0);
+    put8(0);
+
+    uint8_t count = 0;
+    for(const PGNField& field : pgnData.fields) {
+        uint16_t start = packetLen;
+        if(!putString(field.name) || !putString(field.value) || !putString(field.unit)) {
+            packetLen = start;
+            packet[flagsPos] |= FIELDS_TRUNCATED;
+            break;
+        }
+        count++;
+    }
+    packet[flagsPos + 1] = count;
+}
+
+/**
+ * \brief Send the next packet of the bulk response in progress
+ *
+ * The cursor is a position in the device list or the device's PGN list.
+ * Devices coming or going between packets shift the positions, which the
+ * host sees as a changed generation in the packet header.
+ *
+ * \return true if a packet was sent and more may follow
+ */
+bool Snapshot_Server::continueBulk() {
+    if(txRoom() < MAX_ENCODED_LEN) return false;
+
+    begin(bulkType | SNAPSHOT_RESPONSE, bulkSequence);
+    uint16_t flagsPos = packetLen;
+    put8(0);
+
+    uint8_t count = 0;
+    uint16_t countPos;
+    uint16_t total;
+    uint32_t now = millis();
+
+    if(bulkType == SNAPSHOT_DEVICES) {
+        std::vector<uint8_t>& deviceList = monitor->getDeviceList();
+        total = deviceList.size();
+        put32(monitor->getListGeneration());
+        countPos = packetLen;
+        put8(0);
+
+        while(bulkCursor < total) {
+            DeviceInfo* device = monitor->getDevice(deviceList[bulkCursor]);
+            if(device == nullptr) {
+                bulkCursor++;
+                continue;
+            }
+            const N2K_Identity* identity = monitor->getIdentity(device->sourceAddress);
+
+            uint16_t start = packetLen;
+            uint8_t flags = (identity != nullptr ? DEVICE_HAS_NAME : 0) |
+                            (device->lastHeartbeat > 0 ? DEVICE_HAS_HEARTBEAT : 0);
+            uint64_t name = identity != nullptr ? identity->name : 0;
+            bool fits = put8(device->sourceAddress) && put8(device->pgnCount) && put8(flags) &&
+                        put32(device->generation) && put32(now - device->lastSeen) &&
+                        put32((uint32_t)name) && put32((uint32_t)(name >> 32)) &&
+                        putString(device->name);
+            if(!fits) {
+                packetLen = start;
+                break;
+            }
+            count++;
+            bulkCursor++;
+        }
+    } else {
+        DeviceInfo* device = monitor->getDevice(bulkAddress);
+        total = device != nullptr ? device->pgnCount : 0;
+        put8(bulkAddress);
+        put32(monitor->getDeviceGeneration(bulkAddress));
+        countPos = packetLen;
+        put8(0);
+
+        while(bulkCursor < total && packetLen + PGN_ENTRY_LEN + 2 <= SNAPSHOT_MAX_PACKET) {
+            PGNData* pgnData = monitor->getPGNDataAt(bulkAddress, bulkCursor);
+            const N2K_PGNStats& stats = pgnData->stats;
+            const N2K_TransferStats& transfers = pgnData->transfers;
+            put32(pgnData->pgn);
+            put32(stats.getCount());
+            put32(pgnData->sequence);
+            put32(now - pgnData->lastUpdate);
+            putFloat(stats.getRate());
+            putFloat(stats.getInterval());
+            putFloat(stats.getJitter());
+            putFloat(stats.getBytesPerSecond());
+            putFloat(stats.getMinInterval());
+            putFloat(stats.getMaxInterval());
+            put32(transfers.getCompleted());
+            put32(transfers.getTimedOut());
+            put32(transfers.getCorrupted());
+            put8(pgnData->dataLen);
+            put8(pgnData->priority);
+            put8(pgnData->destination);
+            count++;
+            bulkCursor++;
+        }
+    }
+
+    packet[countPos] = count;
+    bool last = bulkCursor >= total;
+    if(last) {
+        packet[flagsPos] = BULK_LAST;
+        bulkType = 0;
+    }
+    send();
+    return !last;
+}
+
+/**
+ * \brief Push the subscriptions that have new data and are due
+ *
+ * Starts where the previous call stopped, so a host that can't keep up
+ * still gets every subscription in turn. An update that doesn't fit waits;
+ * the next one carries the latest data anyway.
+ */
+void Snapshot_Server::serviceSubscriptions() {
+    uint32_t now = millis();
+    for(int n = 0; n < SNAPSHOT_MAX_SUBSCRIPTIONS; n++) {
+        SnapshotSubscription& sub = subscriptions[nextSubscription];
+        if(sub.inUse && now - sub.lastSent >= sub.intervalMs) {
+            PGNData* pgnData = monitor->getPGNData(sub.address, sub.pgn);
+            if(pgnData != nullptr && pgnData->sequence != sub.lastSequence) {
+                if(txRoom() < MAX_ENCODED_LEN) return;
+
+                monitor->getDecodedPGNData(sub.address, sub.pgn);
+                begin(SNAPSHOT_UPDATE, 0);
+                putFields(sub.address, *pgnData);
+                send();
+                sub.lastSequence = pgnData->sequence;
+                sub.lastSent = now;
+            }
+        }
+        nextSubscription = (nextSubscription + 1) % SNAPSHOT_MAX_SUBSCRIPTIONS;
+    }
+}
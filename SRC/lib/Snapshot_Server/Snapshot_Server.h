@@ -0,0 +1,261 @@
+/**
+ * \file Snapshot_Server.h
+ * \brief Binary request/response access to the network monitor over USB
+ *
+ * Host dashboards used to parse the candump text and decode every PGN
+ * again themselves. The snapshot server lets them ask the monitor instead:
+ * the device table, the statistics of a device's PGNs and the decoded
+ * fields of one PGN, or a subscription that pushes the fields of a
+ * (device, PGN) pair whenever a new message was stored.
+ *
+ * It runs on the second USB serial interface (SerialUSB1), so it never
+ * mixes with the capture stream, candump or GVRET, on the first one.
+ *
+ * Every packet, in both directions, is:
+ *
+ *     type (1) | sequence (1) | payload | CRC-16 (2, LE)
+ *
+ * COBS encoded and terminated by a 0x00 byte. The CRC is CRC-16/CCITT-FALSE
+ * over type, sequence and payload. A response carries the type of its
+ * request with bit 7 set and the request's sequence number; pushed updates
+ * use sequence 0. All integers are little-endian and floats are IEEE 754
+ * single precision. Strings are a length byte followed by the characters.
+ * Snapshot_Server::handleRequest() lists the payloads.
+ *
+ * Responses are written straight from the monitor's storage into the
+ * packet buffer. Bulk responses (device table, PGN statistics) are split
+ * into packets and continue on later poll() calls as the USB port drains,
+ * so the loop never waits for the host.
+ */
+
+#ifndef SNAPSHOT_SERVER_H
+#define SNAPSHOT_SERVER_H
+
+#include <Arduino.h>
+#include <N2K_Monitor.h>
+#include "constants.h"
+
+/**
+ * \enum SnapshotType
+ * \brief Packet types
+ */
+enum SnapshotType : uint8_t {
+    SNAPSHOT_HELLO = 0x01,          ///< Protocol version and monitor summary
+    SNAPSHOT_DEVICES = 0x02,        ///< Device table, bulk
+    SNAPSHOT_PGNS = 0x03,           ///< PGN statistics of one device, bulk
+    SNAPSHOT_FIELDS = 0x04,         ///< Decoded fields of one (device, PGN)
+    SNAPSHOT_SUBSCRIBE = 0x05,      ///< Push the fields of a (device, PGN) on change
+    SNAPSHOT_UNSUBSCRIBE = 0x06,    ///< Stop pushing a (device, PGN), or all of them
+    SNAPSHOT_RESPONSE = 0x80,       ///< Set in the type of every response
+    SNAPSHOT_UPDATE = 0xC0,         ///< Pushed fields of a subscription
+    SNAPSHOT_ERROR = 0xFF           ///< Request failed
+};
+
+/**
+ * \enum SnapshotError
+ * \brief Error codes of SNAPSHOT_ERROR packets
+ */
+enum SnapshotError : uint8_t {
+    SNAPSHOT_ERROR_CRC = 1,         ///< Packet didn't decode or failed its CRC
+    SNAPSHOT_ERROR_TYPE = 2,        ///< Unknown request type
+    SNAPSHOT_ERROR_LENGTH = 3,      ///< Payload too short for the request
+    SNAPSHOT_ERROR_NOT_FOUND = 4,   ///< No such device or PGN
+    SNAPSHOT_ERROR_BUSY = 5,        ///< A bulk response is still being sent
+    SNAPSHOT_ERROR_FULL = 6,        ///< All subscriptions are taken
+    SNAPSHOT_ERROR_NO_MONITOR = 7   ///< The monitor isn't running yet
+};
+
+/**
+ * \struct SnapshotSubscription
+ * \brief A (device, PGN) pair pushed to the host
+ */
+struct SnapshotSubscription {
+    uint32_t pgn;               ///< PGN number
+    uint32_t lastSequence;      ///< PGNData::sequence of the last update sent
+    uint32_t lastSent;          ///< Time of the last update (millis)
+    uint16_t intervalMs;        ///< Shortest time between updates
+    uint8_t address;            ///< Source address
+    bool inUse;                 ///< true if the slot is taken
+};
+
+/**
+ * \class Snapshot_Server
+ * \brief Answers snapshot requests from the monitor's tables
+ *
+ * Call poll() once per loop iteration.
+ */
+class Snapshot_Server {
+private:
+    Stream* port;                                   ///< Serial port of the protocol
+    N2K_Monitor* monitor;                           ///< Monitor answering the requests, or nullptr
+
+    uint8_t rxBuffer[SNAPSHOT_MAX_PACKET + SNAPSHOT_MAX_PACKET / 254 + 1];  ///< COBS bytes of the request being received, decoded in place
+    uint16_t rxLen;                                 ///< Bytes in rxBuffer
+    bool rxOverflow;                                ///< Current request was too long
+
+    uint8_t packet[SNAPSHOT_MAX_PACKET];            ///< Response being built
+    uint16_t packetLen;                             ///< Bytes in packet
+
+    uint8_t txBuffer[SNAPSHOT_TX_BUFFER_SIZE];      ///< Encoded packets waiting for the port
+    uint32_t txLen;                                 ///< Bytes in txBuffer
+
+    uint8_t bulkType;                               ///< Request of the bulk response in progress, 0 if none
+    uint8_t bulkSequence;                           ///< Sequence number of that request
+    uint8_t bulkAddress;                            ///< Device of a SNAPSHOT_PGNS response
+    uint16_t bulkCursor;                            ///< Next device list or PGN list position to send
+
+    SnapshotSubscription subscriptions[SNAPSHOT_MAX_SUBSCRIPTIONS];  ///< Pushed pairs
+    uint8_t nextSubscription;                       ///< Subscription checked first on the next poll()
+
+    uint32_t requestsReceived;                      ///< Requests that passed the CRC
+    uint32_t badPackets;                            ///< Requests that were too long or failed the CRC
+    uint32_t packetsSent;                           ///< Packets queued for the host
+    uint32_t packetsDropped;                        ///< Responses or updates lost because the buffer was full
+
+    /**
+     * \brief Decode, check and answer the request in rxBuffer
+     */
+    void handlePacket();
+
+    /**
+     * \brief Answer a decoded request
+     *
+     * \param type Request type
+     * \param sequence Request sequence number
+     * \param payload Request payload
+     * \param len Payload length
+     */
+    void handleRequest(uint8_t type, uint8_t sequence, const uint8_t* payload, uint16_t len);
+
+    /**
+     * \brief Start building a packet
+     *
+     * \param type Packet type
+     * \param sequence Sequence number
+     */
+    void begin(uint8_t type, uint8_t sequence);
+
+    /**
+     * \brief Append bytes to the packet being built
+     *
+     * \param data Bytes
+     * \param len Number of bytes
+     * \return false if they didn't fit; the packet is unchanged
+     */
+    bool put(const void* data, uint16_t len);
+
+    bool put8(uint8_t value) { return put(&value, 1); }     ///< Append a byte
+    bool put16(uint16_t value);                             ///< Append a 16-bit integer
+    bool put32(uint32_t value);                             ///< Append a 32-bit integer
+    bool putFloat(float value);                             ///< Append a float
+    bool putString(const char* text);                       ///< Append a length-prefixed string, truncated to 255
+
+    /**
+     * \brief Append the CRC, COBS encode the packet and queue it
+     *
+     * \return false if the transmit buffer had no room; the packet is lost
+     */
+    bool send();
+
+    /**
+     * \brief Get the free bytes of the transmit buffer after flushing
+     *
+     * \return Bytes
+     */
+    uint32_t txRoom();
+
+    /**
+     * \brief Send an error response
+     *
+     * \param type Request type
+     * \param sequence Request sequence number
+     * \param code Error code
+     */
+    void sendError(uint8_t type, uint8_t sequence, SnapshotError code);
+
+    /**
+     * \brief Append the decoded fields of a PGN entry to the packet
+     *
+     * \param address Source address
+     * \param pgnData Decoded entry
+     */
+    void putFields(uint8_t address, const PGNData& pgnData);
+
+    /**
+     * \brief Send the next packet of the bulk response in progress
+     *
+     * \return true if a packet was sent and more may follow
+     */
+    bool continueBulk();
+
+    /**
+     * \brief Push the subscriptions that have new data and are due
+     */
+    void serviceSubscriptions();
+
+    /**
+     * \brief Write as much of the transmit buffer as the port accepts
+     */
+    void flush();
+
+public:
+    /**
+     * \brief Construct a server on a serial port
+     *
+     * \param serialPort Port of the protocol (e.g. &SerialUSB1)
+     */
+    Snapshot_Server(Stream* serialPort);
+
+    /**
+     * \brief Set the monitor the requests are answered from
+     *
+     * Until this is called every request gets SNAPSHOT_ERROR_NO_MONITOR.
+     *
+     * \param n2kMonitor Monitor of the CAN2 bus
+     */
+    void setMonitor(N2K_Monitor* n2kMonitor) { monitor = n2kMonitor; }
+
+    /**
+     * \brief Handle host requests, continue bulk responses and push updates
+     *
+     * Call once per loop iteration.
+     */
+    void poll();
+
+    /**
+     * \brief Get the number of valid requests received
+     *
+     * \return Requests since startup
+     */
+    uint32_t getRequestsReceived() const { return requestsReceived; }
+
+    /**
+     * \brief Get the number of requests that were too long or failed the CRC
+     *
+     * \return Packets since startup
+     */
+    uint32_t getBadPackets() const { return badPackets; }
+
+    /**
+     * \brief Get the number of packets queued for the host
+     *
+     * \return Packets since startup
+     */
+    uint32_t getPacketsSent() const { return packetsSent; }
+
+    /**
+     * \brief Get the number of responses and updates lost to a slow host
+     *
+     * \return Packets since startup
+     */
+    uint32_t getPacketsDropped() const { return packetsDropped; }
+
+    /**
+     * \brief Get the number of active subscriptions
+     *
+     * \return Subscriptions
+     */
+    uint8_t getSubscriptionCount() const;
+};
+
+#endif // SNAPSHOT_SERVER_H
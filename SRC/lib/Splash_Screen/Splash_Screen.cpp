@@ -11,6 +11,10 @@
  * - Phase 1: Animated clownfish swimming across the screen with trailing bubbles
  * - Phase 2: NEMO logo reveal with line-by-line building effect
  * - Phase 3: Fade-out effect with progressive pixel removal
+ *
+ * Every frame is rendered into the U8g2 frame buffer in one go (cheap) and
+ * sent to the panel a few pages per step (the slow part, about 3 ms per page
+ * on the I2C bus), so no single step blocks the loop for long.
  */
 
 #include "Splash_Screen.h"
@@ -140,301 +144,259 @@ void Splash_Screen::drawNemoLogo(U8G2_SH1106_128X64_NONAME_F_HW_I2C* u8g2) {
 }
 
 /**
- * @brief Display the complete splash screen animation sequence.
- *
- * This method executes the full NEMO boot animation in three distinct phases:
- *
- * **Phase 1: Fish Swimming Animation**
- * - Clownfish enters from left side of screen
- * - Fish swims across with animated tail movement
- * - Bubbles spawn periodically and float upward
- * - Animation continues until fish exits right side
- *
- * **Phase 2: Logo Reveal**
- * - Screen clears with brief pause
- * - NEMO logo builds line-by-line (top to bottom)
- * - Platform subtitle appears in three lines with delays
- * - Logo holds on screen for viewing
+ * @brief Draw the NEMO logo rows using the bitmap letters.
  *
- * **Phase 3: Fade Out**
- * - Progressive pixel removal creates fade effect
- * - Uses modulo-based pixel skipping pattern
- * - Screen clears before handing off to menu system
+ * Used by both the reveal, which draws the rows up to the current reveal
+ * point, and the fade, which skips more rows and pixels as it progresses:
+ * a row or pixel is kept if (index + fade) % (fade + 1) == 0, so
+ * fade = 0 keeps everything and fade = 7 almost nothing.
  *
- * @param u8g2 Pointer to the U8G2 display driver instance.
- *             Must be properly initialized before calling.
+ * @param u8g2    Pointer to the U8G2 display driver instance.
+ * @param lastRow Last bitmap row to draw (0-23).
+ * @param fade    Dissolve level, 0 draws every pixel.
  */
-void Splash_Screen::show(U8G2_SH1106_128X64_NONAME_F_HW_I2C* u8g2) {
-    // Initialize the display and set default font
-    u8g2->begin();
-    u8g2->setFont(u8g2_font_6x10_tf);
-
-    
-    // Phase 1: Fish swims across the screen (left to right)
-    // Creates an engaging animated introduction with the NEMO mascot
-    
+void Splash_Screen::drawLogoRows(U8G2_SH1106_128X64_NONAME_F_HW_I2C* u8g2, int lastRow, int fade) {
+    static const unsigned char* const letters[4] = {letter_N, letter_E, letter_M, letter_O};
 
-    // Fish position and animation state variables
-    int fishX = -45;  // Start off-screen left (fish is ~40 pixels wide)
-    int fishY = 20;   // Vertical center position: (64 - 24) / 2 = 20
-    int frame = 0;    // Current animation frame for tail movement
-    int frameCount = 0;  // Total frames rendered (used for timing)
+    // Logo positioning constants
+    int startX = 10;           // Left margin
+    int startY = 4;            // Top margin (higher to make room for subtitle)
+    int letterSpacing = 4;     // Space between letters
 
-    
-    // Bubble system - creates trailing bubble effect behind swimming fish
-    // Uses a circular buffer of 6 bubbles for memory efficiency
-    
-    struct Bubble {
-        int x, y, size;  // Position and radius of bubble
-        bool active;     // Whether this bubble slot is currently in use
-    };
+    for (int r = 0; r <= lastRow && r < 24; r++) {
+        if ((r + fade) % (fade + 1) != 0) continue;
 
-    // Initialize all bubble slots as inactive
-    Bubble bubbles[6] = {{0,0,0,false}, {0,0,0,false}, {0,0,0,false},
-                         {0,0,0,false}, {0,0,0,false}, {0,0,0,false}};
-    int nextBubble = 0;  // Index for next bubble to spawn (circular buffer)
-
-    
-    // Main swimming animation loop
-    // Fish moves 4 pixels per frame at ~28 FPS until off-screen right
-    
-    while (fishX < 140) {
-        u8g2->clearBuffer();
-
-        // Draw fish with current animation frame
-        drawFish(u8g2, fishX, fishY, frame);
-
-        
-        // Bubble spawning - create new bubble every 6 frames when fish is visible
-        // Bubbles spawn near the fish's tail with randomized position/size
-        
-        if (frameCount % 6 == 0 && fishX > 0) {
-            bubbles[nextBubble].x = fishX - 5;                      // Spawn behind fish
-            bubbles[nextBubble].y = fishY + 16 + (random(10) - 5);  // Randomize vertical pos (-5 to +5)
-            bubbles[nextBubble].size = 2 + random(4);               // Random size (2-5 pixels)
-            bubbles[nextBubble].active = true;
-            nextBubble = (nextBubble + 1) % 6;  // Advance to next slot (wraps around)
-        }
-
-        
-        // Bubble physics - update positions and render active bubbles
-        // Bubbles float upward and drift left to simulate rising in water
-        
-        for (int i = 0; i < 6; i++) {
-            if (bubbles[i].active) {
-                drawBubble(u8g2, bubbles[i].x, bubbles[i].y, bubbles[i].size);
-                bubbles[i].y -= 2;  // Float upward (2 pixels per frame)
-                bubbles[i].x -= 1;  // Drift leftward (1 pixel per frame)
-
-                // Deactivate bubble when it floats off the top of screen
-                if (bubbles[i].y < -5) {
-                    bubbles[i].active = false;
-                }
-            }
-        }
-
-        // Send frame buffer to display
-        u8g2->sendBuffer();
-
-        
-        // Update animation state for next frame
-        
-        fishX += 4;  // Move fish rightward (4 pixels per frame)
-        frameCount++;
-
-        // Cycle through tail animation frames every 4 render frames
-        // This creates a smooth swimming motion at 1/4 the render rate
-        if (frameCount % 4 == 0) {
-            frame++;  // Advance to next animation frame (wraps via modulo in drawFish)
-        }
-
-        delay(35);  // ~28 FPS timing (1000ms / 35ms = ~28.5 FPS)
-    }
-
-    
-    // Phase 2: Display NEMO logo with fade-in effect
-    // Logo appears with a "building" animation, revealing row by row
-    
-
-    // Brief pause and clear screen for transition
-    u8g2->clearBuffer();
-    u8g2->sendBuffer();
-    delay(300);
-
-    
-    // Logo building animation - reveals letters row by row from top to bottom
-    // Each iteration reveals 2 more rows, creating a "drawing" effect
-    
-    for (int row = 0; row < 24; row += 2) {
-        u8g2->clearBuffer();
-
-        // Logo positioning constants
-        int startX = 10;           // Left margin
-        int startY = 4;            // Top margin (higher to make room for subtitle)
-        int letterSpacing = 4;     // Space between letters
-
-        // Draw each letter row by row up to current reveal point
-        for (int r = 0; r <= row && r < 24; r++) {
-            
-            // Letter 'N' - render pixel by pixel from bitmap data
-            // Each letter row is 2 bytes (16 pixels wide)
-            
+        // Each letter row is 2 bytes (16 pixels wide), letters are 16 + spacing apart
+        for (int l = 0; l < 4; l++) {
+            int letterX = startX + l * (16 + letterSpacing);
             for (int c = 0; c < 2; c++) {
-                uint8_t byte = pgm_read_byte(&letter_N[r * 2 + c]);
+                uint8_t byte = pgm_read_byte(&letters[l][r * 2 + c]);
                 for (int b = 0; b < 8; b++) {
+                    if ((b + fade) % (fade + 1) != 0) continue;
                     // Check each bit (MSB first) and draw pixel if set
                     if (byte & (0x80 >> b)) {
-                        u8g2->drawPixel(startX + c * 8 + b, startY + r);
+                        u8g2->drawPixel(letterX + c * 8 + b, startY + r);
                     }
                 }
             }
+        }
+    }
+}
 
-            
-            // Letter 'E' - offset by one letter width plus spacing
-            
-            for (int c = 0; c < 2; c++) {
-                uint8_t byte = pgm_read_byte(&letter_E[r * 2 + c]);
-                for (int b = 0; b < 8; b++) {
-                    if (byte & (0x80 >> b)) {
-                        u8g2->drawPixel(startX + 16 + letterSpacing + c * 8 + b, startY + r);
-                    }
-                }
-            }
+Splash_Screen::Splash_Screen(U8G2_SH1106_128X64_NONAME_F_HW_I2C* u8g2) {
+    display = u8g2;
+    phase = SPLASH_DONE;
+    phaseStep = 0;
+    flushPage = 0;
+    frameStart = 0;
+    frameDelay = 0;
+
+    fishX = 0;
+    tailFrame = 0;
+    frameCount = 0;
+    for (int i = 0; i < 6; i++) {
+        bubbles[i] = {0, 0, 0, false};
+    }
+    nextBubble = 0;
+}
 
-            
-            // Letter 'M' - offset by two letter widths plus spacing
-            
-            for (int c = 0; c < 2; c++) {
-                uint8_t byte = pgm_read_byte(&letter_M[r * 2 + c]);
-                for (int b = 0; b < 8; b++) {
-                    if (byte & (0x80 >> b)) {
-                        u8g2->drawPixel(startX + 32 + letterSpacing * 2 + c * 8 + b, startY + r);
-                    }
-                }
-            }
+/**
+ * @brief Initialize the display and start the animation.
+ *
+ * The first frame is rendered right away; sending it is left to step().
+ */
+void Splash_Screen::begin() {
+    display->begin();
+    display->setFont(u8g2_font_6x10_tf);
+
+    phase = SPLASH_SWIM;
+    phaseStep = 0;
+    fishX = -45;       // Start off-screen left (fish is ~40 pixels wide)
+    tailFrame = 0;
+    frameCount = 0;
+    for (int i = 0; i < 6; i++) {
+        bubbles[i].active = false;
+    }
+    nextBubble = 0;
 
-            
-            // Letter 'O' - offset by three letter widths plus spacing
-            
-            for (int c = 0; c < 2; c++) {
-                uint8_t byte = pgm_read_byte(&letter_O[r * 2 + c]);
-                for (int b = 0; b < 8; b++) {
-                    if (byte & (0x80 >> b)) {
-                        u8g2->drawPixel(startX + 48 + letterSpacing * 3 + c * 8 + b, startY + r);
-                    }
-                }
-            }
-        }
+    renderFrame();
+}
 
-        u8g2->sendBuffer();
-        delay(35);  // Brief delay between row reveals for smooth animation
+/**
+ * @brief Advance the animation by one time slice.
+ *
+ * Frame delays are measured from when a frame was rendered, so the time
+ * spent sending it counts towards how long it stays up, like the delay()
+ * calls of the original blocking animation.
+ *
+ * @return true once the animation has finished.
+ */
+bool Splash_Screen::step() {
+    if (phase == SPLASH_DONE) return true;
+
+    // Finish sending the current frame first
+    uint8_t pages = display->getBufferTileHeight();
+    if (flushPage < pages) {
+        uint8_t count = min((uint8_t)(pages - flushPage), SPLASH_PAGES_PER_STEP);
+        display->updateDisplayArea(0, flushPage, display->getBufferTileWidth(), count);
+        flushPage += count;
+        return false;
     }
 
-    // Small pause before subtitle appears
-    delay(200);
+    if (millis() - frameStart < frameDelay) return false;
 
-    
-    // Platform subtitle - displays full name across three lines
-    // Each line appears with a delay for a "typewriter" effect
-    
-    u8g2->setFont(u8g2_font_5x7_tf);  // Smaller font for subtitle text
+    renderFrame();
+    return phase == SPLASH_DONE;
+}
 
-    // Line 1: "NMEA2000 Education &"
-    u8g2->drawStr(4, 38, "NMEA2000 Education &");
-    u8g2->sendBuffer();
-    delay(150);
+/**
+ * @brief End the animation early and blank the screen.
+ *
+ * Sends the blank buffer in one go, since the menu takes over the display
+ * right afterwards.
+ */
+void Splash_Screen::skip() {
+    if (phase == SPLASH_DONE) return;
+    display->clearBuffer();
+    display->sendBuffer();
+    phase = SPLASH_DONE;
+}
 
-    // Line 2: "Maritime Operations"
-    u8g2->drawStr(8, 48, "Maritime Operations");
-    u8g2->sendBuffer();
-    delay(150);
+/**
+ * @brief Render one frame of the swimming fish and its bubbles.
+ *
+ * The fish moves 4 pixels per frame until it is off-screen right.
+ */
+void Splash_Screen::renderSwimFrame() {
+    int fishY = 20;   // Vertical center position: (64 - 24) / 2 = 20
 
-    // Line 3: "Platform" (centered below)
-    u8g2->drawStr(40, 58, "Platform");
-    u8g2->sendBuffer();
+    display->clearBuffer();
 
-    // Hold the complete logo for viewing
-    delay(2000);
+    // Draw fish with current animation frame
+    drawFish(display, fishX, fishY, tailFrame);
 
     
-    // Phase 3: Fade out effect
-    // Progressively removes pixels to create a dissolve transition
+    // Bubble spawning - create new bubble every 6 frames when fish is visible
+    // Bubbles spawn near the fish's tail with randomized position/size
     
-    for (int fade = 0; fade < 8; fade++) {
-        u8g2->clearBuffer();
-
-        
-        // Gradual pixel removal using modulo-based pattern
-        // As fade increases, more pixels are skipped, creating dissolve effect
-        // fade=0: all pixels shown
-        // fade=7: almost no pixels shown (nearly blank)
-        // fade=8: completely blank (loop exits)
-        
-        if (fade < 7) {
-            int startX = 10;
-            int startY = 4;
-            int letterSpacing = 4;
-
-            for (int r = 0; r < 24; r++) {
-                // Skip more rows as fade progresses
-                // Pattern: keep row if (r + fade) % (fade + 1) == 0
-                if ((r + fade) % (fade + 1) != 0) continue;
-
-                // Letter 'N' with pixel skipping
-                for (int c = 0; c < 2; c++) {
-                    uint8_t byte = pgm_read_byte(&letter_N[r * 2 + c]);
-                    for (int b = 0; b < 8; b++) {
-                        // Skip more pixels horizontally as fade increases
-                        if ((b + fade) % (fade + 1) != 0) continue;
-                        if (byte & (0x80 >> b)) {
-                            u8g2->drawPixel(startX + c * 8 + b, startY + r);
-                        }
-                    }
-                }
+    if (frameCount % 6 == 0 && fishX > 0) {
+        bubbles[nextBubble].x = fishX - 5;                      // Spawn behind fish
+        bubbles[nextBubble].y = fishY + 16 + (random(10) - 5);  // Randomize vertical pos (-5 to +5)
+        bubbles[nextBubble].size = 2 + random(4);               // Random size (2-5 pixels)
+        bubbles[nextBubble].active = true;
+        nextBubble = (nextBubble + 1) % 6;  // Advance to next slot (wraps around)
+    }
 
-                // Letter 'E' with pixel skipping
-                for (int c = 0; c < 2; c++) {
-                    uint8_t byte = pgm_read_byte(&letter_E[r * 2 + c]);
-                    for (int b = 0; b < 8; b++) {
-                        if ((b + fade) % (fade + 1) != 0) continue;
-                        if (byte & (0x80 >> b)) {
-                            u8g2->drawPixel(startX + 16 + letterSpacing + c * 8 + b, startY + r);
-                        }
-                    }
-                }
+    
+    // Bubble physics - update positions and render active bubbles
+    // Bubbles float upward and drift left to simulate rising in water
+    
+    for (int i = 0; i < 6; i++) {
+        if (bubbles[i].active) {
+            drawBubble(display, bubbles[i].x, bubbles[i].y, bubbles[i].size);
+            bubbles[i].y -= 2;  // Float upward (2 pixels per frame)
+            bubbles[i].x -= 1;  // Drift leftward (1 pixel per frame)
+
+            // Deactivate bubble when it floats off the top of screen
+            if (bubbles[i].y < -5) {
+                bubbles[i].active = false;
+            }
+        }
+    }
 
-                // Letter 'M' with pixel skipping
-                for (int c = 0; c < 2; c++) {
-                    uint8_t byte = pgm_read_byte(&letter_M[r * 2 + c]);
-                    for (int b = 0; b < 8; b++) {
-                        if ((b + fade) % (fade + 1) != 0) continue;
-                        if (byte & (0x80 >> b)) {
-                            u8g2->drawPixel(startX + 32 + letterSpacing * 2 + c * 8 + b, startY + r);
-                        }
-                    }
-                }
+    fishX += 4;  // Move fish rightward (4 pixels per frame)
+    frameCount++;
 
-                // Letter 'O' with pixel skipping
-                for (int c = 0; c < 2; c++) {
-                    uint8_t byte = pgm_read_byte(&letter_O[r * 2 + c]);
-                    for (int b = 0; b < 8; b++) {
-                        if ((b + fade) % (fade + 1) != 0) continue;
-                        if (byte & (0x80 >> b)) {
-                            u8g2->drawPixel(startX + 48 + letterSpacing * 3 + c * 8 + b, startY + r);
-                        }
-                    }
-                }
+    // Cycle through tail animation frames every 4 render frames
+    if (frameCount % 4 == 0) {
+        tailFrame++;  // Advance to next animation frame (wraps via modulo in drawFish)
+    }
+}
+
+/**
+ * @brief Render the next frame into the buffer and advance the state.
+ *
+ * Frame timing matches the original animation:
+ * - Swim: 35 ms per frame (~28 FPS), then a 300 ms blank pause
+ * - Reveal: 2 logo rows per 35 ms frame, then 200 ms before the subtitle
+ * - Subtitle: one line every 150 ms, then the complete logo holds for 2 s
+ * - Fade: 8 dissolve steps of 60 ms, then 100 ms of blank screen
+ */
+void Splash_Screen::renderFrame() {
+    switch (phase) {
+        case SPLASH_SWIM:
+            if (fishX < 140) {
+                renderSwimFrame();
+                frameDelay = 35;
+            } else {
+                // Brief pause and clear screen for transition
+                display->clearBuffer();
+                frameDelay = 300;
+                phase = SPLASH_REVEAL;
+                phaseStep = 0;
             }
-        }
+            break;
+
+        case SPLASH_REVEAL:
+            // Each frame reveals 2 more rows, creating a "drawing" effect
+            display->clearBuffer();
+            drawLogoRows(display, phaseStep, 0);
+            phaseStep += 2;
+            frameDelay = 35;
+            if (phaseStep >= 24) {
+                frameDelay += 200;  // Small pause before subtitle appears
+                display->setFont(u8g2_font_5x7_tf);  // Smaller font for subtitle text
+                phase = SPLASH_SUBTITLE;
+                phaseStep = 0;
+            }
+            break;
+
+        case SPLASH_SUBTITLE:
+            // Drawn over the logo, one line per frame for a "typewriter" effect
+            if (phaseStep == 0) {
+                display->drawStr(4, 38, "NMEA2000 Education &");
+                frameDelay = 150;
+                phaseStep++;
+            } else if (phaseStep == 1) {
+                display->drawStr(8, 48, "Maritime Operations");
+                frameDelay = 150;
+                phaseStep++;
+            } else {
+                display->drawStr(40, 58, "Platform");
+                frameDelay = 2000;  // Hold the complete logo for viewing
+                phase = SPLASH_FADE;
+                phaseStep = 0;
+            }
+            break;
 
-        u8g2->sendBuffer();
-        delay(60);  // Slightly longer delay for visible fade steps
+        case SPLASH_FADE:
+            display->clearBuffer();
+            if (phaseStep < 7) {
+                drawLogoRows(display, 23, phaseStep);
+            }
+            frameDelay = 60;  // Slightly longer delay for visible fade steps
+            if (++phaseStep == 8) {
+                phase = SPLASH_CLEAR;
+                phaseStep = 0;
+            }
+            break;
+
+        case SPLASH_CLEAR:
+            // The last fade step is already blank, hold it briefly before the menu
+            if (phaseStep == 0) {
+                display->clearBuffer();
+                frameDelay = 100;
+                phaseStep = 1;
+            } else {
+                phase = SPLASH_DONE;
+                return;
+            }
+            break;
+
+        case SPLASH_DONE:
+            return;
     }
 
-    
-    // Final cleanup - clear screen before handing control to menu system
-    
-    u8g2->clearBuffer();
-    u8g2->sendBuffer();
-    delay(100);  // Brief pause before menu appears
+    frameStart = millis();
+    flushPage = 0;
 }
@@ -9,6 +9,8 @@
  *
  * The splash screen uses the U8g2 graphics library for rendering
  * bitmap graphics and animations on the SH1106 128x64 OLED display.
+ * It is advanced in small time slices by the loop scheduler, so the
+ * network is monitored from power-on and any button cuts it short.
  */
 
 #ifndef SPLASH_SCREEN_H
@@ -16,41 +18,115 @@
 
 #include <Arduino.h>
 #include <U8g2lib.h>
+#include "constants.h"
+
+/**
+ * @enum SplashPhase
+ * @brief Stage of the boot animation.
+ */
+enum SplashPhase : uint8_t {
+    SPLASH_SWIM,        ///< Fish swims across with bubbles
+    SPLASH_REVEAL,      ///< NEMO logo builds row by row
+    SPLASH_SUBTITLE,    ///< Platform name appears line by line
+    SPLASH_FADE,        ///< Logo dissolves
+    SPLASH_CLEAR,       ///< Blank screen before the menu appears
+    SPLASH_DONE         ///< Animation finished or skipped
+};
 
 /**
  * @class Splash_Screen
  * @brief Handles the boot splash screen animation for the NEMO device.
  *
- * This class provides static methods for displaying an animated splash
- * screen on the OLED display during device startup. The animation features
- * a swimming clownfish (representing NEMO) with bubbles and the NEMO logo.
+ * The animation features a swimming clownfish (representing NEMO) with
+ * bubbles and the NEMO logo. It runs as a state machine driven by step(),
+ * which the loop scheduler calls like any other task, so CAN capture and the
+ * monitor are already running while the fish swims.
+ *
+ * Each step() either sends a few pages of the current frame to the panel or,
+ * once the frame has been shown long enough, renders the next one. A full
+ * frame therefore never holds up the loop for a whole I2C buffer transfer.
  *
- * The splash screen is designed to be displayed using U8g2 graphics mode,
- * and after completion, control is handed off to U8x8 text mode for menu
- * navigation.
+ * The splash screen is displayed using U8g2 graphics mode, and after
+ * completion control is handed off to U8x8 text mode for menu navigation.
  */
 class Splash_Screen {
 public:
     /**
-     * @brief Display the splash screen animation sequence.
+     * @brief Construct the animation for a display.
      *
-     * This method runs the complete boot animation sequence which includes:
-     * - Animated clownfish swimming across the screen
-     * - Rising bubble effects
-     * - NEMO logo display
+     * @param u8g2 Pointer to the U8G2 display driver instance.
+     */
+    Splash_Screen(U8G2_SH1106_128X64_NONAME_F_HW_I2C* u8g2);
+
+    /**
+     * @brief Initialize the display and start the animation.
+     */
+    void begin();
+
+    /**
+     * @brief Advance the animation by one time slice.
      *
-     * The animation uses U8g2 graphics mode for smooth bitmap rendering.
-     * After the animation completes, the display can be switched to U8x8
-     * text mode for menu navigation.
+     * Sends up to SPLASH_PAGES_PER_STEP pages of the current frame, or
+     * renders the next frame when the current one is due to be replaced.
+     * Returns immediately when there is nothing to do yet.
      *
-     * @param u8g2 Pointer to the U8G2 display driver instance.
-     *             Must be initialized before calling this method.
+     * @return true once the animation has finished.
+     */
+    bool step();
+
+    /**
+     * @brief End the animation early and blank the screen.
+     */
+    void skip();
+
+    /**
+     * @brief Check whether the animation has finished.
      *
-     * @return void
+     * @return true after the last frame or after skip().
      */
-    static void show(U8G2_SH1106_128X64_NONAME_F_HW_I2C* u8g2);
+    bool isDone() const { return phase == SPLASH_DONE; }
 
 private:
+    /**
+     * @brief One rising bubble of the swim phase.
+     */
+    struct Bubble {
+        int x, y, size;     ///< Position and radius of bubble
+        bool active;        ///< Whether this bubble slot is currently in use
+    };
+
+    U8G2_SH1106_128X64_NONAME_F_HW_I2C* display;   ///< Display the animation is drawn on
+    SplashPhase phase;                              ///< Current stage of the animation
+    uint8_t phaseStep;                              ///< Frames rendered in the current stage
+    uint8_t flushPage;                              ///< Next page of the frame to send
+    uint32_t frameStart;                            ///< millis() when the current frame was rendered
+    uint16_t frameDelay;                            ///< How long the current frame stays up (ms)
+
+    int fishX;              ///< Horizontal fish position
+    int tailFrame;          ///< Tail animation frame
+    int frameCount;         ///< Swim frames rendered so far
+    Bubble bubbles[6];      ///< Bubble slots (circular buffer)
+    int nextBubble;         ///< Slot the next bubble spawns in
+
+    /**
+     * @brief Render the next frame into the buffer and advance the state.
+     */
+    void renderFrame();
+
+    /**
+     * @brief Render one frame of the swimming fish and its bubbles.
+     */
+    void renderSwimFrame();
+
+    /**
+     * @brief Draw the NEMO logo, optionally partial or dissolved.
+     *
+     * @param u8g2    Pointer to the U8G2 display driver instance.
+     * @param lastRow Last bitmap row to draw (0-23).
+     * @param fade    Dissolve level, 0 draws every pixel.
+     */
+    static void drawLogoRows(U8G2_SH1106_128X64_NONAME_F_HW_I2C* u8g2, int lastRow, int fade);
+
     /**
      * @brief Draw the animated clownfish at a specific position and frame.
      *
@@ -0,0 +1,341 @@
+/**
+ * \file TX_Scheduler.cpp
+ * \brief Implementation of the interrupt-timed CAN1 transmit scheduler
+ *
+ * Contains the stream configuration and staging (loop context), the tick
+ * interrupt with its release and drain steps, and the statistics.
+ */
+
+#include "TX_Scheduler.h"
+
+static_assert((TX_QUEUE_SIZE & (TX_QUEUE_SIZE - 1)) == 0,
+              "TX_QUEUE_SIZE must be a power of two");
+static_assert(TX_QUEUE_SIZE >= (tN2kMsg::MaxDataLen + 6) / 7,
+              "TX_QUEUE_SIZE must hold the longest fast packet");
+static_assert(TX_MAX_STREAMS < 255, "Stream indices must fit QueuedFrame::stream");
+
+TX_Scheduler* TX_Scheduler::instance = nullptr;
+
+/**
+ * \brief Build the 29-bit CAN identifier of a message
+ *
+ * For PDU1 PGNs (PF < 240) the destination goes into the PS byte.
+ *
+ * \param msg Message to address
+ * \return CAN identifier
+ */
+static uint32_t buildCanId(const tN2kMsg& msg) {
+    uint32_t pgn = msg.PGN & 0x3FFFF;
+    uint32_t id = ((uint32_t)(msg.Priority & 0x7) << 26) | msg.Source;
+    if(((pgn >> 8) & 0xFF) < 240) {
+        return id | ((pgn & 0x3FF00) << 8) | ((uint32_t)msg.Destination << 8);
+    }
+    return id | (pgn << 8);
+}
+
+TX_Scheduler::TX_Scheduler(CAN_TxTap* bus) {
+    transmitBus = bus;
+    streamCount = 0;
+    paused = false;
+    queueHead = 0;
+    queueTail = 0;
+    queueDepth = 0;
+
+    for(uint8_t i = 0; i < TX_MAX_STREAMS; i++) {
+        TxStream& stream = streams[i];
+        stream.period = 1000000;    // 1 Hz until setStream()
+        stream.phase = 0;
+        stream.enabled = false;
+        stream.restart.store(false);
+        stream.nextDue = 0;
+        stream.staged.store(false);
+        stream.id = 0;
+        stream.length = 0;
+        stream.fastPacket = false;
+        stream.sequence = 0;
+    }
+    resetStats();
+}
+
+void TX_Scheduler::begin() {
+    instance = this;
+    tickTimer.begin(tickISR, TX_TICK_US);
+}
+
+/* ---------------------------------------------------------------------------
+ * Streams (loop context)
+ * ------------------------------------------------------------------------- */
+
+int TX_Scheduler::addStream() {
+    if(streamCount >= TX_MAX_STREAMS) return -1;
+    return streamCount++;
+}
+
+void TX_Scheduler::setStream(uint8_t index, uint32_t periodMicros, uint32_t phaseMicros) {
+    if(index >= streamCount) return;
+    TxStream& stream = streams[index];
+    stream.period = max(periodMicros, TX_TICK_US);
+    stream.phase = phaseMicros;
+    stream.restart.store(true, std::memory_order_release);
+}
+
+void TX_Scheduler::setEnabled(uint8_t index, bool enable) {
+    if(index >= streamCount) return;
+    TxStream& stream = streams[index];
+    if(stream.enabled == enable) return;
+
+    if(enable) {
+        stream.staged.store(false, std::memory_order_relaxed);
+        stream.restart.store(true, std::memory_order_release);
+    }
+    stream.enabled = enable;
+}
+
+bool TX_Scheduler::needsMessage(uint8_t index) const {
+    if(index >= streamCount) return false;
+    const TxStream& stream = streams[index];
+    if(!stream.enabled || paused) return false;
+    if(stream.staged.load(std::memory_order_acquire)) return false;
+    // nextDue is stale until the interrupt has applied a restart
+    if(stream.restart.load(std::memory_order_acquire)) return false;
+
+    int32_t untilDue = (int32_t)(stream.nextDue - micros());
+    return untilDue < (int32_t)(TX_STAGE_LEAD_MS * 1000);
+}
+
+/**
+ * \brief Stage the next message of a stream
+ *
+ * The payload is copied before staged is published with release ordering,
+ * so the interrupt never sends a half-written message.
+ *
+ * \param index Stream index
+ * \param msg Message to send in the stream's next slot
+ * \return false if a message is already staged, the stream is unused, or
+ *         a single-frame PGN carries more than 8 bytes
+ */
+bool TX_Scheduler::stage(uint8_t index, const tN2kMsg& msg) {
+    if(index >= streamCount) return false;
+    TxStream& stream = streams[index];
+    if(stream.staged.load(std::memory_order_acquire)) return false;
+
+    uint8_t length = (uint8_t)constrain(msg.DataLen, 0, tN2kMsg::MaxDataLen);
+    bool fastPacket = isFastPacketPGN(msg.PGN);
+    // Longer single-frame PGNs would need ISO transport, which isn't scheduled
+    if(!fastPacket && length > 8) return false;
+
+    stream.id = buildCanId(msg);
+    stream.length = length;
+    stream.fastPacket = fastPacket;
+    memcpy(stream.data, msg.Data, length);
+    stream.staged.store(true, std::memory_order_release);
+    return true;
+}
+
+void TX_Scheduler::setPaused(bool pause) {
+    if(paused == pause) return;
+    if(!pause) {
+        for(uint8_t i = 0; i < streamCount; i++) {
+            if(streams[i].enabled) streams[i].restart.store(true, std::memory_order_release);
+        }
+    }
+    paused = pause;
+}
+
+/**
+ * \brief Pass the frames sent since the last call to the frame hook
+ *
+ * The hook is read on every call, so frames sent before a hook was set
+ * are discarded rather than delivered late.
+ */
+void TX_Scheduler::service() {
+    CaptureFrameHook hook = transmitBus->getFrameHook();
+    CaptureFrame frame;
+    while(sentRing.pop(frame)) {
+        if(hook != nullptr) hook(frame);
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Tick interrupt
+ * ------------------------------------------------------------------------- */
+
+void TX_Scheduler::tickISR() {
+    if(instance != nullptr) {
+        instance->tick();
+    }
+}
+
+/**
+ * \brief Release the due streams and feed the driver
+ *
+ * A stream whose slot passed without a staged message counts a miss and
+ * moves on to its next slot, so it never catches up with a burst.
+ */
+void TX_Scheduler::tick() {
+    if(!paused) {
+        uint32_t now = micros();
+
+        for(uint8_t i = 0; i < streamCount; i++) {
+            TxStream& stream = streams[i];
+
+            if(stream.restart.exchange(false, std::memory_order_acq_rel)) {
+                stream.nextDue = now + stream.phase;
+                continue;
+            }
+            if(!stream.enabled) continue;
+
+            uint32_t late = now - stream.nextDue;
+            if((int32_t)late < 0) continue;
+
+            // Slots that passed entirely are missed, keeping the phase
+            uint32_t period = stream.period;
+            uint32_t skipped = late / period;
+            stream.nextDue = stream.nextDue + (skipped + 1) * period;
+            stream.missed = stream.missed + skipped;
+
+            if(!stream.staged.load(std::memory_order_acquire)) {
+                stream.missed = stream.missed + 1;
+                continue;
+            }
+
+            late -= skipped * period;
+            if(late > maxLateness) maxLateness = late;
+
+            if(release(i)) {
+                stream.queued = stream.queued + 1;
+            } else {
+                stream.failed = stream.failed + 1;
+            }
+            stream.staged.store(false, std::memory_order_release);
+        }
+    }
+
+    drain();
+    queueDepth = queueHead - queueTail;
+}
+
+/**
+ * \brief Split a stream's staged message into the frame queue
+ *
+ * Single-frame PGNs go out as one frame. Fast-packet PGNs always become a
+ * fast packet, even with 8 bytes or less: the first frame carries the
+ * sequence/frame counter, the total length and 6 bytes, the following
+ * frames the counter and 7 bytes each, padded with 0xFF.
+ *
+ * \param index Stream index
+ * \return false if the queue had no room for the whole message
+ */
+bool TX_Scheduler::release(uint8_t index) {
+    TxStream& stream = streams[index];
+    uint8_t length = stream.length;
+    bool fastPacket = stream.fastPacket;
+    // 6 payload bytes in the first frame, 7 in each following one
+    uint8_t frameCount = (!fastPacket || length <= 6) ? 1 : 1 + (length - 6 + 7 - 1) / 7;
+
+    if(TX_QUEUE_SIZE - (queueHead - queueTail) < frameCount) {
+        framesFailed = framesFailed + frameCount;
+        return false;
+    }
+
+    uint8_t sequence = (stream.sequence << 5) & 0xE0;
+    if(fastPacket) stream.sequence = (stream.sequence + 1) & 0x07;
+
+    uint8_t offset = 0;
+    for(uint8_t n = 0; n < frameCount; n++) {
+        QueuedFrame& frame = queue[queueHead & (TX_QUEUE_SIZE - 1)];
+        frame.id = stream.id;
+        frame.stream = index;
+        frame.remaining = frameCount - n;
+        frame.retries = 0;
+
+        if(!fastPacket) {
+            frame.len = length;
+            memcpy(frame.data, stream.data, length);
+        } else {
+            uint8_t header = 1;
+            frame.data[0] = sequence | n;
+            if(n == 0) frame.data[header++] = length;
+
+            uint8_t chunk = min((uint8_t)(8 - header), (uint8_t)(length - offset));
+            memcpy(&frame.data[header], &stream.data[offset], chunk);
+            memset(&frame.data[header + chunk], 0xFF, 8 - header - chunk);
+            offset += chunk;
+            frame.len = 8;
+        }
+        queueHead++;
+    }
+
+    framesQueued = framesQueued + frameCount;
+    uint32_t depth = queueHead - queueTail;
+    if(depth > queueHighWater) queueHighWater = depth;
+    return true;
+}
+
+/**
+ * \brief Send queued frames until the driver refuses one
+ *
+ * Does nothing while the library is inside the driver; the frames go out
+ * on the next tick. A refused frame keeps its place, so frames of a fast
+ * packet never overtake each other.
+ */
+void TX_Scheduler::drain() {
+    if(transmitBus->isSending()) return;
+    bool report = transmitBus->getFrameHook() != nullptr;
+
+    while(queueTail != queueHead) {
+        QueuedFrame& frame = queue[queueTail & (TX_QUEUE_SIZE - 1)];
+
+        if(transmitBus->sendRawFrame(frame.id, frame.len, frame.data)) {
+            framesSent = framesSent + 1;
+            if(frame.remaining == 1) {
+                streams[frame.stream].sent = streams[frame.stream].sent + 1;
+            }
+            if(report) {
+                CaptureFrame sent;
+                sent.timestamp = micros();
+                sent.id = frame.id;
+                sent.len = frame.len;
+                memcpy(sent.data, frame.data, frame.len);
+                sentRing.push(sent);
+            }
+            queueTail++;
+            continue;
+        }
+
+        retries = retries + 1;
+        if(++frame.retries <= TX_MAX_RETRIES) break;
+
+        // Give up on the rest of the message as well, it can't be reassembled
+        uint8_t dropCount = frame.remaining;
+        streams[frame.stream].failed = streams[frame.stream].failed + 1;
+        framesFailed = framesFailed + dropCount;
+        queueTail += dropCount;
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Statistics
+ * ------------------------------------------------------------------------- */
+
+void TX_Scheduler::resetStats() {
+    framesQueued = 0;
+    framesSent = 0;
+    framesFailed = 0;
+    retries = 0;
+    queueHighWater = 0;
+    maxLateness = 0;
+    sentRing.resetStats();
+    for(uint8_t i = 0; i < TX_MAX_STREAMS; i++) {
+        resetStreamStats(i);
+    }
+}
+
+void TX_Scheduler::resetStreamStats(uint8_t index) {
+    if(index >= TX_MAX_STREAMS) return;
+    TxStream& stream = streams[index];
+    stream.queued = 0;
+    stream.sent = 0;
+    stream.failed = 0;
+    stream.missed = 0;
+}
@@ -0,0 +1,335 @@
+/**
+ * \file TX_Scheduler.h
+ * \brief Interrupt-timed transmit scheduler for the CAN1 interface
+ *
+ * Periodic traffic used to be sent from loop tasks: the simulated devices
+ * from the Sensors task and the impersonation attack on a 100 ms millis()
+ * tick. Their timing therefore jittered with whatever the loop was doing,
+ * and a message the driver refused was gone without a trace.
+ *
+ * TX_Scheduler sends them from a hardware timer instead. Each periodic
+ * source is a stream with its own period and phase offset:
+ * - In loop context the owner builds the stream's next message shortly
+ *   before its slot (needsMessage(), then stage()).
+ * - Every TX_TICK_US the interrupt releases due streams into a frame
+ *   queue, splitting fast packets, and feeds the queue to the driver.
+ *
+ * Slots are kept on an absolute clock, so the average rate is exact and
+ * each message leaves within one tick of its slot when the bus is free.
+ * A frame the driver refuses stays at the head of the queue and is
+ * retried on the next ticks; after TX_MAX_RETRIES it is dropped together
+ * with the rest of its message. Queued, sent, failed and retried frames
+ * and the queue high-water mark show when the transmit side saturates.
+ *
+ * \note Library traffic (address claims, heartbeats, product information,
+ *       the DoS attack) still goes through the library in loop context.
+ *       CAN_TxTap flags when the library is inside the driver, and the
+ *       interrupt then waits for the next tick. The capture replay runs on
+ *       the same PIT interrupt, so the two never preempt each other.
+ */
+
+#ifndef TX_SCHEDULER_H
+#define TX_SCHEDULER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <N2kMsg.h>
+#include <CAN_Capture.h>
+#include <PGN_Helpers.h>
+#include "constants.h"
+
+/**
+ * \struct TxStream
+ * \brief Schedule, staged message and statistics of one transmit stream
+ */
+struct TxStream {
+    /* Configuration (written by the loop) */
+    volatile uint32_t period;           ///< Slot period (micros)
+    volatile uint32_t phase;            ///< First slot after a restart, from the restart (micros)
+    volatile bool enabled;              ///< Slots are released
+    std::atomic<bool> restart;          ///< Ask the interrupt to re-anchor the slots
+
+    /* Schedule (written by the interrupt) */
+    volatile uint32_t nextDue;          ///< micros() of the next slot
+
+    /* Staged message */
+    std::atomic<bool> staged;           ///< Set by the loop once the message is complete
+    uint32_t id;                        ///< 29-bit CAN identifier of the message
+    uint8_t length;                     ///< Payload length in bytes
+    bool fastPacket;                    ///< The PGN is sent as a fast packet, whatever the length
+    uint8_t data[tN2kMsg::MaxDataLen];  ///< Payload
+    uint8_t sequence;                   ///< Fast-packet sequence counter (0-7)
+
+    /* Statistics, in messages */
+    volatile uint32_t queued;           ///< Released into the frame queue
+    volatile uint32_t sent;             ///< Accepted by the driver, all frames
+    volatile uint32_t failed;           ///< Dropped after retries or because the queue was full
+    volatile uint32_t missed;           ///< Slots with no message staged in time
+};
+
+/**
+ * \class TX_Scheduler
+ * \brief Releases stream messages on time and queues their frames for CAN1
+ *
+ * Stream configuration and staging happen in loop context, everything
+ * else in the tick interrupt. The staged flag hands a stream's message
+ * buffer from one side to the other, so neither disables interrupts.
+ */
+class TX_Scheduler {
+private:
+    /**
+     * \struct QueuedFrame
+     * \brief A frame waiting for the driver
+     */
+    struct QueuedFrame {
+        uint32_t id;            ///< 29-bit CAN identifier
+        uint8_t len;            ///< Number of data bytes
+        uint8_t data[8];        ///< Frame payload
+        uint8_t stream;         ///< Stream the frame belongs to
+        uint8_t remaining;      ///< Frames of the message left, this one included
+        uint8_t retries;        ///< Times the driver refused the frame
+    };
+
+    static TX_Scheduler* instance;      ///< Instance serviced by the tick interrupt
+    IntervalTimer tickTimer;            ///< Timer driving tick()
+    CAN_TxTap* transmitBus;             ///< CAN1 interface frames are sent on
+    CAN_FrameRing sentRing;             ///< Sent frames waiting for the frame hook
+
+    TxStream streams[TX_MAX_STREAMS];   ///< Stream table
+    uint8_t streamCount;                ///< Streams handed out by addStream()
+    volatile bool paused;               ///< Nothing is released or sent
+
+    /* Frame queue (interrupt context only) */
+    QueuedFrame queue[TX_QUEUE_SIZE];   ///< Frames released but not yet sent
+    uint32_t queueHead;                 ///< Next write index
+    uint32_t queueTail;                 ///< Next read index
+    volatile uint32_t queueDepth;       ///< Copy of the fill level for the loop
+
+    /* Statistics, in frames */
+    volatile uint32_t framesQueued;     ///< Frames released into the queue
+    volatile uint32_t framesSent;       ///< Frames the driver accepted
+    volatile uint32_t framesFailed;     ///< Frames dropped
+    volatile uint32_t retries;          ///< Times the driver refused a frame
+    volatile uint32_t queueHighWater;   ///< Highest queue fill level seen
+    volatile uint32_t maxLateness;      ///< Worst release time after a slot (micros)
+
+    /**
+     * \brief IntervalTimer entry point
+     */
+    static void tickISR();
+
+    /**
+     * \brief Release the due streams and feed the driver
+     *
+     * Runs in interrupt context.
+     */
+    void tick();
+
+    /**
+     * \brief Split a stream's staged message into the frame queue
+     *
+     * \param index Stream index
+     * \return false if the queue had no room for the whole message
+     */
+    bool release(uint8_t index);
+
+    /**
+     * \brief Send queued frames until the driver refuses one
+     */
+    void drain();
+
+public:
+    /**
+     * \brief Construct a scheduler with no streams
+     *
+     * \param bus CAN1 interface frames are sent on
+     */
+    TX_Scheduler(CAN_TxTap* bus);
+
+    /**
+     * \brief Start the tick interrupt
+     *
+     * Call after the interface has been opened.
+     */
+    void begin();
+
+    /**
+     * \brief Allocate a stream
+     *
+     * The stream starts disabled; configure it with setStream().
+     *
+     * \return Stream index, or -1 if all TX_MAX_STREAMS are taken
+     */
+    int addStream();
+
+    /**
+     * \brief Set the period and phase of a stream and restart its slots
+     *
+     * The first slot is phase after the interrupt picks up the change,
+     * the following ones every period after that.
+     *
+     * \param index Stream index
+     * \param periodMicros Slot period (micros), at least TX_TICK_US
+     * \param phaseMicros Offset of the first slot (micros)
+     */
+    void setStream(uint8_t index, uint32_t periodMicros, uint32_t phaseMicros);
+
+    /**
+     * \brief Enable or disable a stream
+     *
+     * Enabling restarts the slots with the configured phase. A message
+     * staged while the stream was off is discarded.
+     *
+     * \param index Stream index
+     * \param enable true to release the stream's slots
+     */
+    void setEnabled(uint8_t index, bool enable);
+
+    /**
+     * \brief Check whether a stream wants its next message
+     *
+     * \param index Stream index
+     * \return true if the stream is enabled, nothing is staged and its next
+     *         slot is less than TX_STAGE_LEAD_MS away
+     */
+    bool needsMessage(uint8_t index) const;
+
+    /**
+     * \brief Stage the next message of a stream
+     *
+     * The CAN identifier is built from the message's priority, PGN, source
+     * and destination. Fast-packet PGNs (isFastPacketPGN()) are sent as fast
+     * packets even when the payload would fit one frame, the others as a
+     * single frame.
+     *
+     * \param index Stream index
+     * \param msg Message to send in the stream's next slot
+     * \return false if a message is already staged, the stream is unused, or
+     *         a single-frame PGN carries more than 8 bytes
+     */
+    bool stage(uint8_t index, const tN2kMsg& msg);
+
+    /**
+     * \brief Hold back or resume all streams
+     *
+     * Used while a capture is replayed onto CAN1. Frames already queued
+     * stay queued. Resuming restarts every enabled stream, so slots that
+     * passed meanwhile are not counted as missed.
+     *
+     * \param pause true to hold back
+     */
+    void setPaused(bool pause);
+
+    /**
+     * \brief Check whether the streams are held back
+     *
+     * \return true while paused
+     */
+    bool isPaused() const { return paused; }
+
+    /**
+     * \brief Pass the frames sent since the last call to the frame hook
+     *
+     * Call regularly from loop(); the hook must not run in interrupt context.
+     */
+    void service();
+
+    /**
+     * \brief Get a stream
+     *
+     * \param index Stream index
+     * \return Stream, or nullptr if index was not handed out
+     */
+    const TxStream* getStream(uint8_t index) const { return index < streamCount ? &streams[index] : nullptr; }
+
+    /**
+     * \brief Get the number of streams handed out
+     *
+     * \return Stream count
+     */
+    uint8_t getStreamCount() const { return streamCount; }
+
+    /**
+     * \brief Get the number of frames released into the queue
+     *
+     * \return Queued frame count
+     */
+    uint32_t getFramesQueued() const { return framesQueued; }
+
+    /**
+     * \brief Get the number of frames the driver accepted
+     *
+     * \return Sent frame count
+     */
+    uint32_t getFramesSent() const { return framesSent; }
+
+    /**
+     * \brief Get the number of frames dropped
+     *
+     * \return Frames dropped after TX_MAX_RETRIES or because the queue was full
+     */
+    uint32_t getFramesFailed() const { return framesFailed; }
+
+    /**
+     * \brief Get the number of times the driver refused a frame
+     *
+     * \return Retry count
+     */
+    uint32_t getRetries() const { return retries; }
+
+    /**
+     * \brief Get the number of frames in the queue
+     *
+     * \return Current depth
+     */
+    uint32_t getQueueDepth() const { return queueDepth; }
+
+    /**
+     * \brief Get the highest number of frames the queue held
+     *
+     * \return High-water mark in frames
+     */
+    uint32_t getQueueHighWater() const { return queueHighWater; }
+
+    /**
+     * \brief Get the worst time between a slot and its release
+     *
+     * \return Lateness in microseconds
+     */
+    uint32_t getMaxLateness() const { return maxLateness; }
+
+    /**
+     * \brief Get the number of sent frames the frame hook never saw
+     *
+     * \return Frames lost because the sent ring was full
+     */
+    uint32_t getHookDropped() const { return sentRing.getDropped(); }
+
+    /**
+     * \brief Get the ring of sent frames waiting for the frame hook
+     *
+     * \return Ring, e.g. for its fill level
+     */
+    const CAN_FrameRing& getSentRing() const { return sentRing; }
+
+    /**
+     * \brief Get the size of one queued frame
+     *
+     * \return Bytes per frame in the queue
+     */
+    static uint32_t getQueuedFrameBytes() { return sizeof(QueuedFrame); }
+
+    /**
+     * \brief Clear the scheduler and stream statistics
+     */
+    void resetStats();
+
+    /**
+     * \brief Clear the statistics of one stream
+     *
+     * \param index Stream index
+     */
+    void resetStreamStats(uint8_t index);
+};
+
+#endif // TX_SCHEDULER_H
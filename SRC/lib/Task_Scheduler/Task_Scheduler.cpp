@@ -0,0 +1,171 @@
+/**
+ * \file Task_Scheduler.cpp
+ * \brief Implementation of the cooperative loop scheduler
+ *
+ * Contains the per-priority deadline heaps and the run-time accounting.
+ */
+
+#include "Task_Scheduler.h"
+
+Task_Scheduler::Task_Scheduler() {
+    taskCount = 0;
+    for(uint8_t p = 0; p < TASK_PRIORITY_COUNT; p++) {
+        heapSizes[p] = 0;
+    }
+    statsStartMicros = 0;
+}
+
+int Task_Scheduler::addTask(const char* name, TaskFunction function, uint32_t periodMillis, TaskPriority priority) {
+    if(taskCount >= SCHEDULER_MAX_TASKS || function == nullptr || priority >= TASK_PRIORITY_COUNT) {
+        return -1;
+    }
+
+    uint8_t index = taskCount++;
+    SchedulerTask& task = tasks[index];
+    task.name = name;
+    task.function = function;
+    task.periodMicros = periodMillis * 1000UL;
+    task.nextRunMicros = micros();
+    task.priority = priority;
+
+    task.runCount = 0;
+    task.overrunCount = 0;
+    task.lastRunMicros = 0;
+    task.maxRunMicros = 0;
+    task.totalRunMicros = 0;
+    task.maxLatencyMicros = 0;
+
+    if(taskCount == 1) statsStartMicros = task.nextRunMicros;
+
+    uint8_t pos = heapSizes[priority]++;
+    heaps[priority][pos] = index;
+    siftUp(priority, pos);
+    return index;
+}
+
+void Task_Scheduler::siftUp(uint8_t priority, uint8_t pos) {
+    uint8_t* heap = heaps[priority];
+    while(pos > 0) {
+        uint8_t parent = (pos - 1) / 2;
+        if(!earlier(tasks[heap[pos]].nextRunMicros, tasks[heap[parent]].nextRunMicros)) break;
+        uint8_t tmp = heap[pos];
+        heap[pos] = heap[parent];
+        heap[parent] = tmp;
+        pos = parent;
+    }
+}
+
+void Task_Scheduler::siftDown(uint8_t priority, uint8_t pos) {
+    uint8_t* heap = heaps[priority];
+    uint8_t size = heapSizes[priority];
+    while(true) {
+        uint8_t left = 2 * pos + 1;
+        uint8_t right = left + 1;
+        uint8_t first = pos;
+
+        if(left < size && earlier(tasks[heap[left]].nextRunMicros, tasks[heap[first]].nextRunMicros)) {
+            first = left;
+        }
+        if(right < size && earlier(tasks[heap[right]].nextRunMicros, tasks[heap[first]].nextRunMicros)) {
+            first = right;
+        }
+        if(first == pos) return;
+
+        uint8_t tmp = heap[pos];
+        heap[pos] = heap[first];
+        heap[first] = tmp;
+        pos = first;
+    }
+}
+
+/**
+ * \brief Run the earliest task of a heap if it is due
+ *
+ * The next deadline advances by one period from the current one, so a task
+ * keeps its rate even if it started a little late. A task that fell a full
+ * period behind is counted as an overrun and rescheduled from now instead,
+ * so it does not run several times in a row to catch up.
+ *
+ * \param priority Heap to take the task from
+ * \param now Current time (micros)
+ * \return true if a task was run
+ */
+bool Task_Scheduler::runNext(uint8_t priority, uint32_t now) {
+    if(heapSizes[priority] == 0) return false;
+
+    SchedulerTask& task = tasks[heaps[priority][0]];
+    if(earlier(now, task.nextRunMicros)) return false;
+
+    uint32_t latency = now - task.nextRunMicros;
+    if(latency > task.maxLatencyMicros) task.maxLatencyMicros = latency;
+
+    if(task.periodMicros == 0) {
+        task.nextRunMicros = now;
+    } else if(latency >= task.periodMicros) {
+        task.overrunCount++;
+        task.nextRunMicros = now + task.periodMicros;
+    } else {
+        task.nextRunMicros += task.periodMicros;
+    }
+
+    // Reschedule before running, the heap is consistent if the task adds load
+    siftDown(priority, 0);
+
+    uint32_t start = micros();
+    task.function();
+    uint32_t duration = micros() - start;
+
+    task.runCount++;
+    task.lastRunMicros = duration;
+    task.totalRunMicros += duration;
+    if(duration > task.maxRunMicros) task.maxRunMicros = duration;
+    return true;
+}
+
+/**
+ * \brief Run the tasks that are due
+ *
+ * All due high priority tasks run first. Period 0 tasks are due on every
+ * call but run only once per call. Afterwards a single lower priority task
+ * runs, normal before low, so the next call comes around to the high
+ * priority tasks again right after it.
+ */
+void Task_Scheduler::run() {
+    uint32_t now = micros();
+
+    // A period 0 task reschedules itself at now, so stop after each has had one run
+    uint8_t highCount = heapSizes[TASK_PRIORITY_HIGH];
+    for(uint8_t i = 0; i < highCount; i++) {
+        if(!runNext(TASK_PRIORITY_HIGH, now)) break;
+        now = micros();
+    }
+
+    for(uint8_t p = TASK_PRIORITY_HIGH + 1; p < TASK_PRIORITY_COUNT; p++) {
+        if(runNext(p, micros())) return;
+    }
+}
+
+const SchedulerTask* Task_Scheduler::getTask(int index) const {
+    if(index < 0 || index >= taskCount) return nullptr;
+    return &tasks[index];
+}
+
+float Task_Scheduler::getLoadPercent(int index) const {
+    if(index < 0 || index >= taskCount) return 0;
+    uint32_t elapsed = micros() - statsStartMicros;
+    if(elapsed == 0) return 0;
+    return 100.0f * (float)tasks[index].totalRunMicros / elapsed;
+}
+
+void Task_Scheduler::resetStats() {
+    for(uint8_t i = 0; i < taskCount; i++) {
+        SchedulerTask& task = tasks[i];
+        task.runCount = 0;
+        task.overrunCount = 0;
+        task.lastRunMicros = 0;
+        task.maxRunMicros = 0;
+        task.totalRunMicros = 0;
+        task.maxLatencyMicros = 0;
+    }
+    statsStartMicros = micros();
+}
@@ -0,0 +1,170 @@
+/**
+ * \file Task_Scheduler.h
+ * \brief Cooperative, deadline-ordered scheduler for the main loop
+ *
+ * Every periodic job of the firmware (CAN parsing, USB capture output,
+ * logger writes, sensor transmissions, attacks, display refresh) is
+ * registered as a task with a period and a priority. loop() only calls
+ * Task_Scheduler::run().
+ *
+ * Tasks of each priority are kept in a min-heap ordered by their next
+ * deadline, so finding the next due task is constant time and rescheduling
+ * is logarithmic. A run() call executes:
+ * 1. every due TASK_PRIORITY_HIGH task
+ * 2. then at most one due task of the highest non-empty lower priority,
+ *    earliest deadline first
+ *
+ * High priority tasks therefore get to run between any two lower priority
+ * tasks, and never wait behind more than one display refresh.
+ *
+ * Each task records how often it ran, its last, longest and total run time,
+ * how late it started at worst, and how many times it fell a full period
+ * behind (an overrun).
+ */
+
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <Arduino.h>
+#include "constants.h"
+
+/**
+ * \enum TaskPriority
+ * \brief Scheduling class of a task
+ */
+enum TaskPriority : uint8_t {
+    TASK_PRIORITY_HIGH,     ///< Runs on every run() call when due (CAN, USB)
+    TASK_PRIORITY_NORMAL,   ///< Interactive work (buttons, sensors, attacks)
+    TASK_PRIORITY_LOW,      ///< Background work (display, cleanup)
+    TASK_PRIORITY_COUNT     ///< Number of priorities
+};
+
+/**
+ * \brief Function executed by a task
+ */
+typedef void (*TaskFunction)();
+
+/**
+ * \struct SchedulerTask
+ * \brief A registered task and its run-time statistics
+ */
+struct SchedulerTask {
+    const char* name;           ///< Short name for statistics output
+    TaskFunction function;      ///< Function to run
+    uint32_t periodMicros;      ///< Period (0 = every run() call)
+    uint32_t nextRunMicros;     ///< Next deadline (micros)
+    TaskPriority priority;      ///< Scheduling class
+
+    uint32_t runCount;          ///< Number of runs
+    uint32_t overrunCount;      ///< Runs that started a full period or more late
+    uint32_t lastRunMicros;     ///< Duration of the last run
+    uint32_t maxRunMicros;      ///< Longest run
+    uint64_t totalRunMicros;    ///< Sum of all run durations
+    uint32_t maxLatencyMicros;  ///< Longest delay between deadline and start
+};
+
+/**
+ * \class Task_Scheduler
+ * \brief Fixed-capacity periodic task scheduler
+ *
+ * Tasks are added once during setup() and are never removed. A task that
+ * should stop doing work simply returns early.
+ */
+class Task_Scheduler {
+private:
+    SchedulerTask tasks[SCHEDULER_MAX_TASKS];                       ///< Task storage
+    uint8_t taskCount;                                              ///< Number of registered tasks
+    uint8_t heaps[TASK_PRIORITY_COUNT][SCHEDULER_MAX_TASKS];        ///< Task indices, min-heap by deadline
+    uint8_t heapSizes[TASK_PRIORITY_COUNT];                         ///< Number of tasks in each heap
+    uint32_t statsStartMicros;                                      ///< Start of the statistics period
+
+    /**
+     * \brief Check whether one deadline comes before another
+     *
+     * \param a First deadline (micros)
+     * \param b Second deadline (micros)
+     * \return true if a is earlier than b, correct across micros() wraparound
+     */
+    static bool earlier(uint32_t a, uint32_t b) { return (int32_t)(a - b) < 0; }
+
+    /**
+     * \brief Move a heap entry up until its parent is not later
+     *
+     * \param priority Heap to work on
+     * \param pos Position of the entry
+     */
+    void siftUp(uint8_t priority, uint8_t pos);
+
+    /**
+     * \brief Move a heap entry down until no child is earlier
+     *
+     * \param priority Heap to work on
+     * \param pos Position of the entry
+     */
+    void siftDown(uint8_t priority, uint8_t pos);
+
+    /**
+     * \brief Run the earliest task of a heap if it is due
+     *
+     * \param priority Heap to take the task from
+     * \param now Current time (micros)
+     * \return true if a task was run
+     */
+    bool runNext(uint8_t priority, uint32_t now);
+
+public:
+    /**
+     * \brief Construct an empty scheduler
+     */
+    Task_Scheduler();
+
+    /**
+     * \brief Register a periodic task
+     *
+     * The first run is due immediately.
+     *
+     * \param name Short name for statistics output (stored, not copied)
+     * \param function Function to run
+     * \param periodMillis Period in milliseconds, 0 to run on every run() call
+     * \param priority Scheduling class
+     * \return Task index, or -1 if SCHEDULER_MAX_TASKS tasks are registered
+     */
+    int addTask(const char* name, TaskFunction function, uint32_t periodMillis, TaskPriority priority);
+
+    /**
+     * \brief Run the tasks that are due
+     *
+     * Call from loop() as often as possible.
+     */
+    void run();
+
+    /**
+     * \brief Get the number of registered tasks
+     *
+     * \return Task count
+     */
+    int getTaskCount() const { return taskCount; }
+
+    /**
+     * \brief Get a registered task and its statistics
+     *
+     * \param index Task index (0 to getTaskCount()-1)
+     * \return Pointer to the task, or nullptr if index is out of range
+     */
+    const SchedulerTask* getTask(int index) const;
+
+    /**
+     * \brief Get the share of time a task spent running
+     *
+     * \param index Task index
+     * \return Run time as a percentage of the time since the last resetStats()
+     */
+    float getLoadPercent(int index) const;
+
+    /**
+     * \brief Clear the statistics of all tasks
+     */
+    void resetStats();
+};
+
+#endif // TASK_SCHEDULER_H
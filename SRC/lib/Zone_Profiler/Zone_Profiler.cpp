@@ -0,0 +1,122 @@
+/**
+ * \file Zone_Profiler.cpp
+ * \brief Implementation of the zone timing table
+ */
+
+#include "Zone_Profiler.h"
+
+#if PROFILER_ENABLED
+
+#if !defined(ARM_DWT_CYCCNT)
+#include <chrono>
+#endif
+
+static_assert((PROFILER_PGN_SLOTS & (PROFILER_PGN_SLOTS - 1)) == 0,
+              "PROFILER_PGN_SLOTS must be a power of two");
+
+ProfileZoneStats Zone_Profiler::zones[PROFILE_ZONE_COUNT];
+ProfilePGNStats Zone_Profiler::pgns[PROFILER_PGN_SLOTS];
+uint16_t Zone_Profiler::pgnCount = 0;
+uint32_t Zone_Profiler::pgnOverflow = 0;
+
+static const char* const ZONE_NAMES[PROFILE_ZONE_COUNT] = {
+    "CAN2", "N2kMsg", "Parse", "Menu", "OLED", "Sensor", "Encode", "USB"
+};
+
+void Zone_Profiler::begin() {
+#if defined(ARM_DWT_CYCCNT)
+    // The Teensy core normally has the counter running already
+    ARM_DEMCR |= ARM_DEMCR_TRCENA;
+    ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+#endif
+    reset();
+}
+
+#if !defined(ARM_DWT_CYCCNT)
+uint32_t Zone_Profiler::hostNanos() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+void Zone_Profiler::record(ProfileZone zone, uint32_t cycles) {
+    ProfileZoneStats& stats = zones[zone];
+    stats.count++;
+    stats.totalCycles += cycles;
+    if(cycles > stats.maxCycles) stats.maxCycles = cycles;
+    stats.buckets[31 - __builtin_clz(cycles | 1)]++;
+}
+
+/**
+ * \brief Add a parse to the table of a PGN
+ *
+ * The table uses open addressing with linear probing on the low PGN bits.
+ * Entries are never removed before reset(), so a probe ends at the PGN or
+ * at the first unused slot.
+ *
+ * \param pgn PGN
+ * \param cycles Parse time
+ */
+void Zone_Profiler::recordPGN(uint32_t pgn, uint32_t cycles) {
+    uint16_t slot = pgn & (PROFILER_PGN_SLOTS - 1);
+    for(uint16_t probe = 0; probe < PROFILER_PGN_SLOTS; probe++) {
+        ProfilePGNStats& entry = pgns[slot];
+        if(entry.count == 0) {
+            if(pgnCount >= PROFILER_PGN_SLOTS) break;
+            entry.pgn = pgn;
+            pgnCount++;
+        }
+        if(entry.pgn == pgn) {
+            entry.count++;
+            entry.totalCycles += cycles;
+            if(cycles > entry.maxCycles) entry.maxCycles = cycles;
+            return;
+        }
+        slot = (slot + 1) & (PROFILER_PGN_SLOTS - 1);
+    }
+    pgnOverflow++;
+}
+
+void Zone_Profiler::reset() {
+    memset(zones, 0, sizeof(zones));
+    memset(pgns, 0, sizeof(pgns));
+    pgnCount = 0;
+    pgnOverflow = 0;
+}
+
+const char* Zone_Profiler::getZoneName(ProfileZone zone) {
+    return zone < PROFILE_ZONE_COUNT ? ZONE_NAMES[zone] : "?";
+}
+
+uint32_t Zone_Profiler::getPercentile(ProfileZone zone, float fraction) {
+    const ProfileZoneStats& stats = zones[zone];
+    if(stats.count == 0) return 0;
+
+    uint32_t target = (uint32_t)(stats.count * fraction);
+    if(target >= stats.count) target = stats.count - 1;
+
+    uint32_t seen = 0;
+    for(uint8_t bucket = 0; bucket < PROFILER_BUCKETS; bucket++) {
+        seen += stats.buckets[bucket];
+        if(seen > target) {
+            uint32_t edge = (bucket >= 31) ? 0xFFFFFFFFUL : (2UL << bucket) - 1;
+            return edge < stats.maxCycles ? edge : stats.maxCycles;
+        }
+    }
+    return stats.maxCycles;
+}
+
+const ProfilePGNStats* Zone_Profiler::getPGN(int slot) {
+    if(slot < 0 || slot >= PROFILER_PGN_SLOTS || pgns[slot].count == 0) return nullptr;
+    return &pgns[slot];
+}
+
+uint32_t Zone_Profiler::getCyclesPerMicro() {
+#if defined(ARM_DWT_CYCCNT)
+    return F_CPU_ACTUAL / 1000000;
+#else
+    return 1000;    // Host clock counts nanoseconds
+#endif
+}
+
+#endif // PROFILER_ENABLED
@@ -0,0 +1,244 @@
+/**
+ * \file Zone_Profiler.h
+ * \brief Cycle counter timing of the firmware's hot paths
+ *
+ * The scheduler statistics show how long each task took, but not where the
+ * time inside a task went: the parser, the display or the serial output.
+ * A zone is a piece of code marked with PROFILE_ZONE(). The macro reads the
+ * Cortex-M7 DWT cycle counter (CYCCNT) on entry and again when the scope
+ * ends, and the profiler adds the difference to the zone's entry of a
+ * static table: run count, total, maximum and a log2 histogram, where
+ * bucket n counts the runs that took 2^n to 2^(n+1) - 1 cycles.
+ *
+ * PROFILE_PGN() does the same for one call of the PGN parser, keyed by PGN,
+ * in a small hash table of PROFILER_PGN_SLOTS entries.
+ *
+ * Zones are timed inclusively, so a zone nested in another (the parser in
+ * the message handler) is counted in both. Only loop code is profiled; the
+ * table is not safe to update from an interrupt.
+ *
+ * With PROFILER_ENABLED set to false (constants.h) the macros are empty and
+ * the profiler itself is not built.
+ *
+ * On the host benchmark build the counter is a nanosecond clock instead.
+ */
+
+#ifndef ZONE_PROFILER_H
+#define ZONE_PROFILER_H
+
+#include <Arduino.h>
+#include "constants.h"
+
+#if PROFILER_ENABLED
+
+/**
+ * \enum ProfileZone
+ * \brief The timed code zones
+ */
+enum ProfileZone : uint8_t {
+    PROFILE_CAN2_DISPATCH,  ///< One CAN2 dispatch batch: frame hooks and message handlers
+    PROFILE_N2K_MESSAGE,    ///< N2K_Monitor::handleN2kMessage()
+    PROFILE_PGN_PARSE,      ///< N2K_Monitor::parsePGNData()
+    PROFILE_MENU_UPDATE,    ///< Menu_Controller::update()
+    PROFILE_SCREEN_FLUSH,   ///< Screen_Buffer::flush() to the OLED
+    PROFILE_SENSOR_UPDATE,  ///< Sensor::update() of one simulated device
+    PROFILE_CAPTURE_ENCODE, ///< Candump or GVRET encoding of one frame
+    PROFILE_USB_WRITE,      ///< Capture_Stream::flush() to the USB port
+    PROFILE_ZONE_COUNT      ///< Number of zones
+};
+
+/// Histogram buckets, one per bit of the 32-bit cycle count
+inline constexpr uint8_t PROFILER_BUCKETS = 32;
+
+/**
+ * \struct ProfileZoneStats
+ * \brief Timing of one zone
+ */
+struct ProfileZoneStats {
+    uint32_t count;                         ///< Runs
+    uint64_t totalCycles;                   ///< Sum of all run times
+    uint32_t maxCycles;                     ///< Longest run
+    uint32_t buckets[PROFILER_BUCKETS];     ///< Runs per log2 of their cycle count
+};
+
+/**
+ * \struct ProfilePGNStats
+ * \brief Parser timing of one PGN
+ */
+struct ProfilePGNStats {
+    uint32_t pgn;           ///< PGN, only valid while count > 0
+    uint32_t count;         ///< Parser calls
+    uint64_t totalCycles;   ///< Sum of all parse times
+    uint32_t maxCycles;     ///< Longest parse
+};
+
+/**
+ * \class Zone_Profiler
+ * \brief Static table of the zone timings
+ */
+class Zone_Profiler {
+private:
+    static ProfileZoneStats zones[PROFILE_ZONE_COUNT];     ///< Zone table
+    static ProfilePGNStats pgns[PROFILER_PGN_SLOTS];       ///< PGN table, open addressing
+    static uint16_t pgnCount;                              ///< Used entries in pgns
+    static uint32_t pgnOverflow;                           ///< Parses of PGNs that found the table full
+
+public:
+    /**
+     * \brief Start the cycle counter and clear the table
+     *
+     * Call once at the start of setup().
+     */
+    static void begin();
+
+    /**
+     * \brief Read the cycle counter
+     *
+     * \return Cycles, wrapping every 2^32 (7 s at 600 MHz)
+     */
+    static uint32_t now() {
+#if defined(ARM_DWT_CYCCNT)
+        return ARM_DWT_CYCCNT;
+#else
+        return hostNanos();
+#endif
+    }
+
+#if !defined(ARM_DWT_CYCCNT)
+    /**
+     * \brief Host stand-in for the cycle counter
+     *
+     * \return Nanoseconds of a monotonic clock
+     */
+    static uint32_t hostNanos();
+#endif
+
+    /**
+     * \brief Add a run to a zone
+     *
+     * \param zone Zone
+     * \param cycles Run time
+     */
+    static void record(ProfileZone zone, uint32_t cycles);
+
+    /**
+     * \brief Add a parse to the table of a PGN
+     *
+     * \param pgn PGN
+     * \param cycles Parse time
+     */
+    static void recordPGN(uint32_t pgn, uint32_t cycles);
+
+    /**
+     * \brief Clear every zone and PGN entry
+     */
+    static void reset();
+
+    /**
+     * \brief Get the timing of a zone
+     *
+     * \param zone Zone
+     * \return Statistics
+     */
+    static const ProfileZoneStats& getZone(ProfileZone zone) { return zones[zone]; }
+
+    /**
+     * \brief Get the short name of a zone
+     *
+     * \param zone Zone
+     * \return Name, at most 7 characters
+     */
+    static const char* getZoneName(ProfileZone zone);
+
+    /**
+     * \brief Estimate a percentile of a zone's run times
+     *
+     * \param zone Zone
+     * \param fraction Share of runs, e.g. 0.99
+     * \return Upper edge of the histogram bucket holding the percentile,
+     *         capped at the maximum; 0 if the zone never ran
+     */
+    static uint32_t getPercentile(ProfileZone zone, float fraction);
+
+    /**
+     * \brief Get an entry of the PGN table
+     *
+     * \param slot Slot index (0 to PROFILER_PGN_SLOTS-1)
+     * \return Entry, or nullptr if the slot is unused
+     */
+    static const ProfilePGNStats* getPGN(int slot);
+
+    /**
+     * \brief Get the number of parses not timed per PGN because the table was full
+     *
+     * \return Parses
+     */
+    static uint32_t getPGNOverflow() { return pgnOverflow; }
+
+    /**
+     * \brief Get the counter rate
+     *
+     * \return Cycles per microsecond
+     */
+    static uint32_t getCyclesPerMicro();
+
+    /**
+     * \brief Convert cycles to microseconds
+     *
+     * \param cycles Cycle count
+     * \return Microseconds
+     */
+    static uint32_t toMicros(uint64_t cycles) { return (uint32_t)(cycles / getCyclesPerMicro()); }
+};
+
+/**
+ * \class Profile_Scope
+ * \brief Times a zone from construction to the end of the scope
+ */
+class Profile_Scope {
+private:
+    uint32_t start;         ///< Cycle counter at construction
+    ProfileZone zone;       ///< Zone the time is added to
+
+public:
+    explicit Profile_Scope(ProfileZone z) : start(Zone_Profiler::now()), zone(z) {}
+    ~Profile_Scope() { Zone_Profiler::record(zone, Zone_Profiler::now() - start); }
+};
+
+/**
+ * \class Profile_PGNScope
+ * \brief Times one parse of a PGN to the end of the scope
+ */
+class Profile_PGNScope {
+private:
+    uint32_t start;         ///< Cycle counter at construction
+    uint32_t pgn;           ///< PGN the time is added to
+
+public:
+    explicit Profile_PGNScope(uint32_t p) : start(Zone_Profiler::now()), pgn(p) {}
+    ~Profile_PGNScope() { Zone_Profiler::recordPGN(pgn, Zone_Profiler::now() - start); }
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+/**
+ * \def PROFILE_ZONE
+ * \brief Time the rest of the enclosing scope as a zone
+ */
+#define PROFILE_ZONE(zone) Profile_Scope PROFILE_CONCAT(profileScope, __LINE__)(zone)
+
+/**
+ * \def PROFILE_PGN
+ * \brief Time the rest of the enclosing scope as one parse of a PGN
+ */
+#define PROFILE_PGN(pgn) Profile_PGNScope PROFILE_CONCAT(profilePGNScope, __LINE__)(pgn)
+
+#else
+
+#define PROFILE_ZONE(zone)
+#define PROFILE_PGN(pgn)
+
+#endif // PROFILER_ENABLED
+
+#endif // ZONE_PROFILER_H
@@ -25,19 +25,59 @@
 #include <Menu_Controller.h>
 #include <Splash_Screen.h>
 #include <Sensor.h>
+#include <Device_Pool.h>
+#include <TX_Scheduler.h>
+#include <Analog_Sampler.h>
+#include <Task_Scheduler.h>
+#include <Screen_Buffer.h>
+#include <CAN_Capture.h>
+#include <Capture_Stream.h>
+#include <CAN_Filter.h>
+#include <Serial_Console.h>
+#include <N2K_Logger.h>
+#include <N2K_Replay.h>
+#include <Zone_Profiler.h>
+#include <Snapshot_Server.h>
+#include <Config_Store.h>
+#include <Memory_Budget.h>
+
+
+
+//Primary CAN interface for transmitting simulated sensor data.
+//Reports every frame it sends so the logger can record NEMO's own traffic.
+CAN_TxTap NMEA2000_CAN1(tNMEA2000_Teensyx::CAN1);
 
+// Secondary CAN interface for listening to NMEA2000 traffic.
+// Frames are collected and decoded by interrupts, so loop stalls don't drop them.
+CAN_Capture NMEA2000_CAN2(tNMEA2000_Teensyx::CAN2);
 
+// Raw frame capture output over USB. Starts as candump text unless debug
+// output is using the serial port; SavvyCAN switches it to GVRET on connect.
+Capture_Stream captureStream(&Serial, DEBUG ? CAPTURE_MODE_OFF : CAPTURE_MODE_CANDUMP);
 
-//Primary CAN interface for transmitting simulated sensor data
-tNMEA2000_Teensyx NMEA2000_CAN1(tNMEA2000_Teensyx::CAN1);
+// Source address and PGN filter sets applied to CAN2 by the capture interrupt
+CAN_Filter can2Filter;
 
-// Secondary CAN interface for listening to NMEA2000 traffic.
-tNMEA2000_Teensyx NMEA2000_CAN2(tNMEA2000_Teensyx::CAN2);
+// Text commands typed into the USB serial port (outside GVRET mode)
+Serial_Console console(&captureStream);
+
+// Binary snapshot requests from host dashboards on the second USB serial
+// port, answered from the CAN2 monitor
+Snapshot_Server snapshotServer(&SerialUSB1);
+
+// On-device binary frame log (SD card, or program flash as a fallback)
+N2K_Logger frameLogger;
+
+// Timed playback of recorded logs into the CAN2 monitor or onto CAN1
+N2K_Replay frameReplay(&NMEA2000_CAN2, &NMEA2000_CAN1, &frameLogger);
+
+// Background ADC sampling of the sensor potentiometers
+Analog_Sampler analogSampler;
 
+// Runs all periodic work of the loop by deadline and priority
+Task_Scheduler scheduler;
 
 
-//Interval in milliseconds between sensor updates.
-#define UPDATE_INTERVAL 1000
 
 //NMEA2000 manufacturer code for simulated devices.
 #define DEVICE_MANUFACTURER_CODE 2046
@@ -45,12 +85,6 @@ tNMEA2000_Teensyx NMEA2000_CAN2(tNMEA2000_Teensyx::CAN2);
 //NMEA2000 device class for simulated devices.
 #define DEVICE_CLASS 25
 
-//Number of simulated devices on the NMEA2000 bus.
-#define NUM_DEVICES 3
-
-//Sequence counter for fast-packet frame fragmentation.
-static uint8_t fastPacketSequence = 0;
-
 
 //Timestamps of last button press for each button.
 unsigned long lastButtonPress[4] = {0, 0, 0, 0};
@@ -58,26 +92,38 @@ unsigned long lastButtonPress[4] = {0, 0, 0, 0};
 //Debounce delay in milliseconds.
 unsigned long debounceDelay = 250;
 
-//Timestamp of last sensor update.
-unsigned long lastUpdateTime = 0;
-
 //Text-mode display driver for menu system.
 U8X8_SH1106_128X64_NONAME_HW_I2C u8x8(/* reset=*/ U8X8_PIN_NONE);
 
+//Back buffer the menus draw into; only changed cells are sent to u8x8.
+Screen_Buffer screenBuffer(&u8x8);
+
 // Graphics-mode display driver for splash screen.
 U8G2_SH1106_128X64_NONAME_F_HW_I2C u8g2(U8G2_R0, /* reset=*/ U8X8_PIN_NONE);
 
-//Simulated Engine RPM sensor (Device 0).
-Sensor sensor1(SENSOR_PIN_1, MSG_ENGINE_RPM, &NMEA2000_CAN1, 0);
+// Boot animation, stepped by the scheduler while capture is already running
+Splash_Screen splash(&u8g2);
+
+// Set once the splash has handed the display over to the menu
+bool menuStarted = false;
+
+// micros() when the main menu was first shown
+uint32_t menuStartTime = 0;
 
-//Simulated Water Depth sensor (Device 1).
-Sensor sensor2(SENSOR_PIN_2, MSG_WATER_DEPTH, &NMEA2000_CAN1, 1);
+//Sends the simulated device and impersonation messages on CAN1 from a timer.
+TX_Scheduler txScheduler(&NMEA2000_CAN1);
 
-//Simulated Heading sensor (Device 2).
-Sensor sensor3(SENSOR_PIN_3, MSG_HEADING, &NMEA2000_CAN1, 2);
+//Simulated devices on CAN1. Devices 0-2 are the Engine RPM, Water Depth
+//and Heading sensors configured from the menu.
+Device_Pool devicePool(&NMEA2000_CAN1, &txScheduler);
 
+//Menu sensor settings and the stale cleanup toggle, kept in EEPROM.
+Config_Store configStore(&devicePool);
 
-//NMEA2000 network monitor instance
+
+//NMEA2000 network monitor instance. At about 125 KB it is the largest
+//object in the firmware, so it goes on the heap in RAM2, not into the DTCM
+//that globals, the stack and ITCM code share.
 N2K_Monitor* n2kMonitor;
 
 //Attack demonstration controller instance.
@@ -86,6 +132,13 @@ Attack_Controller* attackController;
 //Menu system controller instance.
 Menu_Controller* menuController;
 
+//Heap the NMEA2000 library took for its buffers and device tables while the
+//CAN interfaces were opened.
+uint32_t canLibraryHeapBytes = 0;
+
+//Heap the menu controller and its menus took.
+uint32_t displayHeapBytes = 0;
+
 
 /**
  * \brief Handles incoming NMEA2000 messages from CAN2 interface.
@@ -101,18 +154,16 @@ void setupNMEA2000();
 
 
 /**
- * \brief Prints a single CAN frame in candump format to Serial.
- * \param canId The 29-bit extended CAN identifier.
- * \param len The number of data bytes in the frame (0-8).
- * \param data Pointer to the array of data bytes.
+ * \brief Passes every raw CAN2 frame to the capture stream, logger and bus statistics.
+ * \param frame The frame exactly as received on the bus.
  */
-void PrintCanFrame(uint32_t canId, uint8_t len, const uint8_t *data);
+void HandleCaptureFrame(const CaptureFrame &frame);
 
 /**
- * \brief Prints an NMEA2000 message in candump format, handling fast-packet fragmentation.
- * \param N2kMsg Reference to the NMEA2000 message to print.
+ * \brief Passes every frame transmitted on CAN1 to the logger.
+ * \param frame The frame as accepted by the CAN1 driver.
  */
-void PrintCandumpFormat(const tN2kMsg &N2kMsg);
+void HandleTransmitFrame(const CaptureFrame &frame);
 
 /**
  * \brief Maps a button pin to its debounce array index.
@@ -128,73 +179,349 @@ int getButtonIndex(int button);
  */
 short buttonPressed(int button);
 
+/**
+ * \brief Registers the periodic work of the loop with the scheduler.
+ */
+void setupTasks();
+
+/**
+ * \brief Registers the serial console commands.
+ */
+void setupConsole();
+
+/**
+ * \brief Registers the memory probes of the subsystems.
+ */
+void setupMemoryBudget();
+
+/**
+ * \brief Memory probe: monitor tables, payload pool and snapshot server.
+ * \param usage Usage to add to.
+ */
+void probeMonitorMemory(MemoryUsage &usage);
+
+/**
+ * \brief Memory probe: CAN interfaces, their rings and queues, and the library buffers.
+ * \param usage Usage to add to.
+ */
+void probeCANMemory(MemoryUsage &usage);
+
+/**
+ * \brief Memory probe: display drivers, screen buffer and menus.
+ * \param usage Usage to add to.
+ */
+void probeDisplayMemory(MemoryUsage &usage);
+
+/**
+ * \brief Memory probe: frame logger, replay ring and capture stream.
+ * \param usage Usage to add to.
+ */
+void probeLoggerMemory(MemoryUsage &usage);
+
+/**
+ * \brief Memory probe: attack controller and the simulated devices.
+ * \param usage Usage to add to.
+ */
+void probeAttackMemory(MemoryUsage &usage);
+
+/**
+ * \brief Passes host text from the capture stream to the console.
+ * \param c The received byte.
+ */
+void HandleHostText(uint8_t c);
+
+/**
+ * \brief Ends the splash and shows the main menu on the text-mode display.
+ */
+void startMenu();
+
+/**
+ * \brief Console command: shows how long boot took to reach capture and the menu.
+ * \param output The console to reply to.
+ * \param argc Number of words on the command line.
+ * \param argv The words of the command line.
+ */
+void commandBoot(Serial_Console &output, int argc, char* argv[]);
+
+/**
+ * \brief Console command: shows the run-time statistics of the scheduler tasks.
+ * \param output The console to reply to.
+ * \param argc Number of words on the command line.
+ * \param argv The words of the command line.
+ */
+void commandTasks(Serial_Console &output, int argc, char* argv[]);
+
+/**
+ * \brief Console command: shows and configures the simulated devices.
+ * \param output The console to reply to.
+ * \param argc Number of words on the command line.
+ * \param argv The words of the command line.
+ */
+void commandDevices(Serial_Console &output, int argc, char* argv[]);
+
+/**
+ * \brief Console command: shows the CAN1 transmit scheduler counters.
+ * \param output The console to reply to.
+ * \param argc Number of words on the command line.
+ * \param argv The words of the command line.
+ */
+void commandTransmit(Serial_Console &output, int argc, char* argv[]);
+
+/**
+ * \brief Console command: shows the CAN2 multi-frame transfer diagnostics.
+ * \param output The console to reply to.
+ * \param argc Number of words on the command line.
+ * \param argv The words of the command line.
+ */
+void commandTransfers(Serial_Console &output, int argc, char* argv[]);
+
+/**
+ * \brief Console command: lists the ISO NAMEs seen in address claims.
+ * \param output The console to reply to.
+ * \param argc Number of words on the command line.
+ * \param argv The words of the command line.
+ */
+void commandNames(Serial_Console &output, int argc, char* argv[]);
+
+/**
+ * \brief Console command: shows the queue depths and stage latencies of the CAN2 receive path.
+ * \param output The console to reply to.
+ * \param argc Number of words on the command line.
+ * \param argv The words of the command line.
+ */
+void commandCapture(Serial_Console &output, int argc, char* argv[]);
+
+/**
+ * \brief Console command: lists the alerts of the monitor's anomaly detector.
+ * \param output The console to reply to.
+ * \param argc Number of words on the command line.
+ * \param argv The words of the command line.
+ */
+void commandAlerts(Serial_Console &output, int argc, char* argv[]);
+
+/**
+ * \brief Console command: shows and edits the CAN2 filter sets.
+ * \param output The console to reply to.
+ * \param argc Number of words on the command line.
+ * \param argv The words of the command line.
+ */
+void commandFilter(Serial_Console &output, int argc, char* argv[]);
+
+/**
+ * \brief Console command: shows, saves or erases the EEPROM configuration.
+ * \param output The console to reply to.
+ * \param argc Number of words on the command line.
+ * \param argv The words of the command line.
+ */
+void commandConfig(Serial_Console &output, int argc, char* argv[]);
+
+/**
+ * \brief Console command: shows the memory of each subsystem and RAM region.
+ * \param output The console to reply to.
+ * \param argc Number of words on the command line.
+ * \param argv The words of the command line.
+ */
+void commandMemory(Serial_Console &output, int argc, char* argv[]);
+
+#if PROFILER_ENABLED
+/**
+ * \brief Console command: shows the cycle counter timings of the code zones.
+ * \param output The console to reply to.
+ * \param argc Number of words on the command line.
+ * \param argv The words of the command line.
+ */
+void commandProfile(Serial_Console &output, int argc, char* argv[]);
+#endif
+
+/**
+ * \brief Scheduler task: hands a batch of decoded CAN2 frames and messages to their handlers.
+ */
+void taskDispatchCAN2();
+
+/**
+ * \brief Scheduler task: logs scheduled CAN1 frames and parses CAN1 traffic unless an attack is running.
+ */
+void taskParseCAN1();
+
+/**
+ * \brief Scheduler task: writes buffered capture output to USB.
+ */
+void taskCaptureOutput();
+
+/**
+ * \brief Scheduler task: writes full logger buffers to storage.
+ */
+void taskLogger();
+
+/**
+ * \brief Scheduler task: answers snapshot requests and pushes subscribed PGNs.
+ */
+void taskSnapshotServer();
+
+/**
+ * \brief Scheduler task: saves configuration changes once they settled.
+ */
+void taskConfigStore();
+
+/**
+ * \brief Scheduler task: reads the log being replayed ahead of its timer.
+ */
+void taskReplay();
+
+/**
+ * \brief Scheduler task: advances the boot splash and starts the menu when it ends.
+ */
+void taskSplash();
+
+/**
+ * \brief Scheduler task: processes button presses.
+ */
+void taskButtons();
+
+/**
+ * \brief Scheduler task: refreshes the values of the simulated devices.
+ */
+void taskSensorRefresh();
+
+/**
+ * \brief Scheduler task: stages the simulated device messages that are due next.
+ */
+void taskSensorSend();
+
+/**
+ * \brief Scheduler task: sends or stages attack traffic.
+ */
+void taskAttack();
+
+/**
+ * \brief Scheduler task: publishes the bus statistics.
+ */
+void taskMonitorStats();
+
+/**
+ * \brief Scheduler task: removes stale devices when enabled.
+ */
+void taskStaleCleanup();
+
+/**
+ * \brief Scheduler task: samples the memory budget for its peaks.
+ */
+void taskMemoryBudget();
+
+/**
+ * \brief Scheduler task: refreshes the display.
+ */
+void taskDisplay();
+
+/**
+ * \brief Scheduler task: sends changed screen cells to the display.
+ */
+void taskScreenFlush();
+
+
 
 
 /**
  * \brief Arduino setup function - initializes all hardware and software components.
  *
- * This function is called once at startup and performs complete system
- * initialization:
+ * This function is called once at startup. It is ordered so that CAN2
+ * capture runs as early as possible, because the address claims sent at
+ * power-on are some of the most interesting traffic on the bus:
  *
  * Hardware initialization:
+ * - Stack painting for the memory budget, before the stack gets deep
  * - Serial communication at 115200 baud
- * - Sensor input pins (analog)
+ * - Sensor input pins (analog) and the background sampler
  * - Button input pins with internal pull-up resistors
  *
+ * Capture initialization:
+ * - N2K_Monitor and Attack_Controller, which the CAN2 handlers use
+ * - CAN2 interface for listening/monitoring
+ *
  * NMEA2000 initialization:
  * - CAN1 interface for sensor transmission (via setupNMEA2000())
- * - CAN2 interface for listening/monitoring
  *
- * Display initialization:
- * - Splash screen animation on startup
- * - OLED display for menu system
+ * Display and UI initialization:
+ * - Frame logger storage
+ * - Splash screen animation, run by the scheduler
+ * - Menu_Controller, whose menus are built once the splash ends
+ * - Task_Scheduler with all periodic loop work
+ * - Memory probes of the subsystems
  *
- * Controller initialization:
- * - N2K_Monitor for NMEA2000 traffic analysis
- * - Attack_Controller for educational demonstrations
- * - Menu_Controller for user interface
+ * Captured frames wait in the capture ring until the loop starts parsing
+ * them, so nothing done after CAN2 is opened loses traffic as long as it is
+ * short compared to the ring.
  */
 void setup(void)
 {
+  Memory_Budget::begin();
+
   Serial.begin(115200);
 
+#if PROFILER_ENABLED
+  Zone_Profiler::begin();
+#endif
+
   pinMode(SENSOR_PIN_1, INPUT);
   pinMode(SENSOR_PIN_2, INPUT);
   pinMode(SENSOR_PIN_3, INPUT);
 
+  // Create the simulated devices; the potentiometers are sampled from a
+  // timer interrupt instead of the loop
+  devicePool.begin(&analogSampler);
+  analogSampler.begin();
+
   pinMode(BUTTON_UP, INPUT_PULLUP);
   pinMode(BUTTON_DOWN, INPUT_PULLUP);
   pinMode(BUTTON_LEFT, INPUT_PULLUP);
   pinMode(BUTTON_RIGHT, INPUT_PULLUP);
 
-  setupNMEA2000();
-  NMEA2000_CAN2.SetMsgHandler(HandleNMEA2000Msg);
+  // Initialize NMEA2000 Monitor and Attack Controller first, the CAN2
+  // message handler needs both as soon as frames arrive
+  n2kMonitor = new N2K_Monitor();
+  attackController = new Attack_Controller(&NMEA2000_CAN1, n2kMonitor, devicePool.getDevice(0), &txScheduler);
+  snapshotServer.setMonitor(n2kMonitor);
+  configStore.setMonitor(n2kMonitor);
+
+  // Start capturing on CAN2 before anything else can hold up boot
+  NMEA2000_CAN2.setMessageHandler(HandleNMEA2000Msg);
+  NMEA2000_CAN2.setFrameHook(HandleCaptureFrame);
+  NMEA2000_CAN2.setFilter(&can2Filter);
   NMEA2000_CAN2.SetMode(tNMEA2000::N2km_ListenOnly);
   NMEA2000_CAN2.SetN2kCANReceiveFrameBufSize(2048);
-
-  // Open both CAN interfaces
+  uint32_t heapBefore = Memory_Budget::getHeapUsed();
   NMEA2000_CAN2.Open();
 
-  // Show splash screen animation
-  Splash_Screen::show(&u8g2);
-
-  // Initialize display for menu system
-  u8x8.begin();
-  u8x8.setPowerSave(0);
+  // CAN1 after CAN2, so our own address claims are captured too
+  NMEA2000_CAN1.setFrameHook(HandleTransmitFrame);
+  setupNMEA2000();
+  canLibraryHeapBytes = Memory_Budget::getHeapUsed() - heapBefore;
+  txScheduler.begin();
 
-  // Initialize NMEA2000 Monitor
-  n2kMonitor = new N2K_Monitor();
+  // Look for an SD card (or fall back to flash) for the frame logger
+  frameLogger.begin();
 
-  // Initialize Attack Controller
-  attackController = new Attack_Controller(&NMEA2000_CAN1, n2kMonitor, &sensor1);
+  // Start the splash screen animation, taskSplash() runs it from here on
+  splash.begin();
 
-  // Initialize Menu Controller
-  menuController = new Menu_Controller(&u8x8,
+  // Initialize Menu Controller, the menus themselves are built by startMenu()
+  heapBefore = Memory_Budget::getHeapUsed();
+  menuController = new Menu_Controller(&screenBuffer,
                                       BUTTON_UP, BUTTON_DOWN,
                                       BUTTON_LEFT, BUTTON_RIGHT,
-                                      &sensor1, &sensor2, &sensor3,
+                                      devicePool.getDevice(0), devicePool.getDevice(1),
+                                      devicePool.getDevice(2),
                                       n2kMonitor, attackController);
-  menuController->begin();
+  menuController->setCaptureStream(&captureStream);
+  menuController->setLogger(&frameLogger);
+  menuController->setCanFilter(&can2Filter, &NMEA2000_CAN2);
+  menuController->setReplay(&frameReplay);
+  menuController->setGraphics(&u8g2);
+  displayHeapBytes = Memory_Budget::getHeapUsed() - heapBefore;
+
+  setupConsole();
+  setupTasks();
+  setupMemoryBudget();
 
 #if DEBUG
   Serial.println("System initialized");
@@ -204,81 +531,786 @@ void setup(void)
 /**
  * \brief Arduino main loop - executes continuously after setup().
  *
- * This function implements the main program loop with the following
- * responsibilities:
+ * All work is done by scheduler tasks registered in setupTasks(). Each
+ * pass runs every due high priority task and at most one lower priority
+ * task, so CAN parsing never waits behind more than one display refresh.
+ */
+void loop(void)
+{
+  scheduler.run();
+}
+
+/**
+ * \brief Registers the periodic work of the loop with the scheduler.
  *
- * Sensor updates (every UPDATE_INTERVAL milliseconds):
- * - Normal operation: Update and transmit all sensor values
- * - Own-sensor impersonation: Continue normal transmissions alongside attack
- * - External attack: Only update sensor1 for potentiometer control
+ * High priority (every pass):
+ * - Dispatch decoded CAN2 frames and messages, parse CAN1 traffic
+ * - Write buffered capture output to USB
  *
- * CAN bus processing:
- * - Parse CAN1 messages (skipped during active attacks)
- * - Parse CAN2 messages for monitoring
+ * Normal priority:
+ * - Logger storage writes, snapshot requests, button input, sensor refresh,
+ *   staging of sensor and impersonation messages for the transmit scheduler,
+ *   attack traffic
  *
- * User interface:
- * - Update menu controller for real-time displays
- * - Process button inputs for navigation
+ * Low priority:
+ * - Bus statistics, stale cleanup, configuration saves, memory budget
+ *   samples, boot splash, display refresh and screen flush
+ */
+void setupTasks() {
+  scheduler.addTask("CAN2", taskDispatchCAN2, 0, TASK_PRIORITY_HIGH);
+  scheduler.addTask("CAN1", taskParseCAN1, 0, TASK_PRIORITY_HIGH);
+  scheduler.addTask("USB", taskCaptureOutput, 0, TASK_PRIORITY_HIGH);
+
+  scheduler.addTask("Logger", taskLogger, LOGGER_SERVICE_INTERVAL_MS, TASK_PRIORITY_NORMAL);
+  scheduler.addTask("Snapshot", taskSnapshotServer, SNAPSHOT_SERVICE_INTERVAL_MS, TASK_PRIORITY_NORMAL);
+  scheduler.addTask("Replay", taskReplay, REPLAY_SERVICE_INTERVAL_MS, TASK_PRIORITY_NORMAL);
+  scheduler.addTask("Buttons", taskButtons, BUTTON_POLL_INTERVAL_MS, TASK_PRIORITY_NORMAL);
+  scheduler.addTask("Pots", taskSensorRefresh, SENSOR_REFRESH_INTERVAL_MS, TASK_PRIORITY_NORMAL);
+  scheduler.addTask("Sensors", taskSensorSend, TX_STAGE_INTERVAL_MS, TASK_PRIORITY_NORMAL);
+  scheduler.addTask("Attack", taskAttack, TX_STAGE_INTERVAL_MS, TASK_PRIORITY_NORMAL);
+
+  scheduler.addTask("Stats", taskMonitorStats, MONITOR_STATS_INTERVAL_MS, TASK_PRIORITY_LOW);
+  scheduler.addTask("Cleanup", taskStaleCleanup, MONITOR_CLEANUP_INTERVAL_MS, TASK_PRIORITY_LOW);
+  scheduler.addTask("Config", taskConfigStore, CONFIG_SERVICE_INTERVAL_MS, TASK_PRIORITY_LOW);
+  scheduler.addTask("Memory", taskMemoryBudget, MEMORY_SAMPLE_INTERVAL_MS, TASK_PRIORITY_LOW);
+  scheduler.addTask("Splash", taskSplash, SPLASH_INTERVAL_MS, TASK_PRIORITY_LOW);
+  scheduler.addTask("Display", taskDisplay, MENU_UPDATE_INTERVAL_MS, TASK_PRIORITY_LOW);
+  scheduler.addTask("Flush", taskScreenFlush, SCREEN_FLUSH_INTERVAL_MS, TASK_PRIORITY_LOW);
+}
+
+void setupConsole() {
+  console.addCommand("boot", "time from power-on to capture, first frame and menu", commandBoot);
+  console.addCommand("tasks", "scheduler task runs, overruns, run times, latency and load [reset]", commandTasks);
+  console.addCommand("dev", "simulated devices: [N|N-M|all on|off|ms N|src S [ms]|type N|name S] [reset]", commandDevices);
+  console.addCommand("tx", "CAN1 transmit scheduler counters [reset]", commandTransmit);
+  console.addCommand("cap", "CAN2 receive path: queue depths and stage latencies [reset]", commandCapture);
+  console.addCommand("fp", "CAN2 fast-packet and ISO transport reassembly [reset]", commandTransfers);
+  console.addCommand("names", "ISO NAMEs from address claims and the address each holds", commandNames);
+  console.addCommand("alerts", "claim storms, conflicting sources, timing and value anomalies [reset]", commandAlerts);
+  console.addCommand("filter", "CAN2 filters: [src|pgn off|allow|deny|add N|del N] [clear]", commandFilter);
+  console.addCommand("config", "EEPROM configuration of the menu sensors [save|erase]", commandConfig);
+  console.addCommand("mem", "RAM per subsystem and region, heap free and largest block [reset]", commandMemory);
+#if PROFILER_ENABLED
+  console.addCommand("prof", "cycle counter timings of the code zones [reset]", commandProfile);
+#endif
+  captureStream.setTextHook(HandleHostText);
+}
+
+void setupMemoryBudget() {
+  Memory_Budget::setProbe(MEMORY_MONITOR, probeMonitorMemory);
+  Memory_Budget::setProbe(MEMORY_CAN, probeCANMemory);
+  Memory_Budget::setProbe(MEMORY_DISPLAY, probeDisplayMemory);
+  Memory_Budget::setProbe(MEMORY_LOGGER, probeLoggerMemory);
+  Memory_Budget::setProbe(MEMORY_ATTACK, probeAttackMemory);
+  Memory_Budget::sample();
+}
+
+/// Frame storage of one CAN_FrameRing
+static constexpr uint32_t RING_FRAME_BYTES = CAPTURE_RING_SIZE * sizeof(CaptureFrame);
+
+/**
+ * \brief Adds the frame storage of a ring as a buffer.
+ * \param usage Usage to add to.
+ * \param ring Ring; its indices are counted with the object holding it.
+ */
+static void addFrameRing(MemoryUsage &usage, const CAN_FrameRing &ring) {
+  usage.addBuffer(RING_FRAME_BYTES, ring.available() * sizeof(CaptureFrame),
+                  ring.getHighWater() * sizeof(CaptureFrame));
+}
+
+void probeMonitorMemory(MemoryUsage &usage) {
+  usage.addBuffer(n2kMonitor->getReservedBytes(), n2kMonitor->getUsedBytes(), 0);
+  usage.addFixed(sizeof(snapshotServer));
+}
+
+void probeCANMemory(MemoryUsage &usage) {
+  usage.addFixed(sizeof(NMEA2000_CAN2) - 2 * RING_FRAME_BYTES - CAPTURE_MESSAGE_QUEUE_SIZE);
+  addFrameRing(usage, NMEA2000_CAN2.getRing());
+  addFrameRing(usage, NMEA2000_CAN2.getDecodedFrames());
+  CAN_MessageQueue &messages = NMEA2000_CAN2.getMessages();
+  usage.addBuffer(CAPTURE_MESSAGE_QUEUE_SIZE, messages.getUsedBytes(), messages.getHighWater());
+
+  uint32_t frameBytes = TX_Scheduler::getQueuedFrameBytes();
+  usage.addFixed(sizeof(txScheduler) - RING_FRAME_BYTES - TX_QUEUE_SIZE * frameBytes);
+  addFrameRing(usage, txScheduler.getSentRing());
+  usage.addBuffer(TX_QUEUE_SIZE * frameBytes, txScheduler.getQueueDepth() * frameBytes,
+                  txScheduler.getQueueHighWater() * frameBytes);
+
+  // The filter's PGN bitset lives in DMAMEM
+  usage.addFixed(sizeof(NMEA2000_CAN1) + sizeof(can2Filter) + (CAN_FILTER_MAX_PGN + 1) / 8);
+  usage.addFixed(canLibraryHeapBytes);
+}
+
+void probeDisplayMemory(MemoryUsage &usage) {
+  // The full frame buffer of the graphics driver is a static array of its own
+  uint32_t frameBuffer = (uint32_t)u8g2.getBufferTileWidth() * u8g2.getBufferTileHeight() * 8;
+  usage.addFixed(sizeof(u8x8) + sizeof(u8g2) + frameBuffer + sizeof(screenBuffer) + sizeof(splash));
+  usage.addFixed(displayHeapBytes);
+}
+
+void probeLoggerMemory(MemoryUsage &usage) {
+  uint32_t logged = frameLogger.getBufferedBytes();
+  usage.addFixed(sizeof(frameLogger));
+  usage.addBuffer(2 * LOGGER_BUFFER_SIZE, logged, logged);
+
+  // The replay ring is a DMAMEM object of its own, not part of frameReplay
+  usage.addFixed(sizeof(frameReplay) + sizeof(CAN_FrameRing) - RING_FRAME_BYTES);
+  addFrameRing(usage, frameReplay.getRing());
+
+  uint32_t streamed = captureStream.getBufferedBytes();
+  usage.addFixed(sizeof(captureStream));
+  usage.addBuffer(CAPTURE_STREAM_BUFFER_SIZE, streamed, streamed);
+}
+
+void probeAttackMemory(MemoryUsage &usage) {
+  usage.addBuffer(attackController->getReservedBytes(), attackController->getUsedBytes(), 0);
+  usage.addFixed(sizeof(devicePool) + devicePool.getCount() * sizeof(Sensor));
+}
+
+void HandleHostText(uint8_t c) {
+  console.handleByte(c);
+}
+
+/**
+ * All times are micros() since reset. micros() starts counting before
+ * setup() runs, so this is the time from power-on minus the bootloader.
+ */
+void commandBoot(Serial_Console &output, int argc, char* argv[]) {
+  uint32_t openTime = NMEA2000_CAN2.getOpenTime();
+  output.printf("capture start %8lu us\r\n", (unsigned long)openTime);
+
+  if (NMEA2000_CAN2.hasFirstFrame()) {
+    uint32_t firstFrame = NMEA2000_CAN2.getFirstFrameTime();
+    output.printf("first frame   %8lu us (+%lu us after start)\r\n",
+                  (unsigned long)firstFrame, (unsigned long)(firstFrame - openTime));
+  } else {
+    output.printf("first frame   none yet\r\n");
+  }
+
+  if (menuStarted) {
+    output.printf("menu shown    %8lu us\r\n", (unsigned long)menuStartTime);
+  } else {
+    output.printf("menu shown    splash running\r\n");
+  }
+}
+
+/**
+ * Usage:
+ * - tasks        one line per task: priority, runs, overruns, average and
+ *                longest run, worst start latency and share of the CPU
+ * - tasks reset  clear the statistics
  *
- * Button actions:
- * - UP: Navigate up in menu
- * - DOWN: Navigate down in menu
- * - LEFT: Navigate back/cancel
- * - RIGHT: Select/enter
+ * Priority 0 is high, 2 low. Load is measured since the last reset.
  */
+void commandTasks(Serial_Console &output, int argc, char* argv[]) {
+  if (argc == 2 && strcmp(argv[1], "reset") == 0) {
+    scheduler.resetStats();
+    output.printf("task statistics cleared\r\n");
+    return;
+  } else if (argc != 1) {
+    output.printf("usage: tasks [reset]\r\n");
+    return;
+  }
 
-void loop(void)
-{
-  unsigned long currentTime = millis();
-
-  // Update sensors at regular intervals
-  if (currentTime - lastUpdateTime >= UPDATE_INTERVAL) {
-    lastUpdateTime = currentTime;
-
-    bool attackActive = attackController->isAttackActive();
-    bool impersonatingOwn = attackController->isImpersonatingOwnSensor();
-
-    if (!attackActive) {
-      // Normal operation - update and send all sensors
-      sensor1.update();
-      sensor2.update();
-      sensor3.update();
-
-      // Send NMEA messages
-      sensor1.sendMessage();
-      sensor2.sendMessage();
-      sensor3.sendMessage();
-
-    } else if (impersonatingOwn) {
-      // Impersonating own sensor - continue real transmissions for all sensors
-      // This creates both real data (from sensors) and spoofed data (from attack)
-      // User can see effect in Live Data with interleaved real/spoofed values
-      sensor1.update();
-      sensor2.update();
-      sensor3.update();
-
-      // Send messages from all sensors so Live Data shows real values
-      sensor1.sendMessage();
-      sensor2.sendMessage();
-      sensor3.sendMessage();
+  output.printf("task       pri     runs  ovr   avg_us   max_us   lat_us   load%%\r\n");
+  for (int i = 0; i < scheduler.getTaskCount(); i++) {
+    const SchedulerTask* task = scheduler.getTask(i);
+    uint32_t average = task->runCount ? (uint32_t)(task->totalRunMicros / task->runCount) : 0;
+    output.printf("%-10s %3u %8lu %4lu %8lu %8lu %8lu %7.2f\r\n",
+                  task->name, (unsigned)task->priority,
+                  (unsigned long)task->runCount, (unsigned long)task->overrunCount,
+                  (unsigned long)average, (unsigned long)task->maxRunMicros,
+                  (unsigned long)task->maxLatencyMicros, scheduler.getLoadPercent(i));
+  }
+}
+
+/**
+ * \brief Parse a device selection: "all", an index or an index range
+ * \param text The word to parse.
+ * \param[out] first First selected device.
+ * \param[out] last Last selected device.
+ * \return false if the text is not a valid selection.
+ */
+static bool parseDeviceRange(const char* text, uint8_t &first, uint8_t &last) {
+  uint8_t count = devicePool.getCount();
+  if (strcmp(text, "all") == 0) {
+    first = 0;
+    last = count - 1;
+    return count > 0;
+  }
+
+  char* end;
+  unsigned long from = strtoul(text, &end, 10);
+  unsigned long to = from;
+  if (*end == '-') to = strtoul(end + 1, &end, 10);
+  if (*end != '\0' || from > to || to >= count) return false;
+  first = from;
+  last = to;
+  return true;
+}
+
+/**
+ * Usage:
+ * - dev                          table of all active devices
+ * - dev all                      table of every device
+ * - dev <sel> on|off             switch devices on or off
+ * - dev <sel> ms <n>             transmit every n ms
+ * - dev <sel> src <s> [ms]       value source pot|ramp|sine|trace, optional period
+ * - dev <sel> type <n>           message type (index into the sensor table)
+ * - dev <sel> name <text>        custom Model ID, "-" for the default of the type
+ * - dev reset                    clear the counters
+ *
+ * <sel> is "all", an index ("5") or a range ("3-31").
+ */
+void commandDevices(Serial_Console &output, int argc, char* argv[]) {
+  static const char* const SOURCE_NAMES[SOURCE_COUNT] = {"pot", "ramp", "sine", "trace"};
+  bool showAll = false;
+
+  if (argc == 2 && strcmp(argv[1], "reset") == 0) {
+    devicePool.resetStats();
+  } else if (argc == 2 && strcmp(argv[1], "all") == 0) {
+    showAll = true;
+  } else if (argc >= 3) {
+    uint8_t first, last;
+    if (!parseDeviceRange(argv[1], first, last)) {
+      output.printf("dev: bad device '%s'\r\n", argv[1]);
+      return;
+    }
+
+    const char* action = argv[2];
+    char* end = nullptr;
+    unsigned long value = argc >= 4 ? strtoul(argv[3], &end, 10) : 0;
+    bool valueOk = argc >= 4 && *end == '\0';
 
+    if (strcmp(action, "on") == 0 || strcmp(action, "off") == 0) {
+      bool on = action[1] == 'n';
+      for (uint8_t i = first; i <= last; i++) {
+        Sensor* device = devicePool.getDevice(i);
+        if (device->isActive() != on) device->setActive(on);
+      }
+    } else if (strcmp(action, "ms") == 0 && valueOk) {
+      for (uint8_t i = first; i <= last; i++) devicePool.setInterval(i, value);
+    } else if (strcmp(action, "type") == 0 && valueOk && value < (unsigned long)SENSOR_COUNT) {
+      for (uint8_t i = first; i <= last; i++) {
+        Sensor* device = devicePool.getDevice(i);
+        device->setMessageType((MessageType)value);
+        device->updateDeviceInfo();
+      }
+    } else if (strcmp(action, "name") == 0 && argc == 4) {
+      const char* name = strcmp(argv[3], "-") == 0 ? "" : argv[3];
+      for (uint8_t i = first; i <= last; i++) devicePool.getDevice(i)->setCustomName(name);
+    } else if (strcmp(action, "src") == 0 && argc >= 4) {
+      int source = 0;
+      while (source < SOURCE_COUNT && strcmp(argv[3], SOURCE_NAMES[source]) != 0) source++;
+      unsigned long period = argc >= 5 ? strtoul(argv[4], &end, 10) : 0;
+      if (source == SOURCE_COUNT || (argc >= 5 && *end != '\0')) {
+        output.printf("dev: bad source '%s'\r\n", argv[3]);
+        return;
+      }
+      for (uint8_t i = first; i <= last; i++) {
+        devicePool.getDevice(i)->setValueSource((ValueSource)source, period);
+      }
     } else {
-      // External attack (not impersonating own sensor) - only update sensor1 for potentiometer control
-      sensor1.update();
+      output.printf("dev: bad action '%s'\r\n", action);
+      return;
     }
+  } else if (argc != 1) {
+    output.printf("usage: dev [N|N-M|all on|off|ms N|src S [ms]|type N|name S] [reset]\r\n");
+    return;
+  }
+
+  // Requested and achieved rates side by side, plus what got lost
+  output.printf("dev addr type src    ms  req/s  got/s     sent fail miss\r\n");
+  for (uint8_t i = 0; i < devicePool.getCount(); i++) {
+    Sensor* device = devicePool.getDevice(i);
+    const TxStream* stream = devicePool.getStream(i);
+    if ((!showAll && !device->isActive()) || stream == nullptr) continue;
+    output.printf("%3u %4u %4d %-5s %5lu %6.1f %6.1f %8lu %4lu %4lu\r\n",
+                  (unsigned)i, (unsigned)NMEA2000_CAN1.GetN2kSource(i), (int)device->getMessageType(),
+                  SOURCE_NAMES[device->getValueSource()], (unsigned long)device->getSendInterval(),
+                  devicePool.getRequestedRate(i), devicePool.getAchievedRate(i),
+                  (unsigned long)stream->sent, (unsigned long)stream->failed,
+                  (unsigned long)stream->missed);
+  }
+  output.printf("%u of %u devices active\r\n", (unsigned)devicePool.getActiveCount(),
+                (unsigned)devicePool.getCount());
+}
+
+/**
+ * Usage:
+ * - tx        show the counters
+ * - tx reset  clear them, including the per-device counters
+ *
+ * Retries climbing while the queue high-water mark approaches
+ * TX_QUEUE_SIZE means CAN1 can't take the configured rates.
+ */
+void commandTransmit(Serial_Console &output, int argc, char* argv[]) {
+  if (argc == 2 && strcmp(argv[1], "reset") == 0) {
+    txScheduler.resetStats();
+    devicePool.resetStats();
+  } else if (argc != 1) {
+    output.printf("usage: tx [reset]\r\n");
+    return;
+  }
+
+  output.printf("streams %u, %s\r\n", (unsigned)txScheduler.getStreamCount(),
+                txScheduler.isPaused() ? "paused" : "running");
+  output.printf("frames  queued %lu  sent %lu  failed %lu  retries %lu\r\n",
+                (unsigned long)txScheduler.getFramesQueued(), (unsigned long)txScheduler.getFramesSent(),
+                (unsigned long)txScheduler.getFramesFailed(), (unsigned long)txScheduler.getRetries());
+  output.printf("queue   depth %lu  high-water %lu of %lu\r\n",
+                (unsigned long)txScheduler.getQueueDepth(), (unsigned long)txScheduler.getQueueHighWater(),
+                (unsigned long)TX_QUEUE_SIZE);
+  output.printf("worst   release %lu us after its slot, %lu frames not logged\r\n",
+                (unsigned long)txScheduler.getMaxLateness(), (unsigned long)txScheduler.getHookDropped());
+}
+
+/**
+ * Usage:
+ * - cap        show the queues and latencies
+ * - cap reset  clear the high-water marks, drops and latencies
+ *
+ * Capture and decode run in interrupts, so "wait" and "decode run" stay
+ * small however busy the loop is; a slow loop shows up in the last two
+ * latencies and, once the queues overflow, in their drops.
+ */
+void commandCapture(Serial_Console &output, int argc, char* argv[]) {
+  if (argc == 2 && strcmp(argv[1], "reset") == 0) {
+    NMEA2000_CAN2.resetStats();
+  } else if (argc != 1) {
+    output.printf("usage: cap [reset]\r\n");
+    return;
   }
 
-  // Keep parsing both buses
-  // Skip CAN1 parsing during attacks to prevent library from maintaining attack state
-  if (!menuController->isAttackActive()) {
+  CAN_FrameRing& captured = NMEA2000_CAN2.getRing();
+  CAN_FrameRing& decoded = NMEA2000_CAN2.getDecodedFrames();
+  CAN_MessageQueue& messages = NMEA2000_CAN2.getMessages();
+  output.printf("frames   received %lu  filtered %lu\r\n",
+                (unsigned long)NMEA2000_CAN2.getReceivedCount(), (unsigned long)NMEA2000_CAN2.getFilteredCount());
+  output.printf("queue            depth  peak   size  dropped\r\n");
+  output.printf("capture frames  %6lu %5lu %6lu %8lu\r\n",
+                (unsigned long)captured.available(), (unsigned long)captured.getHighWater(),
+                (unsigned long)CAPTURE_RING_SIZE, (unsigned long)captured.getDropped());
+  output.printf("decoded frames  %6lu %5lu %6lu %8lu\r\n",
+                (unsigned long)decoded.available(), (unsigned long)decoded.getHighWater(),
+                (unsigned long)CAPTURE_RING_SIZE, (unsigned long)decoded.getDropped());
+  output.printf("messages        %6lu %5lu %6lu %8lu  (peak and size in bytes)\r\n",
+                (unsigned long)messages.available(), (unsigned long)messages.getHighWater(),
+                (unsigned long)CAPTURE_MESSAGE_QUEUE_SIZE, (unsigned long)messages.getDropped());
+
+  output.printf("latency          mean us   max us    samples\r\n");
+  const CaptureLatency* latencies[] = {
+    &NMEA2000_CAN2.getDecodeWait(), &NMEA2000_CAN2.getDecodeRun(),
+    &NMEA2000_CAN2.getHookLatency(), &NMEA2000_CAN2.getHandlerLatency(),
+  };
+  static const char* const LATENCY_NAMES[] = {
+    "capture->decode", "decode run", "capture->hook", "frame->handler",
+  };
+  for (int i = 0; i < 4; i++) {
+    output.printf("%-15s %8.1f %8lu %10lu\r\n", LATENCY_NAMES[i], (float)latencies[i]->mean,
+                  (unsigned long)latencies[i]->max, (unsigned long)latencies[i]->count);
+  }
+}
+
+/**
+ * Usage:
+ * - fp        show the totals and every PGN with multi-frame transfers
+ * - fp reset  clear them, together with the other monitor statistics
+ *
+ * Latencies are first to last frame. Corrupted transfers are split by
+ * cause in the totals; the per-PGN rows only have the sum.
+ */
+void commandTransfers(Serial_Console &output, int argc, char* argv[]) {
+  if (n2kMonitor == nullptr) {
+    output.printf("monitor not running\r\n");
+    return;
+  }
+  if (argc == 2 && strcmp(argv[1], "reset") == 0) {
+    n2kMonitor->resetStatistics();
+  } else if (argc != 1) {
+    output.printf("usage: fp [reset]\r\n");
+    return;
+  }
+
+  const N2K_TransferTracker& transfers = n2kMonitor->getTransfers();
+  output.printf("sessions  active %u  peak %u of %u  untracked %lu\r\n",
+                (unsigned)transfers.getActiveCount(), (unsigned)transfers.getPeakActive(),
+                (unsigned)MONITOR_TRANSFER_SESSIONS, (unsigned long)transfers.getUntracked());
+  output.printf("transfers completed %lu  timed out %lu  corrupted %lu\r\n",
+                (unsigned long)transfers.getCompleted(), (unsigned long)transfers.getTimedOut(),
+                (unsigned long)transfers.getCorrupted());
+  output.printf("corrupted missing %lu  order %lu  collision %lu  orphan %lu  abort %lu  length %lu\r\n",
+                (unsigned long)transfers.getMissingFrames(), (unsigned long)transfers.getOutOfOrder(),
+                (unsigned long)transfers.getCollisions(), (unsigned long)transfers.getOrphans(),
+                (unsigned long)transfers.getAborted(), (unsigned long)transfers.getBadLength());
+  output.printf("latency   mean %lu us  max %lu us\r\n",
+                (unsigned long)transfers.getMeanLatency(), (unsigned long)transfers.getMaxLatency());
+
+  output.printf("src    pgn   Hz       ok   to   er  lat ms  max ms\r\n");
+  for (uint8_t address : n2kMonitor->getDeviceList()) {
+    DeviceInfo* device = n2kMonitor->getDevice(address);
+    if (device == nullptr) continue;
+    for (int i = 0; i < device->pgnCount; i++) {
+      PGNData* pgnData = n2kMonitor->getPGNDataAt(address, i);
+      if (pgnData == nullptr || !pgnData->transfers.hasTransfers()) continue;
+      const N2K_TransferStats& stats = pgnData->transfers;
+      output.printf("%3u %6lu %4.1f %8lu %4lu %4lu %7.1f %7.1f\r\n",
+                    (unsigned)address, (unsigned long)pgnData->pgn, pgnData->stats.getRate(),
+                    (unsigned long)stats.getCompleted(), (unsigned long)stats.getTimedOut(),
+                    (unsigned long)stats.getCorrupted(), stats.getLatency(), stats.getMaxLatency());
+    }
+  }
+}
+
+/**
+ * Usage:
+ * - names  list every NAME seen since boot
+ *
+ * "moves" counts claims of a new address; a device entry that was still
+ * tracked moved along with it.
+ */
+void commandNames(Serial_Console &output, int argc, char* argv[]) {
+  if (n2kMonitor == nullptr) {
+    output.printf("monitor not running\r\n");
+    return;
+  }
+  if (argc != 1) {
+    output.printf("usage: names\r\n");
+    return;
+  }
+
+  const N2K_IdentityTable& identities = n2kMonitor->getIdentities();
+  output.printf("names %u of %u  untracked claims %lu  devices moved %lu\r\n",
+                (unsigned)identities.getCount(), (unsigned)MONITOR_MAX_IDENTITIES,
+                (unsigned long)identities.getUntracked(), (unsigned long)n2kMonitor->getMovedDeviceCount());
+  output.printf("NAME              src   mfr fn  claims moves  name\r\n");
+  for (int slot = 0; slot < MONITOR_IDENTITY_SLOTS; slot++) {
+    const N2K_Identity* identity = identities.get(slot);
+    if (identity == nullptr) continue;
+    char address[4];
+    if (identity->address == N2K_NO_ADDRESS) snprintf(address, sizeof(address), "-");
+    else snprintf(address, sizeof(address), "%u", (unsigned)identity->address);
+    output.printf("%08lX%08lX  %3s  %4u %3u  %6u %5u  %s\r\n",
+                  (unsigned long)(identity->name >> 32), (unsigned long)(identity->name & 0xFFFFFFFFUL),
+                  address, (unsigned)N2K_IdentityTable::getManufacturerCode(identity->name),
+                  (unsigned)N2K_IdentityTable::getDeviceFunction(identity->name),
+                  (unsigned)identity->claims, (unsigned)identity->addressChanges, identity->deviceName);
+  }
+}
+
+/**
+ * Usage:
+ * - alerts        list the alerts, newest first
+ * - alerts reset  clear them
+ *
+ * "value" and "limit" are the measured quantity and what it was compared
+ * with, see N2K_Alert for their units per type.
+ */
+void commandAlerts(Serial_Console &output, int argc, char* argv[]) {
+  if (n2kMonitor == nullptr) {
+    output.printf("monitor not running\r\n");
+    return;
+  }
+  if (argc == 2 && strcmp(argv[1], "reset") == 0) {
+    n2kMonitor->resetAlerts();
+  } else if (argc != 1) {
+    output.printf("usage: alerts [reset]\r\n");
+    return;
+  }
+
+  const N2K_AnomalyDetector& anomalies = n2kMonitor->getAnomalies();
+  output.printf("detections");
+  for (int type = 0; type < ANOMALY_TYPE_COUNT; type++) {
+    output.printf("  %s %lu", N2K_AnomalyDetector::getTypeName((AnomalyType)type),
+                  (unsigned long)anomalies.getTotal((AnomalyType)type));
+  }
+  output.printf("\r\n");
+  output.printf("type      src other    pgn      value      limit  count  first ms   last ms  NAME\r\n");
+  for (int age = 0; age < anomalies.getAlertCount(); age++) {
+    const N2K_Alert* alert = anomalies.getAlert(age);
+    char source[4];
+    char other[4];
+    if (alert->source == 0xFF) snprintf(source, sizeof(source), "bus");
+    else snprintf(source, sizeof(source), "%u", (unsigned)alert->source);
+    if (alert->other == 0xFF) snprintf(other, sizeof(other), "-");
+    else snprintf(other, sizeof(other), "%u", (unsigned)alert->other);
+    output.printf("%-8s  %3s  %4s %6lu %10.2f %10.2f %6u %9lu %9lu",
+                  N2K_AnomalyDetector::getTypeName(alert->type), source, other, (unsigned long)alert->pgn,
+                  alert->value, alert->limit, (unsigned)alert->count,
+                  (unsigned long)alert->firstMillis, (unsigned long)alert->lastMillis);
+    if (alert->name != 0) {
+      output.printf("  %08lX%08lX", (unsigned long)(alert->name >> 32),
+                    (unsigned long)(alert->name & 0xFFFFFFFFUL));
+    }
+    output.printf("\r\n");
+  }
+}
+
+/**
+ * Usage:
+ * - filter                        show both sets and the drop counter
+ * - filter src|pgn off|allow|deny set the mode of a set
+ * - filter src|pgn add|del <n>    add or remove an entry (decimal or 0x hex)
+ * - filter clear                  empty both sets and turn them off
+ */
+void commandFilter(Serial_Console &output, int argc, char* argv[]) {
+  if (argc == 2 && strcmp(argv[1], "clear") == 0) {
+    can2Filter.clear();
+  } else if (argc >= 3 && (strcmp(argv[1], "src") == 0 || strcmp(argv[1], "pgn") == 0)) {
+    bool isSource = argv[1][0] == 's';
+    const char* action = argv[2];
+    FilterMode mode = FILTER_MODE_COUNT;
+    if (strcmp(action, "off") == 0) mode = FILTER_OFF;
+    else if (strcmp(action, "allow") == 0) mode = FILTER_ALLOW;
+    else if (strcmp(action, "deny") == 0) mode = FILTER_DENY;
+
+    if (mode != FILTER_MODE_COUNT) {
+      if (isSource) can2Filter.setSourceMode(mode);
+      else can2Filter.setPGNMode(mode);
+    } else if (argc == 4 && (strcmp(action, "add") == 0 || strcmp(action, "del") == 0)) {
+      char* end;
+      unsigned long value = strtoul(argv[3], &end, 0);
+      bool add = action[0] == 'a';
+      if (*end != '\0' || value > (isSource ? 255UL : CAN_FILTER_MAX_PGN)) {
+        output.printf("filter: bad %s '%s'\r\n", isSource ? "address" : "PGN", argv[3]);
+        return;
+      }
+      if (isSource) {
+        if (add) can2Filter.addSource(value);
+        else can2Filter.removeSource(value);
+      } else {
+        if (add) can2Filter.addPGN(value);
+        else can2Filter.removePGN(value);
+      }
+    } else {
+      output.printf("filter: unknown action '%s'\r\n", action);
+      return;
+    }
+  } else if (argc != 1) {
+    output.printf("usage: filter [src|pgn off|allow|deny|add N|del N] [clear]\r\n");
+    return;
+  }
+
+  // Show the resulting state, listing at most a line of entries per set
+  uint8_t sources[16];
+  int sourceCount = can2Filter.getSources(sources, 16);
+  output.printf("src %-5s %3u entries [%s]:", CAN_Filter::getModeName(can2Filter.getSourceMode()),
+                (unsigned)can2Filter.getSourceCount(),
+                CAN_Filter::getEnforcementName(can2Filter.getSourceEnforcement()));
+  for (int i = 0; i < sourceCount; i++) output.printf(" %u", (unsigned)sources[i]);
+  output.printf("%s\r\n", sourceCount < can2Filter.getSourceCount() ? " ..." : "");
+
+  uint32_t pgns[8];
+  int pgnCount = can2Filter.getPGNs(pgns, 8);
+  output.printf("pgn %-5s %3lu entries [%s]:", CAN_Filter::getModeName(can2Filter.getPGNMode()),
+                (unsigned long)can2Filter.getPGNCount(),
+                CAN_Filter::getEnforcementName(can2Filter.getPGNEnforcement()));
+  for (int i = 0; i < pgnCount; i++) output.printf(" %lu", (unsigned long)pgns[i]);
+  output.printf("%s\r\n", (uint32_t)pgnCount < can2Filter.getPGNCount() ? " ..." : "");
+
+  output.printf("dropped %lu of %lu frames\r\n", (unsigned long)NMEA2000_CAN2.getFilteredCount(),
+                (unsigned long)NMEA2000_CAN2.getReceivedCount());
+}
+
+/**
+ * Usage:
+ * - config        show the saved slot and whether a save is pending
+ * - config save   save now instead of after CONFIG_SAVE_IDLE_MS
+ * - config erase  forget the saved configuration, the next boot uses defaults
+ */
+void commandConfig(Serial_Console &output, int argc, char* argv[]) {
+  if (argc == 2 && strcmp(argv[1], "save") == 0) {
+    configStore.save();
+  } else if (argc == 2 && strcmp(argv[1], "erase") == 0) {
+    configStore.erase();
+  } else if (argc != 1) {
+    output.printf("usage: config [save|erase]\r\n");
+    return;
+  }
+
+  if (configStore.getSlot() < 0) {
+    output.printf("slot none");
+  } else {
+    output.printf("slot %d of %u  sequence %lu", (int)configStore.getSlot(), (unsigned)CONFIG_SLOT_COUNT,
+                  (unsigned long)configStore.getSequence());
+  }
+  output.printf("  boot %s  %s\r\n", configStore.isLoaded() ? "restored" : "defaults",
+                configStore.isPending() ? "save pending" : "saved");
+  output.printf("saves %lu  verify failures %lu\r\n", (unsigned long)configStore.getSaves(),
+                (unsigned long)configStore.getVerifyFailures());
+}
+
+/**
+ * Usage:
+ * - mem        show the memory of each subsystem and RAM region, in bytes
+ * - mem reset  set the peaks to the current use
+ *
+ * Peaks are sampled every MEMORY_SAMPLE_INTERVAL_MS and include the
+ * high-water marks the rings keep, which "cap reset" and "tx reset" clear.
+ * The stack peak counts since boot.
+ */
+void commandMemory(Serial_Console &output, int argc, char* argv[]) {
+  if (argc == 2 && strcmp(argv[1], "reset") == 0) {
+    Memory_Budget::resetPeaks();
+    output.printf("memory peaks cleared\r\n");
+    return;
+  } else if (argc != 1) {
+    output.printf("usage: mem [reset]\r\n");
+    return;
+  }
+
+  Memory_Budget::sample();
+  uint32_t totalUsed = 0, totalReserved = 0, totalPeak = 0;
+  output.printf("sys        used   reserved       peak\r\n");
+  for (int i = 0; i < MEMORY_SUBSYSTEM_COUNT; i++) {
+    MemorySubsystem subsystem = (MemorySubsystem)i;
+    const MemoryUsage &usage = Memory_Budget::getUsage(subsystem);
+    output.printf("%-5s %10lu %10lu %10lu\r\n", Memory_Budget::getSubsystemName(subsystem),
+                  (unsigned long)usage.used, (unsigned long)usage.reserved, (unsigned long)usage.peak);
+    totalUsed += usage.used;
+    totalReserved += usage.reserved;
+    totalPeak += usage.peak;
+  }
+  output.printf("total %10lu %10lu %10lu\r\n", (unsigned long)totalUsed, (unsigned long)totalReserved,
+                (unsigned long)totalPeak);
+
+  MemoryRegions regions;
+  Memory_Budget::getRegions(regions);
+  output.printf("DTCM %lu: globals %lu  stack peak %lu of %lu\r\n", (unsigned long)regions.dtcmSize,
+                (unsigned long)regions.dtcmStatic, (unsigned long)regions.stackPeak,
+                (unsigned long)regions.stackSize);
+  output.printf("RAM2 %lu: DMAMEM %lu  heap %lu\r\n", (unsigned long)regions.ocramSize,
+                (unsigned long)regions.dmamemStatic, (unsigned long)regions.heapSize);
+  output.printf("heap used %lu  peak %lu  free %lu  largest block %lu\r\n", (unsigned long)regions.heapUsed,
+                (unsigned long)regions.heapPeak, (unsigned long)regions.heapFree,
+                (unsigned long)regions.heapLargest);
+}
+
+#if PROFILER_ENABLED
+/**
+ * Usage:
+ * - prof        show the zone timings, their histograms and the PGN parse times
+ * - prof reset  clear them
+ *
+ * Percentiles come from the log2 histogram, so they are rounded up to the
+ * next power of two cycles (capped at the maximum). Histogram bucket n holds
+ * the runs of 2^n to 2^(n+1) - 1 cycles.
+ */
+void commandProfile(Serial_Console &output, int argc, char* argv[]) {
+  if (argc == 2 && strcmp(argv[1], "reset") == 0) {
+    Zone_Profiler::reset();
+    output.printf("profiler cleared\r\n");
+    return;
+  } else if (argc != 1) {
+    output.printf("usage: prof [reset]\r\n");
+    return;
+  }
+
+  float cyclesPerMicro = Zone_Profiler::getCyclesPerMicro();
+  output.printf("zone        runs     avg us     p50 us     p99 us     max us\r\n");
+  for (int i = 0; i < PROFILE_ZONE_COUNT; i++) {
+    ProfileZone zone = (ProfileZone)i;
+    const ProfileZoneStats& stats = Zone_Profiler::getZone(zone);
+    float avg = stats.count > 0 ? (float)stats.totalCycles / stats.count : 0.0f;
+    output.printf("%-7s %8lu %10.2f %10.2f %10.2f %10.2f\r\n", Zone_Profiler::getZoneName(zone),
+                  (unsigned long)stats.count, avg / cyclesPerMicro,
+                  Zone_Profiler::getPercentile(zone, 0.50f) / cyclesPerMicro,
+                  Zone_Profiler::getPercentile(zone, 0.99f) / cyclesPerMicro,
+                  stats.maxCycles / cyclesPerMicro);
+  }
+
+  output.printf("histograms (log2 cycles: runs)\r\n");
+  for (int i = 0; i < PROFILE_ZONE_COUNT; i++) {
+    ProfileZone zone = (ProfileZone)i;
+    const ProfileZoneStats& stats = Zone_Profiler::getZone(zone);
+    if (stats.count == 0) continue;
+    output.printf("%-7s", Zone_Profiler::getZoneName(zone));
+    for (int bucket = 0; bucket < PROFILER_BUCKETS; bucket++) {
+      if (stats.buckets[bucket] == 0) continue;
+      output.printf(" %d:%lu", bucket, (unsigned long)stats.buckets[bucket]);
+    }
+    output.printf("\r\n");
+  }
+
+  output.printf("pgn         runs     avg us     max us\r\n");
+  for (int slot = 0; slot < PROFILER_PGN_SLOTS; slot++) {
+    const ProfilePGNStats* entry = Zone_Profiler::getPGN(slot);
+    if (entry == nullptr) continue;
+    output.printf("%6lu  %8lu %10.2f %10.2f\r\n", (unsigned long)entry->pgn, (unsigned long)entry->count,
+                  (float)entry->totalCycles / entry->count / cyclesPerMicro,
+                  entry->maxCycles / cyclesPerMicro);
+  }
+  output.printf("untimed parses (table full) %lu\r\n", (unsigned long)Zone_Profiler::getPGNOverflow());
+}
+#endif
+
+void taskDispatchCAN2() {
+  PROFILE_ZONE(PROFILE_CAN2_DISPATCH);
+  NMEA2000_CAN2.dispatch();
+}
+
+void taskParseCAN1() {
+  // Frames sent by the transmit scheduler interrupt reach the logger here
+  txScheduler.service();
+
+  // Skip CAN1 parsing during attacks to prevent library from maintaining attack state,
+  // and during replay onto CAN1 so the library doesn't answer in between
+  if (!menuController->isAttackActive() && !frameReplay.isTransmitting()) {
     NMEA2000_CAN1.ParseMessages();
   }
-  NMEA2000_CAN2.ParseMessages();
+}
 
-  // Update menu controller (for real-time displays)
-  menuController->update();
+void taskCaptureOutput() {
+  captureStream.poll();
+}
+
+void taskLogger() {
+  frameLogger.service();
+}
+
+void taskSnapshotServer() {
+  snapshotServer.poll();
+}
+
+void taskConfigStore() {
+  configStore.service();
+}
+
+void taskReplay() {
+  frameReplay.service();
+}
+
+void startMenu() {
+  splash.skip();
+
+  // Initialize display for menu system
+  u8x8.begin();
+  u8x8.setPowerSave(0);
+  screenBuffer.begin();
+
+  uint32_t heapBefore = Memory_Budget::getHeapUsed();
+  menuController->begin();
+  displayHeapBytes += Memory_Budget::getHeapUsed() - heapBefore;
+  menuStarted = true;
+  menuStartTime = micros();
+}
+
+void taskSplash() {
+  if (!menuStarted && splash.step()) {
+    startMenu();
+  }
+}
+
+void taskButtons() {
+  // Any button skips the splash; the press is used up by the debounce
+  if (!menuStarted) {
+    if (buttonPressed(BUTTON_UP) || buttonPressed(BUTTON_DOWN) ||
+        buttonPressed(BUTTON_LEFT) || buttonPressed(BUTTON_RIGHT)) {
+      startMenu();
+    }
+    return;
+  }
 
-  // Handle button inputs
   if(buttonPressed(BUTTON_UP)){
     menuController->navigateUp();
   } else if(buttonPressed(BUTTON_DOWN)){
@@ -290,33 +1322,93 @@ void loop(void)
   }
 }
 
+void taskSensorRefresh() {
+  // The sampler filters in the background, so reading the latest values is
+  // cheap and keeps device 0 fresh for potentiometer-controlled attacks
+  devicePool.refresh();
+}
+
+/**
+ * Sensor transmissions depend on the attack state:
+ * - Normal operation: Transmit all sensor values
+ * - Own-sensor impersonation: Continue normal transmissions alongside attack
+ * - External attack: No transmissions, device 0 only drives the attack value
+ * - Replay onto CAN1: No transmissions, the bus carries only the recording
+ *
+ * The messages are only staged here; the transmit scheduler sends them
+ * from its timer interrupt.
+ */
+void taskSensorSend() {
+  // Holds the impersonation stream as well
+  bool replaying = frameReplay.isTransmitting();
+  txScheduler.setPaused(replaying);
+  if (replaying) return;
+
+  // When impersonating our own sensor this interleaves real and spoofed
+  // data, which the user can watch in Live Data
+  bool attackActive = attackController->isAttackActive();
+  bool impersonatingOwn = attackController->isImpersonatingOwnSensor();
+  devicePool.setPaused(attackActive && !impersonatingOwn);
+  devicePool.service();
+}
+
+void taskAttack() {
+  // A running attack resumes once replay onto CAN1 has finished
+  if (!frameReplay.isTransmitting()) {
+    attackController->update();
+  }
+}
+
+void taskMonitorStats() {
+  n2kMonitor->update();
+}
+
+void taskStaleCleanup() {
+  n2kMonitor->cleanupStaleEntries();
+}
+
+void taskMemoryBudget() {
+  Memory_Budget::sample();
+}
+
+void taskDisplay() {
+  if (!menuStarted) return;
+  menuController->update();
+}
+
+void taskScreenFlush() {
+  screenBuffer.flush(SCREEN_FLUSH_TILE_BUDGET);
+}
+
 void setupNMEA2000() {
   // Configure multi-device mode - each sensor appears as its own device on the bus
-  NMEA2000_CAN1.SetDeviceCount(NUM_DEVICES);
+  NMEA2000_CAN1.SetDeviceCount(devicePool.getCount());
 
   NMEA2000_CAN1.SetMode(tNMEA2000::N2km_NodeOnly, 22);
 
+  // Restore the saved menu sensor settings; the sensors are still inactive,
+  // so this sends nothing
+  configStore.load();
+  configStore.apply();
+
   // Set product info for all sensors BEFORE Open()
   // Use updateDeviceInfo() directly to avoid SendIsoAddressClaim before bus is open
-  sensor1.updateDeviceInfo();
-  sensor2.updateDeviceInfo();
-  sensor3.updateDeviceInfo();
+  for (uint8_t i = 0; i < devicePool.getCount(); i++) {
+    devicePool.getDevice(i)->updateDeviceInfo();
+  }
 
   // Now open - this will initialize the CAN bus
   NMEA2000_CAN1.Open();
 
   // Apply initial active/inactive state for each sensor
   // Sensors default to inactive, so set them to null address and disable heartbeat
-  Sensor* sensors[] = {&sensor1, &sensor2, &sensor3};
-  for (int i = 0; i < NUM_DEVICES; i++) {
-    if (sensors[i]->isActive()) {
-      // Active sensor - set custom name and broadcast info
-      char name[20];
-      snprintf(name, sizeof(name), "Sensor %d", i + 1);
-      sensors[i]->setCustomName(name);
-      delay(10);
-      NMEA2000_CAN1.SendProductInformation(i);
-      delay(10);
+  for (uint8_t i = 0; i < devicePool.getCount(); i++) {
+    Sensor* device = devicePool.getDevice(i);
+    if (configStore.wasActive(i)) {
+      // Active when the configuration was saved - claim and announce it again,
+      // under the restored name. The library queues the claims, as it does
+      // for "dev all on", so boot doesn't wait between sensors.
+      device->setActive(true);
     } else {
       // Inactive sensor - set to null address (254) and disable heartbeat
       NMEA2000_CAN1.SetHeartbeatIntervalAndOffset(0, 0, i);
@@ -325,18 +1417,25 @@ void setupNMEA2000() {
   }
 }
 
-void HandleNMEA2000Msg(const tN2kMsg &N2kMsg) {
-#if !DEBUG
-  // Print candump-style output for all received messages
-  PrintCandumpFormat(N2kMsg);
-#endif
+void HandleCaptureFrame(const CaptureFrame &frame) {
+  captureStream.addFrame(frame);
+  frameLogger.logFrame(frame, false);
+  if(n2kMonitor != nullptr) {
+    n2kMonitor->handleFrame(frame.id, frame.len, frame.data, frame.timestamp);
+  }
+}
 
+void HandleTransmitFrame(const CaptureFrame &frame) {
+  frameLogger.logFrame(frame, true);
+}
+
+void HandleNMEA2000Msg(const tN2kMsg &N2kMsg) {
   if(attackController != nullptr && attackController -> isSpamActive()) {
     attackController->attackHandler(N2kMsg);
   }
   // Handle incoming NMEA2000 messages directly
   if(n2kMonitor != nullptr && !attackController -> isSpamActive()) {
-    n2kMonitor->handleN2kMessage(N2kMsg);
+    n2kMonitor->handleN2kMessage(N2kMsg, NMEA2000_CAN2.getLastFrameTime());
   }
 }
 
@@ -357,77 +1456,3 @@ int getButtonIndex(int button) {
   if (button == BUTTON_RIGHT) return 3;
   return 0;
 }
-
-void PrintCandumpFormat(const tN2kMsg &N2kMsg) {
-  // Reconstruct CAN ID: Priority (3 bits) | PGN (18 bits) | Source (8 bits)
-  uint32_t canId = ((uint32_t)N2kMsg.Priority << 26) | ((uint32_t)N2kMsg.PGN << 8) | N2kMsg.Source;
-
-  if (N2kMsg.DataLen <= 8) {
-    // Single frame message - print directly
-    PrintCanFrame(canId, N2kMsg.DataLen, N2kMsg.Data);
-  } else {
-    // Fast-packet message - re-fragment into 8-byte CAN frames
-    uint8_t frame[8];
-    int dataOffset = 0;
-    int frameCount = 0;
-    uint8_t seqId = (fastPacketSequence & 0x07) << 5;  // Sequence ID in upper 3 bits of counter byte
-
-    while (dataOffset < N2kMsg.DataLen) {
-      if (frameCount == 0) {
-        // First frame: [SeqID + FrameNum] [TotalLen] [6 data bytes]
-        frame[0] = seqId | (frameCount & 0x1F);
-        frame[1] = N2kMsg.DataLen;
-        int bytesToCopy = min(6, (int)N2kMsg.DataLen - dataOffset);
-        for (int i = 0; i < bytesToCopy; i++) {
-          frame[2 + i] = N2kMsg.Data[dataOffset + i];
-        }
-        // Pad remaining bytes with 0xFF
-        for (int i = bytesToCopy; i < 6; i++) {
-          frame[2 + i] = 0xFF;
-        }
-        dataOffset += bytesToCopy;
-        PrintCanFrame(canId, 8, frame);
-      } else {
-        // Subsequent frames: [SeqID + FrameNum] [7 data bytes]
-        frame[0] = seqId | (frameCount & 0x1F);
-        int bytesToCopy = min(7, (int)N2kMsg.DataLen - dataOffset);
-        for (int i = 0; i < bytesToCopy; i++) {
-          frame[1 + i] = N2kMsg.Data[dataOffset + i];
-        }
-        // Pad remaining bytes with 0xFF
-        for (int i = bytesToCopy; i < 7; i++) {
-          frame[1 + i] = 0xFF;
-        }
-        dataOffset += bytesToCopy;
-        PrintCanFrame(canId, 8, frame);
-      }
-      frameCount++;
-    }
-
-    fastPacketSequence++;
-  }
-}
-
-
-void PrintCanFrame(uint32_t canId, uint8_t len, const uint8_t *data) {
-  Serial.print("can1  ");
-  if (canId < 0x10000000) Serial.print("0");
-  if (canId < 0x1000000) Serial.print("0");
-  if (canId < 0x100000) Serial.print("0");
-  if (canId < 0x10000) Serial.print("0");
-  if (canId < 0x1000) Serial.print("0");
-  if (canId < 0x100) Serial.print("0");
-  if (canId < 0x10) Serial.print("0");
-  Serial.print(canId, HEX);
-
-  Serial.print("   [");
-  Serial.print(len);
-  Serial.print("]  ");
-
-  for (int i = 0; i < len; i++) {
-    if (data[i] < 0x10) Serial.print("0");
-    Serial.print(data[i], HEX);
-    if (i < len - 1) Serial.print(" ");
-  }
-  Serial.println();
-}
\ No newline at end of file